@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+#
+# This file is part of vitaGL
+# Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published
+# by the Free Software Foundation, version 3 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+# General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+
+#
+# gen_lookup_hash.py:
+# Generates source/lookup_hash.h, the perfect hash vglGetProcAddress uses over vgl_proctable.
+# Must be run every time an entry is added, removed or moved in source/lookup.c:
+#   python3 gen_lookup_hash.py          regenerates the header
+#   python3 gen_lookup_hash.py --check  fails if the header is out of date
+#
+
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.abspath(__file__))
+LOOKUP_PATH = os.path.join(ROOT, "source", "lookup.c")
+HEADER_PATH = os.path.join(ROOT, "source", "lookup_hash.h")
+
+EMPTY_SLOT = 0xFFFF
+MAX_DISPLACEMENT = 0xFF
+
+# Must match hash_proc_name and proc_slot in lookup.c
+def hash_name(name):
+	h = 0x811C9DC5
+	for c in name.encode():
+		h = ((h ^ c) * 0x01000193) & 0xFFFFFFFF
+	return h
+
+def slot_of(h, d, num_slots):
+	x = (h + d * 0x9E3779B9) & 0xFFFFFFFF
+	x ^= x >> 16
+	x = (x * 0x85EBCA6B) & 0xFFFFFFFF
+	x ^= x >> 13
+	x = (x * 0xC2B2AE35) & 0xFFFFFFFF
+	x ^= x >> 16
+	return x & (num_slots - 1)
+
+def parse_proctable():
+	src = open(LOOKUP_PATH).read()
+	start = src.index("vgl_proctable[] = {")
+	end = src.index("\n};", start)
+	names = []
+	num_optional = 0
+	optional = False
+	for line in src[start:end].splitlines():
+		line = line.strip()
+		if line.startswith("#if"):
+			optional = True
+		elif line.startswith("#endif"):
+			optional = False
+		m = re.match(r'\{"(\w+)", \(void \*\)(\w+)\},', line)
+		if not m:
+			continue
+		if m.group(1) != m.group(2):
+			sys.exit("%s: entry name does not match its function" % m.group(1))
+		if m.group(1)[-3:] in ("EXT", "ARB", "OES"):
+			sys.exit("%s: extension markers are stripped on lookup, entry is unreachable" % m.group(1))
+		if optional:
+			num_optional += 1
+		elif num_optional:
+			sys.exit("%s: entries built unconditionally must precede optional ones" % m.group(1))
+		names.append(m.group(1))
+	if len(set(names)) != len(names):
+		sys.exit("vgl_proctable has duplicated entries")
+	return names, num_optional
+
+def next_pow2(n):
+	p = 1
+	while p < n:
+		p *= 2
+	return p
+
+def build_hash(names):
+	# Hash and displace: every bucket gets the displacement placing all its names in free slots
+	num_slots = next_pow2(len(names) + len(names) // 2)
+	num_buckets = next_pow2(len(names) // 4)
+	hashes = [hash_name(n) for n in names]
+	buckets = [[] for _ in range(num_buckets)]
+	for i, h in enumerate(hashes):
+		buckets[h & (num_buckets - 1)].append(i)
+	slots = [EMPTY_SLOT] * num_slots
+	displacements = [0] * num_buckets
+	for b in sorted(range(num_buckets), key=lambda b: -len(buckets[b])):
+		if not buckets[b]:
+			break
+		for d in range(MAX_DISPLACEMENT + 1):
+			picked = [slot_of(hashes[i], d, num_slots) for i in buckets[b]]
+			if len(set(picked)) == len(picked) and all(slots[s] == EMPTY_SLOT for s in picked):
+				break
+		else:
+			sys.exit("no displacement found for bucket %d" % b)
+		displacements[b] = d
+		for i, s in zip(buckets[b], picked):
+			slots[s] = i
+	return displacements, slots
+
+def lookup(names, displacements, slots, name):
+	h = hash_name(name)
+	idx = slots[slot_of(h, displacements[h & (len(displacements) - 1)], len(slots))]
+	return idx if idx != EMPTY_SLOT and names[idx] == name else None
+
+def format_array(values, digits):
+	lines = []
+	for i in range(0, len(values), 16):
+		lines.append("\t" + " ".join("0x%0*X," % (digits, v) for v in values[i:i + 16]))
+	return "\n".join(lines)
+
+def generate():
+	names, num_optional = parse_proctable()
+	displacements, slots = build_hash(names)
+
+	# Self-check, every entry must be found at its own index
+	for i, n in enumerate(names):
+		if lookup(names, displacements, slots, n) != i:
+			sys.exit("%s: not resolved by the generated hash" % n)
+
+	return """/*
+ * lookup_hash.h:
+ * Perfect hash over vgl_proctable names, generated by gen_lookup_hash.py (do not edit)
+ */
+
+#ifndef _LOOKUP_HASH_H_
+#define _LOOKUP_HASH_H_
+
+#define VGL_PROCS_NUM %d // Number of entries in vgl_proctable with EXPOSE_VGL_FUNCS
+#define VGL_OPTIONAL_PROCS_NUM %d // Number of entries in vgl_proctable depending on EXPOSE_VGL_FUNCS
+#define VGL_PROC_BUCKETS_NUM %d
+#define VGL_PROC_SLOTS_NUM %d
+#define VGL_PROC_EMPTY_SLOT 0x%04X
+
+static const uint8_t vgl_proc_displacements[VGL_PROC_BUCKETS_NUM] = {
+%s
+};
+
+static const uint16_t vgl_proc_slots[VGL_PROC_SLOTS_NUM] = {
+%s
+};
+
+#endif
+""" % (len(names), num_optional, len(displacements), len(slots), EMPTY_SLOT, format_array(displacements, 2), format_array(slots, 4))
+
+if __name__ == "__main__":
+	out = generate()
+	if "--check" in sys.argv[1:]:
+		if not os.path.exists(HEADER_PATH) or open(HEADER_PATH).read() != out:
+			sys.exit("source/lookup_hash.h is out of date, run gen_lookup_hash.py")
+		print("source/lookup_hash.h is up to date")
+	else:
+		with open(HEADER_PATH, "w") as f:
+			f.write(out)
@@ -0,0 +1,52 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * bench.h:
+ * Timing helpers shared by the host microbenchmarks, every benchmark is a standalone program printing its results
+ */
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_RUNS 10 // Number of runs a measure is taken over, the fastest one is kept
+
+static inline uint64_t bench_now(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+// Runs the given statement BENCH_RUNS times and stores the fastest run duration in nanoseconds
+#define BENCH_MIN(ns, stmt) \
+	do { \
+		ns = UINT64_MAX; \
+		for (int _r = 0; _r < BENCH_RUNS; _r++) { \
+			uint64_t _t = bench_now(); \
+			stmt; \
+			_t = bench_now() - _t; \
+			if (_t < ns) \
+				ns = _t; \
+		} \
+	} while (0)
+
+#endif
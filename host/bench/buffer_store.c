@@ -0,0 +1,184 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * buffer_store.c:
+ * Bytes moved and storages allocated per frame by buffer updates, copying the whole buffer on every update of a drawn buffer
+ * (the path buffer_utils.c replaced) versus versioned storages tagged when the buffer gets updated or on every draw
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "utils/buffer_utils.h"
+
+#include "bench.h"
+
+#define FRAMES_NUM 600
+#define GPU_LATENCY 2 // Scenes the simulated GPU lags behind the CPU
+
+// Storages are never read by a real GPU here, so they can be released right away
+static void *alloc_storage(uint32_t size, uint32_t type) {
+	return malloc(size);
+}
+
+static void release_storage(void *ptr, int busy) {
+	free(ptr);
+}
+
+static const buffer_allocator allocator = {alloc_storage, release_storage};
+
+typedef struct {
+	const char *name;
+	uint32_t size; // Buffer size
+	uint32_t update; // Bytes updated per pass
+	uint32_t passes; // Update and draw passes per frame
+	uint32_t period; // Frames between updates
+	uint32_t phase; // Frame of the period updates happen in
+	uint32_t draw_period; // Frames between draws, draws happen in the first frame of the period
+	int orphan; // Updates replace the whole content
+} workload;
+
+static const workload workloads[] = {
+	{"1MB VBO, 16KB update per frame", 1 << 20, 16 << 10, 1, 1, 0, 1, 0},
+	{"1MB VBO, 3x (4KB update + draw) per frame", 1 << 20, 4 << 10, 3, 1, 0, 1, 0},
+	{"256KB VBO, 64KB update per frame", 256 << 10, 64 << 10, 1, 1, 0, 1, 0},
+	{"256KB VBO, glBufferData per frame", 256 << 10, 256 << 10, 1, 1, 0, 1, 1},
+	{"1MB VBO, 16KB update every 4 frames", 1 << 20, 16 << 10, 1, 4, 0, 1, 0},
+	{"1MB VBO drawn every 4 frames, 16KB update 3 frames after", 1 << 20, 16 << 10, 1, 4, 3, 4, 0},
+	{"256KB VBO drawn every 8 frames, 64KB update 4 frames after", 256 << 10, 64 << 10, 1, 8, 4, 8, 0},
+};
+
+enum {
+	FULL_COPY, // Whole buffer reallocated and copied if drawn since last update
+	TAG_ON_UPDATE, // Storage tagged with the scene being recorded when updated after a draw
+	TAG_ON_DRAW, // Storage tagged with the scene of every draw
+	MODES_NUM
+};
+
+static const char *mode_names[] = {"full copy", "tag on update", "tag on draw"};
+
+static uint8_t *data;
+
+static uint32_t update_offset(const workload *w, int f, uint32_t pass) {
+	return ((f * w->passes + pass) * 7919u * 64) % (w->size - w->update + 1);
+}
+
+static void run_full_copy(const workload *w, uint64_t *bytes, uint32_t *allocs, uint32_t *renames) {
+	uint8_t *p = malloc(w->size);
+	int used = 0;
+	for (int f = 0; f < FRAMES_NUM; f++) {
+		for (uint32_t pass = 0; pass < w->passes; pass++) {
+			if (f % w->period == w->phase) {
+				uint32_t off = update_offset(w, f, pass);
+				if (w->orphan) {
+					free(p);
+					p = malloc(w->size);
+					memcpy(p, data, w->size);
+					*bytes += w->size;
+					(*allocs)++;
+					(*renames)++;
+				} else if (used) {
+					uint8_t *n = malloc(w->size);
+					memcpy(n, p, off);
+					memcpy(n + off, data, w->update);
+					memcpy(n + off + w->update, p + off + w->update, w->size - off - w->update);
+					free(p);
+					p = n;
+					*bytes += w->size;
+					(*allocs)++;
+					(*renames)++;
+				} else {
+					memcpy(p + off, data, w->update);
+					*bytes += w->update;
+				}
+				used = 0;
+			}
+			if (f % w->draw_period == 0)
+				used = 1;
+		}
+	}
+	free(p);
+}
+
+static void run_store(const workload *w, int tag_on_draw, uint64_t *bytes, uint32_t *allocs, uint32_t *renames) {
+	buffer_store s;
+	buffer_stats stats;
+	uint32_t pending = 1, completed = 0;
+	int used = 0;
+	memset(&s, 0, sizeof(s));
+	memset(&stats, 0, sizeof(stats));
+	buffer_store_orphan(&s, &allocator, w->size, 0, completed, &stats);
+	for (int f = 0; f < FRAMES_NUM; f++) {
+		for (uint32_t pass = 0; pass < w->passes; pass++) {
+			if (f % w->period == w->phase) {
+				if (used) {
+					buffer_store_use(&s, pending);
+					used = 0;
+				}
+				if (w->orphan) {
+					void *p = buffer_store_orphan(&s, &allocator, w->size, 0, completed, &stats);
+					memcpy(p, data, w->size);
+					stats.bytes_written += w->size;
+				} else
+					buffer_store_write(&s, &allocator, update_offset(w, f, pass), data, w->update, completed, &stats);
+			}
+			if (f % w->draw_period)
+				continue;
+			if (tag_on_draw)
+				buffer_store_use(&s, pending);
+			else
+				used = 1;
+		}
+		// One scene per frame
+		pending++;
+		completed = pending > GPU_LATENCY + 1 ? pending - GPU_LATENCY - 1 : 0;
+	}
+	buffer_store_release(&s, &allocator, completed);
+	*bytes = stats.bytes_written + stats.bytes_copied;
+	*allocs = stats.allocs;
+	*renames = stats.renames;
+}
+
+int main(int argc, char **argv) {
+	data = malloc(1 << 20);
+	memset(data, 7, 1 << 20);
+
+	printf("Bytes moved, storages allocated, storage switches and time per frame\n");
+	for (int i = 0; i < sizeof(workloads) / sizeof(*workloads); i++) {
+		const workload *w = &workloads[i];
+		printf("%s\n", w->name);
+		for (int mode = 0; mode < MODES_NUM; mode++) {
+			uint64_t ns, bytes = 0;
+			uint32_t allocs = 0, renames = 0;
+			BENCH_MIN(ns, {
+				bytes = 0;
+				allocs = 0;
+				renames = 0;
+				if (mode == FULL_COPY)
+					run_full_copy(w, &bytes, &allocs, &renames);
+				else
+					run_store(w, mode == TAG_ON_DRAW, &bytes, &allocs, &renames);
+			});
+			printf("  %-14s %9.0f B %5.2f allocs %5.2f renames %8.2f us\n", mode_names[mode], (double)bytes / FRAMES_NUM, (double)allocs / FRAMES_NUM,
+				(double)renames / FRAMES_NUM, ns / 1e3 / FRAMES_NUM);
+		}
+	}
+
+	free(data);
+	return 0;
+}
@@ -0,0 +1,234 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * dxt.c:
+ * Benchmark for runtime DXT compression, stb_dxt walking blocks in morton order (the path dxt_utils.c replaced)
+ * versus dxt_compress_swizzled at every quality level, reporting MPix/s and PSNR
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vitasdk.h>
+#include "utils/dxt_utils.h"
+#define STB_DXT_IMPLEMENTATION
+#include "utils/stb_dxt.h"
+
+#include "bench.h"
+
+#define IMG_SIZE 1024 // Width and height of the compressed images
+
+static const char *img_names[] = {"noisy smooth", "hard edges", "gradients"};
+
+static inline int clamp_u8(double v) {
+	return v < 0 ? 0 : (v > 255 ? 255 : (int)v);
+}
+
+static void gen_image(uint8_t *img, int w, int h, int kind) {
+	srand(kind + 1);
+	for (int y = 0; y < h; y++) {
+		for (int x = 0; x < w; x++) {
+			uint8_t *p = img + (y * w + x) * 4;
+			double fx = x / (double)w, fy = y / (double)h;
+			switch (kind) {
+			case 0: // Smooth photo-like fields with noise
+				p[0] = clamp_u8(128 + 90 * sin(fx * 9 + fy * 3) + rand() % 12);
+				p[1] = clamp_u8(128 + 80 * sin(fy * 7 + 1) * cos(fx * 4) + rand() % 12);
+				p[2] = clamp_u8(100 + 100 * cos(fx * 5 - fy * 6) + rand() % 12);
+				p[3] = clamp_u8(255 * fx + rand() % 8);
+				break;
+			case 1: // Hard edged tiles
+				p[0] = ((x / 13) * 37) & 0xFF;
+				p[1] = ((y / 7) * 53) & 0xFF;
+				p[2] = (((x + y) / 11) * 71) & 0xFF;
+				p[3] = ((x / 16 + y / 16) & 1) ? 0xFF : 0;
+				break;
+			default: // Gradients
+				p[0] = x * 255 / (w - 1);
+				p[1] = y * 255 / (h - 1);
+				p[2] = 255 - p[0] / 2;
+				p[3] = (p[0] + p[1]) / 2;
+				break;
+			}
+		}
+	}
+}
+
+// Morton order walk over the po2 square covering the texture, as gpu_utils.c used to do with stb_dxt
+static uint32_t morton_compact(uint32_t x) {
+	x &= 0x55555555;
+	x = (x | (x >> 1)) & 0x33333333;
+	x = (x | (x >> 2)) & 0x0F0F0F0F;
+	x = (x | (x >> 4)) & 0x00FF00FF;
+	x = (x | (x >> 8)) & 0x0000FFFF;
+	return x;
+}
+
+static void stb_compress(uint8_t *dst, const uint8_t *src, int w, int h, int isdxt5, int mode) {
+	uint8_t block[64];
+	int s = w > h ? w : h;
+	uint32_t blocks_num = (s * s) / 16;
+	for (uint32_t d = 0; d < blocks_num; d++) {
+		uint32_t ox = morton_compact(d), oy = morton_compact(d >> 1);
+		if (ox * 4 >= h || oy * 4 >= w)
+			continue;
+		for (int j = 0; j < 4; j++) {
+			memcpy(&block[j * 16], src + oy * 16 + (ox * 4 + j) * w * 4, 16);
+		}
+		stb_compress_dxt_block(dst, block, isdxt5, mode);
+		dst += isdxt5 ? 16 : 8;
+	}
+}
+
+static inline int expand_565(uint16_t c, int ch) {
+	switch (ch) {
+	case 0:
+		return ((c >> 11) << 3) | (c >> 13);
+	case 1:
+		return (((c >> 5) & 0x3F) << 2) | ((c >> 9) & 0x03);
+	default:
+		return ((c & 0x1F) << 3) | ((c >> 2) & 0x07);
+	}
+}
+
+static void decode_block(const uint8_t *b, int isdxt5, uint8_t *out) {
+	if (isdxt5) {
+		int pal[8] = {b[0], b[1]};
+		if (b[0] > b[1]) {
+			for (int i = 2; i < 8; i++)
+				pal[i] = ((8 - i) * b[0] + (i - 1) * b[1]) / 7;
+		} else {
+			for (int i = 2; i < 6; i++)
+				pal[i] = ((6 - i) * b[0] + (i - 1) * b[1]) / 5;
+			pal[6] = 0;
+			pal[7] = 255;
+		}
+		uint64_t bits = 0;
+		for (int i = 0; i < 6; i++)
+			bits |= (uint64_t)b[2 + i] << (8 * i);
+		for (int i = 0; i < 16; i++)
+			out[i * 4 + 3] = pal[(bits >> (3 * i)) & 7];
+		b += 8;
+	} else {
+		for (int i = 0; i < 16; i++)
+			out[i * 4 + 3] = 255;
+	}
+	uint16_t c0 = b[0] | (b[1] << 8), c1 = b[2] | (b[3] << 8);
+	uint32_t mask = b[4] | (b[5] << 8) | (b[6] << 16) | ((uint32_t)b[7] << 24);
+	for (int c = 0; c < 3; c++) {
+		int pal[4] = {expand_565(c0, c), expand_565(c1, c)};
+		if (c0 > c1 || isdxt5) {
+			pal[2] = (2 * pal[0] + pal[1]) / 3;
+			pal[3] = (pal[0] + 2 * pal[1]) / 3;
+		} else {
+			pal[2] = (pal[0] + pal[1]) / 2;
+			pal[3] = 0;
+		}
+		for (int i = 0; i < 16; i++)
+			out[i * 4 + c] = pal[(mask >> (2 * i)) & 3];
+	}
+}
+
+static double psnr(const uint8_t *img, const uint8_t *comp, int w, int h, int isdxt5) {
+	uint32_t blocks_w = w / 4, blocks_h = h / 4;
+	int channels = isdxt5 ? 4 : 3;
+	uint8_t out[64];
+	double err = 0;
+	for (uint32_t by = 0; by < blocks_h; by++) {
+		for (uint32_t bx = 0; bx < blocks_w; bx++) {
+			decode_block(comp + dxt_swizzled_block_index(bx, by, blocks_w, blocks_h) * (isdxt5 ? 16 : 8), isdxt5, out);
+			for (int j = 0; j < 4; j++) {
+				for (int i = 0; i < 4; i++) {
+					for (int c = 0; c < channels; c++) {
+						int d = out[(j * 4 + i) * 4 + c] - img[((by * 4 + j) * w + bx * 4 + i) * 4 + c];
+						err += d * d;
+					}
+				}
+			}
+		}
+	}
+	return 10 * log10(255.0 * 255.0 * w * h * channels / err);
+}
+
+// Compression setups measured against each other
+typedef struct {
+	const char *name;
+	int stb_mode; // stb_dxt mode or -1 for dxt_utils
+	dxt_quality quality;
+	int workers;
+} bench_setup;
+
+static const bench_setup setups[] = {
+	{"stb normal", STB_DXT_NORMAL},
+	{"stb highqual", STB_DXT_HIGHQUAL},
+	{"fast", -1, DXT_QUALITY_FAST, 0},
+	{"normal", -1, DXT_QUALITY_NORMAL, 0},
+	{"high", -1, DXT_QUALITY_HIGH, 0},
+	{"fast", -1, DXT_QUALITY_FAST, DXT_MAX_WORKERS},
+	{"normal", -1, DXT_QUALITY_NORMAL, DXT_MAX_WORKERS},
+	{"high", -1, DXT_QUALITY_HIGH, DXT_MAX_WORKERS},
+};
+
+#define SETUPS_NUM (sizeof(setups) / sizeof(*setups))
+
+static void run_setup(const bench_setup *b, uint8_t *comp, const uint8_t *img, int isdxt5) {
+	if (b->stb_mode >= 0)
+		stb_compress(comp, img, IMG_SIZE, IMG_SIZE, isdxt5, b->stb_mode);
+	else
+		dxt_compress_swizzled(comp, img, IMG_SIZE, IMG_SIZE, IMG_SIZE, IMG_SIZE, isdxt5, b->quality);
+}
+
+int main(int argc, char **argv) {
+	const double pixels = IMG_SIZE * IMG_SIZE;
+	uint8_t *img = malloc(IMG_SIZE * IMG_SIZE * 4), *comp = malloc(IMG_SIZE * IMG_SIZE);
+	uint64_t best[SETUPS_NUM];
+
+	for (int kind = 0; kind < 3; kind++) {
+		gen_image(img, IMG_SIZE, IMG_SIZE, kind);
+		for (int isdxt5 = 0; isdxt5 < 2; isdxt5++) {
+			// Setups are interleaved so that they all run under the same machine load
+			for (int i = 0; i < SETUPS_NUM; i++)
+				best[i] = UINT64_MAX;
+			for (int r = 0; r < BENCH_RUNS; r++) {
+				for (int i = 0; i < SETUPS_NUM; i++) {
+					dxt_workers_init(setups[i].workers, 0, 0);
+					uint64_t t = bench_now();
+					run_setup(&setups[i], comp, img, isdxt5);
+					t = bench_now() - t;
+					best[i] = t < best[i] ? t : best[i];
+				}
+			}
+			printf("%s %s %dx%d\n", img_names[kind], isdxt5 ? "DXT5" : "DXT1", IMG_SIZE, IMG_SIZE);
+			for (int i = 0; i < SETUPS_NUM; i++) {
+				dxt_workers_init(setups[i].workers, 0, 0);
+				run_setup(&setups[i], comp, img, isdxt5);
+				if (setups[i].stb_mode >= 0)
+					printf("  %-24s", setups[i].name);
+				else
+					printf("  dxt_utils %-6s %d workers", setups[i].name, setups[i].workers);
+				printf(" %7.2f MPix/s %6.2f dB\n", pixels * 1000 / best[i], psnr(img, comp, IMG_SIZE, IMG_SIZE, isdxt5));
+			}
+		}
+	}
+	dxt_workers_term();
+
+	free(img);
+	free(comp);
+	return 0;
+}
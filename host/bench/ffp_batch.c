@@ -0,0 +1,138 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * ffp_batch.c:
+ * Draws and CPU time per frame of a sprite based 2D frame replayed through the fixed function pipeline,
+ * the draws get merged only if libvitaGL was built with FFP_BATCHING=1
+ */
+
+#include <stdlib.h>
+#include <vitaGL.h>
+#include <vgl_mock.h>
+
+#include "bench.h"
+
+#define SPRITES_NUM 2000 // Textured sprites drawn every frame
+#define TEXTURES_NUM 8 // Textures sprites are grouped by
+#define UI_QUADS_NUM 16 // Blended quads drawn over the sprites
+#define TEX_SIZE 64
+
+// Draw of the recorded stream, one quad placed through the modelview
+typedef struct {
+	uint8_t texture;
+	uint8_t blend;
+	float x, y, scale;
+} draw_op;
+
+static draw_op stream[SPRITES_NUM + UI_QUADS_NUM];
+static GLuint textures[TEXTURES_NUM + 1];
+
+static const float quad_pos[] = {0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0};
+static const float quad_uv[] = {0, 0, 1, 0, 1, 1, 0, 1};
+
+static void record_stream(void) {
+	// Sprites sorted by texture as a 2D engine would do, followed by the UI
+	srand(1);
+	for (int i = 0; i < SPRITES_NUM; i++) {
+		draw_op *op = &stream[i];
+		op->texture = i * TEXTURES_NUM / SPRITES_NUM;
+		op->blend = 0;
+		op->x = rand() % 960;
+		op->y = rand() % 544;
+		op->scale = 8 + rand() % 24;
+	}
+	for (int i = 0; i < UI_QUADS_NUM; i++) {
+		draw_op *op = &stream[SPRITES_NUM + i];
+		op->texture = TEXTURES_NUM;
+		op->blend = 1;
+		op->x = 16 + i * 56;
+		op->y = 500;
+		op->scale = 48;
+	}
+}
+
+static void replay_stream(void) {
+	glClear(GL_COLOR_BUFFER_BIT);
+	int texture = -1, blend = 0;
+	for (int i = 0; i < SPRITES_NUM + UI_QUADS_NUM; i++) {
+		draw_op *op = &stream[i];
+		if (op->texture != texture) {
+			texture = op->texture;
+			glBindTexture(GL_TEXTURE_2D, textures[texture]);
+		}
+		if (op->blend != blend) {
+			blend = op->blend;
+			glEnable(GL_BLEND);
+		}
+		glLoadIdentity();
+		glTranslatef(op->x, op->y, 0);
+		glScalef(op->scale, op->scale, 1);
+		glDrawArrays(GL_QUADS, 0, 4);
+	}
+	glDisable(GL_BLEND);
+	vglSwapBuffers(GL_FALSE);
+}
+
+int main(int argc, char **argv) {
+	vglInit(0x800000);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glOrtho(0, 960, 544, 0, -1, 1);
+	glMatrixMode(GL_MODELVIEW);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	uint8_t *pixels = malloc(TEX_SIZE * TEX_SIZE * 4);
+	glGenTextures(TEXTURES_NUM + 1, textures);
+	for (int i = 0; i <= TEXTURES_NUM; i++) {
+		for (int j = 0; j < TEX_SIZE * TEX_SIZE * 4; j++)
+			pixels[j] = i * 31 + j;
+		glBindTexture(GL_TEXTURE_2D, textures[i]);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, TEX_SIZE, TEX_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+	}
+	free(pixels);
+	glEnable(GL_TEXTURE_2D);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 0, quad_pos);
+	glTexCoordPointer(2, GL_FLOAT, 0, quad_uv);
+
+	// The first frame warms up the ffp shaders cache
+	record_stream();
+	replay_stream();
+
+	vglMockStats before, after;
+	vglFFPBatchingStats batch_before, batch_after;
+	vglMockGetStats(&before);
+	vglGetFFPBatchingStats(&batch_before);
+	replay_stream();
+	vglMockGetStats(&after);
+	vglGetFFPBatchingStats(&batch_after);
+
+	uint64_t ns;
+	BENCH_MIN(ns, replay_stream());
+#ifdef HAVE_FFP_BATCHING
+	printf("ffp batching on\n");
+#else
+	printf("ffp batching off (build with FFP_BATCHING=1 to enable it)\n");
+#endif
+	printf("  %d draws submitted, %llu sceGxmDraw calls per frame (clear included)\n", SPRITES_NUM + UI_QUADS_NUM, (unsigned long long)(after.cmds[VGL_MOCK_CMD_DRAW] - before.cmds[VGL_MOCK_CMD_DRAW]));
+	printf("  %u draws batched into %u, %u vertices moved on the CPU\n", batch_after.draws_in - batch_before.draws_in, batch_after.draws_out - batch_before.draws_out, batch_after.vertices_transformed - batch_before.vertices_transformed);
+	printf("  %.1f us CPU time per frame\n", ns / 1000.0);
+	return 0;
+}
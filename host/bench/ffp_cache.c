@@ -0,0 +1,96 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * ffp_cache.c:
+ * Lookup cost of the ffp shaders RAM cache against the linear scan it replaced, at growing cache sizes
+ */
+
+// Static helpers of the cache are benchmarked directly, so ffp.c is built as part of this program
+#include "ffp.c"
+#include "bench.h"
+
+#define LOOKUPS_NUM 1000000
+
+static const uint32_t sizes[] = {256, 1024, 4096};
+
+static shader_mask masks[4096];
+#ifndef DISABLE_TEXTURE_COMBINER
+static combiner_mask cmb_masks[4096];
+#endif
+
+// Reference implementation, how the cache got probed before being hashed
+static int linear_lookup(uint32_t i) {
+	for (int j = 0; j < shader_cache_size; j++) {
+#ifdef DISABLE_TEXTURE_COMBINER
+		if (shader_cache[j].mask.raw == masks[i].raw)
+#else
+		if (shader_cache[j].mask.raw == masks[i].raw && shader_cache[j].cmb_mask.raw == cmb_masks[i].raw)
+#endif
+			return j;
+	}
+	return -1;
+}
+
+static int hashed_lookup(uint32_t i) {
+#ifdef DISABLE_TEXTURE_COMBINER
+	return lookup_ffp_shader(masks[i]);
+#else
+	return lookup_ffp_shader(masks[i], cmb_masks[i]);
+#endif
+}
+
+static uint64_t run(int (*lookup)(uint32_t), uint32_t n) {
+	uint64_t ns;
+	volatile int sink = 0;
+
+	// Striding over entries so that every lookup hits a different one, in no particular order
+	BENCH_MIN(ns, for (uint32_t k = 0; k < LOOKUPS_NUM; k++) sink += lookup((k * 7919) % n));
+	return ns;
+}
+
+int main(int argc, char **argv) {
+	srand(0);
+	for (uint32_t i = 0; i < 4096; i++) {
+		masks[i].raw = rand();
+#ifndef DISABLE_TEXTURE_COMBINER
+		cmb_masks[i].raw = ((uint64_t)rand() << 32) | rand();
+#endif
+	}
+
+	vglInit(0x800000);
+	for (int s = 0; s < sizeof(sizes) / sizeof(*sizes); s++) {
+		uint32_t n = sizes[s];
+		term_ffp_shader_cache();
+		shader_cache_capacity = n;
+		init_ffp_shader_cache();
+		for (uint32_t i = 0; i < n; i++) {
+#ifdef DISABLE_TEXTURE_COMBINER
+			cache_ffp_shader(masks[i]);
+#else
+			cache_ffp_shader(masks[i], cmb_masks[i]);
+#endif
+		}
+
+		uint64_t hashed = run(hashed_lookup, n);
+		uint64_t linear = run(linear_lookup, n);
+		printf("%4u entries: hashed %6.1f ns/lookup, linear %7.1f ns/lookup\n", n, (double)hashed / LOOKUPS_NUM, (double)linear / LOOKUPS_NUM);
+	}
+	vglEnd();
+	return 0;
+}
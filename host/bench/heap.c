@@ -0,0 +1,315 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * heap.c:
+ * Benchmark for the vitaGL memory pools replaying a randomized trace and one recorded from a texture and buffer churn
+ * workload, the backend is the one libvitaGL was built with (HAVE_CUSTOM_HEAP=1 for the list heap, 2 for TLSF)
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vitaGL.h>
+#include "utils/mem_utils.h"
+
+#include "bench.h"
+
+#define POOL_SIZE (256 * 1024 * 1024) // Size of the pool traces are replayed on
+#define RANDOM_SLOTS 4000 // Live allocations at most in the randomized trace
+#define RANDOM_OPS 200000 // Operations in the randomized trace
+#define TRACE_MAX_OPS 1000000 // Recorded operations at most
+#define WORKLOAD_FRAMES 300 // Frames the recorded workload runs for
+#define WORKLOAD_TEXTURES 64 // Live textures at most in the recorded workload
+#define WORKLOAD_BUFFERS 64 // Live buffers at most in the recorded workload
+
+#if defined(HAVE_TLSF_HEAP)
+#define HEAP_NAME "tlsf"
+#elif defined(HAVE_CUSTOM_HEAP)
+#define HEAP_NAME "list heap"
+#else
+#define HEAP_NAME "mspace"
+#endif
+
+enum {
+	OP_ALLOC,
+	OP_REALLOC,
+	OP_FREE
+};
+
+typedef struct {
+	uint8_t op;
+	uint32_t id;
+	uint32_t size;
+	uint32_t align;
+} trace_op;
+
+typedef struct {
+	trace_op *ops;
+	uint32_t num;
+	uint32_t ids_num;
+	uint32_t peak; // Operation the fragmentation is measured at
+} trace;
+
+static void trace_push(trace *t, uint8_t op, uint32_t id, uint32_t size, uint32_t align) {
+	if (t->num == TRACE_MAX_OPS)
+		return;
+	trace_op *o = &t->ops[t->num++];
+	o->op = op;
+	o->id = id;
+	o->size = size;
+	o->align = align;
+	if (op == OP_ALLOC && id >= t->ids_num)
+		t->ids_num = id + 1;
+}
+
+// Closes the trace releasing whatever is still live, fragmentation is measured at the end unless a peak was marked
+static void trace_finish(trace *t, uint8_t *live) {
+	if (!t->peak)
+		t->peak = t->num;
+	for (uint32_t i = 0; i < t->ids_num; i++) {
+		if (live[i])
+			trace_push(t, OP_FREE, i, 0, 0);
+	}
+}
+
+static uint32_t rng = 777;
+
+static uint32_t rnd() {
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+	return rng;
+}
+
+static void make_random_trace(trace *t) {
+	static uint8_t live[RANDOM_SLOTS];
+	uint32_t ids[RANDOM_SLOTS];
+	for (int n = 0; n < RANDOM_OPS; n++) {
+		int s = rnd() % RANDOM_SLOTS;
+		if (live[s]) {
+			trace_push(t, OP_FREE, ids[s], 0, 0);
+			live[s] = 0;
+		} else {
+			uint32_t r = rnd() % 100, size;
+			if (r < 60)
+				size = 16 + rnd() % 512;
+			else if (r < 90)
+				size = 1024 + rnd() % 16384;
+			else
+				size = 65536 + rnd() % (1 << 20);
+			ids[s] = t->ids_num;
+			trace_push(t, OP_ALLOC, ids[s], size, 1 << (4 + rnd() % 5));
+			live[s] = 1;
+		}
+	}
+	static uint8_t live_ids[RANDOM_OPS];
+	for (int s = 0; s < RANDOM_SLOTS; s++) {
+		if (live[s])
+			live_ids[ids[s]] = 1;
+	}
+	trace_finish(t, live_ids);
+}
+
+/*
+ * Recording of the pools traffic through the linker wrappers of the vgl_* memory functions
+ */
+void *__real_vgl_malloc(size_t size, vglMemType type);
+void *__real_vgl_calloc(size_t num, size_t size, vglMemType type);
+void *__real_vgl_memalign(size_t alignment, size_t size, vglMemType type);
+void *__real_vgl_realloc(void *ptr, size_t size);
+void __real_vgl_free(void *ptr);
+
+static trace recorded;
+static int recording = 0;
+static pthread_mutex_t record_mutex = PTHREAD_MUTEX_INITIALIZER;
+static void *record_ptrs[TRACE_MAX_OPS]; // Pointer returned for every recorded id
+
+static int64_t record_find(void *ptr) {
+	for (int64_t i = recorded.ids_num - 1; i >= 0; i--) {
+		if (record_ptrs[i] == ptr)
+			return i;
+	}
+	return -1;
+}
+
+static void *record_alloc(void *res, size_t size, size_t align, vglMemType type) {
+	if (recording && res && type != VGL_MEM_EXTERNAL) {
+		pthread_mutex_lock(&record_mutex);
+		record_ptrs[recorded.ids_num] = res;
+		trace_push(&recorded, OP_ALLOC, recorded.ids_num, size, align);
+		pthread_mutex_unlock(&record_mutex);
+	}
+	return res;
+}
+
+void *__wrap_vgl_malloc(size_t size, vglMemType type) {
+	return record_alloc(__real_vgl_malloc(size, type), size, 8, type);
+}
+
+void *__wrap_vgl_calloc(size_t num, size_t size, vglMemType type) {
+	return record_alloc(__real_vgl_calloc(num, size, type), num * size, 8, type);
+}
+
+void *__wrap_vgl_memalign(size_t alignment, size_t size, vglMemType type) {
+	return record_alloc(__real_vgl_memalign(alignment, size, type), size, alignment, type);
+}
+
+void *__wrap_vgl_realloc(void *ptr, size_t size) {
+	void *res = __real_vgl_realloc(ptr, size);
+	if (recording && res) {
+		pthread_mutex_lock(&record_mutex);
+		int64_t id = record_find(ptr);
+		if (id >= 0) {
+			record_ptrs[id] = res;
+			trace_push(&recorded, OP_REALLOC, id, size, 0);
+		}
+		pthread_mutex_unlock(&record_mutex);
+	}
+	return res;
+}
+
+void __wrap_vgl_free(void *ptr) {
+	if (recording && ptr) {
+		pthread_mutex_lock(&record_mutex);
+		int64_t id = record_find(ptr);
+		if (id >= 0) {
+			record_ptrs[id] = NULL;
+			trace_push(&recorded, OP_FREE, id, 0, 0);
+		}
+		pthread_mutex_unlock(&record_mutex);
+	}
+	__real_vgl_free(ptr);
+}
+
+// Streams textures and buffers of random sizes in and out as a game loading and dropping assets would
+static void record_workload() {
+	GLuint textures[WORKLOAD_TEXTURES] = {0}, buffers[WORKLOAD_BUFFERS] = {0};
+	static uint8_t pixels[512 * 512 * 4];
+	vglInit(0x100000);
+	recording = 1;
+	for (int f = 0; f < WORKLOAD_FRAMES; f++) {
+		for (int n = 0; n < 4; n++) {
+			int i = rnd() % WORKLOAD_TEXTURES;
+			if (textures[i]) {
+				glDeleteTextures(1, &textures[i]);
+				textures[i] = 0;
+			} else {
+				glGenTextures(1, &textures[i]);
+				glBindTexture(GL_TEXTURE_2D, textures[i]);
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 16 << (rnd() % 6), 16 << (rnd() % 6), 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+			}
+			i = rnd() % WORKLOAD_BUFFERS;
+			if (!buffers[i])
+				glGenBuffers(1, &buffers[i]);
+			glBindBuffer(GL_ARRAY_BUFFER, buffers[i]);
+			glBufferData(GL_ARRAY_BUFFER, 256 + rnd() % (256 * 1024), NULL, GL_STATIC_DRAW);
+		}
+		glClear(GL_COLOR_BUFFER_BIT);
+		vglSwapBuffers(GL_FALSE);
+	}
+	recorded.peak = recorded.num;
+	glDeleteTextures(WORKLOAD_TEXTURES, textures);
+	glDeleteBuffers(WORKLOAD_BUFFERS, buffers);
+	vglSwapBuffers(GL_FALSE);
+	vglSwapBuffers(GL_FALSE);
+	recording = 0;
+	vglEnd();
+
+	static uint8_t live[TRACE_MAX_OPS];
+	for (uint32_t i = 0; i < recorded.ids_num; i++) {
+		live[i] = record_ptrs[i] != NULL;
+	}
+	trace_finish(&recorded, live);
+}
+
+/*
+ * Replay
+ */
+static void *ptrs[TRACE_MAX_OPS];
+static uint32_t failed;
+
+static void replay(trace *t, uint32_t from, uint32_t to) {
+	for (uint32_t i = from; i < to; i++) {
+		trace_op *o = &t->ops[i];
+		switch (o->op) {
+		case OP_ALLOC:
+			ptrs[o->id] = __real_vgl_memalign(o->align, o->size, VGL_MEM_RAM);
+			if (!ptrs[o->id])
+				failed++;
+			break;
+		case OP_REALLOC:
+			if (ptrs[o->id]) {
+				void *res = __real_vgl_realloc(ptrs[o->id], o->size);
+				if (res)
+					ptrs[o->id] = res;
+				else
+					failed++;
+			}
+			break;
+		default:
+			if (ptrs[o->id]) {
+				__real_vgl_free(ptrs[o->id]);
+				ptrs[o->id] = NULL;
+			}
+			break;
+		}
+	}
+}
+
+// Largest block that can still be allocated, found by bisection
+static size_t largest_free() {
+	size_t lo = 0, hi = vgl_mem_get_free_space(VGL_MEM_RAM);
+	while (hi - lo > 16) {
+		size_t mid = (lo + hi) / 2;
+		void *p = __real_vgl_malloc(mid, VGL_MEM_RAM);
+		if (p) {
+			__real_vgl_free(p);
+			lo = mid;
+		} else
+			hi = mid;
+	}
+	return lo;
+}
+
+static void bench_trace(const char *name, trace *t) {
+	uint64_t ns;
+	vgl_mem_init(POOL_SIZE, 0, 0, 0);
+	failed = 0;
+	replay(t, 0, t->peak);
+	size_t free_size = vgl_mem_get_free_space(VGL_MEM_RAM);
+	size_t largest = largest_free();
+	replay(t, t->peak, t->num);
+	uint32_t fails = failed;
+	BENCH_MIN(ns, replay(t, 0, t->num));
+	vgl_mem_term();
+	printf("%-10s %7u ops: %6.1f ns/op, failed allocs %u, fragmentation %.1f%% (%zu KB free, %zu KB largest)\n", name, t->num,
+		(double)ns / t->num, fails, free_size ? 100.0 * (1.0 - (double)largest / free_size) : 0.0, free_size >> 10, largest >> 10);
+}
+
+int main(int argc, char **argv) {
+	trace random = {malloc(sizeof(trace_op) * TRACE_MAX_OPS)};
+	recorded.ops = malloc(sizeof(trace_op) * TRACE_MAX_OPS);
+	record_workload();
+	make_random_trace(&random);
+
+	printf("%s, %d MB pool\n", HEAP_NAME, POOL_SIZE >> 20);
+	bench_trace("random", &random);
+	bench_trace("workload", &recorded);
+	return 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * immediate.c:
+ * Draws, ffp shaders reloads, packed vertex bytes and CPU time per frame of glBegin/glEnd blocks, derived from
+ * the immediate_mode and immediate_mode_texture samples, against the size of the legacy vertex layout
+ */
+
+#include <stdlib.h>
+#include <vitaGL.h>
+#include <vgl_mock.h>
+
+#include "bench.h"
+
+#define QUADS_NUM 2000 // glBegin/glEnd blocks drawn every frame
+#define TEX_SIZE 64
+
+// Legacy strides of the immediate mode pipeline (LEGACY_VERTEX_STRIDE and LEGACY_NT_VERTEX_STRIDE)
+#define LEGACY_STRIDE 24
+#define LEGACY_NT_STRIDE 22
+
+extern float *legacy_pool_ptr;
+
+typedef enum {
+	TEXTURED_SINGLE_COLOR, // immediate_mode_texture with a tinted texture
+	VERTEX_COLORS, // immediate_mode
+	TEXTURED_QUAD_COLORS, // immediate_mode_texture with a color for each quad
+	FAN_COLORS, // immediate_mode with a triangle fan and a color for each quad, fans can't be merged
+	VARIANTS_NUM
+} variant;
+
+static const char *variant_names[] = {"textured, single color", "per-vertex colors", "textured, color per quad", "fans, color per quad"};
+
+static const float quad_pos[] = {0, 0, 1, 0, 1, 1, 0, 1};
+static const float quad_uv[] = {0, 1, 1, 1, 1, 0, 0, 0};
+static const float vertex_colors[] = {1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 0, 1};
+
+static float quad_x[QUADS_NUM], quad_y[QUADS_NUM], quad_size[QUADS_NUM];
+static GLuint texture;
+
+static void draw_quads(variant v) {
+	if (v == VERTEX_COLORS || v == FAN_COLORS)
+		glDisable(GL_TEXTURE_2D);
+	else {
+		glEnable(GL_TEXTURE_2D);
+		glBindTexture(GL_TEXTURE_2D, texture);
+	}
+	glColor3f(1.0f, 0.5f, 0.5f);
+	for (int i = 0; i < QUADS_NUM; i++) {
+		if (v == TEXTURED_QUAD_COLORS || v == FAN_COLORS)
+			glColor3f((i & 3) / 3.0f, ((i >> 2) & 3) / 3.0f, 1.0f);
+		glBegin(v == FAN_COLORS ? GL_TRIANGLE_FAN : GL_QUADS);
+		for (int j = 0; j < 4; j++) {
+			if (v == VERTEX_COLORS)
+				glColor3fv(&vertex_colors[j * 3]);
+			else if (v != FAN_COLORS)
+				glTexCoord2f(quad_uv[j * 2], quad_uv[j * 2 + 1]);
+			glVertex3f(quad_x[i] + quad_pos[j * 2] * quad_size[i], quad_y[i] + quad_pos[j * 2 + 1] * quad_size[i], 0);
+		}
+		glEnd();
+	}
+}
+
+static void draw_frame(variant v) {
+	glClear(GL_COLOR_BUFFER_BIT);
+	draw_quads(v);
+	vglSwapBuffers(GL_FALSE);
+}
+
+int main(int argc, char **argv) {
+	vglInit(0x800000);
+	glClearColor(0.0, 0.0, 0.0, 0.0);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glOrtho(0, 960, 544, 0, -1, 1);
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+
+	uint8_t *pixels = malloc(TEX_SIZE * TEX_SIZE * 3);
+	for (int i = 0; i < TEX_SIZE * TEX_SIZE * 3; i++)
+		pixels[i] = i * 7;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, TEX_SIZE, TEX_SIZE, 0, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	free(pixels);
+
+	srand(1);
+	for (int i = 0; i < QUADS_NUM; i++) {
+		quad_x[i] = rand() % 960;
+		quad_y[i] = rand() % 544;
+		quad_size[i] = 8 + rand() % 24;
+	}
+
+	printf("%d glBegin/glEnd blocks per frame\n", QUADS_NUM);
+	for (int v = 0; v < VARIANTS_NUM; v++) {
+		// The first frame warms up the ffp shaders cache
+		draw_frame(v);
+
+		// The legacy pool is replaced when the scene starts, so vertices are measured after the clear
+		vglMockStats before, after;
+		vglFFPCacheStats cache_before, cache_after;
+		vglMockGetStats(&before);
+		vglGetFFPCacheStats(&cache_before);
+		glClear(GL_COLOR_BUFFER_BIT);
+		float *pool_start = legacy_pool_ptr;
+		draw_quads(v);
+		uint32_t packed = (legacy_pool_ptr - pool_start) * sizeof(float);
+		vglSwapBuffers(GL_FALSE);
+		vglMockGetStats(&after);
+		vglGetFFPCacheStats(&cache_after);
+		uint32_t legacy = QUADS_NUM * 4 * (v == VERTEX_COLORS || v == FAN_COLORS ? LEGACY_NT_STRIDE : LEGACY_STRIDE) * sizeof(float);
+
+		// Blocks drawn on their own share the ffp shaders of the previous one, so they must not be selected again
+		uint32_t reloads = (cache_after.hits + cache_after.misses) - (cache_before.hits + cache_before.misses);
+
+		uint64_t ns;
+		BENCH_MIN(ns, draw_frame(v));
+		printf("  %-26s %4llu sceGxmDraw calls (clear included), %u ffp shaders reloads, %u bytes packed vs %u legacy, %.1f us CPU time\n", variant_names[v],
+			(unsigned long long)(after.cmds[VGL_MOCK_CMD_DRAW] - before.cmds[VGL_MOCK_CMD_DRAW]), reloads, packed, legacy, ns / 1000.0);
+	}
+	return 0;
+}
@@ -0,0 +1,147 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * index.c:
+ * Cost per draw of expanding the index buffer of non-native primitives (what draws did before index_cache got introduced)
+ * versus serving the conversion from the cache of converted index buffers, and of finding the highest index drawn with
+ * the scalar loop draws used to run, the range scan and the ranges cache
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "utils/index_utils.h"
+
+#include "bench.h"
+
+#define DRAWS_NUM 10000 // Draws per measure
+
+static const char *prim_names[] = {"list", "quads", "line strip", "line loop"};
+static const uint32_t counts[] = {64, 4096, 65536}; // Sprite, UI batch and mesh sized index buffers
+
+static uint16_t *src16, *dst16;
+static uint32_t *src32, *dst32;
+static index_cache cache;
+
+static void expand(uint32_t count, index_prim prim, int is_short) {
+	for (int i = 0; i < DRAWS_NUM; i++) {
+		if (is_short)
+			index_expand_u16(dst16, src16, count, 0, prim);
+		else
+			index_expand_u32(dst32, src32, count, 0, prim);
+		__asm__ volatile("" ::"r"(dst16), "r"(dst32) : "memory");
+	}
+}
+
+static void cached(uint32_t count, index_prim prim, int is_short) {
+	for (int i = 0; i < DRAWS_NUM; i++) {
+		index_cache_entry *e = index_cache_lookup(&cache, 1, 0, count, 0, prim, is_short);
+		if (!e) {
+			uint32_t dst_count = index_expanded_count(prim, count);
+			uint32_t dst_size = dst_count * (is_short ? 2 : 4);
+			void *dst = malloc(dst_size);
+			if (is_short)
+				index_expand_u16(dst, src16, count, 0, prim);
+			else
+				index_expand_u32(dst, src32, count, 0, prim);
+			index_cache_insert(&cache, 1, 0, count, 0, prim, is_short, dst, dst_count, dst_size);
+		}
+		__asm__ volatile("" ::"r"(e) : "memory");
+	}
+}
+
+// Highest index lookup as ffp.c and custom_shaders.c used to do before index_range_u16 got introduced
+static uint32_t old_top_u16(const uint16_t *src, uint32_t count) {
+	uint32_t top = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		if (src[i] > top)
+			top = src[i];
+	}
+	return top;
+}
+
+static void range_old(uint32_t count) {
+	for (int i = 0; i < DRAWS_NUM; i++) {
+		volatile uint32_t top = old_top_u16(src16, count);
+		(void)top;
+		__asm__ volatile("" ::"r"(src16) : "memory");
+	}
+}
+
+static void range_scan(uint32_t count) {
+	uint32_t lo, hi;
+	for (int i = 0; i < DRAWS_NUM; i++) {
+		index_range_u16(src16, count, &lo, &hi);
+		__asm__ volatile("" ::"r"(src16), "r"(hi) : "memory");
+	}
+}
+
+static void range_cached(index_range_cache *c, uint32_t count) {
+	uint32_t lo, hi;
+	for (int i = 0; i < DRAWS_NUM; i++) {
+		index_range_cached(c, 1, 0, src16, count, 1, &lo, &hi);
+		__asm__ volatile("" ::"r"(hi) : "memory");
+	}
+}
+
+int main(int argc, char **argv) {
+	const uint32_t max_count = counts[sizeof(counts) / sizeof(*counts) - 1];
+	src16 = malloc(max_count * 2);
+	src32 = malloc(max_count * 4);
+	dst16 = malloc(max_count * 2 * 2);
+	dst32 = malloc(max_count * 2 * 4);
+	for (uint32_t i = 0; i < max_count; i++)
+		src16[i] = src32[i] = i;
+
+	printf("Per draw cost in us, expanded every draw versus cached\n");
+	for (int is_short = 1; is_short >= 0; is_short--) {
+		for (int prim = INDEX_PRIM_QUADS; prim <= INDEX_PRIM_LINE_LOOP; prim++) {
+			for (int c = 0; c < sizeof(counts) / sizeof(*counts); c++) {
+				uint64_t t_expand, t_cached;
+				BENCH_MIN(t_expand, expand(counts[c], prim, is_short));
+				index_cache_init(&cache, free);
+				BENCH_MIN(t_cached, cached(counts[c], prim, is_short));
+				index_cache_clear(&cache);
+				printf("  %s %-10s %6u indices: %9.3f %9.3f\n", is_short ? "u16" : "u32", prim_names[prim], counts[c],
+					t_expand / 1e3 / DRAWS_NUM, t_cached / 1e3 / DRAWS_NUM);
+			}
+		}
+	}
+
+	// Shuffled mesh indices
+	srand(1);
+	for (uint32_t i = 0; i < max_count; i++)
+		src16[i] = rand() % 10000;
+	static index_range_cache range_cache;
+	printf("Highest index lookup cost per draw in us, old loop versus range scan versus cached\n");
+	for (int c = 0; c < sizeof(counts) / sizeof(*counts); c++) {
+		uint64_t t_old, t_scan, t_cached;
+		BENCH_MIN(t_old, range_old(counts[c]));
+		BENCH_MIN(t_scan, range_scan(counts[c]));
+		memset(&range_cache, 0, sizeof(range_cache));
+		BENCH_MIN(t_cached, range_cached(&range_cache, counts[c]));
+		printf("  u16 %6u indices: %9.3f %9.3f (%5.2f GB/s) %9.3f\n", counts[c], t_old / 1e3 / DRAWS_NUM, t_scan / 1e3 / DRAWS_NUM,
+			(double)counts[c] * 2 * DRAWS_NUM / t_scan, t_cached / 1e3 / DRAWS_NUM);
+	}
+
+	free(src16);
+	free(src32);
+	free(dst16);
+	free(dst32);
+	return 0;
+}
@@ -0,0 +1,89 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * lookup.c:
+ * Cost of resolving names with vglGetProcAddress against the linear table walk it replaced, for every entry,
+ * their EXT variants and the misses of a typical loader
+ */
+
+// The proc table is walked directly, so lookup.c is built as part of this program
+#include "../../source/lookup.c"
+#include "bench.h"
+
+#define PASSES_NUM 200 // Resolutions of the whole names set per measure
+#define NAME_MAX_LEN 128
+
+// Entry points loaders commonly query that vitaGL doesn't implement
+static const char *misses[] = {
+	"glDrawArraysInstanced", "glDrawElementsInstanced", "glVertexAttribDivisor", "glGenVertexArrays", "glBindVertexArray",
+	"glDeleteVertexArrays", "glBlitFramebuffer", "glRenderbufferStorageMultisample", "glTexStorage2D", "glDebugMessageCallback",
+	"glPushDebugGroup", "glObjectLabel", "glInvalidateFramebuffer", "glClearBufferfv", "glTexImage3D", "glCopyImageSubData",
+	"glGenQueries", "glBeginQuery", "glFenceSync", "glGetInteger64v",
+};
+
+#define MISSES_NUM (sizeof(misses) / sizeof(*misses))
+
+static char names[VGL_PROCS_NUM * 2 + MISSES_NUM * 3][NAME_MAX_LEN];
+static int names_num = 0;
+
+// Reference implementation, how names got resolved before being hashed
+static void *linear_lookup(const char *name) {
+	if (!name || !*name)
+		return NULL;
+	const int len = strlen(name);
+	char tmpname[len + 1];
+	memcpy(tmpname, name, len + 1);
+	if (!strcmp(tmpname + len - 3, "EXT") || !strcmp(tmpname + len - 3, "ARB") || !strcmp(tmpname + len - 3, "OES"))
+		tmpname[len - 3] = 0;
+	for (size_t i = 0; i < vgl_numproc; ++i) {
+		if (!strcmp(tmpname, vgl_proctable[i].name))
+			return vgl_proctable[i].proc;
+	}
+	return NULL;
+}
+
+static void add_name(const char *name, const char *suffix) {
+	snprintf(names[names_num++], NAME_MAX_LEN, "%s%s", name, suffix);
+}
+
+int main(int argc, char **argv) {
+	for (size_t i = 0; i < vgl_numproc; i++) {
+		add_name(vgl_proctable[i].name, "");
+		add_name(vgl_proctable[i].name, "EXT");
+	}
+	for (int i = 0; i < MISSES_NUM; i++) {
+		add_name(misses[i], "");
+		add_name(misses[i], "EXT");
+		add_name(misses[i], "ARB");
+	}
+	int found = 0;
+	for (int i = 0; i < names_num; i++) {
+		found += linear_lookup(names[i]) != NULL;
+	}
+
+	void *volatile sink;
+	uint64_t linear_ns, hash_ns;
+	BENCH_MIN(linear_ns, for (int p = 0; p < PASSES_NUM; p++) for (int i = 0; i < names_num; i++) sink = linear_lookup(names[i]));
+	BENCH_MIN(hash_ns, for (int p = 0; p < PASSES_NUM; p++) for (int i = 0; i < names_num; i++) sink = vglGetProcAddress(names[i]));
+	(void)sink;
+	printf("%d names (%d found)\n", names_num, found);
+	printf("  %-12s %7.1f ns per lookup\n", "linear walk", (double)linear_ns / PASSES_NUM / names_num);
+	printf("  %-12s %7.1f ns per lookup\n", "hash", (double)hash_ns / PASSES_NUM / names_num);
+	return 0;
+}
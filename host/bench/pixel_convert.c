@@ -0,0 +1,84 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * pixel_convert.c:
+ * Benchmark for texture uploads conversions, per pixel callbacks versus row converters
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "utils/pixel_utils.h"
+#include "texture_callbacks.h"
+
+#include "bench.h"
+
+#define PIXELS_NUM (1024 * 1024) // Pixels converted per run
+
+typedef struct {
+	const char *name;
+	uint32_t (*read)(void *);
+	uint8_t bpp;
+} read_fmt;
+
+typedef struct {
+	const char *name;
+	void (*write)(void *, uint32_t);
+	uint8_t bpp;
+} write_fmt;
+
+static const read_fmt reads[] = {
+	{"RGBA8", readRGBA, 4}, {"BGRA8", readBGRA, 4}, {"RGB8", readRGB, 3}, {"LA8", readLA, 2},
+	{"L8", readL, 1}, {"RGB565", readRGB565, 2}, {"RGBA5551", readRGBA5551, 2}, {"RGBA4444", readRGBA4444, 2}
+};
+
+static const write_fmt writes[] = {
+	{"RGBA8", writeRGBA, 4}, {"RGB8", writeRGB, 3}, {"LA8", writeRA, 2}
+};
+
+static void convert_pixels(const read_fmt *r, const write_fmt *w, uint8_t *dst, uint8_t *src, uint32_t num) {
+	for (uint32_t i = 0; i < num; i++) {
+		w->write(dst, r->read(src));
+		src += r->bpp;
+		dst += w->bpp;
+	}
+}
+
+int main(int argc, char **argv) {
+	uint8_t *src = malloc(PIXELS_NUM * 4), *dst = malloc(PIXELS_NUM * 4);
+	for (int i = 0; i < PIXELS_NUM * 4; i++) {
+		src[i] = rand();
+	}
+
+	printf("%-9s -> %-6s %12s %12s\n", "source", "dest", "callbacks", "row");
+	for (int i = 0; i < sizeof(reads) / sizeof(*reads); i++) {
+		for (int j = 0; j < sizeof(writes) / sizeof(*writes); j++) {
+			const read_fmt *r = &reads[i];
+			const write_fmt *w = &writes[j];
+			pixel_row_cb convert_row = getRowConverter(r->read, w->write);
+			uint64_t cb_ns, row_ns;
+			BENCH_MIN(cb_ns, convert_pixels(r, w, dst, src, PIXELS_NUM));
+			BENCH_MIN(row_ns, convert_row(dst, src, PIXELS_NUM));
+			printf("%-9s -> %-6s %6.2f Gpx/s %6.2f Gpx/s\n", r->name, w->name, (double)PIXELS_NUM / cb_ns, (double)PIXELS_NUM / row_ns);
+		}
+	}
+
+	free(src);
+	free(dst);
+	return 0;
+}
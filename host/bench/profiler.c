@@ -0,0 +1,60 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * profiler.c:
+ * Cost of a profiling zone, recorded into the thread ring and aggregates or compiled out, next to the cost
+ * of the kernel calls a zone is made of
+ */
+
+#include <psp2/kernel/processmgr.h>
+#include <psp2/kernel/threadmgr.h>
+#include <vitaGL.h>
+#include "utils/profiler_utils.h"
+
+#include "bench.h"
+
+#define CALLS_NUM 2000000 // Calls per measure
+
+static volatile int sink;
+
+__attribute__((noinline)) static void zone(void) {
+	PROFILE_ZONE(CALL_LIST);
+	sink++;
+}
+
+__attribute__((noinline)) static void no_zone(void) {
+	sink++;
+}
+
+int main(int argc, char **argv) {
+	uint64_t ns;
+#ifdef HAVE_PROFILER
+	BENCH_MIN(ns, for (int i = 0; i < CALLS_NUM; i++) zone());
+	printf("%-28s %6.1f ns\n", "zone", (double)ns / CALLS_NUM);
+#else
+	printf("built without PROFILER=1, zones are compiled out\n");
+#endif
+	BENCH_MIN(ns, for (int i = 0; i < CALLS_NUM; i++) no_zone());
+	printf("%-28s %6.1f ns\n", "no zone", (double)ns / CALLS_NUM);
+	BENCH_MIN(ns, for (int i = 0; i < CALLS_NUM; i++) sceKernelGetProcessTimeWide());
+	printf("%-28s %6.1f ns\n", "sceKernelGetProcessTimeWide", (double)ns / CALLS_NUM);
+	BENCH_MIN(ns, for (int i = 0; i < CALLS_NUM; i++) sceKernelGetThreadId());
+	printf("%-28s %6.1f ns\n", "sceKernelGetThreadId", (double)ns / CALLS_NUM);
+	return 0;
+}
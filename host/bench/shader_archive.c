@@ -0,0 +1,152 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * shader_archive.c:
+ * Lookup cost of ffp shaders stored as one file per binary (the layout shader_archive_utils.c replaced)
+ * versus the packed archive, for hits and misses with a warm page cache
+ */
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "utils/shader_archive_utils.h"
+
+#include "bench.h"
+
+#define BENCH_DIR "shader_archive_bench"
+#define ARCHIVE_PATH BENCH_DIR "/ffp.vgsa"
+#define VARIANTS_NUM 4000 // Shaders pairs looked up
+
+static uint8_t blob[4096];
+
+static uint32_t blob_size(int i) {
+	return 1024 + (i * 37) % 3072;
+}
+
+static void blob_name(char *dst, int i, int stage) {
+	sprintf(dst, BENCH_DIR "/v13-%08X-%016llX_%c.gxp", i * 7919, (unsigned long long)i * 104729, stage ? 'f' : 'v');
+}
+
+static void clear_dir(void) {
+	DIR *d = opendir(BENCH_DIR);
+	if (d) {
+		char path[512];
+		struct dirent *e;
+		while ((e = readdir(d))) {
+			sprintf(path, BENCH_DIR "/%s", e->d_name);
+			if (e->d_name[0] != '.')
+				remove(path);
+		}
+		closedir(d);
+	}
+	mkdir(BENCH_DIR, 0777);
+}
+
+// Same steps the ffp shaders cache took per binary before the archive
+static void files_hits(void) {
+	char name[256];
+	for (int i = 0; i < VARIANTS_NUM; i++) {
+		for (int s = 0; s < 2; s++) {
+			blob_name(name, i, s);
+			FILE *f = fopen(name, "rb");
+			fseek(f, 0, SEEK_END);
+			long size = ftell(f);
+			fseek(f, 0, SEEK_SET);
+			void *p = malloc(size);
+			fread(p, 1, size, f);
+			fclose(f);
+			free(p);
+		}
+	}
+}
+
+static void files_misses(void) {
+	char name[256];
+	for (int i = 0; i < VARIANTS_NUM; i++) {
+		blob_name(name, VARIANTS_NUM + i, 0);
+		FILE *f = fopen(name, "rb");
+		if (f)
+			fclose(f);
+	}
+}
+
+static void archive_hits(shader_archive *a) {
+	char name[256];
+	for (int i = 0; i < VARIANTS_NUM; i++) {
+		for (int s = 0; s < 2; s++) {
+			blob_name(name, i, s);
+			const shader_archive_entry *e = shader_archive_find(a, shader_archive_key(name));
+			void *p = malloc(e->size);
+			shader_archive_read(a, e, p);
+			free(p);
+		}
+	}
+}
+
+static void archive_misses(shader_archive *a) {
+	char name[256];
+	for (int i = 0; i < VARIANTS_NUM; i++) {
+		blob_name(name, VARIANTS_NUM + i, 0);
+		shader_archive_find(a, shader_archive_key(name));
+	}
+}
+
+int main(int argc, char **argv) {
+	shader_archive a;
+	char name[256];
+	uint64_t ns;
+	clear_dir();
+	for (int i = 0; i < VARIANTS_NUM; i++) {
+		for (int s = 0; s < 2; s++) {
+			blob_name(name, i, s);
+			for (uint32_t j = 0; j < blob_size(i + s); j++)
+				blob[j] = i + s + j;
+			FILE *f = fopen(name, "wb");
+			fwrite(blob, 1, blob_size(i + s), f);
+			fclose(f);
+		}
+	}
+
+	printf("%d variants, 2 stages each\n", VARIANTS_NUM);
+	BENCH_MIN(ns, files_hits());
+	printf("  per-file  hits   %8.2f ms\n", ns / 1e6);
+	BENCH_MIN(ns, files_misses());
+	printf("  per-file  misses %8.2f ms\n", ns / 1e6);
+
+	uint64_t t = bench_now();
+	shader_archive_open(&a, ARCHIVE_PATH, 13);
+	shader_archive_import_dir(&a, BENCH_DIR, "v13-", ".gxp", 1);
+	shader_archive_compact(&a);
+	printf("  archive   import and compaction %8.2f ms\n", (bench_now() - t) / 1e6);
+	shader_archive_close(&a);
+	BENCH_MIN(ns, shader_archive_open(&a, ARCHIVE_PATH, 13); shader_archive_close(&a));
+	printf("  archive   open   %8.2f ms\n", ns / 1e6);
+	shader_archive_open(&a, ARCHIVE_PATH, 13);
+	BENCH_MIN(ns, archive_hits(&a));
+	printf("  archive   hits   %8.2f ms\n", ns / 1e6);
+	BENCH_MIN(ns, archive_misses(&a));
+	printf("  archive   misses %8.2f ms\n", ns / 1e6);
+	shader_archive_close(&a);
+
+	clear_dir();
+	rmdir(BENCH_DIR);
+	return 0;
+}
@@ -0,0 +1,212 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * stream.c:
+ * Client arrays streaming on Quake-like and Lugaru-like frames, one heap allocation per draw (the path stream_utils.c replaced)
+ * versus the fenced rings with copies de-duplication, every copy is checked against its source when the simulated GPU reads it
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "utils/stream_utils.h"
+
+#include "bench.h"
+
+#define GPU_LATENCY 2 // Scenes the simulated GPU lags behind the CPU
+#define CHECKS_MAX 8192 // Copies the simulated GPU can have in flight
+
+// Copy awaiting to be read by the simulated GPU with a snapshot of what it must contain
+typedef struct {
+	void *copy;
+	uint8_t *snapshot;
+	uint32_t size;
+	uint32_t seq;
+} gpu_read;
+
+static stream_pool pool;
+static uint32_t ring_size;
+static uint32_t seq, completed;
+static gpu_read reads[CHECKS_MAX];
+static uint32_t reads_num;
+static uint32_t mismatches;
+static uint64_t heap_allocs, heap_bytes; // Traffic of the old path
+static uint64_t fallback_allocs; // Allocations no ring could serve
+static int use_rings;
+
+static void gpu_complete(uint32_t s) {
+	for (uint32_t i = 0; i < reads_num; i++) {
+		gpu_read *r = &reads[i];
+		if (r->seq > s)
+			continue;
+		if (memcmp(r->copy, r->snapshot, r->size))
+			mismatches++;
+		free(r->snapshot);
+		if (!use_rings)
+			free(r->copy);
+		*r = reads[--reads_num];
+		i--;
+	}
+	completed = s;
+}
+
+static void end_scene(void) {
+	seq++;
+	if (use_rings) {
+		stream_pool_fence(&pool, seq);
+		stream_pool_retire(&pool, completed);
+	}
+	if (seq > GPU_LATENCY)
+		gpu_complete(seq - GPU_LATENCY);
+}
+
+// Mirrors gpu_alloc_stream, garbage collected memory is modeled with a leak
+static void *alloc_stream(uint32_t size) {
+	void *res = stream_pool_alloc(&pool, size);
+	if (!res) {
+		stream_pool_retire(&pool, completed);
+		res = stream_pool_alloc(&pool, size);
+		if (!res && !pool.rings[STREAM_RINGS_NUM - 1].base) {
+			stream_ring_init(&pool.rings[STREAM_RINGS_NUM - 1], malloc(ring_size), ring_size);
+			res = stream_pool_alloc(&pool, size);
+		}
+		if (!res) {
+			fallback_allocs++;
+			res = malloc(size);
+		}
+	}
+	return res;
+}
+
+static void client_array(const void *src, uint32_t stride, uint32_t count) {
+	uint32_t size = stride * count;
+	void *res;
+	if (use_rings) {
+		stream_cache_entry *slot;
+		res = stream_pool_lookup(&pool, src, stride, count, &slot);
+		if (!res) {
+			res = alloc_stream(size);
+			memcpy(res, src, size);
+			stream_pool_store(&pool, slot, src, stride, count, res);
+		}
+	} else {
+		res = malloc(size);
+		memcpy(res, src, size);
+		heap_allocs++;
+		heap_bytes += size;
+	}
+	gpu_read *r = &reads[reads_num++];
+	r->copy = res;
+	r->size = size;
+	r->seq = seq + 1;
+	r->snapshot = malloc(size);
+	memcpy(r->snapshot, src, size);
+}
+
+// Unique world polys, alias models and particles going through scratch arrays rewritten before every draw
+static float world[2000][10 * 7];
+static float scratch[1024 * 8];
+
+static void quake_frame(void) {
+	for (int i = 0; i < 600; i++)
+		client_array(world[rand() % 2000], 28, 4 + rand() % 7);
+	for (int i = 0; i < 30; i++) {
+		for (int j = 0; j < 300 * 8; j++)
+			scratch[j] = rand();
+		client_array(scratch, 32, 300);
+	}
+	end_scene();
+	for (int i = 0; i < 40; i++) {
+		for (int j = 0; j < 64 * 6; j++)
+			scratch[j] = rand();
+		client_array(scratch, 24, 64);
+	}
+	end_scene();
+}
+
+// Static models drawn several times per scene (shadow, reflection and color passes of several instances) and unique terrain patches
+static float models[12][1000 * 8];
+static float terrain[64][1024 * 8];
+
+static void lugaru_frame(void) {
+	for (int pass = 0; pass < 3; pass++) {
+		for (int i = 0; i < 12; i++) {
+			for (int inst = 0; inst < 4; inst++)
+				client_array(models[i], 32, 1000);
+		}
+	}
+	for (int i = 0; i < 64; i++)
+		client_array(terrain[i], 32, 1024);
+	end_scene();
+	for (int i = 0; i < 12; i++)
+		client_array(models[i], 32, 1000);
+	end_scene();
+}
+
+static void run(const char *name, void (*frame)(void), uint32_t size, int frames, int rings) {
+	stream_pool_init(&pool);
+	ring_size = size;
+	use_rings = rings;
+	if (rings)
+		stream_ring_init(&pool.rings[0], malloc(size), size);
+	seq = completed = 0;
+	mismatches = 0;
+	heap_allocs = heap_bytes = fallback_allocs = 0;
+	srand(1);
+
+	// Verification snapshots dominate timings, so only the memory traffic is reported
+	for (int i = 0; i < frames; i++)
+		frame();
+	gpu_complete(seq);
+
+	printf("  %-7s", name);
+	if (rings) {
+		printf(" rings %4u KiB: %7.1f ring allocs %5.2f heap allocs, %8.0f copied %8.0f hashed %8.0f reused bytes, overflow ring %s",
+			size / 1024, (double)pool.stats.allocs / frames, (double)fallback_allocs / frames,
+			(double)pool.stats.bytes_copied / frames, (double)pool.stats.bytes_hashed / frames, (double)pool.stats.bytes_reused / frames,
+			pool.rings[1].base ? "used" : "unused");
+	} else
+		printf(" heap:           %7.1f heap allocs, %8.0f copied bytes", (double)heap_allocs / frames, (double)heap_bytes / frames);
+	printf(", %s\n", mismatches ? "DATA MISMATCH" : "data ok");
+	for (int i = 0; i < STREAM_RINGS_NUM; i++)
+		free(pool.rings[i].base);
+}
+
+int main(int argc, char **argv) {
+	for (int i = 0; i < 2000; i++) {
+		for (int j = 0; j < 10 * 7; j++)
+			world[i][j] = rand();
+	}
+	for (int i = 0; i < 12; i++) {
+		for (int j = 0; j < 1000 * 8; j++)
+			models[i][j] = rand();
+	}
+	for (int i = 0; i < 64; i++) {
+		for (int j = 0; j < 1024 * 8; j++)
+			terrain[i][j] = rand();
+	}
+
+	printf("Per frame client arrays traffic\n");
+	run("quake", quake_frame, 4 << 20, 200, 0);
+	run("quake", quake_frame, 4 << 20, 200, 1);
+	run("quake", quake_frame, 256 << 10, 200, 1);
+	run("lugaru", lugaru_frame, 4 << 20, 100, 0);
+	run("lugaru", lugaru_frame, 4 << 20, 100, 1);
+	run("lugaru", lugaru_frame, 1 << 20, 50, 1);
+	return 0;
+}
@@ -0,0 +1,141 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * uniforms.c:
+ * Custom shaders uniforms upload cost, one sceGxmSetUniformDataF per uniform at every draw (the path uniform_utils.c replaced)
+ * versus flattened blocks copied once into the pool, at growing uniforms counts and change rates
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "../src/mock.h"
+#include "utils/uniform_utils.h"
+
+#include "bench.h"
+
+#define DRAWS_NUM 200 // Draws per frame
+#define FRAMES_NUM 50
+#define POOL_SIZE (2 * 1024 * 1024)
+
+// Uniform of a custom program, as kept by custom_shaders.c
+typedef struct {
+	SceGxmProgramParameter param;
+	float *data;
+	uint32_t size; // Number of components
+} bench_uniform;
+
+typedef struct {
+	bench_uniform *unifs;
+	uint32_t num;
+	uniform_block block;
+} bench_program;
+
+static uint8_t pool_mem[POOL_SIZE];
+
+// Mix of vec4, mat4 and vec3[4] uniforms
+static void make_program(bench_program *p, uint32_t num) {
+	uint32_t res_idx = 0;
+	p->unifs = calloc(num, sizeof(bench_uniform));
+	p->num = num;
+	for (uint32_t i = 0; i < num; i++) {
+		SceGxmProgramParameter *param = &p->unifs[i].param;
+		static const uint8_t comps[] = {4, 16, 3};
+		static const uint32_t arrays[] = {1, 1, 4};
+		param->category = SCE_GXM_PARAMETER_CATEGORY_UNIFORM;
+		param->type = SCE_GXM_PARAMETER_TYPE_F32;
+		param->component_count = comps[i % 3];
+		param->array_size = arrays[i % 3];
+		param->resource_index = res_idx;
+		p->unifs[i].size = param->component_count * param->array_size;
+		p->unifs[i].data = calloc(p->unifs[i].size, sizeof(float));
+		res_idx += p->unifs[i].size;
+	}
+	uniform_block_init(&p->block, res_idx * 4);
+}
+
+static void free_program(bench_program *p) {
+	for (uint32_t i = 0; i < p->num; i++)
+		free(p->unifs[i].data);
+	free(p->unifs);
+	uniform_block_term(&p->block);
+}
+
+// glUniform* call changing one uniform every change_rate draws
+static void change_uniform(bench_program *p, uint32_t draw, uint32_t change_rate, int flattened) {
+	if (!change_rate || draw % change_rate)
+		return;
+	bench_uniform *u = &p->unifs[(draw / change_rate) % p->num];
+	u->data[0] += 1.0f;
+	if (flattened) {
+		sceGxmSetUniformDataF(p->block.data, &u->param, 0, u->size, u->data);
+		p->block.dirty = 1;
+	}
+}
+
+static void run_legacy(bench_program *p, uniform_pool *pool, uint32_t change_rate) {
+	for (int f = 0; f < FRAMES_NUM; f++) {
+		for (uint32_t d = 0; d < DRAWS_NUM; d++) {
+			change_uniform(p, d, change_rate, 0);
+			void *buf = uniform_pool_reserve(pool, p->block.size);
+			for (uint32_t i = 0; i < p->num; i++)
+				sceGxmSetUniformDataF(buf, &p->unifs[i].param, 0, p->unifs[i].size, p->unifs[i].data);
+		}
+	}
+}
+
+static void run_flattened(bench_program *p, uniform_pool *pool, uniform_stats *stats, uint32_t change_rate) {
+	for (int f = 0; f < FRAMES_NUM; f++) {
+		for (uint32_t d = 0; d < DRAWS_NUM; d++) {
+			change_uniform(p, d, change_rate, 1);
+			uniform_block_upload(&p->block, pool, stats);
+		}
+	}
+}
+
+int main(int argc, char **argv) {
+	static const uint32_t counts[] = {5, 50, 500};
+	static const uint32_t change_rates[] = {1, 10, 0};
+	const double draws = DRAWS_NUM * FRAMES_NUM;
+	uniform_pool pool;
+	uniform_stats stats;
+	uint64_t legacy_ns, flattened_ns;
+
+	printf("uniforms  block size  changes             legacy       flattened  uploads  reuses\n");
+	for (int i = 0; i < sizeof(counts) / sizeof(*counts); i++) {
+		for (int j = 0; j < sizeof(change_rates) / sizeof(*change_rates); j++) {
+			bench_program p;
+			make_program(&p, counts[i]);
+			uniform_pool_init(&pool, pool_mem, POOL_SIZE);
+			BENCH_MIN(legacy_ns, run_legacy(&p, &pool, change_rates[j]));
+			uniform_pool_init(&pool, pool_mem, POOL_SIZE);
+			BENCH_MIN(flattened_ns, memset(&stats, 0, sizeof(stats)); run_flattened(&p, &pool, &stats, change_rates[j]));
+			char changes[32];
+			if (change_rates[j] == 1)
+				strcpy(changes, "every draw");
+			else if (change_rates[j])
+				snprintf(changes, sizeof(changes), "every %u draws", change_rates[j]);
+			else
+				strcpy(changes, "never");
+			printf("%8u  %8u B  %-14s %7.1f ns/draw %7.1f ns/draw  %7u  %6u\n", counts[i], p.block.size, changes,
+				legacy_ns / draws, flattened_ns / draws, stats.uploads, stats.reuses);
+			free_program(&p);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,61 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * math_neon.h:
+ * Host replacement for the math-neon subset used by vitaGL (NOTE: plain C implementations)
+ */
+
+#ifndef _MATH_NEON_H_
+#define _MATH_NEON_H_
+
+#include <math.h>
+
+// Column-major 4x4 matrix product (d = m0 * m1)
+static inline void matmul4_neon(float m0[16], float m1[16], float d[16]) {
+	float r[16];
+	int i, j;
+	for (i = 0; i < 4; i++) {
+		for (j = 0; j < 4; j++) {
+			r[i * 4 + j] = m0[j] * m1[i * 4] + m0[4 + j] * m1[i * 4 + 1] + m0[8 + j] * m1[i * 4 + 2] + m0[12 + j] * m1[i * 4 + 3];
+		}
+	}
+	for (i = 0; i < 16; i++) {
+		d[i] = r[i];
+	}
+}
+
+static inline void sincosf_neon(float x, float r[2]) {
+	r[0] = sinf(x);
+	r[1] = cosf(x);
+}
+
+static inline float tanf_neon(float x) {
+	return tanf(x);
+}
+
+static inline void normalize4_neon(float v[4], float d[4]) {
+	float len = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2] + v[3] * v[3]);
+	float inv = len > 0.0f ? 1.0f / len : 0.0f;
+	d[0] = v[0] * inv;
+	d[1] = v[1] * inv;
+	d[2] = v[2] * inv;
+	d[3] = v[3] * inv;
+}
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * appmgr.h:
+ * Host replacement for the sceAppMgr subset used by vitaGL
+ */
+
+#ifndef _PSP2_APPMGR_H_
+#define _PSP2_APPMGR_H_
+
+#include <psp2/types.h>
+
+typedef struct SceAppMgrBudgetInfo {
+	int size;
+	int mode;
+	int unk0;
+	unsigned int budget_main;
+	unsigned int free_main;
+	unsigned int unk1;
+	unsigned int unk2;
+	unsigned int budget_cdram;
+	unsigned int free_cdram;
+	unsigned int reserved_1;
+	unsigned int budget_phycont;
+	unsigned int free_phycont;
+	unsigned int total_phycont_mem;
+	unsigned int free_phycont_mem;
+	unsigned int free_user_rw;
+	unsigned int reserved[3];
+} SceAppMgrBudgetInfo;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int sceAppMgrGetBudgetInfo(SceAppMgrBudgetInfo *info);
+int sceAppMgrAppParamGetString(int pid, int param, char *string, int length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
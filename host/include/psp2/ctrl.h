@@ -0,0 +1,84 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * ctrl.h:
+ * Host replacement for the sceCtrl subset used by the samples (NOTE: no button is ever reported as pressed)
+ */
+
+#ifndef _PSP2_CTRL_H_
+#define _PSP2_CTRL_H_
+
+#include <psp2/types.h>
+
+typedef enum SceCtrlButtons {
+	SCE_CTRL_SELECT = 0x00000001,
+	SCE_CTRL_START = 0x00000008,
+	SCE_CTRL_UP = 0x00000010,
+	SCE_CTRL_RIGHT = 0x00000020,
+	SCE_CTRL_DOWN = 0x00000040,
+	SCE_CTRL_LEFT = 0x00000080,
+	SCE_CTRL_LTRIGGER = 0x00000100,
+	SCE_CTRL_RTRIGGER = 0x00000200,
+	SCE_CTRL_TRIANGLE = 0x00001000,
+	SCE_CTRL_CIRCLE = 0x00002000,
+	SCE_CTRL_CROSS = 0x00004000,
+	SCE_CTRL_SQUARE = 0x00008000
+} SceCtrlButtons;
+
+typedef enum SceCtrlPadInputMode {
+	SCE_CTRL_MODE_DIGITAL = 0,
+	SCE_CTRL_MODE_ANALOG = 1,
+	SCE_CTRL_MODE_ANALOG_WIDE = 2
+} SceCtrlPadInputMode;
+
+typedef struct SceCtrlData {
+	uint64_t timeStamp;
+	unsigned int buttons;
+	unsigned char lx;
+	unsigned char ly;
+	unsigned char rx;
+	unsigned char ry;
+	uint8_t up;
+	uint8_t right;
+	uint8_t down;
+	uint8_t left;
+	uint8_t lt;
+	uint8_t rt;
+	uint8_t l1;
+	uint8_t r1;
+	uint8_t triangle;
+	uint8_t circle;
+	uint8_t cross;
+	uint8_t square;
+	uint8_t reserved[4];
+} SceCtrlData;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int sceCtrlSetSamplingMode(SceCtrlPadInputMode mode);
+int sceCtrlPeekBufferPositive(int port, SceCtrlData *pad_data, int count);
+int sceCtrlReadBufferPositive(int port, SceCtrlData *pad_data, int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
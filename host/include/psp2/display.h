@@ -0,0 +1,61 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * display.h:
+ * Host replacement for the sceDisplay subset used by vitaGL
+ */
+
+#ifndef _PSP2_DISPLAY_H_
+#define _PSP2_DISPLAY_H_
+
+#include <psp2/types.h>
+
+typedef enum SceDisplayPixelFormat {
+	SCE_DISPLAY_PIXELFORMAT_A8B8G8R8 = 0x00000000U
+} SceDisplayPixelFormat;
+
+typedef enum SceDisplaySetBufSync {
+	SCE_DISPLAY_SETBUF_IMMEDIATE = 0,
+	SCE_DISPLAY_SETBUF_NEXTFRAME = 1
+} SceDisplaySetBufSync;
+
+typedef struct SceDisplayFrameBuf {
+	SceSize size;
+	void *base;
+	unsigned int pitch;
+	unsigned int pixelformat;
+	unsigned int width;
+	unsigned int height;
+} SceDisplayFrameBuf;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int sceDisplaySetFrameBuf(const SceDisplayFrameBuf *pParam, SceDisplaySetBufSync sync);
+int sceDisplayGetFrameBuf(SceDisplayFrameBuf *pParam, SceDisplaySetBufSync sync);
+int sceDisplayGetMaximumFrameBufResolution(int *width, int *height);
+int sceDisplayWaitVblankStart(void);
+int sceDisplayWaitVblankStartMulti(unsigned int vcount);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
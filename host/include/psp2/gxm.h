@@ -0,0 +1,732 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * gxm.h:
+ * Host replacement for the sceGxm subset used by vitaGL (NOTE: enum values mirror vitasdk ones)
+ */
+
+#ifndef _PSP2_GXM_H_
+#define _PSP2_GXM_H_
+
+#include <psp2/types.h>
+
+#define SCE_GXM_MINIMUM_CONTEXT_HOST_MEM_SIZE 2048
+#define SCE_GXM_DEFAULT_PARAMETER_BUFFER_SIZE 0x01000000
+#define SCE_GXM_DEFAULT_VDM_RING_BUFFER_SIZE 0x00020000
+#define SCE_GXM_DEFAULT_VERTEX_RING_BUFFER_SIZE 0x00200000
+#define SCE_GXM_DEFAULT_FRAGMENT_RING_BUFFER_SIZE 0x00080000
+#define SCE_GXM_DEFAULT_FRAGMENT_USSE_RING_BUFFER_SIZE 0x00004000
+#define SCE_GXM_TILE_SIZEX 32
+#define SCE_GXM_TILE_SIZEY 32
+#define SCE_GXM_MAX_VERTEX_ATTRIBUTES 16
+#define SCE_GXM_MAX_VERTEX_STREAMS 16
+#define SCE_GXM_MAX_TEXTURE_UNITS 16
+
+#define SCE_GXM_ERROR_INVALID_VALUE 0x805B0001
+#define SCE_GXM_ERROR_INVALID_POINTER 0x805B0002
+#define SCE_GXM_ERROR_OUT_OF_MEMORY 0x805B0006
+#define SCE_GXM_ERROR_NOT_WITHIN_SCENE 0x805B000A
+#define SCE_GXM_ERROR_WITHIN_SCENE 0x805B000B
+#define SCE_GXM_ERROR_NULL_PROGRAM 0x805B000C
+
+typedef enum SceGxmMemoryAttribFlags {
+	SCE_GXM_MEMORY_ATTRIB_READ = 1,
+	SCE_GXM_MEMORY_ATTRIB_WRITE = 2,
+	SCE_GXM_MEMORY_ATTRIB_RW = (SCE_GXM_MEMORY_ATTRIB_READ | SCE_GXM_MEMORY_ATTRIB_WRITE)
+} SceGxmMemoryAttribFlags;
+
+typedef enum SceGxmAttributeFormat {
+	SCE_GXM_ATTRIBUTE_FORMAT_U8,
+	SCE_GXM_ATTRIBUTE_FORMAT_S8,
+	SCE_GXM_ATTRIBUTE_FORMAT_U16,
+	SCE_GXM_ATTRIBUTE_FORMAT_S16,
+	SCE_GXM_ATTRIBUTE_FORMAT_U8N,
+	SCE_GXM_ATTRIBUTE_FORMAT_S8N,
+	SCE_GXM_ATTRIBUTE_FORMAT_U16N,
+	SCE_GXM_ATTRIBUTE_FORMAT_S16N,
+	SCE_GXM_ATTRIBUTE_FORMAT_F16,
+	SCE_GXM_ATTRIBUTE_FORMAT_F32,
+	SCE_GXM_ATTRIBUTE_FORMAT_UNTYPED
+} SceGxmAttributeFormat;
+
+typedef enum SceGxmDepthStencilFormat {
+	SCE_GXM_DEPTH_STENCIL_FORMAT_DF32 = 0x00044000,
+	SCE_GXM_DEPTH_STENCIL_FORMAT_S8 = 0x00022000,
+	SCE_GXM_DEPTH_STENCIL_FORMAT_D16 = 0x02444000,
+	SCE_GXM_DEPTH_STENCIL_FORMAT_S8D24 = 0x01266000,
+	SCE_GXM_DEPTH_STENCIL_FORMAT_DF32M = 0x00044000,
+	SCE_GXM_DEPTH_STENCIL_FORMAT_DF32M_S8 = 0x00066000
+} SceGxmDepthStencilFormat;
+
+typedef enum SceGxmPrimitiveType {
+	SCE_GXM_PRIMITIVE_TRIANGLES = 0x00000000,
+	SCE_GXM_PRIMITIVE_LINES = 0x04000000,
+	SCE_GXM_PRIMITIVE_POINTS = 0x08000000,
+	SCE_GXM_PRIMITIVE_TRIANGLE_STRIP = 0x0C000000,
+	SCE_GXM_PRIMITIVE_TRIANGLE_FAN = 0x10000000,
+	SCE_GXM_PRIMITIVE_TRIANGLE_EDGES = 0x14000000
+} SceGxmPrimitiveType;
+
+typedef enum SceGxmIndexFormat {
+	SCE_GXM_INDEX_FORMAT_U16 = 0x00000000,
+	SCE_GXM_INDEX_FORMAT_U32 = 0x01000000
+} SceGxmIndexFormat;
+
+typedef enum SceGxmIndexSource {
+	SCE_GXM_INDEX_SOURCE_INDEX_16BIT = 0x00000000,
+	SCE_GXM_INDEX_SOURCE_INDEX_32BIT = 0x00000001,
+	SCE_GXM_INDEX_SOURCE_INSTANCE_16BIT = 0x00000002,
+	SCE_GXM_INDEX_SOURCE_INSTANCE_32BIT = 0x00000003
+} SceGxmIndexSource;
+
+typedef enum SceGxmCullMode {
+	SCE_GXM_CULL_NONE = 0x00000000,
+	SCE_GXM_CULL_CW = 0x00000001,
+	SCE_GXM_CULL_CCW = 0x00000002
+} SceGxmCullMode;
+
+typedef enum SceGxmTwoSidedMode {
+	SCE_GXM_TWO_SIDED_DISABLED = 0x00000000,
+	SCE_GXM_TWO_SIDED_ENABLED = 0x00000800
+} SceGxmTwoSidedMode;
+
+typedef enum SceGxmDepthFunc {
+	SCE_GXM_DEPTH_FUNC_NEVER = 0x00000000,
+	SCE_GXM_DEPTH_FUNC_LESS = 0x00400000,
+	SCE_GXM_DEPTH_FUNC_EQUAL = 0x00800000,
+	SCE_GXM_DEPTH_FUNC_LESS_EQUAL = 0x00C00000,
+	SCE_GXM_DEPTH_FUNC_GREATER = 0x01000000,
+	SCE_GXM_DEPTH_FUNC_NOT_EQUAL = 0x01400000,
+	SCE_GXM_DEPTH_FUNC_GREATER_EQUAL = 0x01800000,
+	SCE_GXM_DEPTH_FUNC_ALWAYS = 0x01C00000
+} SceGxmDepthFunc;
+
+typedef enum SceGxmDepthWriteMode {
+	SCE_GXM_DEPTH_WRITE_DISABLED = 0x00100000,
+	SCE_GXM_DEPTH_WRITE_ENABLED = 0x00000000
+} SceGxmDepthWriteMode;
+
+typedef enum SceGxmFragmentProgramMode {
+	SCE_GXM_FRAGMENT_PROGRAM_DISABLED = 0x00200000,
+	SCE_GXM_FRAGMENT_PROGRAM_ENABLED = 0x00000000
+} SceGxmFragmentProgramMode;
+
+typedef enum SceGxmPolygonMode {
+	SCE_GXM_POLYGON_MODE_TRIANGLE_FILL = 0x00000000,
+	SCE_GXM_POLYGON_MODE_LINE = 0x00008000,
+	SCE_GXM_POLYGON_MODE_POINT_10UV = 0x00010000,
+	SCE_GXM_POLYGON_MODE_POINT = 0x00018000,
+	SCE_GXM_POLYGON_MODE_POINT_01UV = 0x00020000,
+	SCE_GXM_POLYGON_MODE_TRIANGLE_LINE = 0x00028000,
+	SCE_GXM_POLYGON_MODE_TRIANGLE_POINT = 0x00030000
+} SceGxmPolygonMode;
+
+typedef enum SceGxmStencilFunc {
+	SCE_GXM_STENCIL_FUNC_NEVER = 0x00000000,
+	SCE_GXM_STENCIL_FUNC_LESS = 0x02000000,
+	SCE_GXM_STENCIL_FUNC_EQUAL = 0x04000000,
+	SCE_GXM_STENCIL_FUNC_LESS_EQUAL = 0x06000000,
+	SCE_GXM_STENCIL_FUNC_GREATER = 0x08000000,
+	SCE_GXM_STENCIL_FUNC_NOT_EQUAL = 0x0A000000,
+	SCE_GXM_STENCIL_FUNC_GREATER_EQUAL = 0x0C000000,
+	SCE_GXM_STENCIL_FUNC_ALWAYS = 0x0E000000
+} SceGxmStencilFunc;
+
+typedef enum SceGxmStencilOp {
+	SCE_GXM_STENCIL_OP_KEEP = 0x00000000,
+	SCE_GXM_STENCIL_OP_ZERO = 0x00000001,
+	SCE_GXM_STENCIL_OP_REPLACE = 0x00000002,
+	SCE_GXM_STENCIL_OP_INCR = 0x00000003,
+	SCE_GXM_STENCIL_OP_DECR = 0x00000004,
+	SCE_GXM_STENCIL_OP_INVERT = 0x00000005,
+	SCE_GXM_STENCIL_OP_INCR_WRAP = 0x00000006,
+	SCE_GXM_STENCIL_OP_DECR_WRAP = 0x00000007
+} SceGxmStencilOp;
+
+typedef enum SceGxmRegionClipMode {
+	SCE_GXM_REGION_CLIP_NONE = 0x00000000,
+	SCE_GXM_REGION_CLIP_ALL = 0x40000000,
+	SCE_GXM_REGION_CLIP_OUTSIDE = 0x80000000,
+	SCE_GXM_REGION_CLIP_INSIDE = 0xC0000000
+} SceGxmRegionClipMode;
+
+typedef enum SceGxmBlendFunc {
+	SCE_GXM_BLEND_FUNC_NONE,
+	SCE_GXM_BLEND_FUNC_ADD,
+	SCE_GXM_BLEND_FUNC_SUBTRACT,
+	SCE_GXM_BLEND_FUNC_REVERSE_SUBTRACT,
+	SCE_GXM_BLEND_FUNC_MIN,
+	SCE_GXM_BLEND_FUNC_MAX
+} SceGxmBlendFunc;
+
+typedef enum SceGxmBlendFactor {
+	SCE_GXM_BLEND_FACTOR_ZERO,
+	SCE_GXM_BLEND_FACTOR_ONE,
+	SCE_GXM_BLEND_FACTOR_SRC_COLOR,
+	SCE_GXM_BLEND_FACTOR_ONE_MINUS_SRC_COLOR,
+	SCE_GXM_BLEND_FACTOR_SRC_ALPHA,
+	SCE_GXM_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+	SCE_GXM_BLEND_FACTOR_DST_COLOR,
+	SCE_GXM_BLEND_FACTOR_ONE_MINUS_DST_COLOR,
+	SCE_GXM_BLEND_FACTOR_DST_ALPHA,
+	SCE_GXM_BLEND_FACTOR_ONE_MINUS_DST_ALPHA,
+	SCE_GXM_BLEND_FACTOR_SRC_ALPHA_SATURATE,
+	SCE_GXM_BLEND_FACTOR_DST_ALPHA_SATURATE
+} SceGxmBlendFactor;
+
+typedef enum SceGxmColorMask {
+	SCE_GXM_COLOR_MASK_NONE = 0,
+	SCE_GXM_COLOR_MASK_A = (1 << 0),
+	SCE_GXM_COLOR_MASK_R = (1 << 1),
+	SCE_GXM_COLOR_MASK_G = (1 << 2),
+	SCE_GXM_COLOR_MASK_B = (1 << 3),
+	SCE_GXM_COLOR_MASK_ALL = (SCE_GXM_COLOR_MASK_A | SCE_GXM_COLOR_MASK_B | SCE_GXM_COLOR_MASK_G | SCE_GXM_COLOR_MASK_R)
+} SceGxmColorMask;
+
+typedef enum SceGxmColorFormat {
+	SCE_GXM_COLOR_FORMAT_U8U8U8U8_ABGR = 0x00001000,
+	SCE_GXM_COLOR_FORMAT_U8U8U8_BGR = 0x10001000,
+	SCE_GXM_COLOR_FORMAT_U5U6U5_RGB = 0x30101000,
+	SCE_GXM_COLOR_FORMAT_U1U5U5U5_ABGR = 0x40001000,
+	SCE_GXM_COLOR_FORMAT_U4U4U4U4_ABGR = 0x50001000,
+	SCE_GXM_COLOR_FORMAT_U8_R = 0xC0001000,
+	SCE_GXM_COLOR_FORMAT_F16F16F16F16_RGBA = 0x01100000,
+	SCE_GXM_COLOR_FORMAT_A8B8G8R8 = SCE_GXM_COLOR_FORMAT_U8U8U8U8_ABGR
+} SceGxmColorFormat;
+
+typedef enum SceGxmColorSurfaceType {
+	SCE_GXM_COLOR_SURFACE_LINEAR = 0x00000000,
+	SCE_GXM_COLOR_SURFACE_TILED = 0x04000000,
+	SCE_GXM_COLOR_SURFACE_SWIZZLED = 0x08000000
+} SceGxmColorSurfaceType;
+
+typedef enum SceGxmColorSurfaceScaleMode {
+	SCE_GXM_COLOR_SURFACE_SCALE_NONE = 0x00000000,
+	SCE_GXM_COLOR_SURFACE_SCALE_MSAA_DOWNSCALE = 0x00000001
+} SceGxmColorSurfaceScaleMode;
+
+typedef enum SceGxmDepthStencilSurfaceType {
+	SCE_GXM_DEPTH_STENCIL_SURFACE_LINEAR = 0x00000000,
+	SCE_GXM_DEPTH_STENCIL_SURFACE_TILED = 0x00011000
+} SceGxmDepthStencilSurfaceType;
+
+typedef enum SceGxmDepthStencilForceStoreMode {
+	SCE_GXM_DEPTH_STENCIL_FORCE_STORE_DISABLED = 0x00000000,
+	SCE_GXM_DEPTH_STENCIL_FORCE_STORE_DEPTH = 0x00000004,
+	SCE_GXM_DEPTH_STENCIL_FORCE_STORE_STENCIL = 0x00000008,
+	SCE_GXM_DEPTH_STENCIL_FORCE_STORE_ENABLED = 0x0000000C
+} SceGxmDepthStencilForceStoreMode;
+
+typedef enum SceGxmOutputRegisterSize {
+	SCE_GXM_OUTPUT_REGISTER_SIZE_32BIT,
+	SCE_GXM_OUTPUT_REGISTER_SIZE_64BIT
+} SceGxmOutputRegisterSize;
+
+typedef enum SceGxmOutputRegisterFormat {
+	SCE_GXM_OUTPUT_REGISTER_FORMAT_DECLARED,
+	SCE_GXM_OUTPUT_REGISTER_FORMAT_UCHAR4,
+	SCE_GXM_OUTPUT_REGISTER_FORMAT_CHAR4,
+	SCE_GXM_OUTPUT_REGISTER_FORMAT_USHORT2,
+	SCE_GXM_OUTPUT_REGISTER_FORMAT_SHORT2,
+	SCE_GXM_OUTPUT_REGISTER_FORMAT_HALF4,
+	SCE_GXM_OUTPUT_REGISTER_FORMAT_HALF2,
+	SCE_GXM_OUTPUT_REGISTER_FORMAT_FLOAT2,
+	SCE_GXM_OUTPUT_REGISTER_FORMAT_FLOAT
+} SceGxmOutputRegisterFormat;
+
+typedef enum SceGxmMultisampleMode {
+	SCE_GXM_MULTISAMPLE_NONE,
+	SCE_GXM_MULTISAMPLE_2X,
+	SCE_GXM_MULTISAMPLE_4X
+} SceGxmMultisampleMode;
+
+typedef enum SceGxmParameterCategory {
+	SCE_GXM_PARAMETER_CATEGORY_ATTRIBUTE,
+	SCE_GXM_PARAMETER_CATEGORY_UNIFORM,
+	SCE_GXM_PARAMETER_CATEGORY_SAMPLER,
+	SCE_GXM_PARAMETER_CATEGORY_AUXILIARY_SURFACE,
+	SCE_GXM_PARAMETER_CATEGORY_UNIFORM_BUFFER
+} SceGxmParameterCategory;
+
+typedef enum SceGxmParameterType {
+	SCE_GXM_PARAMETER_TYPE_F32,
+	SCE_GXM_PARAMETER_TYPE_F16,
+	SCE_GXM_PARAMETER_TYPE_C10,
+	SCE_GXM_PARAMETER_TYPE_U32,
+	SCE_GXM_PARAMETER_TYPE_S32,
+	SCE_GXM_PARAMETER_TYPE_U16,
+	SCE_GXM_PARAMETER_TYPE_S16,
+	SCE_GXM_PARAMETER_TYPE_U8,
+	SCE_GXM_PARAMETER_TYPE_S8,
+	SCE_GXM_PARAMETER_TYPE_AGGREGATE
+} SceGxmParameterType;
+
+typedef enum SceGxmTextureSwizzle4Mode {
+	SCE_GXM_TEXTURE_SWIZZLE4_ABGR = 0x00000000,
+	SCE_GXM_TEXTURE_SWIZZLE4_ARGB = 0x00001000,
+	SCE_GXM_TEXTURE_SWIZZLE4_RGBA = 0x00002000,
+	SCE_GXM_TEXTURE_SWIZZLE4_BGRA = 0x00003000,
+	SCE_GXM_TEXTURE_SWIZZLE4_1BGR = 0x00004000,
+	SCE_GXM_TEXTURE_SWIZZLE4_1RGB = 0x00005000,
+	SCE_GXM_TEXTURE_SWIZZLE4_RGB1 = 0x00006000,
+	SCE_GXM_TEXTURE_SWIZZLE4_BGR1 = 0x00007000
+} SceGxmTextureSwizzle4Mode;
+
+typedef enum SceGxmTextureBaseFormat {
+	SCE_GXM_TEXTURE_BASE_FORMAT_U8 = 0x00000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_S8 = 0x01000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_U4U4U4U4 = 0x02000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_U8U3U3U2 = 0x03000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_U1U5U5U5 = 0x04000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_U5U6U5 = 0x05000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_S5S5U6 = 0x06000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_U8U8 = 0x07000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_S8S8 = 0x08000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_U16 = 0x09000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_S16 = 0x0A000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_F16 = 0x0B000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8U8 = 0x0C000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_S8S8S8S8 = 0x0D000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_U2U10U10U10 = 0x0E000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_U16U16 = 0x0F000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_S16S16 = 0x10000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_F16F16 = 0x11000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_F32 = 0x12000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_F32M = 0x13000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_X8S8S8U8 = 0x14000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_X8U24 = 0x15000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_U32 = 0x17000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_S32 = 0x18000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_SE5M9M9M9 = 0x19000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_F11F11F10 = 0x1A000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_F16F16F16F16 = 0x1B000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_U16U16U16U16 = 0x1C000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_S16S16S16S16 = 0x1D000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_F32F32 = 0x1E000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_U32U32 = 0x1F000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_PVRT2BPP = 0x80000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_PVRT4BPP = 0x81000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII2BPP = 0x82000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII4BPP = 0x83000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_ETC1 = 0x84000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_UBC1 = 0x85000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_UBC2 = 0x86000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_UBC3 = 0x87000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_UBC4 = 0x88000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_SBC4 = 0x89000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_UBC5 = 0x8A000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_SBC5 = 0x8B000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_YUV420P2 = 0x90000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_YUV420P3 = 0x91000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_YUV422 = 0x92000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_P4 = 0x94000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_P8 = 0x95000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8 = 0x98000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_S8S8S8 = 0x99000000,
+	SCE_GXM_TEXTURE_BASE_FORMAT_U2F10F10F10 = 0x9A000000
+} SceGxmTextureBaseFormat;
+
+typedef enum SceGxmTextureFormat {
+	SCE_GXM_TEXTURE_FORMAT_U8_R = SCE_GXM_TEXTURE_BASE_FORMAT_U8 | 0x00000000,
+	SCE_GXM_TEXTURE_FORMAT_A8 = SCE_GXM_TEXTURE_BASE_FORMAT_U8 | 0x00001000,
+	SCE_GXM_TEXTURE_FORMAT_U8_RRRR = SCE_GXM_TEXTURE_BASE_FORMAT_U8 | 0x00003000,
+	SCE_GXM_TEXTURE_FORMAT_L8 = SCE_GXM_TEXTURE_BASE_FORMAT_U8 | 0x00005000,
+	SCE_GXM_TEXTURE_FORMAT_U4U4U4U4_ABGR = SCE_GXM_TEXTURE_BASE_FORMAT_U4U4U4U4 | SCE_GXM_TEXTURE_SWIZZLE4_ABGR,
+	SCE_GXM_TEXTURE_FORMAT_U4U4U4U4_RGBA = SCE_GXM_TEXTURE_BASE_FORMAT_U4U4U4U4 | SCE_GXM_TEXTURE_SWIZZLE4_RGBA,
+	SCE_GXM_TEXTURE_FORMAT_U1U5U5U5_ABGR = SCE_GXM_TEXTURE_BASE_FORMAT_U1U5U5U5 | SCE_GXM_TEXTURE_SWIZZLE4_ABGR,
+	SCE_GXM_TEXTURE_FORMAT_U5U5U5U1_RGBA = SCE_GXM_TEXTURE_BASE_FORMAT_U1U5U5U5 | SCE_GXM_TEXTURE_SWIZZLE4_RGBA,
+	SCE_GXM_TEXTURE_FORMAT_U5U6U5_BGR = SCE_GXM_TEXTURE_BASE_FORMAT_U5U6U5 | 0x00000000,
+	SCE_GXM_TEXTURE_FORMAT_U5U6U5_RGB = SCE_GXM_TEXTURE_BASE_FORMAT_U5U6U5 | 0x00001000,
+	SCE_GXM_TEXTURE_FORMAT_A8L8 = SCE_GXM_TEXTURE_BASE_FORMAT_U8U8 | 0x00002000,
+	SCE_GXM_TEXTURE_FORMAT_F32_R = SCE_GXM_TEXTURE_BASE_FORMAT_F32 | 0x00000000,
+	SCE_GXM_TEXTURE_FORMAT_DF32M = SCE_GXM_TEXTURE_BASE_FORMAT_F32M | 0x00000000,
+	SCE_GXM_TEXTURE_FORMAT_U8U8U8U8_ABGR = SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8U8 | SCE_GXM_TEXTURE_SWIZZLE4_ABGR,
+	SCE_GXM_TEXTURE_FORMAT_U8U8U8U8_ARGB = SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8U8 | SCE_GXM_TEXTURE_SWIZZLE4_ARGB,
+	SCE_GXM_TEXTURE_FORMAT_U8U8U8U8_RGBA = SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8U8 | SCE_GXM_TEXTURE_SWIZZLE4_RGBA,
+	SCE_GXM_TEXTURE_FORMAT_U8U8U8U8_BGRA = SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8U8 | SCE_GXM_TEXTURE_SWIZZLE4_BGRA,
+	SCE_GXM_TEXTURE_FORMAT_F16F16F16F16_ABGR = SCE_GXM_TEXTURE_BASE_FORMAT_F16F16F16F16 | SCE_GXM_TEXTURE_SWIZZLE4_ABGR,
+	SCE_GXM_TEXTURE_FORMAT_F16F16F16F16_RGBA = SCE_GXM_TEXTURE_BASE_FORMAT_F16F16F16F16 | SCE_GXM_TEXTURE_SWIZZLE4_RGBA,
+	SCE_GXM_TEXTURE_FORMAT_PVRT2BPP_ABGR = SCE_GXM_TEXTURE_BASE_FORMAT_PVRT2BPP | SCE_GXM_TEXTURE_SWIZZLE4_ABGR,
+	SCE_GXM_TEXTURE_FORMAT_PVRT2BPP_1BGR = SCE_GXM_TEXTURE_BASE_FORMAT_PVRT2BPP | SCE_GXM_TEXTURE_SWIZZLE4_1BGR,
+	SCE_GXM_TEXTURE_FORMAT_PVRT4BPP_ABGR = SCE_GXM_TEXTURE_BASE_FORMAT_PVRT4BPP | SCE_GXM_TEXTURE_SWIZZLE4_ABGR,
+	SCE_GXM_TEXTURE_FORMAT_PVRT4BPP_1BGR = SCE_GXM_TEXTURE_BASE_FORMAT_PVRT4BPP | SCE_GXM_TEXTURE_SWIZZLE4_1BGR,
+	SCE_GXM_TEXTURE_FORMAT_PVRTII2BPP_ABGR = SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII2BPP | SCE_GXM_TEXTURE_SWIZZLE4_ABGR,
+	SCE_GXM_TEXTURE_FORMAT_PVRTII4BPP_ABGR = SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII4BPP | SCE_GXM_TEXTURE_SWIZZLE4_ABGR,
+	SCE_GXM_TEXTURE_FORMAT_UBC1_ABGR = SCE_GXM_TEXTURE_BASE_FORMAT_UBC1 | SCE_GXM_TEXTURE_SWIZZLE4_ABGR,
+	SCE_GXM_TEXTURE_FORMAT_UBC1_1BGR = SCE_GXM_TEXTURE_BASE_FORMAT_UBC1 | SCE_GXM_TEXTURE_SWIZZLE4_1BGR,
+	SCE_GXM_TEXTURE_FORMAT_UBC2_ABGR = SCE_GXM_TEXTURE_BASE_FORMAT_UBC2 | SCE_GXM_TEXTURE_SWIZZLE4_ABGR,
+	SCE_GXM_TEXTURE_FORMAT_UBC3_ABGR = SCE_GXM_TEXTURE_BASE_FORMAT_UBC3 | SCE_GXM_TEXTURE_SWIZZLE4_ABGR,
+	SCE_GXM_TEXTURE_FORMAT_P4_ABGR = SCE_GXM_TEXTURE_BASE_FORMAT_P4 | SCE_GXM_TEXTURE_SWIZZLE4_ABGR,
+	SCE_GXM_TEXTURE_FORMAT_P8_ABGR = SCE_GXM_TEXTURE_BASE_FORMAT_P8 | SCE_GXM_TEXTURE_SWIZZLE4_ABGR,
+	SCE_GXM_TEXTURE_FORMAT_U8U8U8_BGR = SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8 | 0x00000000,
+	SCE_GXM_TEXTURE_FORMAT_U8U8U8_RGB = SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8 | 0x00001000
+} SceGxmTextureFormat;
+
+typedef enum SceGxmTextureType {
+	SCE_GXM_TEXTURE_SWIZZLED = 0x00000000,
+	SCE_GXM_TEXTURE_CUBE = 0x40000000,
+	SCE_GXM_TEXTURE_LINEAR = 0x60000000,
+	SCE_GXM_TEXTURE_TILED = 0x80000000,
+	SCE_GXM_TEXTURE_SWIZZLED_ARBITRARY = 0xA0000000,
+	SCE_GXM_TEXTURE_LINEAR_STRIDED = 0xC0000000,
+	SCE_GXM_TEXTURE_CUBE_ARBITRARY = 0xE0000000
+} SceGxmTextureType;
+
+typedef enum SceGxmTextureFilter {
+	SCE_GXM_TEXTURE_FILTER_POINT = 0x00000000,
+	SCE_GXM_TEXTURE_FILTER_LINEAR = 0x00000001,
+	SCE_GXM_TEXTURE_FILTER_MIPMAP_LINEAR = 0x00000002,
+	SCE_GXM_TEXTURE_FILTER_MIPMAP_POINT = 0x00000003
+} SceGxmTextureFilter;
+
+typedef enum SceGxmTextureMipFilter {
+	SCE_GXM_TEXTURE_MIP_FILTER_DISABLED = 0x00000000,
+	SCE_GXM_TEXTURE_MIP_FILTER_ENABLED = 0x00000200
+} SceGxmTextureMipFilter;
+
+typedef enum SceGxmTextureAddrMode {
+	SCE_GXM_TEXTURE_ADDR_REPEAT = 0x00000000,
+	SCE_GXM_TEXTURE_ADDR_MIRROR = 0x00000001,
+	SCE_GXM_TEXTURE_ADDR_CLAMP = 0x00000002,
+	SCE_GXM_TEXTURE_ADDR_MIRROR_CLAMP = 0x00000003,
+	SCE_GXM_TEXTURE_ADDR_REPEAT_IGNORE_BORDER = 0x00000004,
+	SCE_GXM_TEXTURE_ADDR_CLAMP_FULL_BORDER = 0x00000005,
+	SCE_GXM_TEXTURE_ADDR_CLAMP_IGNORE_BORDER = 0x00000006,
+	SCE_GXM_TEXTURE_ADDR_CLAMP_HALF_BORDER = 0x00000007
+} SceGxmTextureAddrMode;
+
+typedef enum SceGxmTextureGammaMode {
+	SCE_GXM_TEXTURE_GAMMA_NONE = 0x00000000,
+	SCE_GXM_TEXTURE_GAMMA_R = 0x08000000,
+	SCE_GXM_TEXTURE_GAMMA_GR = 0x18000000,
+	SCE_GXM_TEXTURE_GAMMA_BGR = 0x08000000
+} SceGxmTextureGammaMode;
+
+typedef enum SceGxmTransferFormat {
+	SCE_GXM_TRANSFER_FORMAT_U8_R = 0x00000000,
+	SCE_GXM_TRANSFER_FORMAT_U4U4U4U4_ABGR = 0x00010000,
+	SCE_GXM_TRANSFER_FORMAT_U1U5U5U5_ABGR = 0x00020000,
+	SCE_GXM_TRANSFER_FORMAT_U5U6U5_BGR = 0x00030000,
+	SCE_GXM_TRANSFER_FORMAT_U8U8_GR = 0x00040000,
+	SCE_GXM_TRANSFER_FORMAT_U8U8U8_BGR = 0x00050000,
+	SCE_GXM_TRANSFER_FORMAT_U8U8U8U8_ABGR = 0x00060000,
+	SCE_GXM_TRANSFER_FORMAT_RAW16 = 0x000F0000,
+	SCE_GXM_TRANSFER_FORMAT_RAW32 = 0x00110000,
+	SCE_GXM_TRANSFER_FORMAT_RAW64 = 0x00120000,
+	SCE_GXM_TRANSFER_FORMAT_RAW128 = 0x00130000
+} SceGxmTransferFormat;
+
+typedef enum SceGxmTransferType {
+	SCE_GXM_TRANSFER_LINEAR = 0x00000000,
+	SCE_GXM_TRANSFER_TILED = 0x00400000,
+	SCE_GXM_TRANSFER_SWIZZLED = 0x00800000
+} SceGxmTransferType;
+
+typedef enum SceGxmTransferColorKeyMode {
+	SCE_GXM_TRANSFER_COLORKEY_NONE = 0,
+	SCE_GXM_TRANSFER_COLORKEY_PASS = 1,
+	SCE_GXM_TRANSFER_COLORKEY_REJECT = 2
+} SceGxmTransferColorKeyMode;
+
+typedef enum SceGxmSceneFlags {
+	SCE_GXM_SCENE_FRAGMENT_SET_DEPENDENCY = 0x00000001,
+	SCE_GXM_SCENE_VERTEX_WAIT_FOR_DEPENDENCY = 0x00000002,
+	SCE_GXM_SCENE_FRAGMENT_TRANSFER_SYNC = 0x00000004,
+	SCE_GXM_SCENE_VERTEX_TRANSFER_SYNC = 0x00000008
+} SceGxmSceneFlags;
+
+typedef enum SceGxmInitializeFlags {
+	SCE_GXM_INITIALIZE_FLAG_PBDESCFLAGS_ZLS_OVERRIDE = 0x00000001,
+	SCE_GXM_INITIALIZE_FLAG_PBDESCFLAGS_ZLS_DISABLE = 0x00000002,
+	SCE_GXM_INITIALIZE_FLAG_PBDESCFLAGS_TEXFORMAT_EXT = 0x00000004
+} SceGxmInitializeFlags;
+
+// Opaque objects, their host layout is private to the mock backend
+typedef struct SceGxmContext SceGxmContext;
+typedef struct SceGxmRenderTarget SceGxmRenderTarget;
+typedef struct SceGxmSyncObject SceGxmSyncObject;
+typedef struct SceGxmShaderPatcher SceGxmShaderPatcher;
+typedef struct SceGxmRegisteredProgram SceGxmRegisteredProgram;
+typedef SceGxmRegisteredProgram *SceGxmShaderPatcherId;
+typedef struct SceGxmProgram SceGxmProgram;
+typedef struct SceGxmProgramParameter SceGxmProgramParameter;
+typedef struct SceGxmVertexProgram SceGxmVertexProgram;
+typedef struct SceGxmFragmentProgram SceGxmFragmentProgram;
+
+typedef void(SceGxmDisplayQueueCallback)(const void *callbackData);
+
+typedef struct SceGxmInitializeParams {
+	unsigned int flags;
+	unsigned int displayQueueMaxPendingCount;
+	SceGxmDisplayQueueCallback *displayQueueCallback;
+	unsigned int displayQueueCallbackDataSize;
+	SceSize parameterBufferSize;
+} SceGxmInitializeParams;
+
+typedef struct SceGxmNotification {
+	volatile uint32_t *address;
+	uint32_t value;
+} SceGxmNotification;
+
+typedef struct SceGxmValidRegion {
+	unsigned int xMin;
+	unsigned int yMin;
+	unsigned int xMax;
+	unsigned int yMax;
+} SceGxmValidRegion;
+
+typedef struct SceGxmVertexAttribute {
+	unsigned short streamIndex;
+	unsigned short offset;
+	unsigned char format;
+	unsigned char componentCount;
+	unsigned short regIndex;
+} SceGxmVertexAttribute;
+
+typedef struct SceGxmVertexStream {
+	unsigned short stride;
+	unsigned short indexSource;
+} SceGxmVertexStream;
+
+typedef struct SceGxmBlendInfo {
+	uint8_t colorMask;
+	uint8_t colorFunc : 4;
+	uint8_t alphaFunc : 4;
+	uint8_t colorSrc : 4;
+	uint8_t colorDst : 4;
+	uint8_t alphaSrc : 4;
+	uint8_t alphaDst : 4;
+} SceGxmBlendInfo;
+
+// Texture descriptor, decoded fields replace the hardware control words so that 64 bit pointers fit
+typedef struct SceGxmTexture {
+	const void *data;
+	const void *palette;
+	uint32_t format;
+	uint32_t type;
+	uint32_t width;
+	uint32_t height;
+	uint32_t mipCount;
+	uint32_t uAddrMode;
+	uint32_t vAddrMode;
+	uint32_t minFilter;
+	uint32_t magFilter;
+	uint32_t mipFilter;
+	uint32_t lodBias;
+	uint32_t gammaMode;
+} SceGxmTexture;
+
+typedef struct SceGxmColorSurface {
+	void *data;
+	uint32_t colorFormat;
+	uint32_t surfaceType;
+	uint32_t scaleMode;
+	uint32_t outputRegisterSize;
+	uint32_t width;
+	uint32_t height;
+	uint32_t strideInPixels;
+	uint32_t reserved;
+} SceGxmColorSurface;
+
+typedef struct SceGxmDepthStencilSurface {
+	void *depthData;
+	void *stencilData;
+	uint32_t format;
+	uint32_t surfaceType;
+	uint32_t strideInSamples;
+	uint32_t forceStoreMode;
+	float backgroundDepth;
+	uint32_t backgroundControl;
+} SceGxmDepthStencilSurface;
+
+typedef struct SceGxmRenderTargetParams {
+	uint32_t flags;
+	uint16_t width;
+	uint16_t height;
+	uint16_t scenesPerFrame;
+	uint16_t multisampleMode;
+	uint32_t multisampleLocations;
+	SceUID driverMemBlock;
+} SceGxmRenderTargetParams;
+
+typedef struct SceGxmContextParams {
+	void *hostMem;
+	SceSize hostMemSize;
+	void *vdmRingBufferMem;
+	SceSize vdmRingBufferMemSize;
+	void *vertexRingBufferMem;
+	SceSize vertexRingBufferMemSize;
+	void *fragmentRingBufferMem;
+	SceSize fragmentRingBufferMemSize;
+	void *fragmentUsseRingBufferMem;
+	SceSize fragmentUsseRingBufferMemSize;
+	unsigned int fragmentUsseRingBufferOffset;
+} SceGxmContextParams;
+
+typedef void *(SceGxmShaderPatcherHostAllocCallback)(void *userData, unsigned int size);
+typedef void(SceGxmShaderPatcherHostFreeCallback)(void *userData, void *mem);
+typedef void *(SceGxmShaderPatcherBufferAllocCallback)(void *userData, unsigned int size);
+typedef void(SceGxmShaderPatcherBufferFreeCallback)(void *userData, void *mem);
+typedef void *(SceGxmShaderPatcherUsseAllocCallback)(void *userData, unsigned int size, unsigned int *usseOffset);
+typedef void(SceGxmShaderPatcherUsseFreeCallback)(void *userData, void *mem);
+
+typedef struct SceGxmShaderPatcherParams {
+	void *userData;
+	SceGxmShaderPatcherHostAllocCallback *hostAllocCallback;
+	SceGxmShaderPatcherHostFreeCallback *hostFreeCallback;
+	SceGxmShaderPatcherBufferAllocCallback *bufferAllocCallback;
+	SceGxmShaderPatcherBufferFreeCallback *bufferFreeCallback;
+	void *bufferMem;
+	SceSize bufferMemSize;
+	SceGxmShaderPatcherUsseAllocCallback *vertexUsseAllocCallback;
+	SceGxmShaderPatcherUsseFreeCallback *vertexUsseFreeCallback;
+	void *vertexUsseMem;
+	SceSize vertexUsseMemSize;
+	unsigned int vertexUsseOffset;
+	SceGxmShaderPatcherUsseAllocCallback *fragmentUsseAllocCallback;
+	SceGxmShaderPatcherUsseFreeCallback *fragmentUsseFreeCallback;
+	void *fragmentUsseMem;
+	SceSize fragmentUsseMemSize;
+	unsigned int fragmentUsseOffset;
+} SceGxmShaderPatcherParams;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int sceGxmInitialize(const SceGxmInitializeParams *params);
+int sceGxmVshInitialize(const SceGxmInitializeParams *params);
+int sceGxmTerminate(void);
+volatile uint32_t *sceGxmGetNotificationRegion(void);
+int sceGxmNotificationWait(const SceGxmNotification *notification);
+
+int sceGxmMapMemory(void *base, SceSize size, SceGxmMemoryAttribFlags attr);
+int sceGxmUnmapMemory(void *base);
+int sceGxmMapVertexUsseMemory(void *base, SceSize size, unsigned int *offset);
+int sceGxmUnmapVertexUsseMemory(void *base);
+int sceGxmMapFragmentUsseMemory(void *base, SceSize size, unsigned int *offset);
+int sceGxmUnmapFragmentUsseMemory(void *base);
+
+int sceGxmDisplayQueueAddEntry(SceGxmSyncObject *oldBuffer, SceGxmSyncObject *newBuffer, const void *callbackData);
+int sceGxmDisplayQueueFinish(void);
+int sceGxmSyncObjectCreate(SceGxmSyncObject **syncObject);
+int sceGxmSyncObjectDestroy(SceGxmSyncObject *syncObject);
+
+int sceGxmCreateContext(const SceGxmContextParams *params, SceGxmContext **context);
+int sceGxmDestroyContext(SceGxmContext *context);
+int sceGxmCreateRenderTarget(const SceGxmRenderTargetParams *params, SceGxmRenderTarget **renderTarget);
+int sceGxmDestroyRenderTarget(SceGxmRenderTarget *renderTarget);
+
+int sceGxmBeginScene(SceGxmContext *context, unsigned int flags, const SceGxmRenderTarget *renderTarget, const SceGxmValidRegion *validRegion, SceGxmSyncObject *vertexSyncObject, SceGxmSyncObject *fragmentSyncObject, const SceGxmColorSurface *colorSurface, const SceGxmDepthStencilSurface *depthStencil);
+int sceGxmEndScene(SceGxmContext *context, const SceGxmNotification *vertexNotification, const SceGxmNotification *fragmentNotification);
+int sceGxmFinish(SceGxmContext *context);
+int sceGxmPadHeartbeat(const SceGxmColorSurface *displaySurface, SceGxmSyncObject *displaySyncObject);
+
+void sceGxmSetVertexProgram(SceGxmContext *context, const SceGxmVertexProgram *vertexProgram);
+void sceGxmSetFragmentProgram(SceGxmContext *context, const SceGxmFragmentProgram *fragmentProgram);
+int sceGxmReserveVertexDefaultUniformBuffer(SceGxmContext *context, void **uniformBuffer);
+int sceGxmReserveFragmentDefaultUniformBuffer(SceGxmContext *context, void **uniformBuffer);
+int sceGxmSetVertexDefaultUniformBuffer(SceGxmContext *context, const void *uniformBuffer);
+int sceGxmSetFragmentDefaultUniformBuffer(SceGxmContext *context, const void *uniformBuffer);
+int sceGxmSetUniformDataF(void *uniformBuffer, const SceGxmProgramParameter *parameter, unsigned int componentOffset, unsigned int componentCount, const float *sourceData);
+int sceGxmSetVertexStream(SceGxmContext *context, unsigned int streamIndex, const void *streamData);
+int sceGxmSetVertexTexture(SceGxmContext *context, unsigned int textureIndex, const SceGxmTexture *texture);
+int sceGxmSetFragmentTexture(SceGxmContext *context, unsigned int textureIndex, const SceGxmTexture *texture);
+int sceGxmDraw(SceGxmContext *context, SceGxmPrimitiveType primType, SceGxmIndexFormat indexType, const void *indexData, unsigned int indexCount);
+int sceGxmDrawInstanced(SceGxmContext *context, SceGxmPrimitiveType primType, SceGxmIndexFormat indexType, const void *indexData, unsigned int indexCount, unsigned int indexWrap);
+
+void sceGxmSetFrontDepthFunc(SceGxmContext *context, SceGxmDepthFunc depthFunc);
+void sceGxmSetBackDepthFunc(SceGxmContext *context, SceGxmDepthFunc depthFunc);
+void sceGxmSetFrontDepthWriteEnable(SceGxmContext *context, SceGxmDepthWriteMode enable);
+void sceGxmSetBackDepthWriteEnable(SceGxmContext *context, SceGxmDepthWriteMode enable);
+void sceGxmSetFrontFragmentProgramEnable(SceGxmContext *context, SceGxmFragmentProgramMode enable);
+void sceGxmSetBackFragmentProgramEnable(SceGxmContext *context, SceGxmFragmentProgramMode enable);
+void sceGxmSetFrontStencilFunc(SceGxmContext *context, SceGxmStencilFunc func, SceGxmStencilOp stencilFail, SceGxmStencilOp depthFail, SceGxmStencilOp depthPass, unsigned char compareMask, unsigned char writeMask);
+void sceGxmSetBackStencilFunc(SceGxmContext *context, SceGxmStencilFunc func, SceGxmStencilOp stencilFail, SceGxmStencilOp depthFail, SceGxmStencilOp depthPass, unsigned char compareMask, unsigned char writeMask);
+void sceGxmSetFrontStencilRef(SceGxmContext *context, unsigned int sref);
+void sceGxmSetBackStencilRef(SceGxmContext *context, unsigned int sref);
+void sceGxmSetFrontPointLineWidth(SceGxmContext *context, unsigned int width);
+void sceGxmSetBackPointLineWidth(SceGxmContext *context, unsigned int width);
+void sceGxmSetFrontPolygonMode(SceGxmContext *context, SceGxmPolygonMode mode);
+void sceGxmSetBackPolygonMode(SceGxmContext *context, SceGxmPolygonMode mode);
+void sceGxmSetFrontDepthBias(SceGxmContext *context, int factor, int units);
+void sceGxmSetBackDepthBias(SceGxmContext *context, int factor, int units);
+void sceGxmSetCullMode(SceGxmContext *context, SceGxmCullMode mode);
+void sceGxmSetTwoSidedEnable(SceGxmContext *context, SceGxmTwoSidedMode mode);
+void sceGxmSetRegionClip(SceGxmContext *context, SceGxmRegionClipMode mode, unsigned int xMin, unsigned int yMin, unsigned int xMax, unsigned int yMax);
+void sceGxmSetViewport(SceGxmContext *context, float xOffset, float xScale, float yOffset, float yScale, float zOffset, float zScale);
+void sceGxmSetViewport_sfp(SceGxmContext *context, float xOffset, float xScale, float yOffset, float yScale, float zOffset, float zScale);
+
+int sceGxmColorSurfaceInit(SceGxmColorSurface *surface, SceGxmColorFormat colorFormat, SceGxmColorSurfaceType surfaceType, SceGxmColorSurfaceScaleMode scaleMode, SceGxmOutputRegisterSize outputRegisterSize, unsigned int width, unsigned int height, unsigned int strideInPixels, void *data);
+int sceGxmDepthStencilSurfaceInit(SceGxmDepthStencilSurface *surface, SceGxmDepthStencilFormat depthStencilFormat, SceGxmDepthStencilSurfaceType surfaceType, unsigned int strideInSamples, void *depthData, void *stencilData);
+void sceGxmDepthStencilSurfaceSetForceStoreMode(SceGxmDepthStencilSurface *surface, SceGxmDepthStencilForceStoreMode forceStore);
+
+int sceGxmTextureInitLinear(SceGxmTexture *texture, const void *data, SceGxmTextureFormat texFormat, unsigned int width, unsigned int height, unsigned int mipCount);
+int sceGxmTextureInitSwizzled(SceGxmTexture *texture, const void *data, SceGxmTextureFormat texFormat, unsigned int width, unsigned int height, unsigned int mipCount);
+int sceGxmTextureInitSwizzledArbitrary(SceGxmTexture *texture, const void *data, SceGxmTextureFormat texFormat, unsigned int width, unsigned int height, unsigned int mipCount);
+int sceGxmTextureInitCube(SceGxmTexture *texture, const void *data, SceGxmTextureFormat texFormat, unsigned int width, unsigned int height, unsigned int mipCount);
+int sceGxmTextureValidate(const SceGxmTexture *texture);
+int sceGxmTextureSetUAddrMode(SceGxmTexture *texture, SceGxmTextureAddrMode mode);
+int sceGxmTextureSetVAddrMode(SceGxmTexture *texture, SceGxmTextureAddrMode mode);
+int sceGxmTextureSetMinFilter(SceGxmTexture *texture, SceGxmTextureFilter minFilter);
+int sceGxmTextureSetMagFilter(SceGxmTexture *texture, SceGxmTextureFilter magFilter);
+int sceGxmTextureSetMipFilter(SceGxmTexture *texture, SceGxmTextureMipFilter mipFilter);
+int sceGxmTextureSetLodBias(SceGxmTexture *texture, unsigned int bias);
+int sceGxmTextureSetMipmapCount(SceGxmTexture *texture, unsigned int mipCount);
+int sceGxmTextureSetGammaMode(SceGxmTexture *texture, SceGxmTextureGammaMode gammaMode);
+int sceGxmTextureSetPalette(SceGxmTexture *texture, const void *paletteData);
+void *sceGxmTextureGetData(const SceGxmTexture *texture);
+SceGxmTextureFormat sceGxmTextureGetFormat(const SceGxmTexture *texture);
+unsigned int sceGxmTextureGetWidth(const SceGxmTexture *texture);
+unsigned int sceGxmTextureGetHeight(const SceGxmTexture *texture);
+unsigned int sceGxmTextureGetMipmapCount(const SceGxmTexture *texture);
+
+unsigned int sceGxmProgramGetSize(const SceGxmProgram *program);
+unsigned int sceGxmProgramGetParameterCount(const SceGxmProgram *program);
+const SceGxmProgramParameter *sceGxmProgramGetParameter(const SceGxmProgram *program, unsigned int index);
+const SceGxmProgramParameter *sceGxmProgramFindParameterByName(const SceGxmProgram *program, const char *name);
+unsigned int sceGxmProgramGetDefaultUniformBufferSize(const SceGxmProgram *program);
+const char *sceGxmProgramParameterGetName(const SceGxmProgramParameter *parameter);
+SceGxmParameterCategory sceGxmProgramParameterGetCategory(const SceGxmProgramParameter *parameter);
+SceGxmParameterType sceGxmProgramParameterGetType(const SceGxmProgramParameter *parameter);
+unsigned int sceGxmProgramParameterGetComponentCount(const SceGxmProgramParameter *parameter);
+unsigned int sceGxmProgramParameterGetArraySize(const SceGxmProgramParameter *parameter);
+unsigned int sceGxmProgramParameterGetResourceIndex(const SceGxmProgramParameter *parameter);
+
+int sceGxmShaderPatcherCreate(const SceGxmShaderPatcherParams *params, SceGxmShaderPatcher **shaderPatcher);
+int sceGxmShaderPatcherDestroy(SceGxmShaderPatcher *shaderPatcher);
+int sceGxmShaderPatcherRegisterProgram(SceGxmShaderPatcher *shaderPatcher, const SceGxmProgram *programHeader, SceGxmShaderPatcherId *programId);
+int sceGxmShaderPatcherUnregisterProgram(SceGxmShaderPatcher *shaderPatcher, SceGxmShaderPatcherId programId);
+int sceGxmShaderPatcherForceUnregisterProgram(SceGxmShaderPatcher *shaderPatcher, SceGxmShaderPatcherId programId);
+const SceGxmProgram *sceGxmShaderPatcherGetProgramFromId(SceGxmShaderPatcherId programId);
+int sceGxmShaderPatcherCreateVertexProgram(SceGxmShaderPatcher *shaderPatcher, SceGxmShaderPatcherId programId, const SceGxmVertexAttribute *attributes, unsigned int attributeCount, const SceGxmVertexStream *streams, unsigned int streamCount, SceGxmVertexProgram **vertexProgram);
+int sceGxmShaderPatcherCreateFragmentProgram(SceGxmShaderPatcher *shaderPatcher, SceGxmShaderPatcherId programId, SceGxmOutputRegisterFormat outputFormat, SceGxmMultisampleMode multisampleMode, const SceGxmBlendInfo *blendInfo, const SceGxmProgram *vertexProgram, SceGxmFragmentProgram **fragmentProgram);
+int sceGxmShaderPatcherCreateMaskUpdateFragmentProgram(SceGxmShaderPatcher *shaderPatcher, SceGxmFragmentProgram **fragmentProgram);
+int sceGxmShaderPatcherReleaseVertexProgram(SceGxmShaderPatcher *shaderPatcher, SceGxmVertexProgram *vertexProgram);
+int sceGxmShaderPatcherReleaseFragmentProgram(SceGxmShaderPatcher *shaderPatcher, SceGxmFragmentProgram *fragmentProgram);
+
+int sceGxmTransferCopy(uint32_t width, uint32_t height, uint32_t colorKeyValue, uint32_t colorKeyMask, SceGxmTransferColorKeyMode colorKeyMode, SceGxmTransferFormat srcFormat, SceGxmTransferType srcType, const void *srcAddress, uint32_t srcX, uint32_t srcY, int32_t srcStride, SceGxmTransferFormat destFormat, SceGxmTransferType destType, void *destAddress, uint32_t destX, uint32_t destY, int32_t destStride, SceGxmSyncObject *syncObject, uint32_t syncFlags, const SceGxmNotification *notification);
+int sceGxmTransferDownscale(SceGxmTransferFormat srcFormat, const void *srcAddress, unsigned int srcX, unsigned int srcY, unsigned int srcWidth, unsigned int srcHeight, int srcStride, SceGxmTransferFormat destFormat, void *destAddress, unsigned int destX, unsigned int destY, int destStride, SceGxmSyncObject *syncObject, unsigned int syncFlags, const SceGxmNotification *notification);
+int sceGxmTransferFinish(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,65 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * clib.h:
+ * Host replacement for the sceClib subset used by vitaGL
+ */
+
+#ifndef _PSP2_KERNEL_CLIB_H_
+#define _PSP2_KERNEL_CLIB_H_
+
+#include <psp2/types.h>
+
+typedef void *SceClibMspace;
+
+typedef struct SceClibMspaceStats {
+	SceSize capacity;
+	SceSize unk;
+	SceSize peak_in_use;
+	SceSize current_in_use;
+	SceSize unk2;
+	SceSize unk3;
+} SceClibMspaceStats;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void *sceClibMemset(void *dst, int ch, SceSize len);
+void *sceClibMemcpy(void *dst, const void *src, SceSize len);
+void *sceClibMemmove(void *dst, const void *src, SceSize len);
+int sceClibMemcmp(const void *s1, const void *s2, SceSize len);
+int sceClibPrintf(const char *fmt, ...);
+int sceClibSnprintf(char *dst, SceSize dst_max_size, const char *fmt, ...);
+
+SceClibMspace sceClibMspaceCreate(void *base, SceSize capacity);
+void sceClibMspaceDestroy(SceClibMspace msp);
+void *sceClibMspaceMalloc(SceClibMspace msp, SceSize size);
+void *sceClibMspaceCalloc(SceClibMspace msp, SceSize num, SceSize size);
+void *sceClibMspaceMemalign(SceClibMspace msp, SceSize alignment, SceSize size);
+void *sceClibMspaceRealloc(SceClibMspace msp, void *ptr, SceSize size);
+void sceClibMspaceFree(SceClibMspace msp, void *ptr);
+SceSize sceClibMspaceMallocUsableSize(void *ptr);
+int sceClibMspaceMallocStats(SceClibMspace msp, SceClibMspaceStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,81 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * sysmem.h:
+ * Host replacement for the sysmem subset used by vitaGL
+ */
+
+#ifndef _PSP2_KERNEL_SYSMEM_H_
+#define _PSP2_KERNEL_SYSMEM_H_
+
+#include <psp2/types.h>
+
+
+typedef enum SceKernelMemBlockType {
+	SCE_KERNEL_MEMBLOCK_TYPE_USER_CDRAM_RW = 0x09408060,
+	SCE_KERNEL_MEMBLOCK_TYPE_USER_RW_UNCACHE = 0x0C208060,
+	SCE_KERNEL_MEMBLOCK_TYPE_USER_MAIN_PHYCONT_RW = 0x0C80D060,
+	SCE_KERNEL_MEMBLOCK_TYPE_USER_MAIN_PHYCONT_NC_RW = 0x0D808060,
+	SCE_KERNEL_MEMBLOCK_TYPE_USER_MAIN_CDIALOG_RW = 0x0CA0D060,
+	SCE_KERNEL_MEMBLOCK_TYPE_USER_MAIN_CDIALOG_NC_RW = 0x0CA08060,
+	SCE_KERNEL_MEMBLOCK_TYPE_USER_RW = 0x0C20D060
+} SceKernelMemBlockType;
+
+typedef struct SceKernelAllocMemBlockOpt {
+	SceSize size;
+	SceUInt32 attr;
+	SceSize alignment;
+	SceUInt32 uidBaseBlock;
+	const char *strBaseBlockName;
+	int flags;
+	int reserved[10];
+} SceKernelAllocMemBlockOpt;
+
+typedef struct SceKernelMemBlockInfo {
+	SceSize size;
+	void *mappedBase;
+	SceSize mappedSize;
+	int memoryType;
+	SceUInt32 access;
+	SceKernelMemBlockType type;
+} SceKernelMemBlockInfo;
+
+typedef struct SceKernelFreeMemorySizeInfo {
+	SceSize size;
+	SceSize size_user;
+	SceSize size_cdram;
+	SceSize size_phycont;
+} SceKernelFreeMemorySizeInfo;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SceUID sceKernelAllocMemBlock(const char *name, SceKernelMemBlockType type, SceSize size, SceKernelAllocMemBlockOpt *opt);
+int sceKernelFreeMemBlock(SceUID uid);
+int sceKernelGetMemBlockBase(SceUID uid, void **base);
+SceUID sceKernelFindMemBlockByAddr(const void *addr, SceSize size);
+int sceKernelGetMemBlockInfoByAddr(void *base, SceKernelMemBlockInfo *info);
+int sceKernelGetFreeMemorySize(SceKernelFreeMemorySizeInfo *info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,63 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * threadmgr.h:
+ * Host replacement for the thread manager subset used by vitaGL (NOTE: backed by pthreads)
+ */
+
+#ifndef _PSP2_KERNEL_THREADMGR_H_
+#define _PSP2_KERNEL_THREADMGR_H_
+
+#include <psp2/types.h>
+
+#define SCE_KERNEL_CPU_MASK_USER_0 0x00010000
+#define SCE_KERNEL_CPU_MASK_USER_1 0x00020000
+#define SCE_KERNEL_CPU_MASK_USER_2 0x00040000
+#define SCE_KERNEL_CPU_MASK_USER_ALL 0x00070000
+#define SCE_KERNEL_DEFAULT_PRIORITY_USER 0x10000100
+
+typedef int (*SceKernelThreadEntry)(SceSize args, void *argp);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SceUID sceKernelCreateThread(const char *name, SceKernelThreadEntry entry, int initPriority, SceSize stackSize, SceUInt attr, int cpuAffinityMask, const void *option);
+int sceKernelStartThread(SceUID thid, SceSize arglen, void *argp);
+int sceKernelWaitThreadEnd(SceUID thid, int *stat, SceUInt *timeout);
+int sceKernelDeleteThread(SceUID thid);
+int sceKernelExitDeleteThread(int status);
+int sceKernelDelayThread(SceUInt delay);
+SceUID sceKernelGetThreadId(void);
+
+SceUID sceKernelCreateSema(const char *name, SceUInt attr, int initVal, int maxVal, void *option);
+int sceKernelDeleteSema(SceUID semaid);
+int sceKernelWaitSema(SceUID semaid, int signal, SceUInt *timeout);
+int sceKernelSignalSema(SceUID semaid, int signal);
+
+SceUID sceKernelCreateMutex(const char *name, SceUInt attr, int initCount, void *option);
+int sceKernelDeleteMutex(SceUID mutexid);
+int sceKernelLockMutex(SceUID mutexid, int lockCount, unsigned int *timeout);
+int sceKernelUnlockMutex(SceUID mutexid, int unlockCount);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,44 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rtc.h:
+ * Host replacement for the sceRtc subset used by vitaGL
+ */
+
+#ifndef _PSP2_RTC_H_
+#define _PSP2_RTC_H_
+
+#include <psp2/types.h>
+
+typedef struct SceRtcTick {
+	SceUInt64 tick;
+} SceRtcTick;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+unsigned int sceRtcGetTickResolution(void);
+int sceRtcGetCurrentTick(SceRtcTick *tick);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,58 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * sharedfb.h:
+ * Host replacement for the sceSharedFb subset used by vitaGL (NOTE: system app mode is never reported on host)
+ */
+
+#ifndef _PSP2_SHAREDFB_H_
+#define _PSP2_SHAREDFB_H_
+
+#include <psp2/types.h>
+
+typedef struct SceSharedFbInfo {
+	void *fb_base;
+	int fb_size;
+	void *fb_base2;
+	int unk0[6];
+	int stride;
+	int width;
+	int height;
+	int unk1;
+	int index;
+	int unk2[4];
+	int vsync;
+	int unk3[3];
+} SceSharedFbInfo;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SceUID sceSharedFbOpen(int index);
+int sceSharedFbClose(SceUID fb_id);
+int sceSharedFbBegin(SceUID fb_id, SceSharedFbInfo *info);
+int sceSharedFbEnd(SceUID fb_id);
+int sceSharedFbGetInfo(SceUID fb_id, SceSharedFbInfo *info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,45 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * sysmodule.h:
+ * Host replacement for the sceSysmodule subset used by vitaGL
+ */
+
+#ifndef _PSP2_SYSMODULE_H_
+#define _PSP2_SYSMODULE_H_
+
+#include <psp2/types.h>
+
+typedef enum SceSysmoduleModuleId {
+	SCE_SYSMODULE_RAZOR_HUD = 0x0034,
+	SCE_SYSMODULE_RAZOR_CAPTURE = 0x0035
+} SceSysmoduleModuleId;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int sceSysmoduleLoadModule(SceSysmoduleModuleId id);
+int sceSysmoduleUnloadModule(SceSysmoduleModuleId id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,52 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * types.h:
+ * Host replacement for the basic vitasdk types
+ */
+
+#ifndef _PSP2_TYPES_H_
+#define _PSP2_TYPES_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+typedef int SceUID;
+typedef unsigned int SceSize;
+typedef int SceSSize;
+typedef int SceInt;
+typedef int SceInt32;
+typedef unsigned int SceUInt;
+typedef unsigned int SceUInt32;
+typedef uint64_t SceUInt64;
+typedef int64_t SceInt64;
+typedef uint8_t SceUInt8;
+typedef uint16_t SceUInt16;
+typedef int8_t SceInt8;
+typedef char SceChar8;
+typedef int SceBool;
+typedef int64_t SceOff;
+typedef int SceMode;
+
+#define SCE_TRUE 1
+#define SCE_FALSE 0
+#define SCE_OK 0
+
+#endif
@@ -0,0 +1,130 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * vgl_mock.h:
+ * Inspection interface for the command log recorded by the host mock backend
+ */
+
+#ifndef _VGL_MOCK_H_
+#define _VGL_MOCK_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+	VGL_MOCK_CMD_ALLOC_MEMBLOCK, // obj = base, args = {uid, size, type}
+	VGL_MOCK_CMD_FREE_MEMBLOCK, // obj = base, args = {uid, size}
+	VGL_MOCK_CMD_MAP_MEMORY, // obj = base, args = {size, attribs}
+	VGL_MOCK_CMD_UNMAP_MEMORY, // obj = base, args = {size}
+	VGL_MOCK_CMD_CREATE_CONTEXT, // obj = context
+	VGL_MOCK_CMD_DESTROY_CONTEXT, // obj = context
+	VGL_MOCK_CMD_CREATE_RENDER_TARGET, // obj = render target, args = {width, height, msaa}
+	VGL_MOCK_CMD_DESTROY_RENDER_TARGET, // obj = render target
+	VGL_MOCK_CMD_COMPILE_PROGRAM, // obj = NULL, args = {shader type, params num, default uniform buffer size, success}
+	VGL_MOCK_CMD_REGISTER_PROGRAM, // obj = program id, args = {program size}
+	VGL_MOCK_CMD_UNREGISTER_PROGRAM, // obj = program id
+	VGL_MOCK_CMD_PATCH_VERTEX_PROGRAM, // obj = vertex program, args = {program id, attributes num, streams num}
+	VGL_MOCK_CMD_PATCH_FRAGMENT_PROGRAM, // obj = fragment program, args = {program id, output format, msaa, blending enabled}
+	VGL_MOCK_CMD_RELEASE_VERTEX_PROGRAM, // obj = vertex program
+	VGL_MOCK_CMD_RELEASE_FRAGMENT_PROGRAM, // obj = fragment program
+	VGL_MOCK_CMD_INIT_TEXTURE, // obj = texture, args = {format, width, height, mips num}
+	VGL_MOCK_CMD_SET_VERTEX_PROGRAM, // obj = vertex program
+	VGL_MOCK_CMD_SET_FRAGMENT_PROGRAM, // obj = fragment program
+	VGL_MOCK_CMD_SET_VERTEX_TEXTURE, // obj = texture data, args = {unit}
+	VGL_MOCK_CMD_SET_FRAGMENT_TEXTURE, // obj = texture data, args = {unit}
+	VGL_MOCK_CMD_SET_VERTEX_STREAM, // obj = stream data, args = {stream index}
+	VGL_MOCK_CMD_SET_VERTEX_UNIFORMS, // obj = default uniform buffer
+	VGL_MOCK_CMD_SET_FRAGMENT_UNIFORMS, // obj = default uniform buffer
+	VGL_MOCK_CMD_SET_STATE, // obj = context, args = {vglMockState, value, extra value, changed}
+	VGL_MOCK_CMD_BEGIN_SCENE, // obj = render target, args = {color surface data, depth surface data, flags}
+	VGL_MOCK_CMD_END_SCENE, // obj = render target, args = {draws in the scene}
+	VGL_MOCK_CMD_DRAW, // obj = index data, args = {primitive, index format, indices num, instances num}
+	VGL_MOCK_CMD_TRANSFER, // obj = destination, args = {source, width, height, downscale}
+	VGL_MOCK_CMD_DISPLAY, // obj = displayed sync object, args = {frame}
+	VGL_MOCK_CMD_NUM
+} vglMockCmdType;
+
+typedef enum {
+	VGL_MOCK_STATE_DEPTH_FUNC,
+	VGL_MOCK_STATE_DEPTH_WRITE,
+	VGL_MOCK_STATE_FRAGMENT_PROGRAM_ENABLE,
+	VGL_MOCK_STATE_STENCIL_FUNC,
+	VGL_MOCK_STATE_STENCIL_REF,
+	VGL_MOCK_STATE_POINT_LINE_WIDTH,
+	VGL_MOCK_STATE_POLYGON_MODE,
+	VGL_MOCK_STATE_DEPTH_BIAS,
+	VGL_MOCK_STATE_CULL_MODE,
+	VGL_MOCK_STATE_TWO_SIDED,
+	VGL_MOCK_STATE_REGION_CLIP,
+	VGL_MOCK_STATE_VIEWPORT,
+	VGL_MOCK_STATE_NUM
+} vglMockState;
+
+typedef enum {
+	VGL_MOCK_PATCHER_CREATE_VERTEX, // sceGxmShaderPatcherCreateVertexProgram
+	VGL_MOCK_PATCHER_CREATE_FRAGMENT, // sceGxmShaderPatcherCreateFragmentProgram and sceGxmShaderPatcherCreateMaskUpdateFragmentProgram
+	VGL_MOCK_PATCHER_RELEASE_VERTEX, // sceGxmShaderPatcherReleaseVertexProgram
+	VGL_MOCK_PATCHER_RELEASE_FRAGMENT, // sceGxmShaderPatcherReleaseFragmentProgram
+	VGL_MOCK_PATCHER_CALL_NUM
+} vglMockPatcherCall;
+
+typedef struct {
+	uint32_t type; // One of vglMockCmdType
+	uint32_t frame; // Displayed frames count when the command got issued
+	const void *obj; // Main object the command refers to
+	uint64_t args[4]; // Command specific arguments
+} vglMockCmd;
+
+typedef struct {
+	uint64_t cmds[VGL_MOCK_CMD_NUM]; // Issued commands per type
+	uint64_t states[VGL_MOCK_STATE_NUM]; // Setter calls per state
+	uint64_t redundant_states[VGL_MOCK_STATE_NUM]; // Setter calls that left the state untouched
+	uint64_t patcher_calls[VGL_MOCK_PATCHER_CALL_NUM]; // Successful calls per vglMockPatcherCall, including the ones sharing an already patched program
+	uint64_t redundant_binds; // Program, texture, stream and uniform buffer binds of the already bound object
+	uint64_t indices; // Indices submitted through draw calls
+	uint64_t uniform_writes; // sceGxmSetUniformDataF calls
+	uint64_t errors; // Detected API misuses
+	uint64_t mapped_bytes; // Memory currently mapped to the GPU
+	uint64_t allocated_bytes; // Memory currently allocated through memblocks
+	uint32_t frames; // Displayed frames
+	uint32_t live_programs; // Registered programs
+	uint32_t live_vertex_programs; // Patched vertex programs
+	uint32_t live_fragment_programs; // Patched fragment programs
+	uint32_t live_render_targets; // Created render targets
+} vglMockStats;
+
+void vglMockReset(void); // Clears the command log and the statistics
+const vglMockCmd *vglMockGetLog(uint32_t *num); // Returns the recorded commands
+void vglMockGetStats(vglMockStats *stats); // Returns the statistics gathered so far
+const char *vglMockGetLastError(void); // Returns the description of the last detected API misuse
+const char *vglMockCmdName(uint32_t type); // Returns a printable name for a command type
+const char *vglMockStateName(uint32_t state); // Returns a printable name for a state
+void vglMockDumpLog(FILE *f); // Writes the command log in text form
+void vglMockDumpStats(FILE *f); // Writes the statistics in text form
+void vglMockSetFrameLimit(uint32_t frames); // Makes the process exit after the given displayed frames (0 = no limit)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,74 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * mock.h:
+ * Internal header shared by the host mock backend sources
+ */
+
+#ifndef _MOCK_H_
+#define _MOCK_H_
+
+#include <psp2/gxm.h>
+#include <stdint.h>
+
+#include "vgl_mock.h"
+
+#define MOCK_PROGRAM_MAGIC 0x00505847 // 'GXP\0', same magic as real programs
+#define MOCK_NAME_MAX 64 // Maximum length for a parameter name
+
+// Compiled program layout, it's position independent since vitaGL copies programs around
+struct SceGxmProgram {
+	uint32_t magic;
+	uint32_t size; // Whole program size in bytes
+	uint32_t type; // 0 = vertex, 1 = fragment
+	uint32_t params_num;
+	uint32_t params_offset; // Offset of the parameters table from the program start
+	uint32_t default_uniform_size; // Default uniform buffer size in bytes
+	uint32_t source_hash; // Hash of the preprocessed source
+	uint32_t reserved;
+};
+
+struct SceGxmProgramParameter {
+	char name[MOCK_NAME_MAX];
+	uint8_t category; // One of SceGxmParameterCategory
+	uint8_t type; // One of SceGxmParameterType
+	uint8_t component_count;
+	uint8_t reserved;
+	uint32_t array_size;
+	uint32_t resource_index; // Attribute register, uniform buffer offset in words or texture unit
+};
+
+// Logging helpers
+void mock_log(vglMockCmdType type, const void *obj, uint64_t a0, uint64_t a1, uint64_t a2, uint64_t a3);
+void mock_log_state(SceGxmContext *ctx, vglMockState state, uint64_t value, uint64_t extra, int changed);
+void mock_redundant_bind(void);
+void mock_error(const char *fmt, ...);
+void mock_track_mapped(int64_t delta);
+void mock_track_allocated(int64_t delta);
+void mock_track_live(uint32_t *counter, int delta);
+void mock_count_indices(uint32_t count);
+void mock_count_patcher_call(vglMockPatcherCall call);
+void mock_count_uniform_write(void);
+void mock_frame_end(void);
+extern vglMockStats mock_stats;
+
+// Memory helpers
+int mock_addr_is_mapped(const void *addr);
+
+#endif
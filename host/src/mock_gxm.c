@@ -0,0 +1,1137 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * mock_gxm.c:
+ * Host replacement for sceGxm, it validates and records commands without rasterizing anything
+ */
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mock.h"
+
+#define NOTIFICATION_REGION_SIZE 512 // Number of notification words exposed to the application
+#define UNIFORM_RING_SIZE (8 * 1024 * 1024) // Size of the ring used for default uniform buffers reservations
+#define DISPLAY_CALLBACK_DATA_MAX 256 // Maximum size of the display queue callback data
+#define SCE_GXM_ERROR_PROGRAM_IN_USE 0x805B0012 // Unregistering a program with live patched programs
+
+#define VERTEX_PROGRAM_MAGIC 0x56505247 // 'GRPV'
+#define FRAGMENT_PROGRAM_MAGIC 0x46505247 // 'GRPF'
+
+enum {
+	SIDE_FRONT,
+	SIDE_BACK,
+	SIDES_NUM
+};
+
+typedef struct mapped_range {
+	uintptr_t base;
+	uint32_t size;
+	uint32_t attribs;
+	struct mapped_range *next;
+} mapped_range;
+
+struct SceGxmRegisteredProgram {
+	SceGxmProgram *prog; // Private copy of the registered program
+	const SceGxmProgram *header; // Program as passed at registration, owned by the caller as on real hardware
+	uint32_t users; // Patched programs referencing the program
+	int registered;
+	struct SceGxmRegisteredProgram *next;
+};
+
+struct SceGxmVertexProgram {
+	uint32_t magic;
+	uint32_t refs;
+	SceGxmRegisteredProgram *id;
+	SceGxmVertexAttribute attributes[SCE_GXM_MAX_VERTEX_ATTRIBUTES];
+	SceGxmVertexStream streams[SCE_GXM_MAX_VERTEX_STREAMS];
+	uint32_t attributes_num;
+	uint32_t streams_num;
+	struct SceGxmVertexProgram *next;
+};
+
+struct SceGxmFragmentProgram {
+	uint32_t magic;
+	uint32_t refs;
+	SceGxmRegisteredProgram *id; // NULL for mask update programs
+	uint32_t output_format;
+	uint32_t msaa;
+	int has_blend;
+	SceGxmBlendInfo blend;
+	struct SceGxmFragmentProgram *next;
+};
+
+struct SceGxmShaderPatcher {
+	SceGxmShaderPatcherParams params;
+	SceGxmRegisteredProgram *programs;
+	SceGxmVertexProgram *vertex_programs;
+	SceGxmFragmentProgram *fragment_programs;
+};
+
+struct SceGxmSyncObject {
+	uint32_t displayed;
+};
+
+struct SceGxmRenderTarget {
+	SceGxmRenderTargetParams params;
+};
+
+typedef struct {
+	int valid;
+	uint64_t value;
+	uint64_t extra;
+} state_slot;
+
+struct SceGxmContext {
+	SceGxmContextParams params;
+	const SceGxmVertexProgram *vertex_program;
+	const SceGxmFragmentProgram *fragment_program;
+	SceGxmTexture vertex_textures[SCE_GXM_MAX_TEXTURE_UNITS];
+	SceGxmTexture fragment_textures[SCE_GXM_MAX_TEXTURE_UNITS];
+	const void *streams[SCE_GXM_MAX_VERTEX_STREAMS];
+	const void *vertex_uniforms;
+	const void *fragment_uniforms;
+	state_slot states[VGL_MOCK_STATE_NUM][SIDES_NUM];
+	float viewport[6];
+	uint8_t *uniform_ring;
+	uint32_t uniform_ring_offset;
+	const SceGxmRenderTarget *scene_target;
+	int in_scene;
+	uint32_t scene_draws;
+};
+
+static volatile uint32_t notification_region[NOTIFICATION_REGION_SIZE];
+static SceGxmDisplayQueueCallback *display_callback = NULL;
+static uint32_t display_callback_data_size = 0;
+static mapped_range *mapped_ranges = NULL;
+static mapped_range *vertex_usse_ranges = NULL; // USSE mappings live in their own address spaces
+static mapped_range *fragment_usse_ranges = NULL;
+static pthread_mutex_t gxm_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int initialized = 0;
+
+/*
+ * Initialization and memory mapping
+ */
+int sceGxmInitialize(const SceGxmInitializeParams *params) {
+	if (!params)
+		return SCE_GXM_ERROR_INVALID_POINTER;
+	if (params->displayQueueCallbackDataSize > DISPLAY_CALLBACK_DATA_MAX)
+		return SCE_GXM_ERROR_INVALID_VALUE;
+	display_callback = params->displayQueueCallback;
+	display_callback_data_size = params->displayQueueCallbackDataSize;
+	initialized = 1;
+	return 0;
+}
+
+int sceGxmVshInitialize(const SceGxmInitializeParams *params) {
+	return sceGxmInitialize(params);
+}
+
+int sceGxmTerminate(void) {
+	if (!initialized)
+		mock_error("sceGxmTerminate called without sceGxmInitialize");
+	initialized = 0;
+	return 0;
+}
+
+volatile uint32_t *sceGxmGetNotificationRegion(void) {
+	return notification_region;
+}
+
+int sceGxmNotificationWait(const SceGxmNotification *notification) {
+	// GPU work completes as soon as it is submitted
+	return 0;
+}
+
+int mock_addr_is_mapped(const void *addr) {
+	uintptr_t a = (uintptr_t)addr;
+	int r = 0;
+	pthread_mutex_lock(&gxm_mutex);
+	for (mapped_range *m = mapped_ranges; m; m = m->next) {
+		if (a >= m->base && a < m->base + m->size) {
+			r = 1;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&gxm_mutex);
+	return r;
+}
+
+static int map_range(mapped_range **list, const char *func, void *base, SceSize size, uint32_t attribs) {
+	if (!base || !size)
+		return SCE_GXM_ERROR_INVALID_VALUE;
+	uintptr_t b = (uintptr_t)base;
+	pthread_mutex_lock(&gxm_mutex);
+	for (mapped_range *m = *list; m; m = m->next) {
+		if (b < m->base + m->size && m->base < b + size) {
+			pthread_mutex_unlock(&gxm_mutex);
+			mock_error("%s: range %p (0x%X bytes) overlaps an already mapped range", func, base, size);
+			return SCE_GXM_ERROR_INVALID_VALUE;
+		}
+	}
+	mapped_range *m = malloc(sizeof(mapped_range));
+	m->base = b;
+	m->size = size;
+	m->attribs = attribs;
+	m->next = *list;
+	*list = m;
+	pthread_mutex_unlock(&gxm_mutex);
+	mock_track_mapped(size);
+	mock_log(VGL_MOCK_CMD_MAP_MEMORY, base, size, attribs, 0, 0);
+	return 0;
+}
+
+static int unmap_range(mapped_range **list, const char *func, void *base) {
+	pthread_mutex_lock(&gxm_mutex);
+	mapped_range **p = list;
+	while (*p && (*p)->base != (uintptr_t)base)
+		p = &(*p)->next;
+	mapped_range *m = *p;
+	if (m)
+		*p = m->next;
+	pthread_mutex_unlock(&gxm_mutex);
+	if (!m) {
+		mock_error("%s: %p is not mapped", func, base);
+		return SCE_GXM_ERROR_INVALID_VALUE;
+	}
+	mock_track_mapped(-(int64_t)m->size);
+	mock_log(VGL_MOCK_CMD_UNMAP_MEMORY, base, m->size, 0, 0, 0);
+	free(m);
+	return 0;
+}
+
+int sceGxmMapMemory(void *base, SceSize size, SceGxmMemoryAttribFlags attr) {
+	return map_range(&mapped_ranges, __func__, base, size, attr);
+}
+
+int sceGxmUnmapMemory(void *base) {
+	return unmap_range(&mapped_ranges, __func__, base);
+}
+
+int sceGxmMapVertexUsseMemory(void *base, SceSize size, unsigned int *offset) {
+	*offset = 0;
+	return map_range(&vertex_usse_ranges, __func__, base, size, SCE_GXM_MEMORY_ATTRIB_READ);
+}
+
+int sceGxmUnmapVertexUsseMemory(void *base) {
+	return unmap_range(&vertex_usse_ranges, __func__, base);
+}
+
+int sceGxmMapFragmentUsseMemory(void *base, SceSize size, unsigned int *offset) {
+	*offset = 0;
+	return map_range(&fragment_usse_ranges, __func__, base, size, SCE_GXM_MEMORY_ATTRIB_READ);
+}
+
+int sceGxmUnmapFragmentUsseMemory(void *base) {
+	return unmap_range(&fragment_usse_ranges, __func__, base);
+}
+
+/*
+ * Display queue and sync objects
+ */
+int sceGxmDisplayQueueAddEntry(SceGxmSyncObject *oldBuffer, SceGxmSyncObject *newBuffer, const void *callbackData) {
+	if (!newBuffer)
+		return SCE_GXM_ERROR_INVALID_POINTER;
+	uint8_t data[DISPLAY_CALLBACK_DATA_MAX];
+	memcpy(data, callbackData, display_callback_data_size);
+	newBuffer->displayed++;
+	mock_log(VGL_MOCK_CMD_DISPLAY, newBuffer, mock_stats.frames, 0, 0, 0);
+	if (display_callback)
+		display_callback(data);
+	mock_frame_end();
+	return 0;
+}
+
+int sceGxmDisplayQueueFinish(void) {
+	return 0;
+}
+
+int sceGxmSyncObjectCreate(SceGxmSyncObject **syncObject) {
+	*syncObject = calloc(1, sizeof(SceGxmSyncObject));
+	return *syncObject ? 0 : SCE_GXM_ERROR_OUT_OF_MEMORY;
+}
+
+int sceGxmSyncObjectDestroy(SceGxmSyncObject *syncObject) {
+	free(syncObject);
+	return 0;
+}
+
+/*
+ * Contexts and render targets
+ */
+int sceGxmCreateContext(const SceGxmContextParams *params, SceGxmContext **context) {
+	if (!params || !context)
+		return SCE_GXM_ERROR_INVALID_POINTER;
+	if (params->hostMemSize < SCE_GXM_MINIMUM_CONTEXT_HOST_MEM_SIZE)
+		return SCE_GXM_ERROR_INVALID_VALUE;
+	SceGxmContext *ctx = calloc(1, sizeof(SceGxmContext));
+	if (!ctx)
+		return SCE_GXM_ERROR_OUT_OF_MEMORY;
+	ctx->uniform_ring = malloc(UNIFORM_RING_SIZE);
+	if (!ctx->uniform_ring) {
+		free(ctx);
+		return SCE_GXM_ERROR_OUT_OF_MEMORY;
+	}
+	ctx->params = *params;
+	*context = ctx;
+	mock_log(VGL_MOCK_CMD_CREATE_CONTEXT, ctx, 0, 0, 0, 0);
+	return 0;
+}
+
+int sceGxmDestroyContext(SceGxmContext *context) {
+	if (context->in_scene)
+		mock_error("sceGxmDestroyContext: context destroyed within a scene");
+	mock_log(VGL_MOCK_CMD_DESTROY_CONTEXT, context, 0, 0, 0, 0);
+	free(context->uniform_ring);
+	free(context);
+	return 0;
+}
+
+int sceGxmCreateRenderTarget(const SceGxmRenderTargetParams *params, SceGxmRenderTarget **renderTarget) {
+	if (!params || !renderTarget)
+		return SCE_GXM_ERROR_INVALID_POINTER;
+	if (!params->width || !params->height || params->width > 4096 || params->height > 4096)
+		return SCE_GXM_ERROR_INVALID_VALUE;
+	SceGxmRenderTarget *rt = malloc(sizeof(SceGxmRenderTarget));
+	if (!rt)
+		return SCE_GXM_ERROR_OUT_OF_MEMORY;
+	rt->params = *params;
+	*renderTarget = rt;
+	mock_track_live(&mock_stats.live_render_targets, 1);
+	mock_log(VGL_MOCK_CMD_CREATE_RENDER_TARGET, rt, params->width, params->height, params->multisampleMode, 0);
+	return 0;
+}
+
+int sceGxmDestroyRenderTarget(SceGxmRenderTarget *renderTarget) {
+	mock_track_live(&mock_stats.live_render_targets, -1);
+	mock_log(VGL_MOCK_CMD_DESTROY_RENDER_TARGET, renderTarget, 0, 0, 0, 0);
+	free(renderTarget);
+	return 0;
+}
+
+/*
+ * Scenes
+ */
+static void notify(const SceGxmNotification *notification) {
+	if (notification && notification->address)
+		*notification->address = notification->value;
+}
+
+int sceGxmBeginScene(SceGxmContext *context, unsigned int flags, const SceGxmRenderTarget *renderTarget, const SceGxmValidRegion *validRegion, SceGxmSyncObject *vertexSyncObject, SceGxmSyncObject *fragmentSyncObject, const SceGxmColorSurface *colorSurface, const SceGxmDepthStencilSurface *depthStencil) {
+	if (context->in_scene) {
+		mock_error("sceGxmBeginScene: a scene is already in progress");
+		return SCE_GXM_ERROR_WITHIN_SCENE;
+	}
+	if (!renderTarget)
+		return SCE_GXM_ERROR_INVALID_POINTER;
+	if (colorSurface && (colorSurface->width > renderTarget->params.width || colorSurface->height > renderTarget->params.height))
+		mock_error("sceGxmBeginScene: color surface (%ux%u) larger than render target (%ux%u)", colorSurface->width, colorSurface->height, renderTarget->params.width, renderTarget->params.height);
+	context->in_scene = 1;
+	context->scene_target = renderTarget;
+	context->scene_draws = 0;
+
+	// Viewport and region clip do not survive scene boundaries
+	context->states[VGL_MOCK_STATE_VIEWPORT][SIDE_FRONT].valid = 0;
+	context->states[VGL_MOCK_STATE_REGION_CLIP][SIDE_FRONT].valid = 0;
+	mock_log(VGL_MOCK_CMD_BEGIN_SCENE, renderTarget, (uintptr_t)(colorSurface ? colorSurface->data : NULL), (uintptr_t)(depthStencil ? depthStencil->depthData : NULL), flags, 0);
+	return 0;
+}
+
+int sceGxmEndScene(SceGxmContext *context, const SceGxmNotification *vertexNotification, const SceGxmNotification *fragmentNotification) {
+	if (!context->in_scene) {
+		mock_error("sceGxmEndScene: no scene in progress");
+		return SCE_GXM_ERROR_NOT_WITHIN_SCENE;
+	}
+	context->in_scene = 0;
+	mock_log(VGL_MOCK_CMD_END_SCENE, context->scene_target, context->scene_draws, 0, 0, 0);
+
+	// Scenes complete instantly, so notifications can be written straight away
+	notify(vertexNotification);
+	notify(fragmentNotification);
+	return 0;
+}
+
+int sceGxmFinish(SceGxmContext *context) {
+	if (context->in_scene)
+		mock_error("sceGxmFinish: called within a scene");
+	return 0;
+}
+
+int sceGxmPadHeartbeat(const SceGxmColorSurface *displaySurface, SceGxmSyncObject *displaySyncObject) {
+	return 0;
+}
+
+/*
+ * Programs and resources binding
+ */
+void sceGxmSetVertexProgram(SceGxmContext *context, const SceGxmVertexProgram *vertexProgram) {
+	if (vertexProgram && vertexProgram->magic != VERTEX_PROGRAM_MAGIC)
+		mock_error("sceGxmSetVertexProgram: %p is not a live vertex program", vertexProgram);
+	if (context->vertex_program == vertexProgram)
+		mock_redundant_bind();
+	context->vertex_program = vertexProgram;
+	mock_log(VGL_MOCK_CMD_SET_VERTEX_PROGRAM, vertexProgram, 0, 0, 0, 0);
+}
+
+void sceGxmSetFragmentProgram(SceGxmContext *context, const SceGxmFragmentProgram *fragmentProgram) {
+	if (fragmentProgram && fragmentProgram->magic != FRAGMENT_PROGRAM_MAGIC)
+		mock_error("sceGxmSetFragmentProgram: %p is not a live fragment program", fragmentProgram);
+	if (context->fragment_program == fragmentProgram)
+		mock_redundant_bind();
+	context->fragment_program = fragmentProgram;
+	mock_log(VGL_MOCK_CMD_SET_FRAGMENT_PROGRAM, fragmentProgram, 0, 0, 0, 0);
+}
+
+static int reserve_uniforms(SceGxmContext *context, const SceGxmProgram *prog, void **uniformBuffer) {
+	uint32_t size = (prog->default_uniform_size + 15) & ~15;
+	if (context->uniform_ring_offset + size > UNIFORM_RING_SIZE)
+		context->uniform_ring_offset = 0;
+	*uniformBuffer = context->uniform_ring + context->uniform_ring_offset;
+	context->uniform_ring_offset += size;
+	return 0;
+}
+
+int sceGxmReserveVertexDefaultUniformBuffer(SceGxmContext *context, void **uniformBuffer) {
+	if (!context->vertex_program) {
+		mock_error("sceGxmReserveVertexDefaultUniformBuffer: no vertex program set");
+		return SCE_GXM_ERROR_NULL_PROGRAM;
+	}
+	reserve_uniforms(context, context->vertex_program->id->prog, uniformBuffer);
+	context->vertex_uniforms = *uniformBuffer;
+	mock_log(VGL_MOCK_CMD_SET_VERTEX_UNIFORMS, *uniformBuffer, 0, 0, 0, 0);
+	return 0;
+}
+
+int sceGxmReserveFragmentDefaultUniformBuffer(SceGxmContext *context, void **uniformBuffer) {
+	if (!context->fragment_program || !context->fragment_program->id) {
+		mock_error("sceGxmReserveFragmentDefaultUniformBuffer: no fragment program set");
+		return SCE_GXM_ERROR_NULL_PROGRAM;
+	}
+	reserve_uniforms(context, context->fragment_program->id->prog, uniformBuffer);
+	context->fragment_uniforms = *uniformBuffer;
+	mock_log(VGL_MOCK_CMD_SET_FRAGMENT_UNIFORMS, *uniformBuffer, 0, 0, 0, 0);
+	return 0;
+}
+
+int sceGxmSetVertexDefaultUniformBuffer(SceGxmContext *context, const void *uniformBuffer) {
+	if (context->vertex_uniforms == uniformBuffer)
+		mock_redundant_bind();
+	context->vertex_uniforms = uniformBuffer;
+	mock_log(VGL_MOCK_CMD_SET_VERTEX_UNIFORMS, uniformBuffer, 0, 0, 0, 0);
+	return 0;
+}
+
+int sceGxmSetFragmentDefaultUniformBuffer(SceGxmContext *context, const void *uniformBuffer) {
+	if (context->fragment_uniforms == uniformBuffer)
+		mock_redundant_bind();
+	context->fragment_uniforms = uniformBuffer;
+	mock_log(VGL_MOCK_CMD_SET_FRAGMENT_UNIFORMS, uniformBuffer, 0, 0, 0, 0);
+	return 0;
+}
+
+int sceGxmSetUniformDataF(void *uniformBuffer, const SceGxmProgramParameter *parameter, unsigned int componentOffset, unsigned int componentCount, const float *sourceData) {
+	if (!uniformBuffer || !parameter || !sourceData)
+		return SCE_GXM_ERROR_INVALID_POINTER;
+	if (parameter->category != SCE_GXM_PARAMETER_CATEGORY_UNIFORM) {
+		mock_error("sceGxmSetUniformDataF: '%s' is not a uniform", parameter->name);
+		return SCE_GXM_ERROR_INVALID_VALUE;
+	}
+	if (componentOffset + componentCount > parameter->component_count * parameter->array_size) {
+		mock_error("sceGxmSetUniformDataF: writing components %u-%u of '%s' which has %u", componentOffset, componentOffset + componentCount, parameter->name, parameter->component_count * parameter->array_size);
+		return SCE_GXM_ERROR_INVALID_VALUE;
+	}
+	memcpy((uint8_t *)uniformBuffer + (parameter->resource_index + componentOffset) * 4, sourceData, componentCount * 4);
+	mock_count_uniform_write();
+	return 0;
+}
+
+int sceGxmSetVertexStream(SceGxmContext *context, unsigned int streamIndex, const void *streamData) {
+	if (streamIndex >= SCE_GXM_MAX_VERTEX_STREAMS)
+		return SCE_GXM_ERROR_INVALID_VALUE;
+	if (context->streams[streamIndex] == streamData)
+		mock_redundant_bind();
+	context->streams[streamIndex] = streamData;
+	mock_log(VGL_MOCK_CMD_SET_VERTEX_STREAM, streamData, streamIndex, 0, 0, 0);
+	return 0;
+}
+
+static int set_texture(SceGxmTexture *units, unsigned int textureIndex, const SceGxmTexture *texture, vglMockCmdType cmd) {
+	if (textureIndex >= SCE_GXM_MAX_TEXTURE_UNITS)
+		return SCE_GXM_ERROR_INVALID_VALUE;
+	if (!texture)
+		return SCE_GXM_ERROR_INVALID_POINTER;
+	if (!memcmp(&units[textureIndex], texture, sizeof(SceGxmTexture)))
+		mock_redundant_bind();
+	units[textureIndex] = *texture;
+	mock_log(cmd, texture->data, textureIndex, 0, 0, 0);
+	return 0;
+}
+
+int sceGxmSetVertexTexture(SceGxmContext *context, unsigned int textureIndex, const SceGxmTexture *texture) {
+	return set_texture(context->vertex_textures, textureIndex, texture, VGL_MOCK_CMD_SET_VERTEX_TEXTURE);
+}
+
+int sceGxmSetFragmentTexture(SceGxmContext *context, unsigned int textureIndex, const SceGxmTexture *texture) {
+	return set_texture(context->fragment_textures, textureIndex, texture, VGL_MOCK_CMD_SET_FRAGMENT_TEXTURE);
+}
+
+static int draw(SceGxmContext *context, SceGxmPrimitiveType primType, SceGxmIndexFormat indexType, const void *indexData, unsigned int indexCount, unsigned int instances) {
+	if (!context->in_scene) {
+		mock_error("sceGxmDraw: called outside of a scene");
+		return SCE_GXM_ERROR_NOT_WITHIN_SCENE;
+	}
+	if (!context->states[VGL_MOCK_STATE_VIEWPORT][SIDE_FRONT].valid)
+		mock_error("sceGxmDraw: viewport not set since scene start");
+	const SceGxmVertexProgram *vp = context->vertex_program;
+	if (!vp || !context->fragment_program) {
+		mock_error("sceGxmDraw: missing %s program", vp ? "fragment" : "vertex");
+		return SCE_GXM_ERROR_NULL_PROGRAM;
+	}
+	if (!vp->id->registered)
+		mock_error("sceGxmDraw: vertex program %p comes from an unregistered program", vp);
+	if (context->fragment_program->id && !context->fragment_program->id->registered)
+		mock_error("sceGxmDraw: fragment program %p comes from an unregistered program", context->fragment_program);
+	if (!indexData || !indexCount)
+		return SCE_GXM_ERROR_INVALID_VALUE;
+	if (!mock_addr_is_mapped(indexData))
+		mock_error("sceGxmDraw: index buffer %p is not mapped", indexData);
+	for (uint32_t i = 0; i < vp->streams_num; i++) {
+		if (!context->streams[i])
+			mock_error("sceGxmDraw: vertex stream %u not set", i);
+		else if (!mock_addr_is_mapped(context->streams[i]))
+			mock_error("sceGxmDraw: vertex stream %u (%p) is not mapped", i, context->streams[i]);
+	}
+	context->scene_draws++;
+	mock_count_indices(indexCount);
+	mock_log(VGL_MOCK_CMD_DRAW, indexData, primType, indexType, indexCount, instances);
+	return 0;
+}
+
+int sceGxmDraw(SceGxmContext *context, SceGxmPrimitiveType primType, SceGxmIndexFormat indexType, const void *indexData, unsigned int indexCount) {
+	return draw(context, primType, indexType, indexData, indexCount, 1);
+}
+
+int sceGxmDrawInstanced(SceGxmContext *context, SceGxmPrimitiveType primType, SceGxmIndexFormat indexType, const void *indexData, unsigned int indexCount, unsigned int indexWrap) {
+	if (!indexWrap || indexCount % indexWrap)
+		return SCE_GXM_ERROR_INVALID_VALUE;
+	return draw(context, primType, indexType, indexData, indexWrap, indexCount / indexWrap);
+}
+
+/*
+ * Fixed function states
+ */
+static void set_state(SceGxmContext *context, vglMockState state, int side, uint64_t value, uint64_t extra) {
+	state_slot *s = &context->states[state][side];
+	int changed = !s->valid || s->value != value || s->extra != extra;
+	s->valid = 1;
+	s->value = value;
+	s->extra = extra;
+	mock_log_state(context, state, value, extra, changed);
+}
+
+void sceGxmSetFrontDepthFunc(SceGxmContext *context, SceGxmDepthFunc depthFunc) {
+	set_state(context, VGL_MOCK_STATE_DEPTH_FUNC, SIDE_FRONT, depthFunc, SIDE_FRONT);
+}
+
+void sceGxmSetBackDepthFunc(SceGxmContext *context, SceGxmDepthFunc depthFunc) {
+	set_state(context, VGL_MOCK_STATE_DEPTH_FUNC, SIDE_BACK, depthFunc, SIDE_BACK);
+}
+
+void sceGxmSetFrontDepthWriteEnable(SceGxmContext *context, SceGxmDepthWriteMode enable) {
+	set_state(context, VGL_MOCK_STATE_DEPTH_WRITE, SIDE_FRONT, enable, SIDE_FRONT);
+}
+
+void sceGxmSetBackDepthWriteEnable(SceGxmContext *context, SceGxmDepthWriteMode enable) {
+	set_state(context, VGL_MOCK_STATE_DEPTH_WRITE, SIDE_BACK, enable, SIDE_BACK);
+}
+
+void sceGxmSetFrontFragmentProgramEnable(SceGxmContext *context, SceGxmFragmentProgramMode enable) {
+	set_state(context, VGL_MOCK_STATE_FRAGMENT_PROGRAM_ENABLE, SIDE_FRONT, enable, SIDE_FRONT);
+}
+
+void sceGxmSetBackFragmentProgramEnable(SceGxmContext *context, SceGxmFragmentProgramMode enable) {
+	set_state(context, VGL_MOCK_STATE_FRAGMENT_PROGRAM_ENABLE, SIDE_BACK, enable, SIDE_BACK);
+}
+
+static uint64_t pack_stencil_func(SceGxmStencilFunc func, SceGxmStencilOp stencilFail, SceGxmStencilOp depthFail, SceGxmStencilOp depthPass, unsigned char compareMask, unsigned char writeMask) {
+	return (uint64_t)func | ((uint64_t)stencilFail << 32) | ((uint64_t)depthFail << 36) | ((uint64_t)depthPass << 40) | ((uint64_t)compareMask << 48) | ((uint64_t)writeMask << 56);
+}
+
+void sceGxmSetFrontStencilFunc(SceGxmContext *context, SceGxmStencilFunc func, SceGxmStencilOp stencilFail, SceGxmStencilOp depthFail, SceGxmStencilOp depthPass, unsigned char compareMask, unsigned char writeMask) {
+	set_state(context, VGL_MOCK_STATE_STENCIL_FUNC, SIDE_FRONT, pack_stencil_func(func, stencilFail, depthFail, depthPass, compareMask, writeMask), SIDE_FRONT);
+}
+
+void sceGxmSetBackStencilFunc(SceGxmContext *context, SceGxmStencilFunc func, SceGxmStencilOp stencilFail, SceGxmStencilOp depthFail, SceGxmStencilOp depthPass, unsigned char compareMask, unsigned char writeMask) {
+	set_state(context, VGL_MOCK_STATE_STENCIL_FUNC, SIDE_BACK, pack_stencil_func(func, stencilFail, depthFail, depthPass, compareMask, writeMask), SIDE_BACK);
+}
+
+void sceGxmSetFrontStencilRef(SceGxmContext *context, unsigned int sref) {
+	set_state(context, VGL_MOCK_STATE_STENCIL_REF, SIDE_FRONT, sref, SIDE_FRONT);
+}
+
+void sceGxmSetBackStencilRef(SceGxmContext *context, unsigned int sref) {
+	set_state(context, VGL_MOCK_STATE_STENCIL_REF, SIDE_BACK, sref, SIDE_BACK);
+}
+
+void sceGxmSetFrontPointLineWidth(SceGxmContext *context, unsigned int width) {
+	set_state(context, VGL_MOCK_STATE_POINT_LINE_WIDTH, SIDE_FRONT, width, SIDE_FRONT);
+}
+
+void sceGxmSetBackPointLineWidth(SceGxmContext *context, unsigned int width) {
+	set_state(context, VGL_MOCK_STATE_POINT_LINE_WIDTH, SIDE_BACK, width, SIDE_BACK);
+}
+
+void sceGxmSetFrontPolygonMode(SceGxmContext *context, SceGxmPolygonMode mode) {
+	set_state(context, VGL_MOCK_STATE_POLYGON_MODE, SIDE_FRONT, mode, SIDE_FRONT);
+}
+
+void sceGxmSetBackPolygonMode(SceGxmContext *context, SceGxmPolygonMode mode) {
+	set_state(context, VGL_MOCK_STATE_POLYGON_MODE, SIDE_BACK, mode, SIDE_BACK);
+}
+
+void sceGxmSetFrontDepthBias(SceGxmContext *context, int factor, int units) {
+	set_state(context, VGL_MOCK_STATE_DEPTH_BIAS, SIDE_FRONT, (uint32_t)factor | ((uint64_t)(uint32_t)units << 32), SIDE_FRONT);
+}
+
+void sceGxmSetBackDepthBias(SceGxmContext *context, int factor, int units) {
+	set_state(context, VGL_MOCK_STATE_DEPTH_BIAS, SIDE_BACK, (uint32_t)factor | ((uint64_t)(uint32_t)units << 32), SIDE_BACK);
+}
+
+void sceGxmSetCullMode(SceGxmContext *context, SceGxmCullMode mode) {
+	set_state(context, VGL_MOCK_STATE_CULL_MODE, SIDE_FRONT, mode, 0);
+}
+
+void sceGxmSetTwoSidedEnable(SceGxmContext *context, SceGxmTwoSidedMode mode) {
+	set_state(context, VGL_MOCK_STATE_TWO_SIDED, SIDE_FRONT, mode, 0);
+}
+
+void sceGxmSetRegionClip(SceGxmContext *context, SceGxmRegionClipMode mode, unsigned int xMin, unsigned int yMin, unsigned int xMax, unsigned int yMax) {
+	set_state(context, VGL_MOCK_STATE_REGION_CLIP, SIDE_FRONT, mode, (uint64_t)xMin | ((uint64_t)yMin << 16) | ((uint64_t)xMax << 32) | ((uint64_t)yMax << 48));
+}
+
+void sceGxmSetViewport(SceGxmContext *context, float xOffset, float xScale, float yOffset, float yScale, float zOffset, float zScale) {
+	float v[6] = {xOffset, xScale, yOffset, yScale, zOffset, zScale};
+	state_slot *s = &context->states[VGL_MOCK_STATE_VIEWPORT][SIDE_FRONT];
+	int changed = !s->valid || memcmp(context->viewport, v, sizeof(v));
+	s->valid = 1;
+	memcpy(context->viewport, v, sizeof(v));
+
+	// Logged values hold the raw bits of the x and y transforms
+	uint32_t bits[4];
+	memcpy(bits, v, sizeof(bits));
+	mock_log_state(context, VGL_MOCK_STATE_VIEWPORT, bits[0] | ((uint64_t)bits[1] << 32), bits[2] | ((uint64_t)bits[3] << 32), changed);
+}
+
+void sceGxmSetViewport_sfp(SceGxmContext *context, float xOffset, float xScale, float yOffset, float yScale, float zOffset, float zScale) {
+	sceGxmSetViewport(context, xOffset, xScale, yOffset, yScale, zOffset, zScale);
+}
+
+/*
+ * Surfaces
+ */
+int sceGxmColorSurfaceInit(SceGxmColorSurface *surface, SceGxmColorFormat colorFormat, SceGxmColorSurfaceType surfaceType, SceGxmColorSurfaceScaleMode scaleMode, SceGxmOutputRegisterSize outputRegisterSize, unsigned int width, unsigned int height, unsigned int strideInPixels, void *data) {
+	if (!surface)
+		return SCE_GXM_ERROR_INVALID_POINTER;
+	if (!width || !height || strideInPixels < width)
+		return SCE_GXM_ERROR_INVALID_VALUE;
+	memset(surface, 0, sizeof(SceGxmColorSurface));
+	surface->data = data;
+	surface->colorFormat = colorFormat;
+	surface->surfaceType = surfaceType;
+	surface->scaleMode = scaleMode;
+	surface->outputRegisterSize = outputRegisterSize;
+	surface->width = width;
+	surface->height = height;
+	surface->strideInPixels = strideInPixels;
+	return 0;
+}
+
+int sceGxmDepthStencilSurfaceInit(SceGxmDepthStencilSurface *surface, SceGxmDepthStencilFormat depthStencilFormat, SceGxmDepthStencilSurfaceType surfaceType, unsigned int strideInSamples, void *depthData, void *stencilData) {
+	if (!surface)
+		return SCE_GXM_ERROR_INVALID_POINTER;
+	memset(surface, 0, sizeof(SceGxmDepthStencilSurface));
+	surface->depthData = depthData;
+	surface->stencilData = stencilData;
+	surface->format = depthStencilFormat;
+	surface->surfaceType = surfaceType;
+	surface->strideInSamples = strideInSamples;
+	surface->backgroundDepth = 1.0f;
+	return 0;
+}
+
+void sceGxmDepthStencilSurfaceSetForceStoreMode(SceGxmDepthStencilSurface *surface, SceGxmDepthStencilForceStoreMode forceStore) {
+	surface->forceStoreMode = forceStore;
+}
+
+/*
+ * Textures
+ */
+static int texture_init(SceGxmTexture *texture, const void *data, SceGxmTextureFormat texFormat, SceGxmTextureType type, unsigned int width, unsigned int height, unsigned int mipCount) {
+	if (!texture)
+		return SCE_GXM_ERROR_INVALID_POINTER;
+	if (!width || !height || width > 4096 || height > 4096 || mipCount > 13)
+		return SCE_GXM_ERROR_INVALID_VALUE;
+	memset(texture, 0, sizeof(SceGxmTexture));
+	texture->data = data;
+	texture->format = texFormat;
+	texture->type = type;
+	texture->width = width;
+	texture->height = height;
+	texture->mipCount = mipCount ? mipCount : 1;
+	mock_log(VGL_MOCK_CMD_INIT_TEXTURE, texture, texFormat, width, height, texture->mipCount);
+	return 0;
+}
+
+int sceGxmTextureInitLinear(SceGxmTexture *texture, const void *data, SceGxmTextureFormat texFormat, unsigned int width, unsigned int height, unsigned int mipCount) {
+	return texture_init(texture, data, texFormat, SCE_GXM_TEXTURE_LINEAR, width, height, mipCount);
+}
+
+int sceGxmTextureInitSwizzled(SceGxmTexture *texture, const void *data, SceGxmTextureFormat texFormat, unsigned int width, unsigned int height, unsigned int mipCount) {
+	return texture_init(texture, data, texFormat, SCE_GXM_TEXTURE_SWIZZLED, width, height, mipCount);
+}
+
+int sceGxmTextureInitSwizzledArbitrary(SceGxmTexture *texture, const void *data, SceGxmTextureFormat texFormat, unsigned int width, unsigned int height, unsigned int mipCount) {
+	return texture_init(texture, data, texFormat, SCE_GXM_TEXTURE_SWIZZLED_ARBITRARY, width, height, mipCount);
+}
+
+int sceGxmTextureInitCube(SceGxmTexture *texture, const void *data, SceGxmTextureFormat texFormat, unsigned int width, unsigned int height, unsigned int mipCount) {
+	return texture_init(texture, data, texFormat, SCE_GXM_TEXTURE_CUBE, width, height, mipCount);
+}
+
+int sceGxmTextureValidate(const SceGxmTexture *texture) {
+	if (!texture)
+		return SCE_GXM_ERROR_INVALID_POINTER;
+	return texture->width && texture->height ? 0 : SCE_GXM_ERROR_INVALID_VALUE;
+}
+
+int sceGxmTextureSetUAddrMode(SceGxmTexture *texture, SceGxmTextureAddrMode mode) {
+	texture->uAddrMode = mode;
+	return 0;
+}
+
+int sceGxmTextureSetVAddrMode(SceGxmTexture *texture, SceGxmTextureAddrMode mode) {
+	texture->vAddrMode = mode;
+	return 0;
+}
+
+int sceGxmTextureSetMinFilter(SceGxmTexture *texture, SceGxmTextureFilter minFilter) {
+	texture->minFilter = minFilter;
+	return 0;
+}
+
+int sceGxmTextureSetMagFilter(SceGxmTexture *texture, SceGxmTextureFilter magFilter) {
+	texture->magFilter = magFilter;
+	return 0;
+}
+
+int sceGxmTextureSetMipFilter(SceGxmTexture *texture, SceGxmTextureMipFilter mipFilter) {
+	texture->mipFilter = mipFilter;
+	return 0;
+}
+
+int sceGxmTextureSetLodBias(SceGxmTexture *texture, unsigned int bias) {
+	if (bias > 63)
+		return SCE_GXM_ERROR_INVALID_VALUE;
+	texture->lodBias = bias;
+	return 0;
+}
+
+int sceGxmTextureSetMipmapCount(SceGxmTexture *texture, unsigned int mipCount) {
+	if (mipCount > 13)
+		return SCE_GXM_ERROR_INVALID_VALUE;
+	texture->mipCount = mipCount ? mipCount : 1;
+	return 0;
+}
+
+int sceGxmTextureSetGammaMode(SceGxmTexture *texture, SceGxmTextureGammaMode gammaMode) {
+	texture->gammaMode = gammaMode;
+	return 0;
+}
+
+int sceGxmTextureSetPalette(SceGxmTexture *texture, const void *paletteData) {
+	texture->palette = paletteData;
+	return 0;
+}
+
+void *sceGxmTextureGetData(const SceGxmTexture *texture) {
+	return (void *)texture->data;
+}
+
+SceGxmTextureFormat sceGxmTextureGetFormat(const SceGxmTexture *texture) {
+	return texture->format;
+}
+
+unsigned int sceGxmTextureGetWidth(const SceGxmTexture *texture) {
+	return texture->width;
+}
+
+unsigned int sceGxmTextureGetHeight(const SceGxmTexture *texture) {
+	return texture->height;
+}
+
+unsigned int sceGxmTextureGetMipmapCount(const SceGxmTexture *texture) {
+	return texture->mipCount;
+}
+
+/*
+ * Program inspection
+ */
+static const SceGxmProgramParameter *program_params(const SceGxmProgram *program) {
+	return (const SceGxmProgramParameter *)((const uint8_t *)program + program->params_offset);
+}
+
+unsigned int sceGxmProgramGetSize(const SceGxmProgram *program) {
+	return program->size;
+}
+
+unsigned int sceGxmProgramGetParameterCount(const SceGxmProgram *program) {
+	return program->params_num;
+}
+
+const SceGxmProgramParameter *sceGxmProgramGetParameter(const SceGxmProgram *program, unsigned int index) {
+	return index < program->params_num ? &program_params(program)[index] : NULL;
+}
+
+const SceGxmProgramParameter *sceGxmProgramFindParameterByName(const SceGxmProgram *program, const char *name) {
+	const SceGxmProgramParameter *params = program_params(program);
+	for (uint32_t i = 0; i < program->params_num; i++) {
+		if (!strcmp(params[i].name, name))
+			return &params[i];
+	}
+	return NULL;
+}
+
+unsigned int sceGxmProgramGetDefaultUniformBufferSize(const SceGxmProgram *program) {
+	return program->default_uniform_size;
+}
+
+const char *sceGxmProgramParameterGetName(const SceGxmProgramParameter *parameter) {
+	return parameter->name;
+}
+
+SceGxmParameterCategory sceGxmProgramParameterGetCategory(const SceGxmProgramParameter *parameter) {
+	return parameter->category;
+}
+
+SceGxmParameterType sceGxmProgramParameterGetType(const SceGxmProgramParameter *parameter) {
+	return parameter->type;
+}
+
+unsigned int sceGxmProgramParameterGetComponentCount(const SceGxmProgramParameter *parameter) {
+	return parameter->component_count;
+}
+
+unsigned int sceGxmProgramParameterGetArraySize(const SceGxmProgramParameter *parameter) {
+	return parameter->array_size;
+}
+
+unsigned int sceGxmProgramParameterGetResourceIndex(const SceGxmProgramParameter *parameter) {
+	return parameter->resource_index;
+}
+
+/*
+ * Shader patcher
+ */
+int sceGxmShaderPatcherCreate(const SceGxmShaderPatcherParams *params, SceGxmShaderPatcher **shaderPatcher) {
+	if (!params || !shaderPatcher)
+		return SCE_GXM_ERROR_INVALID_POINTER;
+	SceGxmShaderPatcher *p = calloc(1, sizeof(SceGxmShaderPatcher));
+	if (!p)
+		return SCE_GXM_ERROR_OUT_OF_MEMORY;
+	p->params = *params;
+	*shaderPatcher = p;
+	return 0;
+}
+
+static void free_registered_program(SceGxmShaderPatcher *p, SceGxmRegisteredProgram *id) {
+	SceGxmRegisteredProgram **r = &p->programs;
+	while (*r && *r != id)
+		r = &(*r)->next;
+	if (*r)
+		*r = id->next;
+	free(id->prog);
+	free(id);
+}
+
+static void drop_program_user(SceGxmShaderPatcher *p, SceGxmRegisteredProgram *id) {
+	if (!id)
+		return;
+	id->users--;
+	if (!id->users && !id->registered)
+		free_registered_program(p, id);
+}
+
+static void free_vertex_program(SceGxmShaderPatcher *p, SceGxmVertexProgram *prog) {
+	SceGxmVertexProgram **v = &p->vertex_programs;
+	while (*v != prog)
+		v = &(*v)->next;
+	*v = prog->next;
+	mock_log(VGL_MOCK_CMD_RELEASE_VERTEX_PROGRAM, prog, 0, 0, 0, 0);
+	mock_track_live(&mock_stats.live_vertex_programs, -1);
+	drop_program_user(p, prog->id);
+	prog->magic = 0;
+	free(prog);
+}
+
+static void free_fragment_program(SceGxmShaderPatcher *p, SceGxmFragmentProgram *prog) {
+	SceGxmFragmentProgram **f = &p->fragment_programs;
+	while (*f != prog)
+		f = &(*f)->next;
+	*f = prog->next;
+	mock_log(VGL_MOCK_CMD_RELEASE_FRAGMENT_PROGRAM, prog, 0, 0, 0, 0);
+	mock_track_live(&mock_stats.live_fragment_programs, -1);
+	drop_program_user(p, prog->id);
+	prog->magic = 0;
+	free(prog);
+}
+
+int sceGxmShaderPatcherDestroy(SceGxmShaderPatcher *shaderPatcher) {
+	// Everything still alive gets released along with the patcher
+	while (shaderPatcher->vertex_programs) {
+		SceGxmVertexProgram *v = shaderPatcher->vertex_programs;
+		shaderPatcher->vertex_programs = v->next;
+		v->magic = 0;
+		mock_track_live(&mock_stats.live_vertex_programs, -1);
+		free(v);
+	}
+	while (shaderPatcher->fragment_programs) {
+		SceGxmFragmentProgram *f = shaderPatcher->fragment_programs;
+		shaderPatcher->fragment_programs = f->next;
+		f->magic = 0;
+		mock_track_live(&mock_stats.live_fragment_programs, -1);
+		free(f);
+	}
+	while (shaderPatcher->programs) {
+		SceGxmRegisteredProgram *r = shaderPatcher->programs;
+		shaderPatcher->programs = r->next;
+		if (r->registered)
+			mock_track_live(&mock_stats.live_programs, -1);
+		free(r->prog);
+		free(r);
+	}
+	free(shaderPatcher);
+	return 0;
+}
+
+int sceGxmShaderPatcherRegisterProgram(SceGxmShaderPatcher *shaderPatcher, const SceGxmProgram *programHeader, SceGxmShaderPatcherId *programId) {
+	if (!programHeader || !programId)
+		return SCE_GXM_ERROR_INVALID_POINTER;
+	if (programHeader->magic != MOCK_PROGRAM_MAGIC) {
+		mock_error("sceGxmShaderPatcherRegisterProgram: %p is not a valid program", programHeader);
+		return SCE_GXM_ERROR_INVALID_VALUE;
+	}
+	SceGxmRegisteredProgram *r = calloc(1, sizeof(SceGxmRegisteredProgram));
+	r->prog = malloc(programHeader->size);
+	memcpy(r->prog, programHeader, programHeader->size);
+	r->header = programHeader;
+	r->registered = 1;
+	r->next = shaderPatcher->programs;
+	shaderPatcher->programs = r;
+	*programId = r;
+	mock_track_live(&mock_stats.live_programs, 1);
+	mock_log(VGL_MOCK_CMD_REGISTER_PROGRAM, r, programHeader->size, 0, 0, 0);
+	return 0;
+}
+
+static int unregister_program(SceGxmShaderPatcher *shaderPatcher, SceGxmShaderPatcherId programId, int force) {
+	if (!programId || !programId->registered) {
+		mock_error("sceGxmShaderPatcherUnregisterProgram: %p is not registered", programId);
+		return SCE_GXM_ERROR_INVALID_VALUE;
+	}
+	if (programId->users && !force) {
+		mock_error("sceGxmShaderPatcherUnregisterProgram: %p still has %u patched programs", programId, programId->users);
+		return SCE_GXM_ERROR_PROGRAM_IN_USE;
+	}
+	programId->registered = 0;
+	mock_track_live(&mock_stats.live_programs, -1);
+	mock_log(VGL_MOCK_CMD_UNREGISTER_PROGRAM, programId, 0, 0, 0, 0);
+
+	// Force unregistering releases every program patched from it, whatever its references, as the real patcher does.
+	// The last one released frees the program too
+	if (force && programId->users) {
+		SceGxmVertexProgram *v = shaderPatcher->vertex_programs;
+		while (v) {
+			SceGxmVertexProgram *next = v->next;
+			if (v->id == programId)
+				free_vertex_program(shaderPatcher, v);
+			v = next;
+		}
+		SceGxmFragmentProgram *f = shaderPatcher->fragment_programs;
+		while (f) {
+			SceGxmFragmentProgram *next = f->next;
+			if (f->id == programId)
+				free_fragment_program(shaderPatcher, f);
+			f = next;
+		}
+		return 0;
+	}
+	if (!programId->users)
+		free_registered_program(shaderPatcher, programId);
+	return 0;
+}
+
+int sceGxmShaderPatcherUnregisterProgram(SceGxmShaderPatcher *shaderPatcher, SceGxmShaderPatcherId programId) {
+	return unregister_program(shaderPatcher, programId, 0);
+}
+
+int sceGxmShaderPatcherForceUnregisterProgram(SceGxmShaderPatcher *shaderPatcher, SceGxmShaderPatcherId programId) {
+	return unregister_program(shaderPatcher, programId, 1);
+}
+
+const SceGxmProgram *sceGxmShaderPatcherGetProgramFromId(SceGxmShaderPatcherId programId) {
+	return programId ? programId->header : NULL;
+}
+
+int sceGxmShaderPatcherCreateVertexProgram(SceGxmShaderPatcher *shaderPatcher, SceGxmShaderPatcherId programId, const SceGxmVertexAttribute *attributes, unsigned int attributeCount, const SceGxmVertexStream *streams, unsigned int streamCount, SceGxmVertexProgram **vertexProgram) {
+	if (!programId || !vertexProgram)
+		return SCE_GXM_ERROR_INVALID_POINTER;
+	if (!programId->registered || programId->prog->type != 0) {
+		mock_error("sceGxmShaderPatcherCreateVertexProgram: %p is not a registered vertex program", programId);
+		return SCE_GXM_ERROR_INVALID_VALUE;
+	}
+	if (attributeCount > SCE_GXM_MAX_VERTEX_ATTRIBUTES || streamCount > SCE_GXM_MAX_VERTEX_STREAMS)
+		return SCE_GXM_ERROR_INVALID_VALUE;
+	for (uint32_t i = 0; i < attributeCount; i++) {
+		if (attributes[i].streamIndex >= streamCount) {
+			mock_error("sceGxmShaderPatcherCreateVertexProgram: attribute %u reads from missing stream %u", i, attributes[i].streamIndex);
+			return SCE_GXM_ERROR_INVALID_VALUE;
+		}
+	}
+
+	// Identical requests share the same patched program as the real patcher does
+	mock_count_patcher_call(VGL_MOCK_PATCHER_CREATE_VERTEX);
+	for (SceGxmVertexProgram *v = shaderPatcher->vertex_programs; v; v = v->next) {
+		if (v->id == programId && v->attributes_num == attributeCount && v->streams_num == streamCount &&
+			!memcmp(v->attributes, attributes, attributeCount * sizeof(SceGxmVertexAttribute)) &&
+			!memcmp(v->streams, streams, streamCount * sizeof(SceGxmVertexStream))) {
+			v->refs++;
+			*vertexProgram = v;
+			return 0;
+		}
+	}
+
+	SceGxmVertexProgram *v = calloc(1, sizeof(SceGxmVertexProgram));
+	if (!v)
+		return SCE_GXM_ERROR_OUT_OF_MEMORY;
+	v->magic = VERTEX_PROGRAM_MAGIC;
+	v->refs = 1;
+	v->id = programId;
+	memcpy(v->attributes, attributes, attributeCount * sizeof(SceGxmVertexAttribute));
+	memcpy(v->streams, streams, streamCount * sizeof(SceGxmVertexStream));
+	v->attributes_num = attributeCount;
+	v->streams_num = streamCount;
+	v->next = shaderPatcher->vertex_programs;
+	shaderPatcher->vertex_programs = v;
+	programId->users++;
+	*vertexProgram = v;
+	mock_track_live(&mock_stats.live_vertex_programs, 1);
+	mock_log(VGL_MOCK_CMD_PATCH_VERTEX_PROGRAM, v, (uintptr_t)programId, attributeCount, streamCount, 0);
+	return 0;
+}
+
+static int create_fragment_program(SceGxmShaderPatcher *shaderPatcher, SceGxmShaderPatcherId programId, SceGxmOutputRegisterFormat outputFormat, SceGxmMultisampleMode multisampleMode, const SceGxmBlendInfo *blendInfo, SceGxmFragmentProgram **fragmentProgram) {
+	mock_count_patcher_call(VGL_MOCK_PATCHER_CREATE_FRAGMENT);
+	for (SceGxmFragmentProgram *f = shaderPatcher->fragment_programs; f; f = f->next) {
+		if (f->id == programId && f->output_format == outputFormat && f->msaa == multisampleMode && f->has_blend == (blendInfo != NULL) &&
+			(!blendInfo || !memcmp(&f->blend, blendInfo, sizeof(SceGxmBlendInfo)))) {
+			f->refs++;
+			*fragmentProgram = f;
+			return 0;
+		}
+	}
+
+	SceGxmFragmentProgram *f = calloc(1, sizeof(SceGxmFragmentProgram));
+	if (!f)
+		return SCE_GXM_ERROR_OUT_OF_MEMORY;
+	f->magic = FRAGMENT_PROGRAM_MAGIC;
+	f->refs = 1;
+	f->id = programId;
+	f->output_format = outputFormat;
+	f->msaa = multisampleMode;
+	f->has_blend = blendInfo != NULL;
+	if (blendInfo)
+		f->blend = *blendInfo;
+	f->next = shaderPatcher->fragment_programs;
+	shaderPatcher->fragment_programs = f;
+	if (programId)
+		programId->users++;
+	*fragmentProgram = f;
+	mock_track_live(&mock_stats.live_fragment_programs, 1);
+	mock_log(VGL_MOCK_CMD_PATCH_FRAGMENT_PROGRAM, f, (uintptr_t)programId, outputFormat, multisampleMode, blendInfo != NULL);
+	return 0;
+}
+
+int sceGxmShaderPatcherCreateFragmentProgram(SceGxmShaderPatcher *shaderPatcher, SceGxmShaderPatcherId programId, SceGxmOutputRegisterFormat outputFormat, SceGxmMultisampleMode multisampleMode, const SceGxmBlendInfo *blendInfo, const SceGxmProgram *vertexProgram, SceGxmFragmentProgram **fragmentProgram) {
+	if (!programId || !fragmentProgram)
+		return SCE_GXM_ERROR_INVALID_POINTER;
+	if (!programId->registered || programId->prog->type != 1) {
+		mock_error("sceGxmShaderPatcherCreateFragmentProgram: %p is not a registered fragment program", programId);
+		return SCE_GXM_ERROR_INVALID_VALUE;
+	}
+	return create_fragment_program(shaderPatcher, programId, outputFormat, multisampleMode, blendInfo, fragmentProgram);
+}
+
+int sceGxmShaderPatcherCreateMaskUpdateFragmentProgram(SceGxmShaderPatcher *shaderPatcher, SceGxmFragmentProgram **fragmentProgram) {
+	return create_fragment_program(shaderPatcher, NULL, SCE_GXM_OUTPUT_REGISTER_FORMAT_DECLARED, SCE_GXM_MULTISAMPLE_NONE, NULL, fragmentProgram);
+}
+
+int sceGxmShaderPatcherReleaseVertexProgram(SceGxmShaderPatcher *shaderPatcher, SceGxmVertexProgram *vertexProgram) {
+	if (!vertexProgram || vertexProgram->magic != VERTEX_PROGRAM_MAGIC) {
+		mock_error("sceGxmShaderPatcherReleaseVertexProgram: %p is not a live vertex program", vertexProgram);
+		return SCE_GXM_ERROR_INVALID_VALUE;
+	}
+	mock_count_patcher_call(VGL_MOCK_PATCHER_RELEASE_VERTEX);
+	if (!--vertexProgram->refs)
+		free_vertex_program(shaderPatcher, vertexProgram);
+	return 0;
+}
+
+int sceGxmShaderPatcherReleaseFragmentProgram(SceGxmShaderPatcher *shaderPatcher, SceGxmFragmentProgram *fragmentProgram) {
+	if (!fragmentProgram || fragmentProgram->magic != FRAGMENT_PROGRAM_MAGIC) {
+		mock_error("sceGxmShaderPatcherReleaseFragmentProgram: %p is not a live fragment program", fragmentProgram);
+		return SCE_GXM_ERROR_INVALID_VALUE;
+	}
+	mock_count_patcher_call(VGL_MOCK_PATCHER_RELEASE_FRAGMENT);
+	if (!--fragmentProgram->refs)
+		free_fragment_program(shaderPatcher, fragmentProgram);
+	return 0;
+}
+
+/*
+ * Transfers
+ */
+int sceGxmTransferCopy(uint32_t width, uint32_t height, uint32_t colorKeyValue, uint32_t colorKeyMask, SceGxmTransferColorKeyMode colorKeyMode, SceGxmTransferFormat srcFormat, SceGxmTransferType srcType, const void *srcAddress, uint32_t srcX, uint32_t srcY, int32_t srcStride, SceGxmTransferFormat destFormat, SceGxmTransferType destType, void *destAddress, uint32_t destX, uint32_t destY, int32_t destStride, SceGxmSyncObject *syncObject, uint32_t syncFlags, const SceGxmNotification *notification) {
+	if (!srcAddress || !destAddress)
+		return SCE_GXM_ERROR_INVALID_POINTER;
+	mock_log(VGL_MOCK_CMD_TRANSFER, destAddress, (uintptr_t)srcAddress, width, height, 0);
+	notify(notification);
+	return 0;
+}
+
+int sceGxmTransferDownscale(SceGxmTransferFormat srcFormat, const void *srcAddress, unsigned int srcX, unsigned int srcY, unsigned int srcWidth, unsigned int srcHeight, int srcStride, SceGxmTransferFormat destFormat, void *destAddress, unsigned int destX, unsigned int destY, int destStride, SceGxmSyncObject *syncObject, unsigned int syncFlags, const SceGxmNotification *notification) {
+	if (!srcAddress || !destAddress)
+		return SCE_GXM_ERROR_INVALID_POINTER;
+	mock_log(VGL_MOCK_CMD_TRANSFER, destAddress, (uintptr_t)srcAddress, srcWidth, srcHeight, 1);
+	notify(notification);
+	return 0;
+}
+
+int sceGxmTransferFinish(void) {
+	return 0;
+}
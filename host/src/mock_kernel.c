@@ -0,0 +1,648 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * mock_kernel.c:
+ * Host replacement for SceKernel, SceSysmem, SceClib and SceDmac
+ */
+#include <malloc.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/personality.h>
+#include <time.h>
+#include <unistd.h>
+#include <vitasdk.h>
+
+#include "mock.h"
+#include "utils/tlsf_utils.h"
+
+#define MAX_UIDS 1024 // Maximum number of live kernel objects
+#define UID_BASE 0x40010000 // First returned uid, real ones are positive too
+#define HEAP_MAPPED_SIZE (512 * 1024 * 1024) // Size reported for the process heap mapping
+#define LOW_MMAP_BASE 0x40000000 // Start of the area MAP_32BIT memblocks are placed in
+
+#define SCE_KERNEL_ERROR_ERROR 0x80020001
+#define SCE_KERNEL_ERROR_ILLEGAL_SIZE 0x800200B2
+#define SCE_KERNEL_ERROR_NO_MEMORY 0x80020190
+#define SCE_KERNEL_ERROR_UNKNOWN_UID 0x80020002
+#define SCE_KERNEL_ERROR_INVALID_MEMBLOCK_TYPE 0x800201B9
+
+// Memory budgets reported to the application, they match a common Vita application
+#define FREE_USER_SIZE (320 * 1024 * 1024)
+#define FREE_CDRAM_SIZE (112 * 1024 * 1024)
+#define FREE_PHYCONT_SIZE (26 * 1024 * 1024)
+
+typedef enum {
+	OBJ_NONE,
+	OBJ_MEMBLOCK,
+	OBJ_THREAD,
+	OBJ_SEMA,
+	OBJ_MUTEX
+} obj_type;
+
+typedef struct {
+	void *base;
+	SceSize size;
+	SceKernelMemBlockType type;
+} memblock;
+
+typedef struct {
+	pthread_t handle;
+	SceKernelThreadEntry entry;
+	SceSize arglen;
+	void *argp;
+	int started;
+	int exit_status;
+} thread;
+
+typedef struct {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	int count;
+	int max;
+} sema;
+
+typedef struct {
+	obj_type type;
+	void *obj;
+} uid_entry;
+
+typedef struct mspace {
+	tlsf_pool pool;
+	uintptr_t base;
+	SceSize capacity;
+	SceSize peak;
+	pthread_mutex_t mutex;
+	struct mspace *next;
+} mspace;
+
+static uid_entry uids[MAX_UIDS];
+static pthread_mutex_t uid_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uintptr_t heap_base = 0;
+static uint64_t allocated[3] = {0}; // User, cdram and phycont memory currently allocated
+static mspace *mspaces = NULL;
+static pthread_mutex_t mspace_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct timespec process_start;
+
+__attribute__((constructor)) static void mock_kernel_init(int argc, char **argv) {
+	// Randomized program breaks can start right below LOW_MMAP_BASE, leaving no room for the heap to grow without
+	// falling back to mmap outside of the reported mapping, so the process is executed again without randomization
+	int persona = personality(0xFFFFFFFF);
+	if (persona != -1 && !(persona & ADDR_NO_RANDOMIZE) && personality(persona | ADDR_NO_RANDOMIZE) != -1)
+		execv("/proc/self/exe", argv);
+
+	// Keeping all malloc allocations inside the process heap so that it can be reported as a single mapping
+	mallopt(M_MMAP_MAX, 0);
+	mallopt(M_ARENA_MAX, 1);
+	void *dummy = malloc(1);
+	FILE *f = fopen("/proc/self/maps", "r");
+	if (f) {
+		char line[512];
+		while (fgets(line, sizeof(line), f)) {
+			if (strstr(line, "[heap]")) {
+				heap_base = strtoull(line, NULL, 16);
+				break;
+			}
+		}
+		fclose(f);
+	}
+	if (!heap_base)
+		heap_base = (uintptr_t)dummy & ~0xFFF;
+	free(dummy);
+	clock_gettime(CLOCK_MONOTONIC, &process_start);
+}
+
+static SceUID uid_alloc(obj_type type, void *obj) {
+	pthread_mutex_lock(&uid_mutex);
+	for (int i = 0; i < MAX_UIDS; i++) {
+		if (uids[i].type == OBJ_NONE) {
+			uids[i].type = type;
+			uids[i].obj = obj;
+			pthread_mutex_unlock(&uid_mutex);
+			return UID_BASE + i;
+		}
+	}
+	pthread_mutex_unlock(&uid_mutex);
+	return SCE_KERNEL_ERROR_NO_MEMORY;
+}
+
+static void *uid_get(SceUID uid, obj_type type) {
+	uint32_t i = uid - UID_BASE;
+	if (i >= MAX_UIDS || uids[i].type != type)
+		return NULL;
+	return uids[i].obj;
+}
+
+static void uid_free(SceUID uid) {
+	pthread_mutex_lock(&uid_mutex);
+	uids[uid - UID_BASE].type = OBJ_NONE;
+	uids[uid - UID_BASE].obj = NULL;
+	pthread_mutex_unlock(&uid_mutex);
+}
+
+/*
+ * Memory blocks
+ */
+static int memblock_budget(SceKernelMemBlockType type) {
+	switch (type) {
+	case SCE_KERNEL_MEMBLOCK_TYPE_USER_CDRAM_RW:
+		return 1;
+	case SCE_KERNEL_MEMBLOCK_TYPE_USER_MAIN_PHYCONT_RW:
+	case SCE_KERNEL_MEMBLOCK_TYPE_USER_MAIN_PHYCONT_NC_RW:
+		return 2;
+	default:
+		return 0;
+	}
+}
+
+SceUID sceKernelAllocMemBlock(const char *name, SceKernelMemBlockType type, SceSize size, SceKernelAllocMemBlockOpt *opt) {
+	SceSize alignment;
+	switch (type) {
+	case SCE_KERNEL_MEMBLOCK_TYPE_USER_CDRAM_RW:
+		alignment = 256 * 1024;
+		break;
+	case SCE_KERNEL_MEMBLOCK_TYPE_USER_MAIN_PHYCONT_RW:
+	case SCE_KERNEL_MEMBLOCK_TYPE_USER_MAIN_PHYCONT_NC_RW:
+		alignment = 1024 * 1024;
+		break;
+	case SCE_KERNEL_MEMBLOCK_TYPE_USER_RW:
+	case SCE_KERNEL_MEMBLOCK_TYPE_USER_RW_UNCACHE:
+	case SCE_KERNEL_MEMBLOCK_TYPE_USER_MAIN_CDIALOG_RW:
+	case SCE_KERNEL_MEMBLOCK_TYPE_USER_MAIN_CDIALOG_NC_RW:
+		alignment = 4 * 1024;
+		break;
+	default:
+		mock_error("sceKernelAllocMemBlock: unknown memblock type 0x%08X for '%s'", type, name);
+		return SCE_KERNEL_ERROR_INVALID_MEMBLOCK_TYPE;
+	}
+	if (!size || size % alignment) {
+		mock_error("sceKernelAllocMemBlock: size 0x%X of '%s' is not aligned to 0x%X", size, name, alignment);
+		return SCE_KERNEL_ERROR_ILLEGAL_SIZE;
+	}
+	// vitaGL stores pointers in 32 bit GL names, so memblocks are kept in the low address space
+	void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_32BIT, -1, 0);
+	if (base == MAP_FAILED)
+		return SCE_KERNEL_ERROR_NO_MEMORY;
+	memblock *m = malloc(sizeof(memblock));
+	m->base = base;
+	m->size = size;
+	m->type = type;
+	SceUID uid = uid_alloc(OBJ_MEMBLOCK, m);
+	if (uid < 0) {
+		munmap(base, size);
+		free(m);
+		return uid;
+	}
+	allocated[memblock_budget(type)] += size;
+	mock_track_allocated(size);
+	mock_log(VGL_MOCK_CMD_ALLOC_MEMBLOCK, base, uid, size, type, 0);
+	return uid;
+}
+
+int sceKernelFreeMemBlock(SceUID uid) {
+	memblock *m = uid_get(uid, OBJ_MEMBLOCK);
+	if (!m)
+		return SCE_KERNEL_ERROR_UNKNOWN_UID;
+	if (mock_addr_is_mapped(m->base))
+		mock_error("sceKernelFreeMemBlock: memblock %p is still mapped to the GPU", m->base);
+	mock_log(VGL_MOCK_CMD_FREE_MEMBLOCK, m->base, uid, m->size, 0, 0);
+	allocated[memblock_budget(m->type)] -= m->size;
+	mock_track_allocated(-(int64_t)m->size);
+	munmap(m->base, m->size);
+	uid_free(uid);
+	free(m);
+	return 0;
+}
+
+int sceKernelGetMemBlockBase(SceUID uid, void **base) {
+	memblock *m = uid_get(uid, OBJ_MEMBLOCK);
+	if (!m)
+		return SCE_KERNEL_ERROR_UNKNOWN_UID;
+	*base = m->base;
+	return 0;
+}
+
+static SceUID find_memblock(const void *addr) {
+	uintptr_t a = (uintptr_t)addr;
+	SceUID r = SCE_KERNEL_ERROR_UNKNOWN_UID;
+	pthread_mutex_lock(&uid_mutex);
+	for (int i = 0; i < MAX_UIDS; i++) {
+		memblock *m = uids[i].obj;
+		if (uids[i].type == OBJ_MEMBLOCK && a >= (uintptr_t)m->base && a < (uintptr_t)m->base + m->size) {
+			r = UID_BASE + i;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&uid_mutex);
+	return r;
+}
+
+SceUID sceKernelFindMemBlockByAddr(const void *addr, SceSize size) {
+	return find_memblock(addr);
+}
+
+int sceKernelGetMemBlockInfoByAddr(void *base, SceKernelMemBlockInfo *info) {
+	SceUID uid = find_memblock(base);
+	if (uid >= 0) {
+		memblock *m = uid_get(uid, OBJ_MEMBLOCK);
+		info->mappedBase = m->base;
+		info->mappedSize = m->size;
+		info->type = m->type;
+	} else {
+		// Anything else lives in the process heap, mapped as a single block as newlib one on Vita
+		info->mappedBase = (void *)heap_base;
+		info->mappedSize = HEAP_MAPPED_SIZE;
+		if (heap_base < LOW_MMAP_BASE && heap_base + HEAP_MAPPED_SIZE > LOW_MMAP_BASE)
+			info->mappedSize = LOW_MMAP_BASE - heap_base;
+		info->type = SCE_KERNEL_MEMBLOCK_TYPE_USER_RW;
+	}
+	info->memoryType = 0;
+	info->access = 6;
+	return 0;
+}
+
+int sceKernelGetFreeMemorySize(SceKernelFreeMemorySizeInfo *info) {
+	info->size_user = FREE_USER_SIZE - allocated[0];
+	info->size_cdram = FREE_CDRAM_SIZE - allocated[1];
+	info->size_phycont = FREE_PHYCONT_SIZE - allocated[2];
+	return 0;
+}
+
+/*
+ * Threads and synchronization
+ */
+static void *thread_entry(void *arg) {
+	thread *t = arg;
+	t->exit_status = t->entry(t->arglen, t->argp);
+	return NULL;
+}
+
+SceUID sceKernelCreateThread(const char *name, SceKernelThreadEntry entry, int initPriority, SceSize stackSize, SceUInt attr, int cpuAffinityMask, const void *option) {
+	thread *t = calloc(1, sizeof(thread));
+	if (!t)
+		return SCE_KERNEL_ERROR_NO_MEMORY;
+	t->entry = entry;
+	SceUID uid = uid_alloc(OBJ_THREAD, t);
+	if (uid < 0)
+		free(t);
+	return uid;
+}
+
+int sceKernelStartThread(SceUID thid, SceSize arglen, void *argp) {
+	thread *t = uid_get(thid, OBJ_THREAD);
+	if (!t)
+		return SCE_KERNEL_ERROR_UNKNOWN_UID;
+	if (t->started)
+		return SCE_KERNEL_ERROR_ERROR;
+
+	// Arguments are copied as the real kernel does
+	t->arglen = arglen;
+	if (arglen && argp) {
+		t->argp = malloc(arglen);
+		memcpy(t->argp, argp, arglen);
+	}
+	t->started = 1;
+	return pthread_create(&t->handle, NULL, thread_entry, t) ? SCE_KERNEL_ERROR_ERROR : 0;
+}
+
+int sceKernelWaitThreadEnd(SceUID thid, int *stat, SceUInt *timeout) {
+	thread *t = uid_get(thid, OBJ_THREAD);
+	if (!t)
+		return SCE_KERNEL_ERROR_UNKNOWN_UID;
+	if (t->started) {
+		pthread_join(t->handle, NULL);
+		t->started = 0;
+	}
+	if (stat)
+		*stat = t->exit_status;
+	return 0;
+}
+
+int sceKernelDeleteThread(SceUID thid) {
+	thread *t = uid_get(thid, OBJ_THREAD);
+	if (!t)
+		return SCE_KERNEL_ERROR_UNKNOWN_UID;
+	if (t->started)
+		pthread_detach(t->handle);
+	uid_free(thid);
+	free(t->argp);
+	free(t);
+	return 0;
+}
+
+int sceKernelExitDeleteThread(int status) {
+	// Threads are joined or detached by their owner, so exiting is enough
+	pthread_exit(NULL);
+	return 0;
+}
+
+int sceKernelDelayThread(SceUInt delay) {
+	usleep(delay);
+	return 0;
+}
+
+SceUID sceKernelGetThreadId(void) {
+	return (SceUID)(pthread_self() & 0x7FFFFFFF);
+}
+
+SceUID sceKernelCreateSema(const char *name, SceUInt attr, int initVal, int maxVal, void *option) {
+	sema *s = malloc(sizeof(sema));
+	if (!s)
+		return SCE_KERNEL_ERROR_NO_MEMORY;
+	pthread_mutex_init(&s->mutex, NULL);
+	pthread_cond_init(&s->cond, NULL);
+	s->count = initVal;
+	s->max = maxVal;
+	SceUID uid = uid_alloc(OBJ_SEMA, s);
+	if (uid < 0)
+		free(s);
+	return uid;
+}
+
+int sceKernelDeleteSema(SceUID semaid) {
+	sema *s = uid_get(semaid, OBJ_SEMA);
+	if (!s)
+		return SCE_KERNEL_ERROR_UNKNOWN_UID;
+	uid_free(semaid);
+	pthread_cond_destroy(&s->cond);
+	pthread_mutex_destroy(&s->mutex);
+	free(s);
+	return 0;
+}
+
+int sceKernelWaitSema(SceUID semaid, int signal, SceUInt *timeout) {
+	sema *s = uid_get(semaid, OBJ_SEMA);
+	if (!s)
+		return SCE_KERNEL_ERROR_UNKNOWN_UID;
+	pthread_mutex_lock(&s->mutex);
+	while (s->count < signal)
+		pthread_cond_wait(&s->cond, &s->mutex);
+	s->count -= signal;
+	pthread_mutex_unlock(&s->mutex);
+	return 0;
+}
+
+int sceKernelSignalSema(SceUID semaid, int signal) {
+	sema *s = uid_get(semaid, OBJ_SEMA);
+	if (!s)
+		return SCE_KERNEL_ERROR_UNKNOWN_UID;
+	pthread_mutex_lock(&s->mutex);
+	if (s->count + signal > s->max) {
+		pthread_mutex_unlock(&s->mutex);
+		return SCE_KERNEL_ERROR_ERROR;
+	}
+	s->count += signal;
+	pthread_cond_broadcast(&s->cond);
+	pthread_mutex_unlock(&s->mutex);
+	return 0;
+}
+
+SceUID sceKernelCreateMutex(const char *name, SceUInt attr, int initCount, void *option) {
+	pthread_mutex_t *m = malloc(sizeof(pthread_mutex_t));
+	if (!m)
+		return SCE_KERNEL_ERROR_NO_MEMORY;
+	pthread_mutexattr_t a;
+	pthread_mutexattr_init(&a);
+	pthread_mutexattr_settype(&a, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(m, &a);
+	pthread_mutexattr_destroy(&a);
+	for (int i = 0; i < initCount; i++)
+		pthread_mutex_lock(m);
+	SceUID uid = uid_alloc(OBJ_MUTEX, m);
+	if (uid < 0)
+		free(m);
+	return uid;
+}
+
+int sceKernelDeleteMutex(SceUID mutexid) {
+	pthread_mutex_t *m = uid_get(mutexid, OBJ_MUTEX);
+	if (!m)
+		return SCE_KERNEL_ERROR_UNKNOWN_UID;
+	uid_free(mutexid);
+	pthread_mutex_destroy(m);
+	free(m);
+	return 0;
+}
+
+int sceKernelLockMutex(SceUID mutexid, int lockCount, unsigned int *timeout) {
+	pthread_mutex_t *m = uid_get(mutexid, OBJ_MUTEX);
+	if (!m)
+		return SCE_KERNEL_ERROR_UNKNOWN_UID;
+	for (int i = 0; i < lockCount; i++)
+		pthread_mutex_lock(m);
+	return 0;
+}
+
+int sceKernelUnlockMutex(SceUID mutexid, int unlockCount) {
+	pthread_mutex_t *m = uid_get(mutexid, OBJ_MUTEX);
+	if (!m)
+		return SCE_KERNEL_ERROR_UNKNOWN_UID;
+	for (int i = 0; i < unlockCount; i++)
+		pthread_mutex_unlock(m);
+	return 0;
+}
+
+/*
+ * Process and modules
+ */
+SceUID sceKernelGetProcessId(void) {
+	return getpid();
+}
+
+SceInt64 sceKernelGetProcessTimeWide(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (SceInt64)(t.tv_sec - process_start.tv_sec) * 1000000 + (t.tv_nsec - process_start.tv_nsec) / 1000;
+}
+
+SceUInt32 sceKernelGetProcessTimeLow(void) {
+	return (SceUInt32)sceKernelGetProcessTimeWide();
+}
+
+int sceKernelExitProcess(int res) {
+	exit(res);
+}
+
+SceUID sceKernelLoadStartModule(const char *path, SceSize args, void *argp, int flags, void *option, int *status) {
+	// Prx modules can't be loaded on the host, callers fall back to their module-less paths
+	return SCE_KERNEL_ERROR_ERROR;
+}
+
+int sceKernelStopUnloadModule(SceUID modid, SceSize args, void *argp, int flags, void *option, int *status) {
+	return SCE_KERNEL_ERROR_UNKNOWN_UID;
+}
+
+/*
+ * SceClib
+ */
+void *sceClibMemset(void *dst, int ch, SceSize len) {
+	return memset(dst, ch, len);
+}
+
+void *sceClibMemcpy(void *dst, const void *src, SceSize len) {
+	return memcpy(dst, src, len);
+}
+
+void *sceClibMemmove(void *dst, const void *src, SceSize len) {
+	return memmove(dst, src, len);
+}
+
+int sceClibMemcmp(const void *s1, const void *s2, SceSize len) {
+	return memcmp(s1, s2, len);
+}
+
+int sceClibPrintf(const char *fmt, ...) {
+	va_list list;
+	va_start(list, fmt);
+	int r = vprintf(fmt, list);
+	va_end(list);
+	return r;
+}
+
+int sceClibSnprintf(char *dst, SceSize dst_max_size, const char *fmt, ...) {
+	va_list list;
+	va_start(list, fmt);
+	int r = vsnprintf(dst, dst_max_size, fmt, list);
+	va_end(list);
+	return r;
+}
+
+void *sceDmacMemcpy(void *dst, const void *src, SceSize size) {
+	return memcpy(dst, src, size);
+}
+
+void *sceDmacMemset(void *dst, int ch, SceSize size) {
+	return memset(dst, ch, size);
+}
+
+/*
+ * Mspaces, backed by the same TLSF allocator vitaGL uses for its custom heap
+ */
+SceClibMspace sceClibMspaceCreate(void *base, SceSize capacity) {
+	mspace *m = calloc(1, sizeof(mspace));
+	if (!m)
+		return NULL;
+	tlsf_init(&m->pool);
+	if (!tlsf_add_region(&m->pool, base, capacity)) {
+		tlsf_destroy(&m->pool);
+		free(m);
+		return NULL;
+	}
+	m->base = (uintptr_t)base;
+	m->capacity = capacity;
+	pthread_mutex_init(&m->mutex, NULL);
+	pthread_mutex_lock(&mspace_mutex);
+	m->next = mspaces;
+	mspaces = m;
+	pthread_mutex_unlock(&mspace_mutex);
+	return m;
+}
+
+void sceClibMspaceDestroy(SceClibMspace msp) {
+	mspace *m = msp;
+	if (!m)
+		return;
+	pthread_mutex_lock(&mspace_mutex);
+	mspace **p = &mspaces;
+	while (*p && *p != m)
+		p = &(*p)->next;
+	if (*p)
+		*p = m->next;
+	pthread_mutex_unlock(&mspace_mutex);
+	tlsf_destroy(&m->pool);
+	pthread_mutex_destroy(&m->mutex);
+	free(m);
+}
+
+static void update_peak(mspace *m) {
+	SceSize in_use = m->pool.total_size - m->pool.free_size;
+	if (in_use > m->peak)
+		m->peak = in_use;
+}
+
+void *sceClibMspaceMemalign(SceClibMspace msp, SceSize alignment, SceSize size) {
+	mspace *m = msp;
+	pthread_mutex_lock(&m->mutex);
+	void *r = tlsf_alloc(&m->pool, size, alignment);
+	update_peak(m);
+	pthread_mutex_unlock(&m->mutex);
+	return r;
+}
+
+void *sceClibMspaceMalloc(SceClibMspace msp, SceSize size) {
+	return sceClibMspaceMemalign(msp, 8, size);
+}
+
+void *sceClibMspaceCalloc(SceClibMspace msp, SceSize num, SceSize size) {
+	void *r = sceClibMspaceMalloc(msp, num * size);
+	if (r)
+		memset(r, 0, num * size);
+	return r;
+}
+
+void *sceClibMspaceRealloc(SceClibMspace msp, void *ptr, SceSize size) {
+	mspace *m = msp;
+	if (!ptr)
+		return sceClibMspaceMalloc(msp, size);
+	pthread_mutex_lock(&m->mutex);
+	void *r = tlsf_realloc(&m->pool, ptr, size);
+	update_peak(m);
+	pthread_mutex_unlock(&m->mutex);
+	return r;
+}
+
+void sceClibMspaceFree(SceClibMspace msp, void *ptr) {
+	mspace *m = msp;
+	if (!ptr)
+		return;
+	pthread_mutex_lock(&m->mutex);
+	if (!tlsf_free(&m->pool, ptr))
+		mock_error("sceClibMspaceFree: %p was not allocated from mspace %p", ptr, msp);
+	pthread_mutex_unlock(&m->mutex);
+}
+
+SceSize sceClibMspaceMallocUsableSize(void *ptr) {
+	uintptr_t a = (uintptr_t)ptr;
+	SceSize r = 0;
+	pthread_mutex_lock(&mspace_mutex);
+	for (mspace *m = mspaces; m; m = m->next) {
+		if (a >= m->base && a < m->base + m->capacity) {
+			pthread_mutex_lock(&m->mutex);
+			r = tlsf_usable_size(&m->pool, ptr);
+			pthread_mutex_unlock(&m->mutex);
+			break;
+		}
+	}
+	pthread_mutex_unlock(&mspace_mutex);
+	return r;
+}
+
+int sceClibMspaceMallocStats(SceClibMspace msp, SceClibMspaceStats *stats) {
+	mspace *m = msp;
+	memset(stats, 0, sizeof(SceClibMspaceStats));
+	pthread_mutex_lock(&m->mutex);
+	stats->capacity = m->capacity;
+	stats->peak_in_use = m->peak;
+	stats->current_in_use = m->pool.total_size - m->pool.free_size;
+	pthread_mutex_unlock(&m->mutex);
+	return 0;
+}
@@ -0,0 +1,280 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * mock_log.c:
+ * Command log and statistics for the host mock backend
+ */
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mock.h"
+
+#define LOG_DEFAULT_LIMIT (4 * 1024 * 1024) // Default maximum number of recorded commands
+
+vglMockStats mock_stats;
+
+static vglMockCmd *cmds = NULL;
+static uint32_t cmds_num = 0;
+static uint32_t cmds_capacity = 0;
+static uint32_t cmds_limit = LOG_DEFAULT_LIMIT;
+static uint32_t frame_limit = 0;
+static char last_error[256] = "";
+static pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static const char *cmd_names[VGL_MOCK_CMD_NUM] = {
+	"ALLOC_MEMBLOCK",
+	"FREE_MEMBLOCK",
+	"MAP_MEMORY",
+	"UNMAP_MEMORY",
+	"CREATE_CONTEXT",
+	"DESTROY_CONTEXT",
+	"CREATE_RENDER_TARGET",
+	"DESTROY_RENDER_TARGET",
+	"COMPILE_PROGRAM",
+	"REGISTER_PROGRAM",
+	"UNREGISTER_PROGRAM",
+	"PATCH_VERTEX_PROGRAM",
+	"PATCH_FRAGMENT_PROGRAM",
+	"RELEASE_VERTEX_PROGRAM",
+	"RELEASE_FRAGMENT_PROGRAM",
+	"INIT_TEXTURE",
+	"SET_VERTEX_PROGRAM",
+	"SET_FRAGMENT_PROGRAM",
+	"SET_VERTEX_TEXTURE",
+	"SET_FRAGMENT_TEXTURE",
+	"SET_VERTEX_STREAM",
+	"SET_VERTEX_UNIFORMS",
+	"SET_FRAGMENT_UNIFORMS",
+	"SET_STATE",
+	"BEGIN_SCENE",
+	"END_SCENE",
+	"DRAW",
+	"TRANSFER",
+	"DISPLAY",
+};
+
+static const char *state_names[VGL_MOCK_STATE_NUM] = {
+	"DEPTH_FUNC",
+	"DEPTH_WRITE",
+	"FRAGMENT_PROGRAM_ENABLE",
+	"STENCIL_FUNC",
+	"STENCIL_REF",
+	"POINT_LINE_WIDTH",
+	"POLYGON_MODE",
+	"DEPTH_BIAS",
+	"CULL_MODE",
+	"TWO_SIDED",
+	"REGION_CLIP",
+	"VIEWPORT",
+};
+
+static void dump_at_exit(void) {
+	const char *path = getenv("VGL_MOCK_LOG");
+	if (path) {
+		FILE *f = fopen(path, "w");
+		if (f) {
+			vglMockDumpLog(f);
+			fclose(f);
+		}
+	}
+	if (getenv("VGL_MOCK_STATS"))
+		vglMockDumpStats(stderr);
+}
+
+__attribute__((constructor)) static void mock_log_init(void) {
+	const char *s = getenv("VGL_MOCK_FRAMES");
+	if (s)
+		frame_limit = strtoul(s, NULL, 0);
+	s = getenv("VGL_MOCK_LOG_LIMIT");
+	if (s)
+		cmds_limit = strtoul(s, NULL, 0);
+	atexit(dump_at_exit);
+}
+
+void mock_log(vglMockCmdType type, const void *obj, uint64_t a0, uint64_t a1, uint64_t a2, uint64_t a3) {
+	pthread_mutex_lock(&log_mutex);
+	mock_stats.cmds[type]++;
+	if (cmds_num < cmds_limit) {
+		if (cmds_num == cmds_capacity) {
+			uint32_t capacity = cmds_capacity ? cmds_capacity * 2 : 4096;
+			vglMockCmd *c = realloc(cmds, capacity * sizeof(vglMockCmd));
+			if (!c) {
+				pthread_mutex_unlock(&log_mutex);
+				return;
+			}
+			cmds = c;
+			cmds_capacity = capacity;
+		}
+		vglMockCmd *c = &cmds[cmds_num++];
+		c->type = type;
+		c->frame = mock_stats.frames;
+		c->obj = obj;
+		c->args[0] = a0;
+		c->args[1] = a1;
+		c->args[2] = a2;
+		c->args[3] = a3;
+	}
+	pthread_mutex_unlock(&log_mutex);
+}
+
+void mock_log_state(SceGxmContext *ctx, vglMockState state, uint64_t value, uint64_t extra, int changed) {
+	mock_stats.states[state]++;
+	if (!changed)
+		mock_stats.redundant_states[state]++;
+	mock_log(VGL_MOCK_CMD_SET_STATE, ctx, state, value, extra, changed);
+}
+
+void mock_redundant_bind(void) {
+	mock_stats.redundant_binds++;
+}
+
+void mock_error(const char *fmt, ...) {
+	va_list list;
+	pthread_mutex_lock(&log_mutex);
+	va_start(list, fmt);
+	vsnprintf(last_error, sizeof(last_error), fmt, list);
+	va_end(list);
+	mock_stats.errors++;
+	pthread_mutex_unlock(&log_mutex);
+	if (getenv("VGL_MOCK_VERBOSE"))
+		fprintf(stderr, "[vgl_mock] %s\n", last_error);
+}
+
+void mock_track_mapped(int64_t delta) {
+	pthread_mutex_lock(&log_mutex);
+	mock_stats.mapped_bytes += delta;
+	pthread_mutex_unlock(&log_mutex);
+}
+
+void mock_track_allocated(int64_t delta) {
+	pthread_mutex_lock(&log_mutex);
+	mock_stats.allocated_bytes += delta;
+	pthread_mutex_unlock(&log_mutex);
+}
+
+void mock_track_live(uint32_t *counter, int delta) {
+	pthread_mutex_lock(&log_mutex);
+	*counter += delta;
+	pthread_mutex_unlock(&log_mutex);
+}
+
+void mock_count_indices(uint32_t count) {
+	mock_stats.indices += count;
+}
+
+void mock_count_patcher_call(vglMockPatcherCall call) {
+	mock_stats.patcher_calls[call]++;
+}
+
+void mock_count_uniform_write(void) {
+	mock_stats.uniform_writes++;
+}
+
+void mock_frame_end(void) {
+	mock_stats.frames++;
+	if (frame_limit && mock_stats.frames >= frame_limit)
+		exit(0);
+}
+
+void vglMockReset(void) {
+	pthread_mutex_lock(&log_mutex);
+	cmds_num = 0;
+	uint64_t mapped = mock_stats.mapped_bytes;
+	uint64_t allocated = mock_stats.allocated_bytes;
+	uint32_t frames = mock_stats.frames;
+	uint32_t live[4] = {mock_stats.live_programs, mock_stats.live_vertex_programs, mock_stats.live_fragment_programs, mock_stats.live_render_targets};
+	memset(&mock_stats, 0, sizeof(vglMockStats));
+
+	// Resources and frames counters describe the current status, so they survive resets
+	mock_stats.mapped_bytes = mapped;
+	mock_stats.allocated_bytes = allocated;
+	mock_stats.frames = frames;
+	mock_stats.live_programs = live[0];
+	mock_stats.live_vertex_programs = live[1];
+	mock_stats.live_fragment_programs = live[2];
+	mock_stats.live_render_targets = live[3];
+	last_error[0] = 0;
+	pthread_mutex_unlock(&log_mutex);
+}
+
+const vglMockCmd *vglMockGetLog(uint32_t *num) {
+	*num = cmds_num;
+	return cmds;
+}
+
+void vglMockGetStats(vglMockStats *stats) {
+	pthread_mutex_lock(&log_mutex);
+	memcpy(stats, &mock_stats, sizeof(vglMockStats));
+	pthread_mutex_unlock(&log_mutex);
+}
+
+const char *vglMockGetLastError(void) {
+	return last_error;
+}
+
+const char *vglMockCmdName(uint32_t type) {
+	return type < VGL_MOCK_CMD_NUM ? cmd_names[type] : "UNKNOWN";
+}
+
+const char *vglMockStateName(uint32_t state) {
+	return state < VGL_MOCK_STATE_NUM ? state_names[state] : "UNKNOWN";
+}
+
+void vglMockDumpLog(FILE *f) {
+	uint32_t i;
+	for (i = 0; i < cmds_num; i++) {
+		vglMockCmd *c = &cmds[i];
+		fprintf(f, "%u %s %p", c->frame, vglMockCmdName(c->type), c->obj);
+		if (c->type == VGL_MOCK_CMD_SET_STATE)
+			fprintf(f, " %s", vglMockStateName(c->args[0]));
+		fprintf(f, " 0x%" PRIx64 " 0x%" PRIx64 " 0x%" PRIx64 " 0x%" PRIx64 "\n", c->args[0], c->args[1], c->args[2], c->args[3]);
+	}
+}
+
+void vglMockDumpStats(FILE *f) {
+	vglMockStats s;
+	vglMockGetStats(&s);
+	fprintf(f, "frames: %u\n", s.frames);
+	for (int i = 0; i < VGL_MOCK_CMD_NUM; i++) {
+		if (s.cmds[i])
+			fprintf(f, "cmd %s: %" PRIu64 "\n", vglMockCmdName(i), s.cmds[i]);
+	}
+	for (int i = 0; i < VGL_MOCK_STATE_NUM; i++) {
+		if (s.states[i])
+			fprintf(f, "state %s: %" PRIu64 " (%" PRIu64 " redundant)\n", vglMockStateName(i), s.states[i], s.redundant_states[i]);
+	}
+	fprintf(f, "redundant binds: %" PRIu64 "\n", s.redundant_binds);
+	fprintf(f, "indices: %" PRIu64 "\n", s.indices);
+	fprintf(f, "uniform writes: %" PRIu64 "\n", s.uniform_writes);
+	fprintf(f, "mapped bytes: %" PRIu64 "\n", s.mapped_bytes);
+	fprintf(f, "allocated bytes: %" PRIu64 "\n", s.allocated_bytes);
+	fprintf(f, "patcher calls: %" PRIu64 " vertex creates, %" PRIu64 " fragment creates, %" PRIu64 " vertex releases, %" PRIu64 " fragment releases\n",
+		s.patcher_calls[VGL_MOCK_PATCHER_CREATE_VERTEX], s.patcher_calls[VGL_MOCK_PATCHER_CREATE_FRAGMENT], s.patcher_calls[VGL_MOCK_PATCHER_RELEASE_VERTEX], s.patcher_calls[VGL_MOCK_PATCHER_RELEASE_FRAGMENT]);
+	fprintf(f, "live programs: %u registered, %u vertex, %u fragment\n", s.live_programs, s.live_vertex_programs, s.live_fragment_programs);
+	fprintf(f, "live render targets: %u\n", s.live_render_targets);
+	fprintf(f, "errors: %" PRIu64 "%s%s\n", s.errors, s.errors ? ", last: " : "", s.errors ? last_error : "");
+}
+
+void vglMockSetFrameLimit(uint32_t frames) {
+	frame_limit = frames;
+}
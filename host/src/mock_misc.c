@@ -0,0 +1,226 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * mock_misc.c:
+ * Host replacement for SceDisplay, SceAppMgr, SceCommonDialog, SceSharedFb, SceRtc,
+ * SceSysmodule, SceCtrl and SceIo
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <psp2/sharedfb.h>
+#include <vitasdk.h>
+
+#include "mock.h"
+
+#define DISPLAY_WIDTH 960
+#define DISPLAY_HEIGHT 544
+#define APP_PREFIX "app0:" // Application files are looked up in the working directory
+
+#define SCE_ERROR_ERRNO(e) ((int)(0x80010000 | (e)))
+#define SCE_APPMGR_ERROR_NOT_SYSTEM_APP 0x80800001
+
+static SceDisplayFrameBuf current_fb = {0};
+
+/*
+ * SceDisplay
+ */
+int sceDisplaySetFrameBuf(const SceDisplayFrameBuf *pParam, SceDisplaySetBufSync sync) {
+	if (pParam->width > DISPLAY_WIDTH || pParam->height > DISPLAY_HEIGHT || pParam->pitch < pParam->width) {
+		mock_error("sceDisplaySetFrameBuf: invalid framebuffer %ux%u (pitch %u)", pParam->width, pParam->height, pParam->pitch);
+		return SCE_ERROR_ERRNO(EINVAL);
+	}
+	current_fb = *pParam;
+	return 0;
+}
+
+int sceDisplayGetFrameBuf(SceDisplayFrameBuf *pParam, SceDisplaySetBufSync sync) {
+	*pParam = current_fb;
+	return 0;
+}
+
+int sceDisplayGetMaximumFrameBufResolution(int *width, int *height) {
+	*width = DISPLAY_WIDTH;
+	*height = DISPLAY_HEIGHT;
+	return 0;
+}
+
+int sceDisplayWaitVblankStart(void) {
+	// No actual display, frames are produced as fast as possible
+	return 0;
+}
+
+int sceDisplayWaitVblankStartMulti(unsigned int vcount) {
+	return 0;
+}
+
+/*
+ * SceAppMgr and SceCommonDialog
+ */
+int sceAppMgrGetBudgetInfo(SceAppMgrBudgetInfo *info) {
+	// Host processes behave as regular applications
+	return SCE_APPMGR_ERROR_NOT_SYSTEM_APP;
+}
+
+int sceAppMgrAppParamGetString(int pid, int param, char *string, int length) {
+	snprintf(string, length, "VGLMOCK00");
+	return 0;
+}
+
+int sceCommonDialogUpdate(const SceCommonDialogUpdateParam *updateParam) {
+	return 0;
+}
+
+/*
+ * SceSharedFb
+ */
+SceUID sceSharedFbOpen(int index) {
+	return SCE_APPMGR_ERROR_NOT_SYSTEM_APP;
+}
+
+int sceSharedFbClose(SceUID fb_id) {
+	return 0;
+}
+
+int sceSharedFbBegin(SceUID fb_id, SceSharedFbInfo *info) {
+	return SCE_APPMGR_ERROR_NOT_SYSTEM_APP;
+}
+
+int sceSharedFbEnd(SceUID fb_id) {
+	return 0;
+}
+
+int sceSharedFbGetInfo(SceUID fb_id, SceSharedFbInfo *info) {
+	return SCE_APPMGR_ERROR_NOT_SYSTEM_APP;
+}
+
+/*
+ * SceRtc
+ */
+unsigned int sceRtcGetTickResolution(void) {
+	return 1000000;
+}
+
+int sceRtcGetCurrentTick(SceRtcTick *tick) {
+	struct timespec t;
+	clock_gettime(CLOCK_REALTIME, &t);
+	tick->tick = (SceUInt64)t.tv_sec * 1000000 + t.tv_nsec / 1000;
+	return 0;
+}
+
+/*
+ * SceSysmodule
+ */
+int sceSysmoduleLoadModule(SceSysmoduleModuleId id) {
+	// Only Razor modules are requested by vitaGL and they're not available on host
+	return SCE_ERROR_ERRNO(ENOENT);
+}
+
+int sceSysmoduleUnloadModule(SceSysmoduleModuleId id) {
+	return 0;
+}
+
+/*
+ * SceCtrl
+ */
+int sceCtrlSetSamplingMode(SceCtrlPadInputMode mode) {
+	return 0;
+}
+
+int sceCtrlPeekBufferPositive(int port, SceCtrlData *pad_data, int count) {
+	// Idle pad with centered analogs
+	memset(pad_data, 0, sizeof(SceCtrlData) * count);
+	for (int i = 0; i < count; i++) {
+		pad_data[i].lx = pad_data[i].ly = 0x80;
+		pad_data[i].rx = pad_data[i].ry = 0x80;
+	}
+	return count;
+}
+
+int sceCtrlReadBufferPositive(int port, SceCtrlData *pad_data, int count) {
+	return sceCtrlPeekBufferPositive(port, pad_data, count);
+}
+
+/*
+ * SceIo
+ */
+static const char *host_path(const char *path) {
+	if (!strncmp(path, APP_PREFIX, strlen(APP_PREFIX)))
+		return path + strlen(APP_PREFIX);
+	return path;
+}
+
+// Applications built against newlib resolve app0: through stdio too, samples are linked with --wrap=fopen
+FILE *__real_fopen(const char *path, const char *mode);
+FILE *__wrap_fopen(const char *path, const char *mode) {
+	return __real_fopen(host_path(path), mode);
+}
+
+SceUID sceIoOpen(const char *file, int flags, SceMode mode) {
+	int f = 0;
+	if ((flags & SCE_O_RDWR) == SCE_O_RDWR)
+		f = O_RDWR;
+	else if (flags & SCE_O_WRONLY)
+		f = O_WRONLY;
+	else
+		f = O_RDONLY;
+	if (flags & SCE_O_APPEND)
+		f |= O_APPEND;
+	if (flags & SCE_O_CREAT)
+		f |= O_CREAT;
+	if (flags & SCE_O_TRUNC)
+		f |= O_TRUNC;
+	int fd = open(host_path(file), f, mode);
+	return fd < 0 ? SCE_ERROR_ERRNO(errno) : fd;
+}
+
+int sceIoClose(SceUID fd) {
+	return close(fd) ? SCE_ERROR_ERRNO(errno) : 0;
+}
+
+int sceIoRead(SceUID fd, void *data, SceSize size) {
+	ssize_t r = read(fd, data, size);
+	return r < 0 ? SCE_ERROR_ERRNO(errno) : r;
+}
+
+int sceIoWrite(SceUID fd, const void *data, SceSize size) {
+	ssize_t r = write(fd, data, size);
+	return r < 0 ? SCE_ERROR_ERRNO(errno) : r;
+}
+
+SceOff sceIoLseek(SceUID fd, SceOff offset, int whence) {
+	off_t r = lseek(fd, offset, whence == SCE_SEEK_SET ? SEEK_SET : (whence == SCE_SEEK_CUR ? SEEK_CUR : SEEK_END));
+	return r < 0 ? (SceOff)SCE_ERROR_ERRNO(errno) : r;
+}
+
+int sceIoRemove(const char *file) {
+	return unlink(host_path(file)) ? SCE_ERROR_ERRNO(errno) : 0;
+}
+
+int sceIoMkdir(const char *dir, SceMode mode) {
+	return mkdir(host_path(dir), mode) ? SCE_ERROR_ERRNO(errno) : 0;
+}
+
+int sceIoRmdir(const char *path) {
+	return rmdir(host_path(path)) ? SCE_ERROR_ERRNO(errno) : 0;
+}
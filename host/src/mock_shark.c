@@ -0,0 +1,759 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * mock_shark.c:
+ * Host replacement for vitaShaRK, it preprocesses CG sources and extracts
+ * their parameters (attributes, uniforms and samplers) into mock programs
+ */
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vitashark.h>
+
+#include "mock.h"
+
+#define MAX_MACROS 256 // Maximum number of macros per source
+#define MAX_PARAMS 128 // Maximum number of parameters per program
+#define MAX_COND_DEPTH 32 // Maximum #if nesting
+#define MAX_EXPAND_DEPTH 16 // Maximum recursion while expanding macros in expressions
+
+typedef struct {
+	char name[MOCK_NAME_MAX];
+	const char *value; // Points inside the preprocessed copy of the source
+	int value_len;
+	int is_function;
+} macro;
+
+typedef struct {
+	macro macros[MAX_MACROS];
+	int macros_num;
+	const char *error;
+	int error_line;
+} pp_state;
+
+typedef struct {
+	char text[MOCK_NAME_MAX];
+	int len;
+} token;
+
+static __thread SceGxmProgram *output = NULL;
+static void (*log_cb)(const char *msg, shark_log_level msg_level, int line) = NULL;
+
+/*
+ * Preprocessor
+ */
+static macro *find_macro(pp_state *s, const char *name, int len) {
+	int i;
+	for (i = s->macros_num - 1; i >= 0; i--) {
+		if (strlen(s->macros[i].name) == len && !strncmp(s->macros[i].name, name, len))
+			return &s->macros[i];
+	}
+	return NULL;
+}
+
+static int is_ident_char(char c) {
+	return isalnum((unsigned char)c) || c == '_';
+}
+
+static const char *skip_spaces(const char *p, const char *end) {
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+		p++;
+	return p;
+}
+
+typedef struct {
+	const char *p;
+	const char *end;
+	pp_state *s;
+	int depth;
+} expr_ctx;
+
+static long eval_ternary(expr_ctx *e);
+
+static long eval_macro_value(expr_ctx *e, macro *m) {
+	if (e->depth >= MAX_EXPAND_DEPTH)
+		return 0;
+	expr_ctx sub = {m->value, m->value + m->value_len, e->s, e->depth + 1};
+	return eval_ternary(&sub);
+}
+
+static long eval_primary(expr_ctx *e) {
+	e->p = skip_spaces(e->p, e->end);
+	if (e->p >= e->end)
+		return 0;
+	char c = *e->p;
+	if (c == '(') {
+		e->p++;
+		long v = eval_ternary(e);
+		e->p = skip_spaces(e->p, e->end);
+		if (e->p < e->end && *e->p == ')')
+			e->p++;
+		return v;
+	}
+	if (c == '!') {
+		e->p++;
+		return !eval_primary(e);
+	}
+	if (c == '~') {
+		e->p++;
+		return ~eval_primary(e);
+	}
+	if (c == '-') {
+		e->p++;
+		return -eval_primary(e);
+	}
+	if (c == '+') {
+		e->p++;
+		return eval_primary(e);
+	}
+	if (isdigit((unsigned char)c)) {
+		char *next;
+		long v = strtol(e->p, &next, 0);
+		e->p = next;
+		while (e->p < e->end && is_ident_char(*e->p)) // Suffixes (u, l, f)
+			e->p++;
+		return v;
+	}
+	if (is_ident_char(c)) {
+		const char *start = e->p;
+		while (e->p < e->end && is_ident_char(*e->p))
+			e->p++;
+		int len = e->p - start;
+		if (len == 7 && !strncmp(start, "defined", 7)) {
+			e->p = skip_spaces(e->p, e->end);
+			int paren = e->p < e->end && *e->p == '(';
+			if (paren)
+				e->p = skip_spaces(e->p + 1, e->end);
+			start = e->p;
+			while (e->p < e->end && is_ident_char(*e->p))
+				e->p++;
+			int found = find_macro(e->s, start, e->p - start) != NULL;
+			e->p = skip_spaces(e->p, e->end);
+			if (paren && e->p < e->end && *e->p == ')')
+				e->p++;
+			return found;
+		}
+		macro *m = find_macro(e->s, start, len);
+		if (m && !m->is_function)
+			return eval_macro_value(e, m);
+		return 0; // Unknown identifiers evaluate to zero as in the C preprocessor
+	}
+	e->p++;
+	return 0;
+}
+
+static int binary_prec(const char *p, const char *end, int *len) {
+	char c = p[0];
+	char n = p + 1 < end ? p[1] : 0;
+	*len = 2;
+	if (c == '|' && n == '|')
+		return 1;
+	if (c == '&' && n == '&')
+		return 2;
+	if ((c == '=' || c == '!') && n == '=')
+		return 6;
+	if ((c == '<' || c == '>') && n == '=')
+		return 7;
+	if ((c == '<' && n == '<') || (c == '>' && n == '>'))
+		return 8;
+	*len = 1;
+	switch (c) {
+	case '|':
+		return 3;
+	case '^':
+		return 4;
+	case '&':
+		return 5;
+	case '<':
+	case '>':
+		return 7;
+	case '+':
+	case '-':
+		return 9;
+	case '*':
+	case '/':
+	case '%':
+		return 10;
+	default:
+		return 0;
+	}
+}
+
+static long apply_binary(const char *op, int len, long a, long b) {
+	if (len == 2) {
+		switch (op[0]) {
+		case '|':
+			return a || b;
+		case '&':
+			return a && b;
+		case '=':
+			return a == b;
+		case '!':
+			return a != b;
+		case '<':
+			return op[1] == '=' ? a <= b : a << b;
+		case '>':
+			return op[1] == '=' ? a >= b : a >> b;
+		}
+	}
+	switch (op[0]) {
+	case '|':
+		return a | b;
+	case '^':
+		return a ^ b;
+	case '&':
+		return a & b;
+	case '<':
+		return a < b;
+	case '>':
+		return a > b;
+	case '+':
+		return a + b;
+	case '-':
+		return a - b;
+	case '*':
+		return a * b;
+	case '/':
+		return b ? a / b : 0;
+	case '%':
+		return b ? a % b : 0;
+	}
+	return 0;
+}
+
+static long eval_binary(expr_ctx *e, int min_prec) {
+	long lhs = eval_primary(e);
+	for (;;) {
+		int len;
+		e->p = skip_spaces(e->p, e->end);
+		if (e->p >= e->end)
+			break;
+		int prec = binary_prec(e->p, e->end, &len);
+		if (!prec || prec < min_prec)
+			break;
+		const char *op = e->p;
+		e->p += len;
+		long rhs = eval_binary(e, prec + 1);
+		lhs = apply_binary(op, len, lhs, rhs);
+	}
+	return lhs;
+}
+
+static long eval_ternary(expr_ctx *e) {
+	long cond = eval_binary(e, 1);
+	e->p = skip_spaces(e->p, e->end);
+	if (e->p < e->end && *e->p == '?') {
+		e->p++;
+		long a = eval_ternary(e);
+		e->p = skip_spaces(e->p, e->end);
+		if (e->p < e->end && *e->p == ':')
+			e->p++;
+		long b = eval_ternary(e);
+		return cond ? a : b;
+	}
+	return cond;
+}
+
+static long eval_expr(pp_state *s, const char *p, const char *end) {
+	expr_ctx e = {p, end, s, 0};
+	return eval_ternary(&e);
+}
+
+// Strips comments and line continuations, keeping line breaks so that line numbers stay valid
+static char *strip_source(const char *src, uint32_t size) {
+	char *out = malloc(size + 1);
+	if (!out)
+		return NULL;
+	uint32_t i = 0, j = 0;
+	while (i < size && src[i]) {
+		if (src[i] == '/' && i + 1 < size && src[i + 1] == '/') {
+			while (i < size && src[i] && src[i] != '\n')
+				i++;
+		} else if (src[i] == '/' && i + 1 < size && src[i + 1] == '*') {
+			i += 2;
+			while (i < size && src[i] && !(src[i] == '*' && i + 1 < size && src[i + 1] == '/')) {
+				if (src[i] == '\n')
+					out[j++] = '\n';
+				i++;
+			}
+			i += 2;
+			out[j++] = ' ';
+		} else if (src[i] == '\\' && i + 1 < size && (src[i + 1] == '\n' || src[i + 1] == '\r')) {
+			i++;
+			if (src[i] == '\r')
+				i++;
+			if (i < size && src[i] == '\n')
+				i++;
+		} else
+			out[j++] = src[i++];
+	}
+	out[j] = 0;
+	return out;
+}
+
+// Runs conditional directives in place, blanking inactive lines and directives
+static void preprocess(pp_state *s, char *src) {
+	int active[MAX_COND_DEPTH + 1] = {1};
+	int taken[MAX_COND_DEPTH + 1] = {1};
+	int depth = 0, line = 1;
+	char *p = src;
+	while (*p) {
+		char *eol = strchr(p, '\n');
+		if (!eol)
+			eol = p + strlen(p);
+		const char *q = skip_spaces(p, eol);
+		int is_directive = q < eol && *q == '#';
+		if (is_directive) {
+			q = skip_spaces(q + 1, eol);
+			const char *word = q;
+			while (q < eol && is_ident_char(*q))
+				q++;
+			int wlen = q - word;
+			q = skip_spaces(q, eol);
+			int parent = active[depth];
+#define IS_WORD(w) (wlen == sizeof(w) - 1 && !strncmp(word, w, wlen))
+			if (IS_WORD("if") || IS_WORD("ifdef") || IS_WORD("ifndef")) {
+				if (depth == MAX_COND_DEPTH) {
+					s->error = "too many nested conditionals";
+					s->error_line = line;
+					return;
+				}
+				long v;
+				if (IS_WORD("if"))
+					v = parent ? eval_expr(s, q, eol) : 0;
+				else {
+					const char *n = q;
+					while (q < eol && is_ident_char(*q))
+						q++;
+					v = find_macro(s, n, q - n) != NULL;
+					if (IS_WORD("ifndef"))
+						v = !v;
+				}
+				depth++;
+				active[depth] = parent && v;
+				taken[depth] = active[depth];
+			} else if (IS_WORD("elif")) {
+				if (depth && active[depth - 1] && !taken[depth] && eval_expr(s, q, eol)) {
+					active[depth] = 1;
+					taken[depth] = 1;
+				} else
+					active[depth] = 0;
+			} else if (IS_WORD("else")) {
+				if (depth) {
+					active[depth] = active[depth - 1] && !taken[depth];
+					taken[depth] = 1;
+				}
+			} else if (IS_WORD("endif")) {
+				if (depth)
+					depth--;
+			} else if (parent && IS_WORD("define")) {
+				const char *n = q;
+				while (q < eol && is_ident_char(*q))
+					q++;
+				if (s->macros_num < MAX_MACROS && q - n < MOCK_NAME_MAX) {
+					macro *m = &s->macros[s->macros_num++];
+					memcpy(m->name, n, q - n);
+					m->name[q - n] = 0;
+					m->is_function = q < eol && *q == '(';
+					q = skip_spaces(q, eol);
+					m->value = q;
+					m->value_len = eol - q;
+				}
+			} else if (parent && IS_WORD("undef")) {
+				const char *n = q;
+				while (q < eol && is_ident_char(*q))
+					q++;
+				macro *m = find_macro(s, n, q - n);
+				if (m)
+					m->name[0] = 0;
+			}
+#undef IS_WORD
+		}
+		if (is_directive || !active[depth]) {
+			// Macros keep pointing to their value, so directives are blanked only once fully parsed
+			char *c;
+			for (c = p; c < eol; c++) {
+				if (!is_directive)
+					*c = ' ';
+			}
+		}
+		if (is_directive)
+			*p = 0x01; // Marks the directive line so that the extractor skips it
+		line++;
+		p = *eol ? eol + 1 : eol;
+	}
+	if (depth) {
+		s->error = "unterminated conditional directive";
+		s->error_line = line;
+	}
+}
+
+/*
+ * Parameters extraction
+ */
+typedef struct {
+	const char *p;
+	pp_state *s;
+} lexer;
+
+static int next_token(lexer *l, token *t) {
+	for (;;) {
+		while (*l->p && isspace((unsigned char)*l->p))
+			l->p++;
+		if (*l->p == 0x01) { // Directive line
+			while (*l->p && *l->p != '\n')
+				l->p++;
+			continue;
+		}
+		break;
+	}
+	if (!*l->p)
+		return 0;
+	const char *start = l->p;
+	if (is_ident_char(*l->p)) {
+		while (is_ident_char(*l->p))
+			l->p++;
+	} else
+		l->p++;
+	int len = l->p - start;
+	if (len >= MOCK_NAME_MAX)
+		len = MOCK_NAME_MAX - 1;
+	memcpy(t->text, start, len);
+	t->text[len] = 0;
+	t->len = len;
+	return 1;
+}
+
+typedef struct {
+	SceGxmProgramParameter params[MAX_PARAMS];
+	int num;
+	uint32_t attrib_regs;
+	uint32_t uniform_words;
+	uint32_t samplers;
+} param_table;
+
+typedef struct {
+	int valid;
+	int is_sampler;
+	uint8_t type;
+	uint8_t comps;
+	uint8_t rows;
+} type_info;
+
+static type_info parse_type(const char *name, int is_unsigned) {
+	static const struct {
+		const char *prefix;
+		uint8_t type;
+	} bases[] = {
+		{"float", SCE_GXM_PARAMETER_TYPE_F32},
+		{"half", SCE_GXM_PARAMETER_TYPE_F16},
+		{"fixed", SCE_GXM_PARAMETER_TYPE_C10},
+		{"uint", SCE_GXM_PARAMETER_TYPE_U32},
+		{"int", SCE_GXM_PARAMETER_TYPE_S32},
+		{"ushort", SCE_GXM_PARAMETER_TYPE_U16},
+		{"short", SCE_GXM_PARAMETER_TYPE_S16},
+		{"uchar", SCE_GXM_PARAMETER_TYPE_U8},
+		{"char", SCE_GXM_PARAMETER_TYPE_S8},
+		{"bool", SCE_GXM_PARAMETER_TYPE_S32},
+	};
+	type_info r = {0};
+	if (!strncmp(name, "sampler", 7)) {
+		r.valid = 1;
+		r.is_sampler = 1;
+		r.comps = 1;
+		r.rows = 1;
+		return r;
+	}
+	int i;
+	for (i = 0; i < sizeof(bases) / sizeof(*bases); i++) {
+		size_t len = strlen(bases[i].prefix);
+		if (strncmp(name, bases[i].prefix, len))
+			continue;
+		const char *d = name + len;
+		r.comps = 1;
+		r.rows = 1;
+		if (isdigit((unsigned char)d[0])) {
+			r.comps = d[0] - '0';
+			if (d[1] == 'x' && isdigit((unsigned char)d[2])) {
+				r.rows = r.comps;
+				r.comps = d[2] - '0';
+				d += 3;
+			} else
+				d++;
+		}
+		if (*d || r.comps < 1 || r.comps > 4 || r.rows < 1 || r.rows > 4)
+			return r;
+		r.valid = 1;
+		r.type = bases[i].type;
+		if (is_unsigned) {
+			if (r.type == SCE_GXM_PARAMETER_TYPE_S32)
+				r.type = SCE_GXM_PARAMETER_TYPE_U32;
+			else if (r.type == SCE_GXM_PARAMETER_TYPE_S16)
+				r.type = SCE_GXM_PARAMETER_TYPE_U16;
+			else if (r.type == SCE_GXM_PARAMETER_TYPE_S8)
+				r.type = SCE_GXM_PARAMETER_TYPE_U8;
+		}
+		return r;
+	}
+	return r;
+}
+
+// Parses a declaration made of tokens[0..num) and appends the resulting parameter
+static void add_declaration(param_table *t, pp_state *s, token *toks, int num, int is_uniform, int is_vertex) {
+	int i = 0, is_unsigned = 0;
+	while (i < num && (!strcmp(toks[i].text, "uniform") || !strcmp(toks[i].text, "const") || !strcmp(toks[i].text, "in") || !strcmp(toks[i].text, "varying") || !strcmp(toks[i].text, "attribute") || !strcmp(toks[i].text, "unsigned"))) {
+		if (!strcmp(toks[i].text, "unsigned"))
+			is_unsigned = 1;
+		i++;
+	}
+	if (i >= num)
+		return;
+	type_info ti = parse_type(toks[i].text, is_unsigned);
+	if (!ti.valid && is_unsigned) // Plain 'unsigned'
+		ti = parse_type("uint", 0);
+	else
+		i++;
+	if (!ti.valid || i >= num || !is_ident_char(toks[i].text[0]))
+		return;
+	const char *name = toks[i++].text;
+	uint32_t array_size = 1;
+	const char *semantic = NULL;
+	while (i < num) {
+		if (toks[i].text[0] == '[') {
+			// Array size, possibly made of macros
+			char expr[256] = "";
+			int j = i + 1;
+			while (j < num && toks[j].text[0] != ']') {
+				if (strlen(expr) + toks[j].len + 2 < sizeof(expr)) {
+					strcat(expr, toks[j].text);
+					strcat(expr, " ");
+				}
+				j++;
+			}
+			long v = eval_expr(s, expr, expr + strlen(expr));
+			array_size *= v > 0 ? v : 1;
+			i = j + 1;
+		} else if (toks[i].text[0] == ':' && i + 1 < num) {
+			semantic = toks[i + 1].text;
+			i += 2;
+		} else
+			break;
+	}
+
+	// Vertex inputs with system semantics are not attributes, fragment inputs are varyings
+	if (!is_uniform && (!is_vertex || (semantic && (!strcmp(semantic, "INDEX") || !strcmp(semantic, "INSTANCE")))))
+		return;
+	if (t->num == MAX_PARAMS)
+		return;
+	for (int k = 0; k < t->num; k++) {
+		if (!strcmp(t->params[k].name, name))
+			return;
+	}
+
+	SceGxmProgramParameter *p = &t->params[t->num++];
+	memset(p, 0, sizeof(SceGxmProgramParameter));
+	strncpy(p->name, name, MOCK_NAME_MAX - 1);
+	p->type = ti.type;
+	p->component_count = ti.comps;
+	p->array_size = array_size * ti.rows;
+	if (!is_uniform) {
+		p->category = SCE_GXM_PARAMETER_CATEGORY_ATTRIBUTE;
+		p->resource_index = t->attrib_regs;
+		t->attrib_regs += 4 * p->array_size;
+	} else if (ti.is_sampler) {
+		p->category = SCE_GXM_PARAMETER_CATEGORY_SAMPLER;
+		p->type = SCE_GXM_PARAMETER_TYPE_AGGREGATE;
+		if (semantic && !strncmp(semantic, "TEXUNIT", 7))
+			p->resource_index = atoi(semantic + 7);
+		else
+			p->resource_index = t->samplers;
+		t->samplers++;
+	} else {
+		p->category = SCE_GXM_PARAMETER_CATEGORY_UNIFORM;
+		uint32_t align = ti.comps >= 3 ? 4 : ti.comps;
+		t->uniform_words = (t->uniform_words + align - 1) & ~(align - 1);
+		p->resource_index = t->uniform_words;
+		t->uniform_words += ti.comps * p->array_size;
+	}
+}
+
+static int extract_params(param_table *t, pp_state *s, const char *src, int is_vertex) {
+	lexer l = {src, s};
+	token toks[32];
+	token tk;
+	int braces = 0, has_main = 0;
+	while (next_token(&l, &tk)) {
+		if (tk.text[0] == '{') {
+			braces++;
+			continue;
+		}
+		if (tk.text[0] == '}') {
+			braces--;
+			continue;
+		}
+		if (braces)
+			continue;
+		if (!strcmp(tk.text, "uniform")) {
+			// Global uniform declaration, possibly with several declarators
+			int num = 0;
+			toks[num++] = tk;
+			while (next_token(&l, &tk) && tk.text[0] != ';') {
+				if (tk.text[0] == '=') { // Skip initializers
+					int nest = 0;
+					while (next_token(&l, &tk)) {
+						if (tk.text[0] == '(' || tk.text[0] == '{')
+							nest++;
+						else if (tk.text[0] == ')' || tk.text[0] == '}')
+							nest--;
+						else if (!nest && (tk.text[0] == ';' || tk.text[0] == ','))
+							break;
+					}
+				}
+				if (tk.text[0] == ';')
+					break;
+				if (tk.text[0] == ',') {
+					add_declaration(t, s, toks, num, 1, is_vertex);
+					num = 2; // Keeps 'uniform' and the type for the next declarator
+					continue;
+				}
+				if (num < 32)
+					toks[num++] = tk;
+			}
+			add_declaration(t, s, toks, num, 1, is_vertex);
+		} else if (!strcmp(tk.text, "main")) {
+			lexer saved = l;
+			if (!next_token(&l, &tk) || tk.text[0] != '(') {
+				l = saved;
+				continue;
+			}
+			has_main = 1;
+			int nest = 0, num = 0, is_out = 0, is_uniform = 0;
+			while (next_token(&l, &tk)) {
+				if (tk.text[0] == '(' || tk.text[0] == '[')
+					nest++;
+				else if ((tk.text[0] == ')' || tk.text[0] == ']') && nest)
+					nest--;
+				else if (!nest && (tk.text[0] == ',' || tk.text[0] == ')')) {
+					if (num && !is_out)
+						add_declaration(t, s, toks, num, is_uniform, is_vertex);
+					num = is_out = is_uniform = 0;
+					if (tk.text[0] == ')')
+						break;
+					continue;
+				}
+				if (!strcmp(tk.text, "out") || !strcmp(tk.text, "inout"))
+					is_out = 1;
+				else if (!strcmp(tk.text, "uniform"))
+					is_uniform = 1;
+				if (num < 32)
+					toks[num++] = tk;
+			}
+		}
+	}
+	return has_main;
+}
+
+static uint32_t hash_source(const char *s) {
+	uint32_t h = 2166136261u;
+	while (*s) {
+		if (!isspace((unsigned char)*s) && *s != 0x01) {
+			h ^= (uint8_t)*s;
+			h *= 16777619u;
+		}
+		s++;
+	}
+	return h;
+}
+
+static void report(const char *msg, shark_log_level level, int line) {
+	if (log_cb)
+		log_cb(msg, level, line);
+}
+
+SceGxmProgram *shark_compile_shader_extended(const char *src, uint32_t *size, shark_type type, shark_opt opt, int32_t use_fastmath, int32_t use_fastprecision, int32_t use_fastint) {
+	shark_clear_output();
+	if (!src)
+		return NULL;
+	pp_state *s = calloc(1, sizeof(pp_state));
+	param_table *t = calloc(1, sizeof(param_table));
+	char *text = strip_source(src, *size ? *size : strlen(src));
+	SceGxmProgram *r = NULL;
+	if (!s || !t || !text)
+		goto out;
+	preprocess(s, text);
+	if (s->error) {
+		report(s->error, SHARK_LOG_ERROR, s->error_line);
+		goto out;
+	}
+	if (!extract_params(t, s, text, type == SHARK_VERTEX_SHADER)) {
+		report("no entry point 'main' found", SHARK_LOG_ERROR, 0);
+		goto out;
+	}
+
+	uint32_t params_size = t->num * sizeof(SceGxmProgramParameter);
+	uint32_t total = sizeof(SceGxmProgram) + params_size;
+	r = calloc(1, total);
+	if (!r)
+		goto out;
+	r->magic = MOCK_PROGRAM_MAGIC;
+	r->size = total;
+	r->type = type;
+	r->params_num = t->num;
+	r->params_offset = sizeof(SceGxmProgram);
+	r->default_uniform_size = t->uniform_words * 4;
+	r->source_hash = hash_source(text);
+	memcpy((uint8_t *)r + r->params_offset, t->params, params_size);
+	*size = total;
+	output = r;
+
+out:
+	mock_log(VGL_MOCK_CMD_COMPILE_PROGRAM, NULL, type, t ? t->num : 0, r ? r->default_uniform_size : 0, r != NULL);
+	free(text);
+	free(t);
+	free(s);
+	return r;
+}
+
+SceGxmProgram *shark_compile_shader(const char *src, uint32_t *size, shark_type type) {
+	return shark_compile_shader_extended(src, size, type, SHARK_OPT_DEFAULT, 0, 0, 0);
+}
+
+void shark_clear_output(void) {
+	free(output);
+	output = NULL;
+}
+
+int shark_init(const char *path) {
+	return 0;
+}
+
+void shark_end(void) {
+	shark_clear_output();
+}
+
+void shark_install_log_cb(void (*cb)(const char *msg, shark_log_level msg_level, int line)) {
+	log_cb = cb;
+}
+
+void shark_set_warnings_level(shark_warn_level level) {
+}
+
+void shark_set_allocators(void *(*malloc_func)(size_t size), void (*free_func)(void *ptr)) {
+	// Outputs are owned by the mock compiler, so custom allocators are never needed
+}
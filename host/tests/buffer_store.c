@@ -0,0 +1,322 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * buffer_store.c:
+ * Tests for the versioned buffers storages against a model of the GPU reading them with some scenes of latency
+ * and for the ranges glMapBufferRange and glFlushMappedBufferRange accept
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <vitaGL.h>
+#include "utils/buffer_utils.h"
+
+#include "test.h"
+
+#define BUF_SIZE 4096
+#define GPU_LATENCY 2 // Scenes the simulated GPU lags behind the CPU
+#define READS_MAX 4096 // Draws the simulated GPU can have in flight
+#define ITERATIONS 200000
+
+static int live_storages = 0;
+static int busy_releases = 0;
+static void *graveyard[ITERATIONS];
+static int graveyard_num = 0;
+
+static void *alloc_storage(uint32_t size, uint32_t type) {
+	live_storages++;
+	return malloc(size);
+}
+
+// Storages released while busy are kept alive until the end of the test, as the garbage collector would do
+static void release_storage(void *ptr, int busy) {
+	live_storages--;
+	if (busy) {
+		busy_releases++;
+		graveyard[graveyard_num++] = ptr;
+	} else
+		free(ptr);
+}
+
+static const buffer_allocator allocator = {alloc_storage, release_storage};
+
+// Storage read by a draw with a snapshot of what it must contain until the draw scene completes
+typedef struct {
+	uint8_t *ptr;
+	uint8_t snapshot[BUF_SIZE];
+	uint32_t seq;
+} gpu_read;
+
+static gpu_read reads[READS_MAX];
+static int reads_num = 0;
+
+static void test_random_updates(void) {
+	buffer_store s;
+	buffer_stats stats;
+	uint8_t ref[BUF_SIZE], data[512];
+	uint32_t completed = 0, pending = 1;
+	memset(&s, 0, sizeof(s));
+	memset(&stats, 0, sizeof(stats));
+	srand(1234);
+	for (int i = 0; i < BUF_SIZE; i++)
+		ref[i] = rand();
+	uint8_t *p = buffer_store_orphan(&s, &allocator, BUF_SIZE, 0, completed, &stats);
+	memcpy(p, ref, BUF_SIZE);
+
+	for (int it = 0; it < ITERATIONS; it++) {
+		int op = rand() % 12;
+		if (op < 4) {
+			// Draw reading the buffer, the storage is tagged with the scene the draw belongs to
+			buffer_store_use(&s, pending);
+			if (reads_num < READS_MAX) {
+				reads[reads_num].ptr = p;
+				reads[reads_num].seq = pending;
+				memcpy(reads[reads_num].snapshot, p, BUF_SIZE);
+				reads_num++;
+			}
+		} else if (op < 8) {
+			// Partial update
+			uint32_t off = rand() % BUF_SIZE, len = (rand() % (BUF_SIZE - off + 1)) % sizeof(data);
+			for (uint32_t i = 0; i < len; i++)
+				data[i] = rand();
+			p = buffer_store_write(&s, &allocator, off, data, len, completed, &stats);
+			memcpy(ref + off, data, len);
+		} else if (op < 10) {
+			// Mapped update, unsynchronized only once the GPU is done with every draw as applications are required to
+			static const uint32_t map_flags[] = {0, BUFFER_MAP_INVALIDATE_RANGE, BUFFER_MAP_INVALIDATE_BUFFER};
+			uint32_t flags = map_flags[rand() % 3];
+			if (!reads_num && (rand() & 1))
+				flags |= BUFFER_MAP_UNSYNCHRONIZED;
+			uint32_t off = rand() % BUF_SIZE, len = (rand() % (BUF_SIZE - off + 1)) % sizeof(data);
+			if (flags & BUFFER_MAP_INVALIDATE_BUFFER) {
+				off = 0;
+				len = BUF_SIZE;
+			}
+			uint8_t *q = buffer_store_map(&s, &allocator, off, len, flags, completed, &stats);
+			if (flags & BUFFER_MAP_UNSYNCHRONIZED)
+				CHECK(q == p);
+
+			// Bytes out of an invalidated range keep their content
+			if (!(flags & BUFFER_MAP_INVALIDATE_BUFFER)) {
+				CHECK(!memcmp(q, ref, off));
+				CHECK(!memcmp(q + off + len, ref + off + len, BUF_SIZE - off - len));
+				if (!(flags & BUFFER_MAP_INVALIDATE_RANGE))
+					CHECK(!memcmp(q + off, ref + off, len));
+			}
+			for (uint32_t i = 0; i < len; i++)
+				ref[off + i] = rand();
+			memcpy(q + off, ref + off, len);
+			p = q;
+		} else if (op == 10) {
+			// Whole content replaced
+			p = buffer_store_orphan(&s, &allocator, BUF_SIZE, 0, completed, &stats);
+			for (int i = 0; i < BUF_SIZE; i++)
+				ref[i] = rand();
+			memcpy(p, ref, BUF_SIZE);
+		} else {
+			// Scene end, the GPU catches up with some latency
+			pending++;
+			completed = pending > GPU_LATENCY + 1 ? pending - GPU_LATENCY - 1 : 0;
+		}
+
+		// Current storage always holds the latest content
+		CHECK(!memcmp(p, ref, BUF_SIZE));
+		if (test_failures)
+			break;
+
+		// Storages the GPU may still be reading must not be altered
+		int n = 0;
+		for (int r = 0; r < reads_num; r++) {
+			if (buffer_seq_reached(reads[r].seq, completed))
+				continue;
+			CHECK(!memcmp(reads[r].ptr, reads[r].snapshot, BUF_SIZE));
+			reads[n++] = reads[r];
+		}
+		reads_num = n;
+	}
+
+	CHECK(stats.renames > 0);
+	CHECK(s.num <= BUFFER_MAX_VERSIONS);
+	buffer_store_release(&s, &allocator, completed);
+	CHECK_EQ(live_storages, 0);
+	for (int i = 0; i < graveyard_num; i++)
+		free(graveyard[i]);
+	graveyard_num = 0;
+}
+
+// Only the scene of the last draw reading a storage decides whether it can be written in place
+static void test_last_draw_seq(void) {
+	buffer_store s;
+	buffer_stats stats;
+	uint8_t data[16] = {1, 2, 3};
+	memset(&s, 0, sizeof(s));
+	memset(&stats, 0, sizeof(stats));
+	uint8_t *p = buffer_store_orphan(&s, &allocator, BUF_SIZE, 0, 0, &stats);
+
+	// Drawn in scene 1 only, then updated while scene 4 is being recorded and scene 3 got completed
+	buffer_store_use(&s, 1);
+	CHECK(buffer_store_write(&s, &allocator, 0, data, sizeof(data), 3, &stats) == p);
+	CHECK_EQ(stats.renames, 0);
+
+	// Drawn in the scene being recorded, the update can't touch that storage
+	buffer_store_use(&s, 4);
+	uint8_t *q = buffer_store_write(&s, &allocator, 0, data, sizeof(data), 3, &stats);
+	CHECK(q != p);
+	CHECK_EQ(stats.renames, 1);
+	CHECK(!memcmp(q, data, sizeof(data)));
+
+	// The new storage was never drawn, so it's written in place
+	CHECK(buffer_store_write(&s, &allocator, 16, data, sizeof(data), 3, &stats) == q);
+	CHECK_EQ(stats.renames, 1);
+
+	// Once scene 4 completes, the first storage is recycled copying only the bytes it missed
+	buffer_store_use(&s, 5);
+	stats.bytes_copied = 0;
+	CHECK(buffer_store_write(&s, &allocator, 64, data, sizeof(data), 4, &stats) == p);
+	CHECK_EQ(stats.bytes_copied, 32);
+	CHECK(!memcmp(p + 16, data, sizeof(data)));
+	buffer_store_release(&s, &allocator, 5);
+	CHECK_EQ(live_storages, 0);
+}
+
+static void test_map_flags(void) {
+	buffer_store s;
+	buffer_stats stats;
+	uint8_t ref[BUF_SIZE];
+	memset(&s, 0, sizeof(s));
+	memset(&stats, 0, sizeof(stats));
+	for (int i = 0; i < BUF_SIZE; i++)
+		ref[i] = i * 7;
+	uint8_t *p = buffer_store_orphan(&s, &allocator, BUF_SIZE, 0, 0, &stats);
+	memcpy(p, ref, BUF_SIZE);
+
+	// Synchronized map of a busy storage switches to an up to date one
+	buffer_store_use(&s, 1);
+	uint8_t *q = buffer_store_map(&s, &allocator, 100, 50, 0, 0, &stats);
+	CHECK(q != p);
+	CHECK_EQ(stats.renames, 1);
+	CHECK_EQ(stats.bytes_copied, BUF_SIZE);
+	CHECK(!memcmp(q, ref, BUF_SIZE));
+
+	// Invalidated range is not copied
+	buffer_store_use(&s, 1);
+	stats.bytes_copied = 0;
+	uint8_t *r = buffer_store_map(&s, &allocator, 100, 50, BUFFER_MAP_INVALIDATE_RANGE, 0, &stats);
+	CHECK(r != p && r != q);
+	CHECK_EQ(stats.bytes_copied, BUF_SIZE - 50);
+	CHECK(!memcmp(r, ref, 100));
+	CHECK(!memcmp(r + 150, ref + 150, BUF_SIZE - 150));
+
+	// Invalidated buffer is not copied at all
+	buffer_store_use(&s, 1);
+	stats.bytes_copied = 0;
+	uint8_t *t = buffer_store_map(&s, &allocator, 0, 16, BUFFER_MAP_INVALIDATE_BUFFER, 0, &stats);
+	CHECK(t != p && t != q && t != r);
+	CHECK_EQ(stats.bytes_copied, 0);
+	CHECK_EQ(stats.renames, 3);
+
+	// Unsynchronized map returns the busy storage as is
+	buffer_store_use(&s, 1);
+	CHECK(buffer_store_map(&s, &allocator, 0, 16, BUFFER_MAP_UNSYNCHRONIZED, 0, &stats) == t);
+	CHECK_EQ(stats.renames, 3);
+	buffer_store_release(&s, &allocator, 1);
+	CHECK_EQ(live_storages, 0);
+
+	// Bytes written through an unsynchronized map are copied when a previous storage gets recycled
+	memset(&s, 0, sizeof(s));
+	memset(&stats, 0, sizeof(stats));
+	p = buffer_store_orphan(&s, &allocator, BUF_SIZE, 0, 0, &stats);
+	memcpy(p, ref, BUF_SIZE);
+	buffer_store_use(&s, 1);
+	q = buffer_store_write(&s, &allocator, 0, ref + 64, 16, 0, &stats);
+	CHECK(q != p);
+	buffer_store_use(&s, 2);
+	CHECK(buffer_store_map(&s, &allocator, 32, 16, BUFFER_MAP_UNSYNCHRONIZED, 1, &stats) == q);
+	memset(q + 32, 0xAB, 16);
+	stats.bytes_copied = 0;
+	CHECK(buffer_store_map(&s, &allocator, 200, 8, 0, 1, &stats) == p);
+	CHECK_EQ(stats.bytes_copied, 32);
+	CHECK(!memcmp(p, q, BUF_SIZE));
+	buffer_store_release(&s, &allocator, 2);
+	CHECK_EQ(live_storages, 0);
+}
+
+static void test_orphan(void) {
+	buffer_store s;
+	buffer_stats stats;
+	memset(&s, 0, sizeof(s));
+	memset(&stats, 0, sizeof(stats));
+	uint8_t *p = buffer_store_orphan(&s, &allocator, BUF_SIZE, 0, 0, &stats);
+
+	// Orphaning a busy storage never copies anything
+	buffer_store_use(&s, 1);
+	uint8_t *q = buffer_store_orphan(&s, &allocator, BUF_SIZE, 0, 0, &stats);
+	CHECK(q != p);
+	CHECK_EQ(stats.bytes_copied, 0);
+
+	// Size or memory type changes drop every storage
+	busy_releases = 0;
+	buffer_store_orphan(&s, &allocator, BUF_SIZE * 2, 0, 0, &stats);
+	CHECK_EQ(s.num, 1);
+	CHECK_EQ(busy_releases, 1);
+	buffer_store_orphan(&s, &allocator, BUF_SIZE * 2, 1, 2, &stats);
+	CHECK_EQ(s.num, 1);
+	CHECK_EQ(s.type, 1);
+	buffer_store_release(&s, &allocator, 2);
+	CHECK_EQ(live_storages, 0);
+	for (int i = 0; i < graveyard_num; i++)
+		free(graveyard[i]);
+	graveyard_num = 0;
+}
+
+static void test_map_range(void) {
+	GLuint buf;
+	vglInit(0x800000);
+	glGenBuffers(1, &buf);
+	glBindBuffer(GL_ARRAY_BUFFER, buf);
+	glBufferData(GL_ARRAY_BUFFER, 256, NULL, GL_DYNAMIC_DRAW);
+
+	// Lengths are unsigned, so the end of the range must not be computed as offset + length
+	CHECK(glMapBufferRange(GL_ARRAY_BUFFER, 16, 0xFFFFFFF8, GL_MAP_WRITE_BIT) == NULL);
+	CHECK_EQ(glGetError(), GL_INVALID_VALUE);
+	CHECK(glMapBufferRange(GL_ARRAY_BUFFER, 260, 0, GL_MAP_WRITE_BIT) == NULL);
+	CHECK_EQ(glGetError(), GL_INVALID_VALUE);
+	CHECK(glMapBufferRange(GL_ARRAY_BUFFER, 16, 240, GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT) != NULL);
+	CHECK_EQ(glGetError(), GL_NO_ERROR);
+
+	// Same for flushed ranges, relative to the mapped one
+	glFlushMappedBufferRange(GL_ARRAY_BUFFER, 16, 0xFFFFFFF8);
+	CHECK_EQ(glGetError(), GL_INVALID_VALUE);
+	glFlushMappedBufferRange(GL_ARRAY_BUFFER, 244, 0);
+	CHECK_EQ(glGetError(), GL_INVALID_VALUE);
+	glFlushMappedBufferRange(GL_ARRAY_BUFFER, 16, 224);
+	CHECK_EQ(glGetError(), GL_NO_ERROR);
+	glUnmapBuffer(GL_ARRAY_BUFFER);
+	glDeleteBuffers(1, &buf);
+	vglEnd();
+}
+
+int main(int argc, char **argv) {
+	test_random_updates();
+	test_last_draw_seq();
+	test_map_flags();
+	test_orphan();
+	test_map_range();
+	return TEST_RESULT();
+}
@@ -0,0 +1,115 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * compile_queue.c:
+ * Tests for the background compile queue (blocking waits, cancellation and shutdown with pending shaders)
+ */
+
+#include <semaphore.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vitaGL.h>
+
+#include "utils/compiler_utils.h"
+#include "test.h"
+
+static sem_t gate;
+static volatile int compiled = 0;
+
+static void *counting_compile(const char *source, uint32_t size, int type, uint32_t *bin_size) {
+	if (!strcmp(source, "gate"))
+		sem_wait(&gate);
+	__sync_fetch_and_add(&compiled, 1);
+	*bin_size = size;
+	return strdup(source);
+}
+
+static void test_queue(void) {
+	sem_init(&gate, 0, 0);
+	CHECK(compile_queue_init(counting_compile, GL_FALSE, 1, 0, 0));
+	compile_job *a = compile_queue_submit(1, 0, "gate", 4);
+	compile_job *b = compile_queue_submit(2, 0, "b", 1);
+	compile_job *c = compile_queue_submit(3, 0, "c", 1);
+	while (a->status == COMPILE_JOB_QUEUED)
+		usleep(1000);
+
+	// Releasing a job still in the queue must not compile it
+	compile_queue_release(c);
+	CHECK(compile_queue_find(3) == NULL);
+
+	// Waiting blocks until the worker is done, any number of waiters is woken up
+	sem_post(&gate);
+	compile_job_wait(a);
+	CHECK_EQ(a->status, COMPILE_JOB_DONE);
+	compile_job_wait(a);
+	compile_job_wait(b);
+	CHECK_EQ(b->status, COMPILE_JOB_DONE);
+	CHECK(!strcmp((const char *)b->bin, "b"));
+	CHECK_EQ(compiled, 2);
+	compile_queue_release(a);
+
+	// Unreleased jobs are freed by the queue shutdown
+	compile_queue_submit(4, 0, "d", 1);
+	compile_queue_term();
+	sem_destroy(&gate);
+}
+
+static const char *vertex_shader =
+	"void main(float3 position, float4 out gl_Position : POSITION, uniform float4x4 wvp) {\n"
+	"	gl_Position = mul(float4(position, 1.0), wvp);\n"
+	"}";
+
+static GLuint compile_shader(void) {
+	GLuint s = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(s, 1, &vertex_shader, NULL);
+	glCompileShader(s);
+	return s;
+}
+
+static void test_shutdown(void) {
+	GLint status;
+
+	vglInit(0x800000);
+	vglSetShaderCacheSize(0);
+
+	// Disabling the background compiler completes any pending compilation
+	vglSetupAsyncShaderCompiler(GL_TRUE, VGL_ASYNC_FALLBACK_SKIP, 0, 0);
+	GLuint a = compile_shader();
+	GLuint b = compile_shader();
+	vglSetupAsyncShaderCompiler(GL_FALSE, VGL_ASYNC_FALLBACK_SKIP, 0, 0);
+	glGetShaderiv(a, GL_COMPLETION_STATUS_KHR, &status);
+	CHECK(status == GL_TRUE);
+	glGetShaderiv(a, GL_COMPILE_STATUS, &status);
+	CHECK(status == GL_TRUE);
+	glGetShaderiv(b, GL_COMPILE_STATUS, &status);
+	CHECK(status == GL_TRUE);
+
+	// Shaders still pending at shutdown are dropped
+	vglSetupAsyncShaderCompiler(GL_TRUE, VGL_ASYNC_FALLBACK_SKIP, 0, 0);
+	compile_shader();
+	compile_shader();
+	vglEnd();
+}
+
+int main(int argc, char **argv) {
+	test_queue();
+	test_shutdown();
+	return TEST_RESULT();
+}
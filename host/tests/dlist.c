@@ -0,0 +1,380 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * dlist.c:
+ * Tests for the display lists bytecode, replaying a recorded list must be indistinguishable from issuing its calls directly
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "utils/dlist_utils.h"
+
+#include "test.h"
+
+#define CALLS_NUM 4096 // Calls issued by every random program
+#define PROGRAMS_NUM 64 // Random programs checked
+#define STATES_NUM 4 // Fake capabilities toggled by the idempotent calls
+#define LOG_MAX (CALLS_NUM * 2) // Observable events a program can produce
+
+// Mock GL state, attributes are only observable through the vertices using them
+static struct {
+	float attrib[DLIST_ATTRIB_CLASSES_NUM][4];
+	uint32_t state[STATES_NUM];
+	uint32_t counter;
+} gl;
+
+typedef struct {
+	int kind;
+	float pos[3];
+	float attrib[DLIST_ATTRIB_CLASSES_NUM][4];
+	uint32_t state[STATES_NUM];
+	uint32_t counter;
+} event;
+
+static event events[LOG_MAX];
+static int events_num = 0;
+static int calls_num = 0; // Mock calls actually performed
+
+static void log_event(int kind, float x, float y, float z) {
+	event *e = &events[events_num++];
+	memset(e, 0, sizeof(*e));
+	e->kind = kind;
+	e->pos[0] = x;
+	e->pos[1] = y;
+	e->pos[2] = z;
+	memcpy(e->attrib, gl.attrib, sizeof(gl.attrib));
+	memcpy(e->state, gl.state, sizeof(gl.state));
+	e->counter = gl.counter;
+}
+
+// Idempotent state setter, like glEnable or glBindTexture
+static void mock_state(uint32_t cap, uint32_t value) {
+	calls_num++;
+	gl.state[cap % STATES_NUM] = value;
+}
+
+// Attribute setters, like glColor4f, glNormal3f, glTexCoord2f and glMultiTexCoord2f
+static void mock_attrib4(float r, float g, float b, float a) {
+	calls_num++;
+	float v[4] = {r, g, b, a};
+	memcpy(gl.attrib[0], v, sizeof(v));
+}
+
+static void mock_attrib3(float x, float y, float z) {
+	calls_num++;
+	float v[4] = {x, y, z, 0.0f};
+	memcpy(gl.attrib[1], v, sizeof(v));
+}
+
+static void mock_attrib2(float s, float t) {
+	calls_num++;
+	float v[4] = {s, t, 0.0f, 0.0f};
+	memcpy(gl.attrib[2], v, sizeof(v));
+}
+
+static void mock_attrib_unit(uint32_t unit, float s, float t) {
+	calls_num++;
+	float v[4] = {s, t, (float)unit, 0.0f};
+	memcpy(gl.attrib[3], v, sizeof(v));
+}
+
+// Vertex emission, reading every attribute
+static void mock_vertex(float x, float y, float z) {
+	calls_num++;
+	log_event(0, x, y, z);
+}
+
+// Call with side effects, like glTranslatef
+static void mock_effect(uint32_t id, int32_t delta) {
+	calls_num++;
+	gl.counter = gl.counter * 3 + id + delta;
+	log_event(1, 0.0f, 0.0f, 0.0f);
+}
+
+// Issues a call directly or records it with the same flags the display lists compiler uses
+static void issue(dlist_arena *a, void (*func)(), uint8_t flags, const char *sig, ...) {
+	va_list args;
+	va_start(args, sig);
+	if (a) {
+		uint8_t packed[DLIST_MAX_ARGS_SIZE];
+		uint32_t size = 0;
+		dlistFuncType type = dlist_pack_args(packed, &size, sig, args);
+		CHECK(type != DLIST_OP_INVALID);
+		dlist_record(a, func, type, flags, packed, size);
+	} else {
+		va_list copy;
+		va_copy(copy, args);
+		if (func == (void (*)())mock_state) {
+			uint32_t cap = va_arg(copy, uint32_t);
+			mock_state(cap, va_arg(copy, uint32_t));
+		} else if (func == (void (*)())mock_attrib4) {
+			float v[4];
+			for (int i = 0; i < 4; i++)
+				v[i] = (float)va_arg(copy, double);
+			mock_attrib4(v[0], v[1], v[2], v[3]);
+		} else if (func == (void (*)())mock_attrib3) {
+			float v[3];
+			for (int i = 0; i < 3; i++)
+				v[i] = (float)va_arg(copy, double);
+			mock_attrib3(v[0], v[1], v[2]);
+		} else if (func == (void (*)())mock_attrib2) {
+			float s = (float)va_arg(copy, double);
+			mock_attrib2(s, (float)va_arg(copy, double));
+		} else if (func == (void (*)())mock_attrib_unit) {
+			uint32_t unit = va_arg(copy, uint32_t);
+			float s = (float)va_arg(copy, double);
+			mock_attrib_unit(unit, s, (float)va_arg(copy, double));
+		} else if (func == (void (*)())mock_vertex) {
+			float v[3];
+			for (int i = 0; i < 3; i++)
+				v[i] = (float)va_arg(copy, double);
+			mock_vertex(v[0], v[1], v[2]);
+		} else {
+			uint32_t id = va_arg(copy, uint32_t);
+			mock_effect(id, va_arg(copy, int32_t));
+		}
+		va_end(copy);
+	}
+	va_end(args);
+}
+
+// Random program with bursts of redundant state changes and overwritten attributes, replayed identically for a given seed
+static void run_program(dlist_arena *a, int seed) {
+	srand(seed);
+	for (int i = 0; i < CALLS_NUM; i++) {
+		float f = (float)(rand() % 4);
+		switch (rand() % 8) {
+		case 0:
+			issue(a, (void (*)())mock_state, DLIST_FLAG_IDEMPOTENT, "UU", rand() % STATES_NUM, rand() % 2);
+			break;
+		case 1:
+			issue(a, (void (*)())mock_attrib4, DLIST_FLAG_ATTRIB_CLASS(0), "FFFF", f, f + 1.0f, f + 2.0f, 1.0f);
+			break;
+		case 2:
+			issue(a, (void (*)())mock_attrib3, DLIST_FLAG_ATTRIB_CLASS(1), "FFF", f, -f, 0.5f);
+			break;
+		case 3:
+			issue(a, (void (*)())mock_attrib2, DLIST_FLAG_ATTRIB_CLASS(2), "FF", f, f * 2.0f);
+			break;
+		case 4:
+			issue(a, (void (*)())mock_attrib_unit, DLIST_FLAG_ATTRIB_CLASS(3), "UFF", 1, f, -f);
+			break;
+		case 5:
+		case 6:
+			issue(a, (void (*)())mock_vertex, DLIST_FLAG_VERTEX, "FFF", f, (float)i, 0.0f);
+			break;
+		default:
+			issue(a, (void (*)())mock_effect, 0, "UI", i, rand() % 5 - 2);
+			break;
+		}
+	}
+}
+
+static void reset_mock(void) {
+	memset(&gl, 0, sizeof(gl));
+	events_num = 0;
+	calls_num = 0;
+}
+
+static void test_programs(void) {
+	static event expected[LOG_MAX];
+	int folded = 0;
+	for (int p = 0; p < PROGRAMS_NUM; p++) {
+		reset_mock();
+		run_program(NULL, p);
+		int expected_num = events_num, direct_calls = calls_num;
+		memcpy(expected, events, events_num * sizeof(event));
+		uint32_t expected_state[STATES_NUM];
+		memcpy(expected_state, gl.state, sizeof(gl.state));
+
+		dlist_arena a;
+		dlist_arena_init(&a);
+		reset_mock();
+		run_program(&a, p);
+		CHECK_EQ(calls_num, 0); // Recording must not execute anything
+		dlist_execute(&a, NULL);
+		CHECK_EQ(events_num, expected_num);
+		CHECK(!memcmp(events, expected, expected_num * sizeof(event)));
+		CHECK(!memcmp(gl.state, expected_state, sizeof(expected_state)));
+		folded += direct_calls - calls_num;
+
+		// Replaying again from the same initial state must give the same events
+		reset_mock();
+		dlist_execute(&a, NULL);
+		CHECK_EQ(events_num, expected_num);
+		CHECK(!memcmp(events, expected, expected_num * sizeof(event)));
+		dlist_arena_free(&a);
+	}
+	// The programs are redundant enough for the folding to kick in
+	CHECK(folded > 0);
+}
+
+// Every operands layout must reach the replayed function unchanged
+static uint32_t sig_args[4];
+static int sig_calls = 0;
+
+#define SIG_MOCK(name, t0, t1, t2, t3) \
+	static void name(t0 a, t1 b, t2 c, t3 d) { \
+		memcpy(&sig_args[0], &a, sizeof(a)); \
+		memcpy(&sig_args[1], &b, sizeof(b)); \
+		memcpy(&sig_args[2], &c, sizeof(c)); \
+		memcpy(&sig_args[3], &d, sizeof(d)); \
+		sig_calls++; \
+	}
+SIG_MOCK(sig_uuuu, uint32_t, uint32_t, uint32_t, uint32_t)
+SIG_MOCK(sig_ffff, float, float, float, float)
+SIG_MOCK(sig_iuiu, int32_t, uint32_t, int32_t, uint32_t)
+
+static void sig_s3(int16_t a, int16_t b, int16_t c) {
+	sig_args[0] = (uint32_t)a;
+	sig_args[1] = (uint32_t)b;
+	sig_args[2] = (uint32_t)c;
+	sig_calls++;
+}
+
+static void sig_x4(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+	sig_args[0] = a;
+	sig_args[1] = b;
+	sig_args[2] = c;
+	sig_args[3] = d;
+	sig_calls++;
+}
+
+static void sig_void(void) {
+	sig_calls++;
+}
+
+static dlistFuncType pack_sig(const char *sig, ...) {
+	uint8_t packed[DLIST_MAX_ARGS_SIZE];
+	uint32_t size = 0;
+	va_list args;
+	va_start(args, sig);
+	dlistFuncType type = dlist_pack_args(packed, &size, sig, args);
+	va_end(args);
+	return type;
+}
+
+static void record_sig(dlist_arena *a, void (*func)(), const char *sig, ...) {
+	uint8_t packed[DLIST_MAX_ARGS_SIZE];
+	uint32_t size = 0;
+	va_list args;
+	va_start(args, sig);
+	dlistFuncType type = dlist_pack_args(packed, &size, sig, args);
+	va_end(args);
+	CHECK(type != DLIST_OP_INVALID);
+	dlist_record(a, func, type, 0, packed, size);
+}
+
+static void test_signatures(void) {
+	dlist_arena a;
+	float f[4] = {1.5f, -2.25f, 3.0f, 1e-3f};
+	uint32_t fbits[4];
+	memcpy(fbits, f, sizeof(f));
+
+	dlist_arena_init(&a);
+	record_sig(&a, (void (*)())sig_uuuu, "UUUU", 0xDEADBEEF, 1, 0x80000000, 7);
+	sig_calls = 0;
+	dlist_execute(&a, NULL);
+	CHECK_EQ(sig_calls, 1);
+	CHECK(sig_args[0] == 0xDEADBEEF && sig_args[1] == 1 && sig_args[2] == 0x80000000 && sig_args[3] == 7);
+	dlist_arena_free(&a);
+
+	dlist_arena_init(&a);
+	record_sig(&a, (void (*)())sig_ffff, "FFFF", f[0], f[1], f[2], f[3]);
+	dlist_execute(&a, NULL);
+	CHECK(!memcmp(sig_args, fbits, sizeof(fbits)));
+	dlist_arena_free(&a);
+
+	dlist_arena_init(&a);
+	record_sig(&a, (void (*)())sig_iuiu, "IUIU", -5, 6, -7, 8);
+	dlist_execute(&a, NULL);
+	CHECK((int32_t)sig_args[0] == -5 && sig_args[1] == 6 && (int32_t)sig_args[2] == -7 && sig_args[3] == 8);
+	dlist_arena_free(&a);
+
+	dlist_arena_init(&a);
+	record_sig(&a, (void (*)())sig_s3, "SSS", -32768, 32767, -1);
+	dlist_execute(&a, NULL);
+	CHECK((int32_t)sig_args[0] == -32768 && (int32_t)sig_args[1] == 32767 && (int32_t)sig_args[2] == -1);
+	dlist_arena_free(&a);
+
+	dlist_arena_init(&a);
+	record_sig(&a, (void (*)())sig_x4, "XXXX", 0, 255, 128, 1);
+	dlist_execute(&a, NULL);
+	CHECK(sig_args[0] == 0 && sig_args[1] == 255 && sig_args[2] == 128 && sig_args[3] == 1);
+	dlist_arena_free(&a);
+
+	// Unsupported signatures are rejected instead of being packed wrongly
+	CHECK_EQ(pack_sig("UUUUU", 1, 2, 3, 4, 5), DLIST_OP_INVALID);
+	CHECK_EQ(pack_sig("FU", 1.0f, 2), DLIST_OP_INVALID);
+
+	// Void calls
+	dlist_arena_init(&a);
+	record_sig(&a, (void (*)())sig_void, "");
+	sig_calls = 0;
+	dlist_execute(&a, NULL);
+	CHECK_EQ(sig_calls, 1);
+	dlist_arena_free(&a);
+}
+
+// Hooks and jumps, as used for baked primitives and their fallback calls
+static uint32_t hook_calls = 0;
+static uint32_t hook_next = 0;
+static uint32_t end_hook(const dlist_arena *a, const dlist_op *op, uint32_t next) {
+	hook_calls++;
+	hook_next = next;
+	return a->size;
+}
+
+static void test_control_flow(void) {
+	dlist_arena a;
+	dlist_arena_init(&a);
+	reset_mock();
+	issue(&a, (void (*)())mock_effect, 0, "UI", 0, 1);
+	dlist_op hook = {NULL, DLIST_OP_HOOK, 0, sizeof(dlist_op)};
+	uint32_t hook_off = dlist_append(&a, &hook);
+	struct {
+		dlist_op hdr;
+		uint32_t target;
+	} jump = {{NULL, DLIST_OP_JUMP, 0, sizeof(jump)}, 0};
+	uint32_t jump_off = dlist_append(&a, &jump.hdr);
+	issue(&a, (void (*)())mock_effect, 0, "UI", 0, 100); // Skipped by the jump
+	uint32_t target = a.size;
+	issue(&a, (void (*)())mock_effect, 0, "UI", 0, 10);
+	*(uint32_t *)dlist_op_args(dlist_op_at(&a, jump_off)) = target;
+
+	dlist_execute(&a, NULL);
+	CHECK_EQ(gl.counter, 13); // (0 * 3 + 1) * 3 + 10
+	CHECK_EQ(events_num, 2);
+
+	// The hook decides where the replay continues from
+	reset_mock();
+	dlist_execute(&a, end_hook);
+	CHECK_EQ(hook_calls, 1);
+	CHECK_EQ(hook_next, hook_off + sizeof(dlist_op));
+	CHECK_EQ(gl.counter, 1);
+	CHECK_EQ(events_num, 1);
+	dlist_arena_free(&a);
+}
+
+int main(int argc, char **argv) {
+	test_signatures();
+	test_programs();
+	test_control_flow();
+	return TEST_RESULT();
+}
@@ -0,0 +1,169 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * dxt.c:
+ * Tests for the runtime DXT compressor, output must not depend on the number of workers in use
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utils/dxt_utils.h"
+
+#include "test.h"
+
+#define IMG_W 256 // Width of the images compressed by the workers tests
+#define IMG_H 128 // Height of the images compressed by the workers tests
+#define ROUNDS 4 // Compressions repeated per workers count to catch rows handed out differently
+
+static const dxt_quality qualities[] = {DXT_QUALITY_FAST, DXT_QUALITY_NORMAL, DXT_QUALITY_HIGH};
+
+static inline int clamp_u8(double v) {
+	return v < 0 ? 0 : (v > 255 ? 255 : (int)v);
+}
+
+static void gen_image(uint8_t *img, int w, int h, int kind) {
+	srand(kind + 1);
+	for (int y = 0; y < h; y++) {
+		for (int x = 0; x < w; x++) {
+			uint8_t *p = img + (y * w + x) * 4;
+			double fx = x / (double)w, fy = y / (double)h;
+			switch (kind) {
+			case 0: // Smooth fields with noise
+				p[0] = clamp_u8(128 + 90 * sin(fx * 9 + fy * 3) + rand() % 12);
+				p[1] = clamp_u8(128 + 80 * sin(fy * 7 + 1) * cos(fx * 4) + rand() % 12);
+				p[2] = clamp_u8(100 + 100 * cos(fx * 5 - fy * 6) + rand() % 12);
+				p[3] = clamp_u8(255 * fx + rand() % 8);
+				break;
+			case 1: // Hard edged tiles
+				p[0] = ((x / 13) * 37) & 0xFF;
+				p[1] = ((y / 7) * 53) & 0xFF;
+				p[2] = (((x + y) / 11) * 71) & 0xFF;
+				p[3] = ((x / 16 + y / 16) & 1) ? 0xFF : 0;
+				break;
+			default: // Random bytes
+				for (int c = 0; c < 4; c++)
+					p[c] = rand();
+				break;
+			}
+		}
+	}
+}
+
+// Morton order walk over the po2 square covering the texture, as gpu_utils.c used to lay out blocks
+static uint32_t morton_compact(uint32_t x) {
+	x &= 0x55555555;
+	x = (x | (x >> 1)) & 0x33333333;
+	x = (x | (x >> 2)) & 0x0F0F0F0F;
+	x = (x | (x >> 4)) & 0x00FF00FF;
+	x = (x | (x >> 8)) & 0x0000FFFF;
+	return x;
+}
+
+static void test_swizzle(void) {
+	for (uint32_t bw = 1; bw <= 256; bw *= 2) {
+		for (uint32_t bh = 1; bh <= 256; bh *= 2) {
+			uint32_t s = bw > bh ? bw : bh;
+			uint32_t pos = 0, mismatches = 0;
+			for (uint32_t d = 0; d < s * s; d++) {
+				uint32_t y = morton_compact(d), x = morton_compact(d >> 1);
+				if (x >= bw || y >= bh)
+					continue;
+				mismatches += dxt_swizzled_block_index(x, y, bw, bh) != pos++;
+			}
+			CHECK_EQ(mismatches, 0);
+			CHECK_EQ(pos, bw * bh);
+		}
+	}
+}
+
+// Every block of the swizzled output must match the same block compressed alone
+static void test_layout(const uint8_t *img, int isdxt5, dxt_quality quality) {
+	const int w = 64, h = 32, block_size = isdxt5 ? 16 : 8;
+	uint8_t *out = malloc(w * h);
+	dxt_compress_swizzled(out, img, w, h, w, h, isdxt5, quality);
+	int mismatches = 0;
+	for (int by = 0; by < h / 4; by++) {
+		for (int bx = 0; bx < w / 4; bx++) {
+			uint8_t block[64], res[16];
+			for (int j = 0; j < 4; j++)
+				memcpy(&block[j * 16], img + ((by * 4 + j) * w + bx * 4) * 4, 16);
+			dxt_compress_block(res, block, isdxt5, quality);
+			mismatches += memcmp(res, out + dxt_swizzled_block_index(bx, by, w / 4, h / 4) * block_size, block_size) != 0;
+		}
+	}
+	CHECK_EQ(mismatches, 0);
+	free(out);
+}
+
+// Texels past the source size replicate its last row and column
+static void test_padding(const uint8_t *img, int isdxt5, dxt_quality quality) {
+	const int src_w = 100, src_h = 60, w = 128, h = 64;
+	uint8_t *padded = malloc(w * h * 4), *expected = malloc(w * h), *res = malloc(w * h);
+	for (int y = 0; y < h; y++) {
+		for (int x = 0; x < w; x++) {
+			int sx = x < src_w ? x : src_w - 1;
+			int sy = y < src_h ? y : src_h - 1;
+			memcpy(padded + (y * w + x) * 4, img + (sy * src_w + sx) * 4, 4);
+		}
+	}
+	dxt_compress_swizzled(expected, padded, w, h, w, h, isdxt5, quality);
+	dxt_compress_swizzled(res, img, src_w, src_h, w, h, isdxt5, quality);
+	CHECK(!memcmp(res, expected, w * h / (isdxt5 ? 1 : 2)));
+	free(padded);
+	free(expected);
+	free(res);
+}
+
+int main(int argc, char **argv) {
+	uint8_t *img = malloc(IMG_W * IMG_H * 4);
+	uint8_t *expected = malloc(IMG_W * IMG_H), *res = malloc(IMG_W * IMG_H);
+
+	test_swizzle();
+
+	for (int kind = 0; kind < 3; kind++) {
+		gen_image(img, IMG_W, IMG_H, kind);
+		for (int isdxt5 = 0; isdxt5 < 2; isdxt5++) {
+			size_t size = IMG_W * IMG_H / (isdxt5 ? 1 : 2);
+			for (int q = 0; q < sizeof(qualities) / sizeof(*qualities); q++) {
+				test_layout(img, isdxt5, qualities[q]);
+				test_padding(img, isdxt5, qualities[q]);
+
+				dxt_workers_term();
+				dxt_compress_swizzled(expected, img, IMG_W, IMG_H, IMG_W, IMG_H, isdxt5, qualities[q]);
+				for (int n = 1; n <= DXT_MAX_WORKERS; n++) {
+					CHECK(dxt_workers_init(n, 0, 0));
+					for (int r = 0; r < ROUNDS; r++) {
+						memset(res, 0, size);
+						dxt_compress_swizzled(res, img, IMG_W, IMG_H, IMG_W, IMG_H, isdxt5, qualities[q]);
+						CHECK(!memcmp(res, expected, size));
+					}
+					// Sources smaller than the texture go through the edge replication path
+					test_padding(img, isdxt5, qualities[q]);
+				}
+				dxt_workers_term();
+			}
+		}
+	}
+
+	free(img);
+	free(expected);
+	free(res);
+	return TEST_RESULT();
+}
@@ -0,0 +1,83 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * dxt_neon.c:
+ * Tests for the NEON paths of the runtime DXT compressor, built on the host against a portable emulation of the intrinsics in use
+ * and checked byte by byte against the portable compressor in libvitaGL
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+// The NEON build is renamed so that the portable one gets linked alongside it
+#define __ARM_NEON 1
+#define dxt_workers_init neon_dxt_workers_init
+#define dxt_workers_term neon_dxt_workers_term
+#define dxt_compress_block neon_dxt_compress_block
+#define dxt_compress_swizzled neon_dxt_compress_swizzled
+#define dxt_swizzled_block_index neon_dxt_swizzled_block_index
+#include "utils/dxt_utils.c"
+#undef dxt_workers_init
+#undef dxt_workers_term
+#undef dxt_compress_block
+#undef dxt_compress_swizzled
+#undef dxt_swizzled_block_index
+
+void dxt_compress_swizzled(uint8_t *dst, const uint8_t *src, int src_w, int src_h, int w, int h, int isdxt5, dxt_quality quality);
+
+#include "test.h"
+
+#define IMG_SIZE 128 // Width and height of the compressed images
+
+int main(int argc, char **argv) {
+	uint8_t *img = malloc(IMG_SIZE * IMG_SIZE * 4);
+	uint8_t *expected = malloc(IMG_SIZE * IMG_SIZE), *res = malloc(IMG_SIZE * IMG_SIZE);
+
+	for (int kind = 0; kind < 3; kind++) {
+		// Random bytes, few distinct levels per channel (flat and single channel blocks) and smooth ramps
+		srand(kind + 1);
+		for (int i = 0; i < IMG_SIZE * IMG_SIZE * 4; i++) {
+			int x = (i / 4) % IMG_SIZE, y = i / 4 / IMG_SIZE;
+			switch (kind) {
+			case 0:
+				img[i] = rand();
+				break;
+			case 1:
+				img[i] = (rand() % 3) * 0x55 * ((i + y) % 2);
+				break;
+			default:
+				img[i] = (x * (i % 4 + 1) + y * 3 + rand() % 3) & 0xFF;
+				break;
+			}
+		}
+		for (int isdxt5 = 0; isdxt5 < 2; isdxt5++) {
+			for (dxt_quality q = DXT_QUALITY_FAST; q <= DXT_QUALITY_HIGH; q++) {
+				size_t size = IMG_SIZE * IMG_SIZE / (isdxt5 ? 1 : 2);
+				dxt_compress_swizzled(expected, img, IMG_SIZE, IMG_SIZE, IMG_SIZE, IMG_SIZE, isdxt5, q);
+				neon_dxt_compress_swizzled(res, img, IMG_SIZE, IMG_SIZE, IMG_SIZE, IMG_SIZE, isdxt5, q);
+				CHECK(!memcmp(res, expected, size));
+			}
+		}
+	}
+
+	free(img);
+	free(expected);
+	free(res);
+	return TEST_RESULT();
+}
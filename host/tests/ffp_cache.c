@@ -0,0 +1,196 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * ffp_cache.c:
+ * Tests for the ffp shaders RAM cache (variants lookup and release across vitaGL instances)
+ */
+
+#include <malloc.h>
+#include <vitaGL.h>
+#include <vgl_mock.h>
+
+#include "test.h"
+
+#define VARIANTS_NUM 64
+#define INSTANCES_NUM 4
+#define LEAK_SLACK (32 * 1024)
+#define CACHE_SIZE 256 // Default capacity of the cache
+#define SMALL_CACHE_SIZE 4
+#define ALPHA_FUNCS_NUM 8
+
+static float vertices[] = {100, 100, 0, 150, 100, 0, 100, 150, 0};
+static float colors[] = {1.0, 1.0, 1.0, 1.0, 0.0, 0.0, 1.0, 0.0, 1.0};
+static const GLenum alpha_funcs[] = {GL_NEVER, GL_LESS, GL_EQUAL, GL_LEQUAL, GL_GREATER, GL_NOTEQUAL, GL_GEQUAL, GL_ALWAYS};
+static const GLenum fog_modes[] = {GL_LINEAR, GL_EXP, GL_EXP2};
+
+static void set_variant(int v) {
+	// Alpha test function, fog mode and per vertex colors, each combination needs its own ffp shaders
+	glAlphaFunc(alpha_funcs[v & 7], 0.5f);
+	if ((v >> 3) & 3) {
+		glEnable(GL_FOG);
+		glFogi(GL_FOG_MODE, fog_modes[((v >> 3) & 3) - 1]);
+	} else
+		glDisable(GL_FOG);
+	if ((v >> 5) & 1)
+		glDisableClientState(GL_COLOR_ARRAY);
+	else
+		glEnableClientState(GL_COLOR_ARRAY);
+}
+
+static void draw_variants(void) {
+	glEnable(GL_ALPHA_TEST);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 0, vertices);
+	glColorPointer(3, GL_FLOAT, 0, colors);
+	for (int i = 0; i < VARIANTS_NUM; i++) {
+		set_variant(i);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+	}
+	vglSwapBuffers(GL_FALSE);
+}
+
+static void draw_alpha_variants(void) {
+	// Only the fragment stage changes, so every variant shares the same vertex program
+	glEnable(GL_ALPHA_TEST);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 0, vertices);
+	for (int i = 0; i < ALPHA_FUNCS_NUM; i++) {
+		glAlphaFunc(alpha_funcs[i], 0.5f);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+	}
+	vglSwapBuffers(GL_FALSE);
+}
+
+static size_t run_instance(void) {
+	vglFFPCacheStats stats;
+	vglMockStats mock_stats;
+
+	// Keeping the mock commands log from growing along with the instances
+	vglMockReset();
+	vglInit(0x800000);
+	vglGetFFPCacheStats(&stats);
+	CHECK_EQ(stats.entries, 0);
+	draw_variants();
+	draw_variants();
+	vglGetFFPCacheStats(&stats);
+	CHECK_EQ(stats.entries, VARIANTS_NUM);
+	CHECK_EQ(stats.misses, VARIANTS_NUM);
+	CHECK_EQ(stats.hits, VARIANTS_NUM);
+	vglEnd();
+
+	// Cached ffp shaders and their patched programs must not outlive the instance
+	vglMockGetStats(&mock_stats);
+	CHECK_EQ(mock_stats.live_programs, 0);
+	CHECK_EQ(mock_stats.live_vertex_programs, 0);
+	CHECK_EQ(mock_stats.live_fragment_programs, 0);
+
+	struct mallinfo2 info = mallinfo2();
+	return info.uordblks + info.hblkhd;
+}
+
+static void run_evicting_instance(void) {
+	vglFFPCacheStats stats;
+	vglMockStats before, mock_stats;
+
+	// Evicted entries share their vertex program with the cached ones and with the in use ffp shaders
+	vglSetFFPCacheSize(SMALL_CACHE_SIZE);
+	vglInit(0x800000);
+	draw_alpha_variants();
+	vglMockGetStats(&before);
+	draw_alpha_variants();
+	vglGetFFPCacheStats(&stats);
+	CHECK_EQ(stats.entries, SMALL_CACHE_SIZE);
+	CHECK_EQ(stats.misses, ALPHA_FUNCS_NUM * 2);
+	CHECK_EQ(stats.evictions, ALPHA_FUNCS_NUM * 2 - SMALL_CACHE_SIZE);
+
+	// Every miss patches a fragment program and every eviction releases the ones patched for its shaders
+	vglMockGetStats(&mock_stats);
+	CHECK_EQ(mock_stats.errors, 0);
+	CHECK_EQ(mock_stats.patcher_calls[VGL_MOCK_PATCHER_CREATE_FRAGMENT] - before.patcher_calls[VGL_MOCK_PATCHER_CREATE_FRAGMENT], ALPHA_FUNCS_NUM);
+	CHECK_EQ(mock_stats.live_vertex_programs, before.live_vertex_programs);
+	CHECK_EQ(mock_stats.live_fragment_programs, before.live_fragment_programs);
+	vglEnd();
+
+	vglMockGetStats(&mock_stats);
+	CHECK_EQ(mock_stats.live_vertex_programs, 0);
+	CHECK_EQ(mock_stats.live_fragment_programs, 0);
+	CHECK_EQ(mock_stats.live_programs, 0);
+	vglSetFFPCacheSize(CACHE_SIZE);
+}
+
+static void run_same_variant_instances(void) {
+	vglFFPCacheStats stats;
+
+	// The ffp config is the same as the one of the previous instance, but its shaders went away with it
+	for (int i = 0; i < 2; i++) {
+		vglInit(0x800000);
+		glEnable(GL_ALPHA_TEST);
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glVertexPointer(3, GL_FLOAT, 0, vertices);
+		glColorPointer(3, GL_FLOAT, 0, colors);
+		set_variant(VARIANTS_NUM - 1);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		vglSwapBuffers(GL_FALSE);
+		vglGetFFPCacheStats(&stats);
+		CHECK_EQ(stats.misses, 1);
+		vglEnd();
+	}
+}
+
+static void run_setterless_instance(void) {
+	vglFFPCacheStats stats;
+
+	vglInit(0x800000);
+	glEnable(GL_ALPHA_TEST);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 0, vertices);
+	set_variant(VARIANTS_NUM - 1);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	vglSwapBuffers(GL_FALSE);
+	vglEnd();
+
+	// Client state survives the instance, so the next one draws without calling any ffp setter
+	vglInit(0x800000);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	vglSwapBuffers(GL_FALSE);
+	vglGetFFPCacheStats(&stats);
+	CHECK_EQ(stats.misses, 1);
+	vglEnd();
+}
+
+int main(int argc, char **argv) {
+	// Keeping big blocks from moving between the heap and mmap from one instance to the next
+	mallopt(M_MMAP_THRESHOLD, 128 * 1024);
+
+	// Running first, mock errors are meaningful only as long as no GL object survived a previous instance
+	run_evicting_instance();
+	run_same_variant_instances();
+	run_setterless_instance();
+
+	// Every instance must release what the previous one cached. A leaked cache holds every program in it,
+	// so the heap growing by more than the few KB libc keeps for its own bookkeeping means a leak
+	run_instance();
+	size_t used = run_instance();
+	size_t last = used;
+	for (int i = 0; i < INSTANCES_NUM; i++) {
+		last = run_instance();
+	}
+	CHECK(last < used + LEAK_SLACK);
+	return TEST_RESULT();
+}
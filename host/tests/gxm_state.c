@@ -0,0 +1,297 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * gxm_state.c:
+ * Tests for the sceGxm state shadowing, every setter call is also applied to a model sending it straight to sceGxm
+ * as vitaGL did before shadowing, and the state the mock holds at every draw must match the model
+ * NOTE: set_gxm_* functions are wrapped at link time
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <vitasdk.h>
+#include <vitaGL.h>
+#include <vgl_mock.h>
+#include "utils/gxm_state_utils.h"
+
+#include "test.h"
+
+#define FRAMES_NUM 8 // Frames rendered by the test scene
+#define KEYS_NUM (VGL_MOCK_STATE_NUM * 2) // Model slots, one per state and side
+
+// Setter call as seen by sceGxm without shadowing
+typedef struct {
+	uint32_t pos; // Mock log length when the call got issued
+	uint32_t key;
+	uint64_t value;
+	uint64_t extra;
+} state_request;
+
+typedef struct {
+	int valid;
+	uint64_t value;
+	uint64_t extra;
+} state_slot;
+
+static state_request *requests = NULL;
+static uint32_t requests_num = 0, requests_cap = 0;
+
+static void add_request(vglMockState state, int side, uint64_t value, uint64_t extra) {
+	if (requests_num == requests_cap) {
+		requests_cap = requests_cap ? requests_cap * 2 : 4096;
+		requests = realloc(requests, requests_cap * sizeof(state_request));
+	}
+	uint32_t pos;
+	vglMockGetLog(&pos);
+	state_request *r = &requests[requests_num++];
+	r->pos = pos;
+	r->key = state * 2 + side;
+	r->value = value;
+	r->extra = extra;
+}
+
+// Values are encoded as the mock logs them, front/back states carry the side as extra value
+static void add_sided_request(vglMockState state, int sides, uint64_t value) {
+	if (sides & GXM_SIDE_FRONT)
+		add_request(state, 0, value, 0);
+	if (sides & GXM_SIDE_BACK)
+		add_request(state, 1, value, 1);
+}
+
+void __real_set_gxm_depth_func(int sides, SceGxmDepthFunc func);
+void __real_set_gxm_depth_write_enable(int sides, SceGxmDepthWriteMode mode);
+void __real_set_gxm_stencil_func(int sides, SceGxmStencilFunc func, SceGxmStencilOp stencil_fail, SceGxmStencilOp depth_fail, SceGxmStencilOp depth_pass, uint8_t compare_mask, uint8_t write_mask);
+void __real_set_gxm_stencil_ref(int sides, uint32_t ref);
+void __real_set_gxm_polygon_mode(int sides, SceGxmPolygonMode mode);
+void __real_set_gxm_depth_bias(int sides, int factor, int units);
+void __real_set_gxm_fragment_program_enable(int sides, SceGxmFragmentProgramMode mode);
+void __real_set_gxm_point_line_width(int sides, uint32_t width);
+void __real_set_gxm_cull_mode(SceGxmCullMode mode);
+void __real_set_gxm_two_sided_enable(SceGxmTwoSidedMode mode);
+void __real_set_gxm_region_clip(SceGxmRegionClipMode mode, uint32_t x_min, uint32_t y_min, uint32_t x_max, uint32_t y_max);
+void __real_set_gxm_viewport(float x_offset, float x_scale, float y_offset, float y_scale, float z_offset, float z_scale);
+
+void __wrap_set_gxm_depth_func(int sides, SceGxmDepthFunc func) {
+	add_sided_request(VGL_MOCK_STATE_DEPTH_FUNC, sides, func);
+	__real_set_gxm_depth_func(sides, func);
+}
+
+void __wrap_set_gxm_depth_write_enable(int sides, SceGxmDepthWriteMode mode) {
+	add_sided_request(VGL_MOCK_STATE_DEPTH_WRITE, sides, mode);
+	__real_set_gxm_depth_write_enable(sides, mode);
+}
+
+void __wrap_set_gxm_stencil_func(int sides, SceGxmStencilFunc func, SceGxmStencilOp stencil_fail, SceGxmStencilOp depth_fail, SceGxmStencilOp depth_pass, uint8_t compare_mask, uint8_t write_mask) {
+	add_sided_request(VGL_MOCK_STATE_STENCIL_FUNC, sides, (uint64_t)func | ((uint64_t)stencil_fail << 32) | ((uint64_t)depth_fail << 36) | ((uint64_t)depth_pass << 40) | ((uint64_t)compare_mask << 48) | ((uint64_t)write_mask << 56));
+	__real_set_gxm_stencil_func(sides, func, stencil_fail, depth_fail, depth_pass, compare_mask, write_mask);
+}
+
+void __wrap_set_gxm_stencil_ref(int sides, uint32_t ref) {
+	add_sided_request(VGL_MOCK_STATE_STENCIL_REF, sides, ref);
+	__real_set_gxm_stencil_ref(sides, ref);
+}
+
+void __wrap_set_gxm_polygon_mode(int sides, SceGxmPolygonMode mode) {
+	add_sided_request(VGL_MOCK_STATE_POLYGON_MODE, sides, mode);
+	__real_set_gxm_polygon_mode(sides, mode);
+}
+
+void __wrap_set_gxm_depth_bias(int sides, int factor, int units) {
+	add_sided_request(VGL_MOCK_STATE_DEPTH_BIAS, sides, (uint32_t)factor | ((uint64_t)(uint32_t)units << 32));
+	__real_set_gxm_depth_bias(sides, factor, units);
+}
+
+void __wrap_set_gxm_fragment_program_enable(int sides, SceGxmFragmentProgramMode mode) {
+	add_sided_request(VGL_MOCK_STATE_FRAGMENT_PROGRAM_ENABLE, sides, mode);
+	__real_set_gxm_fragment_program_enable(sides, mode);
+}
+
+void __wrap_set_gxm_point_line_width(int sides, uint32_t width) {
+	add_sided_request(VGL_MOCK_STATE_POINT_LINE_WIDTH, sides, width);
+	__real_set_gxm_point_line_width(sides, width);
+}
+
+void __wrap_set_gxm_cull_mode(SceGxmCullMode mode) {
+	add_request(VGL_MOCK_STATE_CULL_MODE, 0, mode, 0);
+	__real_set_gxm_cull_mode(mode);
+}
+
+void __wrap_set_gxm_two_sided_enable(SceGxmTwoSidedMode mode) {
+	add_request(VGL_MOCK_STATE_TWO_SIDED, 0, mode, 0);
+	__real_set_gxm_two_sided_enable(mode);
+}
+
+void __wrap_set_gxm_region_clip(SceGxmRegionClipMode mode, uint32_t x_min, uint32_t y_min, uint32_t x_max, uint32_t y_max) {
+	add_request(VGL_MOCK_STATE_REGION_CLIP, 0, mode, (uint64_t)x_min | ((uint64_t)y_min << 16) | ((uint64_t)x_max << 32) | ((uint64_t)y_max << 48));
+	__real_set_gxm_region_clip(mode, x_min, y_min, x_max, y_max);
+}
+
+void __wrap_set_gxm_viewport(float x_offset, float x_scale, float y_offset, float y_scale, float z_offset, float z_scale) {
+	// Only the x and y transforms are logged by the mock
+	float v[4] = {x_offset, x_scale, y_offset, y_scale};
+	uint32_t bits[4];
+	memcpy(bits, v, sizeof(bits));
+	add_request(VGL_MOCK_STATE_VIEWPORT, 0, bits[0] | ((uint64_t)bits[1] << 32), bits[2] | ((uint64_t)bits[3] << 32));
+	__real_set_gxm_viewport(x_offset, x_scale, y_offset, y_scale, z_offset, z_scale);
+}
+
+static int is_sided(uint32_t state) {
+	return state != VGL_MOCK_STATE_CULL_MODE && state != VGL_MOCK_STATE_TWO_SIDED && state != VGL_MOCK_STATE_REGION_CLIP && state != VGL_MOCK_STATE_VIEWPORT;
+}
+
+static void reset_scene_slots(state_slot *slots) {
+	slots[VGL_MOCK_STATE_VIEWPORT * 2].valid = 0;
+	slots[VGL_MOCK_STATE_REGION_CLIP * 2].valid = 0;
+}
+
+/*
+ * Test scene exercising depth, culling, scissor, stencil, lines and points, polygon offset, attributes stack,
+ * framebuffer switches and clears mid frame
+ */
+static float tri[] = {-1, -1, 0, 1, -1, 0, 0, 1, 0, -1, 1, 0};
+static GLuint tex, fb;
+
+static void draw(GLenum mode, int n) {
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 0, tri);
+	glDrawArrays(mode, 0, n);
+}
+
+static void draw_frame(int f) {
+	glViewport(0, 0, 960, 544);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+	glEnable(GL_DEPTH_TEST);
+	glDepthFunc(f & 1 ? GL_LEQUAL : GL_LESS);
+	glEnable(GL_CULL_FACE);
+	glCullFace(GL_BACK);
+	glFrontFace(f & 2 ? GL_CW : GL_CCW);
+	draw(GL_TRIANGLES, 3);
+	glEnable(GL_SCISSOR_TEST);
+	glScissor(10 + f, 20, 300, 200);
+	draw(GL_TRIANGLES, 3);
+
+	glPushAttrib(GL_ALL_ATTRIB_BITS);
+	glEnable(GL_STENCIL_TEST);
+	glStencilFunc(GL_EQUAL, f & 7, 0xFF);
+	glStencilOp(GL_KEEP, GL_INCR, GL_REPLACE);
+	glDepthMask(GL_FALSE);
+	glLineWidth(2 + (f & 1));
+	draw(GL_LINES, 4);
+	draw(GL_POINTS, 4);
+	draw(GL_LINE_STRIP, 4);
+	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+	glEnable(GL_POLYGON_OFFSET_LINE);
+	glPolygonOffset(1, 2);
+	draw(GL_TRIANGLES, 3);
+	glPopAttrib();
+	draw(GL_TRIANGLES, 3);
+
+	// Rendering to a framebuffer object mid frame and back
+	glBindFramebuffer(GL_FRAMEBUFFER, fb);
+	glViewport(0, 0, 128, 64);
+	draw(GL_TRIANGLES, 3);
+	glClear(GL_DEPTH_BUFFER_BIT);
+	glDisable(GL_SCISSOR_TEST);
+	draw(GL_TRIANGLES, 3);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, 960, 544);
+	draw(GL_TRIANGLE_STRIP, 4);
+	glEnable(GL_SCISSOR_TEST);
+	glClear(GL_STENCIL_BUFFER_BIT);
+	draw(GL_TRIANGLES, 3);
+	glDisable(GL_SCISSOR_TEST);
+	glDisable(GL_CULL_FACE);
+	glDisable(GL_DEPTH_TEST);
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+	vglSwapBuffers(GL_FALSE);
+}
+
+int main(int argc, char **argv) {
+	vglMockReset();
+	vglInit(0x800000);
+	glGenTextures(1, &tex);
+	glBindTexture(GL_TEXTURE_2D, tex);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 128, 64, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glGenFramebuffers(1, &fb);
+	glBindFramebuffer(GL_FRAMEBUFFER, fb);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	for (int f = 0; f < FRAMES_NUM; f++) {
+		draw_frame(f);
+	}
+
+	// Replaying the mock log next to the model, requests are applied as soon as they got issued
+	uint32_t cmds_num;
+	const vglMockCmd *cmds = vglMockGetLog(&cmds_num);
+	state_slot model[KEYS_NUM] = {0}, mock[KEYS_NUM] = {0};
+	uint32_t next = 0, draws = 0, sets = 0, redundant = 0, mismatches = 0;
+	for (uint32_t i = 0; i < cmds_num; i++) {
+		for (; next < requests_num && requests[next].pos <= i; next++) {
+			state_slot *s = &model[requests[next].key];
+			s->valid = 1;
+			s->value = requests[next].value;
+			s->extra = requests[next].extra;
+		}
+		const vglMockCmd *c = &cmds[i];
+		switch (c->type) {
+		case VGL_MOCK_CMD_SET_STATE: {
+			state_slot *s = &mock[c->args[0] * 2 + (is_sided(c->args[0]) ? c->args[2] : 0)];
+			s->valid = 1;
+			s->value = c->args[1];
+			s->extra = c->args[2];
+			sets++;
+			redundant += !c->args[3];
+			break;
+		}
+		case VGL_MOCK_CMD_BEGIN_SCENE:
+			reset_scene_slots(model);
+			reset_scene_slots(mock);
+			break;
+		case VGL_MOCK_CMD_DRAW:
+			for (int k = 0; k < KEYS_NUM; k++) {
+				if (model[k].valid && (!mock[k].valid || mock[k].value != model[k].value || mock[k].extra != model[k].extra)) {
+					if (!mismatches)
+						fprintf(stderr, "draw %u: %s differs from the model\n", draws, vglMockStateName(k / 2));
+					mismatches++;
+				}
+			}
+			draws++;
+			break;
+		default:
+			break;
+		}
+	}
+
+	vglMockStats mock_stats;
+	vglMockGetStats(&mock_stats);
+	vglStateStats stats;
+	vglGetStateStats(&stats);
+	CHECK_EQ(mock_stats.errors, 0);
+	CHECK_EQ(mock_stats.frames, FRAMES_NUM);
+	CHECK(draws >= FRAMES_NUM * 12);
+	CHECK_EQ(mismatches, 0);
+	CHECK_EQ(redundant, 0);
+	CHECK_EQ(stats.issued, sets);
+	CHECK(stats.issued + stats.skipped <= requests_num);
+	CHECK(sets < requests_num);
+	printf("%u draws, %u state changes requested, %u sent to sceGxm, %u skipped\n", draws, requests_num, stats.issued, stats.skipped);
+
+	free(requests);
+	return TEST_RESULT();
+}
@@ -0,0 +1,301 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * index.c:
+ * Tests for the index buffers expansion of non-native primitives, the indices ranges scan and the caches of both
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "utils/index_utils.h"
+
+#include "test.h"
+
+#define MAX_COUNT 200 // Largest index count expanded
+#define MAX_DST (MAX_COUNT * 2 + 8) // Largest expanded index count, plus some guard indices
+
+static const int32_t bases[] = {0, 5, -3};
+
+// Reference expansion, one index at a time and in the same integer width as the source
+#define REF_EXPAND(name, type) \
+	static void name(type *dst, const type *src, uint32_t count, int32_t base, index_prim prim) { \
+		type b = (type)base; \
+		switch (prim) { \
+		case INDEX_PRIM_QUADS: \
+			for (uint32_t i = 0; i < count / 4; i++) { \
+				const type *q = &src[i * 4]; \
+				type tris[6] = {q[0], q[1], q[3], q[1], q[2], q[3]}; \
+				for (int j = 0; j < 6; j++) \
+					dst[i * 6 + j] = tris[j] + b; \
+			} \
+			break; \
+		case INDEX_PRIM_LINE_STRIP: \
+		case INDEX_PRIM_LINE_LOOP: \
+			for (uint32_t i = 0; i + 1 < count; i++) { \
+				dst[i * 2] = src[i] + b; \
+				dst[i * 2 + 1] = src[i + 1] + b; \
+			} \
+			if (prim == INDEX_PRIM_LINE_LOOP && count >= 2) { \
+				dst[(count - 1) * 2] = src[count - 1] + b; \
+				dst[(count - 1) * 2 + 1] = src[0] + b; \
+			} \
+			break; \
+		default: \
+			for (uint32_t i = 0; i < count; i++) \
+				dst[i] = src[i] + b; \
+			break; \
+		} \
+	}
+REF_EXPAND(ref_expand_u16, uint16_t)
+REF_EXPAND(ref_expand_u32, uint32_t)
+
+static void test_expand(void) {
+	uint16_t src16[MAX_COUNT], dst16[MAX_DST], ref16[MAX_DST];
+	uint32_t src32[MAX_COUNT], dst32[MAX_DST], ref32[MAX_DST];
+	srand(1);
+	for (int prim = INDEX_PRIM_LIST; prim <= INDEX_PRIM_LINE_LOOP; prim++) {
+		for (uint32_t count = 0; count < MAX_COUNT; count++) {
+			for (int b = 0; b < sizeof(bases) / sizeof(*bases); b++) {
+				for (uint32_t i = 0; i < count; i++) {
+					src16[i] = rand();
+					src32[i] = (uint32_t)rand() * 2654435761u;
+				}
+				// Guard values past the expanded indices must be left untouched
+				memset(dst16, 0xAA, sizeof(dst16));
+				memset(ref16, 0xAA, sizeof(ref16));
+				memset(dst32, 0xAA, sizeof(dst32));
+				memset(ref32, 0xAA, sizeof(ref32));
+				index_expand_u16(dst16, src16, count, bases[b], prim);
+				index_expand_u32(dst32, src32, count, bases[b], prim);
+				ref_expand_u16(ref16, src16, count, bases[b], prim);
+				ref_expand_u32(ref32, src32, count, bases[b], prim);
+				CHECK(!memcmp(dst16, ref16, sizeof(dst16)));
+				CHECK(!memcmp(dst32, ref32, sizeof(dst32)));
+			}
+		}
+	}
+
+	CHECK_EQ(index_expanded_count(INDEX_PRIM_LIST, 7), 7);
+	CHECK_EQ(index_expanded_count(INDEX_PRIM_QUADS, 11), 12);
+	CHECK_EQ(index_expanded_count(INDEX_PRIM_LINE_STRIP, 1), 0);
+	CHECK_EQ(index_expanded_count(INDEX_PRIM_LINE_STRIP, 5), 8);
+	CHECK_EQ(index_expanded_count(INDEX_PRIM_LINE_LOOP, 1), 0);
+	CHECK_EQ(index_expanded_count(INDEX_PRIM_LINE_LOOP, 5), 10);
+}
+
+// Generated index buffers must match the expansion of a linear index buffer
+static void test_fill(void) {
+	uint16_t linear[MAX_COUNT * 4 + 1], res[MAX_COUNT * 6 + 8], ref[MAX_COUNT * 6 + 8];
+	for (uint32_t first = 0; first < 3; first++) {
+		for (uint32_t n = 0; n < MAX_COUNT; n++) {
+			for (uint32_t i = 0; i <= n * 4; i++)
+				linear[i] = first + i;
+			memset(res, 0xAA, sizeof(res));
+			memset(ref, 0xAA, sizeof(ref));
+			index_fill_linear_u16(res, first, n);
+			memcpy(ref, linear, n * sizeof(uint16_t));
+			CHECK(!memcmp(res, ref, sizeof(res)));
+
+			memset(res, 0xAA, sizeof(res));
+			memset(ref, 0xAA, sizeof(ref));
+			index_fill_quads_u16(res, first, n);
+			ref_expand_u16(ref, linear, n * 4, 0, INDEX_PRIM_QUADS);
+			CHECK(!memcmp(res, ref, sizeof(res)));
+
+			memset(res, 0xAA, sizeof(res));
+			memset(ref, 0xAA, sizeof(ref));
+			index_fill_line_strip_u16(res, first, n);
+			ref_expand_u16(ref, linear, n + 1, 0, INDEX_PRIM_LINE_STRIP);
+			CHECK(!memcmp(res, ref, sizeof(res)));
+		}
+	}
+}
+
+static int freed = 0;
+static void free_converted(void *ptr) {
+	freed++;
+	free(ptr);
+}
+
+static index_cache cache;
+
+static void insert(uint32_t buf_id, uint32_t offset, uint32_t count, int32_t base, index_prim prim, uint32_t size) {
+	index_cache_insert(&cache, buf_id, offset, count, base, prim, 1, malloc(size), count, size);
+}
+
+static void test_cache(void) {
+	index_cache_init(&cache, free_converted);
+
+	// Every part of the key tells entries apart
+	insert(1, 0, 100, 0, INDEX_PRIM_QUADS, 256);
+	CHECK(index_cache_lookup(&cache, 1, 0, 100, 0, INDEX_PRIM_QUADS, 1) != NULL);
+	CHECK(!index_cache_lookup(&cache, 2, 0, 100, 0, INDEX_PRIM_QUADS, 1));
+	CHECK(!index_cache_lookup(&cache, 1, 2, 100, 0, INDEX_PRIM_QUADS, 1));
+	CHECK(!index_cache_lookup(&cache, 1, 0, 96, 0, INDEX_PRIM_QUADS, 1));
+	CHECK(!index_cache_lookup(&cache, 1, 0, 100, 5, INDEX_PRIM_QUADS, 1));
+	CHECK(!index_cache_lookup(&cache, 1, 0, 100, 0, INDEX_PRIM_LINE_LOOP, 1));
+	CHECK(!index_cache_lookup(&cache, 1, 0, 100, 0, INDEX_PRIM_QUADS, 0));
+
+	// Buffers without a content identifier are never served from the cache
+	CHECK(!index_cache_lookup(&cache, 0, 0, 0, 0, INDEX_PRIM_LIST, 0));
+
+	// Updating a buffer region drops only the conversions reading it
+	insert(1, 1000, 100, 0, INDEX_PRIM_QUADS, 256);
+	insert(3, 0, 100, 0, INDEX_PRIM_QUADS, 256);
+	index_cache_invalidate(&cache, 1, 198, 10);
+	CHECK(!index_cache_lookup(&cache, 1, 0, 100, 0, INDEX_PRIM_QUADS, 1));
+	CHECK(index_cache_lookup(&cache, 1, 1000, 100, 0, INDEX_PRIM_QUADS, 1) != NULL);
+	CHECK(index_cache_lookup(&cache, 3, 0, 100, 0, INDEX_PRIM_QUADS, 1) != NULL);
+	CHECK_EQ(freed, 1);
+	CHECK_EQ(cache.bytes, 512);
+	index_cache_invalidate(&cache, 1, 200, 800);
+	CHECK(index_cache_lookup(&cache, 1, 1000, 100, 0, INDEX_PRIM_QUADS, 1) != NULL);
+	index_cache_clear(&cache);
+	CHECK_EQ(freed, 3);
+	CHECK_EQ(cache.bytes, 0);
+
+	// Small conversions are only evicted by the replacement within their set
+	freed = 0;
+	const uint32_t entries = INDEX_CACHE_SETS * INDEX_CACHE_WAYS;
+	for (uint32_t id = 1; id <= entries * 4; id++) {
+		insert(id, 0, 16, 0, INDEX_PRIM_QUADS, 16);
+		CHECK(index_cache_lookup(&cache, 1, 0, 16, 0, INDEX_PRIM_QUADS, 1) != NULL);
+	}
+	CHECK(cache.bytes <= entries * 16);
+	CHECK_EQ(freed + cache.bytes / 16, entries * 4);
+	index_cache_clear(&cache);
+	CHECK_EQ(cache.bytes, 0);
+
+	// Cache budget is never exceeded and the most recently used conversions survive
+	freed = 0;
+	const uint32_t size = 64 * 1024, fitting = INDEX_CACHE_MAX_BYTES / size;
+	for (uint32_t id = 1; id <= fitting * 4; id++) {
+		insert(id, 0, 1000, 0, INDEX_PRIM_QUADS, size);
+		CHECK(cache.bytes <= INDEX_CACHE_MAX_BYTES);
+		// The first conversion is kept in use, so it's never the least recently used one
+		CHECK(index_cache_lookup(&cache, 1, 0, 1000, 0, INDEX_PRIM_QUADS, 1) != NULL);
+	}
+	CHECK(index_cache_lookup(&cache, fitting * 4, 0, 1000, 0, INDEX_PRIM_QUADS, 1) != NULL);
+	CHECK(index_cache_lookup(&cache, 1, 0, 1000, 0, INDEX_PRIM_QUADS, 1) != NULL);
+	CHECK(!index_cache_lookup(&cache, 2, 0, 1000, 0, INDEX_PRIM_QUADS, 1));
+	uint32_t held = cache.bytes / size;
+	CHECK_EQ(freed + held, fitting * 4);
+	index_cache_clear(&cache);
+	CHECK_EQ(freed, fitting * 4);
+}
+
+// Random values, values close to the type limit and few small values
+static uint32_t gen_index(int kind, int is_short) {
+	uint32_t limit = is_short ? 0xFFFF : 0xFFFFFFFF;
+	switch (kind) {
+	case 0:
+		return ((uint32_t)rand() * 2654435761u) & limit;
+	case 1:
+		return limit - (rand() & 7);
+	default:
+		return rand() & 15;
+	}
+}
+
+static void test_range(void) {
+	uint16_t src16[MAX_COUNT + 100];
+	uint32_t src32[MAX_COUNT + 100];
+	srand(2);
+	for (uint32_t count = 0; count < MAX_COUNT + 100; count++) {
+		for (int kind = 0; kind < 3; kind++) {
+			uint32_t lo16 = 0xFFFF, hi16 = 0, lo32 = 0xFFFFFFFF, hi32 = 0;
+			for (uint32_t i = 0; i < count; i++) {
+				src16[i] = gen_index(kind, 1);
+				src32[i] = gen_index(kind, 0);
+				lo16 = src16[i] < lo16 ? src16[i] : lo16;
+				hi16 = src16[i] > hi16 ? src16[i] : hi16;
+				lo32 = src32[i] < lo32 ? src32[i] : lo32;
+				hi32 = src32[i] > hi32 ? src32[i] : hi32;
+			}
+			// Empty ranges are reported as [0, 0]
+			if (!count)
+				lo16 = lo32 = 0;
+			uint32_t lo, hi;
+			index_range_u16(src16, count, &lo, &hi);
+			CHECK(lo == lo16 && hi == hi16);
+			index_range_u32(src32, count, &lo, &hi);
+			CHECK(lo == lo32 && hi == hi32);
+		}
+	}
+}
+
+static void test_range_cache(void) {
+	static index_range_cache c;
+	uint16_t buf16[64];
+	uint32_t buf32[64];
+	uint32_t lo, hi;
+	for (int i = 0; i < 64; i++)
+		buf16[i] = buf32[i] = i + 10;
+
+	// Ranges are scanned once per buffer content
+	index_range_cached(&c, 5, 0, buf16, 64, 1, &lo, &hi);
+	CHECK(lo == 10 && hi == 73);
+	CHECK_EQ(c.misses, 1);
+	buf16[3] = 1000;
+	index_range_cached(&c, 5, 0, buf16, 64, 1, &lo, &hi);
+	CHECK(lo == 10 && hi == 73);
+	CHECK_EQ(c.hits, 1);
+
+	// A new content identifier forces a rescan
+	index_range_cached(&c, 6, 0, buf16, 64, 1, &lo, &hi);
+	CHECK(lo == 10 && hi == 1000);
+
+	// Different regions and index types of the same buffer are different ranges
+	index_range_cached(&c, 6, 2, buf16 + 1, 63, 1, &lo, &hi);
+	CHECK(lo == 11 && hi == 1000);
+	index_range_cached(&c, 6, 0, buf16, 32, 1, &lo, &hi);
+	CHECK(lo == 10 && hi == 1000);
+	index_range_cached(&c, 6, 0, buf32, 64, 0, &lo, &hi);
+	CHECK(lo == 10 && hi == 73);
+
+	// Buffers without a content identifier are always scanned
+	uint32_t misses = c.misses;
+	index_range_cached(&c, 0, 0, buf16, 64, 1, &lo, &hi);
+	buf16[4] = 2000;
+	index_range_cached(&c, 0, 0, buf16, 64, 1, &lo, &hi);
+	CHECK_EQ(hi, 2000);
+	CHECK_EQ(c.misses, misses + 2);
+
+	// Updating a buffer region drops only the ranges reading it
+	index_range_cached(&c, 7, 0, buf16, 16, 1, &lo, &hi);
+	index_range_cached(&c, 7, 64, buf16 + 32, 16, 1, &lo, &hi);
+	index_range_invalidate(&c, 7, 32, 32);
+	misses = c.misses;
+	index_range_cached(&c, 7, 0, buf16, 16, 1, &lo, &hi);
+	index_range_cached(&c, 7, 64, buf16 + 32, 16, 1, &lo, &hi);
+	CHECK_EQ(c.misses, misses);
+	index_range_invalidate(&c, 7, 62, 4);
+	index_range_cached(&c, 7, 0, buf16, 16, 1, &lo, &hi);
+	index_range_cached(&c, 7, 64, buf16 + 32, 16, 1, &lo, &hi);
+	CHECK_EQ(c.misses, misses + 1);
+}
+
+int main(int argc, char **argv) {
+	test_expand();
+	test_fill();
+	test_cache();
+	test_range();
+	test_range_cache();
+	return TEST_RESULT();
+}
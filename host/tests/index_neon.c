@@ -0,0 +1,149 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * index_neon.c:
+ * Tests for the NEON paths of the index buffers expansion and indices ranges scan, built on the host against a portable emulation of the intrinsics in use
+ * and checked index by index against the portable functions in libvitaGL
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+// The NEON build is renamed so that the portable one gets linked alongside it
+#define __ARM_NEON 1
+#define index_expanded_count neon_index_expanded_count
+#define index_expand_u16 neon_index_expand_u16
+#define index_expand_u32 neon_index_expand_u32
+#define index_fill_linear_u16 neon_index_fill_linear_u16
+#define index_fill_quads_u16 neon_index_fill_quads_u16
+#define index_fill_line_strip_u16 neon_index_fill_line_strip_u16
+#define index_range_u16 neon_index_range_u16
+#define index_range_u32 neon_index_range_u32
+#define index_range_cached neon_index_range_cached
+#define index_range_invalidate neon_index_range_invalidate
+#define index_cache_init neon_index_cache_init
+#define index_cache_clear neon_index_cache_clear
+#define index_cache_invalidate neon_index_cache_invalidate
+#define index_cache_lookup neon_index_cache_lookup
+#define index_cache_insert neon_index_cache_insert
+#include "utils/index_utils.c"
+#undef index_expanded_count
+#undef index_expand_u16
+#undef index_expand_u32
+#undef index_fill_linear_u16
+#undef index_fill_quads_u16
+#undef index_fill_line_strip_u16
+#undef index_range_u16
+#undef index_range_u32
+#undef index_range_cached
+#undef index_range_invalidate
+#undef index_cache_init
+#undef index_cache_clear
+#undef index_cache_invalidate
+#undef index_cache_lookup
+#undef index_cache_insert
+
+void index_expand_u16(uint16_t *dst, const uint16_t *src, uint32_t count, int32_t base, index_prim prim);
+void index_expand_u32(uint32_t *dst, const uint32_t *src, uint32_t count, int32_t base, index_prim prim);
+void index_fill_linear_u16(uint16_t *dst, uint32_t first, uint32_t count);
+void index_fill_quads_u16(uint16_t *dst, uint32_t first, uint32_t quads);
+void index_fill_line_strip_u16(uint16_t *dst, uint32_t first, uint32_t lines);
+void index_range_u16(const uint16_t *src, uint32_t count, uint32_t *min, uint32_t *max);
+void index_range_u32(const uint32_t *src, uint32_t count, uint32_t *min, uint32_t *max);
+
+#include "test.h"
+
+#define MAX_COUNT 200 // Largest index count expanded, enough for several vector iterations plus every leftover count
+#define MAX_DST (MAX_COUNT * 2 + 8)
+
+static const int32_t bases[] = {0, 5, -3};
+
+int main(int argc, char **argv) {
+	uint16_t src16[MAX_COUNT], res16[MAX_DST], expected16[MAX_DST];
+	uint32_t src32[MAX_COUNT], res32[MAX_DST], expected32[MAX_DST];
+
+	srand(1);
+	for (int prim = INDEX_PRIM_LIST; prim <= INDEX_PRIM_LINE_LOOP; prim++) {
+		for (uint32_t count = 0; count < MAX_COUNT; count++) {
+			for (int b = 0; b < sizeof(bases) / sizeof(*bases); b++) {
+				for (uint32_t i = 0; i < count; i++) {
+					src16[i] = rand();
+					src32[i] = (uint32_t)rand() * 2654435761u;
+				}
+				memset(res16, 0xAA, sizeof(res16));
+				memset(expected16, 0xAA, sizeof(expected16));
+				memset(res32, 0xAA, sizeof(res32));
+				memset(expected32, 0xAA, sizeof(expected32));
+				neon_index_expand_u16(res16, src16, count, bases[b], prim);
+				neon_index_expand_u32(res32, src32, count, bases[b], prim);
+				index_expand_u16(expected16, src16, count, bases[b], prim);
+				index_expand_u32(expected32, src32, count, bases[b], prim);
+				CHECK(!memcmp(res16, expected16, sizeof(res16)));
+				CHECK(!memcmp(res32, expected32, sizeof(res32)));
+			}
+		}
+	}
+
+	// First indices close to the 16 bits limit wrap around the same way on both paths
+	const uint32_t firsts[] = {0, 3, 0xFFF0};
+	for (int f = 0; f < sizeof(firsts) / sizeof(*firsts); f++) {
+		for (uint32_t n = 0; n < MAX_COUNT / 2; n++) {
+			memset(res16, 0xAA, sizeof(res16));
+			memset(expected16, 0xAA, sizeof(expected16));
+			neon_index_fill_linear_u16(res16, firsts[f], n);
+			index_fill_linear_u16(expected16, firsts[f], n);
+			CHECK(!memcmp(res16, expected16, sizeof(res16)));
+
+			memset(res16, 0xAA, sizeof(res16));
+			memset(expected16, 0xAA, sizeof(expected16));
+			neon_index_fill_quads_u16(res16, firsts[f], n / 3);
+			index_fill_quads_u16(expected16, firsts[f], n / 3);
+			CHECK(!memcmp(res16, expected16, sizeof(res16)));
+
+			memset(res16, 0xAA, sizeof(res16));
+			memset(expected16, 0xAA, sizeof(expected16));
+			neon_index_fill_line_strip_u16(res16, firsts[f], n);
+			index_fill_line_strip_u16(expected16, firsts[f], n);
+			CHECK(!memcmp(res16, expected16, sizeof(res16)));
+		}
+	}
+
+	// Extremes are placed in every lane and in the scalar tail
+	for (uint32_t count = 0; count < MAX_COUNT; count++) {
+		for (uint32_t pos = 0; pos < count; pos += 3) {
+			for (uint32_t i = 0; i < count; i++) {
+				src16[i] = 1000 + (rand() & 0xFF);
+				src32[i] = 100000 + (rand() & 0xFFFF);
+			}
+			src16[pos] = 0xFFFF;
+			src16[count - 1 - pos] = 3;
+			src32[pos] = 0xFFFFFFFF;
+			src32[count - 1 - pos] = 7;
+			uint32_t lo, hi, exp_lo, exp_hi;
+			neon_index_range_u16(src16, count, &lo, &hi);
+			index_range_u16(src16, count, &exp_lo, &exp_hi);
+			CHECK(lo == exp_lo && hi == exp_hi);
+			neon_index_range_u32(src32, count, &lo, &hi);
+			index_range_u32(src32, count, &exp_lo, &exp_hi);
+			CHECK(lo == exp_lo && hi == exp_hi);
+		}
+	}
+
+	return TEST_RESULT();
+}
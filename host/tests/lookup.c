@@ -0,0 +1,146 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * lookup.c:
+ * Tests for vglGetProcAddress, the perfect hash must resolve every name exactly as the linear table walk it replaced
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <vitaGL.h>
+#include "shared.h"
+
+// lookup.c is built twice as part of this program, with and without the vgl* entries, its symbols renamed for each
+#define vglGetProcAddress lookup_default
+#define vgl_proctable proctable_default
+#define vgl_numproc numproc_default
+#define hash_proc_name hash_default
+#define proc_slot slot_default
+#include "../../source/lookup.c"
+#undef vglGetProcAddress
+#undef vgl_proctable
+#undef vgl_numproc
+#undef hash_proc_name
+#undef proc_slot
+
+// The vgl* entries include vglGetProcAddress itself
+void *lookup_exposed(const char *name);
+
+#define EXPOSE_VGL_FUNCS
+#define vglGetProcAddress lookup_exposed
+#define vgl_proctable proctable_exposed
+#define vgl_numproc numproc_exposed
+#define hash_proc_name hash_exposed
+#define proc_slot slot_exposed
+#include "../../source/lookup.c"
+#undef vglGetProcAddress
+#undef vgl_proctable
+#undef vgl_numproc
+#undef hash_proc_name
+#undef proc_slot
+
+#include "test.h"
+
+#define NAME_MAX_LEN 128
+
+// Names no entry must answer to, the last ones are common loader queries vitaGL doesn't implement
+static const char *misses[] = {
+	"gl", "EXT", "x", "glFoo", "vglFoo", "glClea", "glClearX", "glClearColorEX", "glClearColorNV", "glClearColorEXTEXT",
+	"glTexCoord2iv", "eglCreateContext", "glDrawArraysInstanced", "glDrawElementsInstanced", "glGenVertexArrays",
+	"glBindVertexArray", "glBlitFramebuffer", "glTexStorage2D", "glDebugMessageCallback", "glGenQueries", "glTexImage3D",
+};
+
+// Reference implementation, how names got resolved before being hashed
+static void *linear_lookup(const void *table, size_t num, const char *name) {
+	const struct {
+		const char *name;
+		void *proc;
+	} *entries = table;
+	if (!name || !*name)
+		return NULL;
+	const int len = strlen(name);
+	char tmpname[len + 1];
+	memcpy(tmpname, name, len + 1);
+	if (len >= 3 && (!strcmp(tmpname + len - 3, "EXT") || !strcmp(tmpname + len - 3, "ARB") || !strcmp(tmpname + len - 3, "OES")))
+		tmpname[len - 3] = 0;
+	for (size_t i = 0; i < num; i++) {
+		if (!strcmp(tmpname, entries[i].name)) {
+#ifdef HAVE_GL_CAPTURE
+			return capture_get_proc(entries[i].proc);
+#else
+			return entries[i].proc;
+#endif
+		}
+	}
+	return NULL;
+}
+
+static int checks = 0, found = 0;
+
+static void check_name(const char *name) {
+	void *exposed = linear_lookup(proctable_exposed, numproc_exposed, name);
+	void *hidden = linear_lookup(proctable_default, numproc_default, name);
+	CHECK(lookup_exposed(name) == exposed);
+	CHECK(lookup_default(name) == hidden);
+	CHECK(vglGetProcAddress(name) == hidden);
+	checks++;
+	found += exposed != NULL;
+}
+
+static void check_variants(const char *name) {
+	static const char *suffixes[] = {"", "EXT", "ARB", "OES", "EXTEXT", "NV", "x"};
+	char buf[NAME_MAX_LEN];
+	for (int i = 0; i < sizeof(suffixes) / sizeof(*suffixes); i++) {
+		snprintf(buf, sizeof(buf), "%s%s", name, suffixes[i]);
+		check_name(buf);
+	}
+
+	// Prefixes of the name, some of them are entries on their own
+	int len = strlen(name);
+	for (int i = 1; i < len; i++) {
+		memcpy(buf, name, i);
+		buf[i] = 0;
+		check_name(buf);
+	}
+}
+
+int main(int argc, char **argv) {
+	CHECK_EQ(numproc_exposed, VGL_PROCS_NUM);
+	CHECK_EQ(numproc_default, VGL_PROCS_NUM - VGL_OPTIONAL_PROCS_NUM);
+
+	// Every entry resolves to its own function
+	for (size_t i = 0; i < numproc_exposed; i++) {
+		CHECK(proctable_exposed[i].proc != NULL);
+		CHECK(lookup_exposed(proctable_exposed[i].name) != NULL);
+		if (i < numproc_default)
+			CHECK(vglGetProcAddress(proctable_exposed[i].name) != NULL);
+		check_variants(proctable_exposed[i].name);
+	}
+	for (int i = 0; i < sizeof(misses) / sizeof(*misses); i++) {
+		check_variants(misses[i]);
+	}
+	check_name(NULL);
+	check_name("");
+	CHECK(vglGetProcAddress("vglSwapBuffers") == NULL);
+	CHECK(lookup_exposed("vglSwapBuffers") != NULL);
+	CHECK((void *)eglGetProcAddress("glClearColorEXT") == vglGetProcAddress("glClearColor"));
+
+	printf("%d names checked, %d resolved\n", checks, found);
+	return TEST_RESULT();
+}
@@ -0,0 +1,361 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * arm_neon.h:
+ * Portable emulation of the NEON intrinsics used by pixel_utils.c, dxt_utils.c and index_utils.c, only meant to test their results on the host
+ */
+
+#ifndef _ARM_NEON_H_
+#define _ARM_NEON_H_
+
+#include <stdint.h>
+#include <string.h>
+
+typedef struct {
+	uint8_t v[16];
+} uint8x16_t;
+typedef struct {
+	uint8_t v[8];
+} uint8x8_t;
+typedef struct {
+	uint16_t v[8];
+} uint16x8_t;
+typedef struct {
+	uint16_t v[4];
+} uint16x4_t;
+typedef struct {
+	uint32_t v[4];
+} uint32x4_t;
+typedef struct {
+	uint32_t v[2];
+} uint32x2_t;
+typedef struct {
+	int32_t v[4];
+} int32x4_t;
+typedef struct {
+	int32_t v[2];
+} int32x2_t;
+
+// Arrays of N vectors of the given lanes
+#define NEON_ARRAY_TYPES(bits, lanes) \
+	typedef struct { \
+		uint##bits##x##lanes##_t val[2]; \
+	} uint##bits##x##lanes##x2_t; \
+	typedef struct { \
+		uint##bits##x##lanes##_t val[3]; \
+	} uint##bits##x##lanes##x3_t; \
+	typedef struct { \
+		uint##bits##x##lanes##_t val[4]; \
+	} uint##bits##x##lanes##x4_t;
+NEON_ARRAY_TYPES(8, 16)
+NEON_ARRAY_TYPES(16, 8)
+NEON_ARRAY_TYPES(32, 4)
+
+// Interleaved loads and stores of N channels
+#define NEON_LDST(N, bits, lanes) \
+	static inline uint##bits##x##lanes##x##N##_t vld##N##q_u##bits(const uint##bits##_t *p) { \
+		uint##bits##x##lanes##x##N##_t r; \
+		for (int i = 0; i < lanes; i++) \
+			for (int c = 0; c < N; c++) \
+				r.val[c].v[i] = p[i * N + c]; \
+		return r; \
+	} \
+	static inline void vst##N##q_u##bits(uint##bits##_t *p, uint##bits##x##lanes##x##N##_t r) { \
+		for (int i = 0; i < lanes; i++) \
+			for (int c = 0; c < N; c++) \
+				p[i * N + c] = r.val[c].v[i]; \
+	}
+NEON_LDST(2, 8, 16)
+NEON_LDST(3, 8, 16)
+NEON_LDST(4, 8, 16)
+NEON_LDST(2, 16, 8)
+NEON_LDST(3, 16, 8)
+NEON_LDST(4, 16, 8)
+NEON_LDST(2, 32, 4)
+NEON_LDST(3, 32, 4)
+NEON_LDST(4, 32, 4)
+
+static inline uint8x16_t vld1q_u8(const uint8_t *p) {
+	uint8x16_t r;
+	memcpy(r.v, p, 16);
+	return r;
+}
+
+static inline void vst1q_u8(uint8_t *p, uint8x16_t r) {
+	memcpy(p, r.v, 16);
+}
+
+static inline uint8x16_t vdupq_n_u8(uint8_t x) {
+	uint8x16_t r;
+	memset(r.v, x, 16);
+	return r;
+}
+
+static inline uint16x8_t vld1q_u16(const uint16_t *p) {
+	uint16x8_t r;
+	memcpy(r.v, p, 16);
+	return r;
+}
+
+static inline uint16x8_t vdupq_n_u16(uint16_t x) {
+	uint16x8_t r;
+	for (int i = 0; i < 8; i++)
+		r.v[i] = x;
+	return r;
+}
+
+static inline uint16x8_t vandq_u16(uint16x8_t a, uint16x8_t b) {
+	for (int i = 0; i < 8; i++)
+		a.v[i] &= b.v[i];
+	return a;
+}
+
+static inline void vst1q_u16(uint16_t *p, uint16x8_t r) {
+	memcpy(p, r.v, 16);
+}
+
+static inline uint16x8_t vaddq_u16(uint16x8_t a, uint16x8_t b) {
+	for (int i = 0; i < 8; i++)
+		a.v[i] += b.v[i];
+	return a;
+}
+
+static inline uint32x4_t vld1q_u32(const uint32_t *p) {
+	uint32x4_t r;
+	memcpy(r.v, p, 16);
+	return r;
+}
+
+static inline void vst1q_u32(uint32_t *p, uint32x4_t r) {
+	memcpy(p, r.v, 16);
+}
+
+static inline uint32x4_t vdupq_n_u32(uint32_t x) {
+	uint32x4_t r;
+	for (int i = 0; i < 4; i++)
+		r.v[i] = x;
+	return r;
+}
+
+static inline uint32x4_t vaddq_u32(uint32x4_t a, uint32x4_t b) {
+	for (int i = 0; i < 4; i++)
+		a.v[i] += b.v[i];
+	return a;
+}
+
+// Interleaves the lanes of both vectors, low halves first
+static inline uint16x8x2_t vzipq_u16(uint16x8_t a, uint16x8_t b) {
+	uint16x8x2_t r;
+	for (int i = 0; i < 8; i++) {
+		r.val[i / 4].v[(i % 4) * 2] = a.v[i];
+		r.val[i / 4].v[(i % 4) * 2 + 1] = b.v[i];
+	}
+	return r;
+}
+
+static inline uint32x4x2_t vzipq_u32(uint32x4_t a, uint32x4_t b) {
+	uint32x4x2_t r;
+	for (int i = 0; i < 4; i++) {
+		r.val[i / 2].v[(i % 2) * 2] = a.v[i];
+		r.val[i / 2].v[(i % 2) * 2 + 1] = b.v[i];
+	}
+	return r;
+}
+
+#define vshlq_n_u16(a, n) ({ uint16x8_t _r = (a); for (int _i = 0; _i < 8; _i++) _r.v[_i] <<= (n); _r; })
+#define vshrq_n_u16(a, n) ({ uint16x8_t _r = (a); for (int _i = 0; _i < 8; _i++) _r.v[_i] >>= (n); _r; })
+#define vshrq_n_u32(a, n) ({ uint32x4_t _r = (a); for (int _i = 0; _i < 4; _i++) _r.v[_i] >>= (n); _r; })
+
+static inline uint16x8_t vmulq_n_u16(uint16x8_t a, uint16_t b) {
+	for (int i = 0; i < 8; i++)
+		a.v[i] = (uint16_t)(a.v[i] * b);
+	return a;
+}
+
+static inline uint16x4_t vget_low_u16(uint16x8_t a) {
+	uint16x4_t r;
+	memcpy(r.v, a.v, 8);
+	return r;
+}
+
+static inline uint16x4_t vget_high_u16(uint16x8_t a) {
+	uint16x4_t r;
+	memcpy(r.v, a.v + 4, 8);
+	return r;
+}
+
+static inline uint32x4_t vmull_n_u16(uint16x4_t a, uint16_t b) {
+	uint32x4_t r;
+	for (int i = 0; i < 4; i++)
+		r.v[i] = (uint32_t)a.v[i] * b;
+	return r;
+}
+
+static inline uint16x4_t vmovn_u32(uint32x4_t a) {
+	uint16x4_t r;
+	for (int i = 0; i < 4; i++)
+		r.v[i] = (uint16_t)a.v[i];
+	return r;
+}
+
+static inline uint16x8_t vcombine_u16(uint16x4_t a, uint16x4_t b) {
+	uint16x8_t r;
+	memcpy(r.v, a.v, 8);
+	memcpy(r.v + 4, b.v, 8);
+	return r;
+}
+
+static inline uint8x8_t vmovn_u16(uint16x8_t a) {
+	uint8x8_t r;
+	for (int i = 0; i < 8; i++)
+		r.v[i] = (uint8_t)a.v[i];
+	return r;
+}
+
+static inline uint8x16_t vcombine_u8(uint8x8_t a, uint8x8_t b) {
+	uint8x16_t r;
+	memcpy(r.v, a.v, 8);
+	memcpy(r.v + 8, b.v, 8);
+	return r;
+}
+
+// Lane-wise minimum and maximum
+#define NEON_MINMAX(sfx, vtype, lanes) \
+	static inline vtype vmin##sfx(vtype a, vtype b) { \
+		for (int i = 0; i < lanes; i++) \
+			a.v[i] = b.v[i] < a.v[i] ? b.v[i] : a.v[i]; \
+		return a; \
+	} \
+	static inline vtype vmax##sfx(vtype a, vtype b) { \
+		for (int i = 0; i < lanes; i++) \
+			a.v[i] = b.v[i] > a.v[i] ? b.v[i] : a.v[i]; \
+		return a; \
+	}
+NEON_MINMAX(q_u16, uint16x8_t, 8)
+NEON_MINMAX(_u16, uint16x4_t, 4)
+NEON_MINMAX(q_u32, uint32x4_t, 4)
+NEON_MINMAX(_u32, uint32x2_t, 2)
+
+// Pairwise minimum and maximum on the concatenation of both vectors
+#define NEON_PMINMAX(sfx, vtype, lanes) \
+	static inline vtype vpmin##sfx(vtype a, vtype b) { \
+		vtype r; \
+		for (int i = 0; i < lanes / 2; i++) { \
+			r.v[i] = a.v[i * 2] < a.v[i * 2 + 1] ? a.v[i * 2] : a.v[i * 2 + 1]; \
+			r.v[i + lanes / 2] = b.v[i * 2] < b.v[i * 2 + 1] ? b.v[i * 2] : b.v[i * 2 + 1]; \
+		} \
+		return r; \
+	} \
+	static inline vtype vpmax##sfx(vtype a, vtype b) { \
+		vtype r; \
+		for (int i = 0; i < lanes / 2; i++) { \
+			r.v[i] = a.v[i * 2] > a.v[i * 2 + 1] ? a.v[i * 2] : a.v[i * 2 + 1]; \
+			r.v[i + lanes / 2] = b.v[i * 2] > b.v[i * 2 + 1] ? b.v[i * 2] : b.v[i * 2 + 1]; \
+		} \
+		return r; \
+	}
+NEON_PMINMAX(_u16, uint16x4_t, 4)
+NEON_PMINMAX(_u32, uint32x2_t, 2)
+
+static inline uint32x2_t vget_low_u32(uint32x4_t a) {
+	uint32x2_t r;
+	memcpy(r.v, a.v, 8);
+	return r;
+}
+
+static inline uint32x2_t vget_high_u32(uint32x4_t a) {
+	uint32x2_t r;
+	memcpy(r.v, a.v + 2, 8);
+	return r;
+}
+
+#define vget_lane_u16(a, n) ((a).v[n])
+#define vget_lane_u32(a, n) ((a).v[n])
+
+static inline int32x4_t vld1q_s32(const int32_t *p) {
+	int32x4_t r;
+	memcpy(r.v, p, 16);
+	return r;
+}
+
+static inline void vst1q_s32(int32_t *p, int32x4_t r) {
+	memcpy(p, r.v, 16);
+}
+
+static inline int32x4_t vmulq_n_s32(int32x4_t a, int32_t b) {
+	for (int i = 0; i < 4; i++)
+		a.v[i] *= b;
+	return a;
+}
+
+static inline int32x4_t vmlaq_n_s32(int32x4_t a, int32x4_t b, int32_t c) {
+	for (int i = 0; i < 4; i++)
+		a.v[i] += b.v[i] * c;
+	return a;
+}
+
+static inline int32x4_t vaddq_s32(int32x4_t a, int32x4_t b) {
+	for (int i = 0; i < 4; i++)
+		a.v[i] += b.v[i];
+	return a;
+}
+
+static inline int32x4_t vminq_s32(int32x4_t a, int32x4_t b) {
+	for (int i = 0; i < 4; i++)
+		a.v[i] = b.v[i] < a.v[i] ? b.v[i] : a.v[i];
+	return a;
+}
+
+static inline int32x4_t vmaxq_s32(int32x4_t a, int32x4_t b) {
+	for (int i = 0; i < 4; i++)
+		a.v[i] = b.v[i] > a.v[i] ? b.v[i] : a.v[i];
+	return a;
+}
+
+static inline int32x2_t vget_low_s32(int32x4_t a) {
+	int32x2_t r;
+	memcpy(r.v, a.v, 8);
+	return r;
+}
+
+static inline int32x2_t vget_high_s32(int32x4_t a) {
+	int32x2_t r;
+	memcpy(r.v, a.v + 2, 8);
+	return r;
+}
+
+// Pairwise operations on the concatenation of both vectors
+static inline int32x2_t vpadd_s32(int32x2_t a, int32x2_t b) {
+	int32x2_t r = {{a.v[0] + a.v[1], b.v[0] + b.v[1]}};
+	return r;
+}
+
+static inline int32x2_t vpmin_s32(int32x2_t a, int32x2_t b) {
+	int32x2_t r = {{a.v[0] < a.v[1] ? a.v[0] : a.v[1], b.v[0] < b.v[1] ? b.v[0] : b.v[1]}};
+	return r;
+}
+
+static inline int32x2_t vpmax_s32(int32x2_t a, int32x2_t b) {
+	int32x2_t r = {{a.v[0] > a.v[1] ? a.v[0] : a.v[1], b.v[0] > b.v[1] ? b.v[0] : b.v[1]}};
+	return r;
+}
+
+#define vget_lane_s32(a, n) ((a).v[n])
+
+#endif
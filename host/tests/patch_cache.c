@@ -0,0 +1,295 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * patch_cache.c:
+ * Tests for the patched programs cache (lookups and entries dropped by tag or by key word) and for the keys
+ * patch_vertex_program_cached and patch_fragment_program_cached derive from the draw state, counted through the mock patcher
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <vitaGL.h>
+#include <vgl_mock.h>
+#include "shared.h"
+
+#include "test.h"
+
+#define PROGS_NUM 4 // Registered programs
+#define LINKS_NUM 4 // Vertex programs a fragment one can be linked to
+#define KEY_LINK 1 // Index of the linked vertex program in keys
+
+static int progs[PROGS_NUM][LINKS_NUM];
+static int released[PROGS_NUM][LINKS_NUM];
+
+static void release_prog(void *prog) {
+	int idx = (int *)prog - &progs[0][0];
+	released[idx / LINKS_NUM][idx % LINKS_NUM]++;
+}
+
+static void *find(patch_cache *c, int prog, int link) {
+	uint32_t key[2] = {0x1234, link};
+	return patch_cache_find(c, prog, key, 2, patch_cache_hash(prog, key, 2));
+}
+
+static void insert(patch_cache *c, int prog, int link) {
+	uint32_t key[2] = {0x1234, link};
+	CHECK(patch_cache_insert(c, prog, key, 2, patch_cache_hash(prog, key, 2), &progs[prog][link]));
+}
+
+static void test_container(void) {
+	patch_cache c = {0};
+
+	for (int i = 0; i < PROGS_NUM; i++) {
+		for (int j = 0; j < LINKS_NUM; j++) {
+			insert(&c, i, j);
+		}
+	}
+	for (int i = 0; i < PROGS_NUM; i++) {
+		for (int j = 0; j < LINKS_NUM; j++) {
+			CHECK(find(&c, i, j) == &progs[i][j]);
+		}
+	}
+
+	// Releasing a linked program drops every entry linked to it, whatever program they derive from
+	CHECK(find(&c, 2, 1) == &progs[2][1]);
+	patch_cache_drop_key(&c, KEY_LINK, 1, release_prog);
+	for (int i = 0; i < PROGS_NUM; i++) {
+		CHECK(find(&c, i, 1) == NULL);
+		CHECK_EQ(released[i][1], 1);
+		CHECK(find(&c, i, 0) == &progs[i][0]);
+		CHECK_EQ(released[i][0], 0);
+	}
+
+	// Key words past the end of a key never match
+	patch_cache_drop_key(&c, 2, 0x1234, release_prog);
+	CHECK(find(&c, 0, 0) == &progs[0][0]);
+
+	// Dropping by tag leaves the release to the caller when no callback is given
+	patch_cache_drop_tag(&c, 3, NULL);
+	for (int j = 0; j < LINKS_NUM; j++) {
+		CHECK(find(&c, 3, j) == NULL);
+		CHECK_EQ(released[3][j], j == 1);
+	}
+
+	// Entries left are released exactly once
+	patch_cache_clear(&c, release_prog);
+	for (int i = 0; i < PROGS_NUM; i++) {
+		for (int j = 0; j < LINKS_NUM; j++) {
+			CHECK_EQ(released[i][j], i == 3 ? j == 1 : 1);
+		}
+	}
+}
+
+
+static const char *vertex_src[] = {
+	"void main(float3 position, float2 texcoord, float4 out gl_Position : POSITION, float2 out vTexcoord : TEXCOORD0) {\n"
+	"	gl_Position = float4(position, 1.0);\n"
+	"	vTexcoord = texcoord;\n"
+	"}",
+	"void main(float3 position, float2 texcoord, float4 out gl_Position : POSITION, float2 out vTexcoord : TEXCOORD0) {\n"
+	"	gl_Position = float4(position * 2.0, 1.0);\n"
+	"	vTexcoord = texcoord;\n"
+	"}"};
+static const char *fragment_src = "float4 main(float2 vTexcoord : TEXCOORD0) : COLOR {\n"
+	"	return float4(vTexcoord, 0.0, 1.0);\n"
+	"}";
+
+static uint64_t patcher_calls(vglMockPatcherCall call) {
+	vglMockStats stats;
+	vglMockGetStats(&stats);
+	return stats.patcher_calls[call];
+}
+
+static SceGxmProgram *register_program(const char *src, shark_type type, SceGxmShaderPatcherId *id) {
+	// Compiled programs belong to the compiler until the next compilation, so they're copied as vitaGL does
+	uint32_t size = 0;
+	SceGxmProgram *compiled = shark_compile_shader(src, &size, type);
+	CHECK(compiled != NULL);
+	SceGxmProgram *prog = malloc(size);
+	memcpy(prog, compiled, size);
+	shark_clear_output();
+	CHECK_EQ(sceGxmShaderPatcherRegisterProgram(gxm_shader_patcher, prog, id), 0);
+	return prog;
+}
+
+static SceGxmVertexProgram *patch_vertex(patch_cache *c, SceGxmShaderPatcherId id, uint32_t attrs_num, uint16_t stride, SceGxmAttributeFormat fmt) {
+	SceGxmVertexAttribute attrs[2] = {
+		{.streamIndex = 0, .offset = 0, .format = SCE_GXM_ATTRIBUTE_FORMAT_F32, .componentCount = 3, .regIndex = 0},
+		{.streamIndex = 0, .offset = 12, .format = fmt, .componentCount = 2, .regIndex = 4}};
+	SceGxmVertexStream stream = {.stride = stride, .indexSource = SCE_GXM_INDEX_SOURCE_INDEX_16BIT};
+	SceGxmVertexProgram *res = NULL;
+	patch_vertex_program_cached(c, id, attrs, attrs_num, &stream, 1, &res);
+	CHECK(res != NULL);
+	return res;
+}
+
+static SceGxmFragmentProgram *patch_fragment(patch_cache *c, SceGxmShaderPatcherId id, SceGxmOutputRegisterFormat fmt, const SceGxmProgram *link) {
+	SceGxmFragmentProgram *res = NULL;
+	patch_fragment_program_cached(c, id, fmt, link, &res);
+	CHECK(res != NULL);
+	return res;
+}
+
+static void test_keys(void) {
+	patch_cache vert_patches = {0}, frag_patches = {0};
+	SceGxmShaderPatcherId vert_ids[2], frag_id;
+	vglMockStats before, after;
+
+	vglInit(0x800000);
+	vglMockGetStats(&before);
+	SceGxmProgram *vert_progs[2];
+	for (int i = 0; i < 2; i++)
+		vert_progs[i] = register_program(vertex_src[i], SHARK_VERTEX_SHADER, &vert_ids[i]);
+	SceGxmProgram *frag_prog = register_program(fragment_src, SHARK_FRAGMENT_SHADER, &frag_id);
+
+	// Repeated draws with the same layout patch once, any change to the layout or program needs a new patch
+	uint64_t creates = patcher_calls(VGL_MOCK_PATCHER_CREATE_VERTEX);
+	SceGxmVertexProgram *v = patch_vertex(&vert_patches, vert_ids[0], 2, 20, SCE_GXM_ATTRIBUTE_FORMAT_F32);
+	for (int i = 0; i < 3; i++)
+		CHECK(patch_vertex(&vert_patches, vert_ids[0], 2, 20, SCE_GXM_ATTRIBUTE_FORMAT_F32) == v);
+	CHECK_EQ(patcher_calls(VGL_MOCK_PATCHER_CREATE_VERTEX), creates + 1);
+	CHECK(patch_vertex(&vert_patches, vert_ids[0], 2, 24, SCE_GXM_ATTRIBUTE_FORMAT_F32) != v);
+	CHECK(patch_vertex(&vert_patches, vert_ids[0], 2, 20, SCE_GXM_ATTRIBUTE_FORMAT_F16) != v);
+	CHECK(patch_vertex(&vert_patches, vert_ids[0], 1, 20, SCE_GXM_ATTRIBUTE_FORMAT_F32) != v);
+	CHECK(patch_vertex(&vert_patches, vert_ids[1], 2, 20, SCE_GXM_ATTRIBUTE_FORMAT_F32) != v);
+	CHECK(patch_vertex(&vert_patches, vert_ids[0], 2, 20, SCE_GXM_ATTRIBUTE_FORMAT_F32) == v);
+	CHECK_EQ(patcher_calls(VGL_MOCK_PATCHER_CREATE_VERTEX), creates + 5);
+
+	// Same for output format, blending, multisampling and linked vertex program of fragment programs
+	blend_config saved_blend = blend_info;
+	SceGxmMultisampleMode saved_msaa = msaa_mode;
+	creates = patcher_calls(VGL_MOCK_PATCHER_CREATE_FRAGMENT);
+	SceGxmFragmentProgram *f = patch_fragment(&frag_patches, frag_id, SCE_GXM_OUTPUT_REGISTER_FORMAT_UCHAR4, vert_progs[0]);
+	for (int i = 0; i < 3; i++)
+		CHECK(patch_fragment(&frag_patches, frag_id, SCE_GXM_OUTPUT_REGISTER_FORMAT_UCHAR4, vert_progs[0]) == f);
+	CHECK_EQ(patcher_calls(VGL_MOCK_PATCHER_CREATE_FRAGMENT), creates + 1);
+	CHECK(patch_fragment(&frag_patches, frag_id, SCE_GXM_OUTPUT_REGISTER_FORMAT_HALF4, vert_progs[0]) != f);
+	patch_fragment(&frag_patches, frag_id, SCE_GXM_OUTPUT_REGISTER_FORMAT_UCHAR4, vert_progs[1]);
+	blend_info.info.colorFunc = SCE_GXM_BLEND_FUNC_ADD;
+	blend_info.info.colorSrc = SCE_GXM_BLEND_FACTOR_SRC_ALPHA;
+	blend_info.info.colorDst = SCE_GXM_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	CHECK(blend_info.raw != saved_blend.raw);
+	CHECK(patch_fragment(&frag_patches, frag_id, SCE_GXM_OUTPUT_REGISTER_FORMAT_UCHAR4, vert_progs[0]) != f);
+	blend_info = saved_blend;
+	msaa_mode = saved_msaa == SCE_GXM_MULTISAMPLE_4X ? SCE_GXM_MULTISAMPLE_NONE : SCE_GXM_MULTISAMPLE_4X;
+	CHECK(patch_fragment(&frag_patches, frag_id, SCE_GXM_OUTPUT_REGISTER_FORMAT_UCHAR4, vert_progs[0]) != f);
+	msaa_mode = saved_msaa;
+	CHECK(patch_fragment(&frag_patches, frag_id, SCE_GXM_OUTPUT_REGISTER_FORMAT_UCHAR4, vert_progs[0]) == f);
+	CHECK_EQ(patcher_calls(VGL_MOCK_PATCHER_CREATE_FRAGMENT), creates + 5);
+
+	// Dropping a vertex program releases only the fragment programs linked to it
+	uint64_t releases = patcher_calls(VGL_MOCK_PATCHER_RELEASE_FRAGMENT);
+	release_linked_fragment_programs(&frag_patches, vert_progs[1]);
+	CHECK_EQ(patcher_calls(VGL_MOCK_PATCHER_RELEASE_FRAGMENT), releases + 1);
+	CHECK(patch_fragment(&frag_patches, frag_id, SCE_GXM_OUTPUT_REGISTER_FORMAT_UCHAR4, vert_progs[0]) == f);
+	CHECK_EQ(patcher_calls(VGL_MOCK_PATCHER_CREATE_FRAGMENT), creates + 5);
+
+	// Every patched program is released exactly once, so the programs can be unregistered without forcing it
+	release_patched_programs(&vert_patches, &frag_patches);
+	vglMockGetStats(&after);
+	for (int i = 0; i < 2; i++)
+		CHECK_EQ(after.patcher_calls[VGL_MOCK_PATCHER_CREATE_VERTEX + i] - before.patcher_calls[VGL_MOCK_PATCHER_CREATE_VERTEX + i],
+			after.patcher_calls[VGL_MOCK_PATCHER_RELEASE_VERTEX + i] - before.patcher_calls[VGL_MOCK_PATCHER_RELEASE_VERTEX + i]);
+	CHECK_EQ(after.live_vertex_programs, before.live_vertex_programs);
+	CHECK_EQ(after.live_fragment_programs, before.live_fragment_programs);
+	for (int i = 0; i < 2; i++)
+		CHECK_EQ(sceGxmShaderPatcherUnregisterProgram(gxm_shader_patcher, vert_ids[i]), 0);
+	CHECK_EQ(sceGxmShaderPatcherUnregisterProgram(gxm_shader_patcher, frag_id), 0);
+	vglMockGetStats(&after);
+	CHECK_EQ(after.errors, before.errors);
+	for (int i = 0; i < 2; i++)
+		free(vert_progs[i]);
+	free(frag_prog);
+	vglEnd();
+}
+
+static GLuint compile_shader(GLenum type, const char *src) {
+	GLuint s = glCreateShader(type);
+	glShaderSource(s, 1, &src, NULL);
+	glCompileShader(s);
+	return s;
+}
+
+static void draw(void) {
+	for (int i = 0; i < 3; i++)
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+static void test_program(void) {
+	static float vertices[3 * 6] = {0};
+	vglMockStats before, after;
+
+	vglInit(0x800000);
+	GLuint vs = compile_shader(GL_VERTEX_SHADER, vertex_src[0]);
+	GLuint fs = compile_shader(GL_FRAGMENT_SHADER, fragment_src);
+	GLuint prog = glCreateProgram();
+	glAttachShader(prog, vs);
+	glAttachShader(prog, fs);
+	glBindAttribLocation(prog, 0, "position");
+	glBindAttribLocation(prog, 1, "texcoord");
+	glLinkProgram(prog);
+	glUseProgram(prog);
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	vglMockGetStats(&before);
+
+	// Draws through a GL program patch once per layout and blending
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 20, vertices);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 20, vertices + 3);
+	draw();
+	CHECK_EQ(patcher_calls(VGL_MOCK_PATCHER_CREATE_VERTEX), before.patcher_calls[VGL_MOCK_PATCHER_CREATE_VERTEX] + 1);
+	CHECK_EQ(patcher_calls(VGL_MOCK_PATCHER_CREATE_FRAGMENT), before.patcher_calls[VGL_MOCK_PATCHER_CREATE_FRAGMENT] + 1);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 24, vertices);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 24, vertices + 3);
+	draw();
+	CHECK_EQ(patcher_calls(VGL_MOCK_PATCHER_CREATE_VERTEX), before.patcher_calls[VGL_MOCK_PATCHER_CREATE_VERTEX] + 2);
+	glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, 24, vertices + 3);
+	draw();
+	CHECK_EQ(patcher_calls(VGL_MOCK_PATCHER_CREATE_VERTEX), before.patcher_calls[VGL_MOCK_PATCHER_CREATE_VERTEX] + 3);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	draw();
+	CHECK_EQ(patcher_calls(VGL_MOCK_PATCHER_CREATE_FRAGMENT), before.patcher_calls[VGL_MOCK_PATCHER_CREATE_FRAGMENT] + 2);
+	glDisable(GL_BLEND);
+	draw();
+	CHECK_EQ(patcher_calls(VGL_MOCK_PATCHER_CREATE_VERTEX), before.patcher_calls[VGL_MOCK_PATCHER_CREATE_VERTEX] + 3);
+	CHECK_EQ(patcher_calls(VGL_MOCK_PATCHER_CREATE_FRAGMENT), before.patcher_calls[VGL_MOCK_PATCHER_CREATE_FRAGMENT] + 2);
+	vglSwapBuffers(GL_FALSE);
+
+	// Deleting the program releases every program patched for it
+	glUseProgram(0);
+	glDeleteProgram(prog);
+	vglMockGetStats(&after);
+	for (int i = 0; i < 2; i++)
+		CHECK_EQ(after.patcher_calls[VGL_MOCK_PATCHER_RELEASE_VERTEX + i] - before.patcher_calls[VGL_MOCK_PATCHER_RELEASE_VERTEX + i],
+			after.patcher_calls[VGL_MOCK_PATCHER_CREATE_VERTEX + i] - before.patcher_calls[VGL_MOCK_PATCHER_CREATE_VERTEX + i]);
+	CHECK_EQ(after.live_vertex_programs, before.live_vertex_programs);
+	CHECK_EQ(after.live_fragment_programs, before.live_fragment_programs);
+	CHECK_EQ(after.errors, before.errors);
+	glDeleteShader(vs);
+	glDeleteShader(fs);
+	vglEnd();
+}
+
+int main(int argc, char **argv) {
+	test_container();
+	test_keys();
+	test_program();
+	return TEST_RESULT();
+}
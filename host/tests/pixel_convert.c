@@ -0,0 +1,116 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * pixel_convert.c:
+ * Tests for the row pixel converters, every pair must be bit-exact against the per pixel texture callbacks
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "utils/pixel_utils.h"
+#include "texture_callbacks.h"
+
+#include "test.h"
+
+#define PIXELS_NUM (65536 + 13) // Enough for every 16 bit pattern, with a tail the vector paths can't cover
+#define TAIL_MAX 40 // Row lengths checked one by one
+#define GUARD 0xCD // Filler bytes around destinations to catch out of bounds writes
+
+typedef struct {
+	uint32_t (*read)(void *);
+	uint8_t bpp;
+} read_fmt;
+
+typedef struct {
+	void (*write)(void *, uint32_t);
+	uint8_t bpp;
+} write_fmt;
+
+static const read_fmt reads[] = {
+	{readRGBA, 4}, {readBGRA, 4}, {readABGR, 4}, {readRGB, 3}, {readBGR, 3}, {readRG, 2},
+	{readR, 1}, {readL, 1}, {readLA, 2}, {readRGB565, 2}, {readRGBA5551, 2}, {readRGBA4444, 2}
+};
+
+static const write_fmt writes[] = {
+	{writeRGBA, 4}, {writeBGRA, 4}, {writeABGR, 4}, {writeRGB, 3}, {writeBGR, 3}, {writeRG, 2}, {writeR, 1}, {writeRA, 2}
+};
+
+static void convert_pixels(const read_fmt *r, const write_fmt *w, uint8_t *dst, uint8_t *src, uint32_t num) {
+	for (uint32_t i = 0; i < num; i++) {
+		w->write(dst, r->read(src));
+		src += r->bpp;
+		dst += w->bpp;
+	}
+}
+
+int main(int argc, char **argv) {
+	size_t size = PIXELS_NUM * 4 + 64;
+	uint8_t *src = malloc(size), *expected = malloc(size), *res = malloc(size);
+
+	// Random bytes followed by every 16 bit pattern
+	srand(7);
+	for (size_t i = 0; i < size; i++) {
+		src[i] = rand();
+	}
+	for (int i = 0; i < 65536; i++) {
+		src[i * 2] = i;
+		src[i * 2 + 1] = i >> 8;
+	}
+
+	int pairs = 0;
+	for (int i = 0; i < sizeof(reads) / sizeof(*reads); i++) {
+		for (int j = 0; j < sizeof(writes) / sizeof(*writes); j++) {
+			const read_fmt *r = &reads[i];
+			const write_fmt *w = &writes[j];
+			pixel_row_cb convert_row = getRowConverter(r->read, w->write);
+			CHECK(convert_row != NULL);
+			if (!convert_row)
+				continue;
+			pairs++;
+
+			// Every short row length from misaligned pointers, nothing past the row must be touched
+			for (uint32_t len = 0; len < TAIL_MAX; len++) {
+				memset(expected, GUARD, TAIL_MAX * 4 + 8);
+				memset(res, GUARD, TAIL_MAX * 4 + 8);
+				convert_pixels(r, w, expected + 1, src + 3, len);
+				convert_row(res + 1, src + 3, len);
+				if (memcmp(expected, res, TAIL_MAX * 4 + 8)) {
+					fprintf(stderr, "read %d -> write %d mismatches on %u pixels\n", i, j, len);
+					test_failures++;
+					break;
+				}
+			}
+
+			memset(expected, 0, size);
+			memset(res, 0, size);
+			convert_pixels(r, w, expected, src, PIXELS_NUM);
+			convert_row(res, src, PIXELS_NUM);
+			if (memcmp(expected, res, size)) {
+				fprintf(stderr, "read %d -> write %d mismatches on a long row\n", i, j);
+				test_failures++;
+			}
+		}
+	}
+	CHECK_EQ(pairs, 96);
+
+	free(src);
+	free(expected);
+	free(res);
+	return TEST_RESULT();
+}
@@ -0,0 +1,318 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * profiler.c:
+ * Tests for the profiling zones, aggregates and traces must stay consistent while several threads record concurrently
+ * NOTE: Built without PROFILER=1 only the API stubs are checked
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <psp2/kernel/threadmgr.h>
+#include <vitaGL.h>
+#include "utils/profiler_utils.h"
+
+#include "test.h"
+
+#define TRACE_PATH "profiler_test.json"
+
+#ifdef HAVE_PROFILER
+#define THREADS_NUM 4 // Threads recording concurrently
+#define ZONES_PER_THREAD 1000 // Zones recorded by every thread
+#define WRAP_ZONES (PROFILER_EVENTS_NUM * 3) // Zones recorded while traces are dumped, enough to wrap the ring several times
+
+static const char *zone_names[] = {
+#define PROFILER_ZONE(id, name) name,
+	PROFILER_ZONES
+#undef PROFILER_ZONE
+};
+
+// Trace events parsed back from a dump
+typedef struct {
+	char name[64];
+	int tid;
+	uint64_t ts;
+	uint32_t dur;
+} trace_event;
+
+typedef struct {
+	trace_event *events;
+	int events_num;
+	int threads_num; // Tracks other than the frames one, every thread that ever recorded gets one
+	int bad_lines; // Lines that are neither events nor thread names
+} trace;
+
+static void trace_load(trace *t, const char *path) {
+	memset(t, 0, sizeof(*t));
+	FILE *f = fopen(path, "r");
+	if (!f) {
+		t->bad_lines++;
+		return;
+	}
+	char line[256];
+	int cap = 0;
+	while (fgets(line, sizeof(line), f)) {
+		trace_event e;
+		unsigned long long ts;
+		int tid;
+		if (sscanf(line, "{\"name\":\"%63[^\"]\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%llu,\"dur\":%u}", e.name, &e.tid, &ts, &e.dur) == 4) {
+			e.ts = ts;
+			if (t->events_num == cap) {
+				cap = cap ? cap * 2 : 256;
+				t->events = realloc(t->events, cap * sizeof(trace_event));
+			}
+			t->events[t->events_num++] = e;
+		} else if (sscanf(line, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d", &tid) == 1) {
+			if (tid)
+				t->threads_num++;
+		} else if (strcmp(line, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n") && strcmp(line, "]}\n"))
+			t->bad_lines++;
+	}
+	fclose(f);
+}
+
+static int trace_count(const trace *t, const char *name, int tid) {
+	int res = 0;
+	for (int i = 0; i < t->events_num; i++) {
+		if (!strcmp(t->events[i].name, name) && t->events[i].tid == tid)
+			res++;
+	}
+	return res;
+}
+
+static int is_zone_name(const char *name) {
+	for (int i = 0; i < PROFILER_ZONES_NUM; i++) {
+		if (!strcmp(zone_names[i], name))
+			return 1;
+	}
+	return 0;
+}
+
+static vglProfilerZoneStats zone_stats(uint32_t zone) {
+	vglProfilerZoneStats s[PROFILER_ZONES_NUM];
+	CHECK_EQ(vglGetProfilerZoneStats(s, PROFILER_ZONES_NUM), PROFILER_ZONES_NUM);
+	return s[zone];
+}
+
+static void sleep_zone(uint32_t outer_us, uint32_t inner_us) {
+	PROFILE_ZONE(CALL_LIST);
+	usleep(outer_us);
+	{
+		PROFILE_ZONE(MALLOC);
+		usleep(inner_us);
+	}
+}
+
+static void empty_zone(void) {
+	PROFILE_ZONE(CALL_LIST);
+	{
+		PROFILE_ZONE(MALLOC);
+	}
+}
+
+// Threads are kept alive until every one is done so that they all get distinct ids
+static pthread_barrier_t barrier;
+static volatile int recording = 0;
+
+static void *record_thread(void *arg) {
+	int zones = (int)(uintptr_t)arg;
+	pthread_barrier_wait(&barrier);
+	for (int i = 0; i < zones; i++) {
+		empty_zone();
+	}
+	pthread_barrier_wait(&barrier);
+	return NULL;
+}
+
+static void run_threads(int threads_num, int zones) {
+	pthread_t threads[PROFILER_MAX_THREADS * 2];
+	pthread_barrier_init(&barrier, NULL, threads_num);
+	for (int i = 0; i < threads_num; i++) {
+		pthread_create(&threads[i], NULL, record_thread, (void *)(uintptr_t)zones);
+	}
+	for (int i = 0; i < threads_num; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	pthread_barrier_destroy(&barrier);
+}
+
+static void test_threads(void) {
+	run_threads(THREADS_NUM, ZONES_PER_THREAD);
+	vglProfilerZoneStats outer = zone_stats(PROFILER_ZONE_CALL_LIST);
+	vglProfilerZoneStats inner = zone_stats(PROFILER_ZONE_MALLOC);
+	CHECK(!strcmp(outer.name, "glCallList"));
+	CHECK_EQ(outer.calls, THREADS_NUM * ZONES_PER_THREAD);
+	CHECK_EQ(inner.calls, THREADS_NUM * ZONES_PER_THREAD);
+	CHECK(outer.min_time <= outer.max_time);
+	CHECK(outer.total_time >= outer.max_time);
+	CHECK(outer.total_time >= inner.total_time);
+	CHECK_EQ(zone_stats(PROFILER_ZONE_SWAP_BUFFERS).calls, 0);
+}
+
+static void test_reset(void) {
+	vglResetProfiler();
+	CHECK_EQ(zone_stats(PROFILER_ZONE_CALL_LIST).calls, 0);
+	CHECK_EQ(zone_stats(PROFILER_ZONE_MALLOC).calls, 0);
+
+	// No frame ended since the reset, so there's nothing to dump
+	CHECK(!vglDumpProfilerTrace(TRACE_PATH, 4));
+
+	empty_zone();
+	CHECK_EQ(zone_stats(PROFILER_ZONE_CALL_LIST).calls, 1);
+	vglProfilerZoneStats s = zone_stats(PROFILER_ZONE_MALLOC);
+	CHECK_EQ(s.calls, 1);
+	CHECK_EQ(s.total_time, s.max_time);
+	CHECK_EQ(s.min_time, s.max_time);
+}
+
+static void test_dump(void) {
+	vglResetProfiler();
+	int tid = sceKernelGetThreadId();
+
+	// Only the last two of three frames are dumped
+	for (int i = 0; i < 3; i++) {
+		sleep_zone(300, 200);
+		profiler_frame();
+	}
+	sleep_zone(0, 0);
+	CHECK(!vglDumpProfilerTrace(TRACE_PATH, 0));
+	CHECK(vglDumpProfilerTrace(TRACE_PATH, 2));
+
+	trace t;
+	trace_load(&t, TRACE_PATH);
+	CHECK_EQ(t.bad_lines, 0);
+	CHECK_EQ(trace_count(&t, "Frame 0", 0), 0);
+	CHECK_EQ(trace_count(&t, "Frame 1", 0), 1);
+	CHECK_EQ(trace_count(&t, "Frame 2", 0), 1);
+	CHECK_EQ(trace_count(&t, "glCallList", tid), 2);
+	CHECK_EQ(trace_count(&t, "vgl_malloc", tid), 2);
+
+	// Zones lie in their frame and inner zones lie in their outer one
+	for (int i = 0; i < t.events_num; i++) {
+		trace_event *e = &t.events[i];
+		CHECK(e->tid == 0 || e->tid == tid);
+		if (e->tid != tid)
+			continue;
+		int frames = 0, parents = 0;
+		for (int j = 0; j < t.events_num; j++) {
+			trace_event *p = &t.events[j];
+			if (p->tid == 0 && e->ts >= p->ts && e->ts + e->dur <= p->ts + p->dur)
+				frames++;
+			if (p->tid == tid && !strcmp(p->name, "glCallList") && e->ts >= p->ts && e->ts + e->dur <= p->ts + p->dur)
+				parents++;
+		}
+		CHECK_EQ(frames, 1);
+		CHECK_EQ(parents, 1);
+		CHECK(e->dur >= (!strcmp(e->name, "glCallList") ? 500 : 200));
+	}
+
+	// Requests for more frames than recorded cover every frame since the reset
+	CHECK(vglDumpProfilerTrace(TRACE_PATH, 100));
+	free(t.events);
+	trace_load(&t, TRACE_PATH);
+	CHECK_EQ(trace_count(&t, "Frame 0", 0), 1);
+	CHECK_EQ(trace_count(&t, "glCallList", tid), 3);
+	free(t.events);
+}
+
+static void *wrap_thread(void *arg) {
+	while (!recording) {
+	}
+	for (int i = 0; i < WRAP_ZONES; i++) {
+		empty_zone();
+	}
+	recording = 0;
+	return NULL;
+}
+
+static void test_wrap(void) {
+	vglResetProfiler();
+	pthread_t thread;
+	pthread_create(&thread, NULL, wrap_thread, NULL);
+
+	// Dumping while the ring gets overwritten must only return complete events
+	int dumps = 0;
+	recording = 1;
+	while (recording) {
+		profiler_frame();
+		CHECK(vglDumpProfilerTrace(TRACE_PATH, PROFILER_FRAMES_NUM));
+		trace t;
+		trace_load(&t, TRACE_PATH);
+		CHECK_EQ(t.bad_lines, 0);
+		int zones = 0;
+		for (int i = 0; i < t.events_num; i++) {
+			if (t.events[i].tid) {
+				CHECK(is_zone_name(t.events[i].name));
+				zones++;
+			}
+		}
+		CHECK(zones <= PROFILER_EVENTS_NUM * PROFILER_MAX_THREADS);
+		free(t.events);
+		dumps++;
+	}
+	pthread_join(thread, NULL);
+	CHECK(dumps > 0);
+	CHECK_EQ(zone_stats(PROFILER_ZONE_CALL_LIST).calls, WRAP_ZONES);
+	CHECK_EQ(zone_stats(PROFILER_ZONE_MALLOC).calls, WRAP_ZONES);
+
+	// Only the most recent events of the thread survive in its ring
+	profiler_frame();
+	CHECK(vglDumpProfilerTrace(TRACE_PATH, PROFILER_FRAMES_NUM));
+	trace t;
+	trace_load(&t, TRACE_PATH);
+	CHECK(trace_count(&t, "glCallList", thread & 0x7FFFFFFF) + trace_count(&t, "vgl_malloc", thread & 0x7FFFFFFF) <= PROFILER_EVENTS_NUM);
+	free(t.events);
+}
+
+static void test_slots(void) {
+	// Threads past the slots limit run their zones unrecorded
+	vglResetProfiler();
+	run_threads(PROFILER_MAX_THREADS * 2, ZONES_PER_THREAD);
+	uint32_t calls = zone_stats(PROFILER_ZONE_CALL_LIST).calls;
+	CHECK_EQ(calls % ZONES_PER_THREAD, 0);
+	CHECK(calls <= PROFILER_MAX_THREADS * ZONES_PER_THREAD);
+
+	profiler_frame();
+	CHECK(vglDumpProfilerTrace(TRACE_PATH, 1));
+	trace t;
+	trace_load(&t, TRACE_PATH);
+	CHECK_EQ(t.bad_lines, 0);
+	CHECK(t.threads_num <= PROFILER_MAX_THREADS);
+	free(t.events);
+}
+#endif
+
+int main(int argc, char **argv) {
+#ifdef HAVE_PROFILER
+	test_threads();
+	test_reset();
+	test_dump();
+	test_wrap();
+	test_slots();
+	remove(TRACE_PATH);
+#else
+	vglProfilerZoneStats s[PROFILER_ZONES_NUM];
+	CHECK_EQ(vglGetProfilerZoneStats(s, PROFILER_ZONES_NUM), 0);
+	CHECK(!vglDumpProfilerTrace(TRACE_PATH, 1));
+	printf("built without PROFILER=1, only the stubs were checked\n");
+#endif
+	return TEST_RESULT();
+}
@@ -0,0 +1,146 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * purge_queue.c:
+ * Tests for the deferred destruction queue against a simulated GPU timeline, resources must be released exactly once
+ * and never before the GPU completed the last scene referencing them
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utils/purge_utils.h"
+
+#include "test.h"
+
+#define FRAMES_NUM 2000 // Simulated frames
+#define BURST_FRAME 1000 // Frame marking far more elements than a purge batch initially holds
+#define BURST_SIZE 40000 // Elements marked per scene in the burst frame
+#define RES_MAX 200000 // Resources marked at most
+#define SEQ_START 0xFFFFFF00 // First scene sequence number, close to wrapping around
+
+static uint32_t last_use[RES_MAX]; // Sequence of the last scene referencing a resource
+static int released[RES_MAX];
+static _Atomic uint32_t gpu_seq; // Last scene completed by the simulated GPU
+static _Atomic int collector_stop;
+static int early_frees, double_frees, rts_num;
+
+static void release_mem(void *ptr) {
+	int id = (intptr_t)ptr;
+	if (released[id])
+		double_frees++;
+	if (!purge_seq_reached(last_use[id], gpu_seq))
+		early_frees++;
+	released[id] = 1;
+}
+
+static void release_rt(void *ptr) {
+	release_mem(ptr);
+	rts_num++;
+}
+
+static void *collector(void *arg) {
+	while (!collector_stop) {
+		purge_queue_collect(gpu_seq);
+	}
+	return NULL;
+}
+
+// Renders FRAMES_NUM frames with the GPU lagging a random number of scenes behind, returns the marked resources
+static int run_timeline(int threaded) {
+	purge_cb cbs[2] = {release_mem, release_rt};
+	pthread_t t;
+	uint32_t seq = SEQ_START;
+	int res_num = 1;
+
+	memset(released, 0, sizeof(released));
+	early_frees = double_frees = rts_num = 0;
+	gpu_seq = seq;
+	srand(1);
+	purge_queue_init(cbs, 2);
+	if (threaded) {
+		collector_stop = 0;
+		pthread_create(&t, NULL, collector, NULL);
+	}
+
+	for (int f = 0; f < FRAMES_NUM; f++) {
+		int scenes = 1 + rand() % 4;
+		for (int s = 0; s < scenes; s++) {
+			int n = rand() % (f == BURST_FRAME ? BURST_SIZE : 60);
+			for (int i = 0; i < n && res_num < RES_MAX; i++) {
+				last_use[res_num] = seq + 1;
+				purge_queue_mark(rand() % 8 ? 0 : 1, (void *)(intptr_t)res_num++);
+			}
+			seq++;
+		}
+		purge_queue_submit(seq);
+
+		// The GPU completes up to 3 scenes per frame but never goes past the submitted ones
+		uint32_t lag = seq - gpu_seq, adv = rand() % 4;
+		gpu_seq += adv < lag ? adv : lag;
+		if (!threaded)
+			purge_queue_collect(gpu_seq);
+	}
+
+	if (threaded) {
+		collector_stop = 1;
+		pthread_join(t, NULL);
+	}
+	gpu_seq = seq;
+	purge_queue_flush();
+	purge_queue_term();
+	return res_num - 1;
+}
+
+int main(int argc, char **argv) {
+	for (int threaded = 0; threaded < 2; threaded++) {
+		int res_num = run_timeline(threaded);
+		CHECK(res_num > BURST_SIZE);
+		CHECK(rts_num > 0);
+		CHECK_EQ(early_frees, 0);
+		CHECK_EQ(double_frees, 0);
+		int leaked = 0;
+		for (int i = 1; i <= res_num; i++) {
+			leaked += !released[i];
+		}
+		CHECK_EQ(leaked, 0);
+	}
+
+	// Nothing must be released before its sequence is reached, wrapping around included
+	purge_cb cbs[1] = {release_mem};
+	memset(released, 0, sizeof(released));
+	purge_queue_init(cbs, 1);
+	gpu_seq = 0xFFFFFFFE;
+	last_use[1] = 2;
+	purge_queue_mark(0, (void *)1);
+	purge_queue_submit(2);
+	CHECK(!purge_queue_ready(gpu_seq));
+	purge_queue_collect(gpu_seq);
+	CHECK(!released[1]);
+	gpu_seq = 1;
+	CHECK(!purge_queue_ready(gpu_seq));
+	gpu_seq = 2;
+	CHECK(purge_queue_ready(gpu_seq));
+	purge_queue_collect(gpu_seq);
+	CHECK(released[1]);
+	CHECK(!purge_queue_ready(gpu_seq));
+	purge_queue_term();
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,289 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * shader_archive.c:
+ * Tests for the packed shader binaries archive (migration, journal recovery, corruption and interrupted compactions)
+ */
+
+#include <dirent.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "utils/shader_archive_utils.h"
+
+#include "test.h"
+
+#define ARCHIVE_DIR "shader_archive_test"
+#define ARCHIVE_PATH ARCHIVE_DIR "/ffp.vgsa"
+#define BACKUP_PATH ARCHIVE_DIR "/ffp.vgsa.bak"
+#define TMP_PATH ARCHIVE_DIR "/ffp.vgsa.tmp"
+#define VARIANTS_NUM 500 // Shaders pairs stored in the archive
+#define VERSION 13
+#define HEADER_SIZE 32 // Size of the archive header
+#define RECORD_HEADER_SIZE 24 // Size of the header of a journal record
+
+static void gen_blob(uint8_t *b, uint32_t size, uint32_t seed) {
+	for (uint32_t i = 0; i < size; i++)
+		b[i] = (seed * 2654435761u + i * 40503u) >> 13;
+}
+
+static uint32_t blob_size(int i) {
+	return 1024 + (i * 37) % 3072;
+}
+
+// Same naming the ffp shaders had as loose files
+static void blob_name(char *dst, int i, int stage) {
+	sprintf(dst, ARCHIVE_DIR "/v%d-%08X-%016llX_%c.gxp", VERSION, i * 7919, (unsigned long long)i * 104729, stage ? 'f' : 'v');
+}
+
+static long file_size(const char *path) {
+	struct stat st;
+	return stat(path, &st) ? -1 : st.st_size;
+}
+
+static void copy_file(const char *src, const char *dst) {
+	uint8_t buf[4096];
+	size_t n;
+	FILE *in = fopen(src, "rb"), *out = fopen(dst, "wb");
+	while ((n = fread(buf, 1, sizeof(buf), in)) > 0)
+		fwrite(buf, 1, n, out);
+	fclose(in);
+	fclose(out);
+}
+
+static void patch_byte(const char *path, long offset, int val) {
+	FILE *f = fopen(path, "r+b");
+	fseek(f, offset, SEEK_SET);
+	fputc(val, f);
+	fclose(f);
+}
+
+static void clear_dir(void) {
+	DIR *d = opendir(ARCHIVE_DIR);
+	if (d) {
+		char path[512];
+		struct dirent *e;
+		while ((e = readdir(d))) {
+			sprintf(path, ARCHIVE_DIR "/%s", e->d_name);
+			if (e->d_name[0] != '.')
+				remove(path);
+		}
+		closedir(d);
+	}
+	mkdir(ARCHIVE_DIR, 0777);
+}
+
+// Checks that the first n variants are all in the archive with their content
+static int verify(shader_archive *a, int n) {
+	uint8_t buf[4096], ref[4096];
+	char name[256];
+	for (int i = 0; i < n; i++) {
+		for (int s = 0; s < 2; s++) {
+			blob_name(name, i, s);
+			const shader_archive_entry *e = shader_archive_find(a, shader_archive_key(name));
+			if (!e || e->size != blob_size(i + s))
+				return 0;
+			gen_blob(ref, e->size, i * 2 + s);
+			if (!shader_archive_read(a, e, buf) || memcmp(buf, ref, e->size))
+				return 0;
+		}
+	}
+	return 1;
+}
+
+static void test_migration(void) {
+	shader_archive a;
+	uint8_t buf[4096];
+	char name[256];
+	for (int i = 0; i < VARIANTS_NUM; i++) {
+		for (int s = 0; s < 2; s++) {
+			blob_name(name, i, s);
+			gen_blob(buf, blob_size(i + s), i * 2 + s);
+			FILE *f = fopen(name, "wb");
+			fwrite(buf, 1, blob_size(i + s), f);
+			fclose(f);
+		}
+	}
+	FILE *f = fopen(ARCHIVE_DIR "/v12-old_v.gxp", "wb");
+	fclose(f);
+
+	// Loose files of the current version move into the archive, older ones are left alone
+	CHECK(shader_archive_open(&a, ARCHIVE_PATH, VERSION));
+	CHECK_EQ(shader_archive_import_dir(&a, ARCHIVE_DIR, "v13-", ".gxp", 1), VARIANTS_NUM * 2);
+	blob_name(name, 0, 0);
+	CHECK(access(name, F_OK) != 0);
+	CHECK(access(ARCHIVE_DIR "/v12-old_v.gxp", F_OK) == 0);
+	CHECK_EQ(a.records, VARIANTS_NUM * 2);
+	CHECK(verify(&a, VARIANTS_NUM));
+
+	// Compaction turns the journal into the sorted index
+	CHECK(shader_archive_compact(&a));
+	CHECK_EQ(a.records, 0);
+	CHECK_EQ(a.num, VARIANTS_NUM * 2);
+	CHECK(verify(&a, VARIANTS_NUM));
+	shader_archive_close(&a);
+}
+
+static void test_appends(void) {
+	shader_archive a;
+	uint8_t buf[4096];
+	char name[256];
+
+	// Appended blobs survive reopening, duplicated keys supersede older blobs
+	CHECK(shader_archive_open(&a, ARCHIVE_PATH, VERSION));
+	blob_name(name, 0, 0);
+	gen_blob(buf, blob_size(0), 0);
+	CHECK(shader_archive_append(&a, shader_archive_key(name), buf, blob_size(0)));
+	blob_name(name, VARIANTS_NUM, 0);
+	gen_blob(buf, 100, 77);
+	CHECK(shader_archive_append(&a, shader_archive_key(name), buf, 100));
+	CHECK_EQ(a.num, VARIANTS_NUM * 2 + 1);
+	CHECK_EQ(a.dead, blob_size(0));
+	shader_archive_close(&a);
+	CHECK(shader_archive_open(&a, ARCHIVE_PATH, VERSION));
+	CHECK_EQ(a.records, 2);
+	CHECK_EQ(a.num, VARIANTS_NUM * 2 + 1);
+	CHECK(verify(&a, VARIANTS_NUM));
+	CHECK(shader_archive_find(&a, shader_archive_key("missing")) == NULL);
+	CHECK_EQ(a.stats.misses, 1);
+	shader_archive_close(&a);
+}
+
+// Archive interrupted in the middle of an append, at every 7 bytes of the record
+static void test_torn_record(void) {
+	shader_archive a;
+	uint8_t buf[500], out[500];
+	char name[256];
+	CHECK(shader_archive_open(&a, ARCHIVE_PATH, VERSION));
+	uint32_t good_end = a.end;
+	shader_archive_close(&a);
+	long full = file_size(ARCHIVE_PATH);
+
+	CHECK(shader_archive_open(&a, ARCHIVE_PATH, VERSION));
+	blob_name(name, VARIANTS_NUM + 1, 1);
+	gen_blob(buf, sizeof(buf), 99);
+	CHECK(shader_archive_append(&a, shader_archive_key(name), buf, sizeof(buf)));
+	shader_archive_close(&a);
+	long with_record = file_size(ARCHIVE_PATH);
+	CHECK_EQ(with_record, full + RECORD_HEADER_SIZE + sizeof(buf));
+	copy_file(ARCHIVE_PATH, BACKUP_PATH);
+
+	for (long cut = full; cut < with_record; cut += 7) {
+		copy_file(BACKUP_PATH, ARCHIVE_PATH);
+		CHECK(!truncate(ARCHIVE_PATH, cut));
+		CHECK(shader_archive_open(&a, ARCHIVE_PATH, VERSION));
+		CHECK_EQ(a.end, good_end);
+		CHECK_EQ(a.num, VARIANTS_NUM * 2 + 1);
+		CHECK_EQ(a.stats.recovered, cut - full);
+
+		// Next append overwrites the torn tail
+		CHECK(shader_archive_append(&a, shader_archive_key(name), buf, sizeof(buf)));
+		shader_archive_close(&a);
+		CHECK(shader_archive_open(&a, ARCHIVE_PATH, VERSION));
+		CHECK_EQ(a.num, VARIANTS_NUM * 2 + 2);
+		const shader_archive_entry *e = shader_archive_find(&a, shader_archive_key(name));
+		CHECK(e && shader_archive_read(&a, e, out) && !memcmp(out, buf, sizeof(buf)));
+		shader_archive_close(&a);
+		if (test_failures)
+			break;
+	}
+}
+
+static void test_corruption(void) {
+	shader_archive a;
+	uint8_t out[4096];
+
+	// Corrupted payload byte past the index, only that blob gets dropped when read
+	copy_file(BACKUP_PATH, ARCHIVE_PATH);
+	patch_byte(ARCHIVE_PATH, HEADER_SIZE + sizeof(shader_archive_entry) * 2 * VARIANTS_NUM + 10, 0xA5);
+	CHECK(shader_archive_open(&a, ARCHIVE_PATH, VERSION));
+	uint32_t num = a.num;
+	int bad = 0;
+	for (uint32_t i = 0; i < a.num; i++) {
+		if (!shader_archive_read(&a, &a.entries[i], out)) {
+			bad++;
+			i--;
+		}
+	}
+	CHECK_EQ(bad, 1);
+	CHECK_EQ(a.num, num - 1);
+	CHECK_EQ(a.stats.corrupted, 1);
+	shader_archive_close(&a);
+
+	// Corrupted index, the archive starts over instead of serving wrong blobs
+	patch_byte(ARCHIVE_PATH, HEADER_SIZE + offsetof(shader_archive_entry, checksum), 0x11);
+	CHECK(shader_archive_open(&a, ARCHIVE_PATH, VERSION));
+	CHECK_EQ(a.num, 0);
+	shader_archive_close(&a);
+
+	// Corrupted journal record header, the journal ends right before it
+	copy_file(BACKUP_PATH, ARCHIVE_PATH);
+	long full = file_size(ARCHIVE_PATH) - RECORD_HEADER_SIZE - 500;
+	patch_byte(ARCHIVE_PATH, full + 8, 0x5A);
+	CHECK(shader_archive_open(&a, ARCHIVE_PATH, VERSION));
+	CHECK_EQ(a.num, VARIANTS_NUM * 2 + 1);
+	CHECK_EQ(a.stats.recovered, RECORD_HEADER_SIZE + 500);
+	shader_archive_close(&a);
+
+	// Archives of another version are dropped
+	copy_file(BACKUP_PATH, ARCHIVE_PATH);
+	CHECK(shader_archive_open(&a, ARCHIVE_PATH, VERSION + 1));
+	CHECK_EQ(a.num, 0);
+	shader_archive_close(&a);
+}
+
+static void test_interrupted_compaction(void) {
+	shader_archive a;
+	copy_file(BACKUP_PATH, ARCHIVE_PATH);
+	CHECK(shader_archive_open(&a, ARCHIVE_PATH, VERSION));
+	uint32_t num = a.num;
+	CHECK(shader_archive_compact(&a));
+	shader_archive_close(&a);
+
+	// Interrupted after removing the old archive, the new one gets picked up
+	CHECK(!rename(ARCHIVE_PATH, TMP_PATH));
+	CHECK(shader_archive_open(&a, ARCHIVE_PATH, VERSION));
+	CHECK_EQ(a.num, num);
+	CHECK_EQ(a.records, 0);
+	CHECK(verify(&a, VARIANTS_NUM));
+	shader_archive_close(&a);
+	CHECK(access(TMP_PATH, F_OK) != 0);
+
+	// Interrupted while writing the new archive, the old one is kept
+	copy_file(ARCHIVE_PATH, TMP_PATH);
+	CHECK(!truncate(TMP_PATH, 1000));
+	CHECK(shader_archive_open(&a, ARCHIVE_PATH, VERSION));
+	CHECK_EQ(a.num, num);
+	shader_archive_close(&a);
+	CHECK(access(TMP_PATH, F_OK) != 0);
+}
+
+int main(int argc, char **argv) {
+	clear_dir();
+	test_migration();
+	test_appends();
+	test_torn_record();
+	test_corruption();
+	test_interrupted_compaction();
+	clear_dir();
+	rmdir(ARCHIVE_DIR);
+	return TEST_RESULT();
+}
@@ -0,0 +1,219 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * shader_cache.c:
+ * Tests for the custom shaders binary cache (identity checks, build versioning and lazy compiler startup)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <vitaGL.h>
+
+#include "utils/shader_cache_utils.h"
+#include "test.h"
+
+#define MEM_BLOBS_NUM 16
+
+// In-memory backend so that blobs can be inspected and tampered with
+typedef struct {
+	char name[32];
+	void *data;
+	uint32_t size;
+} mem_blob;
+
+static mem_blob blobs[MEM_BLOBS_NUM];
+
+static mem_blob *mem_find(const char *name) {
+	for (int i = 0; i < MEM_BLOBS_NUM; i++) {
+		if (blobs[i].data && !strcmp(blobs[i].name, name))
+			return &blobs[i];
+	}
+	return NULL;
+}
+
+static int mem_read(void *user, const char *name, void **buf, uint32_t *size) {
+	mem_blob *b = mem_find(name);
+	if (!b)
+		return -1;
+	*buf = malloc(b->size);
+	memcpy(*buf, b->data, b->size);
+	*size = b->size;
+	return 0;
+}
+
+static int mem_write(void *user, const char *name, const void *buf, uint32_t size) {
+	mem_blob *b = mem_find(name);
+	for (int i = 0; !b && i < MEM_BLOBS_NUM; i++) {
+		if (!blobs[i].data)
+			b = &blobs[i];
+	}
+	if (!b)
+		return -1;
+	free(b->data);
+	strcpy(b->name, name);
+	b->data = malloc(size);
+	memcpy(b->data, buf, size);
+	b->size = size;
+	return 0;
+}
+
+static int mem_remove(void *user, const char *name) {
+	mem_blob *b = mem_find(name);
+	if (!b)
+		return -1;
+	free(b->data);
+	b->data = NULL;
+	return 0;
+}
+
+static int mem_enumerate(void *user, void (*cb)(void *arg, const char *name, uint32_t size, uint32_t stamp), void *arg) {
+	for (int i = 0; i < MEM_BLOBS_NUM; i++) {
+		if (blobs[i].data)
+			cb(arg, blobs[i].name, blobs[i].size, 0);
+	}
+	return 0;
+}
+
+static void mem_clear(void) {
+	for (int i = 0; i < MEM_BLOBS_NUM; i++) {
+		free(blobs[i].data);
+		blobs[i].data = NULL;
+	}
+}
+
+static shader_cache_backend mem_backend = {NULL, mem_read, mem_write, mem_remove, mem_enumerate};
+
+static void test_identity(void) {
+	const char ident_a[] = "float4 main() { return 1; }";
+	const char ident_b[] = "float4 main() { return 0; }";
+	const uint8_t bin[] = {1, 2, 3, 4, 5, 6, 7, 8};
+	shader_cache_stats stats;
+	uint32_t size;
+
+	shader_cache_init(&mem_backend, 64 * 1024, 1);
+	shader_cache_store(0x1234, ident_a, sizeof(ident_a), bin, sizeof(bin));
+
+	// Same key and identity, the stored binary is returned
+	uint8_t *res = (uint8_t *)shader_cache_load(0x1234, ident_a, sizeof(ident_a), &size);
+	CHECK(res != NULL);
+	if (res) {
+		CHECK_EQ(size, sizeof(bin));
+		CHECK(!memcmp(res, bin, sizeof(bin)));
+		free(res);
+	}
+
+	// Colliding key with a different source must never return the stored binary
+	res = (uint8_t *)shader_cache_load(0x1234, ident_b, sizeof(ident_b), &size);
+	CHECK(res == NULL);
+	shader_cache_get_stats(&stats);
+	CHECK_EQ(stats.hits, 1);
+	CHECK_EQ(stats.collisions, 1);
+	CHECK_EQ(stats.entries, 1);
+
+	// Storing the colliding shader replaces the blob
+	shader_cache_store(0x1234, ident_b, sizeof(ident_b), bin, 4);
+	res = (uint8_t *)shader_cache_load(0x1234, ident_b, sizeof(ident_b), &size);
+	CHECK(res != NULL && size == 4);
+	free(res);
+	CHECK(shader_cache_load(0x1234, ident_a, sizeof(ident_a), &size) == NULL);
+	shader_cache_term();
+}
+
+static void test_version(void) {
+	const char ident[] = "void main() {}";
+	const uint8_t bin[] = {9, 8, 7, 6};
+	shader_cache_stats stats;
+	uint32_t size;
+
+	// Blobs produced by another build are discarded and removed from the storage
+	mem_clear();
+	shader_cache_init(&mem_backend, 64 * 1024, 1);
+	shader_cache_store(0x5678, ident, sizeof(ident), bin, sizeof(bin));
+	shader_cache_init(&mem_backend, 64 * 1024, 2);
+	CHECK(shader_cache_load(0x5678, ident, sizeof(ident), &size) == NULL);
+	shader_cache_get_stats(&stats);
+	CHECK_EQ(stats.corrupted, 1);
+	CHECK_EQ(stats.entries, 0);
+
+	// Tampered identities are detected by the checksum
+	shader_cache_store(0x5678, ident, sizeof(ident), bin, sizeof(bin));
+	mem_blob *b = mem_find("0000000000005678.bin");
+	CHECK(b != NULL);
+	if (b)
+		((char *)b->data)[b->size - sizeof(bin) - 2] ^= 1;
+	CHECK(shader_cache_load(0x5678, ident, sizeof(ident), &size) == NULL);
+	shader_cache_get_stats(&stats);
+	CHECK_EQ(stats.corrupted, 2);
+	shader_cache_term();
+}
+
+static const char *vertex_shader =
+	"void main(float3 position, float4 out gl_Position : POSITION, uniform float4x4 wvp) {\n"
+	"	gl_Position = mul(float4(position, 1.0), wvp);\n"
+	"}";
+
+extern GLboolean is_shark_online;
+
+static GLuint compile_shader(void) {
+	GLuint s = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(s, 1, &vertex_shader, NULL);
+	glCompileShader(s);
+	return s;
+}
+
+static void test_lazy_compiler(void) {
+	vglShaderCacheStats stats;
+	GLint status;
+
+	// Custom shaders cache location, emptied so that the first compilation is always a miss
+	mkdir("ux0:data", 0777);
+	mkdir("ux0:data/shader_cache", 0777);
+	mkdir("ux0:data/shader_cache/custom", 0777);
+	system("rm -f ux0:data/shader_cache/custom/*");
+
+	vglInit(0x800000);
+	glReleaseShaderCompiler();
+	GLuint a = compile_shader();
+	glGetShaderiv(a, GL_COMPILE_STATUS, &status);
+	CHECK(status == GL_TRUE);
+	CHECK(is_shark_online);
+
+	// Cache hits must not bring the compiler back up
+	glReleaseShaderCompiler();
+	GLuint b = compile_shader();
+	glGetShaderiv(b, GL_COMPILE_STATUS, &status);
+	CHECK(status == GL_TRUE);
+	CHECK(!is_shark_online);
+	vglGetShaderCacheStats(&stats);
+	CHECK_EQ(stats.misses, 1);
+	CHECK_EQ(stats.hits, 1);
+	CHECK_EQ(stats.collisions, 0);
+
+	glDeleteShader(a);
+	glDeleteShader(b);
+	vglEnd();
+}
+
+int main(int argc, char **argv) {
+	test_identity();
+	test_version();
+	test_lazy_compiler();
+	return TEST_RESULT();
+}
@@ -0,0 +1,158 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * stream.c:
+ * Tests for the streaming rings and their copies de-duplication cache
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "utils/stream_utils.h"
+
+#include "test.h"
+
+#define RING_SIZE (64 * 1024)
+
+static stream_pool pool;
+static uint32_t completed = 0;
+
+// Same path gpu_stream_client_array takes, minus the garbage collected fallback
+static void *client_array(const void *src, uint32_t stride, uint32_t count) {
+	stream_cache_entry *slot;
+	void *res = stream_pool_lookup(&pool, src, stride, count, &slot);
+	if (res)
+		return res;
+	res = stream_pool_alloc(&pool, stride * count);
+	if (!res)
+		return NULL;
+	memcpy(res, src, stride * count);
+	stream_pool_store(&pool, slot, src, stride, count, res);
+	return res;
+}
+
+static void pool_reset(void) {
+	free(pool.rings[0].base);
+	stream_pool_init(&pool);
+	stream_ring_init(&pool.rings[0], malloc(RING_SIZE), RING_SIZE);
+	completed = 0;
+}
+
+static void test_reuse(void) {
+	uint32_t data[64];
+	for (int i = 0; i < 64; i++)
+		data[i] = i * 7;
+	pool_reset();
+
+	// Copies get reused only once the same array has been hashed
+	void *a = client_array(data, 16, 16);
+	void *b = client_array(data, 16, 16);
+	void *c = client_array(data, 16, 16);
+	CHECK(a != b);
+	CHECK(b == c);
+	CHECK(!memcmp(c, data, sizeof(data)));
+
+	// A different vertex range is a different copy
+	void *d = client_array(data, 16, 8);
+	CHECK(d != c);
+
+	// Copies can't be shared across scenes
+	stream_pool_fence(&pool, 1);
+	void *e = client_array(data, 16, 16);
+	CHECK(e != c);
+	CHECK(!memcmp(e, data, sizeof(data)));
+}
+
+static void test_rewritten(void) {
+	uint32_t data[64];
+	for (int i = 0; i < 64; i++)
+		data[i] = i;
+	pool_reset();
+	client_array(data, 4, 64);
+	client_array(data, 4, 64);
+	data[10] = 1234;
+	void *a = client_array(data, 4, 64);
+	CHECK(!memcmp(a, data, sizeof(data)));
+
+	// Once rewritten in a scene, the array is always copied again
+	void *b = client_array(data, 4, 64);
+	CHECK(a != b);
+	CHECK(!memcmp(b, data, sizeof(data)));
+}
+
+static void test_copy_not_read(void) {
+	uint32_t data[2] = {0x12345678, 0x9ABCDEF0};
+	pool_reset();
+	client_array(data, 8, 1);
+	void *a = client_array(data, 8, 1);
+
+	// Copies live in GPU mapped memory, so reuse is decided on the client array content alone
+	memset(a, 0xFF, sizeof(data));
+	CHECK(client_array(data, 8, 1) == a);
+
+	// A single flipped bit is enough for the copy not to be reused
+	data[1] ^= 0x100;
+	void *b = client_array(data, 8, 1);
+	CHECK(b != a);
+	CHECK(!memcmp(b, data, sizeof(data)));
+}
+
+static void test_ring_reclaim(void) {
+	static uint8_t data[4096];
+	pool_reset();
+
+	// Filling the ring, one fence per allocation
+	uint32_t seq = 0;
+	while (stream_pool_alloc(&pool, sizeof(data)))
+		stream_pool_fence(&pool, ++seq);
+	CHECK_EQ(seq, RING_SIZE / sizeof(data));
+
+	// Nothing can be reclaimed until the GPU completes the scenes using it
+	stream_pool_retire(&pool, 0);
+	CHECK(!stream_pool_alloc(&pool, sizeof(data)));
+	stream_pool_retire(&pool, 2);
+	CHECK(stream_pool_alloc(&pool, sizeof(data)));
+	CHECK(stream_pool_alloc(&pool, sizeof(data)));
+	CHECK(!stream_pool_alloc(&pool, sizeof(data)));
+
+	// Allocations not fitting before the ring end wrap around to the space released at the ring start
+	pool_reset();
+	uint8_t *base = pool.rings[0].base;
+	CHECK(stream_pool_alloc(&pool, RING_SIZE / 2) == base);
+	stream_pool_fence(&pool, 1);
+	CHECK(stream_pool_alloc(&pool, RING_SIZE / 4) == base + RING_SIZE / 2);
+	stream_pool_fence(&pool, 2);
+	CHECK(!stream_pool_alloc(&pool, RING_SIZE / 2));
+	stream_pool_retire(&pool, 1);
+	CHECK(stream_pool_alloc(&pool, RING_SIZE / 2) == base);
+	CHECK(!stream_pool_alloc(&pool, 16));
+	stream_pool_fence(&pool, 3);
+	stream_pool_retire(&pool, 2);
+	CHECK(!stream_pool_alloc(&pool, RING_SIZE / 2 + 16));
+	stream_pool_retire(&pool, 3);
+	CHECK(stream_pool_alloc(&pool, RING_SIZE) == base);
+}
+
+int main(int argc, char **argv) {
+	test_reuse();
+	test_rewritten();
+	test_copy_not_read();
+	test_ring_reclaim();
+	free(pool.rings[0].base);
+	return TEST_RESULT();
+}
@@ -0,0 +1,168 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * tlsf.c:
+ * Randomized stress test for the Two-Level Segregated Fit allocator (alignment, overlaps, contents and coalescing)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "utils/tlsf_utils.h"
+
+#include "test.h"
+
+#define POOL_SIZE (64 * 1024 * 1024) // Managed region size
+#define SLOTS_NUM 2000 // Live allocations at most
+#define OPS_NUM 200000 // Random operations performed
+
+typedef struct {
+	uint8_t *ptr;
+	size_t size;
+	size_t align;
+} slot;
+
+static slot slots[SLOTS_NUM];
+static uint32_t rng = 0x1234567;
+
+static uint32_t rnd() {
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+	return rng;
+}
+
+static size_t rnd_size() {
+	uint32_t r = rnd() % 100;
+	if (r < 60)
+		return 1 + rnd() % 512;
+	if (r < 90)
+		return 1024 + rnd() % 16384;
+	return 65536 + rnd() % (256 * 1024);
+}
+
+// Every slot is filled with a pattern derived from its index so that overlapping writes are detected
+static void fill(int i) {
+	memset(slots[i].ptr, (uint8_t)i, slots[i].size);
+}
+
+static int check_contents(int i, size_t size) {
+	for (size_t j = 0; j < size; j++) {
+		if (slots[i].ptr[j] != (uint8_t)i)
+			return 0;
+	}
+	return 1;
+}
+
+static int cmp_slots(const void *a, const void *b) {
+	const slot *sa = (const slot *)a, *sb = (const slot *)b;
+	return sa->ptr < sb->ptr ? -1 : sa->ptr > sb->ptr;
+}
+
+int main(int argc, char **argv) {
+	uint8_t *mem = malloc(POOL_SIZE);
+	tlsf_pool p;
+	tlsf_init(&p);
+	CHECK(tlsf_add_region(&p, mem, POOL_SIZE));
+	size_t total = p.total_size;
+	CHECK(total > 0 && total <= POOL_SIZE);
+	CHECK_EQ(p.free_size, total);
+
+	int fails = 0, reallocs = 0;
+	for (int n = 0; n < OPS_NUM; n++) {
+		int i = rnd() % SLOTS_NUM;
+		slot *s = &slots[i];
+		if (!s->ptr) {
+			s->size = rnd_size();
+			s->align = 1u << (4 + rnd() % 9);
+			s->ptr = tlsf_alloc(&p, s->size, s->align);
+			if (!s->ptr) {
+				fails++;
+				continue;
+			}
+			CHECK((uintptr_t)s->ptr % s->align == 0);
+			CHECK(s->ptr >= mem && s->ptr + s->size <= mem + POOL_SIZE);
+			CHECK(tlsf_usable_size(&p, s->ptr) >= s->size);
+			fill(i);
+		} else if (rnd() % 4 == 0) {
+			size_t size = rnd_size();
+			uint8_t *ptr = tlsf_realloc(&p, s->ptr, size);
+			if (ptr) {
+				s->ptr = ptr;
+				CHECK((uintptr_t)ptr % TLSF_GRANULARITY == 0);
+				CHECK(check_contents(i, size < s->size ? size : s->size));
+				s->size = size;
+				s->align = TLSF_GRANULARITY;
+				fill(i);
+				reallocs++;
+			} else {
+				CHECK(check_contents(i, s->size));
+			}
+		} else {
+			CHECK(check_contents(i, s->size));
+			CHECK(tlsf_free(&p, s->ptr));
+			s->ptr = NULL;
+		}
+	}
+	CHECK(reallocs > 0);
+	CHECK(fails < OPS_NUM / 100);
+
+	// Live blocks must not overlap and the free space must match what is not in use
+	slot sorted[SLOTS_NUM];
+	int live = 0;
+	size_t used = 0;
+	for (int i = 0; i < SLOTS_NUM; i++) {
+		if (slots[i].ptr) {
+			CHECK(check_contents(i, slots[i].size));
+			used += tlsf_usable_size(&p, slots[i].ptr);
+			sorted[live++] = slots[i];
+		}
+	}
+	qsort(sorted, live, sizeof(slot), cmp_slots);
+	for (int i = 1; i < live; i++) {
+		CHECK(sorted[i - 1].ptr + sorted[i - 1].size <= sorted[i].ptr);
+	}
+	CHECK(p.free_size + used <= total);
+	CHECK(tlsf_largest_free(&p) <= p.free_size);
+
+	// Invalid pointers are rejected without touching the pool
+	size_t free_size = p.free_size;
+	CHECK(!tlsf_free(&p, mem + POOL_SIZE));
+	if (live)
+		CHECK(!tlsf_free(&p, sorted[0].ptr + 1));
+	CHECK_EQ(p.free_size, free_size);
+
+	// Once everything is released, the region must be coalesced back into a single block
+	for (int i = 0; i < SLOTS_NUM; i++) {
+		if (slots[i].ptr) {
+			CHECK(tlsf_free(&p, slots[i].ptr));
+			slots[i].ptr = NULL;
+		}
+	}
+	CHECK_EQ(p.used_num, 0);
+	CHECK_EQ(p.free_size, total);
+	CHECK_EQ(tlsf_largest_free(&p), total);
+	uint8_t *whole = tlsf_alloc(&p, total, TLSF_GRANULARITY);
+	CHECK(whole != NULL);
+	CHECK(tlsf_alloc(&p, TLSF_GRANULARITY, TLSF_GRANULARITY) == NULL);
+	CHECK(tlsf_free(&p, whole));
+
+	tlsf_destroy(&p);
+	free(mem);
+	return TEST_RESULT();
+}
@@ -0,0 +1,231 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * transcode.c:
+ * Tests for the ETC2/EAC and ATITC to DXT transcoders, decoded results are checked against the in tree decoders
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "utils/atitc_utils.h"
+#include "utils/eac_utils.h"
+#include "utils/transcode_utils.h"
+
+#include "test.h"
+
+#define BLOCKS_NUM 65536 // Blocks checked per format and data kind
+
+static inline int expand_565(uint16_t c, int ch) {
+	switch (ch) {
+	case 0:
+		return ((c >> 11) << 3) | (c >> 13);
+	case 1:
+		return (((c >> 5) & 0x3F) << 2) | ((c >> 9) & 0x03);
+	default:
+		return ((c & 0x1F) << 3) | ((c >> 2) & 0x07);
+	}
+}
+
+// Decodes a DXT1 (alpha_size 0), DXT3 or DXT5 block to RGBA
+static void decode_dxt(const uint8_t *b, int alpha_size, int isdxt3, uint8_t *out) {
+	for (int i = 0; i < 16; i++)
+		out[i * 4 + 3] = 255;
+	if (alpha_size && isdxt3) {
+		for (int i = 0; i < 16; i++)
+			out[i * 4 + 3] = ((b[i / 2] >> ((i & 1) * 4)) & 0x0F) * 17;
+	} else if (alpha_size) {
+		int pal[8] = {b[0], b[1]};
+		if (b[0] > b[1]) {
+			for (int i = 2; i < 8; i++)
+				pal[i] = ((8 - i) * b[0] + (i - 1) * b[1]) / 7;
+		} else {
+			for (int i = 2; i < 6; i++)
+				pal[i] = ((6 - i) * b[0] + (i - 1) * b[1]) / 5;
+			pal[6] = 0;
+			pal[7] = 255;
+		}
+		uint64_t bits = 0;
+		for (int i = 0; i < 6; i++)
+			bits |= (uint64_t)b[2 + i] << (8 * i);
+		for (int i = 0; i < 16; i++)
+			out[i * 4 + 3] = pal[(bits >> (3 * i)) & 7];
+	}
+	b += alpha_size;
+	uint16_t c0 = b[0] | (b[1] << 8), c1 = b[2] | (b[3] << 8);
+	uint32_t mask = b[4] | (b[5] << 8) | (b[6] << 16) | ((uint32_t)b[7] << 24);
+	for (int c = 0; c < 3; c++) {
+		int pal[4] = {expand_565(c0, c), expand_565(c1, c)};
+		if (c0 > c1 || alpha_size) {
+			pal[2] = (2 * pal[0] + pal[1]) / 3;
+			pal[3] = (pal[0] + 2 * pal[1]) / 3;
+		} else {
+			pal[2] = (pal[0] + pal[1]) / 2;
+			pal[3] = 0;
+		}
+		for (int i = 0; i < 16; i++)
+			out[i * 4 + c] = pal[(mask >> (2 * i)) & 3];
+	}
+}
+
+static double sq_err(const uint8_t *a, const uint8_t *b, int channels) {
+	double err = 0;
+	for (int i = 0; i < 16; i++) {
+		for (int c = 0; c < channels; c++) {
+			int d = a[i * 4 + c] - b[i * 4 + c];
+			err += d * d;
+		}
+	}
+	return err;
+}
+
+static double psnr(double err, double samples) {
+	return err ? 10.0 * log10(255.0 * 255.0 * samples / err) : 99.0;
+}
+
+// Random bitstreams hit every block mode, smooth ones are ETC differential blocks with small deltas and modifiers
+static void gen_etc2_eac(uint8_t *b, int smooth) {
+	for (int i = 0; i < 16; i++)
+		b[i] = rand();
+	if (smooth) {
+		for (int c = 0; c < 3; c++)
+			b[8 + c] = (b[8 + c] & 0xF8) | (rand() % 2 ? 0 : 7) * (rand() % 2);
+		b[11] = (b[11] & 0x01) | 0x02 | ((rand() % 3) << 5) | ((rand() % 3) << 2);
+	}
+}
+
+// ATITC blocks in 4 colors mode are transcoded exactly, the ones in implicit black mode are compressed again
+static void test_atc(transcode_fmt fmt, ATITCDecodeFlag flag, int alpha_size, int isdxt3) {
+	const uint32_t size = transcode_src_block_size(fmt);
+	uint8_t src[16], dst[16], ref[8], atc[64], dxt[64];
+	int alpha_mismatches = 0, endpoint_mismatches = 0, max_diff = 0, reencoded_mismatches = 0;
+	for (int n = 0; n < BLOCKS_NUM; n++) {
+		for (int i = 0; i < size; i++)
+			src[i] = rand();
+		transcode_block(dst, src, fmt, DXT_QUALITY_NORMAL);
+		decode_dxt(dst, alpha_size, isdxt3, dxt);
+		atitc_decode(src, atc, 4, 4, flag);
+		for (int i = 0; i < 16; i++) {
+			// The ATITC decoder writes ARGB words
+			uint8_t *p = &atc[i * 4];
+			uint8_t t = p[0];
+			p[0] = p[2];
+			p[2] = t;
+			if (!alpha_size)
+				p[3] = 255;
+			alpha_mismatches += p[3] != dxt[i * 4 + 3];
+		}
+		const uint8_t *color = src + alpha_size;
+		if (color[1] & 0x80) {
+			for (int i = 0; i < 16; i++)
+				atc[i * 4 + 3] = 255;
+			dxt_compress_block(ref, atc, 0, DXT_QUALITY_NORMAL);
+			reencoded_mismatches += memcmp(ref, dst + alpha_size, 8) != 0;
+			continue;
+		}
+		uint32_t bits = color[4] | (color[5] << 8) | (color[6] << 16) | ((uint32_t)color[7] << 24);
+		for (int i = 0; i < 16; i++) {
+			int sel = (bits >> (2 * i)) & 3;
+			for (int c = 0; c < 3; c++) {
+				int d = abs(atc[i * 4 + c] - dxt[i * 4 + c]);
+				if (sel == 0 || sel == 3)
+					endpoint_mismatches += d != 0;
+				else
+					max_diff = d > max_diff ? d : max_diff;
+			}
+		}
+	}
+	CHECK_EQ(alpha_mismatches, 0);
+	CHECK_EQ(endpoint_mismatches, 0);
+	CHECK_EQ(reencoded_mismatches, 0);
+	// The in tree decoder approximates the 1/3 interpolation as * 21 >> 6
+	CHECK(max_diff <= 4);
+}
+
+// EAC alpha and ETC2 colors must be as close to the decoded texels as decoding and compressing them again
+static void test_etc2_eac(int smooth) {
+	// Allowed PSNR loss per quality level against the decode and compress path
+	static const double max_loss[] = {1.0, 0.3, 0.0};
+	uint8_t src[16], dst[16], ref[16], rgba[64], res[64], expected[64];
+	for (dxt_quality q = DXT_QUALITY_FAST; q <= DXT_QUALITY_HIGH; q++) {
+		srand(smooth + 11);
+		double err = 0, ref_err = 0, alpha_err = 0, ref_alpha_err = 0;
+		int color_mismatches = 0;
+		for (int n = 0; n < BLOCKS_NUM; n++) {
+			gen_etc2_eac(src, smooth);
+			transcode_block(dst, src, TRANSCODE_ETC2_EAC, q);
+			eac_decode(src, rgba, 4, 4, EAC_ETC2);
+			dxt_compress_block(ref, rgba, 1, q);
+			decode_dxt(dst, 8, 0, res);
+			decode_dxt(ref, 8, 0, expected);
+			err += sq_err(rgba, res, 3);
+			ref_err += sq_err(rgba, expected, 3);
+			for (int i = 0; i < 16; i++) {
+				int d = rgba[i * 4 + 3] - res[i * 4 + 3];
+				alpha_err += d * d;
+				d = rgba[i * 4 + 3] - expected[i * 4 + 3];
+				ref_alpha_err += d * d;
+			}
+			color_mismatches += memcmp(dst + 8, ref + 8, 8) != 0;
+		}
+		CHECK(psnr(err, BLOCKS_NUM * 48.0) >= psnr(ref_err, BLOCKS_NUM * 48.0) - max_loss[q]);
+		CHECK(psnr(alpha_err, BLOCKS_NUM * 16.0) >= psnr(ref_alpha_err, BLOCKS_NUM * 16.0) - 0.1);
+		// High quality compresses the decoded texels
+		if (q == DXT_QUALITY_HIGH)
+			CHECK_EQ(color_mismatches, 0);
+	}
+}
+
+// Swizzled output must match every block transcoded alone, with blocks past the source replicating its edges
+static void test_swizzled(transcode_fmt fmt, int src_w, int src_h, int w, int h) {
+	const uint32_t src_size = transcode_src_block_size(fmt), dst_size = transcode_dst_block_size(fmt);
+	const int src_bw = (src_w + 3) / 4, src_bh = (src_h + 3) / 4, bw = (w + 3) / 4, bh = (h + 3) / 4;
+	uint8_t *src = malloc(src_bw * src_bh * src_size), *out = malloc(bw * bh * dst_size), res[16];
+	for (int i = 0; i < src_bw * src_bh * src_size; i++)
+		src[i] = rand();
+	transcode_swizzled(out, src, src_w, src_h, w, h, fmt, DXT_QUALITY_NORMAL);
+	int mismatches = 0;
+	for (int by = 0; by < bh; by++) {
+		for (int bx = 0; bx < bw; bx++) {
+			int sx = bx < src_bw ? bx : src_bw - 1, sy = by < src_bh ? by : src_bh - 1;
+			transcode_block(res, src + (sy * src_bw + sx) * src_size, fmt, DXT_QUALITY_NORMAL);
+			mismatches += memcmp(res, out + dxt_swizzled_block_index(bx, by, bw, bh) * dst_size, dst_size) != 0;
+		}
+	}
+	CHECK_EQ(mismatches, 0);
+	free(src);
+	free(out);
+}
+
+int main(int argc, char **argv) {
+	srand(1);
+	test_atc(TRANSCODE_ATC_RGB, ATC_RGB, 0, 0);
+	test_atc(TRANSCODE_ATC_EXPLICIT_ALPHA, ATC_EXPLICIT_ALPHA, 8, 1);
+	test_atc(TRANSCODE_ATC_INTERPOLATED_ALPHA, ATC_INTERPOLATED_ALPHA, 8, 0);
+	test_etc2_eac(0);
+	test_etc2_eac(1);
+	for (transcode_fmt fmt = TRANSCODE_ETC2_EAC; fmt <= TRANSCODE_ATC_INTERPOLATED_ALPHA; fmt++) {
+		test_swizzled(fmt, 4, 4, 4, 4);
+		test_swizzled(fmt, 12, 20, 16, 32);
+		test_swizzled(fmt, 100, 60, 128, 64);
+		test_swizzled(fmt, 256, 8, 256, 8);
+	}
+	return TEST_RESULT();
+}
@@ -0,0 +1,173 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * uniforms.c:
+ * Tests for the uniform blocks circular pool and the upload plans, against a setter counting its calls
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "utils/uniform_utils.h"
+
+#include "test.h"
+
+#define BLOCK_FLOATS 1024
+#define POOL_SIZE 1024
+
+// Uniform of the mocked program, offsets are in components as for sceGxmSetUniformDataF
+typedef struct {
+	uint32_t res_index;
+} mock_param;
+
+static uint32_t set_calls = 0;
+
+static int count_set(void *buf, const void *param, uint32_t offset, uint32_t count, const float *src) {
+	memcpy((float *)buf + ((const mock_param *)param)->res_index + offset, src, count * sizeof(float));
+	set_calls++;
+	return 0;
+}
+
+static mock_param params[128];
+static float state[BLOCK_FLOATS];
+
+// Plan with one step per uniform, each one copying count components of the state into its own slot
+static uint32_t run_plan(uniform_plan *p, uniform_block *b, uint32_t steps, uint32_t count) {
+	set_calls = 0;
+	b->dirty = 0;
+	uniform_plan_begin(p, b, count_set);
+	for (uint32_t i = 0; i < steps; i++) {
+		params[i].res_index = i * count;
+		uniform_plan_add(p, &params[i], 0, count, &state[i * count]);
+	}
+	uint32_t writes = uniform_plan_run(p);
+	CHECK_EQ(writes, set_calls);
+	CHECK(!memcmp(b->data, state, steps * count * sizeof(float)));
+	return writes;
+}
+
+static void test_plan(void) {
+	uniform_plan p;
+	uniform_block b;
+	memset(&p, 0, sizeof(p));
+	uniform_block_init(&b, BLOCK_FLOATS * sizeof(float));
+	for (int i = 0; i < BLOCK_FLOATS; i++)
+		state[i] = i;
+
+	// First run writes everything, then only changed steps get written
+	CHECK_EQ(run_plan(&p, &b, 8, 4), 8);
+	CHECK(b.dirty);
+	CHECK_EQ(run_plan(&p, &b, 8, 4), 0);
+	CHECK(!b.dirty);
+	state[13] = -1;
+	CHECK_EQ(run_plan(&p, &b, 8, 4), 1);
+	CHECK(b.dirty);
+
+	// Uniforms the program lacks are skipped
+	set_calls = 0;
+	uniform_plan_begin(&p, &b, count_set);
+	uniform_plan_add(&p, NULL, 0, 4, state);
+	uniform_plan_add(&p, &params[0], 0, 0, state);
+	CHECK_EQ(uniform_plan_run(&p), 0);
+	CHECK_EQ(set_calls, 0);
+
+	// A different steps list can't be compared with the last run
+	CHECK_EQ(run_plan(&p, &b, 8, 4), 8);
+	CHECK_EQ(run_plan(&p, &b, 8, 2), 8);
+	CHECK_EQ(run_plan(&p, &b, 8, 2), 0);
+
+	// Invalidation forces every step to be written again
+	uniform_plan_invalidate(&p);
+	CHECK_EQ(run_plan(&p, &b, 8, 2), 8);
+
+	// Steps past the values storage are always written, the others are still compared
+	uint32_t fitting = UNIFORM_PLAN_MAX_VALUES / 16;
+	CHECK_EQ(run_plan(&p, &b, fitting + 4, 16), fitting + 4);
+	CHECK_EQ(run_plan(&p, &b, fitting + 4, 16), 4);
+	state[0] = -2;
+	CHECK_EQ(run_plan(&p, &b, fitting + 4, 16), 5);
+
+	// Too many steps, every step is executed directly, in order and at every run
+	uint32_t steps = UNIFORM_PLAN_MAX_STEPS + 8;
+	CHECK_EQ(run_plan(&p, &b, steps, 1), steps);
+	CHECK(b.dirty);
+	CHECK_EQ(run_plan(&p, &b, steps, 1), steps);
+	state[steps - 1] = -3;
+	CHECK_EQ(run_plan(&p, &b, steps, 1), steps);
+
+	// Back to a plan that fits, nothing of the direct runs can be compared with
+	CHECK_EQ(run_plan(&p, &b, 8, 1), 8);
+	CHECK_EQ(run_plan(&p, &b, 8, 1), 0);
+	uniform_block_term(&b);
+}
+
+// Steps added past the limit keep their order relative to the previous ones
+static void test_plan_overflow_order(void) {
+	uniform_plan p;
+	uniform_block b;
+	float first = 1.0f, second = 2.0f;
+	memset(&p, 0, sizeof(p));
+	uniform_block_init(&b, BLOCK_FLOATS * sizeof(float));
+	params[0].res_index = 0;
+	uniform_plan_begin(&p, &b, count_set);
+	uniform_plan_add(&p, &params[0], 0, 1, &first);
+	for (uint32_t i = 1; i < UNIFORM_PLAN_MAX_STEPS; i++) {
+		params[i].res_index = i;
+		uniform_plan_add(&p, &params[i], 0, 1, &state[i]);
+	}
+	uniform_plan_add(&p, &params[0], 0, 1, &second);
+	uniform_plan_run(&p);
+	CHECK(((float *)b.data)[0] == second);
+	uniform_block_term(&b);
+}
+
+// Randomized uploads of two blocks, the pool often wraps over the copy of the rarely used one before it gets bound again
+static void test_pool(void) {
+	static uint8_t mem[POOL_SIZE];
+	uniform_pool p;
+	uniform_block a, b;
+	uniform_stats st;
+	memset(&st, 0, sizeof(st));
+	uniform_pool_init(&p, mem, sizeof(mem));
+	uniform_block_init(&a, 96);
+	uniform_block_init(&b, 200);
+	srand(5);
+	for (int i = 0; i < 1000000; i++) {
+		uniform_block *x = (rand() % 4) ? &b : &a;
+		if (rand() & 1) {
+			x->data[rand() % x->size] = rand();
+			x->dirty = 1;
+		}
+		uint8_t *r = uniform_block_upload(x, &p, &st);
+		CHECK(r >= mem && r + x->size <= mem + sizeof(mem));
+		CHECK(!memcmp(r, x->data, x->size));
+		if (test_failures)
+			break;
+	}
+	CHECK(st.reuses > 0);
+	CHECK(p.wraps > 0);
+	uniform_block_term(&a);
+	uniform_block_term(&b);
+}
+
+int main(int argc, char **argv) {
+	test_plan();
+	test_plan_overflow_order();
+	test_pool();
+	return TEST_RESULT();
+}
@@ -0,0 +1,74 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * capture_mapped.c:
+ * Program recorded by the replay-check target next to the samples, covering what they don't use:
+ * buffers written through glMapBufferRange and draws sourcing client memory for colors and indices
+ */
+
+#include <string.h>
+#include <vitaGL.h>
+
+#define FRAMES_NUM 10
+
+int main() {
+	vglInitExtended(0, 960, 544, 0x800000, SCE_GXM_MULTISAMPLE_NONE);
+
+	GLuint bufs[2];
+	glGenBuffers(2, bufs);
+	glBindBuffer(GL_ARRAY_BUFFER, bufs[0]);
+	glBufferData(GL_ARRAY_BUFFER, 9 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+	uint16_t idx[3] = {0, 1, 2};
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufs[1]);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(idx), idx, GL_STATIC_DRAW);
+
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glOrtho(0, 960, 544, 0, -1, 1);
+
+	float colors[] = {1, 0, 0, 1, 0, 1, 0, 1, 0, 0, 1, 1};
+	for (int f = 0; f < FRAMES_NUM; f++) {
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		// Vertices are rewritten every frame in storage orphaned by the map
+		float tri[] = {100 + f, 100, 0, 200, 300, 0, 300, 100, 0};
+		float *v = glMapBufferRange(GL_ARRAY_BUFFER, 0, sizeof(tri), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		memcpy(v, tri, sizeof(tri));
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+
+		// Colors come from client memory changing every frame
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
+		glVertexPointer(3, GL_FLOAT, 0, 0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glColorPointer(4, GL_FLOAT, 0, colors);
+		glBindBuffer(GL_ARRAY_BUFFER, bufs[0]);
+		colors[0] = f / (float)FRAMES_NUM;
+
+		// Same triangle drawn with indices from the element buffer and from client memory
+		glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, idx);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufs[1]);
+
+		vglSwapBuffers(GL_FALSE);
+	}
+	vglStopCapture();
+	return 0;
+}
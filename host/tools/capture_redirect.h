@@ -0,0 +1,289 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * capture_redirect.h:
+ * Force included into programs built by the replay-check target so that their GL calls go through vglGetProcAddress,
+ * which is what GL_CAPTURE=1 records. Capture starts before main when VGL_CAPTURE holds the trace path.
+ * NOTE: Entrypoints are the ones listed in source/utils/trace_procs.h
+ */
+
+#ifndef _CAPTURE_REDIRECT_H_
+#define _CAPTURE_REDIRECT_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vitaGL.h>
+
+static void *capture_proc(const char *name) {
+	void *p = vglGetProcAddress(name);
+	if (!p) {
+		fprintf(stderr, "capture_redirect: %s is not resolved by vglGetProcAddress\n", name);
+		abort();
+	}
+	return p;
+}
+
+static void capture_stats(void) {
+	vglCaptureStats s;
+	vglGetCaptureStats(&s);
+	fprintf(stderr, "capture: %u calls, %u frames, %u blobs (%u reused), %llu bytes\n", s.calls, s.frames, s.blobs, s.blobs_reused, (unsigned long long)s.bytes);
+}
+
+__attribute__((constructor)) static void capture_start(void) {
+	const char *path = getenv("VGL_CAPTURE");
+	if (path) {
+		if (!vglStartCapture(path)) {
+			fprintf(stderr, "capture_redirect: cannot capture into %s\n", path);
+			abort();
+		}
+		atexit(capture_stats);
+	}
+}
+
+// Calls an entrypoint through the pointer vglGetProcAddress returns for it, resolved on first use
+#define CAPTURE_CALL(name, ...) ({ \
+	static __typeof__(&name) _p; \
+	if (!_p) \
+		_p = (__typeof__(&name))capture_proc(#name); \
+	_p(__VA_ARGS__); \
+})
+
+// clang-format off
+#define glActiveTexture(...) CAPTURE_CALL(glActiveTexture, ##__VA_ARGS__)
+#define glAlphaFunc(...) CAPTURE_CALL(glAlphaFunc, ##__VA_ARGS__)
+#define glAlphaFuncx(...) CAPTURE_CALL(glAlphaFuncx, ##__VA_ARGS__)
+#define glAttachShader(...) CAPTURE_CALL(glAttachShader, ##__VA_ARGS__)
+#define glBegin(...) CAPTURE_CALL(glBegin, ##__VA_ARGS__)
+#define glBindAttribLocation(...) CAPTURE_CALL(glBindAttribLocation, ##__VA_ARGS__)
+#define glBindBuffer(...) CAPTURE_CALL(glBindBuffer, ##__VA_ARGS__)
+#define glBindFramebuffer(...) CAPTURE_CALL(glBindFramebuffer, ##__VA_ARGS__)
+#define glBindRenderbuffer(...) CAPTURE_CALL(glBindRenderbuffer, ##__VA_ARGS__)
+#define glBindTexture(...) CAPTURE_CALL(glBindTexture, ##__VA_ARGS__)
+#define glBlendEquation(...) CAPTURE_CALL(glBlendEquation, ##__VA_ARGS__)
+#define glBlendEquationSeparate(...) CAPTURE_CALL(glBlendEquationSeparate, ##__VA_ARGS__)
+#define glBlendFunc(...) CAPTURE_CALL(glBlendFunc, ##__VA_ARGS__)
+#define glBlendFuncSeparate(...) CAPTURE_CALL(glBlendFuncSeparate, ##__VA_ARGS__)
+#define glBufferData(...) CAPTURE_CALL(glBufferData, ##__VA_ARGS__)
+#define glBufferSubData(...) CAPTURE_CALL(glBufferSubData, ##__VA_ARGS__)
+#define glCallList(...) CAPTURE_CALL(glCallList, ##__VA_ARGS__)
+#define glCheckFramebufferStatus(...) CAPTURE_CALL(glCheckFramebufferStatus, ##__VA_ARGS__)
+#define glClear(...) CAPTURE_CALL(glClear, ##__VA_ARGS__)
+#define glClearColor(...) CAPTURE_CALL(glClearColor, ##__VA_ARGS__)
+#define glClearColorx(...) CAPTURE_CALL(glClearColorx, ##__VA_ARGS__)
+#define glClearDepth(...) CAPTURE_CALL(glClearDepth, ##__VA_ARGS__)
+#define glClearDepthf(...) CAPTURE_CALL(glClearDepthf, ##__VA_ARGS__)
+#define glClearDepthx(...) CAPTURE_CALL(glClearDepthx, ##__VA_ARGS__)
+#define glClearStencil(...) CAPTURE_CALL(glClearStencil, ##__VA_ARGS__)
+#define glClientActiveTexture(...) CAPTURE_CALL(glClientActiveTexture, ##__VA_ARGS__)
+#define glClipPlane(...) CAPTURE_CALL(glClipPlane, ##__VA_ARGS__)
+#define glColor3f(...) CAPTURE_CALL(glColor3f, ##__VA_ARGS__)
+#define glColor3fv(...) CAPTURE_CALL(glColor3fv, ##__VA_ARGS__)
+#define glColor3ub(...) CAPTURE_CALL(glColor3ub, ##__VA_ARGS__)
+#define glColor3ubv(...) CAPTURE_CALL(glColor3ubv, ##__VA_ARGS__)
+#define glColor4f(...) CAPTURE_CALL(glColor4f, ##__VA_ARGS__)
+#define glColor4fv(...) CAPTURE_CALL(glColor4fv, ##__VA_ARGS__)
+#define glColor4ub(...) CAPTURE_CALL(glColor4ub, ##__VA_ARGS__)
+#define glColor4ubv(...) CAPTURE_CALL(glColor4ubv, ##__VA_ARGS__)
+#define glColor4x(...) CAPTURE_CALL(glColor4x, ##__VA_ARGS__)
+#define glColorMask(...) CAPTURE_CALL(glColorMask, ##__VA_ARGS__)
+#define glColorMaterial(...) CAPTURE_CALL(glColorMaterial, ##__VA_ARGS__)
+#define glColorPointer(...) CAPTURE_CALL(glColorPointer, ##__VA_ARGS__)
+#define glColorTable(...) CAPTURE_CALL(glColorTable, ##__VA_ARGS__)
+#define glCompileShader(...) CAPTURE_CALL(glCompileShader, ##__VA_ARGS__)
+#define glCompressedTexImage2D(...) CAPTURE_CALL(glCompressedTexImage2D, ##__VA_ARGS__)
+#define glCreateProgram(...) CAPTURE_CALL(glCreateProgram, ##__VA_ARGS__)
+#define glCreateShader(...) CAPTURE_CALL(glCreateShader, ##__VA_ARGS__)
+#define glCullFace(...) CAPTURE_CALL(glCullFace, ##__VA_ARGS__)
+#define glDeleteBuffers(...) CAPTURE_CALL(glDeleteBuffers, ##__VA_ARGS__)
+#define glDeleteFramebuffers(...) CAPTURE_CALL(glDeleteFramebuffers, ##__VA_ARGS__)
+#define glDeleteLists(...) CAPTURE_CALL(glDeleteLists, ##__VA_ARGS__)
+#define glDeleteProgram(...) CAPTURE_CALL(glDeleteProgram, ##__VA_ARGS__)
+#define glDeleteRenderbuffers(...) CAPTURE_CALL(glDeleteRenderbuffers, ##__VA_ARGS__)
+#define glDeleteShader(...) CAPTURE_CALL(glDeleteShader, ##__VA_ARGS__)
+#define glDeleteTextures(...) CAPTURE_CALL(glDeleteTextures, ##__VA_ARGS__)
+#define glDepthFunc(...) CAPTURE_CALL(glDepthFunc, ##__VA_ARGS__)
+#define glDepthMask(...) CAPTURE_CALL(glDepthMask, ##__VA_ARGS__)
+#define glDepthRange(...) CAPTURE_CALL(glDepthRange, ##__VA_ARGS__)
+#define glDepthRangef(...) CAPTURE_CALL(glDepthRangef, ##__VA_ARGS__)
+#define glDisable(...) CAPTURE_CALL(glDisable, ##__VA_ARGS__)
+#define glDisableClientState(...) CAPTURE_CALL(glDisableClientState, ##__VA_ARGS__)
+#define glDisableVertexAttribArray(...) CAPTURE_CALL(glDisableVertexAttribArray, ##__VA_ARGS__)
+#define glDrawArrays(...) CAPTURE_CALL(glDrawArrays, ##__VA_ARGS__)
+#define glDrawElements(...) CAPTURE_CALL(glDrawElements, ##__VA_ARGS__)
+#define glDrawElementsBaseVertex(...) CAPTURE_CALL(glDrawElementsBaseVertex, ##__VA_ARGS__)
+#define glEnable(...) CAPTURE_CALL(glEnable, ##__VA_ARGS__)
+#define glEnableClientState(...) CAPTURE_CALL(glEnableClientState, ##__VA_ARGS__)
+#define glEnableVertexAttribArray(...) CAPTURE_CALL(glEnableVertexAttribArray, ##__VA_ARGS__)
+#define glEnd(...) CAPTURE_CALL(glEnd, ##__VA_ARGS__)
+#define glEndList(...) CAPTURE_CALL(glEndList, ##__VA_ARGS__)
+#define glFinish(...) CAPTURE_CALL(glFinish, ##__VA_ARGS__)
+#define glFlush(...) CAPTURE_CALL(glFlush, ##__VA_ARGS__)
+#define glFlushMappedBufferRange(...) CAPTURE_CALL(glFlushMappedBufferRange, ##__VA_ARGS__)
+#define glFogf(...) CAPTURE_CALL(glFogf, ##__VA_ARGS__)
+#define glFogfv(...) CAPTURE_CALL(glFogfv, ##__VA_ARGS__)
+#define glFogi(...) CAPTURE_CALL(glFogi, ##__VA_ARGS__)
+#define glFramebufferRenderbuffer(...) CAPTURE_CALL(glFramebufferRenderbuffer, ##__VA_ARGS__)
+#define glFramebufferTexture(...) CAPTURE_CALL(glFramebufferTexture, ##__VA_ARGS__)
+#define glFramebufferTexture2D(...) CAPTURE_CALL(glFramebufferTexture2D, ##__VA_ARGS__)
+#define glFrontFace(...) CAPTURE_CALL(glFrontFace, ##__VA_ARGS__)
+#define glFrustum(...) CAPTURE_CALL(glFrustum, ##__VA_ARGS__)
+#define glFrustumf(...) CAPTURE_CALL(glFrustumf, ##__VA_ARGS__)
+#define glFrustumx(...) CAPTURE_CALL(glFrustumx, ##__VA_ARGS__)
+#define glGenBuffers(...) CAPTURE_CALL(glGenBuffers, ##__VA_ARGS__)
+#define glGenerateMipmap(...) CAPTURE_CALL(glGenerateMipmap, ##__VA_ARGS__)
+#define glGenFramebuffers(...) CAPTURE_CALL(glGenFramebuffers, ##__VA_ARGS__)
+#define glGenLists(...) CAPTURE_CALL(glGenLists, ##__VA_ARGS__)
+#define glGenRenderbuffers(...) CAPTURE_CALL(glGenRenderbuffers, ##__VA_ARGS__)
+#define glGenTextures(...) CAPTURE_CALL(glGenTextures, ##__VA_ARGS__)
+#define glGetActiveAttrib(...) CAPTURE_CALL(glGetActiveAttrib, ##__VA_ARGS__)
+#define glGetActiveUniform(...) CAPTURE_CALL(glGetActiveUniform, ##__VA_ARGS__)
+#define glGetAttachedShaders(...) CAPTURE_CALL(glGetAttachedShaders, ##__VA_ARGS__)
+#define glGetAttribLocation(...) CAPTURE_CALL(glGetAttribLocation, ##__VA_ARGS__)
+#define glGetBooleanv(...) CAPTURE_CALL(glGetBooleanv, ##__VA_ARGS__)
+#define glGetBufferParameteriv(...) CAPTURE_CALL(glGetBufferParameteriv, ##__VA_ARGS__)
+#define glGetError(...) CAPTURE_CALL(glGetError, ##__VA_ARGS__)
+#define glGetFloatv(...) CAPTURE_CALL(glGetFloatv, ##__VA_ARGS__)
+#define glGetFramebufferAttachmentParameteriv(...) CAPTURE_CALL(glGetFramebufferAttachmentParameteriv, ##__VA_ARGS__)
+#define glGetIntegerv(...) CAPTURE_CALL(glGetIntegerv, ##__VA_ARGS__)
+#define glGetProgramBinary(...) CAPTURE_CALL(glGetProgramBinary, ##__VA_ARGS__)
+#define glGetProgramInfoLog(...) CAPTURE_CALL(glGetProgramInfoLog, ##__VA_ARGS__)
+#define glGetProgramiv(...) CAPTURE_CALL(glGetProgramiv, ##__VA_ARGS__)
+#define glGetShaderInfoLog(...) CAPTURE_CALL(glGetShaderInfoLog, ##__VA_ARGS__)
+#define glGetShaderiv(...) CAPTURE_CALL(glGetShaderiv, ##__VA_ARGS__)
+#define glGetShaderSource(...) CAPTURE_CALL(glGetShaderSource, ##__VA_ARGS__)
+#define glGetString(...) CAPTURE_CALL(glGetString, ##__VA_ARGS__)
+#define glGetStringi(...) CAPTURE_CALL(glGetStringi, ##__VA_ARGS__)
+#define glGetUniformLocation(...) CAPTURE_CALL(glGetUniformLocation, ##__VA_ARGS__)
+#define glGetVertexAttribfv(...) CAPTURE_CALL(glGetVertexAttribfv, ##__VA_ARGS__)
+#define glGetVertexAttribiv(...) CAPTURE_CALL(glGetVertexAttribiv, ##__VA_ARGS__)
+#define glGetVertexAttribPointerv(...) CAPTURE_CALL(glGetVertexAttribPointerv, ##__VA_ARGS__)
+#define glHint(...) CAPTURE_CALL(glHint, ##__VA_ARGS__)
+#define glInterleavedArrays(...) CAPTURE_CALL(glInterleavedArrays, ##__VA_ARGS__)
+#define glIsEnabled(...) CAPTURE_CALL(glIsEnabled, ##__VA_ARGS__)
+#define glIsFramebuffer(...) CAPTURE_CALL(glIsFramebuffer, ##__VA_ARGS__)
+#define glIsTexture(...) CAPTURE_CALL(glIsTexture, ##__VA_ARGS__)
+#define glLightfv(...) CAPTURE_CALL(glLightfv, ##__VA_ARGS__)
+#define glLightModelfv(...) CAPTURE_CALL(glLightModelfv, ##__VA_ARGS__)
+#define glLightModelxv(...) CAPTURE_CALL(glLightModelxv, ##__VA_ARGS__)
+#define glLightxv(...) CAPTURE_CALL(glLightxv, ##__VA_ARGS__)
+#define glLineWidth(...) CAPTURE_CALL(glLineWidth, ##__VA_ARGS__)
+#define glLinkProgram(...) CAPTURE_CALL(glLinkProgram, ##__VA_ARGS__)
+#define glLoadIdentity(...) CAPTURE_CALL(glLoadIdentity, ##__VA_ARGS__)
+#define glLoadMatrixf(...) CAPTURE_CALL(glLoadMatrixf, ##__VA_ARGS__)
+#define glLoadMatrixx(...) CAPTURE_CALL(glLoadMatrixx, ##__VA_ARGS__)
+#define glMapBuffer(...) CAPTURE_CALL(glMapBuffer, ##__VA_ARGS__)
+#define glMapBufferRange(...) CAPTURE_CALL(glMapBufferRange, ##__VA_ARGS__)
+#define glMaterialfv(...) CAPTURE_CALL(glMaterialfv, ##__VA_ARGS__)
+#define glMaterialxv(...) CAPTURE_CALL(glMaterialxv, ##__VA_ARGS__)
+#define glMatrixMode(...) CAPTURE_CALL(glMatrixMode, ##__VA_ARGS__)
+#define glMultiTexCoord2f(...) CAPTURE_CALL(glMultiTexCoord2f, ##__VA_ARGS__)
+#define glMultiTexCoord2fv(...) CAPTURE_CALL(glMultiTexCoord2fv, ##__VA_ARGS__)
+#define glMultiTexCoord2i(...) CAPTURE_CALL(glMultiTexCoord2i, ##__VA_ARGS__)
+#define glMultMatrixf(...) CAPTURE_CALL(glMultMatrixf, ##__VA_ARGS__)
+#define glMultMatrixx(...) CAPTURE_CALL(glMultMatrixx, ##__VA_ARGS__)
+#define glNewList(...) CAPTURE_CALL(glNewList, ##__VA_ARGS__)
+#define glNormal3f(...) CAPTURE_CALL(glNormal3f, ##__VA_ARGS__)
+#define glNormal3fv(...) CAPTURE_CALL(glNormal3fv, ##__VA_ARGS__)
+#define glNormal3s(...) CAPTURE_CALL(glNormal3s, ##__VA_ARGS__)
+#define glOrtho(...) CAPTURE_CALL(glOrtho, ##__VA_ARGS__)
+#define glOrthof(...) CAPTURE_CALL(glOrthof, ##__VA_ARGS__)
+#define glPointSize(...) CAPTURE_CALL(glPointSize, ##__VA_ARGS__)
+#define glPolygonMode(...) CAPTURE_CALL(glPolygonMode, ##__VA_ARGS__)
+#define glPolygonOffset(...) CAPTURE_CALL(glPolygonOffset, ##__VA_ARGS__)
+#define glPopAttrib(...) CAPTURE_CALL(glPopAttrib, ##__VA_ARGS__)
+#define glPopMatrix(...) CAPTURE_CALL(glPopMatrix, ##__VA_ARGS__)
+#define glProgramBinary(...) CAPTURE_CALL(glProgramBinary, ##__VA_ARGS__)
+#define glPushAttrib(...) CAPTURE_CALL(glPushAttrib, ##__VA_ARGS__)
+#define glPushMatrix(...) CAPTURE_CALL(glPushMatrix, ##__VA_ARGS__)
+#define glReadPixels(...) CAPTURE_CALL(glReadPixels, ##__VA_ARGS__)
+#define glReleaseShaderCompiler(...) CAPTURE_CALL(glReleaseShaderCompiler, ##__VA_ARGS__)
+#define glRenderbufferStorage(...) CAPTURE_CALL(glRenderbufferStorage, ##__VA_ARGS__)
+#define glRotatef(...) CAPTURE_CALL(glRotatef, ##__VA_ARGS__)
+#define glRotatex(...) CAPTURE_CALL(glRotatex, ##__VA_ARGS__)
+#define glScalef(...) CAPTURE_CALL(glScalef, ##__VA_ARGS__)
+#define glScalex(...) CAPTURE_CALL(glScalex, ##__VA_ARGS__)
+#define glScissor(...) CAPTURE_CALL(glScissor, ##__VA_ARGS__)
+#define glShadeModel(...) CAPTURE_CALL(glShadeModel, ##__VA_ARGS__)
+#define glShaderBinary(...) CAPTURE_CALL(glShaderBinary, ##__VA_ARGS__)
+#define glShaderSource(...) CAPTURE_CALL(glShaderSource, ##__VA_ARGS__)
+#define glStencilFunc(...) CAPTURE_CALL(glStencilFunc, ##__VA_ARGS__)
+#define glStencilFuncSeparate(...) CAPTURE_CALL(glStencilFuncSeparate, ##__VA_ARGS__)
+#define glStencilMask(...) CAPTURE_CALL(glStencilMask, ##__VA_ARGS__)
+#define glStencilMaskSeparate(...) CAPTURE_CALL(glStencilMaskSeparate, ##__VA_ARGS__)
+#define glStencilOp(...) CAPTURE_CALL(glStencilOp, ##__VA_ARGS__)
+#define glStencilOpSeparate(...) CAPTURE_CALL(glStencilOpSeparate, ##__VA_ARGS__)
+#define glTexCoord2f(...) CAPTURE_CALL(glTexCoord2f, ##__VA_ARGS__)
+#define glTexCoord2fv(...) CAPTURE_CALL(glTexCoord2fv, ##__VA_ARGS__)
+#define glTexCoord2i(...) CAPTURE_CALL(glTexCoord2i, ##__VA_ARGS__)
+#define glTexCoord2s(...) CAPTURE_CALL(glTexCoord2s, ##__VA_ARGS__)
+#define glTexCoordPointer(...) CAPTURE_CALL(glTexCoordPointer, ##__VA_ARGS__)
+#define glTexEnvf(...) CAPTURE_CALL(glTexEnvf, ##__VA_ARGS__)
+#define glTexEnvfv(...) CAPTURE_CALL(glTexEnvfv, ##__VA_ARGS__)
+#define glTexEnvi(...) CAPTURE_CALL(glTexEnvi, ##__VA_ARGS__)
+#define glTexEnvx(...) CAPTURE_CALL(glTexEnvx, ##__VA_ARGS__)
+#define glTexEnvxv(...) CAPTURE_CALL(glTexEnvxv, ##__VA_ARGS__)
+#define glTexImage2D(...) CAPTURE_CALL(glTexImage2D, ##__VA_ARGS__)
+#define glTexParameterf(...) CAPTURE_CALL(glTexParameterf, ##__VA_ARGS__)
+#define glTexParameteri(...) CAPTURE_CALL(glTexParameteri, ##__VA_ARGS__)
+#define glTexSubImage2D(...) CAPTURE_CALL(glTexSubImage2D, ##__VA_ARGS__)
+#define glTranslatef(...) CAPTURE_CALL(glTranslatef, ##__VA_ARGS__)
+#define glTranslatex(...) CAPTURE_CALL(glTranslatex, ##__VA_ARGS__)
+#define glUniform1f(...) CAPTURE_CALL(glUniform1f, ##__VA_ARGS__)
+#define glUniform1fv(...) CAPTURE_CALL(glUniform1fv, ##__VA_ARGS__)
+#define glUniform1i(...) CAPTURE_CALL(glUniform1i, ##__VA_ARGS__)
+#define glUniform1iv(...) CAPTURE_CALL(glUniform1iv, ##__VA_ARGS__)
+#define glUniform2f(...) CAPTURE_CALL(glUniform2f, ##__VA_ARGS__)
+#define glUniform2fv(...) CAPTURE_CALL(glUniform2fv, ##__VA_ARGS__)
+#define glUniform2i(...) CAPTURE_CALL(glUniform2i, ##__VA_ARGS__)
+#define glUniform2iv(...) CAPTURE_CALL(glUniform2iv, ##__VA_ARGS__)
+#define glUniform3f(...) CAPTURE_CALL(glUniform3f, ##__VA_ARGS__)
+#define glUniform3fv(...) CAPTURE_CALL(glUniform3fv, ##__VA_ARGS__)
+#define glUniform3i(...) CAPTURE_CALL(glUniform3i, ##__VA_ARGS__)
+#define glUniform3iv(...) CAPTURE_CALL(glUniform3iv, ##__VA_ARGS__)
+#define glUniform4f(...) CAPTURE_CALL(glUniform4f, ##__VA_ARGS__)
+#define glUniform4fv(...) CAPTURE_CALL(glUniform4fv, ##__VA_ARGS__)
+#define glUniform4i(...) CAPTURE_CALL(glUniform4i, ##__VA_ARGS__)
+#define glUniform4iv(...) CAPTURE_CALL(glUniform4iv, ##__VA_ARGS__)
+#define glUniformMatrix2fv(...) CAPTURE_CALL(glUniformMatrix2fv, ##__VA_ARGS__)
+#define glUniformMatrix3fv(...) CAPTURE_CALL(glUniformMatrix3fv, ##__VA_ARGS__)
+#define glUniformMatrix4fv(...) CAPTURE_CALL(glUniformMatrix4fv, ##__VA_ARGS__)
+#define glUnmapBuffer(...) CAPTURE_CALL(glUnmapBuffer, ##__VA_ARGS__)
+#define glUseProgram(...) CAPTURE_CALL(glUseProgram, ##__VA_ARGS__)
+#define glVertex2f(...) CAPTURE_CALL(glVertex2f, ##__VA_ARGS__)
+#define glVertex2i(...) CAPTURE_CALL(glVertex2i, ##__VA_ARGS__)
+#define glVertex3f(...) CAPTURE_CALL(glVertex3f, ##__VA_ARGS__)
+#define glVertex3fv(...) CAPTURE_CALL(glVertex3fv, ##__VA_ARGS__)
+#define glVertex3i(...) CAPTURE_CALL(glVertex3i, ##__VA_ARGS__)
+#define glVertexAttrib1f(...) CAPTURE_CALL(glVertexAttrib1f, ##__VA_ARGS__)
+#define glVertexAttrib1fv(...) CAPTURE_CALL(glVertexAttrib1fv, ##__VA_ARGS__)
+#define glVertexAttrib2f(...) CAPTURE_CALL(glVertexAttrib2f, ##__VA_ARGS__)
+#define glVertexAttrib2fv(...) CAPTURE_CALL(glVertexAttrib2fv, ##__VA_ARGS__)
+#define glVertexAttrib3f(...) CAPTURE_CALL(glVertexAttrib3f, ##__VA_ARGS__)
+#define glVertexAttrib3fv(...) CAPTURE_CALL(glVertexAttrib3fv, ##__VA_ARGS__)
+#define glVertexAttrib4f(...) CAPTURE_CALL(glVertexAttrib4f, ##__VA_ARGS__)
+#define glVertexAttrib4fv(...) CAPTURE_CALL(glVertexAttrib4fv, ##__VA_ARGS__)
+#define glVertexAttribPointer(...) CAPTURE_CALL(glVertexAttribPointer, ##__VA_ARGS__)
+#define glVertexPointer(...) CAPTURE_CALL(glVertexPointer, ##__VA_ARGS__)
+#define glViewport(...) CAPTURE_CALL(glViewport, ##__VA_ARGS__)
+#define gluBuild2DMipmaps(...) CAPTURE_CALL(gluBuild2DMipmaps, ##__VA_ARGS__)
+#define gluLookAt(...) CAPTURE_CALL(gluLookAt, ##__VA_ARGS__)
+#define gluPerspective(...) CAPTURE_CALL(gluPerspective, ##__VA_ARGS__)
+// clang-format on
+
+#endif
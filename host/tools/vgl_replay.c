@@ -0,0 +1,702 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * vgl_replay.c:
+ * Replays GL calls traces recorded with vglStartCapture at full speed and reports CPU time statistics
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vitaGL.h>
+
+#include "utils/trace_procs.h"
+#include "utils/trace_utils.h"
+
+#define HISTOGRAM_BUCKETS 32 // Buckets of calls durations histograms, bucket n counts durations in [2^(n-1), 2^n) ns
+#define REPLAY_CLIENT_ARRAYS TRACE_PROCS_NUM // Pseudo entrypoint timing client arrays setup
+#define REPLAY_SWAP_BUFFERS (TRACE_PROCS_NUM + 1) // Pseudo entrypoint timing frames end
+#define REPLAY_ENTRIES_NUM (TRACE_PROCS_NUM + 2)
+#define MAX_SAVED_ARRAYS 32 // Client texture units and attribute indices covered by client arrays setup
+#define MAX_PROCS_IDS 0x10000
+
+typedef struct {
+	const uint8_t *p;
+	const uint8_t *end;
+	int overrun;
+} reader;
+
+typedef struct {
+	uint32_t *keys;
+	uint32_t *values;
+	uint32_t size;
+	uint32_t used;
+} name_map;
+
+typedef struct {
+	uint32_t old_base;
+	uint32_t new_base;
+	uint32_t range;
+} list_range;
+
+typedef struct {
+	void *data;
+	uint32_t size;
+} blob;
+
+typedef struct {
+	uint64_t calls;
+	uint64_t total;
+	uint64_t min;
+	uint64_t max;
+	uint32_t histogram[HISTOGRAM_BUCKETS];
+} entry_stats;
+
+typedef struct {
+	GLboolean valid;
+	trace_slot slots[TRACE_MAX_ARGS];
+} saved_array;
+
+static const char *procs_names[] = {
+#define TRACE_PROC(name, sig, ...) #name,
+#define TRACE_FUNC(name, ret, sig, ...) #name,
+	TRACE_PROCS
+#undef TRACE_PROC
+#undef TRACE_FUNC
+};
+
+static const char *procs_sigs[] = {
+#define TRACE_PROC(name, sig, ...) sig,
+#define TRACE_FUNC(name, ret, sig, ...) sig,
+	TRACE_PROCS
+#undef TRACE_PROC
+#undef TRACE_FUNC
+};
+
+static trace_sig sigs[TRACE_PROCS_NUM];
+static int procs_ids[MAX_PROCS_IDS]; // Trace procs ids to local ids
+
+static name_map names[TRACE_NAMES_NUM];
+static list_range *lists = NULL;
+static uint32_t lists_num = 0;
+
+static blob *blobs = NULL;
+static uint32_t blobs_num = 0;
+
+static entry_stats stats[REPLAY_ENTRIES_NUM];
+static uint64_t *frame_times = NULL;
+static uint32_t frames_num = 0;
+static uint64_t frame_time = 0;
+
+static saved_array ffp_arrays[3][MAX_SAVED_ARRAYS]; // glVertexPointer, glColorPointer and glInterleavedArrays use index 0
+static saved_array tex_arrays[MAX_SAVED_ARRAYS];
+static saved_array attrib_arrays[MAX_SAVED_ARRAYS];
+static uint32_t client_unit = 0;
+static GLuint array_buffer = 0;
+static uint8_t *maps[2] = {NULL, NULL};
+static GLboolean inited = GL_FALSE;
+
+static uint8_t *scratch[TRACE_MAX_ARGS];
+static uint32_t scratch_size[TRACE_MAX_ARGS];
+
+static inline uint64_t get_time(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+static void *get_scratch(int i, uint32_t size) {
+	if (size > scratch_size[i]) {
+		scratch[i] = realloc(scratch[i], size);
+		scratch_size[i] = size;
+	}
+	return scratch[i];
+}
+
+/*
+ * Trace decoding
+ */
+static const void *read_bytes(reader *r, uint32_t size) {
+	if (r->overrun || (size_t)(r->end - r->p) < size) {
+		r->overrun = 1;
+		return NULL;
+	}
+	const void *res = r->p;
+	r->p += size;
+	return res;
+}
+
+static uint8_t read_u8(reader *r) {
+	const uint8_t *p = read_bytes(r, 1);
+	return p ? *p : 0;
+}
+
+static uint16_t read_u16(reader *r) {
+	uint16_t v = 0;
+	const void *p = read_bytes(r, 2);
+	if (p)
+		memcpy(&v, p, 2);
+	return v;
+}
+
+static uint32_t read_u32(reader *r) {
+	uint32_t v = 0;
+	const void *p = read_bytes(r, 4);
+	if (p)
+		memcpy(&v, p, 4);
+	return v;
+}
+
+static uint64_t read_u64(reader *r) {
+	uint64_t v = 0;
+	const void *p = read_bytes(r, 8);
+	if (p)
+		memcpy(&v, p, 8);
+	return v;
+}
+
+static blob *get_blob(uint32_t id) {
+	return id < blobs_num ? &blobs[id] : NULL;
+}
+
+static void *get_blob_data(uint32_t id) {
+	blob *b = get_blob(id);
+	return b ? b->data : NULL;
+}
+
+/*
+ * Names remapping
+ */
+static void map_name(uint32_t kind, uint32_t old_name, uint32_t new_name) {
+	name_map *m = &names[kind];
+	if ((m->used + 1) * 2 > m->size) {
+		uint32_t old_size = m->size;
+		uint32_t *old_keys = m->keys;
+		uint32_t *old_values = m->values;
+		m->size = old_size ? old_size * 2 : 256;
+		m->keys = calloc(m->size, sizeof(uint32_t));
+		m->values = malloc(m->size * sizeof(uint32_t));
+		for (uint32_t i = 0; i < old_size; i++) {
+			if (old_keys[i]) {
+				uint32_t j = (old_keys[i] * 0x9E3779B1) & (m->size - 1);
+				while (m->keys[j])
+					j = (j + 1) & (m->size - 1);
+				m->keys[j] = old_keys[i];
+				m->values[j] = old_values[i];
+			}
+		}
+		free(old_keys);
+		free(old_values);
+	}
+	// Name 0 is never generated and always maps to itself
+	if (!old_name)
+		return;
+	uint32_t i = (old_name * 0x9E3779B1) & (m->size - 1);
+	while (m->keys[i] && m->keys[i] != old_name)
+		i = (i + 1) & (m->size - 1);
+	if (!m->keys[i])
+		m->used++;
+	m->keys[i] = old_name;
+	m->values[i] = new_name;
+}
+
+static uint32_t get_name(uint32_t kind, uint32_t old_name) {
+	if (kind == TRACE_NAME_LIST) {
+		for (uint32_t i = 0; i < lists_num; i++) {
+			if (old_name >= lists[i].old_base && old_name - lists[i].old_base < lists[i].range)
+				return lists[i].new_base + old_name - lists[i].old_base;
+		}
+		return old_name;
+	}
+	name_map *m = &names[kind];
+	if (!old_name || !m->size)
+		return old_name;
+	uint32_t i = (old_name * 0x9E3779B1) & (m->size - 1);
+	while (m->keys[i]) {
+		if (m->keys[i] == old_name)
+			return m->values[i];
+		i = (i + 1) & (m->size - 1);
+	}
+	// Unknown names (eg. -1 uniform locations) are passed as they are
+	return old_name;
+}
+
+/*
+ * Stats
+ */
+static void add_sample(int entry, uint64_t t) {
+	entry_stats *s = &stats[entry];
+	if (!s->calls || t < s->min)
+		s->min = t;
+	if (t > s->max)
+		s->max = t;
+	s->calls++;
+	s->total += t;
+	int bucket = 0;
+	while (bucket < HISTOGRAM_BUCKETS - 1 && (1ULL << bucket) <= t)
+		bucket++;
+	s->histogram[bucket]++;
+	frame_time += t;
+}
+
+static uint64_t histogram_percentile(const entry_stats *s, double p) {
+	uint64_t target = (uint64_t)(s->calls * p);
+	uint64_t count = 0;
+	for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		count += s->histogram[i];
+		if (count > target)
+			return (1ULL << i) < s->max ? (1ULL << i) : s->max;
+	}
+	return s->max;
+}
+
+static int compare_u64(const void *a, const void *b) {
+	uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static int compare_entries(const void *a, const void *b) {
+	uint64_t x = stats[*(const int *)a].total, y = stats[*(const int *)b].total;
+	return x < y ? 1 : (x > y ? -1 : 0);
+}
+
+static const char *entry_name(int entry) {
+	switch (entry) {
+	case REPLAY_CLIENT_ARRAYS:
+		return "(client arrays)";
+	case REPLAY_SWAP_BUFFERS:
+		return "vglSwapBuffers";
+	default:
+		return procs_names[entry];
+	}
+}
+
+static void print_report(FILE *f, int histograms) {
+	uint64_t calls = 0, total = 0;
+	for (int i = 0; i < REPLAY_ENTRIES_NUM; i++) {
+		calls += stats[i].calls;
+		total += stats[i].total;
+	}
+	fprintf(f, "Replayed %llu calls in %u frames, %.3f ms of CPU time\n", (unsigned long long)calls, frames_num, total / 1000000.0);
+
+	if (frames_num) {
+		uint64_t sum = 0;
+		for (uint32_t i = 0; i < frames_num; i++) {
+			sum += frame_times[i];
+		}
+		qsort(frame_times, frames_num, sizeof(uint64_t), compare_u64);
+		fprintf(f, "Frame CPU time (ms): avg %.3f min %.3f p50 %.3f p95 %.3f p99 %.3f max %.3f\n",
+			sum / 1000000.0 / frames_num, frame_times[0] / 1000000.0, frame_times[frames_num / 2] / 1000000.0,
+			frame_times[(uint32_t)(frames_num * 0.95)] / 1000000.0, frame_times[(uint32_t)(frames_num * 0.99)] / 1000000.0,
+			frame_times[frames_num - 1] / 1000000.0);
+	}
+
+	int order[REPLAY_ENTRIES_NUM];
+	int used = 0;
+	for (int i = 0; i < REPLAY_ENTRIES_NUM; i++) {
+		if (stats[i].calls)
+			order[used++] = i;
+	}
+	qsort(order, used, sizeof(int), compare_entries);
+	fprintf(f, "\n%-40s %10s %12s %6s %10s %10s %10s %10s\n", "Entrypoint", "Calls", "Total (ms)", "%", "Avg (ns)", "p50 (ns)", "p99 (ns)", "Max (ns)");
+	for (int i = 0; i < used; i++) {
+		const entry_stats *s = &stats[order[i]];
+		fprintf(f, "%-40s %10llu %12.3f %6.2f %10llu %10llu %10llu %10llu\n", entry_name(order[i]), (unsigned long long)s->calls,
+			s->total / 1000000.0, total ? s->total * 100.0 / total : 0.0, (unsigned long long)(s->total / s->calls),
+			(unsigned long long)histogram_percentile(s, 0.5), (unsigned long long)histogram_percentile(s, 0.99), (unsigned long long)s->max);
+	}
+
+	if (histograms) {
+		fprintf(f, "\nDurations histograms (calls per [2^(n-1), 2^n) ns bucket)\n");
+		for (int i = 0; i < used; i++) {
+			const entry_stats *s = &stats[order[i]];
+			fprintf(f, "%-40s", entry_name(order[i]));
+			for (int j = 0; j < HISTOGRAM_BUCKETS; j++) {
+				if (s->histogram[j])
+					fprintf(f, " <%lluns:%u", 1ULL << j, s->histogram[j]);
+			}
+			fprintf(f, "\n");
+		}
+	}
+}
+
+/*
+ * Replay
+ */
+static void dispatch(int id, trace_slot *slots, trace_slot *res) {
+	switch (id) {
+#define TRACE_PROC(name, sig, ...) \
+	case TRACE_ID_##name: \
+		name(TRACE_SLOTS(__VA_ARGS__)); \
+		break;
+#define TRACE_FUNC(name, ret, sig, ...) \
+	case TRACE_ID_##name: \
+		*(ret *)res = name(TRACE_SLOTS(__VA_ARGS__)); \
+		break;
+		TRACE_PROCS
+#undef TRACE_PROC
+#undef TRACE_FUNC
+	default:
+		break;
+	}
+}
+
+static void ensure_inited(void) {
+	if (!inited) {
+		// Traces started after vitaGL initialization are replayed with default settings
+		vglInit(0x800000);
+		inited = GL_TRUE;
+	}
+}
+
+static saved_array *get_saved_array(int id, uint32_t index) {
+	if (index >= MAX_SAVED_ARRAYS)
+		return NULL;
+	switch (id) {
+	case TRACE_ID_glVertexPointer:
+		return &ffp_arrays[0][index];
+	case TRACE_ID_glColorPointer:
+		return &ffp_arrays[1][index];
+	case TRACE_ID_glInterleavedArrays:
+		return &ffp_arrays[2][index];
+	case TRACE_ID_glTexCoordPointer:
+		return &tex_arrays[index];
+	case TRACE_ID_glVertexAttribPointer:
+		return &attrib_arrays[index];
+	default:
+		return NULL;
+	}
+}
+
+static void track_call(int id, trace_slot *slots) {
+	saved_array *a = NULL;
+	switch (id) {
+	case TRACE_ID_glClientActiveTexture:
+		client_unit = slots[0].u - GL_TEXTURE0;
+		break;
+	case TRACE_ID_glBindBuffer:
+		if (slots[0].u == GL_ARRAY_BUFFER)
+			array_buffer = slots[1].u;
+		break;
+	case TRACE_ID_glVertexPointer:
+	case TRACE_ID_glColorPointer:
+	case TRACE_ID_glInterleavedArrays:
+		a = get_saved_array(id, 0);
+		break;
+	case TRACE_ID_glTexCoordPointer:
+		a = get_saved_array(id, client_unit);
+		break;
+	case TRACE_ID_glVertexAttribPointer:
+		a = get_saved_array(id, slots[0].u);
+		break;
+	default:
+		break;
+	}
+	if (a) {
+		a->valid = GL_TRUE;
+		memcpy(a->slots, slots, sizeof(a->slots));
+	}
+}
+
+static void replay_client_array(int id, uint32_t index, uint32_t blob_id) {
+	saved_array *a = get_saved_array(id, index);
+	if (!a || !a->valid)
+		return;
+	trace_slot slots[TRACE_MAX_ARGS], res;
+	memcpy(slots, a->slots, sizeof(slots));
+	// The client pointer is always the last argument
+	slots[sigs[id].args_num - 1].p = get_blob_data(blob_id);
+
+	uint64_t t = get_time();
+	if (array_buffer)
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	if (id == TRACE_ID_glTexCoordPointer && index != client_unit)
+		glClientActiveTexture(GL_TEXTURE0 + index);
+	dispatch(id, slots, &res);
+	if (id == TRACE_ID_glTexCoordPointer && index != client_unit)
+		glClientActiveTexture(GL_TEXTURE0 + client_unit);
+	if (array_buffer)
+		glBindBuffer(GL_ARRAY_BUFFER, array_buffer);
+	add_sample(REPLAY_CLIENT_ARRAYS, get_time() - t);
+}
+
+static int replay_call(reader *r, int id) {
+	const trace_sig *sig = &sigs[id];
+	trace_slot slots[TRACE_MAX_ARGS], res, ret;
+	const uint32_t *gen_names[TRACE_MAX_ARGS];
+	uint32_t gen_counts[TRACE_MAX_ARGS];
+	res.v = 0;
+
+	for (int i = 0; i < sig->args_num; i++) {
+		const trace_arg *arg = &sig->args[i];
+		slots[i].v = 0;
+		gen_counts[i] = 0;
+		switch (arg->type) {
+		case TRACE_ARG_INT:
+		case TRACE_ARG_FLOAT:
+			slots[i].u = read_u32(r);
+			break;
+		case TRACE_ARG_NAME:
+			slots[i].u = get_name(arg->kind, read_u32(r));
+			break;
+		case TRACE_ARG_DOUBLE:
+			slots[i].v = read_u64(r);
+			break;
+		case TRACE_ARG_PTR:
+			slots[i].p = (const void *)(uintptr_t)read_u64(r);
+			break;
+		case TRACE_ARG_STRING:
+		case TRACE_ARG_BLOB:
+			slots[i].p = get_blob_data(read_u32(r));
+			break;
+		case TRACE_ARG_NAMES: {
+			blob *b = get_blob(read_u32(r));
+			if (b) {
+				uint32_t *n = get_scratch(i, b->size);
+				for (uint32_t j = 0; j < b->size / 4; j++) {
+					n[j] = get_name(arg->kind, ((uint32_t *)b->data)[j]);
+				}
+				slots[i].p = n;
+			}
+		} break;
+		case TRACE_ARG_OUT:
+			slots[i].p = get_scratch(i, read_u32(r) + 1);
+			break;
+		case TRACE_ARG_GEN_NAMES:
+			gen_counts[i] = read_u32(r);
+			gen_names[i] = read_bytes(r, gen_counts[i] * 4);
+			slots[i].p = get_scratch(i, gen_counts[i] * 4 + 4);
+			break;
+		case TRACE_ARG_INDICES:
+			if (read_u8(r))
+				slots[i].p = get_blob_data(read_u32(r));
+			else
+				slots[i].p = (const void *)(uintptr_t)read_u64(r);
+			break;
+		case TRACE_ARG_SOURCES: {
+			blob *b = get_blob(read_u32(r));
+			if (b) {
+				uint32_t count = slots[i - 1].u;
+				const char **strings = get_scratch(i, count * sizeof(char *) + 1);
+				const char *s = b->data;
+				for (uint32_t j = 0; j < count; j++) {
+					strings[j] = s;
+					s += strlen(s) + 1;
+				}
+				slots[i].p = strings;
+			}
+		} break;
+		default:
+			break;
+		}
+	}
+	ret.v = 0;
+	if (sig->has_ret) {
+		if (sig->ret.type == TRACE_ARG_PTR)
+			ret.v = read_u64(r);
+		else
+			ret.u = read_u32(r);
+	}
+	if (r->overrun)
+		return 0;
+
+	ensure_inited();
+	uint64_t t = get_time();
+	dispatch(id, slots, &res);
+	add_sample(id, get_time() - t);
+
+	track_call(id, slots);
+	for (int i = 0; i < sig->args_num; i++) {
+		for (uint32_t j = 0; j < gen_counts[i]; j++) {
+			uint32_t old_name;
+			memcpy(&old_name, &gen_names[i][j], 4);
+			map_name(sig->args[i].kind, old_name, ((uint32_t *)slots[i].p)[j]);
+		}
+	}
+	if (sig->has_ret) {
+		if (sig->ret.type == TRACE_ARG_PTR) {
+			// Mapped buffers are the only procs returning pointers
+			maps[slots[0].u == GL_ARRAY_BUFFER ? 0 : 1] = (uint8_t *)res.p;
+		} else if (sig->ret.kind == TRACE_NAME_LIST) {
+			lists = realloc(lists, (lists_num + 1) * sizeof(list_range));
+			lists[lists_num].old_base = ret.u;
+			lists[lists_num].new_base = res.u;
+			lists[lists_num++].range = slots[0].u;
+		} else {
+			map_name(sig->ret.kind, ret.u, res.u);
+		}
+	}
+	return 1;
+}
+
+static int replay(const uint8_t *data, size_t size) {
+	reader r = {data, data + size, 0};
+	const trace_header *hdr = read_bytes(&r, sizeof(trace_header));
+	if (!hdr || hdr->magic != TRACE_MAGIC) {
+		fprintf(stderr, "Not a vitaGL trace.\n");
+		return 0;
+	}
+	if (hdr->version != TRACE_VERSION) {
+		fprintf(stderr, "Unsupported trace version %u (expected %u).\n", hdr->version, TRACE_VERSION);
+		return 0;
+	}
+	for (int i = 0; i < MAX_PROCS_IDS; i++) {
+		procs_ids[i] = -1;
+	}
+
+	uint32_t frames_size = 0;
+	while (r.p < r.end) {
+		uint8_t tag = read_u8(&r);
+		switch (tag) {
+		case TRACE_TAG_PROC: {
+			uint16_t id = read_u16(&r);
+			uint8_t len = read_u8(&r);
+			const char *name = read_bytes(&r, len);
+			if (!name)
+				break;
+			for (int i = 0; i < TRACE_PROCS_NUM; i++) {
+				if (strlen(procs_names[i]) == len && !strncmp(procs_names[i], name, len)) {
+					procs_ids[id] = i;
+					break;
+				}
+			}
+			if (procs_ids[id] < 0) {
+				fprintf(stderr, "Unknown entrypoint %.*s.\n", len, name);
+				return 0;
+			}
+		} break;
+		case TRACE_TAG_CALL: {
+			uint16_t id = read_u16(&r);
+			if (procs_ids[id] < 0) {
+				fprintf(stderr, "Call to undefined entrypoint %u.\n", id);
+				return 0;
+			}
+			replay_call(&r, procs_ids[id]);
+		} break;
+		case TRACE_TAG_BLOB: {
+			uint32_t id = read_u32(&r);
+			uint32_t len = read_u32(&r);
+			const void *src = read_bytes(&r, len);
+			if (!src)
+				break;
+			if (id != blobs_num) {
+				fprintf(stderr, "Unexpected blob id %u.\n", id);
+				return 0;
+			}
+			// Blobs are copied to keep them aligned as the captured client memory likely was
+			blobs = realloc(blobs, (blobs_num + 1) * sizeof(blob));
+			blobs[blobs_num].data = aligned_alloc(16, (len + 16) & ~15);
+			blobs[blobs_num].size = len;
+			memcpy(blobs[blobs_num++].data, src, len);
+		} break;
+		case TRACE_TAG_CLIENT_ARRAY: {
+			uint16_t id = read_u16(&r);
+			uint32_t index = read_u32(&r);
+			uint32_t blob_id = read_u32(&r);
+			if (!r.overrun && procs_ids[id] >= 0)
+				replay_client_array(procs_ids[id], index, blob_id);
+		} break;
+		case TRACE_TAG_MAP_WRITE: {
+			uint32_t target = read_u32(&r);
+			uint32_t offset = read_u32(&r);
+			blob *b = get_blob(read_u32(&r));
+			uint8_t *dst = maps[target == GL_ARRAY_BUFFER ? 0 : 1];
+			if (!r.overrun && b && dst)
+				memcpy(dst + offset, b->data, b->size);
+		} break;
+		case TRACE_TAG_FRAME: {
+			uint8_t has_commondialog = read_u8(&r);
+			if (r.overrun)
+				break;
+			ensure_inited();
+			uint64_t t = get_time();
+			vglSwapBuffers(has_commondialog);
+			add_sample(REPLAY_SWAP_BUFFERS, get_time() - t);
+			if (frames_num == frames_size) {
+				frames_size = frames_size ? frames_size * 2 : 1024;
+				frame_times = realloc(frame_times, frames_size * sizeof(uint64_t));
+			}
+			frame_times[frames_num++] = frame_time;
+			frame_time = 0;
+		} break;
+		case TRACE_TAG_INIT: {
+			uint32_t args[8];
+			for (int i = 0; i < 8; i++) {
+				args[i] = read_u32(&r);
+			}
+			if (r.overrun || inited)
+				break;
+			vglInitWithCustomSizes(args[0], args[1], args[2], args[3], args[4], args[5], args[6], args[7]);
+			inited = GL_TRUE;
+		} break;
+		default:
+			fprintf(stderr, "Invalid record tag %u.\n", tag);
+			return 0;
+		}
+		if (r.overrun) {
+			// Captures are flushed at each frame end, so the last frame of a trace may be truncated
+			fprintf(stderr, "Trace is truncated, replay stopped.\n");
+			break;
+		}
+	}
+	return 1;
+}
+
+int main(int argc, char *argv[]) {
+	const char *path = NULL;
+	int histograms = 0;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-H"))
+			histograms = 1;
+		else
+			path = argv[i];
+	}
+	if (!path) {
+		fprintf(stderr, "Usage: %s [-H] trace\n  -H  Prints calls durations histograms\n", argv[0]);
+		return 1;
+	}
+
+	for (int i = 0; i < TRACE_PROCS_NUM; i++) {
+		if (!trace_parse_sig(procs_sigs[i], &sigs[i])) {
+			fprintf(stderr, "Invalid trace signature for %s.\n", procs_names[i]);
+			return 1;
+		}
+	}
+
+	FILE *f = fopen(path, "rb");
+	if (!f) {
+		fprintf(stderr, "Cannot open %s.\n", path);
+		return 1;
+	}
+	fseek(f, 0, SEEK_END);
+	size_t size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	uint8_t *data = malloc(size);
+	if (fread(data, 1, size, f) != size) {
+		fprintf(stderr, "Cannot read %s.\n", path);
+		fclose(f);
+		return 1;
+	}
+	fclose(f);
+
+	int res = replay(data, size);
+	print_report(stdout, histograms);
+	free(data);
+	return res ? 0 : 1;
+}
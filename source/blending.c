@@ -179,7 +179,7 @@ void glBlendFunc(GLenum sfactor, GLenum dfactor) {
 void glBlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha) {
 #ifdef HAVE_DLISTS
 	// Enqueueing function to a display list if one is being compiled
-	if (_vgl_enqueue_list_func(glBlendFunc, "UUUU", srcRGB, dstRGB, srcAlpha, dstAlpha))
+	if (_vgl_enqueue_list_func(glBlendFuncSeparate, "UUUU", srcRGB, dstRGB, srcAlpha, dstAlpha))
 		return;
 #endif
 	switch (srcRGB) {
@@ -414,7 +414,7 @@ void glBlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha) {
 void glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha) {
 #ifdef HAVE_DLISTS
 	// Enqueueing function to a display list if one is being compiled
-	if (_vgl_enqueue_list_func(glColorMask, "XXXX", red, green, blue, alpha))
+	if (_vgl_enqueue_list_func((void (*)())glColorMask, "XXXX", red, green, blue, alpha))
 		return;
 #endif
 	blend_color_mask = SCE_GXM_COLOR_MASK_NONE;
@@ -0,0 +1,583 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * capture.c:
+ * Implementation for GL calls capture into replayable traces
+ */
+
+#include <stdarg.h>
+#include "shared.h"
+#ifdef HAVE_GL_CAPTURE
+#include "utils/trace_procs.h"
+
+#define FFP_ARRAY_VERTEX 0
+#define FFP_ARRAY_COLOR 1
+#define FFP_ARRAY_NORMAL 2
+#define FFP_ARRAY_TEXCOORD 3
+#define FFP_ARRAYS_NUM (FFP_ARRAY_TEXCOORD + TEXTURE_COORDS_NUM)
+
+// Client array set up by a gl*Pointer call
+typedef struct {
+	uint16_t id; // Proc that set the array up
+	uint32_t index; // Client texture unit or attribute index
+	const uint8_t *ptr;
+	uint32_t elem_size; // Bytes read for a single vertex
+	uint32_t stride;
+	uint32_t seq; // Shared by arrays set up by the same call
+	GLboolean is_client; // Whether ptr is client memory or a buffer offset
+	GLboolean enabled;
+} capture_array;
+
+// Buffer range mapped by the application
+typedef struct {
+	uint8_t *ptr;
+	uint32_t length;
+	GLboolean writable;
+	GLboolean explicit_flush;
+} capture_map;
+
+static const char *procs_names[] = {
+#define TRACE_PROC(name, sig, ...) #name,
+#define TRACE_FUNC(name, ret, sig, ...) #name,
+	TRACE_PROCS
+#undef TRACE_PROC
+#undef TRACE_FUNC
+};
+
+static const char *procs_sigs[] = {
+#define TRACE_PROC(name, sig, ...) sig,
+#define TRACE_FUNC(name, ret, sig, ...) sig,
+	TRACE_PROCS
+#undef TRACE_PROC
+#undef TRACE_FUNC
+};
+
+static trace_sig sigs[TRACE_PROCS_NUM];
+static GLboolean sigs_parsed = GL_FALSE;
+static GLboolean proc_defined[TRACE_PROCS_NUM];
+static GLboolean capturing = GL_FALSE;
+static trace_writer writer;
+
+static capture_array ffp_arrays[FFP_ARRAYS_NUM];
+static capture_array attrib_arrays[VERTEX_ATTRIBS_NUM];
+static capture_map maps[2]; // GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER mappings
+static uint32_t arrays_seq = 0;
+static char *sources_buf = NULL; // Scratch buffer for shader sources
+static uint32_t sources_size = 0;
+
+static uint32_t interleaved_vertex_size(GLenum format) {
+	switch (format) {
+	case GL_V2F:
+		return 8;
+	case GL_V3F:
+	case GL_C4UB_V2F:
+		return 12;
+	case GL_C4UB_V3F:
+		return 16;
+	case GL_T2F_V3F:
+		return 20;
+	case GL_C3F_V3F:
+	case GL_T2F_C4UB_V3F:
+		return 24;
+	default:
+		return 32;
+	}
+}
+
+static void set_array(capture_array *a, uint16_t id, uint32_t index, const void *ptr, uint32_t elem_size, uint32_t stride, uint32_t seq) {
+	a->id = id;
+	a->index = index;
+	a->ptr = (const uint8_t *)ptr;
+	a->elem_size = elem_size;
+	a->stride = stride ? stride : elem_size;
+	a->seq = seq;
+	a->is_client = vertex_array_unit == 0;
+}
+
+static void set_interleaved_arrays(GLenum format, GLsizei stride, const void *ptr) {
+	uint32_t size = interleaved_vertex_size(format);
+	uint32_t seq = arrays_seq++;
+	set_array(&ffp_arrays[FFP_ARRAY_VERTEX], TRACE_ID_glInterleavedArrays, 0, ptr, size, stride, seq);
+	switch (format) {
+	case GL_C4UB_V2F:
+	case GL_C4UB_V3F:
+	case GL_C3F_V3F:
+		set_array(&ffp_arrays[FFP_ARRAY_COLOR], TRACE_ID_glInterleavedArrays, 0, ptr, size, stride, seq);
+		break;
+	case GL_T2F_C4UB_V3F:
+	case GL_T2F_C3F_V3F:
+		set_array(&ffp_arrays[FFP_ARRAY_COLOR], TRACE_ID_glInterleavedArrays, 0, ptr, size, stride, seq);
+		// fallthrough
+	case GL_T2F_V3F:
+	case GL_T4F_V4F:
+		// Interleaved texture coords are always bound to the first texture unit
+		set_array(&ffp_arrays[FFP_ARRAY_TEXCOORD], TRACE_ID_glInterleavedArrays, 0, ptr, size, stride, seq);
+		break;
+	case GL_T2F_N3F_V3F:
+		set_array(&ffp_arrays[FFP_ARRAY_NORMAL], TRACE_ID_glInterleavedArrays, 0, ptr, size, stride, seq);
+		set_array(&ffp_arrays[FFP_ARRAY_TEXCOORD], TRACE_ID_glInterleavedArrays, 0, ptr, size, stride, seq);
+		break;
+	default:
+		break;
+	}
+}
+
+static capture_array *get_client_state_array(GLenum array) {
+	switch (array) {
+	case GL_VERTEX_ARRAY:
+		return &ffp_arrays[FFP_ARRAY_VERTEX];
+	case GL_COLOR_ARRAY:
+		return &ffp_arrays[FFP_ARRAY_COLOR];
+	case GL_NORMAL_ARRAY:
+		return &ffp_arrays[FFP_ARRAY_NORMAL];
+	case GL_TEXTURE_COORD_ARRAY:
+		return client_texture_unit < TEXTURE_COORDS_NUM ? &ffp_arrays[FFP_ARRAY_TEXCOORD + client_texture_unit] : NULL;
+	default:
+		return NULL;
+	}
+}
+
+static capture_map *get_map(GLenum target) {
+	switch (target) {
+	case GL_ARRAY_BUFFER:
+		return &maps[0];
+	case GL_ELEMENT_ARRAY_BUFFER:
+		return &maps[1];
+	default:
+		return NULL;
+	}
+}
+
+static void write_map(GLenum target, uint32_t offset, uint32_t length) {
+	capture_map *m = get_map(target);
+	if (!m || !m->ptr || !m->writable || offset >= m->length)
+		return;
+	if (length > m->length - offset)
+		length = m->length - offset;
+	uint32_t blob = trace_write_blob(&writer, m->ptr + offset, length);
+	trace_write_u8(&writer, TRACE_TAG_MAP_WRITE);
+	trace_write_u32(&writer, target);
+	trace_write_u32(&writer, offset);
+	trace_write_u32(&writer, blob);
+}
+
+static void get_indices_range(const void *idx, GLsizei count, GLenum type, uint32_t *max) {
+	uint32_t top = 0;
+	switch (type) {
+	case GL_UNSIGNED_BYTE:
+		for (GLsizei i = 0; i < count; i++) {
+			if (((const uint8_t *)idx)[i] > top)
+				top = ((const uint8_t *)idx)[i];
+		}
+		break;
+	case GL_UNSIGNED_SHORT:
+		for (GLsizei i = 0; i < count; i++) {
+			if (((const uint16_t *)idx)[i] > top)
+				top = ((const uint16_t *)idx)[i];
+		}
+		break;
+	default:
+		for (GLsizei i = 0; i < count; i++) {
+			if (((const uint32_t *)idx)[i] > top)
+				top = ((const uint32_t *)idx)[i];
+		}
+		break;
+	}
+	*max = top;
+}
+
+static const void *get_indices(const void *indices) {
+	if (index_array_unit) {
+		gpubuffer *gpu = (gpubuffer *)(uintptr_t)index_array_unit;
+		return (uint8_t *)gpu->ptr + (uintptr_t)indices;
+	}
+	return indices;
+}
+
+static void write_client_arrays(uint32_t vertices) {
+	// Arrays are read by vitaGL from their start, so they are captured up to the highest read vertex
+	capture_array *arrays = cur_program ? attrib_arrays : ffp_arrays;
+	int arrays_num = cur_program ? VERTEX_ATTRIBS_NUM : FFP_ARRAYS_NUM;
+	for (int i = 0; i < arrays_num; i++) {
+		capture_array *a = &arrays[i];
+		if (!a->enabled || !a->is_client || !a->ptr || !a->stride)
+			continue;
+		GLboolean dup = GL_FALSE;
+		for (int j = 0; j < i; j++) {
+			if (arrays[j].enabled && arrays[j].is_client && arrays[j].seq == a->seq) {
+				dup = GL_TRUE;
+				break;
+			}
+		}
+		if (dup)
+			continue;
+		uint32_t blob = trace_write_blob(&writer, a->ptr, vertices * a->stride);
+		trace_write_u8(&writer, TRACE_TAG_CLIENT_ARRAY);
+		trace_write_u16(&writer, a->id);
+		trace_write_u32(&writer, a->index);
+		trace_write_u32(&writer, blob);
+	}
+}
+
+static GLboolean has_client_arrays(void) {
+	capture_array *arrays = cur_program ? attrib_arrays : ffp_arrays;
+	int arrays_num = cur_program ? VERTEX_ATTRIBS_NUM : FFP_ARRAYS_NUM;
+	for (int i = 0; i < arrays_num; i++) {
+		if (arrays[i].enabled && arrays[i].is_client && arrays[i].ptr)
+			return GL_TRUE;
+	}
+	return GL_FALSE;
+}
+
+// Tracks the state needed to capture client memory and writes the records a call depends on
+static void track_call(int id, trace_slot *slots, trace_slot *ret) {
+	capture_array *a;
+	capture_map *m;
+	uint32_t max;
+	switch (id) {
+	case TRACE_ID_glVertexPointer:
+		set_array(&ffp_arrays[FFP_ARRAY_VERTEX], id, 0, slots[3].p, slots[0].u * trace_type_size(slots[1].u), slots[2].u, arrays_seq++);
+		break;
+	case TRACE_ID_glColorPointer:
+		set_array(&ffp_arrays[FFP_ARRAY_COLOR], id, 0, slots[3].p, slots[0].u * trace_type_size(slots[1].u), slots[2].u, arrays_seq++);
+		break;
+	case TRACE_ID_glTexCoordPointer:
+		if (client_texture_unit < TEXTURE_COORDS_NUM)
+			set_array(&ffp_arrays[FFP_ARRAY_TEXCOORD + client_texture_unit], id, client_texture_unit, slots[3].p, slots[0].u * trace_type_size(slots[1].u), slots[2].u, arrays_seq++);
+		break;
+	case TRACE_ID_glVertexAttribPointer:
+		if (slots[0].u < VERTEX_ATTRIBS_NUM)
+			set_array(&attrib_arrays[slots[0].u], id, slots[0].u, slots[5].p, slots[1].u * trace_type_size(slots[2].u), slots[4].u, arrays_seq++);
+		break;
+	case TRACE_ID_glInterleavedArrays:
+		set_interleaved_arrays(slots[0].u, slots[1].i, slots[2].p);
+		break;
+	case TRACE_ID_glEnableClientState:
+	case TRACE_ID_glDisableClientState:
+		a = get_client_state_array(slots[0].u);
+		if (a)
+			a->enabled = id == TRACE_ID_glEnableClientState;
+		break;
+	case TRACE_ID_glEnableVertexAttribArray:
+	case TRACE_ID_glDisableVertexAttribArray:
+		if (slots[0].u < VERTEX_ATTRIBS_NUM)
+			attrib_arrays[slots[0].u].enabled = id == TRACE_ID_glEnableVertexAttribArray;
+		break;
+	case TRACE_ID_glDrawArrays:
+		if (slots[2].i > 0 && has_client_arrays())
+			write_client_arrays(slots[1].i + slots[2].i);
+		break;
+	case TRACE_ID_glDrawElements:
+	case TRACE_ID_glDrawElementsBaseVertex:
+		if (slots[1].i > 0 && has_client_arrays()) {
+			get_indices_range(get_indices(slots[3].p), slots[1].i, slots[2].u, &max);
+			if (id == TRACE_ID_glDrawElementsBaseVertex)
+				max += slots[4].i;
+			write_client_arrays(max + 1);
+		}
+		break;
+	case TRACE_ID_glMapBuffer:
+	case TRACE_ID_glMapBufferRange:
+		m = get_map(slots[0].u);
+		if (m) {
+			m->ptr = (uint8_t *)ret->p;
+			if (id == TRACE_ID_glMapBuffer) {
+				gpubuffer *gpu = (gpubuffer *)(uintptr_t)(slots[0].u == GL_ARRAY_BUFFER ? vertex_array_unit : index_array_unit);
+				m->length = gpu ? gpu->size : 0;
+				m->writable = slots[1].u != GL_READ_ONLY;
+				m->explicit_flush = GL_FALSE;
+			} else {
+				m->length = slots[2].u;
+				m->writable = (slots[3].u & GL_MAP_WRITE_BIT) ? GL_TRUE : GL_FALSE;
+				m->explicit_flush = (slots[3].u & GL_MAP_FLUSH_EXPLICIT_BIT) ? GL_TRUE : GL_FALSE;
+			}
+		}
+		break;
+	case TRACE_ID_glFlushMappedBufferRange:
+		write_map(slots[0].u, slots[1].u, slots[2].u);
+		break;
+	case TRACE_ID_glUnmapBuffer:
+		m = get_map(slots[0].u);
+		if (m && m->ptr) {
+			if (!m->explicit_flush)
+				write_map(slots[0].u, 0, m->length);
+			m->ptr = NULL;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+static uint32_t write_sources(GLsizei count, const GLchar *const *strings, const GLint *lengths) {
+	// Sources are stored as a single NUL separated string list
+	uint32_t size = 0;
+	for (GLsizei i = 0; i < count; i++) {
+		size += (lengths && lengths[i] >= 0 ? lengths[i] : strlen(strings[i])) + 1;
+	}
+	if (size > sources_size) {
+		sources_buf = (char *)realloc(sources_buf, size);
+		sources_size = size;
+	}
+	char *p = sources_buf;
+	for (GLsizei i = 0; i < count; i++) {
+		uint32_t len = lengths && lengths[i] >= 0 ? lengths[i] : strlen(strings[i]);
+		memcpy(p, strings[i], len);
+		p[len] = 0;
+		p += len + 1;
+	}
+	return trace_write_blob(&writer, sources_buf, size);
+}
+
+static void capture_call(int id, trace_slot *ret, ...) {
+	const trace_sig *sig = &sigs[id];
+	trace_slot slots[TRACE_MAX_ARGS];
+	uint32_t blobs[TRACE_MAX_ARGS];
+
+	// Fetching arguments as promoted by the variadic call
+	va_list list;
+	va_start(list, ret);
+	for (int i = 0; i < sig->args_num; i++) {
+		slots[i].v = 0;
+		switch (sig->args[i].type) {
+		case TRACE_ARG_INT:
+		case TRACE_ARG_NAME:
+			slots[i].i = va_arg(list, int);
+			break;
+		case TRACE_ARG_FLOAT:
+			slots[i].f = (float)va_arg(list, double);
+			break;
+		case TRACE_ARG_DOUBLE:
+			slots[i].d = va_arg(list, double);
+			break;
+		default:
+			slots[i].p = va_arg(list, const void *);
+			break;
+		}
+	}
+	va_end(list);
+
+	track_call(id, slots, ret);
+
+	if (!proc_defined[id]) {
+		uint8_t len = strlen(procs_names[id]);
+		trace_write_u8(&writer, TRACE_TAG_PROC);
+		trace_write_u16(&writer, id);
+		trace_write_u8(&writer, len);
+		trace_write(&writer, procs_names[id], len);
+		proc_defined[id] = GL_TRUE;
+	}
+
+	// Blobs must precede the call referencing them
+	for (int i = 0; i < sig->args_num; i++) {
+		const trace_arg *arg = &sig->args[i];
+		switch (arg->type) {
+		case TRACE_ARG_STRING:
+			blobs[i] = trace_write_blob(&writer, slots[i].p, slots[i].p ? strlen((const char *)slots[i].p) + 1 : 0);
+			break;
+		case TRACE_ARG_BLOB:
+			blobs[i] = trace_write_blob(&writer, slots[i].p, trace_eval_size(&arg->size, slots));
+			break;
+		case TRACE_ARG_NAMES:
+			blobs[i] = trace_write_blob(&writer, slots[i].p, trace_eval_size(&arg->size, slots) * sizeof(GLuint));
+			break;
+		case TRACE_ARG_SOURCES:
+			blobs[i] = slots[i].p ? write_sources(slots[i - 1].i, (const GLchar *const *)slots[i].p, (const GLint *)slots[i + 1].p) : TRACE_NULL_BLOB;
+			break;
+		case TRACE_ARG_INDICES:
+			// Indices count and type are always the 2nd and 3rd arguments of draws
+			blobs[i] = index_array_unit ? TRACE_NULL_BLOB : trace_write_blob(&writer, slots[i].p, slots[1].i > 0 ? slots[1].u * trace_type_size(slots[2].u) : 0);
+			break;
+		default:
+			break;
+		}
+	}
+
+	trace_write_u8(&writer, TRACE_TAG_CALL);
+	trace_write_u16(&writer, id);
+	for (int i = 0; i < sig->args_num; i++) {
+		const trace_arg *arg = &sig->args[i];
+		switch (arg->type) {
+		case TRACE_ARG_INT:
+		case TRACE_ARG_FLOAT:
+		case TRACE_ARG_NAME:
+			trace_write_u32(&writer, slots[i].u);
+			break;
+		case TRACE_ARG_DOUBLE:
+			trace_write_u64(&writer, slots[i].v);
+			break;
+		case TRACE_ARG_PTR:
+			trace_write_u64(&writer, (uintptr_t)slots[i].p);
+			break;
+		case TRACE_ARG_OUT:
+			trace_write_u32(&writer, trace_eval_size(&arg->size, slots));
+			break;
+		case TRACE_ARG_GEN_NAMES: {
+			uint32_t count = slots[i].p ? trace_eval_size(&arg->size, slots) : 0;
+			trace_write_u32(&writer, count);
+			trace_write(&writer, slots[i].p, count * sizeof(GLuint));
+		} break;
+		case TRACE_ARG_INDICES:
+			if (blobs[i] == TRACE_NULL_BLOB && index_array_unit) {
+				trace_write_u8(&writer, 0);
+				trace_write_u64(&writer, (uintptr_t)slots[i].p);
+			} else {
+				trace_write_u8(&writer, 1);
+				trace_write_u32(&writer, blobs[i]);
+			}
+			break;
+		case TRACE_ARG_IGNORED:
+			break;
+		default:
+			trace_write_u32(&writer, blobs[i]);
+			break;
+		}
+	}
+	if (sig->has_ret) {
+		if (sig->ret.type == TRACE_ARG_PTR)
+			trace_write_u64(&writer, (uintptr_t)ret->p);
+		else
+			trace_write_u32(&writer, ret->u);
+	}
+	writer.stats.calls++;
+}
+
+/*
+ * Wrappers returned by vglGetProcAddress in place of the actual procs
+ * NOTE: Replays call procs with the types listed in trace_procs.h so they must match their actual prototypes
+ */
+#define TRACE_PROC(name, sig, ...) \
+	_Static_assert(__builtin_types_compatible_p(__typeof__(&name), void (*)(TRACE_PARAMS(__VA_ARGS__))), #name " prototype mismatch"); \
+	static void capture_##name(TRACE_PARAMS(__VA_ARGS__)) { \
+		if (capturing && !sigs[TRACE_ID_##name].after) \
+			capture_call(TRACE_ID_##name, NULL TRACE_VARGS(__VA_ARGS__)); \
+		name(TRACE_ARGS(__VA_ARGS__)); \
+		if (capturing && sigs[TRACE_ID_##name].after) \
+			capture_call(TRACE_ID_##name, NULL TRACE_VARGS(__VA_ARGS__)); \
+	}
+#define TRACE_FUNC(name, ret, sig, ...) \
+	_Static_assert(__builtin_types_compatible_p(__typeof__(&name), ret (*)(TRACE_PARAMS(__VA_ARGS__))), #name " prototype mismatch"); \
+	static ret capture_##name(TRACE_PARAMS(__VA_ARGS__)) { \
+		if (capturing && !sigs[TRACE_ID_##name].after) \
+			capture_call(TRACE_ID_##name, NULL TRACE_VARGS(__VA_ARGS__)); \
+		ret res = name(TRACE_ARGS(__VA_ARGS__)); \
+		if (capturing && sigs[TRACE_ID_##name].after) { \
+			trace_slot slot = {.v = 0}; \
+			*(ret *)&slot = res; \
+			capture_call(TRACE_ID_##name, &slot TRACE_VARGS(__VA_ARGS__)); \
+		} \
+		return res; \
+	}
+TRACE_PROCS
+#undef TRACE_PROC
+#undef TRACE_FUNC
+
+static const struct {
+	void *proc;
+	void *wrapper;
+} wrappers[] = {
+#define TRACE_PROC(name, sig, ...) {(void *)name, (void *)capture_##name},
+#define TRACE_FUNC(name, ret, sig, ...) {(void *)name, (void *)capture_##name},
+	TRACE_PROCS
+#undef TRACE_PROC
+#undef TRACE_FUNC
+};
+
+void *capture_get_proc(void *proc) {
+	for (int i = 0; i < TRACE_PROCS_NUM; i++) {
+		if (wrappers[i].proc == proc)
+			return wrappers[i].wrapper;
+	}
+	return proc;
+}
+
+void capture_init(int pool_size, int width, int height, int ram_pool_size, int cdram_pool_size, int phycont_pool_size, int cdlg_pool_size, SceGxmMultisampleMode msaa) {
+	if (!capturing)
+		return;
+	trace_write_u8(&writer, TRACE_TAG_INIT);
+	trace_write_u32(&writer, pool_size);
+	trace_write_u32(&writer, width);
+	trace_write_u32(&writer, height);
+	trace_write_u32(&writer, ram_pool_size);
+	trace_write_u32(&writer, cdram_pool_size);
+	trace_write_u32(&writer, phycont_pool_size);
+	trace_write_u32(&writer, cdlg_pool_size);
+	trace_write_u32(&writer, msaa);
+}
+
+void capture_frame(GLboolean has_commondialog) {
+	if (!capturing)
+		return;
+	trace_write_u8(&writer, TRACE_TAG_FRAME);
+	trace_write_u8(&writer, has_commondialog);
+	writer.stats.frames++;
+	trace_writer_flush(&writer);
+}
+#endif
+
+GLboolean vglStartCapture(const char *path) {
+#ifdef HAVE_GL_CAPTURE
+	if (capturing)
+		return GL_FALSE;
+	if (!sigs_parsed) {
+		for (int i = 0; i < TRACE_PROCS_NUM; i++) {
+			if (!trace_parse_sig(procs_sigs[i], &sigs[i])) {
+				vgl_log("%s:%d: Invalid trace signature for %s.\n", __FILE__, __LINE__, procs_names[i]);
+				return GL_FALSE;
+			}
+		}
+		sigs_parsed = GL_TRUE;
+	}
+	if (!trace_writer_open(&writer, path))
+		return GL_FALSE;
+	sceClibMemset(proc_defined, 0, sizeof(proc_defined));
+	sceClibMemset(ffp_arrays, 0, sizeof(ffp_arrays));
+	sceClibMemset(attrib_arrays, 0, sizeof(attrib_arrays));
+	sceClibMemset(maps, 0, sizeof(maps));
+	capturing = GL_TRUE;
+	return GL_TRUE;
+#else
+	return GL_FALSE;
+#endif
+}
+
+void vglStopCapture(void) {
+#ifdef HAVE_GL_CAPTURE
+	if (!capturing)
+		return;
+	capturing = GL_FALSE;
+	trace_writer_close(&writer);
+	free(sources_buf);
+	sources_buf = NULL;
+	sources_size = 0;
+#endif
+}
+
+void vglGetCaptureStats(vglCaptureStats *stats) {
+#ifdef HAVE_GL_CAPTURE
+	stats->calls = writer.stats.calls;
+	stats->frames = writer.stats.frames;
+	stats->blobs = writer.stats.blobs;
+	stats->blobs_reused = writer.stats.blobs_reused;
+	stats->bytes = writer.stats.bytes;
+	stats->blob_bytes = writer.stats.blob_bytes;
+#else
+	sceClibMemset(stats, 0, sizeof(vglCaptureStats));
+#endif
+}
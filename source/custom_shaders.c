@@ -28,6 +28,11 @@
 
 #define DISABLED_ATTRIBS_POOL_SIZE (256 * 1024) // Disabled attributes circular pool size in bytes
 
+//#define DISABLE_CUSTOM_SHADER_CACHE // Uncomment this to disable filesystem layer cache for custom shaders
+#if defined(DISABLE_ADVANCED_SHADER_CACHE) && !defined(DISABLE_CUSTOM_SHADER_CACHE)
+#define DISABLE_CUSTOM_SHADER_CACHE
+#endif
+
 #define disableDrawAttrib(i) \
 	orig_stride[i] = streams[i].stride; \
 	orig_fmt[i] = attributes[i].format; \
@@ -46,7 +51,7 @@ static float *vertex_attrib_pool;
 static float *vertex_attrib_pool_ptr;
 static float *vertex_attrib_pool_limit;
 static uint8_t vertex_attrib_size[VERTEX_ATTRIBS_NUM] = {4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4};
-static uint32_t vertex_attrib_offsets[VERTEX_ATTRIBS_NUM] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+static uintptr_t vertex_attrib_offsets[VERTEX_ATTRIBS_NUM] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 static uint32_t vertex_attrib_vbo[VERTEX_ATTRIBS_NUM] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 static uint8_t vertex_attrib_state = 0;
 static SceGxmVertexAttribute temp_attributes[VERTEX_ATTRIBS_NUM];
@@ -63,6 +68,18 @@ shark_opt compiler_opts = SHARK_OPT_FAST;
 
 GLuint cur_program = 0; // Current in use custom program (0 = No custom program)
 
+// Asynchronous shader compiler settings
+GLboolean async_shader_compiler = GL_FALSE;
+vglAsyncFallback async_fallback_mode = VGL_ASYNC_FALLBACK_NEAREST;
+
+#ifndef DISABLE_CUSTOM_SHADER_CACHE
+#ifndef VGL_BUILD_ID
+#define VGL_BUILD_ID __DATE__ " " __TIME__ // Without a build id provided by the Makefile, every rebuild invalidates the cache
+#endif
+static GLboolean is_shader_cache_online = GL_FALSE; // Current custom shaders cache status
+static uint32_t shader_cache_max_size = CUSTOM_SHADER_CACHE_DEF_SIZE; // Maximum size in bytes for custom shaders cache
+#endif
+
 // Uniform struct
 typedef struct {
 	const SceGxmProgramParameter *ptr;
@@ -71,6 +88,10 @@ typedef struct {
 	uint32_t size;
 	GLboolean is_fragment;
 	GLboolean is_vertex;
+	uniform_block *block; // Flattened uniforms of the stage the uniform belongs to
+	const SceGxmProgramParameter *alias_ptr; // Fragment counterpart of a uniform shared by both stages
+	uniform_block *alias_block;
+	GLboolean *wvp_cached; // Set only for the wvp uniform, points to the owning program flag
 } uniform;
 
 // Generic shader struct
@@ -80,6 +101,7 @@ typedef struct {
 	GLboolean dirty;
 	int16_t ref_counter;
 	SceGxmShaderPatcherId id;
+	compile_job *job;
 	const SceGxmProgram *prog;
 	uint32_t size;
 	char *source;
@@ -109,6 +131,8 @@ typedef struct {
 	uint8_t attr_map[VERTEX_ATTRIBS_NUM];
 	SceGxmVertexProgram *vprog;
 	SceGxmFragmentProgram *fprog;
+	patch_cache vert_patches; // Patched vertex programs for the used vertex layouts
+	patch_cache frag_patches; // Patched fragment programs for the used blend settings
 	blend_config blend_info;
 	GLuint attr_num;
 	GLuint attr_idx;
@@ -116,6 +140,11 @@ typedef struct {
 	const SceGxmProgramParameter *wvp;
 	uniform *vert_uniforms;
 	uniform *frag_uniforms;
+	uniform_block vert_block; // Vertex uniforms laid out as the vertex program default uniform buffer
+	uniform_block frag_block; // Fragment uniforms laid out as the fragment program default uniform buffer
+	uniform *wvp_unif;
+	matrix4x4 wvp_cache; // Matrix implicitly set as wvp in the vertex block
+	GLboolean wvp_cached; // Whether the vertex block wvp holds wvp_cache instead of the application value
 	GLuint attr_highest_idx;
 	GLboolean has_unaligned_attrs;
 	GLboolean is_fbo_float;
@@ -125,7 +154,54 @@ typedef struct {
 static shader shaders[MAX_CUSTOM_SHADERS];
 static program progs[MAX_CUSTOM_PROGRAMS];
 
+static void upload_vert_uniforms(program *p, GLboolean implicit_wvp) {
+	// Refreshing wvp in the vertex block only if it actually changed
+	if (p->wvp_unif) {
+		if (implicit_wvp) {
+			if (mvp_modified) {
+				matrix4x4_multiply(mvp_matrix, projection_matrix, modelview_matrix);
+				mvp_modified = GL_FALSE;
+			}
+			if (!p->wvp_cached || sceClibMemcmp(p->wvp_cache, mvp_matrix, sizeof(matrix4x4))) {
+				sceGxmSetUniformDataF(p->vert_block.data, p->wvp, 0, 16, (const float *)mvp_matrix);
+				sceClibMemcpy(p->wvp_cache, mvp_matrix, sizeof(matrix4x4));
+				p->wvp_cached = GL_TRUE;
+				p->vert_block.dirty = GL_TRUE;
+			}
+		} else if (p->wvp_cached) {
+			// Restoring the value set by the application
+			sceGxmSetUniformDataF(p->vert_block.data, p->wvp, 0, 16, p->wvp_unif->data);
+			p->wvp_cached = GL_FALSE;
+			p->vert_block.dirty = GL_TRUE;
+		}
+	}
+	vglUploadVertexUniformBlock(&p->vert_block);
+}
+
+static inline void sync_uniform(uniform *u) {
+	// Writing the new value into the flattened blocks, draws upload them with a single copy
+	sceGxmSetUniformDataF(u->block->data, u->ptr, 0, u->size, u->data);
+	u->block->dirty = GL_TRUE;
+	if (u->alias_ptr) {
+		sceGxmSetUniformDataF(u->alias_block->data, u->alias_ptr, 0, u->size, u->data);
+		u->alias_block->dirty = GL_TRUE;
+	}
+	if (u->wvp_cached)
+		*u->wvp_cached = GL_FALSE;
+
+	if (u->is_vertex)
+		dirty_vert_unifs = GL_TRUE;
+	if (u->is_fragment)
+		dirty_frag_unifs = GL_TRUE;
+}
+
 void release_shader(shader *s) {
+	// Dropping any pending background compilation
+	if (s->job) {
+		compile_queue_release(s->job);
+		s->job = NULL;
+	}
+
 	// Deallocating shader and unregistering it from sceGxmShaderPatcher
 	if (s->valid) {
 		sceGxmShaderPatcherForceUnregisterProgram(gxm_shader_patcher, s->id);
@@ -142,6 +218,89 @@ void release_shader(shader *s) {
 	s->dirty = GL_FALSE;
 }
 
+void *get_shader_cache_ident(GLenum type, const void *source, uint32_t size, uint32_t *ident_size) {
+	// Any setting affecting the produced binary followed by the shader source
+	uint32_t settings[5] = {
+		type,
+		compiler_opts,
+		compiler_fastmath,
+		compiler_fastprecision,
+		compiler_fastint
+	};
+	*ident_size = sizeof(settings) + size;
+	uint8_t *res = (uint8_t *)malloc(*ident_size);
+	if (res) {
+		vgl_fast_memcpy(res, settings, sizeof(settings));
+		vgl_fast_memcpy(&res[sizeof(settings)], source, size);
+	}
+	return res;
+}
+
+uint64_t get_shader_cache_key(const void *ident, uint32_t ident_size) {
+	return shader_cache_hash_finalize(shader_cache_hash(ident, ident_size, SHADER_HASH_SEED));
+}
+
+void *shark_compile_job(const char *source, uint32_t size, int type, uint32_t *bin_size) {
+	// Restarting vitaShaRK if we released it before
+	if (!is_shark_online && !startShaderCompiler())
+		return NULL;
+
+	void *res = NULL;
+	*bin_size = size;
+	SceGxmProgram *t = shark_compile_shader_extended(source, bin_size, type, compiler_opts, compiler_fastmath, compiler_fastprecision, compiler_fastint);
+	if (t) {
+		res = malloc(*bin_size);
+		vgl_fast_memcpy(res, t, *bin_size);
+	}
+#ifdef HAVE_SHARK_LOG
+	// Logs are not propagated for shaders compiled in background
+	if (shark_log) {
+		vgl_free(shark_log);
+		shark_log = NULL;
+	}
+#endif
+	shark_clear_output();
+	return res;
+}
+
+void resolve_shader_job(shader *s) {
+	// Waiting for background compilation to finish and registering the resulting program
+	compile_job *job = s->job;
+	s->job = NULL;
+	compile_job_wait(job);
+	if (job->status == COMPILE_JOB_DONE) {
+		GLuint handle = (s - shaders) + 1;
+		glShaderBinary(1, &handle, 0, job->bin, job->bin_size);
+		s->size = job->bin_size;
+#ifndef DISABLE_CUSTOM_SHADER_CACHE
+		// Compiler settings may have changed since submission, in that case the binary identity is unknown
+		uint32_t ident_size;
+		void *ident = get_shader_cache_ident(s->type, job->source, job->size, &ident_size);
+		if (ident && get_shader_cache_key(ident, ident_size) == job->key)
+			shader_cache_store(job->key, ident, ident_size, job->bin, job->bin_size);
+		free(ident);
+#endif
+	}
+	compile_queue_release(job);
+}
+
+void stop_async_shader_compiler(GLboolean resolve) {
+	// Jobs are freed along with the compile queue, so every shader must drop its pending one first
+	for (int i = 0; i < MAX_CUSTOM_SHADERS; i++) {
+		shader *s = &shaders[i];
+		if (!s->job)
+			continue;
+		if (resolve)
+			resolve_shader_job(s);
+		else {
+			compile_queue_release(s->job);
+			s->job = NULL;
+		}
+	}
+	compile_queue_term();
+	async_shader_compiler = GL_FALSE;
+}
+
 float *reserve_attrib_pool(uint8_t count) {
 	float *res = vertex_attrib_pool_ptr;
 	vertex_attrib_pool_ptr += count;
@@ -244,6 +403,8 @@ void resetCustomShaders(void) {
 	// Init custom programs
 	for (i = 0; i < MAX_CUSTOM_PROGRAMS; i++) {
 		progs[i].status = PROG_INVALID;
+		sceClibMemset(&progs[i].vert_patches, 0, sizeof(patch_cache));
+		sceClibMemset(&progs[i].frag_patches, 0, sizeof(patch_cache));
 	}
 
 	vertex_attrib_pool = (float *)gpu_alloc_mapped(DISABLED_ATTRIBS_POOL_SIZE, VGL_MEM_RAM);
@@ -264,13 +425,14 @@ void resetCustomShaders(void) {
 }
 
 GLboolean _glDrawArrays_CustomShadersIMPL(GLsizei count) {
+	PROFILE_ZONE(SHADERS_DRAW_ARRAYS);
 	program *p = &progs[cur_program - 1];
 
 	// Check if a blend info rebuild is required and upload fragment program
 	if ((p->blend_info.raw != blend_info.raw) || (is_fbo_float != p->is_fbo_float)) {
 		p->is_fbo_float = is_fbo_float;
 		p->blend_info.raw = blend_info.raw;
-		rebuild_frag_shader(p->fshader->id, &p->fprog, (SceGxmProgram *)p->vshader->prog, is_fbo_float ? SCE_GXM_OUTPUT_REGISTER_FORMAT_HALF4 : SCE_GXM_OUTPUT_REGISTER_FORMAT_UCHAR4);
+		patch_fragment_program_cached(&p->frag_patches, p->fshader->id, is_fbo_float ? SCE_GXM_OUTPUT_REGISTER_FORMAT_HALF4 : SCE_GXM_OUTPUT_REGISTER_FORMAT_UCHAR4, (SceGxmProgram *)p->vshader->prog, &p->fprog);
 	}
 	sceGxmSetFragmentProgram(gxm_context, p->fprog);
 
@@ -279,7 +441,7 @@ GLboolean _glDrawArrays_CustomShadersIMPL(GLsizei count) {
 #ifndef SAMPLERS_SPEEDHACK
 		if (p->frag_texunits[i]) {
 #endif
-			texture_unit *tex_unit = &texture_units[(int)p->frag_texunits[i]->data];
+			texture_unit *tex_unit = &texture_units[(int)(uintptr_t)p->frag_texunits[i]->data];
 #ifndef SKIP_ERROR_HANDLING
 			int r = sceGxmTextureValidate(&texture_slots[tex_unit->tex_id].gxm_tex);
 			if (r) {
@@ -298,7 +460,7 @@ GLboolean _glDrawArrays_CustomShadersIMPL(GLsizei count) {
 #ifndef SAMPLERS_SPEEDHACK
 		if (p->vert_texunits[i]) {
 #endif
-			texture_unit *tex_unit = &texture_units[(int)p->vert_texunits[i]->data];
+			texture_unit *tex_unit = &texture_units[(int)(uintptr_t)p->vert_texunits[i]->data];
 #ifndef SKIP_ERROR_HANDLING
 			int r = sceGxmTextureValidate(&texture_slots[tex_unit->tex_id].gxm_tex);
 			if (r) {
@@ -344,8 +506,7 @@ GLboolean _glDrawArrays_CustomShadersIMPL(GLsizei count) {
 
 	// Gathering real attribute data pointers
 	if (is_packed) {
-		ptrs[0] = gpu_alloc_mapped_temp(count * streams[0].stride);
-		vgl_fast_memcpy(ptrs[0], (void *)vertex_attrib_offsets[p->attr_map[0]], count * streams[0].stride);
+		ptrs[0] = gpu_stream_client_array((void *)vertex_attrib_offsets[p->attr_map[0]], streams[0].stride, count);
 		for (int i = 0; i < p->attr_num; i++) {
 			attributes[i].regIndex = p->attr[p->attr_map[i]].regIndex;
 			if (vertex_attrib_state & (1 << p->attr_map[i])) {
@@ -361,16 +522,15 @@ GLboolean _glDrawArrays_CustomShadersIMPL(GLsizei count) {
 			attributes[i].regIndex = p->attr[p->attr_map[i]].regIndex;
 			if (vertex_attrib_state & (1 << p->attr_map[i])) {
 				if (vertex_attrib_vbo[p->attr_map[i]]) {
-					gpubuffer *gpu_buf = (gpubuffer *)vertex_attrib_vbo[p->attr_map[i]];
+					gpubuffer *gpu_buf = (gpubuffer *)(uintptr_t)vertex_attrib_vbo[p->attr_map[i]];
 					ptrs[i] = (uint8_t *)gpu_buf->ptr + vertex_attrib_offsets[p->attr_map[i]];
-					gpu_buf->used = GL_TRUE;
+					mark_buffer_used(gpu_buf);
 					attributes[i].offset = 0;
 				} else {
 #ifdef DRAW_SPEEDHACK
 					ptrs[i] = (void *)vertex_attrib_offsets[p->attr_map[i]];
 #else
-					ptrs[i] = gpu_alloc_mapped_temp(count * streams[i].stride);
-					vgl_fast_memcpy(ptrs[i], (void *)vertex_attrib_offsets[p->attr_map[i]], count * streams[i].stride);
+					ptrs[i] = gpu_stream_client_array((void *)vertex_attrib_offsets[p->attr_map[i]], streams[i].stride, count);
 #endif
 					attributes[i].offset = 0;
 				}
@@ -381,35 +541,16 @@ GLboolean _glDrawArrays_CustomShadersIMPL(GLsizei count) {
 	}
 
 	// Uploading new vertex program
-	patchVertexProgram(gxm_shader_patcher, p->vshader->id, attributes, p->attr_num, streams, p->attr_num, &p->vprog);
+	patch_vertex_program_cached(&p->vert_patches, p->vshader->id, attributes, p->attr_num, streams, p->attr_num, &p->vprog);
 	sceGxmSetVertexProgram(gxm_context, p->vprog);
 
 	// Uploading both fragment and vertex uniforms data
-	void *buffer;
 	if (p->vert_uniforms && dirty_vert_unifs) {
-		vglReserveVertexUniformBuffer(p->vshader->prog, &buffer);
-		uniform *u = p->vert_uniforms;
-		while (u) {
-			if (u->ptr == p->wvp) {
-				if (mvp_modified) {
-					matrix4x4_multiply(mvp_matrix, projection_matrix, modelview_matrix);
-					mvp_modified = GL_FALSE;
-				}
-				sceGxmSetUniformDataF(buffer, p->wvp, 0, 16, (const float *)mvp_matrix);
-			} else if (u->size)
-				sceGxmSetUniformDataF(buffer, u->ptr, 0, u->size, u->data);
-			u = (uniform *)u->chain;
-		}
+		upload_vert_uniforms(p, GL_TRUE);
 		dirty_vert_unifs = GL_FALSE;
 	}
 	if (p->frag_uniforms && dirty_frag_unifs) {
-		vglReserveFragmentUniformBuffer(p->fshader->prog, &buffer);
-		uniform *u = p->frag_uniforms;
-		while (u) {
-			if (u->size)
-				sceGxmSetUniformDataF(buffer, u->ptr, 0, u->size, u->data);
-			u = (uniform *)u->chain;
-		}
+		vglUploadFragmentUniformBlock(&p->frag_block);
 		dirty_frag_unifs = GL_FALSE;
 	}
 
@@ -439,13 +580,14 @@ GLboolean _glDrawArrays_CustomShadersIMPL(GLsizei count) {
 }
 
 GLboolean _glDrawElements_CustomShadersIMPL(uint16_t *idx_buf, GLsizei count, GLboolean is_short) {
+	PROFILE_ZONE(SHADERS_DRAW_ELEMENTS);
 	program *p = &progs[cur_program - 1];
 
 	// Check if a blend info rebuild is required and upload fragment program
 	if ((p->blend_info.raw != blend_info.raw) || (is_fbo_float != p->is_fbo_float)) {
 		p->is_fbo_float = is_fbo_float;
 		p->blend_info.raw = blend_info.raw;
-		rebuild_frag_shader(p->fshader->id, &p->fprog, (SceGxmProgram *)p->vshader->prog, is_fbo_float ? SCE_GXM_OUTPUT_REGISTER_FORMAT_HALF4 : SCE_GXM_OUTPUT_REGISTER_FORMAT_UCHAR4);
+		patch_fragment_program_cached(&p->frag_patches, p->fshader->id, is_fbo_float ? SCE_GXM_OUTPUT_REGISTER_FORMAT_HALF4 : SCE_GXM_OUTPUT_REGISTER_FORMAT_UCHAR4, (SceGxmProgram *)p->vshader->prog, &p->fprog);
 	}
 	sceGxmSetFragmentProgram(gxm_context, p->fprog);
 
@@ -454,7 +596,7 @@ GLboolean _glDrawElements_CustomShadersIMPL(uint16_t *idx_buf, GLsizei count, GL
 #ifndef SAMPLERS_SPEEDHACK
 		if (p->frag_texunits[i]) {
 #endif
-			texture_unit *tex_unit = &texture_units[(int)p->frag_texunits[i]->data];
+			texture_unit *tex_unit = &texture_units[(int)(uintptr_t)p->frag_texunits[i]->data];
 #ifndef SKIP_ERROR_HANDLING
 			int r = sceGxmTextureValidate(&texture_slots[tex_unit->tex_id].gxm_tex);
 			if (r) {
@@ -473,7 +615,7 @@ GLboolean _glDrawElements_CustomShadersIMPL(uint16_t *idx_buf, GLsizei count, GL
 #ifndef SAMPLERS_SPEEDHACK
 		if (p->vert_texunits[i]) {
 #endif
-			texture_unit *tex_unit = &texture_units[(int)p->vert_texunits[i]->data];
+			texture_unit *tex_unit = &texture_units[(int)(uintptr_t)p->vert_texunits[i]->data];
 #ifndef SKIP_ERROR_HANDLING
 			int r = sceGxmTextureValidate(&texture_slots[tex_unit->tex_id].gxm_tex);
 			if (r) {
@@ -523,25 +665,14 @@ GLboolean _glDrawElements_CustomShadersIMPL(uint16_t *idx_buf, GLsizei count, GL
 	// Detecting highest index value
 	uint32_t top_idx = 0;
 	if (!is_full_vbo) {
-		if (is_short) {
-			for (int i = 0; i < count; i++) {
-				if (idx_buf[i] > top_idx)
-					top_idx = idx_buf[i];
-			}
-		} else {
-			uint32_t *_idx_buf = (uint32_t *)idx_buf;
-			for (int i = 0; i < count; i++) {
-				if (_idx_buf[i] > top_idx)
-					top_idx = _idx_buf[i];
-			}
-		}
+		uint32_t bottom_idx;
+		get_index_range(idx_buf, count, is_short, &bottom_idx, &top_idx);
 		top_idx++;
 	}
 
 	// Gathering real attribute data pointers
 	if (is_packed) {
-		ptrs[0] = gpu_alloc_mapped_temp(top_idx * streams[0].stride);
-		vgl_fast_memcpy(ptrs[0], (void *)vertex_attrib_offsets[p->attr_map[0]], top_idx * streams[0].stride);
+		ptrs[0] = gpu_stream_client_array((void *)vertex_attrib_offsets[p->attr_map[0]], streams[0].stride, top_idx);
 		for (int i = 0; i < p->attr_num; i++) {
 			attributes[i].regIndex = p->attr[p->attr_map[i]].regIndex;
 			if (vertex_attrib_state & (1 << p->attr_map[i])) {
@@ -557,16 +688,15 @@ GLboolean _glDrawElements_CustomShadersIMPL(uint16_t *idx_buf, GLsizei count, GL
 			attributes[i].regIndex = p->attr[p->attr_map[i]].regIndex;
 			if (vertex_attrib_state & (1 << p->attr_map[i])) {
 				if (vertex_attrib_vbo[p->attr_map[i]]) {
-					gpubuffer *gpu_buf = (gpubuffer *)vertex_attrib_vbo[p->attr_map[i]];
+					gpubuffer *gpu_buf = (gpubuffer *)(uintptr_t)vertex_attrib_vbo[p->attr_map[i]];
 					ptrs[i] = (uint8_t *)gpu_buf->ptr + vertex_attrib_offsets[p->attr_map[i]];
-					gpu_buf->used = GL_TRUE;
+					mark_buffer_used(gpu_buf);
 					attributes[i].offset = 0;
 				} else {
 #ifdef DRAW_SPEEDHACK
 					ptrs[i] = (void *)vertex_attrib_offsets[p->attr_map[i]];
 #else
-					ptrs[i] = gpu_alloc_mapped_temp(top_idx * streams[i].stride);
-					vgl_fast_memcpy(ptrs[i], (void *)vertex_attrib_offsets[p->attr_map[i]], top_idx * streams[i].stride);
+					ptrs[i] = gpu_stream_client_array((void *)vertex_attrib_offsets[p->attr_map[i]], streams[i].stride, top_idx);
 #endif
 					attributes[i].offset = 0;
 				}
@@ -577,35 +707,16 @@ GLboolean _glDrawElements_CustomShadersIMPL(uint16_t *idx_buf, GLsizei count, GL
 	}
 
 	// Uploading new vertex program
-	patchVertexProgram(gxm_shader_patcher, p->vshader->id, attributes, p->attr_num, streams, p->attr_num, &p->vprog);
+	patch_vertex_program_cached(&p->vert_patches, p->vshader->id, attributes, p->attr_num, streams, p->attr_num, &p->vprog);
 	sceGxmSetVertexProgram(gxm_context, p->vprog);
 
 	// Uploading both fragment and vertex uniforms data
-	void *buffer;
 	if (p->vert_uniforms && dirty_vert_unifs) {
-		vglReserveVertexUniformBuffer(p->vshader->prog, &buffer);
-		uniform *u = p->vert_uniforms;
-		while (u) {
-			if (u->ptr == p->wvp) {
-				if (mvp_modified) {
-					matrix4x4_multiply(mvp_matrix, projection_matrix, modelview_matrix);
-					mvp_modified = GL_FALSE;
-				}
-				sceGxmSetUniformDataF(buffer, p->wvp, 0, 16, (const float *)mvp_matrix);
-			} else if (u->size)
-				sceGxmSetUniformDataF(buffer, u->ptr, 0, u->size, u->data);
-			u = (uniform *)u->chain;
-		}
+		upload_vert_uniforms(p, GL_TRUE);
 		dirty_vert_unifs = GL_FALSE;
 	}
 	if (p->frag_uniforms && dirty_frag_unifs) {
-		vglReserveFragmentUniformBuffer(p->fshader->prog, &buffer);
-		uniform *u = p->frag_uniforms;
-		while (u) {
-			if (u->size)
-				sceGxmSetUniformDataF(buffer, u->ptr, 0, u->size, u->data);
-			u = (uniform *)u->chain;
-		}
+		vglUploadFragmentUniformBlock(&p->frag_block);
 		dirty_frag_unifs = GL_FALSE;
 	}
 
@@ -635,13 +746,14 @@ GLboolean _glDrawElements_CustomShadersIMPL(uint16_t *idx_buf, GLsizei count, GL
 }
 
 void _vglDrawObjects_CustomShadersIMPL(GLboolean implicit_wvp) {
+	PROFILE_ZONE(SHADERS_DRAW_OBJECTS);
 	program *p = &progs[cur_program - 1];
 
 	// Check if a blend info rebuild is required
 	if ((p->blend_info.raw != blend_info.raw) || (is_fbo_float != p->is_fbo_float)) {
 		p->is_fbo_float = is_fbo_float;
 		p->blend_info.raw = blend_info.raw;
-		rebuild_frag_shader(p->fshader->id, &p->fprog, (SceGxmProgram *)p->vshader->prog, is_fbo_float ? SCE_GXM_OUTPUT_REGISTER_FORMAT_HALF4 : SCE_GXM_OUTPUT_REGISTER_FORMAT_UCHAR4);
+		patch_fragment_program_cached(&p->frag_patches, p->fshader->id, is_fbo_float ? SCE_GXM_OUTPUT_REGISTER_FORMAT_HALF4 : SCE_GXM_OUTPUT_REGISTER_FORMAT_UCHAR4, (SceGxmProgram *)p->vshader->prog, &p->fprog);
 	}
 
 	// Setting up required shader
@@ -649,31 +761,12 @@ void _vglDrawObjects_CustomShadersIMPL(GLboolean implicit_wvp) {
 	sceGxmSetFragmentProgram(gxm_context, p->fprog);
 
 	// Uploading both fragment and vertex uniforms data
-	void *buffer;
 	if (p->vert_uniforms && (dirty_vert_unifs || mvp_modified)) {
-		vglReserveVertexUniformBuffer(p->vshader->prog, &buffer);
-		uniform *u = p->vert_uniforms;
-		while (u) {
-			if (u->ptr == p->wvp && implicit_wvp) {
-				if (mvp_modified) {
-					matrix4x4_multiply(mvp_matrix, projection_matrix, modelview_matrix);
-					mvp_modified = GL_FALSE;
-				}
-				sceGxmSetUniformDataF(buffer, p->wvp, 0, 16, (const float *)mvp_matrix);
-			} else if (u->size)
-				sceGxmSetUniformDataF(buffer, u->ptr, 0, u->size, u->data);
-			u = (uniform *)u->chain;
-		}
+		upload_vert_uniforms(p, implicit_wvp);
 		dirty_vert_unifs = GL_FALSE;
 	}
 	if (p->frag_uniforms && dirty_frag_unifs) {
-		vglReserveFragmentUniformBuffer(p->fshader->prog, &buffer);
-		uniform *u = p->frag_uniforms;
-		while (u) {
-			if (u->size)
-				sceGxmSetUniformDataF(buffer, u->ptr, 0, u->size, u->data);
-			u = (uniform *)u->chain;
-		}
+		vglUploadFragmentUniformBlock(&p->frag_block);
 		dirty_frag_unifs = GL_FALSE;
 	}
 
@@ -737,12 +830,11 @@ void shark_log_cb(const char *msg, shark_log_level msg_level, int line) {
 }
 #endif
 
-float *getUniformAliasDataPtr(uniform *u, const char *name, uint32_t size) {
-	int i;
+uniform *getUniformAlias(uniform *u, const char *name, uint32_t size) {
 	while (u) {
 		if (size == u->size) {
 			if (!strcmp(name, sceGxmProgramParameterGetName(u->ptr))) {
-				return u->data;
+				return u;
 			}
 		}
 		u = u->chain;
@@ -762,6 +854,39 @@ void vglSetupRuntimeShaderCompiler(shark_opt opt_level, int32_t use_fastmath, in
 	compiler_fastint = use_fastint;
 }
 
+void vglSetupAsyncShaderCompiler(GLboolean enable, vglAsyncFallback fallback, int priority, int affinity) {
+	if (enable) {
+		// vitaShaRK is not reentrant, so a single worker is used and compilations are serialized
+		async_shader_compiler = compile_queue_init(shark_compile_job, GL_FALSE, 1, priority, affinity);
+	} else {
+		stop_async_shader_compiler(GL_TRUE);
+	}
+	async_fallback_mode = fallback;
+}
+
+void vglSetShaderCacheSize(uint32_t size) {
+#ifndef DISABLE_CUSTOM_SHADER_CACHE
+	shader_cache_max_size = size;
+	shader_cache_set_max_size(size);
+#endif
+}
+
+void vglGetShaderCacheStats(vglShaderCacheStats *stats) {
+#ifndef DISABLE_CUSTOM_SHADER_CACHE
+	shader_cache_stats res;
+	shader_cache_get_stats(&res);
+	stats->hits = res.hits;
+	stats->misses = res.misses;
+	stats->corrupted = res.corrupted;
+	stats->collisions = res.collisions;
+	stats->evictions = res.evictions;
+	stats->entries = res.entries;
+	stats->size = res.size;
+#else
+	sceClibMemset(stats, 0, sizeof(vglShaderCacheStats));
+#endif
+}
+
 GLuint glCreateShader(GLenum shaderType) {
 	// Looking for a free shader slot
 	GLuint i, res = 0;
@@ -803,8 +928,13 @@ void glGetShaderiv(GLuint handle, GLenum pname, GLint *params) {
 		*params = s->type;
 		break;
 	case GL_COMPILE_STATUS:
+		if (s->job)
+			resolve_shader_job(s);
 		*params = s->prog ? GL_TRUE : GL_FALSE;
 		break;
+	case GL_COMPLETION_STATUS_KHR:
+		*params = (!s->job || compile_job_is_complete(s->job)) ? GL_TRUE : GL_FALSE;
+		break;
 	case GL_DELETE_STATUS:
 		*params = s->dirty ? GL_TRUE : GL_FALSE;
 		break;
@@ -909,15 +1039,70 @@ void glShaderBinary(GLsizei count, const GLuint *handles, GLenum binaryFormat, c
 }
 
 void glCompileShader(GLuint handle) {
-	// If vitaShaRK is not enabled, we try to initialize it
+	// Grabbing passed shader
+	shader *s = &shaders[handle - 1];
+
+	// Dropping any previous background compilation for this shader
+	if (s->job) {
+		compile_queue_release(s->job);
+		s->job = NULL;
+	}
+	uint32_t ident_size;
+	void *ident = get_shader_cache_ident(s->type, s->prog, s->size, &ident_size);
+	uint64_t key = ident ? get_shader_cache_key(ident, ident_size) : 0;
+
+#ifndef DISABLE_CUSTOM_SHADER_CACHE
+	// Indexing custom shaders cache on first usage
+	if (!is_shader_cache_online) {
+		uint32_t version = shader_cache_hash_finalize(shader_cache_hash(VGL_BUILD_ID, strlen(VGL_BUILD_ID), SHADER_HASH_SEED));
+		shader_cache_init(shader_cache_stdio_backend(CUSTOM_SHADER_CACHE_PATH), shader_cache_max_size, version);
+		is_shader_cache_online = GL_TRUE;
+	}
+
+	// Looking for an already compiled binary in the shader cache
+	uint32_t bin_size;
+	void *bin = ident ? shader_cache_load(key, ident, ident_size, &bin_size) : NULL;
+	if (bin) {
+		free(ident);
+		if (s->source) {
+			vgl_free(s->source);
+			s->source = NULL;
+		}
+		glShaderBinary(1, &handle, 0, bin, bin_size);
+		s->size = bin_size;
+		free(bin);
+#ifdef HAVE_SHARK_LOG
+		if (s->log) {
+			vgl_free(s->log);
+			s->log = NULL;
+		}
+#endif
+		return;
+	}
+#endif
+
+	// If vitaShaRK is not enabled, we try to initialize it (cache hits never need it)
 	if (!is_shark_online && !startShaderCompiler()) {
+		free(ident);
 		SET_GL_ERROR(GL_INVALID_OPERATION)
 	}
 
-	// Grabbing passed shader
-	shader *s = &shaders[handle - 1];
+	// Enqueueing shader source to the background compiler
+	if (async_shader_compiler) {
+		s->job = compile_queue_submit(key, s->type == GL_FRAGMENT_SHADER ? SHARK_FRAGMENT_SHADER : SHARK_VERTEX_SHADER, (const char *)s->prog, s->size);
+		if (s->job) {
+			free(ident);
+			if (s->source) {
+				vgl_free(s->source);
+				s->source = NULL;
+			}
+			s->prog = NULL;
+			return;
+		}
+	}
 
 	// Compiling shader source
+	compile_lock();
 	s->prog = shark_compile_shader_extended((const char *)s->prog, &s->size, s->type == GL_FRAGMENT_SHADER ? SHARK_FRAGMENT_SHADER : SHARK_VERTEX_SHADER, compiler_opts, compiler_fastmath, compiler_fastprecision, compiler_fastint);
 	if (s->prog) {
 		if (s->source) {
@@ -926,6 +1111,10 @@ void glCompileShader(GLuint handle) {
 		}
 		SceGxmProgram *res = (SceGxmProgram *)vglMalloc(s->size);
 		vgl_fast_memcpy((void *)res, (void *)s->prog, s->size);
+#ifndef DISABLE_CUSTOM_SHADER_CACHE
+		if (ident)
+			shader_cache_store(key, ident, ident_size, res, s->size);
+#endif
 #ifdef LOG_ERRORS
 		int r =
 #endif
@@ -943,6 +1132,8 @@ void glCompileShader(GLuint handle) {
 	shark_log = NULL;
 #endif
 	shark_clear_output();
+	compile_unlock();
+	free(ident);
 }
 
 void glDeleteShader(GLuint shad) {
@@ -1033,6 +1224,8 @@ GLuint glCreateProgram(void) {
 			progs[i].fshader = NULL;
 			progs[i].vert_uniforms = NULL;
 			progs[i].frag_uniforms = NULL;
+			progs[i].wvp_unif = NULL;
+			progs[i].wvp_cached = GL_FALSE;
 			progs[i].attr_highest_idx = 0;
 			progs[i].is_fbo_float = 0xFF;
 			for (j = 0; j < VERTEX_ATTRIBS_NUM; j++) {
@@ -1117,12 +1310,7 @@ void glDeleteProgram(GLuint prog) {
 
 	// Releasing both vertex and fragment programs from sceGxmShaderPatcher
 	if (p->status) {
-		unsigned int count, i;
-		sceGxmShaderPatcherGetFragmentProgramRefCount(gxm_shader_patcher, p->fprog, &count);
-		for (i = 0; i < count; i++) {
-			sceGxmShaderPatcherReleaseFragmentProgram(gxm_shader_patcher, p->fprog);
-			sceGxmShaderPatcherReleaseVertexProgram(gxm_shader_patcher, p->vprog);
-		}
+		release_patched_programs(&p->vert_patches, &p->frag_patches);
 		while (p->vert_uniforms) {
 			uniform *old = p->vert_uniforms;
 			p->vert_uniforms = (uniform *)p->vert_uniforms->chain;
@@ -1143,6 +1331,8 @@ void glDeleteProgram(GLuint prog) {
 				vgl_free(old->data);
 			vgl_free(old);
 		}
+		uniform_block_term(&p->vert_block);
+		uniform_block_term(&p->frag_block);
 		
 		// Checking if attached shaders are marked for deletion and should be deleted
 		if (p->vshader) {
@@ -1175,6 +1365,13 @@ void glGetProgramiv(GLuint progr, GLenum pname, GLint *params) {
 	case GL_LINK_STATUS:
 		*params = p->status == PROG_LINKED;
 		break;
+	case GL_COMPLETION_STATUS_KHR:
+		*params = GL_TRUE;
+		if (p->vshader && p->vshader->job && !compile_job_is_complete(p->vshader->job))
+			*params = GL_FALSE;
+		if (p->fshader && p->fshader->job && !compile_job_is_complete(p->fshader->job))
+			*params = GL_FALSE;
+		break;
 	case GL_INFO_LOG_LENGTH:
 		*params = 0;
 		break;
@@ -1245,12 +1442,21 @@ void glGetProgramiv(GLuint progr, GLenum pname, GLint *params) {
 void glLinkProgram(GLuint progr) {
 	// Grabbing passed program
 	program *p = &progs[progr - 1];
+
+	// Waiting for any shader being compiled in background
+	if (p->vshader->job)
+		resolve_shader_job(p->vshader);
+	if (p->fshader->job)
+		resolve_shader_job(p->fshader);
 #ifndef SKIP_ERROR_HANDLING
 	if (!p->fshader->prog || !p->vshader->prog)
 		return;
 #endif
 	p->status = PROG_LINKED;
 
+	// Releasing any patched program from a previous link
+	release_patched_programs(&p->vert_patches, &p->frag_patches);
+
 	// Analyzing fragment shader
 	uint32_t i, cnt;
 	for (i = 0; i < TEXTURE_IMAGE_UNITS_NUM; i++) {
@@ -1270,6 +1476,9 @@ void glLinkProgram(GLuint progr) {
 			u->ptr = param;
 			u->size = 0;
 			u->data = NULL;
+			u->block = NULL;
+			u->alias_ptr = NULL;
+			u->wvp_cached = NULL;
 			p->frag_uniforms = u;
 			p->frag_texunits[texunit_idx - 1] = u;
 		} else if (cat == SCE_GXM_PARAMETER_CATEGORY_UNIFORM) {
@@ -1281,11 +1490,15 @@ void glLinkProgram(GLuint progr) {
 			u->size = sceGxmProgramParameterGetComponentCount(param) * sceGxmProgramParameterGetArraySize(param);
 			u->data = (float *)vglMalloc(u->size * sizeof(float));
 			sceClibMemset(u->data, 0, u->size * sizeof(float));
+			u->block = &p->frag_block;
+			u->alias_ptr = NULL;
+			u->wvp_cached = NULL;
 			p->frag_uniforms = u;
 		}
 	}
 
 	// Analyzing vertex shader
+	p->wvp_unif = NULL;
 	p->wvp = sceGxmProgramFindParameterByName(p->vshader->prog, "wvp");
 	if (!p->wvp) // Allow to use gl_ModelViewProjectionMatrix binding
 		p->wvp = sceGxmProgramFindParameterByName(p->vshader->prog, "gl_ModelViewProjectionMatrix");
@@ -1304,6 +1517,9 @@ void glLinkProgram(GLuint progr) {
 			u->ptr = param;
 			u->size = 0;
 			u->data = NULL;
+			u->block = NULL;
+			u->alias_ptr = NULL;
+			u->wvp_cached = NULL;
 			p->vert_uniforms = u;
 			p->vert_texunits[texunit_idx - 1] = u;
 		} else if (cat == SCE_GXM_PARAMETER_CATEGORY_UNIFORM) {
@@ -1312,26 +1528,41 @@ void glLinkProgram(GLuint progr) {
 			u->ptr = param;
 			u->is_vertex = GL_TRUE;
 			u->size = sceGxmProgramParameterGetComponentCount(param) * sceGxmProgramParameterGetArraySize(param);
-			u->data = getUniformAliasDataPtr(p->frag_uniforms, sceGxmProgramParameterGetName(param), u->size);
-			if (u->data) {
+			u->block = &p->vert_block;
+			u->wvp_cached = NULL;
+			uniform *alias = getUniformAlias(p->frag_uniforms, sceGxmProgramParameterGetName(param), u->size);
+			if (alias) {
 				u->is_fragment = GL_TRUE;
+				u->data = alias->data;
+				u->alias_ptr = alias->ptr;
+				u->alias_block = &p->frag_block;
 			} else {
 				u->is_fragment = GL_FALSE;
 				u->data = (float *)vglMalloc(u->size * sizeof(float));
 				sceClibMemset(u->data, 0, u->size * sizeof(float));
+				u->alias_ptr = NULL;
+			}
+			if (param == p->wvp) {
+				u->wvp_cached = &p->wvp_cached;
+				p->wvp_unif = u;
 			}
 			p->vert_uniforms = u;
 		}
 	}
 
+	// Allocating flattened uniform blocks, zero filled as the uniforms values
+	uniform_block_term(&p->vert_block);
+	uniform_block_term(&p->frag_block);
+	uniform_block_init(&p->vert_block, sceGxmProgramGetDefaultUniformBufferSize(p->vshader->prog));
+	uniform_block_init(&p->frag_block, sceGxmProgramGetDefaultUniformBufferSize(p->fshader->prog));
+	p->wvp_cached = GL_FALSE;
+
 	// Creating fragment and vertex program via sceGxmShaderPatcher if using vgl* draw pipeline
 	if (p->stream_num) {
 		if (p->stream_num > 1)
 			p->stream_num = p->attr_num;
-		patchVertexProgram(gxm_shader_patcher,
-			p->vshader->id, p->attr, p->attr_num,
-			p->stream, p->stream_num, &p->vprog);
-		rebuild_frag_shader(p->fshader->id, &p->fprog, NULL, is_fbo_float ? SCE_GXM_OUTPUT_REGISTER_FORMAT_HALF4 : SCE_GXM_OUTPUT_REGISTER_FORMAT_UCHAR4);
+		patch_vertex_program_cached(&p->vert_patches, p->vshader->id, p->attr, p->attr_num, p->stream, p->stream_num, &p->vprog);
+		patch_fragment_program_cached(&p->frag_patches, p->fshader->id, is_fbo_float ? SCE_GXM_OUTPUT_REGISTER_FORMAT_HALF4 : SCE_GXM_OUTPUT_REGISTER_FORMAT_UCHAR4, NULL, &p->fprog);
 		p->is_fbo_float = is_fbo_float;
 
 		// Populating current blend settings
@@ -1387,7 +1618,7 @@ GLint glGetUniformLocation(GLuint prog, const GLchar *name) {
 	// Getting the desired location
 	while (j) {
 		if (j->ptr == u)
-			return -((GLint)j);
+			return -((GLint)(uintptr_t)j);
 		j = j->chain;
 	}
 
@@ -1400,18 +1631,15 @@ void glUniform1i(GLint location, GLint v0) {
 		return;
 
 	// Grabbing passed uniform
-	uniform *u = (uniform *)-location;
+	uniform *u = (uniform *)(uintptr_t)-location;
 
 	// Setting passed value to desired uniform
 	if (u->size == 0) // Sampler
-		u->data = (float *)v0;
-	else // Regular Uniform
+		u->data = (float *)(uintptr_t)v0;
+	else { // Regular Uniform
 		u->data[0] = (float)v0;
-
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+		sync_uniform(u);
+	}
 }
 
 void glUniform1iv(GLint location, GLsizei count, const GLint *value) {
@@ -1420,7 +1648,7 @@ void glUniform1iv(GLint location, GLsizei count, const GLint *value) {
 		return;
 
 	// Grabbing passed uniform
-	uniform *u = (uniform *)-location;
+	uniform *u = (uniform *)(uintptr_t)-location;
 
 	// Setting passed value to desired uniform
 	int i;
@@ -1428,10 +1656,7 @@ void glUniform1iv(GLint location, GLsizei count, const GLint *value) {
 		u->data[i] = (float)value[i];
 	}
 
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+	sync_uniform(u);
 }
 
 void glUniform1f(GLint location, GLfloat v0) {
@@ -1440,15 +1665,12 @@ void glUniform1f(GLint location, GLfloat v0) {
 		return;
 
 	// Grabbing passed uniform
-	uniform *u = (uniform *)-location;
+	uniform *u = (uniform *)(uintptr_t)-location;
 
 	// Setting passed value to desired uniform
 	u->data[0] = v0;
 
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+	sync_uniform(u);
 }
 
 void glUniform1fv(GLint location, GLsizei count, const GLfloat *value) {
@@ -1457,15 +1679,12 @@ void glUniform1fv(GLint location, GLsizei count, const GLfloat *value) {
 		return;
 
 	// Grabbing passed uniform
-	uniform *u = (uniform *)-location;
+	uniform *u = (uniform *)(uintptr_t)-location;
 
 	// Setting passed value to desired uniform
 	vgl_fast_memcpy(u->data, value, count * sizeof(float));
 
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+	sync_uniform(u);
 }
 
 void glUniform2i(GLint location, GLint v0, GLint v1) {
@@ -1474,16 +1693,13 @@ void glUniform2i(GLint location, GLint v0, GLint v1) {
 		return;
 
 	// Grabbing passed uniform
-	uniform *u = (uniform *)-location;
+	uniform *u = (uniform *)(uintptr_t)-location;
 
 	// Setting passed value to desired uniform
 	u->data[0] = (float)v0;
 	u->data[1] = (float)v1;
 
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+	sync_uniform(u);
 }
 
 void glUniform2iv(GLint location, GLsizei count, const GLint *value) {
@@ -1492,7 +1708,7 @@ void glUniform2iv(GLint location, GLsizei count, const GLint *value) {
 		return;
 
 	// Grabbing passed uniform
-	uniform *u = (uniform *)-location;
+	uniform *u = (uniform *)(uintptr_t)-location;
 
 	// Setting passed value to desired uniform
 	int i;
@@ -1500,10 +1716,7 @@ void glUniform2iv(GLint location, GLsizei count, const GLint *value) {
 		u->data[i] = (float)value[i];
 	}
 
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+	sync_uniform(u);
 }
 
 void glUniform2f(GLint location, GLfloat v0, GLfloat v1) {
@@ -1512,16 +1725,13 @@ void glUniform2f(GLint location, GLfloat v0, GLfloat v1) {
 		return;
 
 	// Grabbing passed uniform
-	uniform *u = (uniform *)-location;
+	uniform *u = (uniform *)(uintptr_t)-location;
 
 	// Setting passed value to desired uniform
 	u->data[0] = v0;
 	u->data[1] = v1;
 
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+	sync_uniform(u);
 }
 
 void glUniform2fv(GLint location, GLsizei count, const GLfloat *value) {
@@ -1530,15 +1740,12 @@ void glUniform2fv(GLint location, GLsizei count, const GLfloat *value) {
 		return;
 
 	// Grabbing passed uniform
-	uniform *u = (uniform *)-location;
+	uniform *u = (uniform *)(uintptr_t)-location;
 
 	// Setting passed value to desired uniform
 	vgl_fast_memcpy(u->data, value, count * 2 * sizeof(float));
 
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+	sync_uniform(u);
 }
 
 void glUniform3i(GLint location, GLint v0, GLint v1, GLint v2) {
@@ -1547,17 +1754,14 @@ void glUniform3i(GLint location, GLint v0, GLint v1, GLint v2) {
 		return;
 
 	// Grabbing passed uniform
-	uniform *u = (uniform *)-location;
+	uniform *u = (uniform *)(uintptr_t)-location;
 
 	// Setting passed value to desired uniform
 	u->data[0] = (float)v0;
 	u->data[1] = (float)v1;
 	u->data[2] = (float)v2;
 
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+	sync_uniform(u);
 }
 
 void glUniform3iv(GLint location, GLsizei count, const GLint *value) {
@@ -1566,7 +1770,7 @@ void glUniform3iv(GLint location, GLsizei count, const GLint *value) {
 		return;
 
 	// Grabbing passed uniform
-	uniform *u = (uniform *)-location;
+	uniform *u = (uniform *)(uintptr_t)-location;
 
 	// Setting passed value to desired uniform
 	int i;
@@ -1574,10 +1778,7 @@ void glUniform3iv(GLint location, GLsizei count, const GLint *value) {
 		u->data[i] = (float)value[i];
 	}
 
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+	sync_uniform(u);
 }
 
 void glUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2) {
@@ -1586,17 +1787,14 @@ void glUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2) {
 		return;
 
 	// Grabbing passed uniform
-	uniform *u = (uniform *)-location;
+	uniform *u = (uniform *)(uintptr_t)-location;
 
 	// Setting passed value to desired uniform
 	u->data[0] = v0;
 	u->data[1] = v1;
 	u->data[2] = v2;
 
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+	sync_uniform(u);
 }
 
 void glUniform3fv(GLint location, GLsizei count, const GLfloat *value) {
@@ -1605,15 +1803,12 @@ void glUniform3fv(GLint location, GLsizei count, const GLfloat *value) {
 		return;
 
 	// Grabbing passed uniform
-	uniform *u = (uniform *)-location;
+	uniform *u = (uniform *)(uintptr_t)-location;
 
 	// Setting passed value to desired uniform
 	vgl_fast_memcpy(u->data, value, count * 3 * sizeof(float));
 
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+	sync_uniform(u);
 }
 
 void glUniform4i(GLint location, GLint v0, GLint v1, GLint v2, GLint v3) {
@@ -1622,7 +1817,7 @@ void glUniform4i(GLint location, GLint v0, GLint v1, GLint v2, GLint v3) {
 		return;
 
 	// Grabbing passed uniform
-	uniform *u = (uniform *)-location;
+	uniform *u = (uniform *)(uintptr_t)-location;
 
 	// Setting passed value to desired uniform
 	u->data[0] = (float)v0;
@@ -1630,10 +1825,7 @@ void glUniform4i(GLint location, GLint v0, GLint v1, GLint v2, GLint v3) {
 	u->data[2] = (float)v2;
 	u->data[3] = (float)v3;
 
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+	sync_uniform(u);
 }
 
 void glUniform4iv(GLint location, GLsizei count, const GLint *value) {
@@ -1642,7 +1834,7 @@ void glUniform4iv(GLint location, GLsizei count, const GLint *value) {
 		return;
 
 	// Grabbing passed uniform
-	uniform *u = (uniform *)-location;
+	uniform *u = (uniform *)(uintptr_t)-location;
 
 	// Setting passed value to desired uniform
 	int i;
@@ -1650,10 +1842,7 @@ void glUniform4iv(GLint location, GLsizei count, const GLint *value) {
 		u->data[i] = (float)value[i];
 	}
 
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+	sync_uniform(u);
 }
 
 void glUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) {
@@ -1662,7 +1851,7 @@ void glUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
 		return;
 
 	// Grabbing passed uniform
-	uniform *u = (uniform *)-location;
+	uniform *u = (uniform *)(uintptr_t)-location;
 
 	// Setting passed value to desired uniform
 	u->data[0] = v0;
@@ -1670,10 +1859,7 @@ void glUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
 	u->data[2] = v2;
 	u->data[3] = v3;
 
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+	sync_uniform(u);
 }
 
 void glUniform4fv(GLint location, GLsizei count, const GLfloat *value) {
@@ -1682,15 +1868,12 @@ void glUniform4fv(GLint location, GLsizei count, const GLfloat *value) {
 		return;
 
 	// Grabbing passed uniform
-	uniform *u = (uniform *)-location;
+	uniform *u = (uniform *)(uintptr_t)-location;
 
 	// Setting passed value to desired uniform
 	vgl_fast_memcpy(u->data, value, count * 4 * sizeof(float));
 
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+	sync_uniform(u);
 }
 
 void glUniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value) {
@@ -1699,20 +1882,17 @@ void glUniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, cons
 		return;
 
 	// Grabbing passed uniform
-	uniform *u = (uniform *)-location;
+	uniform *u = (uniform *)(uintptr_t)-location;
 
 	// Setting passed value to desired uniform
 	if (transpose) {
 		for (int i = 0; i < count; i++) {
-			matrix2x2_transpose(&u->data[i * 4], &value[i * 4]);
+			matrix2x2_transpose((float (*)[2])&u->data[i * 4], (const float (*)[2])&value[i * 4]);
 		}
 	} else
 		vgl_fast_memcpy(u->data, value, count * 4 * sizeof(float));
 
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+	sync_uniform(u);
 }
 
 void glUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value) {
@@ -1721,20 +1901,17 @@ void glUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, cons
 		return;
 
 	// Grabbing passed uniform
-	uniform *u = (uniform *)-location;
+	uniform *u = (uniform *)(uintptr_t)-location;
 
 	// Setting passed value to desired uniform
 	if (transpose) {
 		for (int i = 0; i < count; i++) {
-			matrix3x3_transpose(&u->data[i * 9], &value[i * 9]);
+			matrix3x3_transpose((float (*)[3])&u->data[i * 9], (const float (*)[3])&value[i * 9]);
 		}
 	} else
 		vgl_fast_memcpy(u->data, value, count * 9 * sizeof(float));
 
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+	sync_uniform(u);
 }
 
 void glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value) {
@@ -1743,20 +1920,17 @@ void glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, cons
 		return;
 
 	// Grabbing passed uniform
-	uniform *u = (uniform *)-location;
+	uniform *u = (uniform *)(uintptr_t)-location;
 
 	// Setting passed value to desired uniform
 	if (transpose) {
 		for (int i = 0; i < count; i++) {
-			matrix4x4_transpose(&u->data[i * 16], &value[i * 16]);
+			matrix4x4_transpose((float (*)[4])&u->data[i * 16], (const float (*)[4])&value[i * 16]);
 		}
 	} else
 		vgl_fast_memcpy(u->data, value, count * 16 * sizeof(float));
 
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+	sync_uniform(u);
 }
 
 void glEnableVertexAttribArray(GLuint index) {
@@ -1795,7 +1969,7 @@ void glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean norm
 	}
 #endif
 
-	vertex_attrib_offsets[index] = (uint32_t)pointer;
+	vertex_attrib_offsets[index] = (uintptr_t)pointer;
 	vertex_attrib_vbo[index] = vertex_array_unit;
 
 	SceGxmVertexAttribute *attributes = &vertex_attrib_config[index];
@@ -2254,6 +2428,8 @@ void vglGetShaderBinary(GLuint handle, GLsizei bufSize, GLsizei *length, void *b
 
 	// Grabbing passed shader
 	shader *s = &shaders[handle - 1];
+	if (s->job)
+		resolve_shader_job(s);
 	
 	GLsizei size = 0;
 	if (s->prog) {
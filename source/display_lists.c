@@ -29,215 +29,291 @@ display_list *curr_display_list = NULL;
 GLboolean display_list_execute;
 display_list display_lists[NUM_DISPLAY_LISTS];
 
+// Attribute classes tracked by the display lists optimizer
+enum {
+	ATTRIB_CLASS_COLOR,
+	ATTRIB_CLASS_NORMAL,
+	ATTRIB_CLASS_TEX0,
+	ATTRIB_CLASS_TEX1
+};
+
+// Immediate mode primitive baked into a vertex buffer, stored as a DLIST_OP_HOOK op
+typedef struct {
+	dlist_op hdr;
+	uint32_t offset; // Offset of the vertices in the list's baked vertex buffer
+	uint32_t vertex_count;
+	GLenum mode;
+	uint32_t layout; // Vertex layout the primitive has been baked with
+	uint32_t fallback; // Offset of the original calls, replayed when the layout is not the expected one
+} baked_prim;
+
+// DLIST_OP_JUMP op
+typedef struct {
+	dlist_op hdr;
+	uint32_t target;
+} jump_op;
+
+static uint8_t get_op_flags(void (*func)(), const uint8_t *args) {
+	// Vertices emission
+	if (func == (void (*)())glVertex3f || func == (void (*)())glVertex3fv || func == (void (*)())glVertex3i ||
+		func == (void (*)())glVertex2f || func == (void (*)())glVertex2i)
+		return DLIST_FLAG_VERTEX;
+	if (func == (void (*)())glBegin)
+		return DLIST_FLAG_BEGIN;
+	if (func == (void (*)())glEnd)
+		return DLIST_FLAG_END;
+
+	// Current vertex attributes
+	if (func == (void (*)())glColor3f || func == (void (*)())glColor3fv || func == (void (*)())glColor3ub ||
+		func == (void (*)())glColor3ubv || func == (void (*)())glColor4f || func == (void (*)())glColor4fv ||
+		func == (void (*)())glColor4ub || func == (void (*)())glColor4ubv || func == (void (*)())glColor4x)
+		return DLIST_FLAG_ATTRIB_CLASS(ATTRIB_CLASS_COLOR);
+	if (func == (void (*)())glNormal3f || func == (void (*)())glNormal3fv)
+		return DLIST_FLAG_ATTRIB_CLASS(ATTRIB_CLASS_NORMAL);
+	if (func == (void (*)())glTexCoord2f)
+		return DLIST_FLAG_ATTRIB_CLASS(ATTRIB_CLASS_TEX0);
+	if (func == (void (*)())glMultiTexCoord2f) {
+		switch (*(uint32_t *)args) {
+		case GL_TEXTURE0:
+			return DLIST_FLAG_ATTRIB_CLASS(ATTRIB_CLASS_TEX0);
+		case GL_TEXTURE1:
+			return DLIST_FLAG_ATTRIB_CLASS(ATTRIB_CLASS_TEX1);
+		default:
+			return 0;
+		}
+	}
+
+	// State setters whose repetition has no effect
+	if (func == (void (*)())glEnable || func == (void (*)())glDisable || func == (void (*)())glBindTexture ||
+		func == (void (*)())glBlendFunc || func == (void (*)())glBlendFuncSeparate || func == (void (*)())glBlendEquation ||
+		func == (void (*)())glBlendEquationSeparate || func == (void (*)())glShadeModel || func == (void (*)())glColorMaterial ||
+		func == (void (*)())glMatrixMode || func == (void (*)())glLoadIdentity || func == (void (*)())glColorMask ||
+		func == (void (*)())glTexEnvf || func == (void (*)())glTexEnvi || func == (void (*)())glFogf ||
+		func == (void (*)())glFogi || func == (void (*)())glEnableClientState || func == (void (*)())glDisableClientState ||
+		func == (void (*)())glClientActiveTexture || func == (void (*)())glBindBuffer)
+		return DLIST_FLAG_IDEMPOTENT;
+
+	return 0;
+}
+
 GLboolean _vgl_enqueue_list_func(void (*func)(), const char *type, ...) {
 	// Check if we are creating a display list
 	if (!curr_display_list)
 		return GL_FALSE;
-	
-	// Enqueuing function call
-	list_chain *new_tail = (list_chain *)vglMalloc(sizeof(list_chain));
-	if (curr_display_list->tail)
-		curr_display_list->tail->next = new_tail;
-	curr_display_list->tail = new_tail;
-	if (!curr_display_list->head)
-		curr_display_list->head = new_tail;
-	new_tail->func = func;
-	
+
 	// Recording function arguments
-	if (*type) {
-		va_list arglist;
-		va_start(arglist, type);
-		int i = 0;
-		char *p = (char *)type;
-		while (*p) {
-			switch (*p) {
-			case 'I':
-				{
-				int32_t arg = va_arg(arglist, int32_t);
-				sceClibMemcpy(&new_tail->args[i], &arg, sizeof(arg));
-				i += sizeof(arg);
-				}
-				break;
-			case 'U':
-				{
-				uint32_t arg = va_arg(arglist, uint32_t);
-				sceClibMemcpy(&new_tail->args[i], &arg, sizeof(arg));
-				i += sizeof(arg);
-				}
-				break;
-			case 'F':
-				{
-				float arg = (float)va_arg(arglist, double);
-				sceClibMemcpy(&new_tail->args[i], &arg, sizeof(arg));
-				i += sizeof(arg);
-				}
-				break;
-			case 'X':
-				{
-				uint8_t arg = (uint8_t)va_arg(arglist, int);
-				sceClibMemcpy(&new_tail->args[i], &arg, sizeof(arg));
-				i += sizeof(arg);
-				}
-				break;
-			case 'S':
-				{
-				int16_t arg = (int16_t)va_arg(arglist, int);
-				sceClibMemcpy(&new_tail->args[i], &arg, sizeof(arg));
-				i += sizeof(arg);
-				}
-				break;
-			default:
+	uint8_t args[DLIST_MAX_ARGS_SIZE];
+	uint32_t args_size = 0;
+	va_list arglist;
+	va_start(arglist, type);
+	dlistFuncType func_type = dlist_pack_args(args, &args_size, type, arglist);
+	va_end(arglist);
+#ifndef SKIP_ERROR_HANDLING
+	if (func_type == DLIST_OP_INVALID) {
+		vgl_log("%s:%d _vgl_enqueue_list_func: Unsupported arguments signature (%s)!\n", __FILE__, __LINE__, type);
+		return !display_list_execute;
+	}
+#endif
+
+	// Enqueuing function call
+	dlist_record(&curr_display_list->code, func, func_type, get_op_flags(func, args), args, args_size);
+
+	return !display_list_execute;
+}
+
+static uint32_t replay_baked_prim(const dlist_arena *a, const dlist_op *op, uint32_t next) {
+	const baked_prim *p = (const baked_prim *)op;
+
+	// Baked vertices live in the buffer of the list owning the executed code
+	const display_list *l = (const display_list *)((const uint8_t *)a - offsetof(display_list, code));
+
+	// Falling back to the original calls if the baked vertices can't be used with current state
+	if (phase == MODEL_CREATION || p->layout != ffp_get_immediate_layout())
+		return p->fallback;
+
+	// Performing a scene reset if necessary
+	sceneReset();
+
+	ffp_draw_immediate(l->baked + p->offset, p->mode, p->vertex_count, p->layout | IMMEDIATE_LAYOUT_COLORS);
+	return next;
+}
+
+static uint32_t bake_prim(dlist_arena *dst, const dlist_arena *src, uint32_t begin, uint32_t layout, uint32_t *attribs, uint8_t *baked, uint32_t *baked_size) {
+	// Lit vertices can't be baked
+	if (layout == IMMEDIATE_LAYOUT_INVALID)
+		return DLIST_NO_OP;
+
+	// Attributes that must have a known value when the first vertex is emitted
+	uint8_t required = (1 << ATTRIB_CLASS_COLOR);
+	uint32_t stride = ffp_get_immediate_stride(layout | IMMEDIATE_LAYOUT_COLORS);
+	if (layout == IMMEDIATE_LAYOUT_MT)
+		required |= (1 << ATTRIB_CLASS_TEX0) | (1 << ATTRIB_CLASS_TEX1);
+	else if (layout == IMMEDIATE_LAYOUT_TEX)
+		required |= (1 << ATTRIB_CLASS_TEX0);
+	uint8_t known = 0;
+	uint32_t seg_attribs[DLIST_ATTRIB_CLASSES_NUM];
+	for (int i = 0; i < DLIST_ATTRIB_CLASSES_NUM; i++) {
+		if (attribs[i] != DLIST_NO_OP)
+			known |= (1 << i);
+		seg_attribs[i] = attribs[i];
+	}
+
+	// Checking the primitive only emits vertices and attributes
+	const dlist_op *begin_op = dlist_op_at(src, begin);
+	uint32_t vertex_count = 0;
+	uint32_t off = begin + begin_op->size;
+	for (;;) {
+		if (off >= src->size)
+			return DLIST_NO_OP;
+		const dlist_op *op = dlist_op_at(src, off);
+		if (op->type != DLIST_OP_NOP) {
+			if (op->flags & DLIST_FLAG_END)
 				break;
-			}
-			p++;
+			else if (op->flags & DLIST_FLAG_VERTEX) {
+				if ((known & required) != required)
+					return DLIST_NO_OP;
+				vertex_count++;
+			} else if (op->flags & DLIST_FLAG_ATTRIB) {
+				int c = DLIST_ATTRIB_CLASS(op->flags);
+				known |= (1 << c);
+				seg_attribs[c] = off;
+			} else
+				return DLIST_NO_OP;
 		}
-		va_end(arglist);
-		
-		// Detecting function type
-		// 1 argument
-		if (strcmp(type, "U"))
-			new_tail->type = DLIST_FUNC_U32;
-		// 2 arguments
-		else if (strcmp(type, "II"))
-			new_tail->type = DLIST_FUNC_I32_I32;
-		else if (strcmp(type, "UU"))
-			new_tail->type = DLIST_FUNC_U32_U32;
-		else if (strcmp(type, "UI"))
-			new_tail->type = DLIST_FUNC_U32_I32;
-		else if (strcmp(type, "FF"))
-			new_tail->type = DLIST_FUNC_F32_F32;
-		else if (strcmp(type, "UF"))
-			new_tail->type = DLIST_FUNC_U32_F32;
-		// 3 arguments
-		else if (strcmp(type, "UII"))
-			new_tail->type = DLIST_FUNC_U32_I32_I32;
-		else if (strcmp(type, "UIU"))
-			new_tail->type = DLIST_FUNC_U32_I32_U32;
-		else if (strcmp(type, "UUI"))
-			new_tail->type = DLIST_FUNC_U32_U32_I32;
-		else if (strcmp(type, "UUU"))
-			new_tail->type = DLIST_FUNC_U32_U32_U32;
-		else if (strcmp(type, "III"))
-			new_tail->type = DLIST_FUNC_I32_I32_I32;
-		else if (strcmp(type, "UFF"))
-			new_tail->type = DLIST_FUNC_U32_F32_F32;
-		else if (strcmp(type, "UUF"))
-			new_tail->type = DLIST_FUNC_U32_U32_F32;
-		else if (strcmp(type, "FFF"))
-			new_tail->type = DLIST_FUNC_F32_F32_F32;
-		else if (strcmp(type, "XXX"))
-			new_tail->type = DLIST_FUNC_U8_U8_U8;
-		else if (strcmp(type, "SSS"))
-			new_tail->type = DLIST_FUNC_I16_I16_I16;
-		// 4 arguments
-		else if (strcmp(type, "UUUU"))
-			new_tail->type = DLIST_FUNC_U32_U32_U32_U32;
-		else if (strcmp(type, "UIUU"))
-			new_tail->type = DLIST_FUNC_U32_I32_U32_U32;
-		else if (strcmp(type, "IIII"))
-			new_tail->type = DLIST_FUNC_I32_I32_I32_I32;
-		else if (strcmp(type, "IUIU"))
-			new_tail->type = DLIST_FUNC_I32_U32_I32_U32;
-		else if (strcmp(type, "FFFF"))
-			new_tail->type = DLIST_FUNC_F32_F32_F32_F32;
-		else if (strcmp(type, "XXXX"))
-			new_tail->type = DLIST_FUNC_U8_U8_U8_U8;
-	} else
-		new_tail->type = DLIST_FUNC_VOID;
-	
-	return !display_list_execute;
+		off += op->size;
+	}
+	if (!vertex_count)
+		return DLIST_NO_OP;
+	uint32_t end = off;
+	const dlist_op *end_op = dlist_op_at(src, end);
+	uint32_t offset = *baked_size;
+	*baked_size += vertex_count * stride * sizeof(float);
+
+	// Sizing pass, only the attributes values the primitive leaves behind are needed
+	if (!dst) {
+		for (int i = 0; i < DLIST_ATTRIB_CLASSES_NUM; i++) {
+			attribs[i] = seg_attribs[i];
+		}
+		return end + end_op->size;
+	}
+
+	// Capturing the emitted vertices into the list's vertex buffer
+	ffp_capture_immediate_begin((float *)(baked + offset));
+	for (int i = 0; i < DLIST_ATTRIB_CLASSES_NUM; i++) {
+		if (attribs[i] != DLIST_NO_OP)
+			dlist_execute_range(src, attribs[i], attribs[i] + dlist_op_at(src, attribs[i])->size, NULL);
+	}
+	dlist_execute_range(src, begin + begin_op->size, end, NULL);
+	ffp_capture_immediate_end();
+
+	// Emitting the baked draw followed by the attributes values it leaves behind
+	baked_prim prim;
+	prim.hdr.func = NULL;
+	prim.hdr.type = DLIST_OP_HOOK;
+	prim.hdr.flags = 0;
+	prim.hdr.size = sizeof(baked_prim);
+	prim.offset = offset;
+	prim.vertex_count = vertex_count;
+	prim.mode = *(uint32_t *)dlist_op_args(begin_op);
+	prim.layout = layout;
+	prim.fallback = DLIST_NO_OP;
+	uint32_t prim_off = dlist_append(dst, &prim.hdr);
+	for (int i = 0; i < DLIST_ATTRIB_CLASSES_NUM; i++) {
+		if (seg_attribs[i] != attribs[i]) {
+			dlist_append(dst, dlist_op_at(src, seg_attribs[i]));
+			attribs[i] = seg_attribs[i];
+		}
+	}
+	jump_op jump;
+	jump.hdr.func = NULL;
+	jump.hdr.type = DLIST_OP_JUMP;
+	jump.hdr.flags = 0;
+	jump.hdr.size = sizeof(jump_op);
+	jump.target = DLIST_NO_OP;
+	uint32_t jump_off = dlist_append(dst, &jump.hdr);
+
+	// Keeping the original calls as fallback
+	uint32_t fallback = dst->size;
+	for (off = begin; off <= end; off += dlist_op_at(src, off)->size) {
+		if (dlist_op_at(src, off)->type != DLIST_OP_NOP)
+			dlist_append(dst, dlist_op_at(src, off));
+	}
+	if (prim_off != DLIST_NO_OP)
+		((baked_prim *)dlist_op_at(dst, prim_off))->fallback = fallback;
+	if (jump_off != DLIST_NO_OP)
+		((jump_op *)dlist_op_at(dst, jump_off))->target = dst->size;
+
+	return end + end_op->size;
 }
 
-void glCallList(GLuint list) {
-	list_chain *l = NULL;
-	if(list == 0){
-		l = curr_display_list->head;
-	}else{
-		l = display_lists[list].head;
+static void rebuild_list(dlist_arena *dst, const dlist_arena *src, uint32_t layout, uint8_t *baked, uint32_t *baked_size) {
+	// Offsets of the last write of each attribute class
+	uint32_t attribs[DLIST_ATTRIB_CLASSES_NUM];
+	for (int i = 0; i < DLIST_ATTRIB_CLASSES_NUM; i++) {
+		attribs[i] = DLIST_NO_OP;
 	}
-	while (l) {
-		switch (l->type) {
-		// No arguments
-		case DLIST_FUNC_VOID:
-			l->func();
-			break;
-		// 1 argument
-		case DLIST_FUNC_U32:
-			l->func(*(uint32_t *)(l->args));
-			break;
-		// 2 arguments
-		case DLIST_FUNC_U32_U32:
-			l->func(*(uint32_t *)(l->args), *(uint32_t *)(&l->args[4]));
-			break;
-		case DLIST_FUNC_U32_I32:
-			l->func(*(uint32_t *)(l->args), *(int32_t *)(&l->args[4]));
-			break;
-		case DLIST_FUNC_I32_I32:
-			l->func(*(int32_t *)(l->args), *(int32_t *)(&l->args[4]));
-			break;
-		case DLIST_FUNC_U32_F32:
-			l->func(*(uint32_t *)(l->args), *(float *)(&l->args[4]));
-			break;
-		case DLIST_FUNC_F32_F32:
-			l->func(*(float *)(l->args), *(float *)(&l->args[4]));
-			break;
-		// 3 arguments
-		case DLIST_FUNC_I32_I32_I32:
-			l->func(*(int32_t *)(l->args), *(int32_t *)(&l->args[4]), *(int32_t *)(&l->args[8]));
-			break;
-		case DLIST_FUNC_U32_I32_I32:
-			l->func(*(uint32_t *)(l->args), *(int32_t *)(&l->args[4]), *(int32_t *)(&l->args[8]));
-			break;
-		case DLIST_FUNC_U32_I32_U32:
-			l->func(*(uint32_t *)(l->args), *(int32_t *)(&l->args[4]), *(uint32_t *)(&l->args[8]));
-			break;
-		case DLIST_FUNC_U32_U32_U32:
-			l->func(*(uint32_t *)(l->args), *(uint32_t *)(&l->args[4]), *(uint32_t *)(&l->args[8]));
-			break;
-		case DLIST_FUNC_U32_U32_I32:
-			l->func(*(uint32_t *)(l->args), *(uint32_t *)(&l->args[4]), *(int32_t *)(&l->args[8]));
-			break;
-		case DLIST_FUNC_U8_U8_U8:
-			l->func(*(uint8_t *)(l->args), *(uint8_t *)(&l->args[1]), *(uint8_t *)(&l->args[2]));
-			break;
-		case DLIST_FUNC_I16_I16_I16:
-			l->func(*(int16_t *)(l->args), *(int16_t *)(&l->args[2]), *(int16_t *)(&l->args[4]));
-			break;
-		case DLIST_FUNC_U32_F32_F32:
-			l->func(*(uint32_t *)(l->args), *(float *)(&l->args[4]), *(float *)(&l->args[8]));
-			break;
-		case DLIST_FUNC_U32_U32_F32:
-			l->func(*(uint32_t *)(l->args), *(uint32_t *)(&l->args[4]), *(float *)(&l->args[8]));
-			break;
-		case DLIST_FUNC_F32_F32_F32:
-			l->func(*(float *)(l->args), *(float *)(&l->args[4]), *(float *)(&l->args[8]));
-			break;
-		// 4 arguments
-		case DLIST_FUNC_U32_U32_U32_U32:
-			l->func(*(uint32_t *)(l->args), *(uint32_t *)(&l->args[4]), *(uint32_t *)(&l->args[8]), *(uint32_t *)(&l->args[12]));
-			break;
-		case DLIST_FUNC_I32_I32_I32_I32:
-			l->func(*(int32_t *)(l->args), *(int32_t *)(&l->args[4]), *(int32_t *)(&l->args[8]), *(int32_t *)(&l->args[12]));
-			break;
-		case DLIST_FUNC_I32_U32_I32_U32:
-			l->func(*(int32_t *)(l->args), *(uint32_t *)(&l->args[4]), *(int32_t *)(&l->args[8]), *(uint32_t *)(&l->args[12]));
-			break;
-		case DLIST_FUNC_U32_I32_U32_U32:
-			l->func(*(uint32_t *)(l->args), *(int32_t *)(&l->args[4]), *(uint32_t *)(&l->args[8]), *(uint32_t *)(&l->args[12]));
-			break;
-		case DLIST_FUNC_F32_F32_F32_F32:
-			l->func(*(float *)(l->args), *(float *)(&l->args[4]), *(float *)(&l->args[8]), *(float *)(&l->args[12]));
-			break;
-		case DLIST_FUNC_U8_U8_U8_U8:
-			l->func(*(uint8_t *)(l->args), *(uint8_t *)(&l->args[1]), *(uint8_t *)(&l->args[2]), *(uint8_t *)(&l->args[3]));
-			break;
-		default:
-			break;
+
+	uint32_t off = 0;
+	while (off < src->size) {
+		const dlist_op *op = dlist_op_at(src, off);
+
+		// Dropping folded calls
+		if (op->type == DLIST_OP_NOP) {
+			off += op->size;
+			continue;
 		}
-		l = (list_chain *)l->next;
+
+		if (op->flags & DLIST_FLAG_BEGIN) {
+			uint32_t next = bake_prim(dst, src, off, layout, attribs, baked, baked_size);
+			if (next != DLIST_NO_OP) {
+				off = next;
+				continue;
+			}
+		} else if (op->flags & DLIST_FLAG_ATTRIB)
+			attribs[DLIST_ATTRIB_CLASS(op->flags)] = off;
+		if (dst)
+			dlist_append(dst, op);
+		off += op->size;
 	}
 }
 
+static void optimize_list(display_list *l) {
+	dlist_arena *src = &l->code;
+	dlist_arena dst;
+	dlist_arena_init(&dst);
+
+	// Immediate mode primitives are baked with the vertex layout in use when the list is completed
+	uint32_t layout = ffp_get_immediate_layout();
+
+	// Sizing every bakeable primitive first, so that the list gets a single vertex buffer
+	uint32_t baked_size = 0;
+	rebuild_list(NULL, src, layout, NULL, &baked_size);
+	if (baked_size) {
+		l->baked = (uint8_t *)gpu_alloc_mapped(baked_size, VGL_MEM_VRAM);
+		if (!l->baked)
+			layout = IMMEDIATE_LAYOUT_INVALID;
+	}
+	baked_size = 0;
+	rebuild_list(&dst, src, layout, l->baked, &baked_size);
+
+	dlist_arena_free(src);
+	*src = dst;
+}
+
+static void free_list(display_list *l) {
+	// Releasing baked vertex buffer
+	markAsDirty(l->baked);
+	l->baked = NULL;
+	dlist_arena_free(&l->code);
+}
+
+void glCallList(GLuint list) {
+	PROFILE_ZONE(CALL_LIST);
+	display_list *l = list ? &display_lists[list] : curr_display_list;
+	if (l)
+		dlist_execute(&l->code, replay_baked_prim);
+}
+
 void glNewList(GLuint list, GLenum mode) {
 #ifndef SKIP_ERROR_HANDLING
 	if (list == 0) {
@@ -247,11 +323,18 @@ void glNewList(GLuint list, GLenum mode) {
 	}
 #endif
 	curr_display_list = &display_lists[list];
+	free_list(curr_display_list);
 	display_list_execute = mode == GL_COMPILE ? GL_FALSE : GL_TRUE;
 }
 
 void glEndList(void) {
+	display_list *l = curr_display_list;
+	if (!l)
+		return;
+
+	// Stopping recording before the list gets optimized since optimizing replays some of its calls
 	curr_display_list = NULL;
+	optimize_list(l);
 }
 
 GLuint glGenLists(GLsizei range) {
@@ -262,9 +345,10 @@ GLuint glGenLists(GLsizei range) {
 		SET_GL_ERROR_WITH_RET(GL_INVALID_OPERATION, 0)
 	}
 #endif
+	// List 0 is reserved, so it is never handed out
 	GLsizei r = range;
 	GLuint first = 0;
-	for (GLuint i = 0; i < NUM_DISPLAY_LISTS; i++) {
+	for (GLuint i = 1; i < NUM_DISPLAY_LISTS; i++) {
 		if (!display_lists[i].used) {
 			if (!first)
 				first = i;
@@ -284,7 +368,7 @@ GLuint glGenLists(GLsizei range) {
 #endif	
 	for (GLuint i = first; i < first + range; i++) {
 		display_lists[i].used = GL_TRUE;
-		display_lists[i].head = display_lists[i].tail = NULL;
+		dlist_arena_init(&display_lists[i].code);
 	}
 	return first;
 }
@@ -298,12 +382,7 @@ void glDeleteLists(GLuint list, GLsizei range) {
 	}
 #endif
 	for (GLuint i = list; i < list + range; i++) {
-		list_chain *l = display_lists[i].head;
-		while (l) {
-			list_chain *old = l;
-			l = l->next;
-			vglFree(old);
-		}
+		free_list(&display_lists[i]);
 		display_lists[i].used = GL_FALSE;
 	}
 }
@@ -25,90 +25,81 @@
 
 GLboolean prim_is_non_native = GL_FALSE; // Flag for when a primitive not supported natively by sceGxm is used
 
-#define setup_elements_indices(type_t) \
-	type_t *ptr; \
-	if (gpu_buf != NULL && !prim_is_non_native) { \
-		ptr = (type_t *)((uint8_t *)gpu_buf->ptr + (uint32_t)gl_indices); \
-		gpu_buf->used = GL_TRUE; \
-	} else { \
-		switch (mode) { \
-		case GL_QUADS: \
-			ptr = gpu_alloc_mapped_temp(count * 3 * sizeof(type_t)); \
-			for (int i = 0; i < count / 4; i++) { \
-				ptr[i * 6] = src[i * 4]; \
-				ptr[i * 6 + 1] = src[i * 4 + 1]; \
-				ptr[i * 6 + 2] = src[i * 4 + 3]; \
-				ptr[i * 6 + 3] = src[i * 4 + 1]; \
-				ptr[i * 6 + 4] = src[i * 4 + 2]; \
-				ptr[i * 6 + 5] = src[i * 4 + 3]; \
-			} \
-			count = (count / 2) * 3; \
-			break; \
-		case GL_LINE_STRIP: \
-			ptr = gpu_alloc_mapped_temp((count - 1) * 2 * sizeof(type_t)); \
-			for (int i = 0; i < count - 1; i++) { \
-				ptr[i * 2] = src[i]; \
-				ptr[i * 2 + 1] = src[i + 1]; \
-			} \
-			count = (count - 1) * 2; \
-			break; \
-		case GL_LINE_LOOP: \
-			ptr = gpu_alloc_mapped_temp(count * 2 * sizeof(type_t)); \
-			for (int i = 0; i < count - 1; i++) { \
-				ptr[i * 2] = src[i]; \
-				ptr[i * 2 + 1] = src[i + 1]; \
-			} \
-			ptr[(count - 1) * 2] = src[count - 1]; \
-			ptr[(count - 1) * 2 + 1] = src[0]; \
-			count = count * 2; \
-			break; \
-		default: \
-			ptr = gpu_alloc_mapped_temp(count * sizeof(type_t)); \
-			vgl_fast_memcpy(ptr, src, count * sizeof(type_t)); \
-			break; \
-		} \
+static index_cache converted_indices; // Converted index buffers for static index buffers
+static GLboolean converted_indices_ready = GL_FALSE;
+
+static void free_converted_indices(void *ptr) {
+	markAsDirty(ptr);
+}
+
+void invalidate_converted_indices(uint32_t data_id, uint32_t offset, uint32_t size) {
+	if (converted_indices_ready)
+		index_cache_invalidate(&converted_indices, data_id, offset, size);
+}
+
+static void *setup_elements_indices(gpubuffer *gpu_buf, const GLvoid *gl_indices, const void *src, GLenum mode, GLsizei *count, GLboolean is_short, int32_t base_vertex) {
+	// Index buffers natively supported by sceGxm are used straight
+	if (gpu_buf && !prim_is_non_native && !base_vertex) {
+		mark_buffer_used(gpu_buf);
+		return (uint8_t *)gpu_buf->ptr + (uintptr_t)gl_indices;
 	}
-	
-#define setup_elements_indices_with_base(type_t) \
-	type_t *ptr; \
-	switch (mode) { \
-	case GL_QUADS: \
-		ptr = gpu_alloc_mapped_temp(count * 3 * sizeof(type_t)); \
-		for (int i = 0; i < count / 4; i++) { \
-			ptr[i * 6] = src[i * 4] + baseVertex; \
-			ptr[i * 6 + 1] = src[i * 4 + 1] + baseVertex; \
-			ptr[i * 6 + 2] = src[i * 4 + 3] + baseVertex; \
-			ptr[i * 6 + 3] = src[i * 4 + 1] + baseVertex; \
-			ptr[i * 6 + 4] = src[i * 4 + 2] + baseVertex; \
-			ptr[i * 6 + 5] = src[i * 4 + 3] + baseVertex; \
-		} \
-		count = (count / 2) * 3; \
-		break; \
-	case GL_LINE_STRIP: \
-		ptr = gpu_alloc_mapped_temp((count - 1) * 2 * sizeof(type_t)); \
-		for (int i = 0; i < count - 1; i++) { \
-			ptr[i * 2] = src[i] + baseVertex; \
-			ptr[i * 2 + 1] = src[i + 1] + baseVertex; \
-		} \
-		count = (count - 1) * 2; \
-		break; \
-	case GL_LINE_LOOP: \
-		ptr = gpu_alloc_mapped_temp(count * 2 * sizeof(type_t)); \
-		for (int i = 0; i < count - 1; i++) { \
-			ptr[i * 2] = src[i] + baseVertex; \
-			ptr[i * 2 + 1] = src[i + 1] + baseVertex; \
-		} \
-		ptr[(count - 1) * 2] = src[count - 1] + baseVertex; \
-		ptr[(count - 1) * 2 + 1] = src[0] + baseVertex; \
-		count = count * 2; \
-		break; \
-	default: \
-		ptr = gpu_alloc_mapped_temp(count * sizeof(type_t)); \
-		for (int i = 0; i < count; i++) { \
-			ptr[i] = src[i] + baseVertex; \
-		} \
-		break; \
+
+	index_prim prim;
+	switch (mode) {
+	case GL_QUADS:
+		prim = INDEX_PRIM_QUADS;
+		break;
+	case GL_LINE_STRIP:
+		prim = INDEX_PRIM_LINE_STRIP;
+		break;
+	case GL_LINE_LOOP:
+		prim = INDEX_PRIM_LINE_LOOP;
+		break;
+	default:
+		prim = INDEX_PRIM_LIST;
+		break;
 	}
+	uint32_t bpe = is_short ? sizeof(uint16_t) : sizeof(uint32_t);
+	uint32_t dst_count = index_expanded_count(prim, *count);
+	uint32_t dst_size = dst_count * bpe;
+	void *ptr;
+
+	if (gpu_buf && gpu_buf->type == VGL_MEM_VRAM && gpu_buf->data_id && dst_size && dst_size <= INDEX_CACHE_MAX_BYTES / 4) {
+		// Static index buffers are converted once and kept around until their content changes
+		if (!converted_indices_ready) {
+			index_cache_init(&converted_indices, free_converted_indices);
+			converted_indices_ready = GL_TRUE;
+		}
+		index_cache_entry *e = index_cache_lookup(&converted_indices, gpu_buf->data_id, (uintptr_t)gl_indices, *count, base_vertex, prim, is_short);
+		if (e) {
+			*count = e->dst_count;
+			return e->dst;
+		}
+		ptr = gpu_alloc_mapped(dst_size, VGL_MEM_VRAM);
+		if (ptr) {
+			if (is_short)
+				index_expand_u16((uint16_t *)ptr, (const uint16_t *)src, *count, base_vertex, prim);
+			else
+				index_expand_u32((uint32_t *)ptr, (const uint32_t *)src, *count, base_vertex, prim);
+			index_cache_insert(&converted_indices, gpu_buf->data_id, (uintptr_t)gl_indices, *count, base_vertex, prim, is_short, ptr, dst_count, dst_size);
+			*count = dst_count;
+			return ptr;
+		}
+	}
+
+	// Client side and dynamic index buffers are converted on every draw
+	if (prim == INDEX_PRIM_LIST && !base_vertex)
+		ptr = gpu_stream_client_array(src, bpe, *count);
+	else {
+		ptr = gpu_alloc_stream(dst_size);
+		if (is_short)
+			index_expand_u16((uint16_t *)ptr, (const uint16_t *)src, *count, base_vertex, prim);
+		else
+			index_expand_u32((uint32_t *)ptr, (const uint32_t *)src, *count, base_vertex, prim);
+	}
+	*count = dst_count;
+	return ptr;
+}
 
 void glDrawArrays(GLenum mode, GLint first, GLsizei count) {
 #ifdef HAVE_DLISTS
@@ -123,6 +114,12 @@ void glDrawArrays(GLenum mode, GLint first, GLsizei count) {
 		SET_GL_ERROR_WITH_VALUE(GL_INVALID_VALUE, count)
 	}
 #endif
+#ifdef HAVE_FFP_BATCHING
+	// Merging the draw into the pending ffp batch when possible
+	if (cur_program == 0 && ffp_batch_draw_arrays(mode, first, count))
+		return;
+#endif
+	flush_ffp_batch();
 	SceGxmPrimitiveType gxm_p;
 	gl_primitive_to_gxm(mode, gxm_p, count);
 	sceneReset();
@@ -133,13 +130,23 @@ void glDrawArrays(GLenum mode, GLint first, GLsizei count) {
 	else {
 		if (!(ffp_vertex_attrib_state & (1 << 0)))
 			return;
-		_glDrawArrays_FixedFunctionIMPL(first + count);
+		if (!_glDrawArrays_FixedFunctionIMPL(first + count)) {
+			restore_polygon_mode(gxm_p);
+			return;
+		}
 	}
 
 #ifndef SKIP_ERROR_HANDLING
 	if (is_draw_legal)
 #endif
 	{
+#ifndef SKIP_ERROR_HANDLING
+		if (first + count > MAX_IDX_NUMBER) {
+			vgl_log("%s:%d Attempting to draw a model with glDrawArrays which is too big! Consider increasing MAX_IDX_NUMBER value...\n", __FILE__, __LINE__);
+		}
+#endif
+		reserve_default_indices(first + count);
+
 		uint16_t *ptr;
 		switch (mode) {
 		case GL_QUADS:
@@ -151,7 +158,7 @@ void glDrawArrays(GLenum mode, GLint first, GLsizei count) {
 			count = (count - 1) * 2;
 			break;
 		case GL_LINE_LOOP:
-			ptr = gpu_alloc_mapped_temp(count * 2 * sizeof(uint16_t));
+			ptr = gpu_alloc_stream(count * 2 * sizeof(uint16_t));
 			vgl_fast_memcpy(ptr, default_line_strips_idx_ptr + first * 2, (count - 1) * 2 * sizeof(uint16_t));
 			ptr[(count - 1) * 2] = first + count - 1;
 			ptr[(count - 1) * 2 + 1] = first;
@@ -162,11 +169,7 @@ void glDrawArrays(GLenum mode, GLint first, GLsizei count) {
 			break;
 		}
 
-#ifndef SKIP_ERROR_HANDLING
-		if (first + count > MAX_IDX_NUMBER) {
-			vgl_log("%s:%d Attempting to draw a model with glDrawArrays which is too big! Consider increasing MAX_IDX_NUMBER value...\n", __FILE__, __LINE__);
-		}	
-#endif
+		flush_gxm_state();
 		sceGxmDraw(gxm_context, gxm_p, SCE_GXM_INDEX_FORMAT_U16, ptr, count);
 	}
 	restore_polygon_mode(gxm_p);
@@ -188,32 +191,33 @@ void glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid *gl_in
 	}
 #endif
 
+	// Indexed draws are never batched, any pending batch must be drawn before them
+	flush_ffp_batch();
 	SceGxmPrimitiveType gxm_p;
 	gl_primitive_to_gxm(mode, gxm_p, count);
 	sceneReset();
 	GLboolean is_draw_legal = GL_TRUE;
 
-	gpubuffer *gpu_buf = (gpubuffer *)index_array_unit;
-	uint16_t *src = gpu_buf ? (uint16_t *)((uint8_t *)gpu_buf->ptr + (uint32_t)gl_indices) : (uint16_t *)gl_indices;
+	gpubuffer *gpu_buf = (gpubuffer *)(uintptr_t)index_array_unit;
+	uint16_t *src = gpu_buf ? (uint16_t *)((uint8_t *)gpu_buf->ptr + (uintptr_t)gl_indices) : (uint16_t *)gl_indices;
 	if (cur_program != 0)
 		is_draw_legal = _glDrawElements_CustomShadersIMPL(src, count, type == GL_UNSIGNED_SHORT);
 	else {
 		if (!(ffp_vertex_attrib_state & (1 << 0)))
 			return;
-		_glDrawElements_FixedFunctionIMPL(src, count, type == GL_UNSIGNED_SHORT);
+		if (!_glDrawElements_FixedFunctionIMPL(src, count, type == GL_UNSIGNED_SHORT)) {
+			restore_polygon_mode(gxm_p);
+			return;
+		}
 	}
 
 #ifndef SKIP_ERROR_HANDLING
 	if (is_draw_legal)
 #endif
 	{
-		if (type == GL_UNSIGNED_SHORT) {
-			setup_elements_indices(uint16_t)
-			sceGxmDraw(gxm_context, gxm_p, SCE_GXM_INDEX_FORMAT_U16, ptr, count);
-		} else {
-			setup_elements_indices(uint32_t)
-			sceGxmDraw(gxm_context, gxm_p, SCE_GXM_INDEX_FORMAT_U32, ptr, count);
-		}
+		void *ptr = setup_elements_indices(gpu_buf, gl_indices, src, mode, &count, type == GL_UNSIGNED_SHORT, 0);
+		flush_gxm_state();
+		sceGxmDraw(gxm_context, gxm_p, type == GL_UNSIGNED_SHORT ? SCE_GXM_INDEX_FORMAT_U16 : SCE_GXM_INDEX_FORMAT_U32, ptr, count);
 	}
 	restore_polygon_mode(gxm_p);
 }
@@ -229,32 +233,33 @@ void glDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const GLv
 	}
 #endif
 
+	// Indexed draws are never batched, any pending batch must be drawn before them
+	flush_ffp_batch();
 	SceGxmPrimitiveType gxm_p;
 	gl_primitive_to_gxm(mode, gxm_p, count);
 	sceneReset();
 	GLboolean is_draw_legal = GL_TRUE;
 
-	gpubuffer *gpu_buf = (gpubuffer *)index_array_unit;
-	uint16_t *src = gpu_buf ? (uint16_t *)((uint8_t *)gpu_buf->ptr + (uint32_t)gl_indices) : (uint16_t *)gl_indices;
+	gpubuffer *gpu_buf = (gpubuffer *)(uintptr_t)index_array_unit;
+	uint16_t *src = gpu_buf ? (uint16_t *)((uint8_t *)gpu_buf->ptr + (uintptr_t)gl_indices) : (uint16_t *)gl_indices;
 	if (cur_program != 0)
 		is_draw_legal = _glDrawElements_CustomShadersIMPL(src, count, type == GL_UNSIGNED_SHORT);
 	else {
 		if (!(ffp_vertex_attrib_state & (1 << 0)))
 			return;
-		_glDrawElements_FixedFunctionIMPL(src, count, type == GL_UNSIGNED_SHORT);
+		if (!_glDrawElements_FixedFunctionIMPL(src, count, type == GL_UNSIGNED_SHORT)) {
+			restore_polygon_mode(gxm_p);
+			return;
+		}
 	}
 
 #ifndef SKIP_ERROR_HANDLING
 	if (is_draw_legal)
 #endif
 	{
-		if (type == GL_UNSIGNED_SHORT) {
-			setup_elements_indices_with_base(uint16_t)
-			sceGxmDraw(gxm_context, gxm_p, SCE_GXM_INDEX_FORMAT_U16, ptr, count);
-		} else {
-			setup_elements_indices_with_base(uint32_t)
-			sceGxmDraw(gxm_context, gxm_p, SCE_GXM_INDEX_FORMAT_U32, ptr, count);
-		}
+		void *ptr = setup_elements_indices(gpu_buf, gl_indices, src, mode, &count, type == GL_UNSIGNED_SHORT, baseVertex);
+		flush_gxm_state();
+		sceGxmDraw(gxm_context, gxm_p, type == GL_UNSIGNED_SHORT ? SCE_GXM_INDEX_FORMAT_U16 : SCE_GXM_INDEX_FORMAT_U32, ptr, count);
 	}
 	restore_polygon_mode(gxm_p);
 }
@@ -268,6 +273,7 @@ void vglDrawObjects(GLenum mode, GLsizei count, GLboolean implicit_wvp) {
 	}
 #endif
 
+	flush_ffp_batch();
 	SceGxmPrimitiveType gxm_p;
 	gl_primitive_to_gxm(mode, gxm_p, count);
 	sceneReset();
@@ -275,9 +281,13 @@ void vglDrawObjects(GLenum mode, GLsizei count, GLboolean implicit_wvp) {
 	texture_unit *tex_unit = &texture_units[0];
 	if (cur_program != 0) {
 		_vglDrawObjects_CustomShadersIMPL(implicit_wvp);
+		flush_gxm_state();
 		sceGxmDraw(gxm_context, gxm_p, SCE_GXM_INDEX_FORMAT_U16, index_object, count);
 	} else if (ffp_vertex_attrib_state & (1 << 0)) {
-		reload_ffp_shaders(NULL, NULL);
+		if (!reload_ffp_shaders(NULL, NULL)) {
+			restore_polygon_mode(gxm_p);
+			return;
+		}
 		if (ffp_vertex_attrib_state & (1 << 1)) {
 			if (texture_slots[tex_unit->tex_id].status != TEX_VALID)
 				return;
@@ -288,6 +298,7 @@ void vglDrawObjects(GLenum mode, GLsizei count, GLboolean implicit_wvp) {
 		} else if (ffp_vertex_num_params > 1)
 			sceGxmSetVertexStream(gxm_context, 1, color_object);
 		sceGxmSetVertexStream(gxm_context, 0, vertex_object);
+		flush_gxm_state();
 		sceGxmDraw(gxm_context, gxm_p, SCE_GXM_INDEX_FORMAT_U16, index_object, count);
 	}
 
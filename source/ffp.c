@@ -36,6 +36,7 @@
 #include "shaders/texture_combiners/combine.h"
 #endif
 #include "shared.h"
+#include <inttypes.h>
 
 //#define DISABLE_FS_SHADER_CACHE // Uncomment this to disable filesystem layer cache for ffp
 //#define DISABLE_RAM_SHADER_CACHE // Uncomment this to disable RAM layer cache for ffp
@@ -43,6 +44,7 @@
 #define SHADER_CACHE_SIZE 256
 #ifndef DISABLE_FS_SHADER_CACHE
 #define SHADER_CACHE_MAGIC 13 // This must be increased whenever ffp shader sources or shader mask/combiner mask changes
+#define SHADER_ARCHIVE_PATH "ux0:data/shader_cache/ffp.vgsa" // Location of the filesystem layer cache for ffp
 //#define DUMP_SHADER_SOURCES // Enable this flag to dump shader sources inside shader cache
 #endif
 
@@ -52,6 +54,7 @@
 #else
 #define FRAGMENT_UNIFORMS_NUM 17
 #endif
+#define VERTEX_ATTRIB_PARAMS_NUM 9
 
 typedef enum {
 	//FLAT, // FIXME: Not easy to implement with ShaccCg constraints
@@ -135,9 +138,21 @@ SceGxmVertexStream legacy_mt_vertex_stream_config[FFP_VERTEX_ATTRIBS_NUM];
 SceGxmVertexAttribute legacy_nt_vertex_attrib_config[FFP_VERTEX_ATTRIBS_NUM - 2];
 SceGxmVertexStream legacy_nt_vertex_stream_config[FFP_VERTEX_ATTRIBS_NUM - 2];
 
-static uint32_t ffp_vertex_attrib_offsets[FFP_VERTEX_ATTRIBS_NUM] = {0, 0, 0, 0, 0, 0, 0, 0};
+static uintptr_t ffp_vertex_attrib_offsets[FFP_VERTEX_ATTRIBS_NUM] = {0, 0, 0, 0, 0, 0, 0, 0};
 static uint32_t ffp_vertex_attrib_vbo[FFP_VERTEX_ATTRIBS_NUM] = {0, 0, 0, 0, 0, 0, 0, 0};
 static GLenum ffp_mode;
+
+// Immediate Mode with packed vertices
+static SceGxmVertexStream immediate_vertex_stream_config[FFP_VERTEX_ATTRIBS_NUM];
+static uint32_t imm_layout; // Layout of the vertices being emitted
+static uint32_t imm_stride; // Stride in floats of the vertices being emitted
+static vector4f imm_color; // Color shared by all the vertices of the run if they carry no color
+static float *imm_run = NULL; // First vertex of the run of primitives merged into a single draw
+static uint32_t imm_run_count = 0; // Number of vertices of the run
+static uint32_t imm_run_layout; // Layout the run draw has been set up for
+static GLenum imm_run_mode; // Primitive of the run
+static uint8_t imm_run_mask_state; // Attributes mask returned by the run draw setup
+static SceGxmTexture imm_run_textures[2]; // Textures bound when the run started
 #ifdef HAVE_HIGH_FFP_TEXUNITS
 uint16_t ffp_vertex_attrib_state = 0;
 static uint8_t texcoord_idxs[TEXTURE_COORDS_NUM] = {1, FFP_VERTEX_ATTRIBS_NUM - 2, FFP_VERTEX_ATTRIBS_NUM - 1};
@@ -194,22 +209,6 @@ typedef union combiner_mask {
 } combiner_mask;
 #endif
 
-#ifndef DISABLE_RAM_SHADER_CACHE
-typedef struct {
-	SceGxmProgram *frag;
-	SceGxmProgram *vert;
-	SceGxmShaderPatcherId frag_id;
-	SceGxmShaderPatcherId vert_id;
-	shader_mask mask;
-#ifndef DISABLE_TEXTURE_COMBINER
-	combiner_mask cmb_mask;
-#endif
-} cached_shader;
-cached_shader shader_cache[SHADER_CACHE_SIZE];
-uint8_t shader_cache_size = 0;
-int shader_cache_idx = -1;
-#endif
-
 typedef enum {
 	CLIP_PLANES_EQUATION_UNIF,
 	MODELVIEW_MATRIX_UNIF,
@@ -250,19 +249,95 @@ typedef enum {
 #endif
 } frag_uniform_type;
 
+typedef enum {
+	POSITION_ATTRIB,
+	TEXCOORD0_ATTRIB,
+	TEXCOORD1_ATTRIB,
+	TEXCOORD2_ATTRIB,
+	COLOR_ATTRIB,
+	DIFFUSE_ATTRIB,
+	SPECULAR_ATTRIB,
+	EMISSION_ATTRIB,
+	NORMAL_ATTRIB
+} vert_attrib_type;
+
+// Names of the parameters of the ffp programs, in the same order as the relative enums
+static const char *const ffp_vertex_uniform_names[VERTEX_UNIFORMS_NUM] = {
+	"clip_planes_eq",
+	"modelview",
+	"wvp",
+	"texmat",
+	"lights_ambients",
+	"lights_diffuses",
+	"lights_speculars",
+	"lights_positions",
+	"lights_attenuations",
+	"light_global_ambient",
+	"normal_mat",
+	"point_size",
+	"ambient"
+};
+
+static const char *const ffp_fragment_uniform_names[FRAGMENT_UNIFORMS_NUM] = {
+	"alphaCut",
+	"fogColor",
+	"texEnvColor",
+	"tintColor",
+	"fog_range",
+	"fog_far",
+	"fog_density",
+	"lights_ambients",
+	"lights_diffuses",
+	"lights_speculars",
+	"lights_positions",
+	"lights_attenuations",
+	"light_global_ambient",
+	"pass0_rgb_scale",
+	"pass0_a_scale",
+	"pass1_rgb_scale",
+	"pass1_a_scale",
+#ifdef HAVE_HIGH_FFP_TEXUNITS
+	"pass2_rgb_scale",
+	"pass2_a_scale"
+#endif
+};
+
+static const char *const ffp_vertex_attrib_names[VERTEX_ATTRIB_PARAMS_NUM] = {
+	"position",
+	"texcoord0",
+	"texcoord1",
+	"texcoord2",
+	"color",
+	"diff",
+	"spec",
+	"emission",
+	"normals"
+};
+
 uint8_t ffp_vertex_num_params = 1;
-const SceGxmProgramParameter *ffp_vertex_params[VERTEX_UNIFORMS_NUM];
-const SceGxmProgramParameter *ffp_fragment_params[FRAGMENT_UNIFORMS_NUM];
+gxp_param ffp_vertex_params[VERTEX_UNIFORMS_NUM];
+gxp_param ffp_fragment_params[FRAGMENT_UNIFORMS_NUM];
+gxp_param ffp_vertex_attrib_params[VERTEX_ATTRIB_PARAMS_NUM];
+static uniform_block ffp_vertex_block; // Default uniform buffer content for the current ffp vertex program
+static uniform_block ffp_fragment_block; // Default uniform buffer content for the current ffp fragment program
+static const SceGxmProgram *ffp_vertex_block_prog = NULL; // Program ffp_vertex_block is laid out for
+static const SceGxmProgram *ffp_fragment_block_prog = NULL; // Program ffp_fragment_block is laid out for
+static uniform_plan ffp_vertex_plan;
+static uniform_plan ffp_fragment_plan;
 SceGxmShaderPatcherId ffp_vertex_program_id;
 SceGxmShaderPatcherId ffp_fragment_program_id;
 SceGxmProgram *ffp_fragment_program = NULL;
 SceGxmProgram *ffp_vertex_program = NULL;
 SceGxmVertexProgram *ffp_vertex_program_patched; // Patched vertex program for the fixed function pipeline implementation
 SceGxmFragmentProgram *ffp_fragment_program_patched; // Patched fragment program for the fixed function pipeline implementation
+static patch_cache ffp_vertex_patches; // Patched vertex programs for the fixed function pipeline implementation
+static patch_cache ffp_fragment_patches; // Patched fragment programs for the fixed function pipeline implementation
 GLboolean ffp_dirty_frag = GL_TRUE;
 GLboolean ffp_dirty_vert = GL_TRUE;
+static uint8_t ffp_reload_attrib_state = 0; // Vertex attributes state the ffp shaders got last reloaded with
 GLboolean dirty_frag_unifs = GL_TRUE;
 GLboolean dirty_vert_unifs = GL_TRUE;
+GLboolean dirty_tint_unif = GL_TRUE;
 blend_config ffp_blend_info;
 shader_mask ffp_mask = {.raw = 0};
 GLenum color_material_mode = GL_AMBIENT_AND_DIFFUSE;
@@ -278,52 +353,44 @@ combiner_mask ffp_combiner_mask = {.raw = 0};
 SceGxmVertexAttribute ffp_vertex_attribute[FFP_VERTEX_ATTRIBS_NUM];
 SceGxmVertexStream ffp_vertex_stream[FFP_VERTEX_ATTRIBS_NUM];
 
-void reload_vertex_uniforms() {
-	ffp_vertex_params[CLIP_PLANES_EQUATION_UNIF] = sceGxmProgramFindParameterByName(ffp_vertex_program, "clip_planes_eq");
-	ffp_vertex_params[MODELVIEW_MATRIX_UNIF] = sceGxmProgramFindParameterByName(ffp_vertex_program, "modelview");
-	ffp_vertex_params[WVP_MATRIX_UNIF] = sceGxmProgramFindParameterByName(ffp_vertex_program, "wvp");
-	ffp_vertex_params[TEX_MATRIX_UNIF] = sceGxmProgramFindParameterByName(ffp_vertex_program, "texmat");
-	ffp_vertex_params[POINT_SIZE_UNIF] = sceGxmProgramFindParameterByName(ffp_vertex_program, "point_size");
-	ffp_vertex_params[NORMAL_MATRIX_UNIF] = sceGxmProgramFindParameterByName(ffp_vertex_program, "normal_mat");
-	if (ffp_vertex_params[NORMAL_MATRIX_UNIF]) {
-		ffp_vertex_params[LIGHTS_AMBIENTS_V_UNIF] = sceGxmProgramFindParameterByName(ffp_vertex_program, "lights_ambients");
-		ffp_vertex_params[AMBIENT_UNIF] = sceGxmProgramFindParameterByName(ffp_vertex_program, "ambient");
-		if (ffp_vertex_params[LIGHTS_AMBIENTS_V_UNIF]) {
-			ffp_vertex_params[LIGHTS_DIFFUSES_V_UNIF] = sceGxmProgramFindParameterByName(ffp_vertex_program, "lights_diffuses");
-			ffp_vertex_params[LIGHTS_SPECULARS_V_UNIF] = sceGxmProgramFindParameterByName(ffp_vertex_program, "lights_speculars");
-			ffp_vertex_params[LIGHTS_POSITIONS_V_UNIF] = sceGxmProgramFindParameterByName(ffp_vertex_program, "lights_positions");
-			ffp_vertex_params[LIGHTS_ATTENUATIONS_V_UNIF] = sceGxmProgramFindParameterByName(ffp_vertex_program, "lights_attenuations");
-			ffp_vertex_params[LIGHT_GLOBAL_AMBIENT_V_UNIF] = sceGxmProgramFindParameterByName(ffp_vertex_program, "light_global_ambient");
+static int find_ffp_param(const void *prog, const char *name, gxp_param *out) {
+	const SceGxmProgramParameter *param = sceGxmProgramFindParameterByName((const SceGxmProgram *)prog, name);
+	if (!param)
+		return 0;
+	out->ptr = param;
+	out->res_index = sceGxmProgramParameterGetResourceIndex(param);
+	out->size = sceGxmProgramParameterGetComponentCount(param) * sceGxmProgramParameterGetArraySize(param);
+	return 1;
+}
+
+static int set_ffp_uniform(void *buf, const void *param, uint32_t offset, uint32_t count, const float *src) {
+	return sceGxmSetUniformDataF(buf, (const SceGxmProgramParameter *)param, offset, count, src);
+}
+
+static void add_ffp_lights_steps(uniform_plan *plan, const gxp_param *lights, const void *global_ambient, float *light_vars[][5], int lights_num) {
+	// lights points to ambients, diffuses, speculars, positions and attenuations uniforms, in this order
+	uniform_plan_add(plan, global_ambient, 0, 4, (const float *)&light_global_ambient.r);
+	if (lights_aligned) {
+		for (int j = 0; j < 5; j++) {
+			uniform_plan_add(plan, lights[j].ptr, 0, (j == 4 ? 3 : 4) * lights_num, (const float *)light_vars[0][j]);
+		}
+	} else {
+		for (int i = 0; i < lights_num; i++) {
+			for (int j = 0; j < 5; j++) {
+				uint32_t comps = j == 4 ? 3 : 4;
+				uniform_plan_add(plan, lights[j].ptr, comps * i, comps, (const float *)light_vars[i][j]);
+			}
 		}
 	}
 }
 
+void reload_vertex_uniforms() {
+	gxp_table_build(ffp_vertex_params, ffp_vertex_uniform_names, VERTEX_UNIFORMS_NUM, ffp_vertex_program, find_ffp_param);
+	gxp_table_build(ffp_vertex_attrib_params, ffp_vertex_attrib_names, VERTEX_ATTRIB_PARAMS_NUM, ffp_vertex_program, find_ffp_param);
+}
+
 void reload_fragment_uniforms() {
-	ffp_fragment_params[ALPHA_CUT_UNIF] = sceGxmProgramFindParameterByName(ffp_fragment_program, "alphaCut");
-	ffp_fragment_params[FOG_COLOR_UNIF] = sceGxmProgramFindParameterByName(ffp_fragment_program, "fogColor");
-	ffp_fragment_params[TEX_ENV_COLOR_UNIF] = sceGxmProgramFindParameterByName(ffp_fragment_program, "texEnvColor");
-#ifndef DISABLE_TEXTURE_COMBINER
-	ffp_fragment_params[RGB_SCALE_PASS_0_UNIF] = sceGxmProgramFindParameterByName(ffp_fragment_program, "pass0_rgb_scale");
-	ffp_fragment_params[ALPHA_SCALE_PASS_0_UNIF] = sceGxmProgramFindParameterByName(ffp_fragment_program, "pass0_a_scale");
-	ffp_fragment_params[RGB_SCALE_PASS_1_UNIF] = sceGxmProgramFindParameterByName(ffp_fragment_program, "pass1_rgb_scale");
-	ffp_fragment_params[ALPHA_SCALE_PASS_1_UNIF] = sceGxmProgramFindParameterByName(ffp_fragment_program, "pass1_a_scale");
-#ifdef HAVE_HIGH_FFP_TEXUNITS
-	ffp_fragment_params[RGB_SCALE_PASS_2_UNIF] = sceGxmProgramFindParameterByName(ffp_fragment_program, "pass2_rgb_scale");
-	ffp_fragment_params[ALPHA_SCALE_PASS_2_UNIF] = sceGxmProgramFindParameterByName(ffp_fragment_program, "pass2_a_scale");
-#endif
-#endif
-	ffp_fragment_params[TINT_COLOR_UNIF] = sceGxmProgramFindParameterByName(ffp_fragment_program, "tintColor");
-	ffp_fragment_params[FOG_RANGE_UNIF] = sceGxmProgramFindParameterByName(ffp_fragment_program, "fog_range");
-	ffp_fragment_params[FOG_FAR_UNIF] = sceGxmProgramFindParameterByName(ffp_fragment_program, "fog_far");
-	ffp_fragment_params[FOG_DENSITY_UNIF] = sceGxmProgramFindParameterByName(ffp_fragment_program, "fog_density");
-	ffp_fragment_params[LIGHTS_AMBIENTS_F_UNIF] = sceGxmProgramFindParameterByName(ffp_fragment_program, "lights_ambients");
-	if (ffp_fragment_params[LIGHTS_AMBIENTS_F_UNIF]) {
-		ffp_fragment_params[LIGHTS_DIFFUSES_F_UNIF] = sceGxmProgramFindParameterByName(ffp_fragment_program, "lights_diffuses");
-		ffp_fragment_params[LIGHTS_SPECULARS_F_UNIF] = sceGxmProgramFindParameterByName(ffp_fragment_program, "lights_speculars");
-		ffp_fragment_params[LIGHTS_POSITIONS_F_UNIF] = sceGxmProgramFindParameterByName(ffp_fragment_program, "lights_positions");
-		ffp_fragment_params[LIGHTS_ATTENUATIONS_F_UNIF] = sceGxmProgramFindParameterByName(ffp_fragment_program, "lights_attenuations");
-		ffp_fragment_params[LIGHT_GLOBAL_AMBIENT_F_UNIF] = sceGxmProgramFindParameterByName(ffp_fragment_program, "light_global_ambient");
-	}
+	gxp_table_build(ffp_fragment_params, ffp_fragment_uniform_names, FRAGMENT_UNIFORMS_NUM, ffp_fragment_program, find_ffp_param);
 }
 
 #ifndef DISABLE_TEXTURE_COMBINER
@@ -397,7 +464,470 @@ void setup_combiner_pass(int i, char *dst) {
 }
 #endif
 
+#ifndef DISABLE_RAM_SHADER_CACHE
+typedef struct {
+	SceGxmProgram *frag;
+	SceGxmProgram *vert;
+	SceGxmShaderPatcherId frag_id;
+	SceGxmShaderPatcherId vert_id;
+	shader_mask mask;
+#ifndef DISABLE_TEXTURE_COMBINER
+	combiner_mask cmb_mask;
+#endif
+	uint32_t hash; // Hash of mask and cmb_mask
+	uint32_t hits; // Number of lookups served by this entry
+	gxp_param vert_params[VERTEX_UNIFORMS_NUM]; // Uniforms of vert, located when the shader got compiled or loaded
+	gxp_param frag_params[FRAGMENT_UNIFORMS_NUM]; // Uniforms of frag, located when the shader got compiled or loaded
+	gxp_param attrib_params[VERTEX_ATTRIB_PARAMS_NUM]; // Attributes of vert, located when the shader got compiled or loaded
+	int32_t lru_prev; // More recently used entry
+	int32_t lru_next; // Less recently used entry
+} cached_shader;
+static uint32_t shader_cache_capacity = SHADER_CACHE_SIZE; // Maximum number of cached shaders
+static cached_shader *shader_cache = NULL;
+static uint32_t *shader_cache_masks = NULL; // Shader masks of cached shaders, used for nearest variant lookups
+static int32_t *shader_cache_table = NULL; // Open addressing hash table of indices into shader_cache (-1 for empty slots)
+static uint32_t shader_cache_table_mask = 0;
+static uint32_t shader_cache_size = 0;
+static int32_t shader_cache_lru_head = -1; // Most recently used entry
+static int32_t shader_cache_lru_tail = -1; // Least recently used entry
+static uint32_t shader_cache_hits = 0;
+static uint32_t shader_cache_misses = 0;
+static uint32_t shader_cache_evictions = 0;
+
+#ifndef DISABLE_TEXTURE_COMBINER
+static inline uint32_t hash_ffp_shader(shader_mask mask, combiner_mask cmb_mask) {
+#ifdef HAVE_HIGH_FFP_TEXUNITS
+	uint64_t h = (mask.raw ^ cmb_mask.raw_low) * 0x9E3779B97F4A7C15ULL;
+	h = (h ^ cmb_mask.raw_high) * 0x9E3779B97F4A7C15ULL;
+#else
+	uint64_t h = mask.raw * 0x9E3779B97F4A7C15ULL;
+	h = (h ^ cmb_mask.raw) * 0x9E3779B97F4A7C15ULL;
+#endif
+	return (uint32_t)(h >> 32);
+}
+
+static inline GLboolean match_ffp_shader(cached_shader *s, uint32_t hash, shader_mask mask, combiner_mask cmb_mask) {
+#ifdef HAVE_HIGH_FFP_TEXUNITS
+	return s->hash == hash && s->mask.raw == mask.raw && s->cmb_mask.raw_high == cmb_mask.raw_high && s->cmb_mask.raw_low == cmb_mask.raw_low;
+#else
+	return s->hash == hash && s->mask.raw == mask.raw && s->cmb_mask.raw == cmb_mask.raw;
+#endif
+}
+#else
+static inline uint32_t hash_ffp_shader(shader_mask mask) {
+	return (uint32_t)((mask.raw * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+static inline GLboolean match_ffp_shader(cached_shader *s, uint32_t hash, shader_mask mask) {
+	return s->hash == hash && s->mask.raw == mask.raw;
+}
+#endif
+
+static void lru_unlink_ffp_shader(int32_t idx) {
+	cached_shader *s = &shader_cache[idx];
+	if (s->lru_prev >= 0)
+		shader_cache[s->lru_prev].lru_next = s->lru_next;
+	else
+		shader_cache_lru_head = s->lru_next;
+	if (s->lru_next >= 0)
+		shader_cache[s->lru_next].lru_prev = s->lru_prev;
+	else
+		shader_cache_lru_tail = s->lru_prev;
+}
+
+static void lru_push_ffp_shader(int32_t idx) {
+	cached_shader *s = &shader_cache[idx];
+	s->lru_prev = -1;
+	s->lru_next = shader_cache_lru_head;
+	if (shader_cache_lru_head >= 0)
+		shader_cache[shader_cache_lru_head].lru_prev = idx;
+	else
+		shader_cache_lru_tail = idx;
+	shader_cache_lru_head = idx;
+}
+
+static void table_remove_ffp_shader(int32_t idx) {
+	uint32_t i = shader_cache[idx].hash & shader_cache_table_mask;
+	while (shader_cache_table[i] != idx) {
+		i = (i + 1) & shader_cache_table_mask;
+	}
+
+	// Shifting back following entries of the probe chain so that no tombstone is required
+	for (uint32_t j = (i + 1) & shader_cache_table_mask; shader_cache_table[j] >= 0; j = (j + 1) & shader_cache_table_mask) {
+		uint32_t k = shader_cache[shader_cache_table[j]].hash & shader_cache_table_mask;
+		if (i <= j ? (k <= i || k > j) : (k <= i && k > j)) {
+			shader_cache_table[i] = shader_cache_table[j];
+			i = j;
+		}
+	}
+	shader_cache_table[i] = -1;
+}
+
+static GLboolean is_ffp_program_shared(int32_t idx, const SceGxmProgram *prog) {
+	// Entries cached after a change affecting only one stage share the program of the other one
+	if (prog == ffp_vertex_program || prog == ffp_fragment_program)
+		return GL_TRUE;
+	for (uint32_t i = 0; i < shader_cache_size; i++) {
+		if ((int32_t)i != idx && (shader_cache[i].vert == prog || shader_cache[i].frag == prog))
+			return GL_TRUE;
+	}
+	return GL_FALSE;
+}
+
+static void release_cached_ffp_shader(int32_t idx) {
+	cached_shader *s = &shader_cache[idx];
+	if (!is_ffp_program_shared(idx, s->vert)) {
+		release_linked_fragment_programs(&ffp_fragment_patches, s->vert);
+		patch_cache_drop_tag(&ffp_vertex_patches, (uintptr_t)s->vert_id, NULL);
+		sceGxmShaderPatcherForceUnregisterProgram(gxm_shader_patcher, s->vert_id);
+		vgl_free(s->vert);
+	}
+	if (!is_ffp_program_shared(idx, s->frag)) {
+		patch_cache_drop_tag(&ffp_fragment_patches, (uintptr_t)s->frag_id, NULL);
+		sceGxmShaderPatcherForceUnregisterProgram(gxm_shader_patcher, s->frag_id);
+		vgl_free(s->frag);
+	}
+}
+
+void init_ffp_shader_cache() {
+	uint32_t table_size = 1;
+	while (table_size < shader_cache_capacity * 2) {
+		table_size <<= 1;
+	}
+	shader_cache = (cached_shader *)vglMalloc(shader_cache_capacity * sizeof(cached_shader));
+	shader_cache_masks = (uint32_t *)vglMalloc(shader_cache_capacity * sizeof(uint32_t));
+	shader_cache_table = (int32_t *)vglMalloc(table_size * sizeof(int32_t));
+	sceClibMemset(shader_cache_table, 0xFF, table_size * sizeof(int32_t));
+	shader_cache_table_mask = table_size - 1;
+	shader_cache_size = 0;
+	shader_cache_lru_head = -1;
+	shader_cache_lru_tail = -1;
+	shader_cache_hits = 0;
+	shader_cache_misses = 0;
+	shader_cache_evictions = 0;
+}
+
+#ifndef DISABLE_TEXTURE_COMBINER
+int lookup_ffp_shader(shader_mask mask, combiner_mask cmb_mask) {
+	uint32_t hash = hash_ffp_shader(mask, cmb_mask);
+#else
+int lookup_ffp_shader(shader_mask mask) {
+	uint32_t hash = hash_ffp_shader(mask);
+#endif
+	for (uint32_t i = hash & shader_cache_table_mask; shader_cache_table[i] >= 0; i = (i + 1) & shader_cache_table_mask) {
+		int32_t idx = shader_cache_table[i];
+#ifndef DISABLE_TEXTURE_COMBINER
+		if (match_ffp_shader(&shader_cache[idx], hash, mask, cmb_mask)) {
+#else
+		if (match_ffp_shader(&shader_cache[idx], hash, mask)) {
+#endif
+			// Moving the entry on top of the LRU list
+			if (idx != shader_cache_lru_head) {
+				lru_unlink_ffp_shader(idx);
+				lru_push_ffp_shader(idx);
+			}
+			shader_cache[idx].hits++;
+			shader_cache_hits++;
+			return idx;
+		}
+	}
+	shader_cache_misses++;
+	return -1;
+}
+
+void restore_ffp_shader(int idx) {
+	cached_shader *s = &shader_cache[idx];
+	ffp_vertex_program = s->vert;
+	ffp_fragment_program = s->frag;
+	ffp_vertex_program_id = s->vert_id;
+	ffp_fragment_program_id = s->frag_id;
+
+	// Parameters got already located when the shaders were cached
+	vgl_fast_memcpy(ffp_vertex_params, s->vert_params, sizeof(ffp_vertex_params));
+	vgl_fast_memcpy(ffp_fragment_params, s->frag_params, sizeof(ffp_fragment_params));
+	vgl_fast_memcpy(ffp_vertex_attrib_params, s->attrib_params, sizeof(ffp_vertex_attrib_params));
+}
+
+#ifndef DISABLE_TEXTURE_COMBINER
+void cache_ffp_shader(shader_mask mask, combiner_mask cmb_mask) {
+#else
+void cache_ffp_shader(shader_mask mask) {
+#endif
+	int32_t idx;
+	if (shader_cache_size < shader_cache_capacity)
+		idx = shader_cache_size++;
+	else {
+		// Evicting least recently used shader
+		idx = shader_cache_lru_tail;
+		lru_unlink_ffp_shader(idx);
+		table_remove_ffp_shader(idx);
+		release_cached_ffp_shader(idx);
+
+		// Programs may get allocated again at the same address, so uniform blocks layouts must not be trusted anymore
+		ffp_vertex_block_prog = NULL;
+		ffp_fragment_block_prog = NULL;
+		shader_cache_evictions++;
+	}
+
+	cached_shader *s = &shader_cache[idx];
+	s->mask.raw = mask.raw;
+#ifndef DISABLE_TEXTURE_COMBINER
+#ifdef HAVE_HIGH_FFP_TEXUNITS
+	s->cmb_mask.raw_low = cmb_mask.raw_low;
+	s->cmb_mask.raw_high = cmb_mask.raw_high;
+#else
+	s->cmb_mask.raw = cmb_mask.raw;
+#endif
+	s->hash = hash_ffp_shader(mask, cmb_mask);
+#else
+	s->hash = hash_ffp_shader(mask);
+#endif
+	s->frag = ffp_fragment_program;
+	s->vert = ffp_vertex_program;
+	s->frag_id = ffp_fragment_program_id;
+	s->vert_id = ffp_vertex_program_id;
+	s->hits = 0;
+	vgl_fast_memcpy(s->vert_params, ffp_vertex_params, sizeof(ffp_vertex_params));
+	vgl_fast_memcpy(s->frag_params, ffp_fragment_params, sizeof(ffp_fragment_params));
+	vgl_fast_memcpy(s->attrib_params, ffp_vertex_attrib_params, sizeof(ffp_vertex_attrib_params));
+	shader_cache_masks[idx] = mask.raw;
+
+	uint32_t i = s->hash & shader_cache_table_mask;
+	while (shader_cache_table[i] >= 0) {
+		i = (i + 1) & shader_cache_table_mask;
+	}
+	shader_cache_table[i] = idx;
+	lru_push_ffp_shader(idx);
+}
+#else
+void init_ffp_shader_cache() {
+}
+#endif
+
+void term_ffp_shader_cache() {
+	// Patched programs must be released while the shader patcher is still alive
+	release_patched_programs(&ffp_vertex_patches, &ffp_fragment_patches);
+#ifndef DISABLE_RAM_SHADER_CACHE
+	if (shader_cache) {
+		// In use ffp shaders are cached too, so every program gets released along with its last entry
+		ffp_vertex_program = NULL;
+		ffp_fragment_program = NULL;
+		while (shader_cache_size) {
+			shader_cache_size--;
+			release_cached_ffp_shader(shader_cache_size);
+		}
+		vgl_free(shader_cache);
+		vgl_free(shader_cache_masks);
+		vgl_free(shader_cache_table);
+		shader_cache = NULL;
+		shader_cache_masks = NULL;
+		shader_cache_table = NULL;
+	}
+#endif
+	ffp_vertex_block_prog = NULL;
+	ffp_fragment_block_prog = NULL;
+
+	// In use ffp shaders went away too, so the next vitaGL instance must select them again (lights_num can't exceed MAX_LIGHTS_NUM, so no real mask is all ones)
+	ffp_mask.raw = 0xFFFFFFFF;
+#ifndef DISABLE_TEXTURE_COMBINER
+#ifdef HAVE_HIGH_FFP_TEXUNITS
+	ffp_combiner_mask.raw_high = 0xFFFFFFFFFFFFFFFFULL;
+	ffp_combiner_mask.raw_low = 0xFFFFFFFF;
+#else
+	ffp_combiner_mask.raw = 0xFFFFFFFFFFFFFFFFULL;
+#endif
+#endif
+	ffp_dirty_vert = GL_TRUE;
+	ffp_dirty_frag = GL_TRUE;
+}
+
+#ifndef DISABLE_FS_SHADER_CACHE
+#ifndef DISABLE_TEXTURE_COMBINER
+void get_ffp_shader_fname(char *dst, shader_mask mask, combiner_mask cmb_mask, char stage, const char *ext) {
+#ifdef HAVE_HIGH_FFP_TEXUNITS
+	sprintf(dst, "ux0:data/shader_cache/v%d-%08X-%016" PRIX64 "-%08X_%c.%s", SHADER_CACHE_MAGIC, mask.raw, cmb_mask.raw_high, cmb_mask.raw_low, stage, ext);
+#else
+	sprintf(dst, "ux0:data/shader_cache/v%d-%08X-%016" PRIX64 "_%c.%s", SHADER_CACHE_MAGIC, mask.raw, cmb_mask.raw, stage, ext);
+#endif
+}
+#else
+void get_ffp_shader_fname(char *dst, shader_mask mask, char stage, const char *ext) {
+	sprintf(dst, "ux0:data/shader_cache/v%d-%08X-0000000000000000_%c.%s", SHADER_CACHE_MAGIC, mask.raw, stage, ext);
+}
+#endif
+
+static shader_archive ffp_archive; // Filesystem layer cache for ffp, blobs are keyed by the name they used to have as loose files
+
+void init_ffp_shader_archive() {
+	shader_archive_close(&ffp_archive);
+	shader_archive_open(&ffp_archive, SHADER_ARCHIVE_PATH, SHADER_CACHE_MAGIC);
+
+	// Moving shaders cached as loose files by previous vitaGL versions into the archive
+	char prefix[16];
+	sprintf(prefix, "v%d-", SHADER_CACHE_MAGIC);
+	shader_archive_import_dir(&ffp_archive, "ux0:data/shader_cache", prefix, ".gxp", 1);
+
+	// Compacting the journal now rather than while rendering
+	if (ffp_archive.records >= SHADER_ARCHIVE_COMPACT_RECORDS)
+		shader_archive_compact(&ffp_archive);
+}
+
+static SceGxmProgram *load_ffp_shader(const char *fname) {
+	const shader_archive_entry *e = shader_archive_find(&ffp_archive, shader_archive_key(fname));
+	if (!e)
+		return NULL;
+	SceGxmProgram *p = (SceGxmProgram *)vglMalloc(e->size);
+	if (p && !shader_archive_read(&ffp_archive, e, p)) {
+		vgl_free(p);
+		return NULL;
+	}
+	return p;
+}
+
+static void store_ffp_shader(const char *fname, const void *bin, uint32_t size) {
+	shader_archive_append(&ffp_archive, shader_archive_key(fname), bin, size);
+}
+#else
+void init_ffp_shader_archive() {
+}
+#endif
+
+void build_ffp_vertex_shader(char *dst, shader_mask mask) {
+	sprintf(dst, ffp_vert_src, mask.clip_planes_num, mask.num_textures, mask.has_colors, mask.lights_num, mask.shading_mode, mask.normalize, mask.fixed_mask, mask.pos_fixed_mask);
+}
+
+void build_ffp_fragment_shader(char *dst, shader_mask mask) {
+	char texenv_shad[8192] = {0};
+	GLboolean unused_mode[5] = {GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE};
+	for (int i = 0; i < mask.num_textures; i++) {
+		char tmp[1024];
+		switch (texture_units[i].env_mode) {
+		case MODULATE:
+			if (unused_mode[MODULATE]) {
+				sprintf(texenv_shad, "%s\n%s", texenv_shad, modulate_src);
+				unused_mode[MODULATE] = GL_FALSE;
+			}
+			break;
+		case DECAL:
+			if (unused_mode[DECAL]) {
+				sprintf(texenv_shad, "%s\n%s", texenv_shad, decal_src);
+				unused_mode[DECAL] = GL_FALSE;
+			}
+			break;
+		case BLEND:
+			if (unused_mode[BLEND]) {
+				sprintf(texenv_shad, "%s\n%s", texenv_shad, blend_src);
+				unused_mode[BLEND] = GL_FALSE;
+			}
+			break;
+		case ADD:
+			if (unused_mode[ADD]) {
+				sprintf(texenv_shad, "%s\n%s", texenv_shad, add_src);
+				unused_mode[ADD] = GL_FALSE;
+			}
+			break;
+		case REPLACE:
+			if (unused_mode[REPLACE]) {
+				sprintf(texenv_shad, "%s\n%s", texenv_shad, replace_src);
+				unused_mode[REPLACE] = GL_FALSE;
+			}
+			break;
+#ifndef DISABLE_TEXTURE_COMBINER
+		case COMBINE:
+			setup_combiner_pass(i, tmp);
+			sprintf(texenv_shad, "%s\n%s", texenv_shad, tmp);
+			break;
+#endif
+		default:
+			break;
+		}
+	}
+#ifdef HAVE_HIGH_FFP_TEXUNITS
+	sprintf(dst, ffp_frag_src, texenv_shad, alpha_op,
+		mask.num_textures, mask.has_colors, mask.fog_mode,
+		mask.tex_env_mode_pass0 != COMBINE ? mask.tex_env_mode_pass0 : 50,
+		mask.tex_env_mode_pass1 != COMBINE ? mask.tex_env_mode_pass1 : 51,
+		mask.tex_env_mode_pass2 != COMBINE ? mask.tex_env_mode_pass2 : 52,
+		mask.lights_num, mask.shading_mode);
+#else
+	sprintf(dst, ffp_frag_src, texenv_shad, alpha_op,
+		mask.num_textures, mask.has_colors, mask.fog_mode,
+		mask.tex_env_mode_pass0 != COMBINE ? mask.tex_env_mode_pass0 : 50,
+		mask.tex_env_mode_pass1 != COMBINE ? mask.tex_env_mode_pass1 : 51,
+		mask.lights_num, mask.shading_mode);
+#endif
+}
+
+#ifndef DISABLE_FS_SHADER_CACHE
+static GLboolean is_ffp_fallback = GL_FALSE; // Flag for when a fallback shader is in use while waiting for the background compiler
+
+#ifndef DISABLE_TEXTURE_COMBINER
+GLboolean prepare_async_ffp_shader(int type, shader_mask mask, combiner_mask cmb_mask) {
+#else
+GLboolean prepare_async_ffp_shader(int type, shader_mask mask) {
+#endif
+	char fname[256];
+	uint32_t key_data[5] = {type, mask.raw, 0, 0, 0};
+#ifndef DISABLE_TEXTURE_COMBINER
+#ifdef HAVE_HIGH_FFP_TEXUNITS
+	key_data[2] = cmb_mask.raw_low;
+	key_data[3] = cmb_mask.raw_high & 0xFFFFFFFF;
+	key_data[4] = cmb_mask.raw_high >> 32;
+#else
+	key_data[2] = cmb_mask.raw & 0xFFFFFFFF;
+	key_data[3] = cmb_mask.raw >> 32;
+#endif
+	get_ffp_shader_fname(fname, mask, cmb_mask, type == SHARK_VERTEX_SHADER ? 'v' : 'f', "gxp");
+#else
+	get_ffp_shader_fname(fname, mask, type == SHARK_VERTEX_SHADER ? 'v' : 'f', "gxp");
+#endif
+	uint64_t key = shader_cache_hash_finalize(shader_cache_hash(key_data, sizeof(key_data), SHADER_HASH_SEED));
+
+	compile_job *job = compile_queue_find(key);
+	if (!job) {
+		// Checking if the shader is already available in filesystem cache
+		if (shader_archive_find(&ffp_archive, shader_archive_key(fname)))
+			return GL_TRUE;
+
+		// Enqueueing the shader to the background compiler
+		char src[8192];
+		if (type == SHARK_VERTEX_SHADER)
+			build_ffp_vertex_shader(src, mask);
+		else
+			build_ffp_fragment_shader(src, mask);
+		return compile_queue_submit(key, type, src, strlen(src)) ? GL_FALSE : GL_TRUE;
+	}
+	if (!compile_job_is_complete(job))
+		return GL_FALSE;
+
+	// Saving compiled shader in filesystem cache so that it gets picked up by the standard path
+	if (job->status == COMPILE_JOB_DONE)
+		store_ffp_shader(fname, job->bin, job->bin_size);
+	compile_queue_release(job);
+	return GL_TRUE;
+}
+
+#ifndef DISABLE_RAM_SHADER_CACHE
+int get_nearest_ffp_shader(shader_mask mask) {
+	// Cached shaders must share vertex layout and uniforms sizes with the requested one to be usable
+	shader_mask compat_mask = {.raw = 0};
+	compat_mask.num_textures = 0x3;
+	compat_mask.has_colors = 0x1;
+	compat_mask.clip_planes_num = 0x7;
+	compat_mask.lights_num = 0xF;
+#ifdef HAVE_HIGH_FFP_TEXUNITS
+	compat_mask.fixed_mask = 0xF;
+#else
+	compat_mask.fixed_mask = 0x7;
+#endif
+	compat_mask.pos_fixed_mask = 0x3;
+
+	return compile_find_nearest_variant(shader_cache_masks, shader_cache_size, mask.raw, compat_mask.raw);
+}
+#endif
+#endif
 uint8_t reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *streams) {
+	PROFILE_ZONE(RELOAD_FFP_SHADERS);
 	// Checking if mask changed
 	GLboolean ffp_dirty_frag_blend = ffp_blend_info.raw != blend_info.raw;
 	shader_mask mask = {.raw = 0};
@@ -416,6 +946,13 @@ uint8_t reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *str
 	mask.fixed_mask = ffp_vertex_attrib_fixed_mask;
 	mask.pos_fixed_mask = ffp_vertex_attrib_fixed_pos_mask;
 	uint8_t draw_mask_state = ffp_vertex_attrib_state;
+
+	// Immediate mode draws override the attributes state without going through its setters
+	if (ffp_vertex_attrib_state != ffp_reload_attrib_state) {
+		ffp_dirty_vert = GL_TRUE;
+		ffp_dirty_frag = GL_TRUE;
+		ffp_reload_attrib_state = ffp_vertex_attrib_state;
+	}
 	
 	// Counting number of enabled texture units
 	mask.num_textures = 0;
@@ -505,32 +1042,60 @@ uint8_t reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *str
 		ffp_dirty_vert = GL_FALSE;
 		ffp_dirty_frag = GL_FALSE;
 	} else {
+#ifndef DISABLE_FS_SHADER_CACHE
+		// Fallback shader got replaced, so both shaders need to be reloaded
+		if (is_ffp_fallback) {
+			ffp_dirty_vert = GL_TRUE;
+			ffp_dirty_frag = GL_TRUE;
+			is_ffp_fallback = GL_FALSE;
+		}
+#endif
 #ifndef DISABLE_RAM_SHADER_CACHE
-		for (int i = 0; i < shader_cache_size; i++) {
 #ifdef DISABLE_TEXTURE_COMBINER
-			if (shader_cache[i].mask.raw == mask.raw) {
+		int i = lookup_ffp_shader(mask);
 #else
-#ifdef HAVE_HIGH_FFP_TEXUNITS
-			if (shader_cache[i].mask.raw == mask.raw && shader_cache[i].cmb_mask.raw_high == cmb_mask.raw_high && shader_cache[i].cmb_mask.raw_low == cmb_mask.raw_low) { // Fixed function pipeline config didn't change
+		int i = lookup_ffp_shader(mask, cmb_mask);
+#endif
+		if (i >= 0) {
+			restore_ffp_shader(i);
+			ffp_dirty_frag_blend = GL_TRUE;
+			ffp_dirty_vert = GL_FALSE;
+			ffp_dirty_frag = GL_FALSE;
+		}
+#endif
+#ifndef DISABLE_FS_SHADER_CACHE
+		// Checking if required shaders are still being compiled in background
+		if (async_shader_compiler && (ffp_dirty_vert || ffp_dirty_frag)) {
+			GLboolean is_ready = GL_TRUE;
+#ifndef DISABLE_TEXTURE_COMBINER
+			if (ffp_dirty_vert && !prepare_async_ffp_shader(SHARK_VERTEX_SHADER, mask, cmb_mask))
+				is_ready = GL_FALSE;
+			if (ffp_dirty_frag && !prepare_async_ffp_shader(SHARK_FRAGMENT_SHADER, mask, cmb_mask))
+				is_ready = GL_FALSE;
 #else
-			if (shader_cache[i].mask.raw == mask.raw && shader_cache[i].cmb_mask.raw == cmb_mask.raw) {
+			if (ffp_dirty_vert && !prepare_async_ffp_shader(SHARK_VERTEX_SHADER, mask))
+				is_ready = GL_FALSE;
+			if (ffp_dirty_frag && !prepare_async_ffp_shader(SHARK_FRAGMENT_SHADER, mask))
+				is_ready = GL_FALSE;
 #endif
+			if (!is_ready) {
+#ifndef DISABLE_RAM_SHADER_CACHE
+				// Drawing with the nearest compatible cached shader, if any
+				int i = async_fallback_mode == VGL_ASYNC_FALLBACK_NEAREST ? get_nearest_ffp_shader(mask) : -1;
+				if (i < 0)
+					return 0;
+				mask.raw = shader_cache[i].mask.raw;
+#ifndef DISABLE_TEXTURE_COMBINER
+				cmb_mask = shader_cache[i].cmb_mask;
 #endif
-				ffp_vertex_program = shader_cache[i].vert;
-				ffp_fragment_program = shader_cache[i].frag;
-				ffp_vertex_program_id = shader_cache[i].vert_id;
-				ffp_fragment_program_id = shader_cache[i].frag_id;
+				restore_ffp_shader(i);
 				ffp_dirty_frag_blend = GL_TRUE;
-
-				if (ffp_dirty_vert)
-					reload_vertex_uniforms();
-
-				if (ffp_dirty_frag)
-					reload_fragment_uniforms();
-
 				ffp_dirty_vert = GL_FALSE;
 				ffp_dirty_frag = GL_FALSE;
-				break;
+				is_ffp_fallback = GL_TRUE;
+#else
+				return 0;
+#endif
 			}
 		}
 #endif
@@ -554,55 +1119,40 @@ uint8_t reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *str
 #ifndef DISABLE_FS_SHADER_CACHE
 		char fname[256];
 #ifndef DISABLE_TEXTURE_COMBINER
-#ifdef HAVE_HIGH_FFP_TEXUNITS
-		sprintf(fname, "ux0:data/shader_cache/v%d-%08X-%016llX-%08X_v.gxp", SHADER_CACHE_MAGIC, mask.raw, cmb_mask.raw_high, cmb_mask.raw_low);
+		get_ffp_shader_fname(fname, mask, cmb_mask, 'v', "gxp");
 #else
-		sprintf(fname, "ux0:data/shader_cache/v%d-%08X-%016llX_v.gxp", SHADER_CACHE_MAGIC, mask.raw, cmb_mask.raw);
+		get_ffp_shader_fname(fname, mask, 'v', "gxp");
 #endif
-#else
-		sprintf(fname, "ux0:data/shader_cache/v%d-%08X-0000000000000000_v.gxp", SHADER_CACHE_MAGIC, mask.raw);
-#endif
-		FILE *f = fopen(fname, "rb");
-		if (f) {
-			// Gathering the precompiled shader from cache
-			fseek(f, 0, SEEK_END);
-			uint32_t size = ftell(f);
-			fseek(f, 0, SEEK_SET);
-			ffp_vertex_program = (SceGxmProgram *)vglMalloc(size);
-			fread(ffp_vertex_program, 1, size, f);
-			fclose(f);
-		} else
+		// Gathering the precompiled shader from cache
+		ffp_vertex_program = load_ffp_shader(fname);
+		if (!ffp_vertex_program)
 #endif
 		{
 			// Restarting vitaShaRK if we released it before
+			compile_lock();
 			if (!is_shark_online)
 				startShaderCompiler();
 
 			// Compiling the new shader
 			char vshader[8192];
-			sprintf(vshader, ffp_vert_src, mask.clip_planes_num, mask.num_textures, mask.has_colors, mask.lights_num, mask.shading_mode, mask.normalize, mask.fixed_mask, mask.pos_fixed_mask);
+			build_ffp_vertex_shader(vshader, mask);
 			uint32_t size = strlen(vshader);
 			SceGxmProgram *t = shark_compile_shader_extended(vshader, &size, SHARK_VERTEX_SHADER, compiler_opts, compiler_fastmath, compiler_fastprecision, compiler_fastint);
 			ffp_vertex_program = (SceGxmProgram *)vglMalloc(size);
 			vgl_fast_memcpy((void *)ffp_vertex_program, (void *)t, size);
 			shark_clear_output();
+			compile_unlock();
 #ifndef DISABLE_FS_SHADER_CACHE
 			// Saving compiled shader in filesystem cache
-			f = fopen(fname, "wb");
-			fwrite(ffp_vertex_program, 1, size, f);
-			fclose(f);
+			store_ffp_shader(fname, ffp_vertex_program, size);
 #ifdef DUMP_SHADER_SOURCES
 #ifndef DISABLE_TEXTURE_COMBINER
-#ifdef HAVE_HIGH_FFP_TEXUNITS
-			sprintf(fname, "ux0:data/shader_cache/v%d-%08X-%016llX-%08X_v.cg", SHADER_CACHE_MAGIC, mask.raw, cmb_mask.raw_high, cmb_mask.raw_low);
-#else
-			sprintf(fname, "ux0:data/shader_cache/v%d-%08X-%016llX_v.cg", SHADER_CACHE_MAGIC, mask.raw, cmb_mask.raw);
-#endif
+			get_ffp_shader_fname(fname, mask, cmb_mask, 'v', "cg");
 #else
-			sprintf(fname, "ux0:data/shader_cache/v%d-%08X-0000000000000000_v.cg", SHADER_CACHE_MAGIC, mask.raw);
+			get_ffp_shader_fname(fname, mask, 'v', "cg");
 #endif
 			// Saving shader source in filesystem cache
-			f = fopen(fname, "wb");
+			FILE *f = fopen(fname, "wb");
 			fwrite(vshader, 1, strlen(vshader), f);
 			fclose(f);
 #endif
@@ -626,18 +1176,15 @@ uint8_t reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *str
 	ffp_vertex_num_params = 1;
 	if (attrs) { // Immediate mode and non-immediate only when #textures == 1
 		// Vertex positions
-		const SceGxmProgramParameter *param = sceGxmProgramFindParameterByName(ffp_vertex_program, "position");
-		attrs[0].regIndex = sceGxmProgramParameterGetResourceIndex(param);
+		attrs[0].regIndex = ffp_vertex_attrib_params[POSITION_ATTRIB].res_index;
 
 		if (mask.num_textures > 0) {
 			// Vertex texture coordinates (First Pass)
-			param = sceGxmProgramFindParameterByName(ffp_vertex_program, "texcoord0");
-			attrs[1].regIndex = sceGxmProgramParameterGetResourceIndex(param);
+			attrs[1].regIndex = ffp_vertex_attrib_params[TEXCOORD0_ATTRIB].res_index;
 
 			// Vertex texture coordinates (Second Pass)
 			if (mask.num_textures > 1) {
-				param = sceGxmProgramFindParameterByName(ffp_vertex_program, "texcoord1");
-				attrs[2].regIndex = sceGxmProgramParameterGetResourceIndex(param);
+				attrs[2].regIndex = ffp_vertex_attrib_params[TEXCOORD1_ATTRIB].res_index;
 				ffp_vertex_num_params += 2;
 			} else
 				ffp_vertex_num_params += 1;
@@ -645,36 +1192,29 @@ uint8_t reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *str
 
 		// Vertex colors
 		if (mask.has_colors) {
-			param = sceGxmProgramFindParameterByName(ffp_vertex_program, "color");
-			attrs[ffp_vertex_num_params++].regIndex = sceGxmProgramParameterGetResourceIndex(param);
+			attrs[ffp_vertex_num_params++].regIndex = ffp_vertex_attrib_params[COLOR_ATTRIB].res_index;
 		}
 
 		// Lighting data
 		if (mask.lights_num > 0) {
-			param = sceGxmProgramFindParameterByName(ffp_vertex_program, "diff");
-			attrs[ffp_vertex_num_params++].regIndex = sceGxmProgramParameterGetResourceIndex(param);
-			param = sceGxmProgramFindParameterByName(ffp_vertex_program, "spec");
-			attrs[ffp_vertex_num_params++].regIndex = sceGxmProgramParameterGetResourceIndex(param);
-			param = sceGxmProgramFindParameterByName(ffp_vertex_program, "emission");
-			attrs[ffp_vertex_num_params++].regIndex = sceGxmProgramParameterGetResourceIndex(param);
-			param = sceGxmProgramFindParameterByName(ffp_vertex_program, "normals");
-			attrs[ffp_vertex_num_params++].regIndex = sceGxmProgramParameterGetResourceIndex(param);
+			attrs[ffp_vertex_num_params++].regIndex = ffp_vertex_attrib_params[DIFFUSE_ATTRIB].res_index;
+			attrs[ffp_vertex_num_params++].regIndex = ffp_vertex_attrib_params[SPECULAR_ATTRIB].res_index;
+			attrs[ffp_vertex_num_params++].regIndex = ffp_vertex_attrib_params[EMISSION_ATTRIB].res_index;
+			attrs[ffp_vertex_num_params++].regIndex = ffp_vertex_attrib_params[NORMAL_ATTRIB].res_index;
 		}
 	} else { // Non immediate mode
 		// Vertex positions
-		const SceGxmProgramParameter *param = sceGxmProgramFindParameterByName(ffp_vertex_program, "position");
 		vgl_fast_memcpy(&ffp_vertex_attribute[0], &ffp_vertex_attrib_config[0], sizeof(SceGxmVertexAttribute));
 		ffp_vertex_attribute[0].streamIndex = 0;
-		ffp_vertex_attribute[0].regIndex = sceGxmProgramParameterGetResourceIndex(param);
+		ffp_vertex_attribute[0].regIndex = ffp_vertex_attrib_params[POSITION_ATTRIB].res_index;
 		ffp_vertex_stream[0].stride = ffp_vertex_stream_config[0].stride;
 		ffp_vertex_stream[0].indexSource = SCE_GXM_INDEX_SOURCE_INDEX_16BIT;
 
 		// Vertex texture coordinates (First pass)
 		if (mask.num_textures > 0) {
-			param = sceGxmProgramFindParameterByName(ffp_vertex_program, "texcoord0");
 			vgl_fast_memcpy(&ffp_vertex_attribute[1], &ffp_vertex_attrib_config[texcoord_idxs[0]], sizeof(SceGxmVertexAttribute));
 			ffp_vertex_attribute[1].streamIndex = 1;
-			ffp_vertex_attribute[1].regIndex = sceGxmProgramParameterGetResourceIndex(param);
+			ffp_vertex_attribute[1].regIndex = ffp_vertex_attrib_params[TEXCOORD0_ATTRIB].res_index;
 			ffp_vertex_stream[1].stride = ffp_vertex_stream_config[texcoord_idxs[0]].stride;
 			ffp_vertex_stream[1].indexSource = SCE_GXM_INDEX_SOURCE_INDEX_16BIT;
 			ffp_vertex_num_params++;
@@ -682,50 +1222,45 @@ uint8_t reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *str
 
 		// Vertex colors
 		if (mask.has_colors) {
-			param = sceGxmProgramFindParameterByName(ffp_vertex_program, "color");
 			vgl_fast_memcpy(&ffp_vertex_attribute[ffp_vertex_num_params], &ffp_vertex_attrib_config[2], sizeof(SceGxmVertexAttribute));
 			ffp_vertex_attribute[ffp_vertex_num_params].streamIndex = ffp_vertex_num_params;
-			ffp_vertex_attribute[ffp_vertex_num_params].regIndex = sceGxmProgramParameterGetResourceIndex(param);
+			ffp_vertex_attribute[ffp_vertex_num_params].regIndex = ffp_vertex_attrib_params[COLOR_ATTRIB].res_index;
 			ffp_vertex_stream[ffp_vertex_num_params].stride = ffp_vertex_stream_config[2].stride;
 			ffp_vertex_stream[ffp_vertex_num_params].indexSource = SCE_GXM_INDEX_SOURCE_INDEX_16BIT;
 			ffp_vertex_num_params++;
 		}
 		
 		if (mask.lights_num > 0) {	
-			param = sceGxmProgramFindParameterByName(ffp_vertex_program, "diff");
 			vgl_fast_memcpy(&ffp_vertex_attribute[ffp_vertex_num_params], &ffp_vertex_attrib_config[3], sizeof(SceGxmVertexAttribute));
 			ffp_vertex_attribute[ffp_vertex_num_params].format = SCE_GXM_ATTRIBUTE_FORMAT_F32;
 			ffp_vertex_attribute[ffp_vertex_num_params].componentCount = 4;
 			ffp_vertex_attribute[ffp_vertex_num_params].streamIndex = ffp_vertex_num_params;
-			ffp_vertex_attribute[ffp_vertex_num_params].regIndex = sceGxmProgramParameterGetResourceIndex(param);
+			ffp_vertex_attribute[ffp_vertex_num_params].regIndex = ffp_vertex_attrib_params[DIFFUSE_ATTRIB].res_index;
 			ffp_vertex_stream[ffp_vertex_num_params].stride = ffp_vertex_stream_config[3].stride;
 			ffp_vertex_stream[ffp_vertex_num_params].indexSource = SCE_GXM_INDEX_SOURCE_INDEX_16BIT;
 			ffp_vertex_num_params++;
 			
-			param = sceGxmProgramFindParameterByName(ffp_vertex_program, "spec");
 			vgl_fast_memcpy(&ffp_vertex_attribute[ffp_vertex_num_params], &ffp_vertex_attrib_config[4], sizeof(SceGxmVertexAttribute));
 			ffp_vertex_attribute[ffp_vertex_num_params].format = SCE_GXM_ATTRIBUTE_FORMAT_F32;
 			ffp_vertex_attribute[ffp_vertex_num_params].componentCount = 4;
 			ffp_vertex_attribute[ffp_vertex_num_params].streamIndex = ffp_vertex_num_params;
-			ffp_vertex_attribute[ffp_vertex_num_params].regIndex = sceGxmProgramParameterGetResourceIndex(param);
+			ffp_vertex_attribute[ffp_vertex_num_params].regIndex = ffp_vertex_attrib_params[SPECULAR_ATTRIB].res_index;
 			ffp_vertex_stream[ffp_vertex_num_params].stride = ffp_vertex_stream_config[4].stride;
 			ffp_vertex_stream[ffp_vertex_num_params].indexSource = SCE_GXM_INDEX_SOURCE_INDEX_16BIT;
 			ffp_vertex_num_params++;
 			
-			param = sceGxmProgramFindParameterByName(ffp_vertex_program, "emission");
 			vgl_fast_memcpy(&ffp_vertex_attribute[ffp_vertex_num_params], &ffp_vertex_attrib_config[5], sizeof(SceGxmVertexAttribute));
 			ffp_vertex_attribute[ffp_vertex_num_params].format = SCE_GXM_ATTRIBUTE_FORMAT_F32;
 			ffp_vertex_attribute[ffp_vertex_num_params].componentCount = 4;
 			ffp_vertex_attribute[ffp_vertex_num_params].streamIndex = ffp_vertex_num_params;
-			ffp_vertex_attribute[ffp_vertex_num_params].regIndex = sceGxmProgramParameterGetResourceIndex(param);
+			ffp_vertex_attribute[ffp_vertex_num_params].regIndex = ffp_vertex_attrib_params[EMISSION_ATTRIB].res_index;
 			ffp_vertex_stream[ffp_vertex_num_params].stride = ffp_vertex_stream_config[5].stride;
 			ffp_vertex_stream[ffp_vertex_num_params].indexSource = SCE_GXM_INDEX_SOURCE_INDEX_16BIT;
 			ffp_vertex_num_params++;
 			
-			param = sceGxmProgramFindParameterByName(ffp_vertex_program, "normals");
 			vgl_fast_memcpy(&ffp_vertex_attribute[ffp_vertex_num_params], &ffp_vertex_attrib_config[6], sizeof(SceGxmVertexAttribute));
 			ffp_vertex_attribute[ffp_vertex_num_params].streamIndex = ffp_vertex_num_params;
-			ffp_vertex_attribute[ffp_vertex_num_params].regIndex = sceGxmProgramParameterGetResourceIndex(param);
+			ffp_vertex_attribute[ffp_vertex_num_params].regIndex = ffp_vertex_attrib_params[NORMAL_ATTRIB].res_index;
 			ffp_vertex_stream[ffp_vertex_num_params].stride = ffp_vertex_stream_config[6].stride;
 			ffp_vertex_stream[ffp_vertex_num_params].indexSource = SCE_GXM_INDEX_SOURCE_INDEX_16BIT;
 			ffp_vertex_num_params++;
@@ -733,20 +1268,18 @@ uint8_t reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *str
 
 		// Vertex texture coordinates (Second pass)
 		if (mask.num_textures > 1) {
-			param = sceGxmProgramFindParameterByName(ffp_vertex_program, "texcoord1");
 			vgl_fast_memcpy(&ffp_vertex_attribute[ffp_vertex_num_params], &ffp_vertex_attrib_config[texcoord_idxs[1]], sizeof(SceGxmVertexAttribute));
 			ffp_vertex_attribute[ffp_vertex_num_params].streamIndex = ffp_vertex_num_params;
-			ffp_vertex_attribute[ffp_vertex_num_params].regIndex = sceGxmProgramParameterGetResourceIndex(param);
+			ffp_vertex_attribute[ffp_vertex_num_params].regIndex = ffp_vertex_attrib_params[TEXCOORD1_ATTRIB].res_index;
 			ffp_vertex_stream[ffp_vertex_num_params].stride = ffp_vertex_stream_config[texcoord_idxs[1]].stride;
 			ffp_vertex_stream[ffp_vertex_num_params].indexSource = SCE_GXM_INDEX_SOURCE_INDEX_16BIT;
 			ffp_vertex_num_params++;
 #ifdef HAVE_HIGH_FFP_TEXUNITS
 			// Vertex texture coordinates (Third pass)
 			if (mask.num_textures > 2) {
-				param = sceGxmProgramFindParameterByName(ffp_vertex_program, "texcoord2");
 				vgl_fast_memcpy(&ffp_vertex_attribute[ffp_vertex_num_params], &ffp_vertex_attrib_config[texcoord_idxs[2]], sizeof(SceGxmVertexAttribute));
 				ffp_vertex_attribute[ffp_vertex_num_params].streamIndex = ffp_vertex_num_params;
-				ffp_vertex_attribute[ffp_vertex_num_params].regIndex = sceGxmProgramParameterGetResourceIndex(param);
+				ffp_vertex_attribute[ffp_vertex_num_params].regIndex = ffp_vertex_attrib_params[TEXCOORD2_ATTRIB].res_index;
 				ffp_vertex_stream[ffp_vertex_num_params].stride = ffp_vertex_stream_config[texcoord_idxs[2]].stride;
 				ffp_vertex_stream[ffp_vertex_num_params].indexSource = SCE_GXM_INDEX_SOURCE_INDEX_16BIT;
 				ffp_vertex_num_params++;
@@ -758,120 +1291,47 @@ uint8_t reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *str
 	}
 
 	// Creating patched vertex shader
-	patchVertexProgram(gxm_shader_patcher, ffp_vertex_program_id, attrs, ffp_vertex_num_params, streams, ffp_vertex_num_params, &ffp_vertex_program_patched);
+	patch_vertex_program_cached(&ffp_vertex_patches, ffp_vertex_program_id, attrs, ffp_vertex_num_params, streams, ffp_vertex_num_params, &ffp_vertex_program_patched);
 
 	// Checking if fragment shader requires a recompilation
 	if (ffp_dirty_frag) {
 #ifndef DISABLE_FS_SHADER_CACHE
 		char fname[256];
 #ifndef DISABLE_TEXTURE_COMBINER
-#ifdef HAVE_HIGH_FFP_TEXUNITS
-		sprintf(fname, "ux0:data/shader_cache/v%d-%08X-%016llX-%08X_f.cg", SHADER_CACHE_MAGIC, mask.raw, cmb_mask.raw_high, cmb_mask.raw_low);
+		get_ffp_shader_fname(fname, mask, cmb_mask, 'f', "gxp");
 #else
-		sprintf(fname, "ux0:data/shader_cache/v%d-%08X-%016llX_f.gxp", SHADER_CACHE_MAGIC, mask.raw, cmb_mask.raw);
+		get_ffp_shader_fname(fname, mask, 'f', "gxp");
 #endif
-#else
-		sprintf(fname, "ux0:data/shader_cache/v%d-%08X-0000000000000000_f.gxp", SHADER_CACHE_MAGIC, mask.raw);
-#endif
-		FILE *f = fopen(fname, "rb");
-		if (f) {
-			// Gathering the precompiled shader from cache
-			fseek(f, 0, SEEK_END);
-			uint32_t size = ftell(f);
-			fseek(f, 0, SEEK_SET);
-			ffp_fragment_program = (SceGxmProgram *)vglMalloc(size);
-			fread(ffp_fragment_program, 1, size, f);
-			fclose(f);
-		} else
+		// Gathering the precompiled shader from cache
+		ffp_fragment_program = load_ffp_shader(fname);
+		if (!ffp_fragment_program)
 #endif
 		{
 			// Restarting vitaShaRK if we released it before
+			compile_lock();
 			if (!is_shark_online)
 				startShaderCompiler();
 
 			// Compiling the new shader
 			char fshader[8192];
-			char texenv_shad[8192] = {0};
-			GLboolean unused_mode[5] = {GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE};
-			for (int i = 0; i < mask.num_textures; i++) {
-				char tmp[1024];
-				switch (texture_units[i].env_mode) {
-				case MODULATE:
-					if (unused_mode[MODULATE]) {
-						sprintf(texenv_shad, "%s\n%s", texenv_shad, modulate_src);
-						unused_mode[MODULATE] = GL_FALSE;
-					}
-					break;
-				case DECAL:
-					if (unused_mode[DECAL]) {
-						sprintf(texenv_shad, "%s\n%s", texenv_shad, decal_src);
-						unused_mode[DECAL] = GL_FALSE;
-					}
-					break;
-				case BLEND:
-					if (unused_mode[BLEND]) {
-						sprintf(texenv_shad, "%s\n%s", texenv_shad, blend_src);
-						unused_mode[BLEND] = GL_FALSE;
-					}
-					break;
-				case ADD:
-					if (unused_mode[ADD]) {
-						sprintf(texenv_shad, "%s\n%s", texenv_shad, add_src);
-						unused_mode[ADD] = GL_FALSE;
-					}
-					break;
-				case REPLACE:
-					if (unused_mode[REPLACE]) {
-						sprintf(texenv_shad, "%s\n%s", texenv_shad, replace_src);
-						unused_mode[REPLACE] = GL_FALSE;
-					}
-					break;
-#ifndef DISABLE_TEXTURE_COMBINER
-				case COMBINE:
-					setup_combiner_pass(i, tmp);
-					sprintf(texenv_shad, "%s\n%s", texenv_shad, tmp);
-					break;
-#endif
-				default:
-					break;
-				}
-			}
-#ifdef HAVE_HIGH_FFP_TEXUNITS
-						sprintf(fshader, ffp_frag_src, texenv_shad, alpha_op,
-				mask.num_textures, mask.has_colors, mask.fog_mode,
-				mask.tex_env_mode_pass0 != COMBINE ? mask.tex_env_mode_pass0 : 50,
-				mask.tex_env_mode_pass1 != COMBINE ? mask.tex_env_mode_pass1 : 51,
-				mask.tex_env_mode_pass2 != COMBINE ? mask.tex_env_mode_pass2 : 52,
-				mask.lights_num, mask.shading_mode);
-#else
-			sprintf(fshader, ffp_frag_src, texenv_shad, alpha_op,
-				mask.num_textures, mask.has_colors, mask.fog_mode,
-				mask.tex_env_mode_pass0 != COMBINE ? mask.tex_env_mode_pass0 : 50,
-				mask.tex_env_mode_pass1 != COMBINE ? mask.tex_env_mode_pass1 : 51,
-				mask.lights_num, mask.shading_mode);
-#endif
+			build_ffp_fragment_shader(fshader, mask);
 			uint32_t size = strlen(fshader);
 			SceGxmProgram *t = shark_compile_shader_extended(fshader, &size, SHARK_FRAGMENT_SHADER, compiler_opts, compiler_fastmath, compiler_fastprecision, compiler_fastint);
 			ffp_fragment_program = (SceGxmProgram *)vglMalloc(size);
 			vgl_fast_memcpy((void *)ffp_fragment_program, (void *)t, size);
 			shark_clear_output();
+			compile_unlock();
 #ifndef DISABLE_FS_SHADER_CACHE
 			// Saving compiled shader in filesystem cache
-			f = fopen(fname, "wb");
-			fwrite(ffp_fragment_program, 1, size, f);
-			fclose(f);
+			store_ffp_shader(fname, ffp_fragment_program, size);
 #ifdef DUMP_SHADER_SOURCES
 #ifndef DISABLE_TEXTURE_COMBINER
-#ifdef HAVE_HIGH_FFP_TEXUNITS
-			sprintf(fname, "ux0:data/shader_cache/v%d-%08X-%016llX-%08X_f.cg", SHADER_CACHE_MAGIC, mask.raw, cmb_mask.raw_high, cmb_mask.raw_low);
-#else
-			sprintf(fname, "ux0:data/shader_cache/v%d-%08X-%016X_f.cg", SHADER_CACHE_MAGIC, mask.raw, cmb_mask.raw);
-#endif
+			get_ffp_shader_fname(fname, mask, cmb_mask, 'f', "cg");
 #else
-			sprintf(fname, "ux0:data/shader_cache/v%d-%08X-0000000000000000_f.cg", SHADER_CACHE_MAGIC, mask.raw);
+			get_ffp_shader_fname(fname, mask, 'f', "cg");
 #endif
 			// Saving shader source in filesystem cache
-			f = fopen(fname, "wb");
+			FILE *f = fopen(fname, "wb");
 			fwrite(fshader, 1, strlen(fshader), f);
 			fclose(f);
 #endif
@@ -889,35 +1349,18 @@ uint8_t reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *str
 
 	// Checking if fragment shader requires a blend settings change
 	if (ffp_dirty_frag_blend) {
-		rebuild_frag_shader(ffp_fragment_program_id, &ffp_fragment_program_patched, ffp_vertex_program, SCE_GXM_OUTPUT_REGISTER_FORMAT_UCHAR4);
+		patch_fragment_program_cached(&ffp_fragment_patches, ffp_fragment_program_id, SCE_GXM_OUTPUT_REGISTER_FORMAT_UCHAR4, ffp_vertex_program, &ffp_fragment_program_patched);
 
 		// Updating current fixed function pipeline blend config
 		ffp_blend_info.raw = blend_info.raw;
 	}
 #ifndef DISABLE_RAM_SHADER_CACHE
 	if (new_shader_flag) {
-		shader_cache_idx = (shader_cache_idx + 1) % SHADER_CACHE_SIZE;
-		if (shader_cache_size < SHADER_CACHE_SIZE)
-			shader_cache_size++;
-		else {
-			sceGxmShaderPatcherForceUnregisterProgram(gxm_shader_patcher, shader_cache[shader_cache_idx].vert_id);
-			sceGxmShaderPatcherForceUnregisterProgram(gxm_shader_patcher, shader_cache[shader_cache_idx].frag_id);
-			vgl_free(shader_cache[shader_cache_idx].frag);
-			vgl_free(shader_cache[shader_cache_idx].vert);
-		}
-		shader_cache[shader_cache_idx].mask.raw = mask.raw;
-#ifndef DISABLE_TEXTURE_COMBINER
-#ifdef HAVE_HIGH_FFP_TEXUNITS
-		shader_cache[shader_cache_idx].cmb_mask.raw_low = cmb_mask.raw_low;
-		shader_cache[shader_cache_idx].cmb_mask.raw_high = cmb_mask.raw_high;
+#ifdef DISABLE_TEXTURE_COMBINER
+		cache_ffp_shader(mask);
 #else
-		shader_cache[shader_cache_idx].cmb_mask.raw = cmb_mask.raw;
+		cache_ffp_shader(mask, cmb_mask);
 #endif
-#endif
-		shader_cache[shader_cache_idx].frag = ffp_fragment_program;
-		shader_cache[shader_cache_idx].vert = ffp_vertex_program;
-		shader_cache[shader_cache_idx].frag_id = ffp_fragment_program_id;
-		shader_cache[shader_cache_idx].vert_id = ffp_vertex_program_id;
 	}
 #endif
 	sceGxmSetVertexProgram(gxm_context, ffp_vertex_program_patched);
@@ -939,98 +1382,74 @@ uint8_t reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *str
 	}
 
 	// Uploading fragment shader uniforms
-	void *buffer;
-	if (dirty_frag_unifs) {
-		if (vglReserveFragmentUniformBuffer(ffp_fragment_program, &buffer)) {
-			if (ffp_fragment_params[ALPHA_CUT_UNIF])
-				sceGxmSetUniformDataF(buffer, ffp_fragment_params[ALPHA_CUT_UNIF], 0, 1, &alpha_ref);
-			if (ffp_fragment_params[FOG_COLOR_UNIF])
-				sceGxmSetUniformDataF(buffer, ffp_fragment_params[FOG_COLOR_UNIF], 0, 4, &fog_color.r);
-			if (ffp_fragment_params[TEX_ENV_COLOR_UNIF]) {
+	if (dirty_frag_unifs || dirty_tint_unif) {
+		if (ffp_fragment_block_prog != ffp_fragment_program) {
+			uniform_block_resize(&ffp_fragment_block, sceGxmProgramGetDefaultUniformBufferSize(ffp_fragment_program));
+			uniform_plan_invalidate(&ffp_fragment_plan);
+			ffp_fragment_block_prog = ffp_fragment_program;
+		}
+		if (ffp_fragment_block.size) {
+			uniform_plan *plan = &ffp_fragment_plan;
+			uniform_plan_begin(plan, &ffp_fragment_block, set_ffp_uniform);
+			uniform_plan_add(plan, ffp_fragment_params[ALPHA_CUT_UNIF].ptr, 0, 1, &alpha_ref);
+			uniform_plan_add(plan, ffp_fragment_params[FOG_COLOR_UNIF].ptr, 0, 4, &fog_color.r);
+			if (ffp_fragment_params[TEX_ENV_COLOR_UNIF].ptr) {
 				for (int i = 0; i < mask.num_textures; i++) {
-					sceGxmSetUniformDataF(buffer, ffp_fragment_params[TEX_ENV_COLOR_UNIF], 4 * i, 4, (const float *)&texture_units[i].env_color.r);
+					uniform_plan_add(plan, ffp_fragment_params[TEX_ENV_COLOR_UNIF].ptr, 4 * i, 4, (const float *)&texture_units[i].env_color.r);
 				}
 			}
 #ifndef DISABLE_TEXTURE_COMBINER
-			if (ffp_fragment_params[RGB_SCALE_PASS_0_UNIF]) {
-				sceGxmSetUniformDataF(buffer, ffp_fragment_params[RGB_SCALE_PASS_0_UNIF], 0, 1, &texture_units[0].rgb_scale);
-				sceGxmSetUniformDataF(buffer, ffp_fragment_params[ALPHA_SCALE_PASS_0_UNIF], 0, 1, &texture_units[0].a_scale);
+			if (ffp_fragment_params[RGB_SCALE_PASS_0_UNIF].ptr) {
+				uniform_plan_add(plan, ffp_fragment_params[RGB_SCALE_PASS_0_UNIF].ptr, 0, 1, &texture_units[0].rgb_scale);
+				uniform_plan_add(plan, ffp_fragment_params[ALPHA_SCALE_PASS_0_UNIF].ptr, 0, 1, &texture_units[0].a_scale);
 			}
-			if (ffp_fragment_params[RGB_SCALE_PASS_1_UNIF]) {
-				sceGxmSetUniformDataF(buffer, ffp_fragment_params[RGB_SCALE_PASS_1_UNIF], 0, 1, &texture_units[1].rgb_scale);
-				sceGxmSetUniformDataF(buffer, ffp_fragment_params[ALPHA_SCALE_PASS_1_UNIF], 0, 1, &texture_units[1].a_scale);
+			if (ffp_fragment_params[RGB_SCALE_PASS_1_UNIF].ptr) {
+				uniform_plan_add(plan, ffp_fragment_params[RGB_SCALE_PASS_1_UNIF].ptr, 0, 1, &texture_units[1].rgb_scale);
+				uniform_plan_add(plan, ffp_fragment_params[ALPHA_SCALE_PASS_1_UNIF].ptr, 0, 1, &texture_units[1].a_scale);
 			}
 #ifdef HAVE_HIGH_FFP_TEXUNITS
-			if (ffp_fragment_params[RGB_SCALE_PASS_2_UNIF]) {
-				sceGxmSetUniformDataF(buffer, ffp_fragment_params[RGB_SCALE_PASS_2_UNIF], 0, 1, &texture_units[2].rgb_scale);
-				sceGxmSetUniformDataF(buffer, ffp_fragment_params[ALPHA_SCALE_PASS_2_UNIF], 0, 1, &texture_units[2].a_scale);
+			if (ffp_fragment_params[RGB_SCALE_PASS_2_UNIF].ptr) {
+				uniform_plan_add(plan, ffp_fragment_params[RGB_SCALE_PASS_2_UNIF].ptr, 0, 1, &texture_units[2].rgb_scale);
+				uniform_plan_add(plan, ffp_fragment_params[ALPHA_SCALE_PASS_2_UNIF].ptr, 0, 1, &texture_units[2].a_scale);
 			}
 #endif
 #endif
-			if (ffp_fragment_params[TINT_COLOR_UNIF])
-				sceGxmSetUniformDataF(buffer, ffp_fragment_params[TINT_COLOR_UNIF], 0, 4, &current_vtx.clr.r);
-			if (ffp_fragment_params[FOG_RANGE_UNIF])
-				sceGxmSetUniformDataF(buffer, ffp_fragment_params[FOG_RANGE_UNIF], 0, 1, (const float *)&fog_range);
-			if (ffp_fragment_params[FOG_FAR_UNIF])
-				sceGxmSetUniformDataF(buffer, ffp_fragment_params[FOG_FAR_UNIF], 0, 1, (const float *)&fog_far);
-			if (ffp_fragment_params[FOG_DENSITY_UNIF])
-				sceGxmSetUniformDataF(buffer, ffp_fragment_params[FOG_DENSITY_UNIF], 0, 1, (const float *)&fog_density);
-			if (ffp_fragment_params[LIGHTS_AMBIENTS_F_UNIF]) {
-				sceGxmSetUniformDataF(buffer, ffp_fragment_params[LIGHT_GLOBAL_AMBIENT_F_UNIF], 0, 4, (const float *)&light_global_ambient.r);
-				if (lights_aligned) {
-					sceGxmSetUniformDataF(buffer, ffp_fragment_params[LIGHTS_AMBIENTS_F_UNIF], 0, 4 * mask.lights_num, (const float *)light_vars[0][0]);
-					sceGxmSetUniformDataF(buffer, ffp_fragment_params[LIGHTS_DIFFUSES_F_UNIF], 0, 4 * mask.lights_num, (const float *)light_vars[0][1]);
-					sceGxmSetUniformDataF(buffer, ffp_fragment_params[LIGHTS_SPECULARS_F_UNIF], 0, 4 * mask.lights_num, (const float *)light_vars[0][2]);
-					sceGxmSetUniformDataF(buffer, ffp_fragment_params[LIGHTS_POSITIONS_F_UNIF], 0, 4 * mask.lights_num, (const float *)light_vars[0][3]);
-					sceGxmSetUniformDataF(buffer, ffp_fragment_params[LIGHTS_ATTENUATIONS_F_UNIF], 0, 3 * mask.lights_num, (const float *)light_vars[0][4]);
-				} else {
-					for (int i = 0; i < mask.lights_num; i++) {
-						sceGxmSetUniformDataF(buffer, ffp_fragment_params[LIGHTS_AMBIENTS_F_UNIF], 4 * i, 4, (const float *)light_vars[i][0]);
-						sceGxmSetUniformDataF(buffer, ffp_fragment_params[LIGHTS_DIFFUSES_F_UNIF], 4 * i, 4, (const float *)light_vars[i][1]);
-						sceGxmSetUniformDataF(buffer, ffp_fragment_params[LIGHTS_SPECULARS_F_UNIF], 4 * i, 4, (const float *)light_vars[i][2]);
-						sceGxmSetUniformDataF(buffer, ffp_fragment_params[LIGHTS_POSITIONS_F_UNIF], 4 * i, 4, (const float *)light_vars[i][3]);
-						sceGxmSetUniformDataF(buffer, ffp_fragment_params[LIGHTS_ATTENUATIONS_F_UNIF], 3 * i, 3, (const float *)light_vars[i][4]);
-					}
-				}
-			}
+			uniform_plan_add(plan, ffp_fragment_params[TINT_COLOR_UNIF].ptr, 0, 4, &current_vtx.clr.r);
+			uniform_plan_add(plan, ffp_fragment_params[FOG_RANGE_UNIF].ptr, 0, 1, (const float *)&fog_range);
+			uniform_plan_add(plan, ffp_fragment_params[FOG_FAR_UNIF].ptr, 0, 1, (const float *)&fog_far);
+			uniform_plan_add(plan, ffp_fragment_params[FOG_DENSITY_UNIF].ptr, 0, 1, (const float *)&fog_density);
+			if (ffp_fragment_params[LIGHTS_AMBIENTS_F_UNIF].ptr)
+				add_ffp_lights_steps(plan, &ffp_fragment_params[LIGHTS_AMBIENTS_F_UNIF], ffp_fragment_params[LIGHT_GLOBAL_AMBIENT_F_UNIF].ptr, light_vars, mask.lights_num);
+			uniform_plan_run(plan);
+			vglUploadFragmentUniformBlock(&ffp_fragment_block);
 		}
 		dirty_frag_unifs = GL_FALSE;
+		dirty_tint_unif = GL_FALSE;
 	}
 
 	// Uploading vertex shader uniforms
 	if (dirty_vert_unifs) {
-		vglReserveVertexUniformBuffer(ffp_vertex_program, &buffer);
-		if (ffp_vertex_params[CLIP_PLANES_EQUATION_UNIF])
-			sceGxmSetUniformDataF(buffer, ffp_vertex_params[CLIP_PLANES_EQUATION_UNIF], 0, 4 * mask.clip_planes_num, &clip_planes[0].x);
-		if (ffp_vertex_params[MODELVIEW_MATRIX_UNIF])
-			sceGxmSetUniformDataF(buffer, ffp_vertex_params[MODELVIEW_MATRIX_UNIF], 0, 16, (const float *)modelview_matrix);
-		sceGxmSetUniformDataF(buffer, ffp_vertex_params[WVP_MATRIX_UNIF], 0, 16, (const float *)mvp_matrix);
-		if (ffp_vertex_params[TEX_MATRIX_UNIF])
-			sceGxmSetUniformDataF(buffer, ffp_vertex_params[TEX_MATRIX_UNIF], 0, 16, (const float *)texture_matrix);
-		sceGxmSetUniformDataF(buffer, ffp_vertex_params[POINT_SIZE_UNIF], 0, 1, &point_size);
-		if (ffp_vertex_params[NORMAL_MATRIX_UNIF]) {
-			sceGxmSetUniformDataF(buffer, ffp_vertex_params[NORMAL_MATRIX_UNIF], 0, 16, (const float *)normal_matrix);
-			if (ffp_vertex_params[AMBIENT_UNIF]) {
-				sceGxmSetUniformDataF(buffer, ffp_vertex_params[AMBIENT_UNIF], 0, 4, (const float *)&current_vtx.amb.r);
-			}
-			if (ffp_vertex_params[LIGHTS_AMBIENTS_V_UNIF]) {
-				sceGxmSetUniformDataF(buffer, ffp_vertex_params[LIGHT_GLOBAL_AMBIENT_V_UNIF], 0, 4, (const float *)&light_global_ambient.r);
-				if (lights_aligned) {
-					sceGxmSetUniformDataF(buffer, ffp_vertex_params[LIGHTS_AMBIENTS_V_UNIF], 0, 4 * mask.lights_num, (const float *)light_vars[0][0]);
-					sceGxmSetUniformDataF(buffer, ffp_vertex_params[LIGHTS_DIFFUSES_V_UNIF], 0, 4 * mask.lights_num, (const float *)light_vars[0][1]);
-					sceGxmSetUniformDataF(buffer, ffp_vertex_params[LIGHTS_SPECULARS_V_UNIF], 0, 4 * mask.lights_num, (const float *)light_vars[0][2]);
-					sceGxmSetUniformDataF(buffer, ffp_vertex_params[LIGHTS_POSITIONS_V_UNIF], 0, 4 * mask.lights_num, (const float *)light_vars[0][3]);
-					sceGxmSetUniformDataF(buffer, ffp_vertex_params[LIGHTS_ATTENUATIONS_V_UNIF], 0, 3 * mask.lights_num, (const float *)light_vars[0][4]);
-				} else {
-					for (int i = 0; i < mask.lights_num; i++) {
-						sceGxmSetUniformDataF(buffer, ffp_vertex_params[LIGHTS_AMBIENTS_V_UNIF], 4 * i, 4, (const float *)light_vars[i][0]);
-						sceGxmSetUniformDataF(buffer, ffp_vertex_params[LIGHTS_DIFFUSES_V_UNIF], 4 * i, 4, (const float *)light_vars[i][1]);
-						sceGxmSetUniformDataF(buffer, ffp_vertex_params[LIGHTS_SPECULARS_V_UNIF], 4 * i, 4, (const float *)light_vars[i][2]);
-						sceGxmSetUniformDataF(buffer, ffp_vertex_params[LIGHTS_POSITIONS_V_UNIF], 4 * i, 4, (const float *)light_vars[i][3]);
-						sceGxmSetUniformDataF(buffer, ffp_vertex_params[LIGHTS_ATTENUATIONS_V_UNIF], 3 * i, 3, (const float *)light_vars[i][4]);
-					}
-				}
+		if (ffp_vertex_block_prog != ffp_vertex_program) {
+			uniform_block_resize(&ffp_vertex_block, sceGxmProgramGetDefaultUniformBufferSize(ffp_vertex_program));
+			uniform_plan_invalidate(&ffp_vertex_plan);
+			ffp_vertex_block_prog = ffp_vertex_program;
+		}
+		if (ffp_vertex_block.size) {
+			uniform_plan *plan = &ffp_vertex_plan;
+			uniform_plan_begin(plan, &ffp_vertex_block, set_ffp_uniform);
+			uniform_plan_add(plan, ffp_vertex_params[CLIP_PLANES_EQUATION_UNIF].ptr, 0, 4 * mask.clip_planes_num, &clip_planes[0].x);
+			uniform_plan_add(plan, ffp_vertex_params[MODELVIEW_MATRIX_UNIF].ptr, 0, 16, (const float *)modelview_matrix);
+			uniform_plan_add(plan, ffp_vertex_params[WVP_MATRIX_UNIF].ptr, 0, 16, (const float *)mvp_matrix);
+			uniform_plan_add(plan, ffp_vertex_params[TEX_MATRIX_UNIF].ptr, 0, 16, (const float *)texture_matrix);
+			uniform_plan_add(plan, ffp_vertex_params[POINT_SIZE_UNIF].ptr, 0, 1, &point_size);
+			if (ffp_vertex_params[NORMAL_MATRIX_UNIF].ptr) {
+				uniform_plan_add(plan, ffp_vertex_params[NORMAL_MATRIX_UNIF].ptr, 0, 16, (const float *)normal_matrix);
+				uniform_plan_add(plan, ffp_vertex_params[AMBIENT_UNIF].ptr, 0, 4, (const float *)&current_vtx.amb.r);
+				if (ffp_vertex_params[LIGHTS_AMBIENTS_V_UNIF].ptr)
+					add_ffp_lights_steps(plan, &ffp_vertex_params[LIGHTS_AMBIENTS_V_UNIF], ffp_vertex_params[LIGHT_GLOBAL_AMBIENT_V_UNIF].ptr, light_vars, mask.lights_num);
 			}
+			uniform_plan_run(plan);
+			vglUploadVertexUniformBlock(&ffp_vertex_block);
 		}
 		dirty_vert_unifs = GL_FALSE;
 	}
@@ -1038,8 +1457,11 @@ uint8_t reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *str
 	return draw_mask_state;
 }
 
-void _glDrawArrays_FixedFunctionIMPL(GLsizei count) {
+GLboolean _glDrawArrays_FixedFunctionIMPL(GLsizei count) {
+	PROFILE_ZONE(FFP_DRAW_ARRAYS);
 	uint8_t mask_state = reload_ffp_shaders(NULL, NULL);
+	if (!mask_state)
+		return GL_FALSE;
 	
 	// Uploading textures on relative texture units
 	for (int i = 0; i < ffp_mask.num_textures; i++) {
@@ -1053,13 +1475,13 @@ void _glDrawArrays_FixedFunctionIMPL(GLsizei count) {
 		if (mask_state & (1 << i)) {
 			void *ptr;
 			if (ffp_vertex_attrib_vbo[i]) {
-				gpubuffer *gpu_buf = (gpubuffer *)ffp_vertex_attrib_vbo[i];
-				gpu_buf->used = GL_TRUE;
+				gpubuffer *gpu_buf = (gpubuffer *)(uintptr_t)ffp_vertex_attrib_vbo[i];
+				mark_buffer_used(gpu_buf);
 				ptr = (uint8_t *)gpu_buf->ptr + ffp_vertex_attrib_offsets[i];
 			} else {
 				if (ffp_vertex_stream_config[i].stride == 0) { // Materials
 					if (!materials) {
-						materials = (float *)gpu_alloc_mapped_temp(12 * sizeof(float));
+						materials = (float *)gpu_alloc_stream(12 * sizeof(float));
 						src_materials = (float *)&current_vtx.diff.x;
 					} else {
 						materials += 4;
@@ -1071,19 +1493,21 @@ void _glDrawArrays_FixedFunctionIMPL(GLsizei count) {
 #ifdef DRAW_SPEEDHACK
 					ptr = (void *)ffp_vertex_attrib_offsets[i];
 #else
-					uint32_t size = count * ffp_vertex_stream_config[i].stride;
-					ptr = gpu_alloc_mapped_temp(size);
-					vgl_fast_memcpy(ptr, (void *)ffp_vertex_attrib_offsets[i], size);
+					ptr = gpu_stream_client_array((void *)ffp_vertex_attrib_offsets[i], ffp_vertex_stream_config[i].stride, count);
 #endif
 				}
 			}
 			sceGxmSetVertexStream(gxm_context, j++, ptr);
 		}
 	}
+	return GL_TRUE;
 }
 
-void _glDrawElements_FixedFunctionIMPL(uint16_t *idx_buf, GLsizei count, GLboolean is_short) {
+GLboolean _glDrawElements_FixedFunctionIMPL(uint16_t *idx_buf, GLsizei count, GLboolean is_short) {
+	PROFILE_ZONE(FFP_DRAW_ELEMENTS);
 	uint8_t mask_state = reload_ffp_shaders(NULL, NULL);
+	if (!mask_state)
+		return GL_FALSE;
 	int attr_idxs[FFP_VERTEX_ATTRIBS_NUM] = {0, 0, 0, 0, 0, 0, 0, 0};
 	int attr_num = 0;
 	GLboolean is_full_vbo = GL_TRUE;
@@ -1099,18 +1523,8 @@ void _glDrawElements_FixedFunctionIMPL(uint16_t *idx_buf, GLsizei count, GLboole
 	// Detecting highest index value
 	uint32_t top_idx = 0;
 	if (!is_full_vbo) {
-		if (is_short) {
-			for (int i = 0; i < count; i++) {
-				if (idx_buf[i] > top_idx)
-					top_idx = idx_buf[i];
-			}
-		} else {
-			uint32_t *_idx_buf = (uint32_t *)idx_buf;
-			for (int i = 0; i < count; i++) {
-				if (_idx_buf[i] > top_idx)
-					top_idx = _idx_buf[i];
-			}
-		}
+		uint32_t bottom_idx;
+		get_index_range(idx_buf, count, is_short, &bottom_idx, &top_idx);
 		top_idx++;
 	}
 #endif
@@ -1126,13 +1540,13 @@ void _glDrawElements_FixedFunctionIMPL(uint16_t *idx_buf, GLsizei count, GLboole
 		void *ptr;
 		int attr_idx = attr_idxs[i];
 		if (ffp_vertex_attrib_vbo[attr_idx]) {
-			gpubuffer *gpu_buf = (gpubuffer *)ffp_vertex_attrib_vbo[attr_idx];
-			gpu_buf->used = GL_TRUE;
+			gpubuffer *gpu_buf = (gpubuffer *)(uintptr_t)ffp_vertex_attrib_vbo[attr_idx];
+			mark_buffer_used(gpu_buf);
 			ptr = (uint8_t *)gpu_buf->ptr + ffp_vertex_attrib_offsets[attr_idx];
 		} else {
 			if (ffp_vertex_stream_config[attr_idx].stride == 0) { // Materials
 				if (!materials) {
-					materials = (float *)gpu_alloc_mapped_temp(12 * sizeof(float));
+					materials = (float *)gpu_alloc_stream(12 * sizeof(float));
 					src_materials = (float *)&current_vtx.diff.x;
 				} else {
 					materials += 4;
@@ -1144,14 +1558,374 @@ void _glDrawElements_FixedFunctionIMPL(uint16_t *idx_buf, GLsizei count, GLboole
 #ifdef DRAW_SPEEDHACK
 				ptr = (void *)ffp_vertex_attrib_offsets[attr_idx];
 #else
-				uint32_t size = top_idx * ffp_vertex_stream_config[attr_idx].stride;
-				ptr = gpu_alloc_mapped_temp(size);
-				vgl_fast_memcpy(ptr, (void *)ffp_vertex_attrib_offsets[attr_idx], size);
+				ptr = gpu_stream_client_array((void *)ffp_vertex_attrib_offsets[attr_idx], ffp_vertex_stream_config[attr_idx].stride, top_idx);
 #endif
 			}
 		}
 		sceGxmSetVertexStream(gxm_context, i, ptr);
 	}
+	return GL_TRUE;
+}
+
+#ifdef HAVE_FFP_BATCHING
+// State the draws of a batch must share besides the one tracked by dirty flags
+typedef struct {
+	GLenum mode;
+	uint32_t attrib_state;
+	int alpha_op;
+	uint32_t fog_mode;
+	uint32_t shading_mode;
+	uint32_t fixed_mask;
+	uint32_t fixed_pos_mask;
+	uint32_t clip_planes_mask;
+	uint32_t blend;
+	uint32_t env_modes[TEXTURE_COORDS_NUM];
+	uint32_t combiners[TEXTURE_COORDS_NUM];
+	SceGxmTexture textures[TEXTURE_COORDS_NUM];
+	SceGxmVertexAttribute attribs[FFP_VERTEX_ATTRIBS_NUM];
+	uint32_t strides[FFP_VERTEX_ATTRIBS_NUM];
+	matrix4x4 projection;
+} ffp_batch_key;
+
+static draw_batch ffp_batch;
+static GLenum ffp_batch_mode;
+static uint8_t ffp_batch_attribs[FFP_VERTEX_ATTRIBS_NUM]; // Vertex attributes fed by the streams of the batch
+static GLboolean ffp_batch_movable; // Whether merged draws can be moved into the batch space on the CPU
+
+static void build_ffp_batch_key(ffp_batch_key *k, GLenum mode) {
+	// Zeroing the whole key so that padding bytes compare equal
+	sceClibMemset(k, 0, sizeof(ffp_batch_key));
+	k->mode = mode;
+	k->attrib_state = ffp_vertex_attrib_state;
+	k->alpha_op = alpha_op;
+	k->fog_mode = internal_fog_mode;
+	k->shading_mode = shading_mode;
+	k->fixed_mask = ffp_vertex_attrib_fixed_mask;
+	k->fixed_pos_mask = ffp_vertex_attrib_fixed_pos_mask;
+	k->clip_planes_mask = clip_planes_mask;
+	k->blend = blend_info.raw;
+	for (int i = 0; i < TEXTURE_COORDS_NUM; i++) {
+		if (texture_units[i].enabled) {
+			k->env_modes[i] = texture_units[i].env_mode + 1;
+			k->combiners[i] = texture_units[i].combiner.raw;
+			vgl_fast_memcpy(&k->textures[i], &texture_slots[texture_units[i].tex_id].gxm_tex, sizeof(SceGxmTexture));
+		}
+	}
+	for (int i = 0; i < FFP_VERTEX_ATTRIBS_NUM; i++) {
+		if (ffp_vertex_attrib_state & (1 << i)) {
+			vgl_fast_memcpy(&k->attribs[i], &ffp_vertex_attrib_config[i], sizeof(SceGxmVertexAttribute));
+			k->strides[i] = ffp_vertex_stream_config[i].stride;
+		}
+	}
+	matrix4x4_copy(k->projection, projection_matrix);
+}
+
+static GLboolean append_ffp_batch(GLint first, GLsizei count) {
+	if (!batch_reserve(&ffp_batch, count))
+		return GL_FALSE;
+
+	// Moving vertices into the batch space if the modelview changed since the batch started
+	float rebase[16];
+	GLboolean needs_rebase = GL_FALSE;
+	if (ffp_batch.draws && mvp_modified && sceClibMemcmp(ffp_batch.base, modelview_matrix, sizeof(matrix4x4))) {
+		if (!ffp_batch_movable || !batch_rebase(&ffp_batch, (const float *)modelview_matrix, ffp_vertex_attrib_config[0].componentCount, rebase))
+			return GL_FALSE;
+		needs_rebase = GL_TRUE;
+	}
+
+	for (uint32_t i = 0; i < ffp_batch.streams_num; i++) {
+		uint32_t attr_idx = ffp_batch_attribs[i];
+		uint32_t stride = ffp_vertex_stream_config[attr_idx].stride;
+		void *dst = batch_append(&ffp_batch, i, (uint8_t *)ffp_vertex_attrib_offsets[attr_idx] + first * stride, count);
+		if (needs_rebase && attr_idx == 0) {
+			batch_transform_positions((uint8_t *)dst + ffp_vertex_attrib_config[0].offset, stride, count, ffp_vertex_attrib_config[0].componentCount, rebase);
+			ffp_batch.stats.vertices_transformed += count;
+		}
+	}
+	batch_commit(&ffp_batch, count);
+	return GL_TRUE;
+}
+
+static void flush_draw_batch(void) {
+	if (!ffp_batch.draws)
+		return;
+
+	// Uploading merged vertex streams and performing a single draw for the whole batch
+	uint32_t count = ffp_batch.count;
+	for (uint32_t i = 0; i < ffp_batch.streams_num; i++) {
+		uint32_t size = count * ffp_batch.streams[i].stride;
+		void *ptr = gpu_alloc_stream(size);
+		vgl_fast_memcpy(ptr, ffp_batch.streams[i].data, size);
+		sceGxmSetVertexStream(gxm_context, i, ptr);
+	}
+	reserve_default_indices(count);
+	flush_gxm_state();
+	if (ffp_batch_mode == GL_QUADS)
+		sceGxmDraw(gxm_context, SCE_GXM_PRIMITIVE_TRIANGLES, SCE_GXM_INDEX_FORMAT_U16, default_quads_idx_ptr, (count / 2) * 3);
+	else
+		sceGxmDraw(gxm_context, SCE_GXM_PRIMITIVE_TRIANGLES, SCE_GXM_INDEX_FORMAT_U16, default_idx_ptr, count);
+	batch_end(&ffp_batch);
+}
+
+GLboolean ffp_batch_draw_arrays(GLenum mode, GLint first, GLsizei count) {
+	// Only independent triangles from client arrays can be merged without changing their meaning
+	if ((mode != GL_TRIANGLES && mode != GL_QUADS) || count <= 0 || count % (mode == GL_QUADS ? 4 : 3) || no_polygons_mode)
+		return GL_FALSE;
+	if (!(ffp_vertex_attrib_state & (1 << 0)) || lighting_state)
+		return GL_FALSE;
+	for (int i = 0; i < FFP_VERTEX_ATTRIBS_NUM; i++) {
+		if ((ffp_vertex_attrib_state & (1 << i)) && (ffp_vertex_attrib_vbo[i] || !ffp_vertex_stream_config[i].stride))
+			return GL_FALSE;
+	}
+
+	// Switching scene flushes the pending batch
+	sceneReset();
+
+	ffp_batch_key key;
+	build_ffp_batch_key(&key, mode);
+	if (ffp_batch_pending) {
+		// Any state change tracked through dirty flags is applied on the next reload, so it can't be part of the batch
+		if (ffp_batch.draws && !ffp_dirty_vert && !ffp_dirty_frag && !dirty_vert_unifs && !dirty_frag_unifs && !dirty_tint_unif && batch_match(&ffp_batch, &key, sizeof(ffp_batch_key), count)) {
+			if (append_ffp_batch(first, count))
+				return GL_TRUE;
+		}
+		ffp_batch_flush();
+	}
+
+	// Setting up the state of a new batch
+	uint8_t mask_state = reload_ffp_shaders(NULL, NULL);
+	if (!mask_state)
+		return GL_TRUE;
+	for (int i = 0; i < ffp_mask.num_textures; i++) {
+		sceGxmSetFragmentTexture(gxm_context, i, &texture_slots[texture_units[i].tex_id].gxm_tex);
+	}
+
+	// Reloading shaders may alter attributes config, so the key must reflect their final state
+	build_ffp_batch_key(&key, mode);
+	uint32_t strides[FFP_VERTEX_ATTRIBS_NUM];
+	uint32_t streams_num = 0;
+	for (int i = 0; i < FFP_VERTEX_ATTRIBS_NUM; i++) {
+		if (mask_state & (1 << i)) {
+			ffp_batch_attribs[streams_num] = i;
+			strides[streams_num++] = ffp_vertex_stream_config[i].stride;
+		}
+	}
+	if (ffp_batch.max_count == 0)
+		batch_init(&ffp_batch, MAX_IDX_NUMBER);
+	if (!batch_begin(&ffp_batch, &key, sizeof(ffp_batch_key), strides, streams_num, (const float *)modelview_matrix))
+		return GL_FALSE;
+
+	// Eye space is used by clipping and lighting, so vertices can be moved only if the shader doesn't rely on it
+	// NOTE: normal_mat is declared by every ffp vertex program, so its presence doesn't tell if lighting is on (which is already excluded above)
+	ffp_batch_movable = !ffp_vertex_params[MODELVIEW_MATRIX_UNIF].ptr && ffp_vertex_attrib_config[0].format == SCE_GXM_ATTRIBUTE_FORMAT_F32 && ffp_vertex_attrib_config[0].componentCount >= 2;
+	ffp_batch_mode = mode;
+	if (!append_ffp_batch(first, count)) {
+		// Not enough memory to hold the vertices, drawing straight
+		_glDrawArrays_FixedFunctionIMPL(first + count);
+		reserve_default_indices(first + count);
+		flush_gxm_state();
+		if (mode == GL_QUADS)
+			sceGxmDraw(gxm_context, SCE_GXM_PRIMITIVE_TRIANGLES, SCE_GXM_INDEX_FORMAT_U16, default_quads_idx_ptr + (first / 2) * 3, (count / 2) * 3);
+		else
+			sceGxmDraw(gxm_context, SCE_GXM_PRIMITIVE_TRIANGLES, SCE_GXM_INDEX_FORMAT_U16, default_idx_ptr + first, count);
+		return GL_TRUE;
+	}
+	ffp_batch_pending = GL_TRUE;
+	return GL_TRUE;
+}
+
+#endif
+
+GLboolean ffp_batch_pending = GL_FALSE;
+
+static uint32_t get_immediate_format(void) {
+	uint32_t layout;
+	if (texture_units[1].enabled)
+		layout = IMMEDIATE_LAYOUT_MT;
+	else if (texture_units[0].enabled)
+		layout = IMMEDIATE_LAYOUT_TEX;
+	else
+		layout = IMMEDIATE_LAYOUT_NT;
+	return lighting_state ? (layout | IMMEDIATE_LAYOUT_LIT) : layout;
+}
+
+uint32_t ffp_get_immediate_stride(uint32_t layout) {
+	uint32_t base = IMMEDIATE_LAYOUT_BASE(layout);
+
+	// Lit vertices embed the whole material state, so they keep the legacy layouts
+	if (layout & IMMEDIATE_LAYOUT_LIT) {
+		if (base == IMMEDIATE_LAYOUT_MT)
+			return LEGACY_MT_VERTEX_STRIDE;
+		else if (base == IMMEDIATE_LAYOUT_TEX)
+			return LEGACY_VERTEX_STRIDE;
+		return LEGACY_NT_VERTEX_STRIDE;
+	}
+
+	uint32_t stride = 3;
+	if (base == IMMEDIATE_LAYOUT_MT)
+		stride += IMMEDIATE_UV_SIZE * 2;
+	else if (base == IMMEDIATE_LAYOUT_TEX)
+		stride += IMMEDIATE_UV_SIZE;
+	if (layout & IMMEDIATE_LAYOUT_COLORS)
+		stride += IMMEDIATE_COLOR_SIZE;
+	return stride;
+}
+
+static uint8_t setup_immediate_draw(uint32_t layout) {
+	// Invalidating current attributes state settings
+	uint8_t orig_state = ffp_vertex_attrib_state;
+	SceGxmVertexAttribute *attrs;
+	SceGxmVertexStream *streams;
+	uint32_t base = IMMEDIATE_LAYOUT_BASE(layout);
+	if (base == IMMEDIATE_LAYOUT_MT) { // Multitexture usage
+		ffp_vertex_attrib_state = 0xFF;
+		attrs = legacy_mt_vertex_attrib_config;
+		streams = legacy_mt_vertex_stream_config;
+	} else if (base == IMMEDIATE_LAYOUT_TEX) { // Texturing usage
+		ffp_vertex_attrib_state = 0x07;
+		attrs = legacy_vertex_attrib_config;
+		streams = legacy_vertex_stream_config;
+	} else { // No texturing usage
+		ffp_vertex_attrib_state = 0x05;
+		attrs = legacy_nt_vertex_attrib_config;
+		streams = legacy_nt_vertex_stream_config;
+	}
+
+	// Packed vertices share the attributes offsets of the legacy layouts, only their stride differs
+	if (!(layout & IMMEDIATE_LAYOUT_LIT)) {
+		uint32_t stride = ffp_get_immediate_stride(layout) * sizeof(float);
+		for (int i = 0; i < FFP_VERTEX_ATTRIBS_NUM; i++) {
+			immediate_vertex_stream_config[i].stride = stride;
+			immediate_vertex_stream_config[i].indexSource = SCE_GXM_INDEX_SOURCE_INDEX_16BIT;
+		}
+		streams = immediate_vertex_stream_config;
+		if (!(layout & IMMEDIATE_LAYOUT_COLORS))
+			ffp_vertex_attrib_state &= ~(1 << 2);
+	}
+
+	// Vertices without colors are tinted with the color they have been emitted with
+	vector4f clr = current_vtx.clr;
+	GLboolean tinted = !(layout & (IMMEDIATE_LAYOUT_COLORS | IMMEDIATE_LAYOUT_LIT)) && sceClibMemcmp(&clr, &imm_color, sizeof(vector4f));
+	if (tinted) {
+		current_vtx.clr = imm_color;
+		dirty_tint_unif = GL_TRUE;
+	}
+
+	uint8_t mask_state = reload_ffp_shaders(attrs, streams);
+	if (base != IMMEDIATE_LAYOUT_NT)
+		sceGxmSetFragmentTexture(gxm_context, 0, &texture_slots[texture_units[0].tex_id].gxm_tex);
+	if (base == IMMEDIATE_LAYOUT_MT)
+		sceGxmSetFragmentTexture(gxm_context, 1, &texture_slots[texture_units[1].tex_id].gxm_tex);
+
+	// Restoring original attributes state settings
+	ffp_vertex_attrib_state = orig_state;
+	if (tinted) {
+		current_vtx.clr = clr;
+		dirty_tint_unif = GL_TRUE;
+	}
+	return mask_state;
+}
+
+static void submit_immediate_vertices(const void *vertices, GLenum mode, uint32_t count) {
+	// Uploading vertex streams and performing the draw
+	for (int i = 0; i < ffp_vertex_num_params; i++) {
+		sceGxmSetVertexStream(gxm_context, i, vertices);
+	}
+
+	uint16_t *ptr;
+	uint32_t index_count;
+
+	// Get the index source
+	reserve_default_indices(count);
+	switch (mode) {
+	case GL_QUADS:
+		ptr = default_quads_idx_ptr;
+		index_count = (count / 2) * 3;
+		break;
+	case GL_LINE_STRIP:
+		ptr = default_line_strips_idx_ptr;
+		index_count = (count - 1) * 2;
+		break;
+	case GL_LINE_LOOP:
+		ptr = gpu_alloc_stream(count * 2 * sizeof(uint16_t));
+		vgl_fast_memcpy(ptr, default_line_strips_idx_ptr, (count - 1) * 2 * sizeof(uint16_t));
+		ptr[(count - 1) * 2] = count - 1;
+		ptr[(count - 1) * 2 + 1] = 0;
+
+		index_count = count * 2;
+		break;
+	default:
+		ptr = default_idx_ptr;
+		index_count = count;
+		break;
+	}
+
+	flush_gxm_state();
+	sceGxmDraw(gxm_context, prim, SCE_GXM_INDEX_FORMAT_U16, ptr, index_count);
+}
+
+static GLboolean is_immediate_count_valid(GLenum mode, uint32_t count) {
+	switch (mode) {
+	case GL_POINTS:
+		return count > 0;
+	case GL_LINES:
+		return count > 0 && !(count % 2);
+	case GL_TRIANGLES:
+		return count > 0 && !(count % 3) && !no_polygons_mode;
+	case GL_QUADS:
+		return count > 0 && !(count % 4) && !no_polygons_mode;
+	default: // Primitives sharing vertices can't be merged
+		return GL_FALSE;
+	}
+}
+
+static GLboolean can_extend_immediate_run(GLenum mode, uint32_t layout) {
+	if (!imm_run_count || mode != imm_run_mode || (layout & IMMEDIATE_LAYOUT_LIT) || IMMEDIATE_LAYOUT_BASE(layout) != IMMEDIATE_LAYOUT_BASE(imm_layout))
+		return GL_FALSE;
+
+	// The run is drawn with the state it started with, so anything altering it prevents further merging
+	if (ffp_dirty_vert || ffp_dirty_frag || dirty_vert_unifs || dirty_frag_unifs || mvp_modified || ffp_blend_info.raw != blend_info.raw)
+		return GL_FALSE;
+	// Base layouts are numbered after the number of texture units they use
+	for (int i = 0; i < IMMEDIATE_LAYOUT_BASE(layout); i++) {
+		if (sceClibMemcmp(&imm_run_textures[i], &texture_slots[texture_units[i].tex_id].gxm_tex, sizeof(SceGxmTexture)))
+			return GL_FALSE;
+	}
+
+	// Merged vertices must directly follow the ones of the run
+	return imm_run_count < MAX_IDX_NUMBER && legacy_pool_ptr == imm_run + imm_run_count * imm_stride;
+}
+
+static void promote_immediate_run(void) {
+	// Giving a color to every vertex emitted so far since the run can't be drawn with a single tint anymore
+	uint32_t count = (legacy_pool_ptr - imm_run) / imm_stride;
+	legacy_pool_ptr = immediate_add_colors(imm_run, count, imm_stride, &imm_color.r);
+	imm_layout |= IMMEDIATE_LAYOUT_COLORS;
+	imm_stride += IMMEDIATE_COLOR_SIZE;
+}
+
+static void draw_immediate_run(void) {
+	uint32_t count = imm_run_count;
+	imm_run_count = 0;
+
+	// Translating primitive to sceGxm one
+	gl_primitive_to_gxm(imm_run_mode, prim, count);
+
+	// Skipping the draw if no shader is available yet
+	if (imm_run_mask_state)
+		submit_immediate_vertices(imm_run, imm_run_mode, count);
+
+	// Restore polygon mode if a GL_LINES/GL_POINTS has been rendered
+	restore_polygon_mode(prim);
+}
+
+void ffp_batch_flush(void) {
+	ffp_batch_pending = GL_FALSE;
+	if (imm_run_count)
+		draw_immediate_run();
+#ifdef HAVE_FFP_BATCHING
+	flush_draw_batch();
+#endif
 }
 
 void update_fogging_state() {
@@ -1178,6 +1952,43 @@ void update_fogging_state() {
  * ------------------------------
  */
 
+void vglSetFFPCacheSize(uint32_t size) {
+#ifndef DISABLE_RAM_SHADER_CACHE
+	// Cache gets allocated on vglInit, so changing its size afterwards is not allowed
+	if (shader_cache)
+		return;
+	shader_cache_capacity = size ? size : 1;
+#endif
+}
+
+void vglGetFFPCacheStats(vglFFPCacheStats *stats) {
+#ifndef DISABLE_RAM_SHADER_CACHE
+	stats->hits = shader_cache_hits;
+	stats->misses = shader_cache_misses;
+	stats->evictions = shader_cache_evictions;
+	stats->entries = shader_cache_size;
+	stats->capacity = shader_cache_capacity;
+	stats->max_entry_hits = 0;
+	for (uint32_t i = 0; i < shader_cache_size; i++) {
+		if (shader_cache[i].hits > stats->max_entry_hits)
+			stats->max_entry_hits = shader_cache[i].hits;
+	}
+#else
+	sceClibMemset(stats, 0, sizeof(vglFFPCacheStats));
+#endif
+}
+
+void vglGetFFPBatchingStats(vglFFPBatchingStats *stats) {
+#ifdef HAVE_FFP_BATCHING
+	stats->draws_in = ffp_batch.stats.draws_in;
+	stats->draws_out = ffp_batch.stats.draws_out + (ffp_batch.draws ? 1 : 0);
+	stats->vertices = ffp_batch.stats.vertices;
+	stats->vertices_transformed = ffp_batch.stats.vertices_transformed;
+#else
+	sceClibMemset(stats, 0, sizeof(vglFFPBatchingStats));
+#endif
+}
+
 void glEnableClientState(GLenum array) {
 #ifdef HAVE_DLISTS
 	// Enqueueing function to a display list if one is being compiled
@@ -1210,7 +2021,7 @@ void glEnableClientState(GLenum array) {
 void glDisableClientState(GLenum array) {
 #ifdef HAVE_DLISTS
 	// Enqueueing function to a display list if one is being compiled
-	if (_vgl_enqueue_list_func(glEnableClientState, "U", array))
+	if (_vgl_enqueue_list_func(glDisableClientState, "U", array))
 		return;
 #endif
 	ffp_dirty_vert = GL_TRUE;
@@ -1248,7 +2059,7 @@ void glVertexPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *poin
 	}
 #endif
 
-	ffp_vertex_attrib_offsets[0] = (uint32_t)pointer;
+	ffp_vertex_attrib_offsets[0] = (uintptr_t)pointer;
 	ffp_vertex_attrib_vbo[0] = vertex_array_unit;
 
 	SceGxmVertexAttribute *attributes = &ffp_vertex_attrib_config[0];
@@ -1290,7 +2101,7 @@ void glColorPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *point
 	}
 #endif
 
-	ffp_vertex_attrib_offsets[2] = (uint32_t)pointer;
+	ffp_vertex_attrib_offsets[2] = (uintptr_t)pointer;
 	ffp_vertex_attrib_vbo[2] = vertex_array_unit;
 
 	SceGxmVertexAttribute *attributes = &ffp_vertex_attrib_config[2];
@@ -1363,7 +2174,7 @@ void glNormalPointer(GLenum type, GLsizei stride, const void *pointer) {
 	}
 #endif
 
-	ffp_vertex_attrib_offsets[6] = (uint32_t)pointer;
+	ffp_vertex_attrib_offsets[6] = (uintptr_t)pointer;
 	ffp_vertex_attrib_vbo[6] = vertex_array_unit;
 
 	SceGxmVertexAttribute *attributes = &ffp_vertex_attrib_config[6];
@@ -1410,7 +2221,7 @@ void glTexCoordPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *po
 	}
 #endif
 
-	ffp_vertex_attrib_offsets[texcoord_idxs[client_texture_unit]] = (uint32_t)pointer;
+	ffp_vertex_attrib_offsets[texcoord_idxs[client_texture_unit]] = (uintptr_t)pointer;
 	ffp_vertex_attrib_vbo[texcoord_idxs[client_texture_unit]] = vertex_array_unit;
 
 	SceGxmVertexAttribute *attributes = &ffp_vertex_attrib_config[texcoord_idxs[client_texture_unit]];
@@ -1452,7 +2263,7 @@ void glInterleavedArrays(GLenum format, GLsizei stride, const void *pointer) {
 	switch (format) {
 	case GL_V2F:
 		// Vertex2f
-		ffp_vertex_attrib_offsets[0] = (uint32_t)pointer;
+		ffp_vertex_attrib_offsets[0] = (uintptr_t)pointer;
 		ffp_vertex_attrib_vbo[0] = vertex_array_unit;
 		attributes = &ffp_vertex_attrib_config[0];
 		streams = &ffp_vertex_stream_config[0];
@@ -1462,7 +2273,7 @@ void glInterleavedArrays(GLenum format, GLsizei stride, const void *pointer) {
 		break;
 	case GL_V3F:
 		// Vertex3f
-		ffp_vertex_attrib_offsets[0] = (uint32_t)pointer;
+		ffp_vertex_attrib_offsets[0] = (uintptr_t)pointer;
 		ffp_vertex_attrib_vbo[0] = vertex_array_unit;
 		attributes = &ffp_vertex_attrib_config[0];
 		streams = &ffp_vertex_stream_config[0];
@@ -1472,7 +2283,7 @@ void glInterleavedArrays(GLenum format, GLsizei stride, const void *pointer) {
 		break;
 	case GL_C4UB_V2F:
 		// Color4Ub
-		ffp_vertex_attrib_offsets[2] = (uint32_t)pointer;
+		ffp_vertex_attrib_offsets[2] = (uintptr_t)pointer;
 		ffp_vertex_attrib_vbo[2] = vertex_array_unit;
 		attributes = &ffp_vertex_attrib_config[2];
 		streams = &ffp_vertex_stream_config[2];
@@ -1481,7 +2292,7 @@ void glInterleavedArrays(GLenum format, GLsizei stride, const void *pointer) {
 		streams->stride = stride ? stride : 12;
 
 		// Vertex2f
-		ffp_vertex_attrib_offsets[0] = (uint32_t)pointer + 4;
+		ffp_vertex_attrib_offsets[0] = (uintptr_t)pointer + 4;
 		ffp_vertex_attrib_vbo[0] = vertex_array_unit;
 		attributes = &ffp_vertex_attrib_config[0];
 		streams = &ffp_vertex_stream_config[0];
@@ -1491,7 +2302,7 @@ void glInterleavedArrays(GLenum format, GLsizei stride, const void *pointer) {
 		break;
 	case GL_C4UB_V3F:
 		// Color4Ub
-		ffp_vertex_attrib_offsets[2] = (uint32_t)pointer;
+		ffp_vertex_attrib_offsets[2] = (uintptr_t)pointer;
 		ffp_vertex_attrib_vbo[2] = vertex_array_unit;
 		attributes = &ffp_vertex_attrib_config[2];
 		streams = &ffp_vertex_stream_config[2];
@@ -1500,7 +2311,7 @@ void glInterleavedArrays(GLenum format, GLsizei stride, const void *pointer) {
 		streams->stride = stride ? stride : 16;
 
 		// Vertex3f
-		ffp_vertex_attrib_offsets[0] = (uint32_t)pointer + 4;
+		ffp_vertex_attrib_offsets[0] = (uintptr_t)pointer + 4;
 		ffp_vertex_attrib_vbo[0] = vertex_array_unit;
 		attributes = &ffp_vertex_attrib_config[0];
 		streams = &ffp_vertex_stream_config[0];
@@ -1510,7 +2321,7 @@ void glInterleavedArrays(GLenum format, GLsizei stride, const void *pointer) {
 		break;
 	case GL_C3F_V3F:
 		// Color3f
-		ffp_vertex_attrib_offsets[2] = (uint32_t)pointer;
+		ffp_vertex_attrib_offsets[2] = (uintptr_t)pointer;
 		ffp_vertex_attrib_vbo[2] = vertex_array_unit;
 		attributes = &ffp_vertex_attrib_config[2];
 		streams = &ffp_vertex_stream_config[2];
@@ -1519,7 +2330,7 @@ void glInterleavedArrays(GLenum format, GLsizei stride, const void *pointer) {
 		streams->stride = stride ? stride : 24;
 
 		// Vertex3f
-		ffp_vertex_attrib_offsets[0] = (uint32_t)pointer + 12;
+		ffp_vertex_attrib_offsets[0] = (uintptr_t)pointer + 12;
 		ffp_vertex_attrib_vbo[0] = vertex_array_unit;
 		attributes = &ffp_vertex_attrib_config[0];
 		streams = &ffp_vertex_stream_config[0];
@@ -1529,7 +2340,7 @@ void glInterleavedArrays(GLenum format, GLsizei stride, const void *pointer) {
 		break;
 	case GL_T2F_V3F:
 		// Texcoord2f
-		ffp_vertex_attrib_offsets[1] = (uint32_t)pointer;
+		ffp_vertex_attrib_offsets[1] = (uintptr_t)pointer;
 		ffp_vertex_attrib_vbo[1] = vertex_array_unit;
 		attributes = &ffp_vertex_attrib_config[1];
 		streams = &ffp_vertex_stream_config[1];
@@ -1538,7 +2349,7 @@ void glInterleavedArrays(GLenum format, GLsizei stride, const void *pointer) {
 		streams->stride = stride ? stride : 20;
 
 		// Vertex3f
-		ffp_vertex_attrib_offsets[0] = (uint32_t)pointer + 8;
+		ffp_vertex_attrib_offsets[0] = (uintptr_t)pointer + 8;
 		ffp_vertex_attrib_vbo[0] = vertex_array_unit;
 		attributes = &ffp_vertex_attrib_config[0];
 		streams = &ffp_vertex_stream_config[0];
@@ -1548,7 +2359,7 @@ void glInterleavedArrays(GLenum format, GLsizei stride, const void *pointer) {
 		break;
 	case GL_T4F_V4F:
 		// Texcoord4f
-		ffp_vertex_attrib_offsets[1] = (uint32_t)pointer;
+		ffp_vertex_attrib_offsets[1] = (uintptr_t)pointer;
 		ffp_vertex_attrib_vbo[1] = vertex_array_unit;
 		attributes = &ffp_vertex_attrib_config[1];
 		streams = &ffp_vertex_stream_config[1];
@@ -1557,7 +2368,7 @@ void glInterleavedArrays(GLenum format, GLsizei stride, const void *pointer) {
 		streams->stride = stride ? stride : 32;
 
 		// Vertex4f
-		ffp_vertex_attrib_offsets[0] = (uint32_t)pointer + 16;
+		ffp_vertex_attrib_offsets[0] = (uintptr_t)pointer + 16;
 		ffp_vertex_attrib_vbo[0] = vertex_array_unit;
 		attributes = &ffp_vertex_attrib_config[0];
 		streams = &ffp_vertex_stream_config[0];
@@ -1567,7 +2378,7 @@ void glInterleavedArrays(GLenum format, GLsizei stride, const void *pointer) {
 		break;
 	case GL_T2F_C4UB_V3F:
 		// Texcoord2f
-		ffp_vertex_attrib_offsets[1] = (uint32_t)pointer;
+		ffp_vertex_attrib_offsets[1] = (uintptr_t)pointer;
 		ffp_vertex_attrib_vbo[1] = vertex_array_unit;
 		attributes = &ffp_vertex_attrib_config[1];
 		streams = &ffp_vertex_stream_config[1];
@@ -1576,7 +2387,7 @@ void glInterleavedArrays(GLenum format, GLsizei stride, const void *pointer) {
 		streams->stride = stride ? stride : 24;
 
 		// Color4ub
-		ffp_vertex_attrib_offsets[2] = (uint32_t)pointer + 8;
+		ffp_vertex_attrib_offsets[2] = (uintptr_t)pointer + 8;
 		ffp_vertex_attrib_vbo[2] = vertex_array_unit;
 		attributes = &ffp_vertex_attrib_config[2];
 		streams = &ffp_vertex_stream_config[2];
@@ -1585,7 +2396,7 @@ void glInterleavedArrays(GLenum format, GLsizei stride, const void *pointer) {
 		streams->stride = stride ? stride : 24;
 
 		// Vertex3f
-		ffp_vertex_attrib_offsets[0] = (uint32_t)pointer + 12;
+		ffp_vertex_attrib_offsets[0] = (uintptr_t)pointer + 12;
 		ffp_vertex_attrib_vbo[0] = vertex_array_unit;
 		attributes = &ffp_vertex_attrib_config[0];
 		streams = &ffp_vertex_stream_config[0];
@@ -1595,7 +2406,7 @@ void glInterleavedArrays(GLenum format, GLsizei stride, const void *pointer) {
 		break;
 	case GL_T2F_C3F_V3F:
 		// Texcoord2f
-		ffp_vertex_attrib_offsets[1] = (uint32_t)pointer;
+		ffp_vertex_attrib_offsets[1] = (uintptr_t)pointer;
 		ffp_vertex_attrib_vbo[1] = vertex_array_unit;
 		attributes = &ffp_vertex_attrib_config[1];
 		streams = &ffp_vertex_stream_config[1];
@@ -1604,7 +2415,7 @@ void glInterleavedArrays(GLenum format, GLsizei stride, const void *pointer) {
 		streams->stride = stride ? stride : 32;
 
 		// Color3f
-		ffp_vertex_attrib_offsets[2] = (uint32_t)pointer + 8;
+		ffp_vertex_attrib_offsets[2] = (uintptr_t)pointer + 8;
 		ffp_vertex_attrib_vbo[2] = vertex_array_unit;
 		attributes = &ffp_vertex_attrib_config[2];
 		streams = &ffp_vertex_stream_config[2];
@@ -1613,7 +2424,7 @@ void glInterleavedArrays(GLenum format, GLsizei stride, const void *pointer) {
 		streams->stride = stride ? stride : 32;
 
 		// Vertex3f
-		ffp_vertex_attrib_offsets[0] = (uint32_t)pointer + 20;
+		ffp_vertex_attrib_offsets[0] = (uintptr_t)pointer + 20;
 		ffp_vertex_attrib_vbo[0] = vertex_array_unit;
 		attributes = &ffp_vertex_attrib_config[0];
 		streams = &ffp_vertex_stream_config[0];
@@ -1623,7 +2434,7 @@ void glInterleavedArrays(GLenum format, GLsizei stride, const void *pointer) {
 		break;
 	case GL_T2F_N3F_V3F:
 		// Texcoord2f
-		ffp_vertex_attrib_offsets[1] = (uint32_t)pointer;
+		ffp_vertex_attrib_offsets[1] = (uintptr_t)pointer;
 		ffp_vertex_attrib_vbo[1] = vertex_array_unit;
 		attributes = &ffp_vertex_attrib_config[1];
 		streams = &ffp_vertex_stream_config[1];
@@ -1632,7 +2443,7 @@ void glInterleavedArrays(GLenum format, GLsizei stride, const void *pointer) {
 		streams->stride = stride ? stride : 32;
 
 		// Normal3f
-		ffp_vertex_attrib_offsets[6] = (uint32_t)pointer + 8;
+		ffp_vertex_attrib_offsets[6] = (uintptr_t)pointer + 8;
 		ffp_vertex_attrib_vbo[6] = vertex_array_unit;
 		attributes = &ffp_vertex_attrib_config[6];
 		streams = &ffp_vertex_stream_config[6];
@@ -1641,7 +2452,7 @@ void glInterleavedArrays(GLenum format, GLsizei stride, const void *pointer) {
 		streams->stride = stride ? stride : 32;
 
 		// Vertex3f
-		ffp_vertex_attrib_offsets[0] = (uint32_t)pointer + 20;
+		ffp_vertex_attrib_offsets[0] = (uintptr_t)pointer + 20;
 		ffp_vertex_attrib_vbo[0] = vertex_array_unit;
 		attributes = &ffp_vertex_attrib_config[0];
 		streams = &ffp_vertex_stream_config[0];
@@ -1657,7 +2468,7 @@ void glInterleavedArrays(GLenum format, GLsizei stride, const void *pointer) {
 void glVertex3f(GLfloat x, GLfloat y, GLfloat z) {
 #ifdef HAVE_DLISTS
 	// Enqueueing function to a display list if one is being compiled
-	if (_vgl_enqueue_list_func(glVertex3f, "FFF", x, y, z))
+	if (_vgl_enqueue_list_func((void (*)())glVertex3f, "FFF", x, y, z))
 		return;
 #endif
 #ifndef SKIP_ERROR_HANDLING
@@ -1667,31 +2478,39 @@ void glVertex3f(GLfloat x, GLfloat y, GLfloat z) {
 	}
 #endif
 
-	legacy_pool_ptr[0] = x;
-	legacy_pool_ptr[1] = y;
-	legacy_pool_ptr[2] = z;
-	if (texture_units[1].enabled) { // Multitexturing enabled
-
-		vgl_fast_memcpy(legacy_pool_ptr + 3, &current_vtx.uv.x, sizeof(float) * 2);
-		vgl_fast_memcpy(legacy_pool_ptr + 5, &current_vtx.uv2.x, sizeof(float) * 2);
-		if (lighting_state) {
+	if (imm_layout & IMMEDIATE_LAYOUT_LIT) {
+		legacy_pool_ptr[0] = x;
+		legacy_pool_ptr[1] = y;
+		legacy_pool_ptr[2] = z;
+		switch (IMMEDIATE_LAYOUT_BASE(imm_layout)) {
+		case IMMEDIATE_LAYOUT_MT: // Multitexturing enabled
+			vgl_fast_memcpy(legacy_pool_ptr + 3, &current_vtx.uv.x, sizeof(float) * 2);
+			vgl_fast_memcpy(legacy_pool_ptr + 5, &current_vtx.uv2.x, sizeof(float) * 2);
 			vgl_fast_memcpy(legacy_pool_ptr + 7, &current_vtx.amb.x, sizeof(float) * 19);
-		} else
-			vgl_fast_memcpy(legacy_pool_ptr + 7, &current_vtx.clr.x, sizeof(float) * 4);
-		legacy_pool_ptr += LEGACY_MT_VERTEX_STRIDE;
-	} else if (texture_units[0].enabled) { // Texturing enabled
-		if (lighting_state) {
+			break;
+		case IMMEDIATE_LAYOUT_TEX: // Texturing enabled
 			vgl_fast_memcpy(legacy_pool_ptr + 3, &current_vtx.uv.x, sizeof(float) * 2);
 			vgl_fast_memcpy(legacy_pool_ptr + 5, &current_vtx.amb.x, sizeof(float) * 19);
-		} else
-			vgl_fast_memcpy(legacy_pool_ptr + 3, &current_vtx.uv.x, sizeof(float) * 6);
-		legacy_pool_ptr += LEGACY_VERTEX_STRIDE;
-	} else { // Texturing disabled
-		if (lighting_state)
+			break;
+		default: // Texturing disabled
 			vgl_fast_memcpy(legacy_pool_ptr + 3, &current_vtx.amb.x, sizeof(float) * 19);
-		else
-			vgl_fast_memcpy(legacy_pool_ptr + 3, &current_vtx.clr.x, sizeof(float) * 4);
-		legacy_pool_ptr += LEGACY_NT_VERTEX_STRIDE;
+			break;
+		}
+		legacy_pool_ptr += imm_stride;
+	} else {
+		// Vertices carry a color only once it differs from the one of the first vertex of the run
+		if (!(imm_layout & IMMEDIATE_LAYOUT_COLORS) && sceClibMemcmp(&current_vtx.clr, &imm_color, sizeof(vector4f))) {
+			if (legacy_pool_ptr == imm_run)
+				imm_color = current_vtx.clr;
+			else
+				promote_immediate_run();
+		}
+		float pos[3] = {x, y, z};
+		uint32_t base = IMMEDIATE_LAYOUT_BASE(imm_layout);
+		legacy_pool_ptr = immediate_pack_vertex(legacy_pool_ptr, pos,
+			base != IMMEDIATE_LAYOUT_NT ? &current_vtx.uv.x : NULL,
+			base == IMMEDIATE_LAYOUT_MT ? &current_vtx.uv2.x : NULL,
+			(imm_layout & IMMEDIATE_LAYOUT_COLORS) ? &current_vtx.clr.x : NULL);
 	}
 
 	// Increasing vertex counter
@@ -1733,7 +2552,7 @@ void glVertex3i(GLint x, GLint y, GLint z) {
 void glVertex2f(GLfloat x, GLfloat y) {
 #ifdef HAVE_DLISTS
 	// Enqueueing function to a display list if one is being compiled
-	if (_vgl_enqueue_list_func(glVertex2f, "FF", x, y))
+	if (_vgl_enqueue_list_func((void (*)())glVertex2f, "FF", x, y))
 		return;
 #endif
 	glVertex3f(x, y, 0.0f);
@@ -1822,7 +2641,7 @@ void glMaterialxv(GLenum face, GLenum pname, const GLfixed *params) {
 void glColor3f(GLfloat red, GLfloat green, GLfloat blue) {
 #ifdef HAVE_DLISTS
 	// Enqueueing function to a display list if one is being compiled
-	if (_vgl_enqueue_list_func(glColor3f, "FFF", red, green, blue))
+	if (_vgl_enqueue_list_func((void (*)())glColor3f, "FFF", red, green, blue))
 		return;
 #endif
 	// Setting current color value
@@ -1852,7 +2671,7 @@ void glColor3f(GLfloat red, GLfloat green, GLfloat blue) {
 		}
 	}
 
-	dirty_frag_unifs = GL_TRUE;
+	dirty_tint_unif = GL_TRUE;
 }
 
 void glColor3fv(const GLfloat *v) {
@@ -1886,13 +2705,13 @@ void glColor3fv(const GLfloat *v) {
 		}
 	}
 
-	dirty_frag_unifs = GL_TRUE;
+	dirty_tint_unif = GL_TRUE;
 }
 
 void glColor3ub(GLubyte red, GLubyte green, GLubyte blue) {
 #ifdef HAVE_DLISTS
 	// Enqueueing function to a display list if one is being compiled
-	if (_vgl_enqueue_list_func(glColor3ub, "XXX", red, green, blue))
+	if (_vgl_enqueue_list_func((void (*)())glColor3ub, "XXX", red, green, blue))
 		return;
 #endif
 	// Setting current color value
@@ -1922,7 +2741,7 @@ void glColor3ub(GLubyte red, GLubyte green, GLubyte blue) {
 		}
 	}
 
-	dirty_frag_unifs = GL_TRUE;
+	dirty_tint_unif = GL_TRUE;
 }
 
 void glColor3ubv(const GLubyte *c) {
@@ -1958,13 +2777,13 @@ void glColor3ubv(const GLubyte *c) {
 		}
 	}
 
-	dirty_frag_unifs = GL_TRUE;
+	dirty_tint_unif = GL_TRUE;
 }
 
 void glColor4f(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
 #ifdef HAVE_DLISTS
 	// Enqueueing function to a display list if one is being compiled
-	if (_vgl_enqueue_list_func(glColor4f, "FFFF", red, green, blue, alpha))
+	if (_vgl_enqueue_list_func((void (*)())glColor4f, "FFFF", red, green, blue, alpha))
 		return;
 #endif
 	// Setting current color value
@@ -1994,7 +2813,7 @@ void glColor4f(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
 		}
 	}
 
-	dirty_frag_unifs = GL_TRUE;
+	dirty_tint_unif = GL_TRUE;
 }
 
 void glColor4fv(const GLfloat *v) {
@@ -2027,13 +2846,13 @@ void glColor4fv(const GLfloat *v) {
 		}
 	}
 
-	dirty_frag_unifs = GL_TRUE;
+	dirty_tint_unif = GL_TRUE;
 }
 
 void glColor4ub(GLubyte red, GLubyte green, GLubyte blue, GLubyte alpha) {
 #ifdef HAVE_DLISTS
 	// Enqueueing function to a display list if one is being compiled
-	if (_vgl_enqueue_list_func(glColor4ub, "XXXX", red, green, blue, alpha))
+	if (_vgl_enqueue_list_func((void (*)())glColor4ub, "XXXX", red, green, blue, alpha))
 		return;
 #endif
 	current_vtx.clr.r = (float)red / 255.0f;
@@ -2062,7 +2881,7 @@ void glColor4ub(GLubyte red, GLubyte green, GLubyte blue, GLubyte alpha) {
 		}
 	}
 
-	dirty_frag_unifs = GL_TRUE;
+	dirty_tint_unif = GL_TRUE;
 }
 
 void glColor4ubv(const GLubyte *c) {
@@ -2098,7 +2917,7 @@ void glColor4ubv(const GLubyte *c) {
 		}
 	}
 
-	dirty_frag_unifs = GL_TRUE;
+	dirty_tint_unif = GL_TRUE;
 }
 
 void glColor4x(GLfixed red, GLfixed green, GLfixed blue, GLfixed alpha) {
@@ -2141,13 +2960,13 @@ void glColor4x(GLfixed red, GLfixed green, GLfixed blue, GLfixed alpha) {
 		}
 	}
 
-	dirty_frag_unifs = GL_TRUE;
+	dirty_tint_unif = GL_TRUE;
 }
 
 void glNormal3f(GLfloat x, GLfloat y, GLfloat z) {
 #ifdef HAVE_DLISTS
 	// Enqueueing function to a display list if one is being compiled
-	if (_vgl_enqueue_list_func(glNormal3f, "FFF", x, y, z))
+	if (_vgl_enqueue_list_func((void (*)())glNormal3f, "FFF", x, y, z))
 		return;
 #endif
 #ifndef SKIP_ERROR_HANDLING
@@ -2187,7 +3006,7 @@ void glNormal3fv(const GLfloat *v) {
 void glTexCoord2f(GLfloat s, GLfloat t) {
 #ifdef HAVE_DLISTS
 	// Enqueueing function to a display list if one is being compiled
-	if (_vgl_enqueue_list_func(glTexCoord2f, "FF", s, t))
+	if (_vgl_enqueue_list_func((void (*)())glTexCoord2f, "FF", s, t))
 		return;
 #endif
 #ifndef SKIP_ERROR_HANDLING
@@ -2216,7 +3035,7 @@ void glTexCoord2s(GLshort s, GLshort t) {
 void glMultiTexCoord2f(GLenum target, GLfloat s, GLfloat t) {
 #ifdef HAVE_DLISTS
 	// Enqueueing function to a display list if one is being compiled
-	if (_vgl_enqueue_list_func(glMultiTexCoord2f, "UFF", target, s, t))
+	if (_vgl_enqueue_list_func((void (*)())glMultiTexCoord2f, "UFF", target, s, t))
 		return;
 #endif
 #ifndef SKIP_ERROR_HANDLING
@@ -2266,7 +3085,20 @@ void glBegin(GLenum mode) {
 
 	// Performing a scene reset if necessary
 	sceneReset();
-	
+
+	// Merging the primitive with the previous ones if nothing changed since they have been emitted
+	uint32_t layout = get_immediate_format();
+	if (ffp_batch_pending && can_extend_immediate_run(mode, layout)) {
+		if (!(imm_layout & IMMEDIATE_LAYOUT_COLORS) && sceClibMemcmp(&current_vtx.clr, &imm_color, sizeof(vector4f)))
+			promote_immediate_run();
+	} else {
+		flush_ffp_batch();
+		imm_run = legacy_pool_ptr;
+		imm_layout = layout;
+		imm_stride = ffp_get_immediate_stride(layout);
+		imm_color = current_vtx.clr;
+	}
+
 	// Tracking desired primitive
 	ffp_mode = mode;
 
@@ -2290,72 +3122,36 @@ void glEnd(void) {
 	phase = NONE;
 #endif
 
-	// Translating primitive to sceGxm one
-	gl_primitive_to_gxm(ffp_mode, prim, vertex_count);
-
-	// Invalidating current attributes state settings
-	uint8_t orig_state = ffp_vertex_attrib_state;
-
-	ffp_dirty_frag = GL_TRUE;
-	ffp_dirty_vert = GL_TRUE;
-	if (texture_units[1].enabled) { // Multitexture usage
-		ffp_vertex_attrib_state = 0xFF;
-		reload_ffp_shaders(legacy_mt_vertex_attrib_config, legacy_mt_vertex_stream_config);
-		sceGxmSetFragmentTexture(gxm_context, 0, &texture_slots[texture_units[0].tex_id].gxm_tex);
-		sceGxmSetFragmentTexture(gxm_context, 1, &texture_slots[texture_units[1].tex_id].gxm_tex);
-	} else if (texture_units[0].enabled) { // Texturing usage
-		ffp_vertex_attrib_state = 0x07;
-		reload_ffp_shaders(legacy_vertex_attrib_config, legacy_vertex_stream_config);
-		sceGxmSetFragmentTexture(gxm_context, 0, &texture_slots[texture_units[0].tex_id].gxm_tex);
-	} else { // No texturing usage
-		ffp_vertex_attrib_state = 0x05;
-		reload_ffp_shaders(legacy_nt_vertex_attrib_config, legacy_nt_vertex_stream_config);
+	// Setting up again the run draw if its vertices gained colors
+	if (imm_run_count && imm_run_layout != imm_layout) {
+		imm_run_mask_state = setup_immediate_draw(imm_layout);
+		imm_run_layout = imm_layout;
 	}
 
-	// Restoring original attributes state settings
-	ffp_vertex_attrib_state = orig_state;
-
-	// Uploading vertex streams and performing the draw
-	for (int i = 0; i < ffp_vertex_num_params; i++) {
-		sceGxmSetVertexStream(gxm_context, i, legacy_pool);
-	}
-
-	uint16_t *ptr;
-	uint32_t index_count;
-
-	// Get the index source
-	switch (ffp_mode) {
-	case GL_QUADS:
-		ptr = default_quads_idx_ptr;
-		index_count = (vertex_count / 2) * 3;
-		break;
-	case GL_LINE_STRIP:
-		ptr = default_line_strips_idx_ptr;
-		index_count = (vertex_count - 1) * 2;
-		break;
-	case GL_LINE_LOOP:
-		ptr = gpu_alloc_mapped_temp(vertex_count * 2 * sizeof(uint16_t));
-		vgl_fast_memcpy(ptr, default_line_strips_idx_ptr, (vertex_count - 1) * 2 * sizeof(uint16_t));
-		ptr[(vertex_count - 1) * 2] = vertex_count - 1;
-		ptr[(vertex_count - 1) * 2 + 1] = 0;
-
-		index_count = vertex_count * 2;
-		break;
-	default:
-		ptr = default_idx_ptr;
-		index_count = vertex_count;
-		break;
+	float *vertices = imm_run + imm_run_count * imm_stride;
+	if (!(imm_layout & IMMEDIATE_LAYOUT_LIT) && is_immediate_count_valid(ffp_mode, vertex_count)) {
+		// Independent primitives are held back so that the following ones can be drawn with them
+		if (imm_run_count + vertex_count > MAX_IDX_NUMBER) {
+			ffp_batch_flush();
+			imm_run = vertices;
+		}
+		if (!imm_run_count) {
+			imm_run_mask_state = setup_immediate_draw(imm_layout);
+			imm_run_layout = imm_layout;
+			imm_run_mode = ffp_mode;
+			for (int i = 0; i < IMMEDIATE_LAYOUT_BASE(imm_layout); i++) {
+				vgl_fast_memcpy(&imm_run_textures[i], &texture_slots[texture_units[i].tex_id].gxm_tex, sizeof(SceGxmTexture));
+			}
+		}
+		imm_run_count += vertex_count;
+		ffp_batch_pending = GL_TRUE;
+	} else {
+		// Performing the draw with the vertices populated since glBegin
+		ffp_draw_immediate(vertices, ffp_mode, vertex_count, imm_layout);
 	}
 
-	sceGxmDraw(gxm_context, prim, SCE_GXM_INDEX_FORMAT_U16, ptr, index_count);
-
 	// Moving legacy pool address offset
-	if (texture_units[1].enabled)
-		legacy_pool += vertex_count * LEGACY_MT_VERTEX_STRIDE;
-	else if (texture_units[0].enabled)
-		legacy_pool += vertex_count * LEGACY_VERTEX_STRIDE;
-	else
-		legacy_pool += vertex_count * LEGACY_NT_VERTEX_STRIDE;
+	legacy_pool = legacy_pool_ptr;
 
 #ifndef SKIP_ERROR_HANDLING
 	// Checking for out of bounds of the immediate mode vertex pool
@@ -2363,15 +3159,79 @@ void glEnd(void) {
 		vgl_log("%s:%d glEnd: Legacy pool outbounded by %d bytes! Consider increasing its size...\n", __FILE__, __LINE__, legacy_pool - legacy_pool_end);
 	}
 #endif
+}
+
+void ffp_draw_immediate(const void *vertices, GLenum mode, uint32_t count, uint32_t layout) {
+	flush_ffp_batch();
+
+	// Translating primitive to sceGxm one
+	gl_primitive_to_gxm(mode, prim, count);
+
+	// Skipping the draw if no shader is available yet
+	if (setup_immediate_draw(layout))
+		submit_immediate_vertices(vertices, mode, count);
 
 	// Restore polygon mode if a GL_LINES/GL_POINTS has been rendered
 	restore_polygon_mode(prim);
 }
 
+uint32_t ffp_get_immediate_layout(void) {
+	// Lit vertices embed the whole material state so they are never baked
+	if (lighting_state)
+		return IMMEDIATE_LAYOUT_INVALID;
+	if (texture_units[1].enabled)
+		return IMMEDIATE_LAYOUT_MT;
+	if (texture_units[0].enabled)
+		return IMMEDIATE_LAYOUT_TEX;
+	return IMMEDIATE_LAYOUT_NT;
+}
+
+// State saved while immediate mode vertices are captured
+static legacy_vtx_attachment capture_vtx;
+static float *capture_pool_ptr;
+static uint32_t capture_vertex_count;
+static glPhase capture_phase;
+static uint32_t capture_layout;
+static uint32_t capture_stride;
+static vector4f capture_color;
+static float *capture_run;
+
+void ffp_capture_immediate_begin(float *dst) {
+	capture_vtx = current_vtx;
+	capture_pool_ptr = legacy_pool_ptr;
+	capture_vertex_count = vertex_count;
+	capture_phase = phase;
+	capture_layout = imm_layout;
+	capture_stride = imm_stride;
+	capture_color = imm_color;
+	capture_run = imm_run;
+	legacy_pool_ptr = dst;
+	vertex_count = 0;
+	phase = MODEL_CREATION;
+
+	// Baked vertices always carry their color since the tint is whatever color is current on replay
+	imm_layout = get_immediate_format() | IMMEDIATE_LAYOUT_COLORS;
+	imm_stride = ffp_get_immediate_stride(imm_layout);
+	imm_run = dst;
+}
+
+uint32_t ffp_capture_immediate_end(void) {
+	uint32_t count = vertex_count;
+	current_vtx = capture_vtx;
+	legacy_pool_ptr = capture_pool_ptr;
+	vertex_count = capture_vertex_count;
+	phase = capture_phase;
+	imm_layout = capture_layout;
+	imm_stride = capture_stride;
+	imm_color = capture_color;
+	imm_run = capture_run;
+	return count;
+}
+
 void glTexEnvf(GLenum target, GLenum pname, GLfloat param) {
 #ifdef HAVE_DLISTS
 	// Enqueueing function to a display list if one is being compiled
-	if (_vgl_enqueue_list_func(glTexEnvf, "UUF", target, pname, param))
+	if (_vgl_enqueue_list_func((void (*)())glTexEnvf, "UUF", target, pname, param))
 		return;
 #endif
 	// Aliasing texture unit for cleaner code
@@ -2582,7 +3442,7 @@ void glTexEnvx(GLenum target, GLenum pname, GLfixed param) {
 void glTexEnvfv(GLenum target, GLenum pname, GLfloat *param) {
 #ifdef HAVE_DLISTS
 	// Enqueueing function to a display list if one is being compiled
-	if (_vgl_enqueue_list_func(glTexEnvf, "UUU", target, pname, param))
+	if (_vgl_enqueue_list_func(glTexEnvfv, "UUU", target, pname, param))
 		return;
 #endif
 	// Aliasing texture unit for cleaner code
@@ -2626,7 +3486,7 @@ void glTexEnvfv(GLenum target, GLenum pname, GLfloat *param) {
 void glTexEnvxv(GLenum target, GLenum pname, GLfixed *param) {
 #ifdef HAVE_DLISTS
 	// Enqueueing function to a display list if one is being compiled
-	if (_vgl_enqueue_list_func(glTexEnvxv, "UUF", target, pname, param))
+	if (_vgl_enqueue_list_func(glTexEnvxv, "UUU", target, pname, param))
 		return;
 #endif
 	// Aliasing texture unit for cleaner code
@@ -2673,7 +3533,7 @@ void glTexEnvxv(GLenum target, GLenum pname, GLfixed *param) {
 void glTexEnvi(GLenum target, GLenum pname, GLint param) {
 #ifdef HAVE_DLISTS
 	// Enqueueing function to a display list if one is being compiled
-	if (_vgl_enqueue_list_func(glTexEnvf, "UUI", target, pname, param))
+	if (_vgl_enqueue_list_func(glTexEnvi, "UUI", target, pname, param))
 		return;
 #endif
 	// Aliasing texture unit for cleaner code
@@ -3121,7 +3981,7 @@ void glLightModelxv(GLenum pname, const GLfixed *params) {
 void glFogf(GLenum pname, GLfloat param) {
 #ifdef HAVE_DLISTS
 	// Enqueueing function to a display list if one is being compiled
-	if (_vgl_enqueue_list_func(glFogf, "UF", pname, param))
+	if (_vgl_enqueue_list_func((void (*)())glFogf, "UF", pname, param))
 		return;
 #endif
 	switch (pname) {
@@ -78,7 +78,7 @@ void glGenFramebuffers(GLsizei n, GLuint *ids) {
 #endif
 	for (i = 0; i < BUFFERS_NUM; i++) {
 		if (!framebuffers[i].active) {
-			ids[j++] = (GLuint)&framebuffers[i];
+			ids[j++] = (GLuint)(uintptr_t)&framebuffers[i];
 			framebuffers[i].active = GL_TRUE;
 			framebuffers[i].is_depth_hidden = GL_FALSE;
 			framebuffers[i].depthbuffer_ptr = NULL;
@@ -99,7 +99,7 @@ void glGenRenderbuffers(GLsizei n, GLuint *ids) {
 #endif
 	for (i = 0; i < BUFFERS_NUM; i++) {
 		if (!renderbuffers[i].active) {
-			ids[j++] = (GLuint)&renderbuffers[i];
+			ids[j++] = (GLuint)(uintptr_t)&renderbuffers[i];
 			renderbuffers[i].active = GL_TRUE;
 		}
 		if (j >= n)
@@ -114,7 +114,7 @@ void glDeleteFramebuffers(GLsizei n, const GLuint *ids) {
 	}
 #endif
 	while (n > 0) {
-		framebuffer *fb = (framebuffer *)ids[--n];
+		framebuffer *fb = (framebuffer *)(uintptr_t)ids[--n];
 		if (fb) {
 			// Check if the framebuffer is currently bound
 			if (fb == active_read_fb)
@@ -145,7 +145,7 @@ void glDeleteRenderbuffers(GLsizei n, const GLuint *ids) {
 	}
 #endif
 	while (n > 0) {
-		renderbuffer *rb = (renderbuffer *)ids[--n];
+		renderbuffer *rb = (renderbuffer *)(uintptr_t)ids[--n];
 		if (rb) {
 			// Check if the framebuffer is currently bound
 			if (active_read_fb && active_read_fb->depthbuffer_ptr == &rb->depthbuffer)
@@ -168,13 +168,13 @@ void glDeleteRenderbuffers(GLsizei n, const GLuint *ids) {
 void glBindFramebuffer(GLenum target, GLuint fb) {
 	switch (target) {
 	case GL_DRAW_FRAMEBUFFER:
-		active_write_fb = (framebuffer *)fb;
+		active_write_fb = (framebuffer *)(uintptr_t)fb;
 		break;
 	case GL_READ_FRAMEBUFFER:
-		active_read_fb = (framebuffer *)fb;
+		active_read_fb = (framebuffer *)(uintptr_t)fb;
 		break;
 	case GL_FRAMEBUFFER:
-		active_write_fb = active_read_fb = (framebuffer *)fb;
+		active_write_fb = active_read_fb = (framebuffer *)(uintptr_t)fb;
 		break;
 	default:
 		SET_GL_ERROR_WITH_VALUE(GL_INVALID_ENUM, target)
@@ -184,7 +184,7 @@ void glBindFramebuffer(GLenum target, GLuint fb) {
 void glBindRenderbuffer(GLenum target, GLuint rb) {
 	switch (target) {
 	case GL_RENDERBUFFER:
-		active_rb = (renderbuffer *)rb;
+		active_rb = (renderbuffer *)(uintptr_t)rb;
 		break;
 	default:
 		SET_GL_ERROR_WITH_VALUE(GL_INVALID_ENUM, target)
@@ -498,14 +498,19 @@ void glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format
 		}
 	} else {
 		int j;
+		pixel_row_cb convert_row = getRowConverter(read_cb, write_cb);
 		for (i = 0; i < height; i++) {
 			uint8_t *line_src = &src[y + i * stride + x * src_bpp];
 			uint8_t *line_dst = data_u8;
-			for (j = 0; j < width; j++) {
-				uint32_t clr = read_cb(line_src);
-				write_cb(line_dst, clr);
-				line_src += src_bpp;
-				line_dst += dst_bpp;
+			if (convert_row)
+				convert_row(line_dst, line_src, width);
+			else {
+				for (j = 0; j < width; j++) {
+					uint32_t clr = read_cb(line_src);
+					write_cb(line_dst, clr);
+					line_src += src_bpp;
+					line_dst += dst_bpp;
+				}
 			}
 #ifdef HAVE_UNFLIPPED_FBOS
 			data_u8 -= width * dst_bpp;
@@ -349,13 +349,13 @@ void glGetIntegerv(GLenum pname, GLint *data) {
 	case GL_SHADER_BINARY_FORMATS:
 		break;
 	case GL_FRAMEBUFFER_BINDING:
-		*data = (GLint)active_write_fb;
+		*data = (GLint)(uintptr_t)active_write_fb;
 		break;
 	case GL_RENDERBUFFER_BINDING:
-		*data = (GLint)active_rb;
+		*data = (GLint)(uintptr_t)active_rb;
 		break;
 	case GL_READ_FRAMEBUFFER_BINDING:
-		*data = (GLint)active_read_fb;
+		*data = (GLint)(uintptr_t)active_read_fb;
 		break;
 	case GL_MAX_VERTEX_ATTRIBS:
 		*data = VERTEX_ATTRIBS_NUM;
@@ -472,6 +472,6 @@ GLboolean glIsTexture(GLuint i) {
 }
 
 GLboolean glIsFramebuffer(GLuint fb) {
-	framebuffer *p = (framebuffer *)fb;
+	framebuffer *p = (framebuffer *)(uintptr_t)fb;
 	return (p && p->active);
 }
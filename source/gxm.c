@@ -24,7 +24,7 @@
 #include "shared.h"
 
 // Flags available for sceGxmVshInitialize
-static enum {
+enum {
 	GXM_FLAG_DEFAULT = 0x00,
 	GXM_FLAG_SYSAPP = 0x0A,
 	GXM_FLAG_TEXFORMAT_EXT = 0x10
@@ -41,6 +41,7 @@ static void *vdm_ring_buffer_addr; // VDM ring buffer memblock starting address
 static void *vertex_ring_buffer_addr; // vertex ring buffer memblock starting address
 static void *fragment_ring_buffer_addr; // fragment ring buffer memblock starting address
 static void *fragment_usse_ring_buffer_addr; // fragment USSE ring buffer memblock starting address
+static void *gxm_context_host_mem; // sceGxm context host memory
 
 static SceGxmRenderTarget *gxm_render_target; // Display render target
 static SceGxmColorSurface gxm_color_surfaces[DISPLAY_MAX_BUFFER_COUNT]; // Display color surfaces
@@ -93,15 +94,14 @@ float *legacy_pool_end = NULL; // Address of the end of the GL1 immediate draw p
 uint32_t vgl_debugger_framecount = 0; // Current frame number since application started
 #endif
 
-void *frame_purge_list[FRAME_PURGE_FREQ][FRAME_PURGE_LIST_SIZE]; // Purge list for internal elements
-void *frame_rt_purge_list[FRAME_PURGE_FREQ][FRAME_PURGE_RENDERTARGETS_LIST_SIZE]; // Purge list for rendertargets
-int frame_purge_idx = 0; // Index for currently populatable purge list
-int frame_elem_purge_idx = 0; // Index for currently populatable purge list element
-int frame_rt_purge_idx = 0; // Index for currently populatable purge list rendetarget
-static int frame_purge_clean_idx = 1;
+static volatile uint32_t *scene_notification; // Notification written by the GPU when a scene completes
+static uint32_t scene_seq = 0; // Sequence number of the last submitted scene
 SceUID gc_mutex;
 static int gc_thread_priority = 0x10000100;
 static int gc_thread_affinity = 0;
+static int dxt_workers_num = DXT_DEF_WORKERS; // Number of texture compressor workers started alongside sceGxm context
+static int dxt_workers_priority = 0x10000100;
+static int dxt_workers_affinity = 0;
 #ifdef HAVE_PTHREAD
 pthread_t gc_thread;
 #else
@@ -131,6 +131,9 @@ razor_results razor_metrics;
 GLboolean has_razor_live = GL_FALSE; // Flag for live metrics support with sceRazor
 #endif
 
+#define FRAG_PATCH_KEY_SIZE 4 // Number of words in the key of patched fragment programs
+#define FRAG_PATCH_KEY_LINK 3 // Index of the linked vertex program in the key of patched fragment programs
+
 #ifdef HAVE_SHARED_RENDERTARGETS
 #define MAX_RENDER_TARGETS_NUM 47 // Maximum amount of dedicated render targets usable for fbos
 #define MAX_SHARED_RT_SIZE 256 // Maximum  width value in pixels for shared rendertargets usage
@@ -223,6 +226,15 @@ static void display_queue_callback(const void *callbackData) {
 		sceDisplayWaitVblankStartMulti(vsync_interval);
 }
 
+static void purge_rendertarget(void *rt) {
+	sceGxmDestroyRenderTarget((SceGxmRenderTarget *)rt);
+}
+
+static const purge_cb purge_callbacks[PURGE_KINDS_NUM] = {
+	vgl_free, // PURGE_MEM
+	purge_rendertarget // PURGE_RENDERTARGET
+};
+
 // Garbage collector
 #if defined(HAVE_PTHREAD) && !defined(HAVE_SINGLE_THREADED_GC)
 void garbage_collector(void *arg) {
@@ -234,26 +246,14 @@ int garbage_collector(unsigned int args, void *arg) {
 		// Waiting for garbage collection request
 		sceKernelWaitSema(gc_mutex, 1, NULL);
 #endif
-		// Purging all elements marked for deletion
-		int i;
-		for (i = 0; i < FRAME_PURGE_LIST_SIZE; i++) {
-			if (frame_purge_list[frame_purge_clean_idx][i]) {
-				vgl_free(frame_purge_list[frame_purge_clean_idx][i]);
-				frame_purge_list[frame_purge_clean_idx][i] = NULL;
-			} else
-				break;
-		}
-		for (i = 0; i < FRAME_PURGE_RENDERTARGETS_LIST_SIZE; i++) {
-			if (frame_rt_purge_list[frame_purge_clean_idx][i]) {
-				sceGxmDestroyRenderTarget(frame_rt_purge_list[frame_purge_clean_idx][i]);
-				frame_rt_purge_list[frame_purge_clean_idx][i] = NULL;
-			} else
-				break;
+		// Purging all elements whose last referencing scene has been completed by the GPU
+		uint32_t completed_seq = *scene_notification;
+		if (purge_queue_ready(completed_seq)) {
+			PROFILE_ZONE(GARBAGE_COLLECTOR);
+			// Transfers are not tracked by scene notifications, so we make sure none is still reading from purged memory
+			sceGxmTransferFinish();
+			purge_queue_collect(completed_seq);
 		}
-		frame_purge_clean_idx = (frame_purge_clean_idx + 1) % FRAME_PURGE_FREQ;
-		frame_purge_idx = (frame_purge_idx + 1) % FRAME_PURGE_FREQ;
-		frame_elem_purge_idx = 0;
-		frame_rt_purge_idx = 0;
 #ifndef HAVE_SINGLE_THREADED_GC
 	}
 #ifndef HAVE_PTHREAD
@@ -262,8 +262,13 @@ int garbage_collector(unsigned int args, void *arg) {
 #endif
 }
 
+// vitashark allocator taking a size_t size
+static void *shark_malloc(size_t size) {
+	return vglMalloc(size);
+}
+
 GLboolean startShaderCompiler(void) {
-	shark_set_allocators(vglMalloc, vglFree);
+	shark_set_allocators(shark_malloc, vglFree);
 	is_shark_online = shark_init(NULL) >= 0;
 
 	// If standard path failed to init we try to init it with ScePiglet path
@@ -309,7 +314,7 @@ void initGxm(void) {
 
 #ifndef HAVE_SINGLE_THREADED_GC
 	// Initializing garbage collector
-	gc_mutex = sceKernelCreateSema("Garbage Collector Sema", 0, 0, FRAME_PURGE_FREQ, NULL);
+	gc_mutex = sceKernelCreateSema("Garbage Collector Sema", 0, 0, GC_MAX_PENDING_REQUESTS, NULL);
 #ifdef HAVE_PTRHEAD
 	pthread_create(&gc_thread, NULL, garbage_collector, NULL);
 	pthread_setaffinity_np(gc_thread, 4, &gc_thread_affinity);
@@ -341,6 +346,11 @@ void initGxm(void) {
 	sceGxmVshInitialize(&gxm_init_params);
 	gxm_initialized = GL_TRUE;
 
+	// Initializing deferred destruction queue
+	scene_notification = sceGxmGetNotificationRegion();
+	*scene_notification = scene_seq;
+	purge_queue_init(purge_callbacks, PURGE_KINDS_NUM);
+
 #ifdef HAVE_DEVKIT
 	sceRazorGpuLiveSetMetricsGroup(SCE_RAZOR_GPU_LIVE_METRICS_GROUP_PBUFFER_USAGE);
 	has_razor_live = !sceRazorGpuLiveStart();
@@ -364,7 +374,7 @@ void initGxmContext(void) {
 	// Setting sceGxm context parameters
 	SceGxmContextParams gxm_context_params;
 	sceClibMemset(&gxm_context_params, 0, sizeof(SceGxmContextParams));
-	gxm_context_params.hostMem = vglMalloc(SCE_GXM_MINIMUM_CONTEXT_HOST_MEM_SIZE);
+	gxm_context_params.hostMem = gxm_context_host_mem = vglMalloc(SCE_GXM_MINIMUM_CONTEXT_HOST_MEM_SIZE);
 	gxm_context_params.hostMemSize = SCE_GXM_MINIMUM_CONTEXT_HOST_MEM_SIZE;
 	gxm_context_params.vdmRingBufferMem = vdm_ring_buffer_addr;
 	gxm_context_params.vdmRingBufferMemSize = gxm_vdm_buf_size;
@@ -378,9 +388,16 @@ void initGxmContext(void) {
 
 	// Initializing sceGxm context
 	sceGxmCreateContext(&gxm_context_params, &gxm_context);
+	reset_gxm_state();
 
 	// Initializing circular pool for uniform buffers
 	vglSetupUniformCircularPool();
+
+	// Initializing streaming rings for client arrays
+	gpu_stream_init(scene_notification);
+
+	// Starting texture compressor workers
+	dxt_workers_init(dxt_workers_num, dxt_workers_priority, dxt_workers_affinity);
 }
 
 void termGxmContext(void) {
@@ -390,8 +407,16 @@ void termGxmContext(void) {
 	vgl_free(fragment_ring_buffer_addr);
 	gpu_fragment_usse_free_mapped(fragment_usse_ring_buffer_addr);
 
+	// Releasing all elements marked for deletion
+	purge_queue_flush();
+
+	// Releasing streaming rings
+	gpu_stream_term();
+
 	// Destroying sceGxm context
 	sceGxmDestroyContext(gxm_context);
+	gxm_context = NULL;
+	vglFree(gxm_context_host_mem);
 
 	if (system_app_mode) {
 		sceSharedFbBegin(shared_fb, &shared_fb_info);
@@ -400,7 +425,11 @@ void termGxmContext(void) {
 		sceSharedFbClose(shared_fb);
 	}
 
-	// Shutting down runtime shader compiler
+	// Shutting down texture compressor workers
+	dxt_workers_term();
+
+	// Shutting down runtime shader compiler (shader patcher is already gone, so pending compilations are dropped)
+	stop_async_shader_compiler(GL_FALSE);
 	glReleaseShaderCompiler();
 }
 
@@ -563,6 +592,70 @@ void stopShaderPatcher(void) {
 	gpu_fragment_usse_free_mapped(gxm_shader_patcher_fragment_usse_addr);
 }
 
+static void release_patched_vertex_program(void *prog) {
+	sceGxmShaderPatcherReleaseVertexProgram(gxm_shader_patcher, (SceGxmVertexProgram *)prog);
+}
+
+static void release_patched_fragment_program(void *prog) {
+	sceGxmShaderPatcherReleaseFragmentProgram(gxm_shader_patcher, (SceGxmFragmentProgram *)prog);
+}
+
+void patch_vertex_program_cached(patch_cache *c, SceGxmShaderPatcherId id, const SceGxmVertexAttribute *attrs, uint32_t attrs_num, const SceGxmVertexStream *streams, uint32_t streams_num, SceGxmVertexProgram **prog) {
+	PROFILE_ZONE(PATCH_VERTEX_PROGRAM);
+
+	// Building the cache key from the vertex layout
+	uint32_t key[1 + VERTEX_ATTRIBS_NUM * 3];
+	key[0] = (attrs_num << 16) | streams_num;
+	vgl_fast_memcpy(&key[1], attrs, attrs_num * sizeof(SceGxmVertexAttribute));
+	vgl_fast_memcpy(&key[1 + attrs_num * 2], streams, streams_num * sizeof(SceGxmVertexStream));
+	uint32_t key_size = 1 + attrs_num * 2 + streams_num;
+	uint32_t hash = patch_cache_hash((uintptr_t)id, key, key_size);
+
+	SceGxmVertexProgram *res = (SceGxmVertexProgram *)patch_cache_find(c, (uintptr_t)id, key, key_size, hash);
+	if (!res) {
+		int r = sceGxmShaderPatcherCreateVertexProgram(gxm_shader_patcher, id, attrs, attrs_num, streams, streams_num, &res);
+		if (r) {
+#ifdef LOG_ERRORS
+			vgl_log("Vertex shader patching failed (%s) on shader 0x%X with %d attributes and %d streams.\n", get_gxm_error_literal(r), id, attrs_num, streams_num);
+#endif
+			return;
+		}
+		patch_cache_insert(c, (uintptr_t)id, key, key_size, hash, res);
+	}
+	*prog = res;
+}
+
+void patch_fragment_program_cached(patch_cache *c, SceGxmShaderPatcherId id, SceGxmOutputRegisterFormat fmt, const SceGxmProgram *vertex_link, SceGxmFragmentProgram **prog) {
+	// Building the cache key from blend settings, multisample mode, output format and linked vertex program
+	uint32_t key[FRAG_PATCH_KEY_SIZE] = {fmt, msaa_mode, blend_info.raw, (uintptr_t)vertex_link};
+	uint32_t hash = patch_cache_hash((uintptr_t)id, key, FRAG_PATCH_KEY_SIZE);
+
+	SceGxmFragmentProgram *res = (SceGxmFragmentProgram *)patch_cache_find(c, (uintptr_t)id, key, FRAG_PATCH_KEY_SIZE, hash);
+	if (!res) {
+		int r = sceGxmShaderPatcherCreateFragmentProgram(gxm_shader_patcher, id, fmt, msaa_mode, &blend_info.info, vertex_link, &res);
+		if (r) {
+#ifdef LOG_ERRORS
+			vgl_log("Fragment shader patching failed (%s) on shader 0x%X.\n", get_gxm_error_literal(r), id);
+#endif
+			return;
+		}
+		patch_cache_insert(c, (uintptr_t)id, key, FRAG_PATCH_KEY_SIZE, hash, res);
+	}
+	*prog = res;
+}
+
+void release_linked_fragment_programs(patch_cache *c, const SceGxmProgram *vertex_link) {
+	// Keys hold the linked vertex program address, which may be reused by the next allocated program
+	patch_cache_drop_key(c, FRAG_PATCH_KEY_LINK, (uintptr_t)vertex_link, release_patched_fragment_program);
+}
+
+void release_patched_programs(patch_cache *vert_cache, patch_cache *frag_cache) {
+	if (vert_cache)
+		patch_cache_clear(vert_cache, release_patched_vertex_program);
+	if (frag_cache)
+		patch_cache_clear(frag_cache, release_patched_fragment_program);
+}
+
 void waitRenderingDone(void) {
 	// Wait for rendering to be finished
 	sceGxmDisplayQueueFinish();
@@ -570,14 +663,24 @@ void waitRenderingDone(void) {
 }
 
 void sceneEnd(void) {
-	// Ends current gxm scene
-	sceGxmEndScene(gxm_context, NULL, NULL);
+	// Issuing pending batched draws before closing the scene
+	flush_ffp_batch();
+
+	// Ends current gxm scene signaling its completion through the notification region
+	SceGxmNotification scene_end_notification;
+	scene_end_notification.address = scene_notification;
+	scene_end_notification.value = ++scene_seq;
+	sceGxmEndScene(gxm_context, NULL, &scene_end_notification);
+
+	// Closing streamed data of the scene, its space will be reclaimed once the GPU completes it
+	gpu_stream_fence(scene_seq);
 	if (system_app_mode && vsync_interval)
 		sceDisplayWaitVblankStartMulti(vsync_interval);
 }
 
 void sceneReset(void) {
 	if (in_use_framebuffer != active_write_fb || needs_scene_reset) {
+		PROFILE_ZONE(SCENE_RESET);
 		needs_scene_reset = GL_FALSE;
 		in_use_framebuffer = active_write_fb;
 		is_fbo_float = in_use_framebuffer ? in_use_framebuffer->is_float : GL_FALSE;
@@ -671,6 +774,9 @@ void sceneReset(void) {
 #endif
 		}
 
+		// Viewport and region clip set for the previous scene are lost
+		reset_gxm_scene_state();
+
 		// Setting back current viewport if enabled cause sceGxm will reset it at sceGxmEndScene call
 		if (old_framebuffer != in_use_framebuffer) {
 			old_framebuffer = in_use_framebuffer;
@@ -682,13 +788,22 @@ void sceneReset(void) {
 			change_cull_mode();
 #endif
 		} else
-			setViewport(gxm_context, x_port, x_scale, y_port, y_scale, z_port, z_scale);
+			set_gxm_viewport(x_port, x_scale, y_port, y_scale, z_port, z_scale);
 
 		if (scissor_test_state)
-			sceGxmSetRegionClip(gxm_context, SCE_GXM_REGION_CLIP_OUTSIDE, region.x, region.y, region.x + region.w - 1, region.y + region.h - 1);
+			set_gxm_region_clip(SCE_GXM_REGION_CLIP_OUTSIDE, region.x, region.y, region.x + region.w - 1, region.y + region.h - 1);
 	}
 }
 
+uint32_t get_pending_scene_seq(void) {
+	// Scenes get signaled when they end, so the one being recorded will use the next sequence number
+	return scene_seq + 1;
+}
+
+uint32_t get_completed_scene_seq(void) {
+	return *scene_notification;
+}
+
 /*
  * ------------------------------
  * - IMPLEMENTATION STARTS HERE -
@@ -700,6 +815,15 @@ void vglSetupGarbageCollector(int priority, int affinity) {
 	gc_thread_affinity = affinity;
 }
 
+void vglSetupTextureCompressor(int num_threads, int priority, int affinity) {
+	dxt_workers_num = num_threads;
+	dxt_workers_priority = priority;
+	dxt_workers_affinity = affinity;
+	// Block rows are split between the calling thread and the workers, so zero workers means compressing on the calling thread only
+	if (gxm_context)
+		dxt_workers_init(num_threads, priority, affinity);
+}
+
 void vglSetParamBufferSize(uint32_t size) {
 	gxm_param_buf_size = size;
 }
@@ -725,6 +849,14 @@ void vglUseTripleBuffering(GLboolean usage) {
 }
 
 void vglSwapBuffers(GLboolean has_commondialog) {
+	// Frames boundaries are set on swaps, so a swap is accounted to the frame it starts
+	PROFILE_FRAME();
+	PROFILE_ZONE(SWAP_BUFFERS);
+#ifdef HAVE_GL_CAPTURE
+	capture_frame(has_commondialog);
+#endif
+	flush_ffp_batch();
+
 #ifndef SKIP_ERROR_HANDLING
 	vgl_debugger_framecount++;
 #endif
@@ -869,6 +1001,9 @@ void vglSwapBuffers(GLboolean has_commondialog) {
 	}
 	needs_scene_reset = GL_TRUE;
 
+	// Closing current purge batch, its elements can't be referenced by scenes submitted from now on
+	purge_queue_submit(scene_seq);
+
 	// Starting garbage collector job
 #ifdef HAVE_SINGLE_THREADED_GC
 	garbage_collector(0, NULL);
@@ -876,19 +1011,25 @@ void vglSwapBuffers(GLboolean has_commondialog) {
 	sceKernelSignalSema(gc_mutex, 1);
 #endif
 
+#ifdef HAVE_CIRCULAR_VERTEX_POOL
 	reset_vertex_data_pool();
+#endif
 }
 
 void glFinish(void) {
+	flush_ffp_batch();
+
 	// Waiting for GPU to finish drawing jobs
 	sceGxmFinish(gxm_context);
 }
 
 void glReleaseShaderCompiler(void) {
+	compile_lock();
 	if (is_shark_online) {
 		shark_end();
 		is_shark_online = GL_FALSE;
 	}
+	compile_unlock();
 }
 
 void glFlush(void) {
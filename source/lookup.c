@@ -23,6 +23,7 @@
 
 #include "shared.h"
 #include "vitaGL.h"
+#include "lookup_hash.h"
 
 //#define EXPOSE_VGL_FUNCS // Define this to enable exposure of vgl* functions in vglGetProcAddress/eglGetProcAddress
 
@@ -197,7 +198,6 @@ static const struct {
 	{"glTexCoord2f", (void *)glTexCoord2f},
 	{"glTexCoord2fv", (void *)glTexCoord2fv},
 	{"glTexCoord2i", (void *)glTexCoord2i},
-	{"glTexCoord2iv", (void *)glTexCoord2i},
 	{"glTexCoord2s", (void *)glTexCoord2s},
 	{"glTexCoordPointer", (void *)glTexCoordPointer},
 	{"glTexEnvf", (void *)glTexEnvf},
@@ -252,6 +252,17 @@ static const struct {
 	{"gluBuild2DMipmaps", (void *)gluBuild2DMipmaps},
 	{"gluLookAt", (void *)gluLookAt},
 	{"gluPerspective", (void *)gluPerspective},
+	// *egl
+	{"eglBindAPI", (void *)eglBindAPI},
+	{"eglGetDisplay", (void *)eglGetDisplay},
+	{"eglGetError", (void *)eglGetError},
+	{"eglGetProcAddress", (void *)eglGetProcAddress},
+	{"eglGetSystemTimeFrequencyNV", (void *)eglGetSystemTimeFrequencyNV},
+	{"eglGetSystemTimeNV", (void *)eglGetSystemTimeNV},
+	{"eglQueryAPI", (void *)eglQueryAPI},
+	{"eglSwapInterval", (void *)eglSwapInterval},
+	{"eglSwapBuffers", (void *)eglSwapBuffers},
+	// Optional entries must stay last so that indices in lookup_hash.h do not depend on them being built
 #ifdef EXPOSE_VGL_FUNCS
 	// *vgl
 	{"vglColorPointer", (void *)vglColorPointer},
@@ -269,13 +280,22 @@ static const struct {
 	{"vglVertexAttribPointerMapped", (void *)vglVertexAttribPointerMapped},
 	{"vglAlloc", (void *)vglAlloc},
 	{"vglCalloc", (void *)vglCalloc},
+	{"vglDumpProfilerTrace", (void *)vglDumpProfilerTrace},
 	{"vglEnd", (void *)vglEnd},
 	{"vglForceAlloc", (void *)vglForceAlloc},
 	{"vglFree", (void *)vglFree},
+	{"vglGetBufferStats", (void *)vglGetBufferStats},
+	{"vglGetCaptureStats", (void *)vglGetCaptureStats},
+	{"vglGetFFPBatchingStats", (void *)vglGetFFPBatchingStats},
+	{"vglGetFFPCacheStats", (void *)vglGetFFPCacheStats},
 	{"vglGetGxmTexture", (void *)vglGetGxmTexture},
 	{"vglGetProcAddress", (void *)vglGetProcAddress},
+	{"vglGetProfilerZoneStats", (void *)vglGetProfilerZoneStats},
+	{"vglGetShaderCacheStats", (void *)vglGetShaderCacheStats},
 	{"vglGetShaderBinary", (void *)vglGetShaderBinary},
+	{"vglGetStateStats", (void *)vglGetStateStats},
 	{"vglGetTexDataPointer", (void *)vglGetTexDataPointer},
+	{"vglGetUniformStats", (void *)vglGetUniformStats},
 	{"vglInit", (void *)vglInit},
 	{"vglInitExtended", (void *)vglInitExtended},
 	{"vglInitWithCustomSizes", (void *)vglInitWithCustomSizes},
@@ -287,15 +307,22 @@ static const struct {
 	{"vglMemTotal", (void *)vglMemTotal},
 	{"vglOverloadTexDataPointer", (void *)vglOverloadTexDataPointer},
 	{"vglRealloc", (void *)vglRealloc},
+	{"vglResetProfiler", (void *)vglResetProfiler},
 	{"vglSetDisplayCallback", (void *)vglSetDisplayCallback},
+	{"vglSetFFPCacheSize", (void *)vglSetFFPCacheSize},
 	{"vglSetFragmentBufferSize", (void *)vglSetFragmentBufferSize},
 	{"vglSetParamBufferSize", (void *)vglSetParamBufferSize},
+	{"vglSetShaderCacheSize", (void *)vglSetShaderCacheSize},
 	{"vglSetUSSEBufferSize", (void *)vglSetUSSEBufferSize},
 	{"vglSetVDMBufferSize", (void *)vglSetVDMBufferSize},
 	{"vglSetVertexBufferSize", (void *)vglSetVertexBufferSize},
 	{"vglSetVertexPoolSize", (void *)vglSetVertexPoolSize},
+	{"vglSetupAsyncShaderCompiler", (void *)vglSetupAsyncShaderCompiler},
 	{"vglSetupGarbageCollector", (void *)vglSetupGarbageCollector},
 	{"vglSetupRuntimeShaderCompiler", (void *)vglSetupRuntimeShaderCompiler},
+	{"vglSetupTextureCompressor", (void *)vglSetupTextureCompressor},
+	{"vglStartCapture", (void *)vglStartCapture},
+	{"vglStopCapture", (void *)vglStopCapture},
 	{"vglSwapBuffers", (void *)vglSwapBuffers},
 	{"vglTexImageDepthBuffer", (void *)vglTexImageDepthBuffer},
 	{"vglUseCachedMem", (void *)vglUseCachedMem},
@@ -305,39 +332,55 @@ static const struct {
 	{"vglUseExtraMem", (void *)vglUseExtraMem},
 	{"vglWaitVblankStart", (void *)vglWaitVblankStart},
 #endif
-	// *egl
-	{"eglBindAPI", (void *)eglBindAPI},
-	{"eglGetDisplay", (void *)eglGetDisplay},
-	{"eglGetError", (void *)eglGetError},
-	{"eglGetProcAddress", (void *)eglGetProcAddress},
-	{"eglGetSystemTimeFrequencyNV", (void *)eglGetSystemTimeFrequencyNV},
-	{"eglGetSystemTimeNV", (void *)eglGetSystemTimeNV},
-	{"eglQueryAPI", (void *)eglQueryAPI},
-	{"eglSwapInterval", (void *)eglSwapInterval},
-	{"eglSwapBuffers", (void *)eglSwapBuffers},
 };
 
 static const size_t vgl_numproc = sizeof(vgl_proctable) / sizeof(*vgl_proctable);
 
+// A table not matching its hash would make some entries unreachable
+#ifdef EXPOSE_VGL_FUNCS
+_Static_assert(sizeof(vgl_proctable) / sizeof(*vgl_proctable) == VGL_PROCS_NUM, "lookup_hash.h is out of date, run gen_lookup_hash.py");
+#else
+_Static_assert(sizeof(vgl_proctable) / sizeof(*vgl_proctable) == VGL_PROCS_NUM - VGL_OPTIONAL_PROCS_NUM, "lookup_hash.h is out of date, run gen_lookup_hash.py");
+#endif
+
+// Must match hash_name and slot_of in gen_lookup_hash.py
+static inline uint32_t hash_proc_name(const char *name, int len) {
+	uint32_t h = 0x811C9DC5;
+	for (int i = 0; i < len; i++) {
+		h = (h ^ (uint8_t)name[i]) * 0x01000193;
+	}
+	return h;
+}
+
+static inline uint32_t proc_slot(uint32_t h) {
+	uint32_t x = h + vgl_proc_displacements[h & (VGL_PROC_BUCKETS_NUM - 1)] * 0x9E3779B9;
+	x ^= x >> 16;
+	x *= 0x85EBCA6B;
+	x ^= x >> 13;
+	x *= 0xC2B2AE35;
+	x ^= x >> 16;
+	return x & (VGL_PROC_SLOTS_NUM - 1);
+}
+
 void *vglGetProcAddress(const char *name) {
 	if (!name || !*name) {
 		return NULL;
 	}
 
 	// strip any extension markers
-	const int len = strlen(name);
-	char tmpname[len + 1];
-	vgl_fast_memcpy(tmpname, name, len + 1);
-	if (!strcmp(tmpname + len - 3, "EXT") || !strcmp(tmpname + len - 3, "ARB") || !strcmp(tmpname + len - 3, "OES")) {
-		tmpname[len - 3] = 0;
+	int len = strlen(name);
+	if (len > 3 && (!strcmp(name + len - 3, "EXT") || !strcmp(name + len - 3, "ARB") || !strcmp(name + len - 3, "OES"))) {
+		len -= 3;
 	}
 
-	// search for stripped name
-	for (size_t i = 0; i < vgl_numproc; ++i) {
-		if (!strcmp(tmpname, vgl_proctable[i].name)) {
-			return vgl_proctable[i].proc;
-		}
+	// search for stripped name, the only candidate is the entry in its hash slot
+	uint16_t idx = vgl_proc_slots[proc_slot(hash_proc_name(name, len))];
+	if (idx >= vgl_numproc || strncmp(name, vgl_proctable[idx].name, len) || vgl_proctable[idx].name[len]) {
+		return NULL;
 	}
-
-	return NULL;
+#ifdef HAVE_GL_CAPTURE
+	return capture_get_proc(vgl_proctable[idx].proc);
+#else
+	return vgl_proctable[idx].proc;
+#endif
 }
@@ -0,0 +1,61 @@
+/*
+ * lookup_hash.h:
+ * Perfect hash over vgl_proctable names, generated by gen_lookup_hash.py (do not edit)
+ */
+
+#ifndef _LOOKUP_HASH_H_
+#define _LOOKUP_HASH_H_
+
+#define VGL_PROCS_NUM 294 // Number of entries in vgl_proctable with EXPOSE_VGL_FUNCS
+#define VGL_OPTIONAL_PROCS_NUM 66 // Number of entries in vgl_proctable depending on EXPOSE_VGL_FUNCS
+#define VGL_PROC_BUCKETS_NUM 128
+#define VGL_PROC_SLOTS_NUM 512
+#define VGL_PROC_EMPTY_SLOT 0xFFFF
+
+static const uint8_t vgl_proc_displacements[VGL_PROC_BUCKETS_NUM] = {
+	0x00, 0x02, 0x01, 0x04, 0x01, 0x02, 0x00, 0x03, 0x06, 0x03, 0x02, 0x00, 0x00, 0x00, 0x00, 0x01,
+	0x00, 0x00, 0x02, 0x00, 0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x02, 0x00, 0x00,
+	0x01, 0x03, 0x01, 0x00, 0x00, 0x06, 0x01, 0x02, 0x04, 0x00, 0x01, 0x03, 0x00, 0x03, 0x00, 0x02,
+	0x06, 0x02, 0x15, 0x00, 0x01, 0x00, 0x00, 0x02, 0x07, 0x05, 0x01, 0x00, 0x00, 0x06, 0x00, 0x01,
+	0x01, 0x01, 0x00, 0x0C, 0x02, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x02, 0x00, 0x00, 0x03, 0x04,
+	0x00, 0x00, 0x01, 0x08, 0x07, 0x00, 0x00, 0x01, 0x00, 0x02, 0x01, 0x01, 0x04, 0x02, 0x00, 0x04,
+	0x00, 0x12, 0x02, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02, 0x01, 0x03, 0x0C, 0x00, 0x01,
+	0x05, 0x01, 0x01, 0x0C, 0x02, 0x01, 0x00, 0x01, 0x01, 0x00, 0x01, 0x08, 0x04, 0x00, 0x02, 0x01,
+};
+
+static const uint16_t vgl_proc_slots[VGL_PROC_SLOTS_NUM] = {
+	0xFFFF, 0x0044, 0xFFFF, 0x00C3, 0x0051, 0x00C1, 0xFFFF, 0x008D, 0xFFFF, 0xFFFF, 0x0058, 0x00B3, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0x00C4, 0x00B6, 0xFFFF, 0x00AD, 0x0049, 0xFFFF, 0x004C, 0x0109, 0x001F, 0x001C, 0x00CC, 0x00AF, 0x00F4, 0xFFFF, 0xFFFF, 0x00AA,
+	0x002E, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x00CE, 0xFFFF, 0x0060, 0xFFFF, 0xFFFF, 0x00D5, 0x0089, 0x0055, 0xFFFF, 0xFFFF, 0x0122,
+	0xFFFF, 0x0038, 0x005C, 0x00F9, 0x0117, 0xFFFF, 0x0017, 0x00AE, 0x00A9, 0x0104, 0xFFFF, 0x0124, 0x00A0, 0x0008, 0xFFFF, 0x0005,
+	0xFFFF, 0x005A, 0xFFFF, 0x00EA, 0xFFFF, 0x001D, 0xFFFF, 0x0105, 0x010F, 0x0034, 0x0053, 0x0057, 0x006F, 0xFFFF, 0x00AB, 0x00DA,
+	0xFFFF, 0x000C, 0x00F7, 0xFFFF, 0x003E, 0x00B1, 0x0042, 0xFFFF, 0xFFFF, 0x00E1, 0x0074, 0xFFFF, 0xFFFF, 0x007A, 0x00B5, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x00B8, 0x0073, 0x00EC, 0xFFFF, 0xFFFF, 0x00DB, 0x00EF, 0x0095, 0x00D2, 0x0068, 0xFFFF, 0xFFFF,
+	0x00B4, 0x00A2, 0x009D, 0xFFFF, 0x0084, 0x0077, 0xFFFF, 0xFFFF, 0x006A, 0xFFFF, 0xFFFF, 0x007B, 0x0080, 0x00E8, 0x0123, 0x008E,
+	0xFFFF, 0xFFFF, 0x004A, 0xFFFF, 0x010A, 0x00FD, 0x009E, 0xFFFF, 0xFFFF, 0x00F0, 0xFFFF, 0x006D, 0xFFFF, 0x00F5, 0xFFFF, 0x00DC,
+	0x0012, 0x00DE, 0x0061, 0xFFFF, 0x0118, 0xFFFF, 0xFFFF, 0x011F, 0x0031, 0x00E3, 0xFFFF, 0x00DF, 0x004B, 0xFFFF, 0xFFFF, 0xFFFF,
+	0x0004, 0x001A, 0x0014, 0x00BE, 0x003C, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0088, 0x0103, 0x003F, 0x00C5, 0x004F, 0xFFFF,
+	0x0069, 0x00FA, 0xFFFF, 0x00E5, 0x00C7, 0x0028, 0x0076, 0xFFFF, 0x0063, 0x0099, 0x009C, 0xFFFF, 0xFFFF, 0x0013, 0x0041, 0xFFFF,
+	0x0113, 0xFFFF, 0xFFFF, 0x0007, 0x005D, 0x0114, 0xFFFF, 0xFFFF, 0x0026, 0xFFFF, 0xFFFF, 0x0111, 0x00D6, 0xFFFF, 0xFFFF, 0x00FF,
+	0xFFFF, 0x0043, 0xFFFF, 0xFFFF, 0x005F, 0x0066, 0x006C, 0x00A3, 0x0027, 0x0018, 0x00CA, 0xFFFF, 0x008F, 0x0059, 0x00D0, 0x009B,
+	0xFFFF, 0x0046, 0x0002, 0x0079, 0xFFFF, 0x00CD, 0xFFFF, 0x0070, 0x003A, 0xFFFF, 0x0072, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0016,
+	0x008A, 0x004E, 0x00EE, 0xFFFF, 0x0064, 0x0011, 0xFFFF, 0xFFFF, 0x002F, 0x00A4, 0x0033, 0xFFFF, 0xFFFF, 0xFFFF, 0x00F3, 0xFFFF,
+	0xFFFF, 0x00AC, 0xFFFF, 0x00DD, 0x00D9, 0x0040, 0x00B9, 0xFFFF, 0xFFFF, 0xFFFF, 0x00D1, 0x0086, 0xFFFF, 0xFFFF, 0xFFFF, 0x010C,
+	0x00D7, 0x0067, 0x0094, 0xFFFF, 0x0090, 0x00FE, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x007F, 0x002C, 0xFFFF, 0xFFFF, 0x008C, 0xFFFF,
+	0xFFFF, 0x001B, 0xFFFF, 0xFFFF, 0xFFFF, 0x001E, 0x00A8, 0x00C9, 0x00F8, 0xFFFF, 0x0082, 0xFFFF, 0x00E2, 0xFFFF, 0x0035, 0x005E,
+	0xFFFF, 0x00F6, 0xFFFF, 0x00A1, 0x0102, 0x00B7, 0x0021, 0xFFFF, 0xFFFF, 0x0036, 0xFFFF, 0xFFFF, 0x00B2, 0xFFFF, 0x0091, 0x00BF,
+	0x00A5, 0x0085, 0x00FC, 0x0020, 0x0009, 0x00E9, 0xFFFF, 0xFFFF, 0xFFFF, 0x0116, 0x00F2, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0019,
+	0x00A6, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0032, 0x0024, 0xFFFF, 0xFFFF, 0x0093, 0xFFFF, 0x0048, 0x0029, 0x0096, 0x0112, 0xFFFF,
+	0xFFFF, 0xFFFF, 0x006E, 0x00C6, 0x006B, 0xFFFF, 0xFFFF, 0x010B, 0x0052, 0xFFFF, 0xFFFF, 0xFFFF, 0x0078, 0x00BB, 0x0121, 0xFFFF,
+	0xFFFF, 0x0025, 0xFFFF, 0xFFFF, 0x009F, 0x0120, 0x0115, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0110, 0x0106, 0x0010, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0x0101, 0x00ED, 0x0097, 0x009A, 0x0125, 0x0001, 0x000B, 0x00E7, 0xFFFF, 0x0108, 0x00BD, 0x007E, 0xFFFF,
+	0x0045, 0xFFFF, 0xFFFF, 0x011D, 0xFFFF, 0xFFFF, 0x0075, 0x00D8, 0x00BC, 0x002B, 0x00E0, 0x00F1, 0x0098, 0x00CB, 0xFFFF, 0x003D,
+	0xFFFF, 0x011B, 0x004D, 0x0107, 0xFFFF, 0xFFFF, 0x0022, 0xFFFF, 0xFFFF, 0x00E4, 0x0047, 0x0037, 0x00CF, 0x00C8, 0x000D, 0xFFFF,
+	0x011E, 0x00E6, 0x00B0, 0x0003, 0x002A, 0x00A7, 0xFFFF, 0x0039, 0x0087, 0xFFFF, 0x0015, 0x0081, 0x00EB, 0xFFFF, 0x0065, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0x007C, 0x0092, 0x0000, 0xFFFF, 0x0056, 0xFFFF, 0x0054, 0xFFFF, 0xFFFF, 0x0050, 0xFFFF, 0xFFFF, 0xFFFF,
+	0x000A, 0x00D3, 0xFFFF, 0xFFFF, 0x00C2, 0x0030, 0x003B, 0x00BA, 0x005B, 0xFFFF, 0x010D, 0xFFFF, 0x011C, 0x00FB, 0xFFFF, 0x000E,
+	0xFFFF, 0x0083, 0x0119, 0x0100, 0x000F, 0xFFFF, 0xFFFF, 0xFFFF, 0x0006, 0xFFFF, 0x008B, 0xFFFF, 0x00C0, 0xFFFF, 0xFFFF, 0x007D,
+	0x002D, 0x010E, 0xFFFF, 0x00D4, 0xFFFF, 0xFFFF, 0x0023, 0xFFFF, 0xFFFF, 0x011A, 0x0062, 0xFFFF, 0x0071, 0xFFFF, 0xFFFF, 0xFFFF,
+};
+
+#endif
@@ -77,7 +77,7 @@ typedef struct {
 	GLfloat fog_near;
 	GLint fog_mode;
 	// GL_HINT_BIT
-	GLboolean fast_texture_compression;
+	dxt_quality texture_compression_quality;
 	GLboolean recompress_non_native;
 	// GL_LINE_BIT
 	GLfloat line_width;
@@ -120,7 +120,7 @@ uint8_t attrib_stack_counter = 0;
 
 GLfloat line_width = 1.0f;
 GLfloat point_size = 1.0f;
-GLboolean fast_texture_compression = GL_FALSE; // Hints for texture compression
+dxt_quality texture_compression_quality = DXT_QUALITY_NORMAL; // Quality level for runtime texture compression
 GLboolean recompress_non_native = GL_FALSE;
 vector4f clear_rgba_val; // Current clear color for glClear
 
@@ -146,74 +146,76 @@ GLenum gl_polygon_mode_back = GL_FILL; // Current in use polygon mode for back
 viewport gl_viewport; // Current viewport state
 
 static void update_polygon_offset() {
+	flush_ffp_batch();
 	switch (polygon_mode_front) {
 	case SCE_GXM_POLYGON_MODE_TRIANGLE_LINE:
 		if (pol_offset_line)
-			sceGxmSetFrontDepthBias(gxm_context, (int)pol_factor, (int)pol_units);
+			set_gxm_depth_bias(GXM_SIDE_FRONT, (int)pol_factor, (int)pol_units);
 		else
-			sceGxmSetFrontDepthBias(gxm_context, 0, 0);
+			set_gxm_depth_bias(GXM_SIDE_FRONT, 0, 0);
 		break;
 	case SCE_GXM_POLYGON_MODE_TRIANGLE_POINT:
 		if (pol_offset_point)
-			sceGxmSetFrontDepthBias(gxm_context, (int)pol_factor, (int)pol_units);
+			set_gxm_depth_bias(GXM_SIDE_FRONT, (int)pol_factor, (int)pol_units);
 		else
-			sceGxmSetFrontDepthBias(gxm_context, 0, 0);
+			set_gxm_depth_bias(GXM_SIDE_FRONT, 0, 0);
 		break;
 	case SCE_GXM_POLYGON_MODE_TRIANGLE_FILL:
 		if (pol_offset_fill)
-			sceGxmSetFrontDepthBias(gxm_context, (int)pol_factor, (int)pol_units);
+			set_gxm_depth_bias(GXM_SIDE_FRONT, (int)pol_factor, (int)pol_units);
 		else
-			sceGxmSetFrontDepthBias(gxm_context, 0, 0);
+			set_gxm_depth_bias(GXM_SIDE_FRONT, 0, 0);
 		break;
 	}
 	switch (polygon_mode_back) {
 	case SCE_GXM_POLYGON_MODE_TRIANGLE_LINE:
 		if (pol_offset_line)
-			sceGxmSetBackDepthBias(gxm_context, (int)pol_factor, (int)pol_units);
+			set_gxm_depth_bias(GXM_SIDE_BACK, (int)pol_factor, (int)pol_units);
 		else
-			sceGxmSetBackDepthBias(gxm_context, 0, 0);
+			set_gxm_depth_bias(GXM_SIDE_BACK, 0, 0);
 		break;
 	case SCE_GXM_POLYGON_MODE_TRIANGLE_POINT:
 		if (pol_offset_point)
-			sceGxmSetBackDepthBias(gxm_context, (int)pol_factor, (int)pol_units);
+			set_gxm_depth_bias(GXM_SIDE_BACK, (int)pol_factor, (int)pol_units);
 		else
-			sceGxmSetBackDepthBias(gxm_context, 0, 0);
+			set_gxm_depth_bias(GXM_SIDE_BACK, 0, 0);
 		break;
 	case SCE_GXM_POLYGON_MODE_TRIANGLE_FILL:
 		if (pol_offset_fill)
-			sceGxmSetBackDepthBias(gxm_context, (int)pol_factor, (int)pol_units);
+			set_gxm_depth_bias(GXM_SIDE_BACK, (int)pol_factor, (int)pol_units);
 		else
-			sceGxmSetBackDepthBias(gxm_context, 0, 0);
+			set_gxm_depth_bias(GXM_SIDE_BACK, 0, 0);
 		break;
 	}
 }
 
 void change_cull_mode() {
+	flush_ffp_batch();
 	// Setting proper cull mode in sceGxm depending to current openGL machine state
 	if (cull_face_state) {
 #ifdef HAVE_UNFLIPPED_FBOS
 		if ((gl_front_face == GL_CW) && (gl_cull_mode == GL_BACK))
-			sceGxmSetCullMode(gxm_context, SCE_GXM_CULL_CCW);
+			set_gxm_cull_mode(SCE_GXM_CULL_CCW);
 		else if ((gl_front_face == GL_CCW) && (gl_cull_mode == GL_BACK))
-			sceGxmSetCullMode(gxm_context, SCE_GXM_CULL_CW);
+			set_gxm_cull_mode(SCE_GXM_CULL_CW);
 		else if ((gl_front_face == GL_CCW) && (gl_cull_mode == GL_FRONT))
-			sceGxmSetCullMode(gxm_context, SCE_GXM_CULL_CCW);
+			set_gxm_cull_mode(SCE_GXM_CULL_CCW);
 		else if ((gl_front_face == GL_CW) && (gl_cull_mode == GL_FRONT))
-			sceGxmSetCullMode(gxm_context, SCE_GXM_CULL_CW);
+			set_gxm_cull_mode(SCE_GXM_CULL_CW);
 #else
 		if ((gl_front_face == GL_CW) && (gl_cull_mode == GL_BACK))
-			sceGxmSetCullMode(gxm_context, is_rendering_display ? SCE_GXM_CULL_CCW : SCE_GXM_CULL_CW);
+			set_gxm_cull_mode(is_rendering_display ? SCE_GXM_CULL_CCW : SCE_GXM_CULL_CW);
 		else if ((gl_front_face == GL_CCW) && (gl_cull_mode == GL_BACK))
-			sceGxmSetCullMode(gxm_context, is_rendering_display ? SCE_GXM_CULL_CW : SCE_GXM_CULL_CCW);
+			set_gxm_cull_mode(is_rendering_display ? SCE_GXM_CULL_CW : SCE_GXM_CULL_CCW);
 		else if ((gl_front_face == GL_CCW) && (gl_cull_mode == GL_FRONT))
-			sceGxmSetCullMode(gxm_context, is_rendering_display ? SCE_GXM_CULL_CCW : SCE_GXM_CULL_CW);
+			set_gxm_cull_mode(is_rendering_display ? SCE_GXM_CULL_CCW : SCE_GXM_CULL_CW);
 		else if ((gl_front_face == GL_CW) && (gl_cull_mode == GL_FRONT))
-			sceGxmSetCullMode(gxm_context, is_rendering_display ? SCE_GXM_CULL_CW : SCE_GXM_CULL_CCW);
+			set_gxm_cull_mode(is_rendering_display ? SCE_GXM_CULL_CW : SCE_GXM_CULL_CCW);
 #endif
 		else if (gl_cull_mode == GL_FRONT_AND_BACK)
 			no_polygons_mode = GL_TRUE;
 	} else
-		sceGxmSetCullMode(gxm_context, SCE_GXM_CULL_NONE);
+		set_gxm_cull_mode(SCE_GXM_CULL_NONE);
 }
 
 /*
@@ -223,6 +225,7 @@ void change_cull_mode() {
  */
 
 void glPolygonMode(GLenum face, GLenum mode) {
+	flush_ffp_batch();
 	SceGxmPolygonMode new_mode;
 	switch (mode) {
 	case GL_POINT:
@@ -241,18 +244,17 @@ void glPolygonMode(GLenum face, GLenum mode) {
 	case GL_FRONT:
 		polygon_mode_front = new_mode;
 		gl_polygon_mode_front = mode;
-		sceGxmSetFrontPolygonMode(gxm_context, new_mode);
+		set_gxm_polygon_mode(GXM_SIDE_FRONT, new_mode);
 		break;
 	case GL_BACK:
 		polygon_mode_back = new_mode;
 		gl_polygon_mode_back = mode;
-		sceGxmSetBackPolygonMode(gxm_context, new_mode);
+		set_gxm_polygon_mode(GXM_SIDE_BACK, new_mode);
 		break;
 	case GL_FRONT_AND_BACK:
 		polygon_mode_front = polygon_mode_back = new_mode;
 		gl_polygon_mode_front = gl_polygon_mode_back = mode;
-		sceGxmSetFrontPolygonMode(gxm_context, new_mode);
-		sceGxmSetBackPolygonMode(gxm_context, new_mode);
+		set_gxm_polygon_mode(GXM_SIDES_BOTH, new_mode);
 		break;
 	default:
 		SET_GL_ERROR_WITH_VALUE(GL_INVALID_ENUM, face)
@@ -279,6 +281,7 @@ void glFrontFace(GLenum mode) {
 }
 
 void glViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+	flush_ffp_batch();
 #ifndef SKIP_ERROR_HANDLING
 	if ((width < 0) || (height < 0)) {
 		SET_GL_ERROR(GL_INVALID_VALUE)
@@ -296,7 +299,7 @@ void glViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
 	}
 #endif
 
-	setViewport(gxm_context, x_port, x_scale, y_port, y_scale, z_port, z_scale);
+	set_gxm_viewport(x_port, x_scale, y_port, y_scale, z_port, z_scale);
 	gl_viewport.x = x;
 	gl_viewport.y = y;
 	gl_viewport.w = width;
@@ -304,15 +307,17 @@ void glViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
 }
 
 void glDepthRange(GLdouble nearVal, GLdouble farVal) {
+	flush_ffp_batch();
 	z_port = (farVal + nearVal) / 2.0f;
 	z_scale = (farVal - nearVal) / 2.0f;
-	setViewport(gxm_context, x_port, x_scale, y_port, y_scale, z_port, z_scale);
+	set_gxm_viewport(x_port, x_scale, y_port, y_scale, z_port, z_scale);
 }
 
 void glDepthRangef(GLfloat nearVal, GLfloat farVal) {
+	flush_ffp_batch();
 	z_port = (farVal + nearVal) / 2.0f;
 	z_scale = (farVal - nearVal) / 2.0f;
-	setViewport(gxm_context, x_port, x_scale, y_port, y_scale, z_port, z_scale);
+	set_gxm_viewport(x_port, x_scale, y_port, y_scale, z_port, z_scale);
 }
 
 void glEnable(GLenum cap) {
@@ -549,6 +554,7 @@ void glDisable(GLenum cap) {
 }
 
 void glClear(GLbitfield mask) {
+	flush_ffp_batch();
 #ifndef SKIP_ERROR_HANDLING
 	if (mask & ~(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT)) {
 		SET_GL_ERROR(GL_INVALID_VALUE);
@@ -559,7 +565,7 @@ void glClear(GLbitfield mask) {
 
 	// Invalidating viewport and culling
 	invalidate_viewport();
-	sceGxmSetCullMode(gxm_context, SCE_GXM_CULL_NONE);
+	set_gxm_cull_mode(SCE_GXM_CULL_NONE);
 
 	void *fbuffer, *vbuffer;
 
@@ -571,11 +577,9 @@ void glClear(GLbitfield mask) {
 	// Enable disable depth write if both depth mask is true and the depth buffer bit is active.
 	change_depth_write(depth_mask_state && (mask & GL_DEPTH_BUFFER_BIT) ? SCE_GXM_DEPTH_WRITE_ENABLED : SCE_GXM_DEPTH_WRITE_DISABLED);
 
-	sceGxmSetFrontDepthBias(gxm_context, 0, 0);
-	sceGxmSetBackDepthBias(gxm_context, 0, 0);
+	set_gxm_depth_bias(GXM_SIDES_BOTH, 0, 0);
 
-	sceGxmSetFrontPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_TRIANGLE_FILL);
-	sceGxmSetBackPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_TRIANGLE_FILL);
+	set_gxm_polygon_mode(GXM_SIDES_BOTH, SCE_GXM_POLYGON_MODE_TRIANGLE_FILL);
 
 	sceGxmSetVertexProgram(gxm_context, clear_vertex_program_patched);
 	if (is_fbo_float)
@@ -590,37 +594,30 @@ void glClear(GLbitfield mask) {
 	sceGxmReserveFragmentDefaultUniformBuffer(gxm_context, &fbuffer);
 	sceGxmSetUniformDataF(fbuffer, clear_color, 0, 4, &clear_rgba_val.r);
 
-	sceGxmSetFrontStencilFunc(gxm_context,
+	set_gxm_stencil_func(GXM_SIDE_FRONT,
 		SCE_GXM_STENCIL_FUNC_ALWAYS,
 		SCE_GXM_STENCIL_OP_REPLACE,
 		SCE_GXM_STENCIL_OP_REPLACE,
 		SCE_GXM_STENCIL_OP_REPLACE,
 		0XFF, stencil_mask_front_write & 0xFF);
-	sceGxmSetFrontStencilRef(gxm_context, stencil_value & 0xFF);
+	set_gxm_stencil_ref(GXM_SIDE_FRONT, stencil_value & 0xFF);
 
-	sceGxmSetBackStencilFunc(gxm_context,
+	set_gxm_stencil_func(GXM_SIDE_BACK,
 		SCE_GXM_STENCIL_FUNC_ALWAYS,
 		SCE_GXM_STENCIL_OP_REPLACE,
 		SCE_GXM_STENCIL_OP_REPLACE,
 		SCE_GXM_STENCIL_OP_REPLACE,
 		0xFF, stencil_mask_back_write & 0xFF);
-	sceGxmSetBackStencilRef(gxm_context, stencil_value & 0xFF);
+	set_gxm_stencil_ref(GXM_SIDE_BACK, stencil_value & 0xFF);
 
 	if (!(mask & GL_COLOR_BUFFER_BIT)) {
 		// Disable fragment program if not clearing color buffer. Depth and stencil clears are unaffected.
-		sceGxmSetFrontFragmentProgramEnable(gxm_context, SCE_GXM_FRAGMENT_PROGRAM_DISABLED);
-		sceGxmSetBackFragmentProgramEnable(gxm_context, SCE_GXM_FRAGMENT_PROGRAM_DISABLED);
+		set_gxm_fragment_program_enable(GXM_SIDES_BOTH, SCE_GXM_FRAGMENT_PROGRAM_DISABLED);
 	}
 
 	if (!(mask & GL_STENCIL_BUFFER_BIT)) {
 		// Set stencil functions to KEEP if not clearing stencil buffer.
-		sceGxmSetFrontStencilFunc(gxm_context,
-			SCE_GXM_STENCIL_FUNC_ALWAYS,
-			SCE_GXM_STENCIL_OP_KEEP,
-			SCE_GXM_STENCIL_OP_KEEP,
-			SCE_GXM_STENCIL_OP_KEEP,
-			0XFF, 0xFF);
-		sceGxmSetBackStencilFunc(gxm_context,
+		set_gxm_stencil_func(GXM_SIDES_BOTH,
 			SCE_GXM_STENCIL_FUNC_ALWAYS,
 			SCE_GXM_STENCIL_OP_KEEP,
 			SCE_GXM_STENCIL_OP_KEEP,
@@ -628,6 +625,7 @@ void glClear(GLbitfield mask) {
 			0xFF, 0xFF);
 	}
 
+	flush_gxm_state();
 	sceGxmDraw(gxm_context, SCE_GXM_PRIMITIVE_TRIANGLE_FAN, SCE_GXM_INDEX_FORMAT_U16, depth_clear_indices, 4);
 
 	validate_depth_test();
@@ -635,11 +633,10 @@ void glClear(GLbitfield mask) {
 
 	change_stencil_settings();
 
-	sceGxmSetFrontPolygonMode(gxm_context, polygon_mode_front);
-	sceGxmSetBackPolygonMode(gxm_context, polygon_mode_back);
+	set_gxm_polygon_mode(GXM_SIDE_FRONT, polygon_mode_front);
+	set_gxm_polygon_mode(GXM_SIDE_BACK, polygon_mode_back);
 
-	sceGxmSetFrontFragmentProgramEnable(gxm_context, SCE_GXM_FRAGMENT_PROGRAM_ENABLED);
-	sceGxmSetBackFragmentProgramEnable(gxm_context, SCE_GXM_FRAGMENT_PROGRAM_ENABLED);
+	set_gxm_fragment_program_enable(GXM_SIDES_BOTH, SCE_GXM_FRAGMENT_PROGRAM_ENABLED);
 
 	update_polygon_offset();
 
@@ -666,6 +663,7 @@ void glClearColorx(GLclampx red, GLclampx green, GLclampx blue, GLclampx alpha)
 }
 
 void glLineWidth(GLfloat width) {
+	flush_ffp_batch();
 #ifndef SKIP_ERROR_HANDLING
 	// Error handling
 	if (width <= 0.0f) {
@@ -681,8 +679,7 @@ void glLineWidth(GLfloat width) {
 		int_width = 1;
 
 	// Changing line width as requested
-	sceGxmSetFrontPointLineWidth(gxm_context, int_width);
-	sceGxmSetBackPointLineWidth(gxm_context, int_width);
+	set_gxm_point_line_width(GXM_SIDES_BOTH, int_width);
 }
 
 void glPointSize(GLfloat size) {
@@ -703,16 +700,16 @@ void glHint(GLenum target, GLenum mode) {
 	case GL_TEXTURE_COMPRESSION_HINT:
 		switch (mode) {
 		case GL_FASTEST:
-			fast_texture_compression = GL_TRUE;
+			texture_compression_quality = DXT_QUALITY_FAST;
 			recompress_non_native = GL_FALSE;
 			break;
 		case GL_DONT_CARE:
-			fast_texture_compression = GL_FALSE;
+			texture_compression_quality = DXT_QUALITY_NORMAL;
 			recompress_non_native = GL_FALSE;
 			break;
 		default:
 			recompress_non_native = GL_TRUE;
-			fast_texture_compression = GL_FALSE;
+			texture_compression_quality = DXT_QUALITY_HIGH;
 			break;
 		}
 		break;
@@ -781,7 +778,7 @@ void glPushAttrib(GLbitfield mask) {
 	}
 	if (mask & GL_HINT_BIT) {
 		setup->enabled_bits += (1 << HINT_BIT);
-		setup->fast_texture_compression = fast_texture_compression;
+		setup->texture_compression_quality = texture_compression_quality;
 		setup->recompress_non_native = recompress_non_native;
 	}
 	if (mask & GL_LINE_BIT) {
@@ -919,7 +916,7 @@ void glPopAttrib(void) {
 		update_fogging_state();
 	}
 	if (setup->enabled_bits & (1 << HINT_BIT)) {
-		fast_texture_compression = setup->fast_texture_compression;
+		texture_compression_quality = setup->texture_compression_quality;
 		recompress_non_native = setup->recompress_non_native;
 	}
 	if (setup->enabled_bits & (1 << LINE_BIT)) {
@@ -44,9 +44,7 @@
 #define DISPLAY_HEIGHT_DEF 544 // Default display height in pixels
 #define DISPLAY_MAX_BUFFER_COUNT 3 // Maximum amount of display buffers to use
 #define GXM_TEX_MAX_SIZE 4096 // Maximum width/height in pixels per texture
-#define FRAME_PURGE_LIST_SIZE 16384 // Number of elements a single frame can hold
-#define FRAME_PURGE_RENDERTARGETS_LIST_SIZE 128 // Number of rendertargets a single frame can hold
-#define FRAME_PURGE_FREQ 5 // Frequency in frames for garbage collection
+#define GC_MAX_PENDING_REQUESTS 5 // Maximum number of pending garbage collection requests
 #define BUFFERS_NUM 256 // Maximum amount of framebuffers objects usable
 #ifdef HAVE_HIGH_FFP_TEXUNITS
 #define FFP_VERTEX_ATTRIBS_NUM 9 // Number of attributes used in ffp shaders
@@ -59,7 +57,8 @@
 #define LEGACY_MT_VERTEX_STRIDE 26 // Vertex stride for GL1 immediate draw pipeline with multitexturing
 #define LEGACY_NT_VERTEX_STRIDE 22 // Vertex stride for GL1 immediate draw pipeline without texturing
 #define MAX_LIGHTS_NUM 8 // Maximum number of allowed light sources for ffp
-#define MAX_IDX_NUMBER 0xC000 // Maximum allowed number of indices per draw call for glDrawArrays
+#define MAX_IDX_NUMBER 0x10000 // Maximum allowed number of vertices per draw call for glDrawArrays
+#define DEFAULT_IDX_NUMBER 0x1000 // Number of vertices initially covered by the progressive indices buffers
 
 // Internal constants set in bootup phase
 extern int DISPLAY_WIDTH; // Display width in pixels
@@ -91,11 +90,30 @@ extern float DISPLAY_HEIGHT_FLOAT; // Display height in pixels (float)
 #include "vitaGL.h"
 
 #include "utils/atitc_utils.h"
+#include "utils/batch_utils.h"
+#include "utils/buffer_utils.h"
+#include "utils/compiler_utils.h"
+#include "utils/dlist_utils.h"
+#include "utils/dxt_utils.h"
 #include "utils/eac_utils.h"
 #include "utils/gpu_utils.h"
+#include "utils/gxm_state_utils.h"
 #include "utils/gxm_utils.h"
+#include "utils/immediate_utils.h"
+#include "utils/index_utils.h"
 #include "utils/math_utils.h"
 #include "utils/mem_utils.h"
+#include "utils/patch_cache_utils.h"
+#include "utils/pixel_utils.h"
+#include "utils/profiler_utils.h"
+#include "utils/purge_utils.h"
+#include "utils/shader_archive_utils.h"
+#include "utils/shader_cache_utils.h"
+#include "utils/stream_utils.h"
+#include "utils/tlsf_utils.h"
+#include "utils/trace_utils.h"
+#include "utils/transcode_utils.h"
+#include "utils/uniform_utils.h"
 
 #include "texture_callbacks.h"
 
@@ -130,30 +148,26 @@ extern GLboolean prim_is_non_native; // Flag for when a primitive not supported
 	switch (x) { \
 	case GL_POINTS: \
 		p = SCE_GXM_PRIMITIVE_POINTS; \
-		sceGxmSetFrontPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_POINT_01UV); \
-		sceGxmSetBackPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_POINT_01UV); \
+		set_gxm_polygon_mode(GXM_SIDES_BOTH, SCE_GXM_POLYGON_MODE_POINT_01UV); \
 		break; \
 	case GL_LINES: \
 		if (c % 2) \
 			return; \
 		p = SCE_GXM_PRIMITIVE_LINES; \
-		sceGxmSetFrontPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
-		sceGxmSetBackPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
+		set_gxm_polygon_mode(GXM_SIDES_BOTH, SCE_GXM_POLYGON_MODE_LINE); \
 		break; \
 	case GL_LINE_STRIP: \
 		if (c < 2) \
 			return; \
 		p = SCE_GXM_PRIMITIVE_LINES; \
-		sceGxmSetFrontPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
-		sceGxmSetBackPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
+		set_gxm_polygon_mode(GXM_SIDES_BOTH, SCE_GXM_POLYGON_MODE_LINE); \
 		prim_is_non_native = GL_TRUE; \
 		break; \
 	case GL_LINE_LOOP: \
 		if (c < 2) \
 			return; \
 		p = SCE_GXM_PRIMITIVE_LINES; \
-		sceGxmSetFrontPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
-		sceGxmSetBackPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
+		set_gxm_polygon_mode(GXM_SIDES_BOTH, SCE_GXM_POLYGON_MODE_LINE); \
 		prim_is_non_native = GL_TRUE; \
 		break; \
 	case GL_TRIANGLES: \
@@ -186,24 +200,20 @@ extern GLboolean prim_is_non_native; // Flag for when a primitive not supported
 	switch (x) { \
 	case GL_POINTS: \
 		p = SCE_GXM_PRIMITIVE_POINTS; \
-		sceGxmSetFrontPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_POINT_01UV); \
-		sceGxmSetBackPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_POINT_01UV); \
+		set_gxm_polygon_mode(GXM_SIDES_BOTH, SCE_GXM_POLYGON_MODE_POINT_01UV); \
 		break; \
 	case GL_LINES: \
 		p = SCE_GXM_PRIMITIVE_LINES; \
-		sceGxmSetFrontPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
-		sceGxmSetBackPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
+		set_gxm_polygon_mode(GXM_SIDES_BOTH, SCE_GXM_POLYGON_MODE_LINE); \
 		break; \
 	case GL_LINE_STRIP: \
 		p = SCE_GXM_PRIMITIVE_LINES; \
-		sceGxmSetFrontPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
-		sceGxmSetBackPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
+		set_gxm_polygon_mode(GXM_SIDES_BOTH, SCE_GXM_POLYGON_MODE_LINE); \
 		prim_is_non_native = GL_TRUE; \
 		break; \
 	case GL_LINE_LOOP: \
 		p = SCE_GXM_PRIMITIVE_LINES; \
-		sceGxmSetFrontPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
-		sceGxmSetBackPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
+		set_gxm_polygon_mode(GXM_SIDES_BOTH, SCE_GXM_POLYGON_MODE_LINE); \
 		prim_is_non_native = GL_TRUE; \
 		break; \
 	case GL_TRIANGLES: \
@@ -227,8 +237,8 @@ extern GLboolean prim_is_non_native; // Flag for when a primitive not supported
 // Restore Polygon mode after a draw call
 #define restore_polygon_mode(p) \
 	if (p == SCE_GXM_PRIMITIVE_LINES || p == SCE_GXM_PRIMITIVE_POINTS) { \
-		sceGxmSetFrontPolygonMode(gxm_context, polygon_mode_front); \
-		sceGxmSetBackPolygonMode(gxm_context, polygon_mode_back); \
+		set_gxm_polygon_mode(GXM_SIDE_FRONT, polygon_mode_front); \
+		set_gxm_polygon_mode(GXM_SIDE_BACK, polygon_mode_back); \
 	}
 
 // Error set funcs
@@ -259,8 +269,6 @@ extern GLboolean prim_is_non_native; // Flag for when a primitive not supported
 #define patchFragmentProgram sceGxmShaderPatcherCreateFragmentProgram
 #endif
 
-#define rebuild_frag_shader(x, y, z, w) patchFragmentProgram(gxm_shader_patcher, x, w, msaa_mode, &blend_info.info, z, y) // Creates a new patched fragment program with proper blend settings
-
 #ifdef HAVE_SOFTFP_ABI
 extern __attribute__((naked)) void sceGxmSetViewport_sfp(SceGxmContext *context, float xOffset, float xScale, float yOffset, float yScale, float zOffset, float zScale);
 #define setViewport sceGxmSetViewport_sfp
@@ -403,10 +411,17 @@ typedef struct {
 	void *ptr;
 	int32_t size;
 	vglMemType type;
-	GLboolean used;
 	GLboolean mapped;
+	uint32_t map_offset; // Offset in bytes of the mapped range
+	uint32_t map_length; // Size in bytes of the mapped range
+	GLbitfield map_access; // GL_MAP_* flags the buffer got mapped with
+	uint32_t data_id; // Content identifier, changes whenever buffer content may change
+	buffer_store store; // Storages the buffer content cycles through, ptr is the current one
 } gpubuffer;
 
+// Macro to tag the storage a draw reads with the scene it belongs to, so that it's known when the GPU is done with it
+#define mark_buffer_used(b) buffer_store_use(&(b)->store, get_pending_scene_seq())
+
 // 3D vertex for position + 4D vertex for RGBA color struct
 typedef struct {
 	vector3f position;
@@ -431,52 +446,24 @@ typedef union {
 	uint32_t raw;
 } blend_config;
 
-typedef enum {
-	// No arguments
-	DLIST_FUNC_VOID,
-	// 1 argument
-	DLIST_FUNC_U32,
-	// 2 arguments
-	DLIST_FUNC_I32_I32,
-	DLIST_FUNC_U32_U32,
-	DLIST_FUNC_U32_I32,
-	DLIST_FUNC_U32_F32,
-	DLIST_FUNC_F32_F32,
-	// 3 arguments
-	DLIST_FUNC_I32_I32_I32,
-	DLIST_FUNC_U32_I32_I32,
-	DLIST_FUNC_U32_U32_I32,
-	DLIST_FUNC_U32_I32_U32,
-	DLIST_FUNC_U32_U32_U32,
-	DLIST_FUNC_U32_F32_F32,
-	DLIST_FUNC_U32_U32_F32,
-	DLIST_FUNC_F32_F32_F32,
-	DLIST_FUNC_I16_I16_I16,
-	DLIST_FUNC_U8_U8_U8,
-	// 4 arguments
-	DLIST_FUNC_U32_U32_U32_U32,
-	DLIST_FUNC_I32_I32_I32_I32,
-	DLIST_FUNC_I32_U32_I32_U32,
-	DLIST_FUNC_U32_I32_U32_U32,
-	DLIST_FUNC_F32_F32_F32_F32,
-	DLIST_FUNC_U8_U8_U8_U8,
-} dlistFuncType;
-
-// Display list function call internal struct
-typedef struct {
-	void (*func)();
-	uint8_t args[24];
-	uint32_t type;
-	void *next;
-} list_chain;
-
 // Display list internal struct
 typedef struct {
 	GLboolean used;
-	list_chain *head;
-	list_chain *tail;
+	dlist_arena code;
+	uint8_t *baked; // Vertex buffer of the baked immediate mode primitives
 } display_list;
 
+// Immediate mode vertex layouts
+enum {
+	IMMEDIATE_LAYOUT_NT, // No texturing
+	IMMEDIATE_LAYOUT_TEX, // Single texture
+	IMMEDIATE_LAYOUT_MT, // Multitexturing
+	IMMEDIATE_LAYOUT_INVALID // Layout depending on lighting state
+};
+#define IMMEDIATE_LAYOUT_COLORS 0x10 // Flag for immediate mode vertices carrying a per-vertex color
+#define IMMEDIATE_LAYOUT_LIT 0x20 // Flag for immediate mode vertices carrying the whole material state
+#define IMMEDIATE_LAYOUT_BASE(x) ((x) & 0x0F)
+
 #include "shaders.h"
 
 // Internal stuffs
@@ -576,6 +563,7 @@ extern GLboolean has_razor_live; // Flag for live metrics support with sceRazor
 extern GLboolean is_shark_online; // Current vitaShaRK status
 extern GLboolean dirty_frag_unifs;
 extern GLboolean dirty_vert_unifs;
+extern GLboolean dirty_tint_unif; // Flag for when current color changed, kept apart since it only affects draws without per-vertex colors
 
 // Internal fixed function pipeline dirty flags and variables
 extern GLboolean ffp_dirty_frag;
@@ -592,6 +580,8 @@ extern int32_t compiler_fastmath;
 extern int32_t compiler_fastprecision;
 extern int32_t compiler_fastint;
 extern shark_opt compiler_opts;
+extern GLboolean async_shader_compiler;
+extern vglAsyncFallback async_fallback_mode;
 
 // sceGxm viewport setup (NOTE: origin is on center screen)
 extern float x_port;
@@ -614,15 +604,17 @@ extern GLenum vgl_error; // Error returned by glGetError
 extern SceGxmShaderPatcher *gxm_shader_patcher; // sceGxmShaderPatcher shader patcher instance
 extern SceGxmDepthStencilSurface gxm_depth_stencil_surface; // Depth/Stencil surfaces setup for sceGxm
 extern GLboolean system_app_mode; // Flag for system app mode usage
-extern void *frame_purge_list[FRAME_PURGE_FREQ][FRAME_PURGE_LIST_SIZE]; // Purge list for internal elements
-extern void *frame_rt_purge_list[FRAME_PURGE_FREQ][FRAME_PURGE_RENDERTARGETS_LIST_SIZE]; // Purge list for rendertargets
-extern int frame_purge_idx; // Index for currently populatable purge list
-extern int frame_elem_purge_idx; // Index for currently populatable purge list element
-extern int frame_rt_purge_idx; // Index for currently populatable purge list rendertarget
 extern GLboolean use_vram; // Flag for VRAM usage for allocations
 
+// Kinds of elements handled by the garbage collector
+enum {
+	PURGE_MEM,
+	PURGE_RENDERTARGET,
+	PURGE_KINDS_NUM
+};
+
 // Macro to mark a pointer or a rendertarget as dirty for garbage collection
-#define markAsDirty(x) frame_purge_list[frame_purge_idx][frame_elem_purge_idx++] = x
+#define markAsDirty(x) purge_queue_mark(PURGE_MEM, x)
 #ifdef HAVE_SHARED_RENDERTARGETS
 typedef struct {
 	SceGxmRenderTarget *rt;
@@ -632,10 +624,10 @@ typedef struct {
 	int max_refs;
 } render_target;
 void __markRtAsDirty(render_target *rt);
-#define _markRtAsDirty(x) frame_rt_purge_list[frame_purge_idx][frame_rt_purge_idx++] = x
+#define _markRtAsDirty(x) purge_queue_mark(PURGE_RENDERTARGET, x)
 #define markRtAsDirty(x) __markRtAsDirty((render_target *)x)
 #else
-#define markRtAsDirty(x) frame_rt_purge_list[frame_purge_idx][frame_rt_purge_idx++] = x
+#define markRtAsDirty(x) purge_queue_mark(PURGE_RENDERTARGET, x)
 #endif
 
 // Blending
@@ -793,7 +785,7 @@ extern SceGxmVertexProgram *clear_vertex_program_patched; // Patched vertex prog
 extern SceGxmFragmentProgram *clear_fragment_program_float_patched; // Patched fragment program for clearing screen on float fbos
 extern vector4f *clear_vertices; // Memblock starting address for clear screen vertices
 
-extern GLboolean fast_texture_compression; // Hints for texture compression
+extern dxt_quality texture_compression_quality; // Quality level for runtime texture compression
 extern GLboolean recompress_non_native;
 extern GLfloat point_size; // Size of points for fixed function pipeline
 
@@ -812,7 +804,16 @@ void startShaderPatcher(void); // Creates a shader patcher instance
 void stopShaderPatcher(void); // Destroys a shader patcher instance
 void waitRenderingDone(void); // Waits for rendering to be finished
 void sceneReset(void); // Resets drawing scene if required
+uint32_t get_pending_scene_seq(void); // Returns the sequence number the scene being recorded will be signaled with
+uint32_t get_completed_scene_seq(void); // Returns the sequence number of the last scene completed by the GPU
 GLboolean startShaderCompiler(void); // Starts a shader compiler instance
+void patch_vertex_program_cached(patch_cache *c, SceGxmShaderPatcherId id, const SceGxmVertexAttribute *attrs, uint32_t attrs_num, const SceGxmVertexStream *streams, uint32_t streams_num, SceGxmVertexProgram **prog); // Gets a patched vertex program for the given layout, creating it if not cached
+void patch_fragment_program_cached(patch_cache *c, SceGxmShaderPatcherId id, SceGxmOutputRegisterFormat fmt, const SceGxmProgram *vertex_link, SceGxmFragmentProgram **prog); // Gets a patched fragment program for current blend settings, creating it if not cached
+void release_linked_fragment_programs(patch_cache *c, const SceGxmProgram *vertex_link); // Releases patched fragment programs linked to the given vertex program
+void release_patched_programs(patch_cache *vert_cache, patch_cache *frag_cache); // Releases all patched programs held by the given caches
+
+/* draw.c */
+void invalidate_converted_indices(uint32_t data_id, uint32_t offset, uint32_t size); // Drops converted indices sourced from the given bytes range of a buffer content
 
 /* tests.c */
 void change_depth_write(SceGxmDepthWriteMode mode); // Changes current in use depth write mode
@@ -831,23 +832,52 @@ void validate_viewport(void); // Restores previously invalidated viewport
 /* blending.c (TODO) */
 void change_blend_factor(void); // Changes current blending settings for all used shaders
 void change_blend_mask(void); // Changes color mask when blending is disabled for all used shaders
+GLenum gxm_blend_to_gl(SceGxmBlendFactor factor); // Converts a sceGxm blend factor to its GL equivalent
+
+/* capture.c */
+#ifdef HAVE_GL_CAPTURE
+void *capture_get_proc(void *proc); // Returns the capturing wrapper of a GL proc
+void capture_init(int pool_size, int width, int height, int ram_pool_size, int cdram_pool_size, int phycont_pool_size, int cdlg_pool_size, SceGxmMultisampleMode msaa); // Records vitaGL initialization into current capture
+void capture_frame(GLboolean has_commondialog); // Records a frame end into current capture
+#endif
 
 /* custom_shaders.c */
 void resetCustomShaders(void); // Resets custom shaders
 void _vglDrawObjects_CustomShadersIMPL(GLboolean implicit_wvp); // vglDrawObjects implementation for rendering with custom shaders
+void stop_async_shader_compiler(GLboolean resolve); // Terminates the background shader compiler, pending compilations are either completed and registered or dropped
 GLboolean _glDrawElements_CustomShadersIMPL(uint16_t *idx_buf, GLsizei count, GLboolean is_short); // glDrawElements implementation for rendering with custom shaders
 GLboolean _glDrawArrays_CustomShadersIMPL(GLsizei count); // glDrawArrays implementation for rendering with custom shaders
 
 /* ffp.c */
-void _glDrawElements_FixedFunctionIMPL(uint16_t *idx_buf, GLsizei count, GLboolean is_short); // glDrawElements implementation for rendering with ffp
-void _glDrawArrays_FixedFunctionIMPL(GLsizei count); // glDrawArrays implementation for rendering with ffp
-uint8_t reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *streams); // Reloads current in use ffp shaders
+GLboolean _glDrawElements_FixedFunctionIMPL(uint16_t *idx_buf, GLsizei count, GLboolean is_short); // glDrawElements implementation for rendering with ffp
+GLboolean _glDrawArrays_FixedFunctionIMPL(GLsizei count); // glDrawArrays implementation for rendering with ffp
+uint8_t reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *streams); // Reloads current in use ffp shaders (returns 0 if no shader is available for drawing)
 void upload_ffp_uniforms(); // Uploads required uniforms for the in use ffp shaders
 void update_fogging_state(); // Updates current setup for fogging
+void init_ffp_shader_cache(); // Allocates RAM cache for ffp shaders
+void term_ffp_shader_cache(); // Releases RAM cache for ffp shaders and every shader in it
+void init_ffp_shader_archive(); // Opens filesystem cache for ffp shaders
+void ffp_draw_immediate(const void *vertices, GLenum mode, uint32_t count, uint32_t layout); // Draws immediate mode vertices laid out with the given layout
+uint32_t ffp_get_immediate_stride(uint32_t layout); // Returns the size in floats of an immediate mode vertex with the given layout
+uint32_t ffp_get_immediate_layout(void); // Returns the immediate mode vertex layout for current state
+void ffp_capture_immediate_begin(float *dst); // Redirects immediate mode vertices to the given buffer without altering current state
+uint32_t ffp_capture_immediate_end(void); // Restores immediate mode state and returns the number of captured vertices
+extern GLboolean ffp_batch_pending; // Whether some ffp draws are waiting to be issued as a single batch
+void ffp_batch_flush(void); // Issues the pending ffp batch
+#ifdef HAVE_FFP_BATCHING
+GLboolean ffp_batch_draw_arrays(GLenum mode, GLint first, GLsizei count); // Merges a ffp glDrawArrays call into current batch (returns GL_FALSE if the draw can't be batched)
+#endif
+#define flush_ffp_batch() \
+	if (ffp_batch_pending) { \
+		ffp_batch_flush(); \
+	}
 
 /* misc.c */
 void change_cull_mode(void); // Updates current cull mode
 
+/* vertex_buffers.c */
+void get_index_range(const void *idx_buf, GLsizei count, GLboolean is_short, uint32_t *min, uint32_t *max); // Gets lowest and highest values of an indices array
+
 /* misc functions */
 void vector4f_convert_to_local_space(vector4f *out, int x, int y, int width, int height); // Converts screen coords to local space
 
@@ -859,5 +889,6 @@ void vgl_debugger_light_draw(uint32_t *fb); // Draws CPU rendered debugger windo
 /* vitaGL.c */
 uint8_t *reserve_data_pool(uint32_t size);
 void reset_vertex_data_pool();
+void reserve_default_indices(uint32_t count); // Grows progressive indices buffers so that they cover at least the given number of vertices
 
 #endif
@@ -63,15 +63,15 @@ int alpha_op = ALWAYS; // Current in use alpha test operation
 GLboolean alpha_test_state = GL_FALSE; // Current state for GL_ALPHA_TEST
 
 void change_depth_write(SceGxmDepthWriteMode mode) {
+	flush_ffp_batch();
 	// Change depth write mode for both front and back primitives
-	sceGxmSetFrontDepthWriteEnable(gxm_context, mode);
-	sceGxmSetBackDepthWriteEnable(gxm_context, mode);
+	set_gxm_depth_write_enable(GXM_SIDES_BOTH, mode);
 }
 
 void change_depth_func() {
+	flush_ffp_batch();
 	// Setting depth function for both front and back primitives
-	sceGxmSetFrontDepthFunc(gxm_context, depth_test_state ? depth_func : SCE_GXM_DEPTH_FUNC_ALWAYS);
-	sceGxmSetBackDepthFunc(gxm_context, depth_test_state ? depth_func : SCE_GXM_DEPTH_FUNC_ALWAYS);
+	set_gxm_depth_func(GXM_SIDES_BOTH, depth_test_state ? depth_func : SCE_GXM_DEPTH_FUNC_ALWAYS);
 
 	// Calling an update for the depth write mode
 	change_depth_write(depth_mask_state ? SCE_GXM_DEPTH_WRITE_ENABLED : SCE_GXM_DEPTH_WRITE_DISABLED);
@@ -95,25 +95,28 @@ void validate_depth_test() {
 }
 
 void invalidate_viewport() {
+	flush_ffp_batch();
 	// Invalidating current viewport
-	setViewport(gxm_context, fullscreen_x_port, fullscreen_x_scale, fullscreen_y_port, fullscreen_y_scale, fullscreen_z_port, fullscreen_z_scale);
+	set_gxm_viewport(fullscreen_x_port, fullscreen_x_scale, fullscreen_y_port, fullscreen_y_scale, fullscreen_z_port, fullscreen_z_scale);
 }
 
 void validate_viewport() {
+	flush_ffp_batch();
 	// Restoring original viewport
-	setViewport(gxm_context, x_port, x_scale, y_port, y_scale, z_port, z_scale);
+	set_gxm_viewport(x_port, x_scale, y_port, y_scale, z_port, z_scale);
 }
 
 void change_stencil_settings() {
+	flush_ffp_batch();
 	if (stencil_test_state) {
 		// Setting stencil function for both front and back primitives
-		sceGxmSetFrontStencilFunc(gxm_context,
+		set_gxm_stencil_func(GXM_SIDE_FRONT,
 			stencil_func_front,
 			stencil_fail_front,
 			depth_fail_front,
 			depth_pass_front,
 			stencil_mask_front, stencil_mask_front_write);
-		sceGxmSetBackStencilFunc(gxm_context,
+		set_gxm_stencil_func(GXM_SIDE_BACK,
 			stencil_func_back,
 			stencil_fail_back,
 			depth_fail_back,
@@ -121,17 +124,11 @@ void change_stencil_settings() {
 			stencil_mask_back, stencil_mask_back_write);
 
 		// Setting stencil ref for both front and back primitives
-		sceGxmSetFrontStencilRef(gxm_context, stencil_ref_front);
-		sceGxmSetBackStencilRef(gxm_context, stencil_ref_back);
+		set_gxm_stencil_ref(GXM_SIDE_FRONT, stencil_ref_front);
+		set_gxm_stencil_ref(GXM_SIDE_BACK, stencil_ref_back);
 
 	} else {
-		sceGxmSetFrontStencilFunc(gxm_context,
-			SCE_GXM_STENCIL_FUNC_ALWAYS,
-			SCE_GXM_STENCIL_OP_KEEP,
-			SCE_GXM_STENCIL_OP_KEEP,
-			SCE_GXM_STENCIL_OP_KEEP,
-			0, 0);
-		sceGxmSetBackStencilFunc(gxm_context,
+		set_gxm_stencil_func(GXM_SIDES_BOTH,
 			SCE_GXM_STENCIL_FUNC_ALWAYS,
 			SCE_GXM_STENCIL_OP_KEEP,
 			SCE_GXM_STENCIL_OP_KEEP,
@@ -245,6 +242,7 @@ void update_alpha_test_settings() {
 }
 
 void update_scissor_test() {
+	flush_ffp_batch();
 	const float scissor_depth = 1.0f;
 
 	// Setting current vertex program to clear screen one and fragment program to scissor test one
@@ -255,10 +253,10 @@ void update_scissor_test() {
 	invalidate_viewport();
 
 	// Invalidating culling
-	sceGxmSetCullMode(gxm_context, SCE_GXM_CULL_NONE);
+	set_gxm_cull_mode(SCE_GXM_CULL_NONE);
 
 	// Invalidating internal tile based region clip
-	sceGxmSetRegionClip(gxm_context, SCE_GXM_REGION_CLIP_OUTSIDE, 0, 0, is_rendering_display ? DISPLAY_WIDTH : in_use_framebuffer->width - 1, is_rendering_display ? DISPLAY_HEIGHT : in_use_framebuffer->height - 1);
+	set_gxm_region_clip(SCE_GXM_REGION_CLIP_OUTSIDE, 0, 0, is_rendering_display ? DISPLAY_WIDTH : in_use_framebuffer->width - 1, is_rendering_display ? DISPLAY_HEIGHT : in_use_framebuffer->height - 1);
 
 	if (scissor_test_state) {
 		// Calculating scissor test region vertices
@@ -270,29 +268,18 @@ void update_scissor_test() {
 		sceGxmSetUniformDataF(vertex_buffer, clear_depth, 0, 1, &scissor_depth);
 
 		// Cleaning stencil surface mask update bit on the whole screen
-		sceGxmSetFrontStencilFunc(gxm_context,
-			SCE_GXM_STENCIL_FUNC_NEVER,
-			SCE_GXM_STENCIL_OP_KEEP,
-			SCE_GXM_STENCIL_OP_KEEP,
-			SCE_GXM_STENCIL_OP_KEEP,
-			0, 0);
-		sceGxmSetBackStencilFunc(gxm_context,
+		set_gxm_stencil_func(GXM_SIDES_BOTH,
 			SCE_GXM_STENCIL_FUNC_NEVER,
 			SCE_GXM_STENCIL_OP_KEEP,
 			SCE_GXM_STENCIL_OP_KEEP,
 			SCE_GXM_STENCIL_OP_KEEP,
 			0, 0);
+		flush_gxm_state();
 		sceGxmDraw(gxm_context, SCE_GXM_PRIMITIVE_TRIANGLE_FAN, SCE_GXM_INDEX_FORMAT_U16, depth_clear_indices, 4);
 	}
 
 	// Setting stencil surface mask update bit on the scissor test region
-	sceGxmSetFrontStencilFunc(gxm_context,
-		SCE_GXM_STENCIL_FUNC_ALWAYS,
-		SCE_GXM_STENCIL_OP_KEEP,
-		SCE_GXM_STENCIL_OP_KEEP,
-		SCE_GXM_STENCIL_OP_KEEP,
-		0, 0);
-	sceGxmSetBackStencilFunc(gxm_context,
+	set_gxm_stencil_func(GXM_SIDES_BOTH,
 		SCE_GXM_STENCIL_FUNC_ALWAYS,
 		SCE_GXM_STENCIL_OP_KEEP,
 		SCE_GXM_STENCIL_OP_KEEP,
@@ -307,6 +294,7 @@ void update_scissor_test() {
 		sceGxmSetUniformDataF(vertex_buffer, clear_position, 0, 4, &clear_vertices->x);
 	sceGxmSetUniformDataF(vertex_buffer, clear_depth, 0, 1, &scissor_depth);
 
+	flush_gxm_state();
 	sceGxmDraw(gxm_context, SCE_GXM_PRIMITIVE_TRIANGLE_FAN, SCE_GXM_INDEX_FORMAT_U16, depth_clear_indices, 4);
 
 	// Restoring viewport
@@ -317,7 +305,7 @@ void update_scissor_test() {
 
 	// Reducing GPU workload by performing tile granularity clipping
 	if (scissor_test_state)
-		sceGxmSetRegionClip(gxm_context, SCE_GXM_REGION_CLIP_OUTSIDE, region.x, region.y, region.x + region.w - 1, region.y + region.h - 1);
+		set_gxm_region_clip(SCE_GXM_REGION_CLIP_OUTSIDE, region.x, region.y, region.x + region.w - 1, region.y + region.h - 1);
 
 	// Restoring original stencil test settings
 	change_stencil_settings();
@@ -339,6 +327,7 @@ void resetScissorTestRegion(void) {
  */
 
 void glScissor(GLint x, GLint y, GLsizei width, GLsizei height) {
+	flush_ffp_batch();
 #ifndef SKIP_ERROR_HANDLING
 	// Error handling
 	if ((width < 0) || (height < 0)) {
@@ -51,7 +51,7 @@ uint32_t readRGBA5551(void *data) {
 	uint8_t r, g, b, a;
 	uint8_t *dst = (uint8_t *)&clr;
 	uint8_t *src = (uint8_t *)data;
-	dst[0] = src[2];
+	dst[0] = src[0];
 	dst[1] = src[1];
 	r = convert_u16_to_u32_cspace(clr, 0, 11, 0x1F);
 	g = convert_u16_to_u32_cspace(clr, 5, 11, 0x1F);
@@ -66,7 +66,7 @@ uint32_t readRGBA4444(void *data) {
 	uint8_t r, g, b, a;
 	uint8_t *dst = (uint8_t *)&clr;
 	uint8_t *src = (uint8_t *)data;
-	dst[0] = src[2];
+	dst[0] = src[0];
 	dst[1] = src[1];
 	r = convert_u16_to_u32_cspace(clr, 0, 12, 0x0F);
 	g = convert_u16_to_u32_cspace(clr, 4, 12, 0x0F);
@@ -81,7 +81,7 @@ uint32_t readRGB565(void *data) {
 	uint8_t r, g, b;
 	uint8_t *dst = (uint8_t *)&clr;
 	uint8_t *src = (uint8_t *)data;
-	dst[0] = src[2];
+	dst[0] = src[0];
 	dst[1] = src[1];
 	r = convert_u16_to_u32_cspace(clr, 0, 11, 0x1F);
 	g = convert_u16_to_u32_cspace(clr, 5, 10, 0x3F);
@@ -196,3 +196,57 @@ void writeR(void *data, uint32_t color) {
 	uint8_t *src = (uint8_t *)&color;
 	dst[0] = src[0];
 }
+
+// Maps a read callback to the pixel format it decodes
+static pixel_fmt getReadFormat(uint32_t (*read_cb)(void *)) {
+	if (read_cb == readRGBA)
+		return PIXEL_FMT_RGBA8;
+	if (read_cb == readBGRA)
+		return PIXEL_FMT_BGRA8;
+	if (read_cb == readABGR)
+		return PIXEL_FMT_ABGR8;
+	if (read_cb == readRGB)
+		return PIXEL_FMT_RGB8;
+	if (read_cb == readBGR)
+		return PIXEL_FMT_BGR8;
+	if (read_cb == readRG)
+		return PIXEL_FMT_RG8;
+	if (read_cb == readR)
+		return PIXEL_FMT_R8;
+	if (read_cb == readL)
+		return PIXEL_FMT_L8;
+	if (read_cb == readLA)
+		return PIXEL_FMT_LA8;
+	if (read_cb == readRGB565)
+		return PIXEL_FMT_RGB565;
+	if (read_cb == readRGBA5551)
+		return PIXEL_FMT_RGBA5551;
+	if (read_cb == readRGBA4444)
+		return PIXEL_FMT_RGBA4444;
+	return PIXEL_FMT_INVALID;
+}
+
+// Maps a write callback to the pixel format it encodes
+static pixel_fmt getWriteFormat(void (*write_cb)(void *, uint32_t)) {
+	if (write_cb == writeRGBA)
+		return PIXEL_FMT_RGBA8;
+	if (write_cb == writeBGRA)
+		return PIXEL_FMT_BGRA8;
+	if (write_cb == writeABGR)
+		return PIXEL_FMT_ABGR8;
+	if (write_cb == writeRGB)
+		return PIXEL_FMT_RGB8;
+	if (write_cb == writeBGR)
+		return PIXEL_FMT_BGR8;
+	if (write_cb == writeRG)
+		return PIXEL_FMT_RG8;
+	if (write_cb == writeR)
+		return PIXEL_FMT_R8;
+	if (write_cb == writeRA)
+		return PIXEL_FMT_LA8;
+	return PIXEL_FMT_INVALID;
+}
+
+pixel_row_cb getRowConverter(uint32_t (*read_cb)(void *), void (*write_cb)(void *, uint32_t)) {
+	return get_pixel_row_converter(getReadFormat(read_cb), getWriteFormat(write_cb));
+}
@@ -48,4 +48,7 @@ void writeRGBA(void *data, uint32_t color);
 void writeABGR(void *data, uint32_t color);
 void writeBGRA(void *data, uint32_t color);
 
+// Returns a row converter equivalent to the given callbacks pair (NULL if none is available)
+pixel_row_cb getRowConverter(uint32_t (*read_cb)(void *), void (*write_cb)(void *, uint32_t));
+
 #endif
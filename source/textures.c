@@ -397,11 +397,11 @@ void _glTexImage2D_FlatIMPL(texture *tex, GLint level, GLint internalFormat, GLs
 		if (tex->write_cb)
 			gpu_alloc_texture(width, height, tex_format, data, tex, data_bpp, read_cb, tex->write_cb, fast_store);
 		else
-			gpu_alloc_compressed_texture(level, width, height, tex_format, 0, data, tex, data_bpp, read_cb);
+			gpu_alloc_compressed_texture(level, width, height, tex_format, 0, data, tex, data_bpp, read_cb, TRANSCODE_NONE);
 	else if (tex->write_cb)
 		gpu_alloc_mipmaps(level, tex);
 	else
-		gpu_alloc_compressed_texture(level, width, height, tex_format, 0, data, tex, data_bpp, read_cb);
+		gpu_alloc_compressed_texture(level, width, height, tex_format, 0, data, tex, data_bpp, read_cb, TRANSCODE_NONE);
 
 	// Setting texture parameters
 	vglSetTexUMode(&tex->gxm_tex, tex->u_mode);
@@ -774,15 +774,25 @@ void glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, G
 			}
 		} else { // Executing texture modification via callbacks
 			uint8_t *data = (uint8_t *)pixels;
-			for (i = 0; i < height; i++) {
-				for (j = 0; j < width; j++) {
-					uint32_t clr = read_cb((uint8_t *)data);
-					write_cb(ptr, clr);
-					data += data_bpp;
-					ptr += bpp;
+			pixel_row_cb convert_row = getRowConverter(read_cb, write_cb);
+			if (convert_row) {
+				uint32_t line_size = width * data_bpp;
+				for (i = 0; i < height; i++) {
+					convert_row(ptr_line, data, width);
+					data += line_size;
+					ptr_line += stride;
+				}
+			} else {
+				for (i = 0; i < height; i++) {
+					for (j = 0; j < width; j++) {
+						uint32_t clr = read_cb((uint8_t *)data);
+						write_cb(ptr, clr);
+						data += data_bpp;
+						ptr += bpp;
+					}
+					ptr = ptr_line + stride;
+					ptr_line = ptr;
 				}
-				ptr = ptr_line + stride;
-				ptr_line = ptr;
 			}
 		}
 
@@ -808,6 +818,7 @@ void glCompressedTexImage2D(GLenum target, GLint level, GLenum internalFormat, G
 	GLboolean gamma_correction = GL_FALSE;
 	GLboolean non_native_format = GL_FALSE;
 	GLboolean paletted_format = GL_FALSE;
+	transcode_fmt transcode = TRANSCODE_NONE;
 	void *decompressed_data;
 	uint8_t data_bpp;
 	uint32_t (*read_cb)(void *) = NULL;
@@ -925,48 +936,52 @@ void glCompressedTexImage2D(GLenum target, GLint level, GLenum internalFormat, G
 			tex_format = SCE_GXM_TEXTURE_FORMAT_ETC1_RGB;
 			break;
 		case GL_COMPRESSED_RGBA8_ETC2_EAC:
-			non_native_format = GL_TRUE;
-			decompressed_data = vglMalloc(width * height * 4);
-			eac_decode((uint8_t *)data, decompressed_data, width, height, EAC_ETC2);
 			if (recompress_non_native) {
-				read_cb = readRGBA;
+				transcode = TRANSCODE_ETC2_EAC;
 				tex_format = SCE_GXM_TEXTURE_FORMAT_UBC3_ABGR;
-			} else
+			} else {
+				non_native_format = GL_TRUE;
+				decompressed_data = vglMalloc(width * height * 4);
+				eac_decode((uint8_t *)data, decompressed_data, width, height, EAC_ETC2);
 				tex_format = SCE_GXM_TEXTURE_FORMAT_U8U8U8U8_ABGR;
-			data_bpp = 4;
+				data_bpp = 4;
+			}
 			break;
 		case GL_ATC_RGB_AMD:
-			non_native_format = GL_TRUE;
-			decompressed_data = vglMalloc(width * height * 4);
-			atitc_decode((uint8_t *)data, decompressed_data, width, height, ATC_RGB);
 			if (recompress_non_native) {
-				read_cb = readBGRA;
+				transcode = TRANSCODE_ATC_RGB;
 				tex_format = SCE_GXM_TEXTURE_FORMAT_UBC1_ABGR;
-			} else
+			} else {
+				non_native_format = GL_TRUE;
+				decompressed_data = vglMalloc(width * height * 4);
+				atitc_decode((uint8_t *)data, decompressed_data, width, height, ATC_RGB);
 				tex_format = SCE_GXM_TEXTURE_FORMAT_U8U8U8U8_ARGB;
-			data_bpp = 4;
+				data_bpp = 4;
+			}
 			break;
 		case GL_ATC_RGBA_EXPLICIT_ALPHA_AMD:
-			non_native_format = GL_TRUE;
-			decompressed_data = vglMalloc(width * height * 4);
-			atitc_decode((uint8_t *)data, decompressed_data, width, height, ATC_EXPLICIT_ALPHA);
 			if (recompress_non_native) {
-				read_cb = readBGRA;
-				tex_format = SCE_GXM_TEXTURE_FORMAT_UBC3_ABGR;
-			} else
+				transcode = TRANSCODE_ATC_EXPLICIT_ALPHA;
+				tex_format = SCE_GXM_TEXTURE_FORMAT_UBC2_ABGR;
+			} else {
+				non_native_format = GL_TRUE;
+				decompressed_data = vglMalloc(width * height * 4);
+				atitc_decode((uint8_t *)data, decompressed_data, width, height, ATC_EXPLICIT_ALPHA);
 				tex_format = SCE_GXM_TEXTURE_FORMAT_U8U8U8U8_ARGB;
-			data_bpp = 4;
+				data_bpp = 4;
+			}
 			break;
 		case GL_ATC_RGBA_INTERPOLATED_ALPHA_AMD:
-			non_native_format = GL_TRUE;
-			decompressed_data = vglMalloc(width * height * 4);
-			atitc_decode((uint8_t *)data, decompressed_data, width, height, ATC_INTERPOLATED_ALPHA);
 			if (recompress_non_native) {
-				read_cb = readBGRA;
+				transcode = TRANSCODE_ATC_INTERPOLATED_ALPHA;
 				tex_format = SCE_GXM_TEXTURE_FORMAT_UBC3_ABGR;
-			} else
+			} else {
+				non_native_format = GL_TRUE;
+				decompressed_data = vglMalloc(width * height * 4);
+				atitc_decode((uint8_t *)data, decompressed_data, width, height, ATC_INTERPOLATED_ALPHA);
 				tex_format = SCE_GXM_TEXTURE_FORMAT_U8U8U8U8_ARGB;
-			data_bpp = 4;
+				data_bpp = 4;
+			}
 			break;
 		default:
 			SET_GL_ERROR_WITH_VALUE(GL_INVALID_ENUM, internalFormat)
@@ -990,17 +1005,12 @@ void glCompressedTexImage2D(GLenum target, GLint level, GLenum internalFormat, G
 #endif
 			if (non_native_format) {
 				if (level == 0)
-					if (read_cb)
-						gpu_alloc_compressed_texture(level, width, height, tex_format, 0, decompressed_data, tex, data_bpp, read_cb);
-					else
-						gpu_alloc_texture(width, height, tex_format, decompressed_data, tex, data_bpp, NULL, NULL, GL_TRUE);
-				else if (read_cb)
-					gpu_alloc_compressed_texture(level, width, height, tex_format, 0, decompressed_data, tex, data_bpp, read_cb);
+					gpu_alloc_texture(width, height, tex_format, decompressed_data, tex, data_bpp, NULL, NULL, GL_TRUE);
 				else
 					gpu_alloc_mipmaps(level, tex);
 				vgl_free(decompressed_data);
 			} else
-				gpu_alloc_compressed_texture(level, width, height, tex_format, imageSize, data, tex, 0, NULL);
+				gpu_alloc_compressed_texture(level, width, height, tex_format, imageSize, data, tex, 0, NULL, transcode);
 		}
 		// Setting texture parameters
 		vglSetTexUMode(&tex->gxm_tex, tex->u_mode);
@@ -47,6 +47,8 @@ static void atitc_decode_block(uint8_t **blockData,
     /* the channel is r5g6b5 , 16 bits */
     rb0  = (colorValue0 << 3 | colorValue0 << 9) & 0xf800f8;
     rb1  = (colorValue1 << 3 | colorValue1 << 8) & 0xf800f8;
+    rb0 += (rb0 >> 5) & 0x070007;
+    rb1 += (rb1 >> 5) & 0x070007;
     g0   = (colorValue0 << 6) & 0x00fc00;
     g1   = (colorValue1 << 5) & 0x00fc00;
     g0  += (g0 >> 6) & 0x000300;
@@ -119,7 +121,7 @@ static void atitc_decode_block(uint8_t **blockData,
         {
             for (int x = 0; x < 4; ++x)
             {
-                decodeBlockData[x] = (alphaArray[alpha & 5] << 24) + colors[pixelsIndex & 3];
+                decodeBlockData[x] = (alphaArray[alpha & 7] << 24) + colors[pixelsIndex & 3];
                 pixelsIndex >>= 2;
                 alpha >>= 3;
             }
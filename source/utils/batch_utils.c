@@ -0,0 +1,209 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * batch_utils.c:
+ * Merging of consecutive draw calls sharing the same state into a single one
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "batch_utils.h"
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+#define REBASE_EPSILON 1e-5f // Tolerance used when checking if a rebased transform keeps 2D positions on the z = 0 plane
+
+void batch_init(draw_batch *b, uint32_t max_count) {
+	memset(b, 0, sizeof(draw_batch));
+	b->max_count = max_count;
+}
+
+void batch_term(draw_batch *b) {
+	for (int i = 0; i < BATCH_MAX_STREAMS; i++) {
+		free(b->streams[i].data);
+	}
+	memset(b, 0, sizeof(draw_batch));
+}
+
+int batch_begin(draw_batch *b, const void *key, uint32_t key_size, const uint32_t *strides, uint32_t streams_num, const float *base) {
+	if (key_size > BATCH_MAX_KEY_SIZE || streams_num > BATCH_MAX_STREAMS)
+		return 0;
+	memcpy(b->key, key, key_size);
+	b->key_size = key_size;
+	for (uint32_t i = 0; i < streams_num; i++) {
+		b->streams[i].stride = strides[i];
+	}
+	b->streams_num = streams_num;
+	memcpy(b->base, base, sizeof(b->base));
+	b->has_base_inv = 0;
+	b->count = 0;
+	b->draws = 0;
+	return 1;
+}
+
+int batch_match(draw_batch *b, const void *key, uint32_t key_size, uint32_t count) {
+	if (b->count + count > b->max_count || b->key_size != key_size)
+		return 0;
+	return !memcmp(b->key, key, key_size);
+}
+
+int batch_reserve(draw_batch *b, uint32_t count) {
+	for (uint32_t i = 0; i < b->streams_num; i++) {
+		batch_stream *s = &b->streams[i];
+		uint32_t needed = (b->count + count) * s->stride;
+		if (needed > s->size) {
+			uint32_t new_size = s->size ? s->size * 2 : BATCH_DEF_VERTICES * s->stride;
+			while (new_size < needed) {
+				new_size *= 2;
+			}
+			uint8_t *new_data = (uint8_t *)realloc(s->data, new_size);
+			if (!new_data)
+				return 0;
+			s->data = new_data;
+			s->size = new_size;
+		}
+	}
+	return 1;
+}
+
+void *batch_append(draw_batch *b, uint32_t stream, const void *src, uint32_t count) {
+	batch_stream *s = &b->streams[stream];
+	uint8_t *dst = s->data + b->count * s->stride;
+	memcpy(dst, src, count * s->stride);
+	return dst;
+}
+
+void batch_commit(draw_batch *b, uint32_t count) {
+	b->count += count;
+	b->draws++;
+	b->stats.draws_in++;
+	b->stats.vertices += count;
+}
+
+void batch_end(draw_batch *b) {
+	if (b->draws)
+		b->stats.draws_out++;
+	b->count = 0;
+	b->draws = 0;
+}
+
+static int is_affine(const float *m) {
+	return m[12] == 0.0f && m[13] == 0.0f && m[14] == 0.0f && m[15] == 1.0f;
+}
+
+static int invert_affine(float *out, const float *m) {
+	// Inverting the linear part through its cofactors, the translation is then moved back through it
+	float c00 = m[5] * m[10] - m[6] * m[9];
+	float c01 = m[6] * m[8] - m[4] * m[10];
+	float c02 = m[4] * m[9] - m[5] * m[8];
+	float det = m[0] * c00 + m[1] * c01 + m[2] * c02;
+	if (det == 0.0f)
+		return 0;
+	float inv_det = 1.0f / det;
+	out[0] = c00 * inv_det;
+	out[1] = (m[2] * m[9] - m[1] * m[10]) * inv_det;
+	out[2] = (m[1] * m[6] - m[2] * m[5]) * inv_det;
+	out[4] = c01 * inv_det;
+	out[5] = (m[0] * m[10] - m[2] * m[8]) * inv_det;
+	out[6] = (m[2] * m[4] - m[0] * m[6]) * inv_det;
+	out[8] = c02 * inv_det;
+	out[9] = (m[1] * m[8] - m[0] * m[9]) * inv_det;
+	out[10] = (m[0] * m[5] - m[1] * m[4]) * inv_det;
+	out[3] = -(out[0] * m[3] + out[1] * m[7] + out[2] * m[11]);
+	out[7] = -(out[4] * m[3] + out[5] * m[7] + out[6] * m[11]);
+	out[11] = -(out[8] * m[3] + out[9] * m[7] + out[10] * m[11]);
+	out[12] = out[13] = out[14] = 0.0f;
+	out[15] = 1.0f;
+	return 1;
+}
+
+int batch_rebase(draw_batch *b, const float *m, uint32_t comps, float *out) {
+	// Only affine transforms keep w untouched, so that positions can be stored with the same layout
+	if (!is_affine(m) || !is_affine(b->base))
+		return 0;
+	if (!b->has_base_inv) {
+		if (!invert_affine(b->base_inv, b->base))
+			return 0;
+		b->has_base_inv = 1;
+	}
+	const float *inv = b->base_inv;
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 4; j++) {
+			out[i * 4 + j] = inv[i * 4] * m[j] + inv[i * 4 + 1] * m[4 + j] + inv[i * 4 + 2] * m[8 + j] + (j == 3 ? inv[i * 4 + 3] : 0.0f);
+		}
+	}
+	out[12] = out[13] = out[14] = 0.0f;
+	out[15] = 1.0f;
+
+	// 2D positions have an implicit z = 0 that must be preserved
+	if (comps == 2 && (fabsf(out[8]) > REBASE_EPSILON || fabsf(out[9]) > REBASE_EPSILON || fabsf(out[11]) > REBASE_EPSILON))
+		return 0;
+	return 1;
+}
+
+void batch_transform_positions(void *data, uint32_t stride, uint32_t count, uint32_t comps, const float *m) {
+	uint8_t *p = (uint8_t *)data;
+#ifdef __ARM_NEON
+	// Columns of the transform, every position is the weighted sum of them
+	const float c0_[4] = {m[0], m[4], m[8], m[12]};
+	const float c1_[4] = {m[1], m[5], m[9], m[13]};
+	const float c2_[4] = {m[2], m[6], m[10], m[14]};
+	const float c3_[4] = {m[3], m[7], m[11], m[15]};
+	float32x4_t c0 = vld1q_f32(c0_);
+	float32x4_t c1 = vld1q_f32(c1_);
+	float32x4_t c2 = vld1q_f32(c2_);
+	float32x4_t c3 = vld1q_f32(c3_);
+	for (uint32_t i = 0; i < count; i++, p += stride) {
+		float *v = (float *)p;
+		float32x4_t r = comps == 4 ? vmulq_n_f32(c3, v[3]) : c3;
+		r = vmlaq_n_f32(r, c0, v[0]);
+		r = vmlaq_n_f32(r, c1, v[1]);
+		if (comps > 2)
+			r = vmlaq_n_f32(r, c2, v[2]);
+		switch (comps) {
+		case 2:
+			vst1_f32(v, vget_low_f32(r));
+			break;
+		case 3:
+			vst1_f32(v, vget_low_f32(r));
+			vst1q_lane_f32(&v[2], r, 2);
+			break;
+		default:
+			vst1q_f32(v, r);
+			break;
+		}
+	}
+#else
+	for (uint32_t i = 0; i < count; i++, p += stride) {
+		float *v = (float *)p;
+		float x = v[0], y = v[1];
+		float z = comps > 2 ? v[2] : 0.0f;
+		float w = comps > 3 ? v[3] : 1.0f;
+		v[0] = m[0] * x + m[1] * y + m[2] * z + m[3] * w;
+		v[1] = m[4] * x + m[5] * y + m[6] * z + m[7] * w;
+		if (comps > 2)
+			v[2] = m[8] * x + m[9] * y + m[10] * z + m[11] * w;
+		if (comps > 3)
+			v[3] = m[12] * x + m[13] * y + m[14] * z + m[15] * w;
+	}
+#endif
+}
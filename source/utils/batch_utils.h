@@ -0,0 +1,74 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * batch_utils.h:
+ * Header file for the draw calls batching utilities exposed by batch_utils.c
+ */
+
+#ifndef _BATCH_UTILS_H_
+#define _BATCH_UTILS_H_
+
+#include <stdint.h>
+
+#define BATCH_MAX_STREAMS 8 // Maximum number of vertex streams of a batch
+#define BATCH_MAX_KEY_SIZE 512 // Maximum size in bytes of the state key of a batch
+#define BATCH_DEF_VERTICES 1024 // Number of vertices a batch stream can initially hold
+
+// Vertex stream of a batch, vertices of merged draws are stored one after the other
+typedef struct {
+	uint8_t *data;
+	uint32_t stride;
+	uint32_t size; // Capacity in bytes
+} batch_stream;
+
+// Batching counters
+typedef struct {
+	uint32_t draws_in; // Number of draws submitted to batches
+	uint32_t draws_out; // Number of draws issued by flushing batches
+	uint32_t vertices; // Number of vertices merged into batches
+	uint32_t vertices_transformed; // Number of vertices moved into the batch space on the CPU
+} batch_stats;
+
+// Set of consecutive draws sharing the same state
+typedef struct {
+	batch_stream streams[BATCH_MAX_STREAMS];
+	uint32_t streams_num;
+	uint32_t count; // Number of vertices of the merged draws
+	uint32_t draws; // Number of merged draws
+	uint32_t max_count; // Maximum number of vertices of a batch
+	uint8_t key[BATCH_MAX_KEY_SIZE]; // State the merged draws share
+	uint32_t key_size;
+	float base[16]; // Row major transform of the first merged draw
+	float base_inv[16]; // Inverse of base, valid only if has_base_inv is set
+	uint8_t has_base_inv;
+	batch_stats stats;
+} draw_batch;
+
+void batch_init(draw_batch *b, uint32_t max_count);
+void batch_term(draw_batch *b);
+int batch_begin(draw_batch *b, const void *key, uint32_t key_size, const uint32_t *strides, uint32_t streams_num, const float *base);
+int batch_match(draw_batch *b, const void *key, uint32_t key_size, uint32_t count);
+int batch_reserve(draw_batch *b, uint32_t count);
+void *batch_append(draw_batch *b, uint32_t stream, const void *src, uint32_t count);
+void batch_commit(draw_batch *b, uint32_t count);
+void batch_end(draw_batch *b);
+int batch_rebase(draw_batch *b, const float *m, uint32_t comps, float *out);
+void batch_transform_positions(void *data, uint32_t stride, uint32_t count, uint32_t comps, const float *m);
+
+#endif
@@ -0,0 +1,241 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * buffer_utils.c:
+ * Versioned storage for buffers updated while the GPU may still be reading them
+ */
+
+#include <string.h>
+#include "buffer_utils.h"
+
+static inline int is_version_busy(const buffer_version *v, uint32_t completed_seq) {
+	return !buffer_seq_reached(v->seq, completed_seq);
+}
+
+static void mark_version_stale(buffer_version *v, uint32_t start, uint32_t end) {
+	if (start >= end)
+		return;
+
+	// Merging the range with the ones it overlaps or touches
+	uint32_t i = 0;
+	while (i < v->stale_num && v->stale[i].end < start)
+		i++;
+	uint32_t j = i;
+	while (j < v->stale_num && v->stale[j].start <= end) {
+		if (v->stale[j].start < start)
+			start = v->stale[j].start;
+		if (v->stale[j].end > end)
+			end = v->stale[j].end;
+		j++;
+	}
+	if (j > i) {
+		v->stale[i].start = start;
+		v->stale[i].end = end;
+		memmove(&v->stale[i + 1], &v->stale[j], (v->stale_num - j) * sizeof(buffer_range));
+		v->stale_num -= j - i - 1;
+		return;
+	}
+
+	// Merging the two closest ranges if there's no room for a new one
+	if (v->stale_num == BUFFER_MAX_STALE_RANGES) {
+		uint32_t best = 0;
+		uint32_t best_gap = 0xFFFFFFFF;
+		for (uint32_t k = 0; k + 1 < v->stale_num; k++) {
+			uint32_t gap = v->stale[k + 1].start - v->stale[k].end;
+			if (gap < best_gap) {
+				best = k;
+				best_gap = gap;
+			}
+		}
+		v->stale[best].end = v->stale[best + 1].end;
+		memmove(&v->stale[best + 1], &v->stale[best + 2], (v->stale_num - best - 2) * sizeof(buffer_range));
+		v->stale_num--;
+		mark_version_stale(v, start, end);
+		return;
+	}
+	memmove(&v->stale[i + 1], &v->stale[i], (v->stale_num - i) * sizeof(buffer_range));
+	v->stale[i].start = start;
+	v->stale[i].end = end;
+	v->stale_num++;
+}
+
+static void mark_others_stale(buffer_store *s, uint32_t start, uint32_t end) {
+	for (uint32_t i = 0; i < s->num; i++) {
+		if (i != s->cur)
+			mark_version_stale(&s->versions[i], start, end);
+	}
+}
+
+static void init_version(buffer_version *v, void *ptr, uint32_t size, uint32_t completed_seq) {
+	v->ptr = ptr;
+	v->seq = completed_seq;
+	v->stale_num = 0;
+	mark_version_stale(v, 0, size);
+}
+
+static int acquire_version(buffer_store *s, const buffer_allocator *a, uint32_t completed_seq, buffer_stats *stats) {
+	// Current storage can be written straight if the GPU is done with it
+	if (!is_version_busy(&s->versions[s->cur], completed_seq))
+		return s->cur;
+
+	// Recycling the idle storage requiring the smallest update
+	int res = -1;
+	uint32_t res_cost = 0xFFFFFFFF;
+	for (uint32_t i = 0; i < s->num; i++) {
+		buffer_version *v = &s->versions[i];
+		if (i != s->cur && !is_version_busy(v, completed_seq)) {
+			uint32_t cost = 0;
+			for (uint32_t j = 0; j < v->stale_num; j++) {
+				cost += v->stale[j].end - v->stale[j].start;
+			}
+			if (cost < res_cost) {
+				res = i;
+				res_cost = cost;
+			}
+		}
+	}
+	if (res >= 0)
+		return res;
+
+	// Every storage may still be read by the GPU, so a new one is required
+	void *ptr = a->alloc(s->size, s->type);
+	if (!ptr)
+		return -1;
+	stats->allocs++;
+	if (s->num < BUFFER_MAX_VERSIONS)
+		res = s->num++;
+	else {
+		// Replacing the storage the GPU will be done with first
+		for (uint32_t i = 0; i < s->num; i++) {
+			if (i != s->cur && (res < 0 || buffer_seq_reached(s->versions[i].seq, s->versions[res].seq)))
+				res = i;
+		}
+		a->release(s->versions[res].ptr, 1);
+	}
+	init_version(&s->versions[res], ptr, s->size, completed_seq);
+	return res;
+}
+
+void *buffer_store_orphan(buffer_store *s, const buffer_allocator *a, uint32_t size, uint32_t type, uint32_t completed_seq, buffer_stats *stats) {
+	// Storages can be recycled only if the buffer keeps its size and memory type
+	if (s->num && (size != s->size || type != s->type))
+		buffer_store_release(s, a, completed_seq);
+	if (!s->num) {
+		void *ptr = a->alloc(size, type);
+		if (!ptr)
+			return NULL;
+		stats->allocs++;
+		s->num = 1;
+		s->cur = 0;
+		s->size = size;
+		s->type = type;
+		init_version(&s->versions[0], ptr, size, completed_seq);
+		s->versions[0].stale_num = 0;
+		return ptr;
+	}
+
+	int idx = acquire_version(s, a, completed_seq, stats);
+	if (idx < 0)
+		return NULL;
+	if ((uint32_t)idx != s->cur) {
+		s->cur = idx;
+		stats->renames++;
+	}
+
+	// The whole content is about to be replaced, so no copy is needed
+	buffer_version *v = &s->versions[idx];
+	v->stale_num = 0;
+	mark_others_stale(s, 0, size);
+	return v->ptr;
+}
+
+static void switch_version(buffer_store *s, int idx, uint32_t skip_start, uint32_t skip_end, buffer_stats *stats) {
+	buffer_version *v = &s->versions[idx];
+
+	// Bringing the storage up to date, bytes in the skipped range are about to be overwritten so they don't need to be copied
+	const uint8_t *src = (const uint8_t *)s->versions[s->cur].ptr;
+	uint8_t *dst = (uint8_t *)v->ptr;
+	for (uint32_t i = 0; i < v->stale_num; i++) {
+		buffer_range *r = &v->stale[i];
+		if (r->start < skip_start) {
+			uint32_t copy_end = r->end < skip_start ? r->end : skip_start;
+			memcpy(dst + r->start, src + r->start, copy_end - r->start);
+			stats->bytes_copied += copy_end - r->start;
+		}
+		if (r->end > skip_end) {
+			uint32_t copy_start = r->start > skip_end ? r->start : skip_end;
+			memcpy(dst + copy_start, src + copy_start, r->end - copy_start);
+			stats->bytes_copied += r->end - copy_start;
+		}
+	}
+	v->stale_num = 0;
+	s->cur = idx;
+	stats->renames++;
+}
+
+void *buffer_store_map(buffer_store *s, const buffer_allocator *a, uint32_t offset, uint32_t size, uint32_t flags, uint32_t completed_seq, buffer_stats *stats) {
+	if (!s->num)
+		return NULL;
+	uint32_t end = offset + size;
+
+	// The caller takes care of not touching bytes the GPU may still be reading
+	if (flags & BUFFER_MAP_UNSYNCHRONIZED) {
+		mark_others_stale(s, offset, end);
+		return s->versions[s->cur].ptr;
+	}
+
+	int idx = acquire_version(s, a, completed_seq, stats);
+	if (idx < 0)
+		return NULL;
+	if (flags & BUFFER_MAP_INVALIDATE_BUFFER) {
+		// Previous content is discarded, so no copy is needed
+		if ((uint32_t)idx != s->cur) {
+			s->cur = idx;
+			stats->renames++;
+		}
+		s->versions[idx].stale_num = 0;
+		mark_others_stale(s, 0, s->size);
+	} else {
+		if ((uint32_t)idx != s->cur) {
+			if (flags & BUFFER_MAP_INVALIDATE_RANGE)
+				switch_version(s, idx, offset, end, stats);
+			else
+				switch_version(s, idx, 0, 0, stats);
+		}
+		mark_others_stale(s, offset, end);
+	}
+	return s->versions[idx].ptr;
+}
+
+void *buffer_store_write(buffer_store *s, const buffer_allocator *a, uint32_t offset, const void *data, uint32_t size, uint32_t completed_seq, buffer_stats *stats) {
+	uint8_t *ptr = (uint8_t *)buffer_store_map(s, a, offset, size, BUFFER_MAP_INVALIDATE_RANGE, completed_seq, stats);
+	if (!ptr)
+		return NULL;
+	memcpy(ptr + offset, data, size);
+	stats->bytes_written += size;
+	return ptr;
+}
+
+void buffer_store_release(buffer_store *s, const buffer_allocator *a, uint32_t completed_seq) {
+	for (uint32_t i = 0; i < s->num; i++) {
+		a->release(s->versions[i].ptr, is_version_busy(&s->versions[i], completed_seq));
+	}
+	s->num = 0;
+	s->cur = 0;
+}
@@ -0,0 +1,88 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * buffer_utils.h:
+ * Header file for the versioned buffers storage utilities exposed by buffer_utils.c
+ */
+
+#ifndef _BUFFER_UTILS_H_
+#define _BUFFER_UTILS_H_
+
+#include <stdint.h>
+
+#define BUFFER_MAX_VERSIONS 4 // Maximum number of storages a buffer can cycle through
+#define BUFFER_MAX_STALE_RANGES 8 // Maximum number of disjoint stale ranges tracked per storage
+
+// Mapping flags for buffer_store_map
+#define BUFFER_MAP_INVALIDATE_RANGE 0x1 // Mapped range content is going to be fully overwritten
+#define BUFFER_MAP_INVALIDATE_BUFFER 0x2 // Whole buffer content is discarded
+#define BUFFER_MAP_UNSYNCHRONIZED 0x4 // Current storage is returned even if the GPU may still be reading it
+
+// Returns non zero if sequence a has been reached by sequence b (wrap-around safe)
+#define buffer_seq_reached(a, b) ((int32_t)((b) - (a)) >= 0)
+
+// Range of bytes of a buffer
+typedef struct {
+	uint32_t start;
+	uint32_t end;
+} buffer_range;
+
+// Storage holding the content a buffer had at some point
+typedef struct {
+	void *ptr;
+	uint32_t seq; // Last scene sequence number that may read the storage
+	buffer_range stale[BUFFER_MAX_STALE_RANGES]; // Sorted ranges changed since the storage stopped being the current one
+	uint32_t stale_num;
+} buffer_version;
+
+// Set of storages of a buffer, the GPU keeps reading older ones while the current one gets updated
+typedef struct {
+	buffer_version versions[BUFFER_MAX_VERSIONS];
+	uint32_t num;
+	uint32_t cur;
+	uint32_t size;
+	uint32_t type; // Memory type storages get allocated with
+} buffer_store;
+
+// Storages allocator, busy is set when releasing a storage the GPU may still be reading
+typedef struct {
+	void *(*alloc)(uint32_t size, uint32_t type);
+	void (*release)(void *ptr, int busy);
+} buffer_allocator;
+
+// Buffers counters
+typedef struct {
+	uint32_t bytes_written; // Bytes of new content written into storages
+	uint32_t bytes_copied; // Bytes of previous content copied to bring storages up to date
+	uint32_t renames; // Number of times a buffer switched storage to not stall on the GPU
+	uint32_t allocs; // Number of storages allocated
+} buffer_stats;
+
+// Tags current storage as read by the given scene, called by every draw so it's kept as cheap as a store
+static inline void buffer_store_use(buffer_store *s, uint32_t seq) {
+	if (s->num)
+		s->versions[s->cur].seq = seq;
+}
+
+void *buffer_store_orphan(buffer_store *s, const buffer_allocator *a, uint32_t size, uint32_t type, uint32_t completed_seq, buffer_stats *stats);
+void *buffer_store_map(buffer_store *s, const buffer_allocator *a, uint32_t offset, uint32_t size, uint32_t flags, uint32_t completed_seq, buffer_stats *stats);
+void *buffer_store_write(buffer_store *s, const buffer_allocator *a, uint32_t offset, const void *data, uint32_t size, uint32_t completed_seq, buffer_stats *stats);
+void buffer_store_release(buffer_store *s, const buffer_allocator *a, uint32_t completed_seq);
+
+#endif
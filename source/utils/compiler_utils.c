@@ -0,0 +1,315 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * compiler_utils.c:
+ * Background compile queue for shaders
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "compiler_utils.h"
+
+#ifdef __vita__
+#include <psp2/kernel/threadmgr.h>
+typedef SceUID worker_thread;
+typedef SceUID worker_mutex;
+typedef SceUID worker_sema;
+#define mutex_create(m) m = sceKernelCreateMutex(#m, 0, 0, NULL)
+#define mutex_destroy(m) sceKernelDeleteMutex(m)
+#define mutex_lock(m) sceKernelLockMutex(m, 1, NULL)
+#define mutex_unlock(m) sceKernelUnlockMutex(m, 1)
+#define sema_create(s) s = sceKernelCreateSema("Compile Queue Sema", 0, 0, 0x7FFFFFFF, NULL)
+#define sema_destroy(s) sceKernelDeleteSema(s)
+#define sema_wait(s) sceKernelWaitSema(s, 1, NULL)
+#define sema_signal(s) sceKernelSignalSema(s, 1)
+#else
+#include <pthread.h>
+#include <semaphore.h>
+typedef pthread_t worker_thread;
+typedef pthread_mutex_t worker_mutex;
+typedef sem_t worker_sema;
+#define mutex_create(m) pthread_mutex_init(&m, NULL)
+#define mutex_destroy(m) pthread_mutex_destroy(&m)
+#define mutex_lock(m) pthread_mutex_lock(&m)
+#define mutex_unlock(m) pthread_mutex_unlock(&m)
+#define sema_create(s) sem_init(&s, 0, 0)
+#define sema_destroy(s) sem_destroy(&s)
+#define sema_wait(s) sem_wait(&s)
+#define sema_signal(s) sem_post(&s)
+#endif
+
+// Compile job alongside its completion semaphore (signaled once the job completes and kept signaled for any further waiter)
+typedef struct {
+	compile_job job;
+	worker_sema done;
+} pending_job;
+#define job_done_sema(job) (((pending_job *)(job))->done)
+
+static compile_job_cb compile_cb = NULL;
+static worker_thread workers[COMPILE_MAX_WORKERS];
+static int workers_num = 0;
+static worker_mutex queue_mutex;
+static worker_mutex compile_mutex;
+static int compile_reentrant = 0; // Whether the compile callback can be invoked from several threads at once
+static worker_sema queue_sema;
+static compile_job *queue_head = NULL; // Oldest pending job
+static compile_job *queue_tail = NULL; // Newest pending job
+static compile_job *jobs = NULL; // All jobs not yet released
+static volatile int queue_running = 0;
+
+static compile_job *queue_pop(void) {
+	mutex_lock(queue_mutex);
+	compile_job *job = queue_head;
+	if (job) {
+		queue_head = job->next_queued;
+		if (!queue_head)
+			queue_tail = NULL;
+		job->next_queued = NULL;
+		job->status = COMPILE_JOB_RUNNING;
+	}
+	mutex_unlock(queue_mutex);
+	return job;
+}
+
+static void compile_job_run(compile_job *job) {
+	if (!compile_reentrant)
+		mutex_lock(compile_mutex);
+	job->bin = compile_cb(job->source, job->size, job->type, &job->bin_size);
+	if (!compile_reentrant)
+		mutex_unlock(compile_mutex);
+	__sync_synchronize();
+	job->status = job->bin ? COMPILE_JOB_DONE : COMPILE_JOB_FAILED;
+	sema_signal(job_done_sema(job));
+}
+
+static void queue_unlink(compile_job *job) {
+	// Removes a job not picked up by a worker yet from the pending queue (queue_mutex must be held)
+	compile_job *prev = NULL, *cur = queue_head;
+	while (cur != job) {
+		prev = cur;
+		cur = cur->next_queued;
+	}
+	if (prev)
+		prev->next_queued = job->next_queued;
+	else
+		queue_head = job->next_queued;
+	if (queue_tail == job)
+		queue_tail = prev;
+	job->next_queued = NULL;
+}
+
+static void job_free(compile_job *job) {
+	sema_destroy(job_done_sema(job));
+	free(job->source);
+	free(job->bin);
+	free(job);
+}
+
+#ifdef __vita__
+static int compile_worker(SceSize args, void *argp) {
+#else
+static void *compile_worker(void *argp) {
+#endif
+	for (;;) {
+		sema_wait(queue_sema);
+		if (!queue_running)
+			break;
+		compile_job *job = queue_pop();
+		if (job)
+			compile_job_run(job);
+	}
+#ifdef __vita__
+	return sceKernelExitDeleteThread(0);
+#else
+	return NULL;
+#endif
+}
+
+int compile_queue_init(compile_job_cb cb, int reentrant, int num, int priority, int affinity) {
+	if (queue_running)
+		return 1;
+	if (num > COMPILE_MAX_WORKERS)
+		num = COMPILE_MAX_WORKERS;
+
+	compile_cb = cb;
+	compile_reentrant = reentrant;
+	mutex_create(queue_mutex);
+	mutex_create(compile_mutex);
+	sema_create(queue_sema);
+	queue_running = 1;
+	for (workers_num = 0; workers_num < num; workers_num++) {
+#ifdef __vita__
+		workers[workers_num] = sceKernelCreateThread("Shader Compiler", &compile_worker, priority, 0x40000, 0, affinity, NULL);
+		if (workers[workers_num] < 0)
+			break;
+		sceKernelStartThread(workers[workers_num], 0, NULL);
+#else
+		if (pthread_create(&workers[workers_num], NULL, compile_worker, NULL))
+			break;
+#endif
+	}
+
+	return workers_num > 0;
+}
+
+void compile_queue_term(void) {
+	if (!queue_running)
+		return;
+
+	// Waking up workers so that they can exit
+	queue_running = 0;
+	for (int i = 0; i < workers_num; i++) {
+		sema_signal(queue_sema);
+	}
+	for (int i = 0; i < workers_num; i++) {
+#ifdef __vita__
+		sceKernelWaitThreadEnd(workers[i], NULL, NULL);
+#else
+		pthread_join(workers[i], NULL);
+#endif
+	}
+	workers_num = 0;
+
+	// Releasing any leftover job (callers must have dropped every reference to them)
+	while (jobs) {
+		compile_job *next = jobs->next;
+		job_free(jobs);
+		jobs = next;
+	}
+	queue_head = queue_tail = NULL;
+
+	sema_destroy(queue_sema);
+	mutex_destroy(compile_mutex);
+	mutex_destroy(queue_mutex);
+}
+
+compile_job *compile_queue_submit(uint64_t key, int type, const char *source, uint32_t size) {
+	if (!queue_running)
+		return NULL;
+
+	compile_job *job = (compile_job *)calloc(1, sizeof(pending_job));
+	if (!job)
+		return NULL;
+	job->source = (char *)malloc(size + 1);
+	if (!job->source) {
+		free(job);
+		return NULL;
+	}
+	sema_create(job_done_sema(job));
+	memcpy(job->source, source, size);
+	job->source[size] = 0;
+	job->size = size;
+	job->key = key;
+	job->type = type;
+	job->status = COMPILE_JOB_QUEUED;
+
+	mutex_lock(queue_mutex);
+	job->next = jobs;
+	jobs = job;
+	if (queue_tail)
+		queue_tail->next_queued = job;
+	else
+		queue_head = job;
+	queue_tail = job;
+	mutex_unlock(queue_mutex);
+
+	sema_signal(queue_sema);
+	return job;
+}
+
+compile_job *compile_queue_find(uint64_t key) {
+	mutex_lock(queue_mutex);
+	compile_job *job = jobs;
+	while (job && job->key != key) {
+		job = job->next;
+	}
+	mutex_unlock(queue_mutex);
+	return job;
+}
+
+void compile_job_wait(compile_job *job) {
+	// If the job has not been picked up by a worker yet, we compile it on the caller thread
+	mutex_lock(queue_mutex);
+	if (job->status == COMPILE_JOB_QUEUED) {
+		queue_unlink(job);
+		job->status = COMPILE_JOB_RUNNING;
+		mutex_unlock(queue_mutex);
+		compile_job_run(job);
+		return;
+	}
+	mutex_unlock(queue_mutex);
+
+	if (!compile_job_is_complete(job)) {
+		sema_wait(job_done_sema(job));
+		sema_signal(job_done_sema(job));
+	}
+}
+
+void compile_queue_release(compile_job *job) {
+	// Jobs not picked up by a worker yet are dropped without being compiled
+	mutex_lock(queue_mutex);
+	int queued = job->status == COMPILE_JOB_QUEUED;
+	if (queued)
+		queue_unlink(job);
+	mutex_unlock(queue_mutex);
+	if (!queued)
+		compile_job_wait(job);
+
+	mutex_lock(queue_mutex);
+	compile_job *prev = NULL, *cur = jobs;
+	while (cur && cur != job) {
+		prev = cur;
+		cur = cur->next;
+	}
+	if (cur) {
+		if (prev)
+			prev->next = job->next;
+		else
+			jobs = job->next;
+	}
+	mutex_unlock(queue_mutex);
+
+	job_free(job);
+}
+
+void compile_lock(void) {
+	if (queue_running && !compile_reentrant)
+		mutex_lock(compile_mutex);
+}
+
+void compile_unlock(void) {
+	if (queue_running && !compile_reentrant)
+		mutex_unlock(compile_mutex);
+}
+
+int compile_find_nearest_variant(const uint32_t *variants, int num, uint32_t wanted, uint32_t compat_mask) {
+	int res = -1;
+	int best_dist = 33;
+	for (int i = 0; i < num; i++) {
+		uint32_t diff = variants[i] ^ wanted;
+		if (diff & compat_mask)
+			continue;
+		int dist = __builtin_popcount(diff);
+		if (dist < best_dist) {
+			best_dist = dist;
+			res = i;
+		}
+	}
+	return res;
+}
@@ -0,0 +1,72 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * compiler_utils.h:
+ * Header file for the asynchronous shader compilation utilities exposed by compiler_utils.c
+ */
+
+#ifndef _COMPILER_UTILS_H_
+#define _COMPILER_UTILS_H_
+
+#include <stdint.h>
+
+#define COMPILE_MAX_WORKERS 4 // Maximum number of worker threads for the compile queue
+
+// Compile job status
+typedef enum {
+	COMPILE_JOB_QUEUED,
+	COMPILE_JOB_RUNNING,
+	COMPILE_JOB_DONE,
+	COMPILE_JOB_FAILED
+} compile_job_status;
+
+// Compile job
+typedef struct compile_job {
+	uint64_t key; // Caller defined key used for lookups
+	int type; // Caller defined shader type passed to the compile callback
+	char *source; // Shader source (owned by the job, kept until release)
+	uint32_t size; // Shader source length
+	void *bin; // Compiled binary (allocated with malloc, owned by the job)
+	uint32_t bin_size; // Compiled binary size
+	volatile uint32_t status; // One of compile_job_status
+	struct compile_job *next_queued; // Next job in the pending queue
+	struct compile_job *next; // Next job in the jobs table
+} compile_job;
+
+// Compile callback, returns a malloc allocated binary or NULL on failure
+typedef void *(*compile_job_cb)(const char *source, uint32_t size, int type, uint32_t *bin_size);
+
+// NOTE: compile_queue_term frees every job not released yet, callers must drop their references first
+int compile_queue_init(compile_job_cb cb, int reentrant, int workers_num, int priority, int affinity);
+void compile_queue_term(void);
+compile_job *compile_queue_submit(uint64_t key, int type, const char *source, uint32_t size);
+compile_job *compile_queue_find(uint64_t key);
+void compile_queue_release(compile_job *job);
+void compile_job_wait(compile_job *job);
+
+// Serializes compile callback usage from threads outside the compile queue
+void compile_lock(void);
+void compile_unlock(void);
+
+// Returns index of the entry in variants matching wanted on every bit set in compat_mask and differing the least on the others (-1 if none)
+int compile_find_nearest_variant(const uint32_t *variants, int num, uint32_t wanted, uint32_t compat_mask);
+
+#define compile_job_is_complete(job) ((job)->status >= COMPILE_JOB_DONE)
+
+#endif
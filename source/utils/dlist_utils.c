@@ -0,0 +1,322 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * dlist_utils.c:
+ * Bytecode recording, folding and replay for display lists
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "dlist_utils.h"
+
+#define DLIST_OP_ALIGN (sizeof(void *))
+
+// Packs up to 4 signature chars in a single word
+#define SIG(a, b, c, d) ((uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+
+// Offsets of the pending writes per attribute class for the arena being recorded
+static uint32_t pending_attribs[DLIST_ATTRIB_CLASSES_NUM];
+static dlist_arena *pending_arena = NULL;
+
+static void reset_pending_attribs(dlist_arena *a) {
+	for (int i = 0; i < DLIST_ATTRIB_CLASSES_NUM; i++)
+		pending_attribs[i] = DLIST_NO_OP;
+	pending_arena = a;
+}
+
+void dlist_arena_init(dlist_arena *a) {
+	a->data = NULL;
+	a->size = 0;
+	a->capacity = 0;
+	a->last = DLIST_NO_OP;
+	if (pending_arena == a)
+		pending_arena = NULL;
+}
+
+void dlist_arena_free(dlist_arena *a) {
+	free(a->data);
+	dlist_arena_init(a);
+}
+
+dlistFuncType dlist_pack_args(uint8_t *dst, uint32_t *size, const char *sig, va_list args) {
+	uint32_t key = 0;
+	uint32_t i = 0;
+	for (int n = 0; sig[n]; n++) {
+		if (n == 4)
+			return DLIST_OP_INVALID;
+		key |= (uint32_t)sig[n] << (n * 8);
+		switch (sig[n]) {
+		case 'I':
+			{
+				int32_t arg = va_arg(args, int32_t);
+				memcpy(&dst[i], &arg, sizeof(arg));
+				i += sizeof(arg);
+			}
+			break;
+		case 'U':
+			{
+				uint32_t arg = va_arg(args, uint32_t);
+				memcpy(&dst[i], &arg, sizeof(arg));
+				i += sizeof(arg);
+			}
+			break;
+		case 'F':
+			{
+				float arg = (float)va_arg(args, double);
+				memcpy(&dst[i], &arg, sizeof(arg));
+				i += sizeof(arg);
+			}
+			break;
+		case 'X':
+			{
+				uint8_t arg = (uint8_t)va_arg(args, int);
+				memcpy(&dst[i], &arg, sizeof(arg));
+				i += sizeof(arg);
+			}
+			break;
+		case 'S':
+			{
+				int16_t arg = (int16_t)va_arg(args, int);
+				memcpy(&dst[i], &arg, sizeof(arg));
+				i += sizeof(arg);
+			}
+			break;
+		default:
+			return DLIST_OP_INVALID;
+		}
+	}
+	*size = i;
+
+	switch (key) {
+	// No arguments
+	case 0:
+		return DLIST_FUNC_VOID;
+	// 1 argument
+	case SIG('U', 0, 0, 0):
+		return DLIST_FUNC_U32;
+	// 2 arguments
+	case SIG('I', 'I', 0, 0):
+		return DLIST_FUNC_I32_I32;
+	case SIG('U', 'U', 0, 0):
+		return DLIST_FUNC_U32_U32;
+	case SIG('U', 'I', 0, 0):
+		return DLIST_FUNC_U32_I32;
+	case SIG('U', 'F', 0, 0):
+		return DLIST_FUNC_U32_F32;
+	case SIG('F', 'F', 0, 0):
+		return DLIST_FUNC_F32_F32;
+	// 3 arguments
+	case SIG('I', 'I', 'I', 0):
+		return DLIST_FUNC_I32_I32_I32;
+	case SIG('U', 'I', 'I', 0):
+		return DLIST_FUNC_U32_I32_I32;
+	case SIG('U', 'U', 'I', 0):
+		return DLIST_FUNC_U32_U32_I32;
+	case SIG('U', 'I', 'U', 0):
+		return DLIST_FUNC_U32_I32_U32;
+	case SIG('U', 'U', 'U', 0):
+		return DLIST_FUNC_U32_U32_U32;
+	case SIG('U', 'F', 'F', 0):
+		return DLIST_FUNC_U32_F32_F32;
+	case SIG('U', 'U', 'F', 0):
+		return DLIST_FUNC_U32_U32_F32;
+	case SIG('F', 'F', 'F', 0):
+		return DLIST_FUNC_F32_F32_F32;
+	case SIG('S', 'S', 'S', 0):
+		return DLIST_FUNC_I16_I16_I16;
+	case SIG('X', 'X', 'X', 0):
+		return DLIST_FUNC_U8_U8_U8;
+	// 4 arguments
+	case SIG('U', 'U', 'U', 'U'):
+		return DLIST_FUNC_U32_U32_U32_U32;
+	case SIG('I', 'I', 'I', 'I'):
+		return DLIST_FUNC_I32_I32_I32_I32;
+	case SIG('I', 'U', 'I', 'U'):
+		return DLIST_FUNC_I32_U32_I32_U32;
+	case SIG('U', 'I', 'U', 'U'):
+		return DLIST_FUNC_U32_I32_U32_U32;
+	case SIG('F', 'F', 'F', 'F'):
+		return DLIST_FUNC_F32_F32_F32_F32;
+	case SIG('X', 'X', 'X', 'X'):
+		return DLIST_FUNC_U8_U8_U8_U8;
+	default:
+		return DLIST_OP_INVALID;
+	}
+}
+
+static uint32_t reserve_op(dlist_arena *a, uint32_t size) {
+	if (a->size + size > a->capacity) {
+		uint32_t new_capacity = a->capacity ? a->capacity : DLIST_ARENA_DEF_SIZE;
+		while (new_capacity < a->size + size)
+			new_capacity *= 2;
+		uint8_t *new_data = (uint8_t *)realloc(a->data, new_capacity);
+		if (!new_data)
+			return DLIST_NO_OP;
+		a->data = new_data;
+		a->capacity = new_capacity;
+	}
+	uint32_t off = a->size;
+	a->size += size;
+	return off;
+}
+
+uint32_t dlist_record(dlist_arena *a, void (*func)(), dlistFuncType type, uint8_t flags, const void *args, uint32_t args_size) {
+	if (pending_arena != a)
+		reset_pending_attribs(a);
+
+	// Repeating the last call with the same operands is a no-op for idempotent calls
+	if ((flags & DLIST_FLAG_IDEMPOTENT) && a->last != DLIST_NO_OP) {
+		dlist_op *last = dlist_op_at(a, a->last);
+		if (last->func == func && last->type == type && !memcmp(dlist_op_args(last), args, args_size))
+			return a->last;
+	}
+
+	uint32_t size = (sizeof(dlist_op) + args_size + DLIST_OP_ALIGN - 1) & ~(DLIST_OP_ALIGN - 1);
+	uint32_t off = reserve_op(a, size);
+	if (off == DLIST_NO_OP)
+		return DLIST_NO_OP;
+	dlist_op *op = dlist_op_at(a, off);
+	op->func = func;
+	op->type = type;
+	op->flags = flags;
+	op->size = size;
+	memcpy(dlist_op_args(op), args, args_size);
+	a->last = off;
+
+	// An attribute overwritten before anything could read it makes the previous write dead
+	if (flags & DLIST_FLAG_ATTRIB) {
+		int c = DLIST_ATTRIB_CLASS(flags);
+		if (pending_attribs[c] != DLIST_NO_OP)
+			dlist_op_at(a, pending_attribs[c])->type = DLIST_OP_NOP;
+		pending_attribs[c] = off;
+	} else
+		reset_pending_attribs(a);
+
+	return off;
+}
+
+uint32_t dlist_append(dlist_arena *a, const dlist_op *op) {
+	uint32_t off = reserve_op(a, op->size);
+	if (off == DLIST_NO_OP)
+		return DLIST_NO_OP;
+	memcpy(dlist_op_at(a, off), op, op->size);
+	a->last = off;
+	if (pending_arena == a)
+		pending_arena = NULL;
+	return off;
+}
+
+void dlist_execute(const dlist_arena *a, dlist_hook_cb hook) {
+	// Arena size is sampled once so that calls recorded while replaying are not replayed as well
+	dlist_execute_range(a, 0, a->size, hook);
+}
+
+void dlist_execute_range(const dlist_arena *a, uint32_t off, uint32_t end, dlist_hook_cb hook) {
+	while (off < end) {
+		const dlist_op *op = dlist_op_at(a, off);
+		const uint8_t *args = dlist_op_args(op);
+		off += op->size;
+		switch (op->type) {
+		// No arguments
+		case DLIST_FUNC_VOID:
+			((void (*)(void))op->func)();
+			break;
+		// 1 argument
+		case DLIST_FUNC_U32:
+			((void (*)(uint32_t))op->func)(*(uint32_t *)args);
+			break;
+		// 2 arguments
+		case DLIST_FUNC_I32_I32:
+			((void (*)(int32_t, int32_t))op->func)(*(int32_t *)args, *(int32_t *)&args[4]);
+			break;
+		case DLIST_FUNC_U32_U32:
+			((void (*)(uint32_t, uint32_t))op->func)(*(uint32_t *)args, *(uint32_t *)&args[4]);
+			break;
+		case DLIST_FUNC_U32_I32:
+			((void (*)(uint32_t, int32_t))op->func)(*(uint32_t *)args, *(int32_t *)&args[4]);
+			break;
+		case DLIST_FUNC_U32_F32:
+			((void (*)(uint32_t, float))op->func)(*(uint32_t *)args, *(float *)&args[4]);
+			break;
+		case DLIST_FUNC_F32_F32:
+			((void (*)(float, float))op->func)(*(float *)args, *(float *)&args[4]);
+			break;
+		// 3 arguments
+		case DLIST_FUNC_I32_I32_I32:
+			((void (*)(int32_t, int32_t, int32_t))op->func)(*(int32_t *)args, *(int32_t *)&args[4], *(int32_t *)&args[8]);
+			break;
+		case DLIST_FUNC_U32_I32_I32:
+			((void (*)(uint32_t, int32_t, int32_t))op->func)(*(uint32_t *)args, *(int32_t *)&args[4], *(int32_t *)&args[8]);
+			break;
+		case DLIST_FUNC_U32_U32_I32:
+			((void (*)(uint32_t, uint32_t, int32_t))op->func)(*(uint32_t *)args, *(uint32_t *)&args[4], *(int32_t *)&args[8]);
+			break;
+		case DLIST_FUNC_U32_I32_U32:
+			((void (*)(uint32_t, int32_t, uint32_t))op->func)(*(uint32_t *)args, *(int32_t *)&args[4], *(uint32_t *)&args[8]);
+			break;
+		case DLIST_FUNC_U32_U32_U32:
+			((void (*)(uint32_t, uint32_t, uint32_t))op->func)(*(uint32_t *)args, *(uint32_t *)&args[4], *(uint32_t *)&args[8]);
+			break;
+		case DLIST_FUNC_U32_F32_F32:
+			((void (*)(uint32_t, float, float))op->func)(*(uint32_t *)args, *(float *)&args[4], *(float *)&args[8]);
+			break;
+		case DLIST_FUNC_U32_U32_F32:
+			((void (*)(uint32_t, uint32_t, float))op->func)(*(uint32_t *)args, *(uint32_t *)&args[4], *(float *)&args[8]);
+			break;
+		case DLIST_FUNC_F32_F32_F32:
+			((void (*)(float, float, float))op->func)(*(float *)args, *(float *)&args[4], *(float *)&args[8]);
+			break;
+		case DLIST_FUNC_I16_I16_I16:
+			((void (*)(int16_t, int16_t, int16_t))op->func)(*(int16_t *)args, *(int16_t *)&args[2], *(int16_t *)&args[4]);
+			break;
+		case DLIST_FUNC_U8_U8_U8:
+			((void (*)(uint8_t, uint8_t, uint8_t))op->func)(args[0], args[1], args[2]);
+			break;
+		// 4 arguments
+		case DLIST_FUNC_U32_U32_U32_U32:
+			((void (*)(uint32_t, uint32_t, uint32_t, uint32_t))op->func)(*(uint32_t *)args, *(uint32_t *)&args[4], *(uint32_t *)&args[8], *(uint32_t *)&args[12]);
+			break;
+		case DLIST_FUNC_I32_I32_I32_I32:
+			((void (*)(int32_t, int32_t, int32_t, int32_t))op->func)(*(int32_t *)args, *(int32_t *)&args[4], *(int32_t *)&args[8], *(int32_t *)&args[12]);
+			break;
+		case DLIST_FUNC_I32_U32_I32_U32:
+			((void (*)(int32_t, uint32_t, int32_t, uint32_t))op->func)(*(int32_t *)args, *(uint32_t *)&args[4], *(int32_t *)&args[8], *(uint32_t *)&args[12]);
+			break;
+		case DLIST_FUNC_U32_I32_U32_U32:
+			((void (*)(uint32_t, int32_t, uint32_t, uint32_t))op->func)(*(uint32_t *)args, *(int32_t *)&args[4], *(uint32_t *)&args[8], *(uint32_t *)&args[12]);
+			break;
+		case DLIST_FUNC_F32_F32_F32_F32:
+			((void (*)(float, float, float, float))op->func)(*(float *)args, *(float *)&args[4], *(float *)&args[8], *(float *)&args[12]);
+			break;
+		case DLIST_FUNC_U8_U8_U8_U8:
+			((void (*)(uint8_t, uint8_t, uint8_t, uint8_t))op->func)(args[0], args[1], args[2], args[3]);
+			break;
+		// Internal opcodes
+		case DLIST_OP_JUMP:
+			off = *(uint32_t *)args;
+			break;
+		case DLIST_OP_HOOK:
+			if (hook)
+				off = hook(a, op, off);
+			break;
+		default:
+			break;
+		}
+	}
+}
@@ -0,0 +1,111 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * dlist_utils.h:
+ * Header file for the display lists bytecode utilities exposed by dlist_utils.c
+ */
+
+#ifndef _DLIST_UTILS_H_
+#define _DLIST_UTILS_H_
+
+#include <stdarg.h>
+#include <stdint.h>
+
+#define DLIST_ARENA_DEF_SIZE 256 // Initial size in bytes of a display list bytecode arena
+#define DLIST_MAX_ARGS_SIZE 16 // Maximum size in bytes of the operands of a recorded call
+#define DLIST_NO_OP 0xFFFFFFFF // Invalid op offset
+
+// Operands layout of recorded calls and internal opcodes
+typedef enum {
+	// No arguments
+	DLIST_FUNC_VOID,
+	// 1 argument
+	DLIST_FUNC_U32,
+	// 2 arguments
+	DLIST_FUNC_I32_I32,
+	DLIST_FUNC_U32_U32,
+	DLIST_FUNC_U32_I32,
+	DLIST_FUNC_U32_F32,
+	DLIST_FUNC_F32_F32,
+	// 3 arguments
+	DLIST_FUNC_I32_I32_I32,
+	DLIST_FUNC_U32_I32_I32,
+	DLIST_FUNC_U32_U32_I32,
+	DLIST_FUNC_U32_I32_U32,
+	DLIST_FUNC_U32_U32_U32,
+	DLIST_FUNC_U32_F32_F32,
+	DLIST_FUNC_U32_U32_F32,
+	DLIST_FUNC_F32_F32_F32,
+	DLIST_FUNC_I16_I16_I16,
+	DLIST_FUNC_U8_U8_U8,
+	// 4 arguments
+	DLIST_FUNC_U32_U32_U32_U32,
+	DLIST_FUNC_I32_I32_I32_I32,
+	DLIST_FUNC_I32_U32_I32_U32,
+	DLIST_FUNC_U32_I32_U32_U32,
+	DLIST_FUNC_F32_F32_F32_F32,
+	DLIST_FUNC_U8_U8_U8_U8,
+	// Internal opcodes
+	DLIST_OP_NOP, // Folded call, skipped on replay
+	DLIST_OP_JUMP, // Continues replay from the offset stored as operand
+	DLIST_OP_HOOK, // Handled by the hook passed to dlist_execute
+	DLIST_OP_INVALID
+} dlistFuncType;
+
+// Op flags used by the optimizer
+#define DLIST_FLAG_IDEMPOTENT 0x01 // Repeating the call with the same operands has no effect
+#define DLIST_FLAG_VERTEX 0x02 // Call emits an immediate mode vertex
+#define DLIST_FLAG_BEGIN 0x04 // Call starts an immediate mode primitive
+#define DLIST_FLAG_END 0x08 // Call ends an immediate mode primitive
+#define DLIST_FLAG_ATTRIB 0x10 // Call only overwrites a current vertex attribute
+#define DLIST_FLAG_ATTRIB_CLASS(c) (DLIST_FLAG_ATTRIB | ((c) << 5)) // Attribute op overwriting the given attribute class
+#define DLIST_ATTRIB_CLASS(flags) ((flags) >> 5) // Attribute class of an attribute op
+#define DLIST_ATTRIB_CLASSES_NUM 4 // Maximum number of attribute classes
+
+// Recorded op header, operands follow it
+typedef struct {
+	void (*func)();
+	uint8_t type;
+	uint8_t flags;
+	uint16_t size; // Whole op size, header included
+} dlist_op;
+
+// Contiguous bytecode storage for a display list
+typedef struct {
+	uint8_t *data;
+	uint32_t size;
+	uint32_t capacity;
+	uint32_t last; // Offset of the last recorded op
+} dlist_arena;
+
+// Callback for DLIST_OP_HOOK ops, returns the offset to continue from
+typedef uint32_t (*dlist_hook_cb)(const dlist_arena *a, const dlist_op *op, uint32_t next);
+
+#define dlist_op_at(a, off) ((dlist_op *)((a)->data + (off)))
+#define dlist_op_args(op) ((uint8_t *)((dlist_op *)(op) + 1))
+
+void dlist_arena_init(dlist_arena *a);
+void dlist_arena_free(dlist_arena *a);
+dlistFuncType dlist_pack_args(uint8_t *dst, uint32_t *size, const char *sig, va_list args);
+uint32_t dlist_record(dlist_arena *a, void (*func)(), dlistFuncType type, uint8_t flags, const void *args, uint32_t args_size);
+uint32_t dlist_append(dlist_arena *a, const dlist_op *op);
+void dlist_execute(const dlist_arena *a, dlist_hook_cb hook);
+void dlist_execute_range(const dlist_arena *a, uint32_t off, uint32_t end, dlist_hook_cb hook);
+
+#endif
@@ -0,0 +1,738 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * dxt_utils.c:
+ * Multithreaded DXT1/DXT5 texture compressor writing directly in swizzled layout
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dxt_utils.h"
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+#ifdef __vita__
+#include <psp2/kernel/threadmgr.h>
+typedef SceUID worker_thread;
+typedef SceUID worker_mutex;
+typedef SceUID worker_sema;
+#define mutex_create(m) m = sceKernelCreateMutex(#m, 0, 0, NULL)
+#define mutex_destroy(m) sceKernelDeleteMutex(m)
+#define mutex_lock(m) sceKernelLockMutex(m, 1, NULL)
+#define mutex_unlock(m) sceKernelUnlockMutex(m, 1)
+#define sema_create(s) s = sceKernelCreateSema(#s, 0, 0, DXT_MAX_WORKERS, NULL)
+#define sema_destroy(s) sceKernelDeleteSema(s)
+#define sema_wait(s) sceKernelWaitSema(s, 1, NULL)
+#define sema_signal(s) sceKernelSignalSema(s, 1)
+#else
+#include <pthread.h>
+#include <semaphore.h>
+typedef pthread_t worker_thread;
+typedef pthread_mutex_t worker_mutex;
+typedef sem_t worker_sema;
+#define mutex_create(m) pthread_mutex_init(&m, NULL)
+#define mutex_destroy(m) pthread_mutex_destroy(&m)
+#define mutex_lock(m) pthread_mutex_lock(&m)
+#define mutex_unlock(m) pthread_mutex_unlock(&m)
+#define sema_create(s) sem_init(&s, 0, 0)
+#define sema_destroy(s) sem_destroy(&s)
+#define sema_wait(s) sem_wait(&s)
+#define sema_signal(s) sem_post(&s)
+#endif
+
+#define clamp_u8(x) ((x) < 0 ? 0 : ((x) > 255 ? 255 : (x)))
+
+/*
+ * Single color blocks are encoded with the endpoints pair whose 2/3 interpolation
+ * gets the closest to the wanted value (taken from stb_dxt)
+ */
+static uint8_t single_match5[256][2];
+static uint8_t single_match6[256][2];
+static int tables_initialized = 0;
+
+static inline int expand5(int v) {
+	return (v << 3) | (v >> 2);
+}
+
+static inline int expand6(int v) {
+	return (v << 2) | (v >> 4);
+}
+
+static void build_single_match(uint8_t table[256][2], int size, int (*expand)(int)) {
+	for (int i = 0; i < 256; i++) {
+		int best_err = 256 * 100;
+		for (int mn = 0; mn < size; mn++) {
+			for (int mx = 0; mx < size; mx++) {
+				int mine = expand(mn);
+				int maxe = expand(mx);
+				int err = abs((2 * maxe + mine) / 3 - i) * 100 + abs(maxe - mine) * 3;
+				if (err < best_err) {
+					table[i][0] = mx;
+					table[i][1] = mn;
+					best_err = err;
+				}
+			}
+		}
+	}
+}
+
+static void init_tables(void) {
+	if (tables_initialized)
+		return;
+	build_single_match(single_match5, 32, expand5);
+	build_single_match(single_match6, 64, expand6);
+	tables_initialized = 1;
+}
+
+static inline uint16_t pack565(int r, int g, int b) {
+	r = clamp_u8(r);
+	g = clamp_u8(g);
+	b = clamp_u8(b);
+	return (((r * 31 + 127) / 255) << 11) | (((g * 63 + 127) / 255) << 5) | ((b * 31 + 127) / 255);
+}
+
+static inline void unpack565(uint16_t c, int *rgb) {
+	rgb[0] = expand5(c >> 11);
+	rgb[1] = expand6((c >> 5) & 0x3F);
+	rgb[2] = expand5(c & 0x1F);
+}
+
+// Block colors split by channel so that per pixel loops can be vectorized
+typedef struct {
+	int r[16];
+	int g[16];
+	int b[16];
+	int a[16];
+} dxt_block;
+
+static void palette_from_endpoints(uint16_t c0, uint16_t c1, int pal[4][3]) {
+	unpack565(c0, pal[0]);
+	unpack565(c1, pal[1]);
+	for (int c = 0; c < 3; c++) {
+		pal[2][c] = (2 * pal[0][c] + pal[1][c]) / 3;
+		pal[3][c] = (pal[0][c] + 2 * pal[1][c]) / 3;
+	}
+}
+
+// Picks the closest palette entry for every pixel, returns the total squared error
+static uint32_t match_nearest(const dxt_block *blk, int pal[4][3], uint8_t *idx) {
+	int err[4][16];
+	for (int k = 0; k < 4; k++) {
+		for (int i = 0; i < 16; i++) {
+			int dr = blk->r[i] - pal[k][0];
+			int dg = blk->g[i] - pal[k][1];
+			int db = blk->b[i] - pal[k][2];
+			err[k][i] = dr * dr + dg * dg + db * db;
+		}
+	}
+	uint32_t total = 0;
+	for (int i = 0; i < 16; i++) {
+		int best = 0;
+		int best_err = err[0][i];
+		for (int k = 1; k < 4; k++) {
+			if (err[k][i] < best_err) {
+				best_err = err[k][i];
+				best = k;
+			}
+		}
+		idx[i] = best;
+		total += best_err;
+	}
+	return total;
+}
+
+// Picks palette entries by projecting pixels on the endpoints axis
+static void match_projected(const dxt_block *blk, int pal[4][3], uint8_t *idx) {
+	int dir[3] = {pal[0][0] - pal[1][0], pal[0][1] - pal[1][1], pal[0][2] - pal[1][2]};
+	int stops[4];
+	for (int k = 0; k < 4; k++)
+		stops[k] = pal[k][0] * dir[0] + pal[k][1] * dir[1] + pal[k][2] * dir[2];
+	// Palette entries along the axis are ordered as 1, 3, 2, 0
+	int t0 = stops[1] + stops[3];
+	int t1 = stops[3] + stops[2];
+	int t2 = stops[2] + stops[0];
+	// Thresholds are crossed in order, so the entry can be derived without branches from the comparisons
+	for (int i = 0; i < 16; i++) {
+		int dot = 2 * (blk->r[i] * dir[0] + blk->g[i] * dir[1] + blk->b[i] * dir[2]);
+		int c0 = dot >= t0, c1 = dot >= t1, c2 = dot >= t2;
+		idx[i] = (c1 ^ 1) | ((c0 & (c2 ^ 1)) << 1);
+	}
+}
+
+// Solves endpoints minimizing the squared error for the given indices, returns 0 if indices are degenerate
+static int refine_endpoints(const dxt_block *blk, const int *sum, const uint8_t *idx, uint16_t *c0, uint16_t *c1) {
+	// Weight of the first endpoint in thirds is 3, 0, 2, 1 for indices 0 to 3, the second one gets the remainder
+	int sa = 0, aa = 0;
+	int ax[3] = {0, 0, 0};
+	for (int i = 0; i < 16; i++) {
+		int a = (0x1203 >> (idx[i] << 2)) & 3;
+		sa += a;
+		aa += a * a;
+		ax[0] += a * blk->r[i];
+		ax[1] += a * blk->g[i];
+		ax[2] += a * blk->b[i];
+	}
+	int bb = 144 - 6 * sa + aa;
+	int ab = 3 * sa - aa;
+	int bx[3] = {3 * sum[0] - ax[0], 3 * sum[1] - ax[1], 3 * sum[2] - ax[2]};
+	int det = aa * bb - ab * ab;
+	if (!det)
+		return 0;
+	float f = 3.0f / (float)det;
+	int e0[3], e1[3];
+	for (int c = 0; c < 3; c++) {
+		e0[c] = (int)((float)(ax[c] * bb - bx[c] * ab) * f + 0.5f);
+		e1[c] = (int)((float)(bx[c] * aa - ax[c] * ab) * f + 0.5f);
+	}
+	*c0 = pack565(e0[0], e0[1], e0[2]);
+	*c1 = pack565(e1[0], e1[1], e1[2]);
+	return 1;
+}
+
+#ifdef __ARM_NEON
+static inline int32x4_t neon_dots(const dxt_block *blk, const int *dir, int k) {
+	int32x4_t dot = vmulq_n_s32(vld1q_s32(&blk->r[k]), dir[0]);
+	dot = vmlaq_n_s32(dot, vld1q_s32(&blk->g[k]), dir[1]);
+	return vmlaq_n_s32(dot, vld1q_s32(&blk->b[k]), dir[2]);
+}
+
+static inline int neon_min(int32x4_t v) {
+	int32x2_t m = vpmin_s32(vget_low_s32(v), vget_high_s32(v));
+	return vget_lane_s32(vpmin_s32(m, m), 0);
+}
+
+static inline int neon_max(int32x4_t v) {
+	int32x2_t m = vpmax_s32(vget_low_s32(v), vget_high_s32(v));
+	return vget_lane_s32(vpmax_s32(m, m), 0);
+}
+
+// Finds the pixels with the smallest and biggest projection on the given axis
+static void search_endpoints(const dxt_block *blk, const int *dir, int *min_i, int *max_i) {
+	int dots[16];
+	int32x4_t d0 = neon_dots(blk, dir, 0);
+	int32x4_t d1 = neon_dots(blk, dir, 4);
+	int32x4_t d2 = neon_dots(blk, dir, 8);
+	int32x4_t d3 = neon_dots(blk, dir, 12);
+	vst1q_s32(&dots[0], d0);
+	vst1q_s32(&dots[4], d1);
+	vst1q_s32(&dots[8], d2);
+	vst1q_s32(&dots[12], d3);
+	int mn = neon_min(vminq_s32(vminq_s32(d0, d1), vminq_s32(d2, d3)));
+	int mx = neon_max(vmaxq_s32(vmaxq_s32(d0, d1), vmaxq_s32(d2, d3)));
+	// The first matching pixels are picked as the scalar search does
+	for (*min_i = 0; dots[*min_i] != mn; (*min_i)++);
+	for (*max_i = 0; dots[*max_i] != mx; (*max_i)++);
+}
+
+// Computes minimum, maximum and sum of a block channel
+static void channel_range(const int *ch, int *mn, int *mx, int *sum) {
+	int32x4_t v0 = vld1q_s32(&ch[0]);
+	int32x4_t v1 = vld1q_s32(&ch[4]);
+	int32x4_t v2 = vld1q_s32(&ch[8]);
+	int32x4_t v3 = vld1q_s32(&ch[12]);
+	*mn = neon_min(vminq_s32(vminq_s32(v0, v1), vminq_s32(v2, v3)));
+	*mx = neon_max(vmaxq_s32(vmaxq_s32(v0, v1), vmaxq_s32(v2, v3)));
+	int32x4_t acc = vaddq_s32(vaddq_s32(v0, v1), vaddq_s32(v2, v3));
+	int32x2_t pair = vpadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+	*sum = vget_lane_s32(vpadd_s32(pair, pair), 0);
+}
+#else
+// Finds the pixels with the smallest and biggest projection on the given axis
+static void search_endpoints(const dxt_block *blk, const int *dir, int *min_i, int *max_i) {
+	int dots[16];
+	for (int i = 0; i < 16; i++)
+		dots[i] = blk->r[i] * dir[0] + blk->g[i] * dir[1] + blk->b[i] * dir[2];
+	int mn = dots[0], mx = dots[0];
+	for (int i = 1; i < 16; i++) {
+		mn = dots[i] < mn ? dots[i] : mn;
+		mx = dots[i] > mx ? dots[i] : mx;
+	}
+	int i;
+	for (i = 0; dots[i] != mn; i++);
+	*min_i = i;
+	for (i = 0; dots[i] != mx; i++);
+	*max_i = i;
+}
+
+// Computes minimum, maximum and sum of a block channel
+static void channel_range(const int *ch, int *mn, int *mx, int *sum) {
+	int lo = ch[0], hi = ch[0], total = ch[0];
+	for (int i = 1; i < 16; i++) {
+		lo = ch[i] < lo ? ch[i] : lo;
+		hi = ch[i] > hi ? ch[i] : hi;
+		total += ch[i];
+	}
+	*mn = lo;
+	*mx = hi;
+	*sum = total;
+}
+#endif
+
+// Endpoints from the colors bounding box, flipping the diagonal when channels are inversely correlated
+static void fit_bounding_box(const dxt_block *blk, const int *lo, const int *hi, const int *sum, uint16_t *c0, uint16_t *c1) {
+	int mn[3] = {lo[0], lo[1], lo[2]};
+	int mx[3] = {hi[0], hi[1], hi[2]};
+	const int *ch[3] = {blk->r, blk->g, blk->b};
+	int major = 0;
+	for (int c = 1; c < 3; c++) {
+		if (mx[c] - mn[c] > mx[major] - mn[major])
+			major = c;
+	}
+	for (int c = 0; c < 3; c++) {
+		if (c != major) {
+			int cov = 0;
+			for (int i = 0; i < 16; i++)
+				cov += (ch[major][i] * 16 - sum[major]) * (ch[c][i] * 16 - sum[c]);
+			if (cov < 0) {
+				int t = mn[c];
+				mn[c] = mx[c];
+				mx[c] = t;
+			}
+		}
+		// Insetting the box to reduce the error of the interpolated colors
+		int inset = (mx[c] - mn[c]) / 16;
+		mx[c] -= inset;
+		mn[c] += inset;
+	}
+	*c0 = pack565(mx[0], mx[1], mx[2]);
+	*c1 = pack565(mn[0], mn[1], mn[2]);
+}
+
+// Direction of the biggest variance of the block colors, left untouched when there is none
+static void principal_axis(const dxt_block *blk, const int *sum, int *dir) {
+	// Covariance of the colors scaled by 256 so that it can be computed in integers
+	int cov[6] = {0, 0, 0, 0, 0, 0};
+	for (int i = 0; i < 16; i++) {
+		int r = blk->r[i] * 16 - sum[0];
+		int g = blk->g[i] * 16 - sum[1];
+		int b = blk->b[i] * 16 - sum[2];
+		cov[0] += r * r;
+		cov[1] += r * g;
+		cov[2] += r * b;
+		cov[3] += g * g;
+		cov[4] += g * b;
+		cov[5] += b * b;
+	}
+
+	// Power iteration starting from the largest variance channel
+	float fcov[6];
+	for (int i = 0; i < 6; i++)
+		fcov[i] = (float)cov[i];
+	float axis[3];
+	if (cov[0] >= cov[3] && cov[0] >= cov[5]) {
+		axis[0] = fcov[0]; axis[1] = fcov[1]; axis[2] = fcov[2];
+	} else if (cov[3] >= cov[5]) {
+		axis[0] = fcov[1]; axis[1] = fcov[3]; axis[2] = fcov[4];
+	} else {
+		axis[0] = fcov[2]; axis[1] = fcov[4]; axis[2] = fcov[5];
+	}
+	for (int iter = 0; iter < 3; iter++) {
+		float x = axis[0] * fcov[0] + axis[1] * fcov[1] + axis[2] * fcov[2];
+		float y = axis[0] * fcov[1] + axis[1] * fcov[3] + axis[2] * fcov[4];
+		float z = axis[0] * fcov[2] + axis[1] * fcov[4] + axis[2] * fcov[5];
+		float m = fmaxf(fabsf(x), fmaxf(fabsf(y), fabsf(z)));
+		if (m < 1e-8f)
+			break;
+		m = 1.0f / m;
+		axis[0] = x * m;
+		axis[1] = y * m;
+		axis[2] = z * m;
+		if (iter == 2) {
+			for (int c = 0; c < 3; c++)
+				dir[c] = (int)(axis[c] * 512.0f);
+		}
+	}
+}
+
+// Endpoints from the extreme pixels along the principal axis of the block colors
+static void fit_principal_axis(const dxt_block *blk, const int *mn, const int *mx, const int *sum, uint16_t *c0, uint16_t *c1) {
+	int dir[3] = {299, 587, 114}; // Luminance, used when the colors have no dominant direction
+	if ((mn[0] != mx[0]) + (mn[1] != mx[1]) + (mn[2] != mx[2]) == 1) {
+		// The only channel with some variance is the principal axis
+		for (int c = 0; c < 3; c++)
+			dir[c] = mn[c] != mx[c] ? 512 : 0;
+	} else
+		principal_axis(blk, sum, dir);
+
+	int min_i, max_i;
+	search_endpoints(blk, dir, &min_i, &max_i);
+	*c0 = pack565(blk->r[max_i], blk->g[max_i], blk->b[max_i]);
+	*c1 = pack565(blk->r[min_i], blk->g[min_i], blk->b[min_i]);
+}
+
+// Orders endpoints for 4 colors mode and computes the indices for them
+static uint32_t finalize_color(const dxt_block *blk, uint16_t *c0, uint16_t *c1, uint8_t *idx, int nearest) {
+	if (*c0 < *c1) {
+		uint16_t t = *c0;
+		*c0 = *c1;
+		*c1 = t;
+	}
+	int pal[4][3];
+	palette_from_endpoints(*c0, *c1, pal);
+	if (*c0 == *c1) {
+		memset(idx, 0, 16);
+		if (!nearest)
+			return 0;
+		// Every palette entry is the same color
+		uint32_t total = 0;
+		for (int i = 0; i < 16; i++) {
+			int dr = blk->r[i] - pal[0][0];
+			int dg = blk->g[i] - pal[0][1];
+			int db = blk->b[i] - pal[0][2];
+			total += dr * dr + dg * dg + db * db;
+		}
+		return total;
+	}
+	if (nearest)
+		return match_nearest(blk, pal, idx);
+	match_projected(blk, pal, idx);
+	return 0;
+}
+
+// Endpoints whose interpolation gets the closest to a single color
+static void fit_single_color(int r, int g, int b, uint16_t *c0, uint16_t *c1) {
+	*c0 = (single_match5[r][0] << 11) | (single_match6[g][0] << 5) | single_match5[b][0];
+	*c1 = (single_match5[r][1] << 11) | (single_match6[g][1] << 5) | single_match5[b][1];
+}
+
+static void compress_color(uint8_t *dst, const dxt_block *blk, dxt_quality quality) {
+	uint16_t c0, c1;
+	uint8_t idx[16];
+	uint32_t mask = 0;
+
+	int mn[3], mx[3], sum[3];
+	channel_range(blk->r, &mn[0], &mx[0], &sum[0]);
+	channel_range(blk->g, &mn[1], &mx[1], &sum[1]);
+	channel_range(blk->b, &mn[2], &mx[2], &sum[2]);
+
+	// Single color blocks use precomputed optimal endpoints
+	if (mn[0] == mx[0] && mn[1] == mx[1] && mn[2] == mx[2]) {
+		fit_single_color(mn[0], mn[1], mn[2], &c0, &c1);
+		if (c0 == c1)
+			mask = 0;
+		else if (c0 > c1)
+			mask = 0xAAAAAAAA;
+		else {
+			uint16_t t = c0;
+			c0 = c1;
+			c1 = t;
+			mask = 0xFFFFFFFF;
+		}
+	} else {
+		// Nearly flat blocks may collapse to a single endpoint once quantized, the average color fit is used as fallback for them
+		int avg[3] = {(sum[0] + 8) >> 4, (sum[1] + 8) >> 4, (sum[2] + 8) >> 4};
+		if (quality != DXT_QUALITY_HIGH && pack565(mn[0], mn[1], mn[2]) == pack565(mx[0], mx[1], mx[2])) {
+			// Every pixel quantizes to the same color, so the endpoints fit would collapse anyway
+			fit_single_color(avg[0], avg[1], avg[2], &c0, &c1);
+			finalize_color(blk, &c0, &c1, idx, 1);
+		} else if (quality == DXT_QUALITY_FAST) {
+			fit_bounding_box(blk, mn, mx, sum, &c0, &c1);
+			if (finalize_color(blk, &c0, &c1, idx, 0), c0 == c1) {
+				fit_single_color(avg[0], avg[1], avg[2], &c0, &c1);
+				finalize_color(blk, &c0, &c1, idx, 1);
+			}
+		} else if (quality == DXT_QUALITY_NORMAL) {
+			// Principal axis fit refined once without evaluating errors
+			fit_principal_axis(blk, mn, mx, sum, &c0, &c1);
+			finalize_color(blk, &c0, &c1, idx, 0);
+			uint16_t r0, r1;
+			if (c0 != c1 && refine_endpoints(blk, sum, idx, &r0, &r1) && ((r0 > r1 ? r0 : r1) != c0 || (r0 > r1 ? r1 : r0) != c1)) {
+				c0 = r0;
+				c1 = r1;
+				finalize_color(blk, &c0, &c1, idx, 0);
+			}
+			if (c0 == c1) {
+				fit_single_color(avg[0], avg[1], avg[2], &c0, &c1);
+				finalize_color(blk, &c0, &c1, idx, 1);
+			}
+		} else {
+			fit_principal_axis(blk, mn, mx, sum, &c0, &c1);
+			uint32_t err = finalize_color(blk, &c0, &c1, idx, 1);
+			uint16_t s0, s1;
+			uint8_t sidx[16];
+			fit_single_color(avg[0], avg[1], avg[2], &s0, &s1);
+			uint32_t serr = finalize_color(blk, &s0, &s1, sidx, 1);
+			if (serr < err) {
+				err = serr;
+				c0 = s0;
+				c1 = s1;
+				memcpy(idx, sidx, 16);
+			}
+			for (int s = 0; s < 2 && err; s++) {
+				uint16_t r0, r1;
+				uint8_t ridx[16];
+				if (!refine_endpoints(blk, sum, idx, &r0, &r1))
+					break;
+				// Same endpoints would get the same indices
+				if ((r0 > r1 ? r0 : r1) == c0 && (r0 > r1 ? r1 : r0) == c1)
+					break;
+				uint32_t rerr = finalize_color(blk, &r0, &r1, ridx, 1);
+				if (rerr >= err)
+					break;
+				err = rerr;
+				c0 = r0;
+				c1 = r1;
+				memcpy(idx, ridx, 16);
+			}
+		}
+		for (int i = 15; i >= 0; i--)
+			mask = (mask << 2) | idx[i];
+	}
+
+	dst[0] = c0 & 0xFF;
+	dst[1] = c0 >> 8;
+	dst[2] = c1 & 0xFF;
+	dst[3] = c1 >> 8;
+	dst[4] = mask & 0xFF;
+	dst[5] = (mask >> 8) & 0xFF;
+	dst[6] = (mask >> 16) & 0xFF;
+	dst[7] = mask >> 24;
+}
+
+static void compress_alpha(uint8_t *dst, const dxt_block *blk) {
+	int mn, mx, sum;
+	channel_range(blk->a, &mn, &mx, &sum);
+	dst[0] = mx;
+	dst[1] = mn;
+
+	// 8 alpha values mode, indices 0 and 1 are the endpoints and 2-7 are interpolated from first to second
+	uint64_t bits = 0;
+	int range = mx - mn;
+	if (range) {
+		// Dividing by 2 * range through its reciprocal, exact since dividends times divisor stay below 2^21
+		uint32_t recip = ((1 << 21) + 2 * range - 1) / (2 * range);
+		for (int i = 15; i >= 0; i--) {
+			int k = (((blk->a[i] - mn) * 14 + range) * recip) >> 21;
+			int code = k == 7 ? 0 : (k == 0 ? 1 : 8 - k);
+			bits = (bits << 3) | code;
+		}
+	}
+	for (int i = 0; i < 6; i++)
+		dst[2 + i] = (bits >> (8 * i)) & 0xFF;
+}
+
+static void compress_block(uint8_t *dst, const dxt_block *blk, int isdxt5, dxt_quality quality) {
+	if (isdxt5) {
+		compress_alpha(dst, blk);
+		dst += 8;
+	}
+	compress_color(dst, blk, quality);
+}
+
+void dxt_compress_block(uint8_t *dst, const uint8_t *block, int isdxt5, dxt_quality quality) {
+	dxt_block blk;
+	init_tables();
+	for (int i = 0; i < 16; i++) {
+		blk.r[i] = block[i * 4];
+		blk.g[i] = block[i * 4 + 1];
+		blk.b[i] = block[i * 4 + 2];
+		blk.a[i] = block[i * 4 + 3];
+	}
+	compress_block(dst, &blk, isdxt5, quality);
+}
+
+static inline uint32_t spread_bits(uint32_t v) {
+	v &= 0x0000FFFF;
+	v = (v | (v << 8)) & 0x00FF00FF;
+	v = (v | (v << 4)) & 0x0F0F0F0F;
+	v = (v | (v << 2)) & 0x33333333;
+	v = (v | (v << 1)) & 0x55555555;
+	return v;
+}
+
+// Blocks are stored in morton order over the smaller side with the leftover bits of the bigger one on top
+static inline uint32_t swizzled_block_index(uint32_t x, uint32_t y, uint32_t bits) {
+	uint32_t low_mask = (1u << bits) - 1;
+	uint32_t idx = spread_bits(y & low_mask) | (spread_bits(x & low_mask) << 1);
+	return idx | (((x | y) >> bits) << (2 * bits));
+}
+
+static inline uint32_t swizzle_bits(uint32_t w, uint32_t h) {
+	uint32_t min_side = w < h ? w : h;
+	uint32_t bits = 0;
+	while ((1u << bits) < min_side)
+		bits++;
+	return bits;
+}
+
+uint32_t dxt_swizzled_block_index(uint32_t x, uint32_t y, uint32_t w, uint32_t h) {
+	return swizzled_block_index(x, y, swizzle_bits(w, h));
+}
+
+// Compression job shared with workers
+static struct {
+	uint8_t *dst;
+	const uint8_t *src;
+	int src_w;
+	int src_h;
+	uint32_t blocks_w;
+	uint32_t blocks_h;
+	uint32_t bits; // Morton order bits of the destination
+	int isdxt5;
+	dxt_quality quality;
+	volatile int next_row;
+} job;
+
+static void compress_rows(void) {
+	const uint32_t block_size = job.isdxt5 ? 16 : 8;
+	dxt_block blk;
+	for (;;) {
+		uint32_t by = __sync_fetch_and_add(&job.next_row, 1);
+		if (by >= job.blocks_h)
+			break;
+		for (uint32_t bx = 0; bx < job.blocks_w; bx++) {
+			if (bx * 4 + 4 <= job.src_w && by * 4 + 4 <= job.src_h) {
+				const uint8_t *texel = job.src + (by * 4 * job.src_w + bx * 4) * 4;
+				for (int j = 0; j < 4; j++) {
+					for (int i = 0; i < 4; i++) {
+						blk.r[j * 4 + i] = texel[i * 4];
+						blk.g[j * 4 + i] = texel[i * 4 + 1];
+						blk.b[j * 4 + i] = texel[i * 4 + 2];
+					}
+					if (job.isdxt5) {
+						for (int i = 0; i < 4; i++)
+							blk.a[j * 4 + i] = texel[i * 4 + 3];
+					}
+					texel += job.src_w * 4;
+				}
+			} else {
+				// Texels past source size replicate its edges
+				for (int j = 0; j < 4; j++) {
+					int y = by * 4 + j;
+					y = y < job.src_h ? y : job.src_h - 1;
+					const uint8_t *row = job.src + y * job.src_w * 4;
+					for (int i = 0; i < 4; i++) {
+						int x = bx * 4 + i;
+						x = x < job.src_w ? x : job.src_w - 1;
+						blk.r[j * 4 + i] = row[x * 4];
+						blk.g[j * 4 + i] = row[x * 4 + 1];
+						blk.b[j * 4 + i] = row[x * 4 + 2];
+						blk.a[j * 4 + i] = row[x * 4 + 3];
+					}
+				}
+			}
+			compress_block(job.dst + swizzled_block_index(bx, by, job.bits) * block_size, &blk, job.isdxt5, job.quality);
+		}
+	}
+}
+
+static worker_thread workers[DXT_MAX_WORKERS];
+static int workers_num = 0;
+static worker_sema start_sema;
+static worker_sema done_sema;
+static worker_mutex job_mutex;
+static volatile int workers_running = 0;
+
+#ifdef __vita__
+static int dxt_worker(SceSize args, void *argp) {
+#else
+static void *dxt_worker(void *argp) {
+#endif
+	for (;;) {
+		sema_wait(start_sema);
+		if (!workers_running)
+			break;
+		compress_rows();
+		sema_signal(done_sema);
+	}
+#ifdef __vita__
+	return sceKernelExitDeleteThread(0);
+#else
+	return NULL;
+#endif
+}
+
+int dxt_workers_init(int num, int priority, int affinity) {
+	dxt_workers_term();
+	if (num > DXT_MAX_WORKERS)
+		num = DXT_MAX_WORKERS;
+	if (num <= 0)
+		return 1;
+
+	sema_create(start_sema);
+	sema_create(done_sema);
+	mutex_create(job_mutex);
+	workers_running = 1;
+	for (workers_num = 0; workers_num < num; workers_num++) {
+#ifdef __vita__
+		workers[workers_num] = sceKernelCreateThread("Texture Compressor", &dxt_worker, priority, 0x10000, 0, affinity, NULL);
+		if (workers[workers_num] < 0)
+			break;
+		sceKernelStartThread(workers[workers_num], 0, NULL);
+#else
+		if (pthread_create(&workers[workers_num], NULL, dxt_worker, NULL))
+			break;
+#endif
+	}
+	return workers_num > 0;
+}
+
+void dxt_workers_term(void) {
+	if (!workers_running)
+		return;
+	workers_running = 0;
+	for (int i = 0; i < workers_num; i++)
+		sema_signal(start_sema);
+#ifdef __vita__
+	for (int i = 0; i < workers_num; i++)
+		sceKernelWaitThreadEnd(workers[i], NULL, NULL);
+#else
+	for (int i = 0; i < workers_num; i++)
+		pthread_join(workers[i], NULL);
+#endif
+	workers_num = 0;
+	sema_destroy(start_sema);
+	sema_destroy(done_sema);
+	mutex_destroy(job_mutex);
+}
+
+void dxt_compress_swizzled(uint8_t *dst, const uint8_t *src, int src_w, int src_h, int w, int h, int isdxt5, dxt_quality quality) {
+	init_tables();
+	int threaded = workers_running;
+	if (threaded)
+		mutex_lock(job_mutex);
+
+	job.dst = dst;
+	job.src = src;
+	job.src_w = src_w;
+	job.src_h = src_h;
+	job.blocks_w = (w + 3) / 4;
+	job.blocks_h = (h + 3) / 4;
+	job.bits = swizzle_bits(job.blocks_w, job.blocks_h);
+	job.isdxt5 = isdxt5;
+	job.quality = quality;
+	job.next_row = 0;
+
+	// Block rows are distributed among workers and the calling thread
+	int helpers = 0;
+	if (threaded) {
+		helpers = workers_num < (int)job.blocks_h - 1 ? workers_num : (int)job.blocks_h - 1;
+		__sync_synchronize();
+		for (int i = 0; i < helpers; i++)
+			sema_signal(start_sema);
+	}
+	compress_rows();
+	for (int i = 0; i < helpers; i++)
+		sema_wait(done_sema);
+
+	if (threaded)
+		mutex_unlock(job_mutex);
+}
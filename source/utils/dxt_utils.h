@@ -0,0 +1,45 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * dxt_utils.h:
+ * Header file for the DXT texture compression utilities exposed by dxt_utils.c
+ */
+
+#ifndef _DXT_UTILS_H_
+#define _DXT_UTILS_H_
+
+#include <stdint.h>
+
+#define DXT_MAX_WORKERS 4 // Maximum number of worker threads for texture compression
+#define DXT_DEF_WORKERS 2 // Default number of worker threads, together with the calling thread they cover the three user cores
+
+// Compression quality levels
+typedef enum {
+	DXT_QUALITY_FAST, // Range fit over the colors bounding box
+	DXT_QUALITY_NORMAL, // Principal axis fit with one least squares refinement step and projected indices
+	DXT_QUALITY_HIGH // Principal axis fit with up to two error checked refinement steps and nearest indices
+} dxt_quality;
+
+int dxt_workers_init(int num, int priority, int affinity);
+void dxt_workers_term(void);
+void dxt_compress_block(uint8_t *dst, const uint8_t *block, int isdxt5, dxt_quality quality);
+void dxt_compress_swizzled(uint8_t *dst, const uint8_t *src, int src_w, int src_h, int w, int h, int isdxt5, dxt_quality quality);
+uint32_t dxt_swizzled_block_index(uint32_t x, uint32_t y, uint32_t w, uint32_t h);
+
+#endif
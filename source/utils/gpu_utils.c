@@ -23,9 +23,6 @@
 
 #include "../shared.h"
 
-#define STB_DXT_IMPLEMENTATION
-#include "stb_dxt.h"
-
 #ifndef MAX
 #define MAX(a, b) (((a) < (b)) ? (b) : (a))
 #endif
@@ -37,6 +34,11 @@ uint8_t use_vram_for_usse = GL_FALSE;
 // Newlib mempool usage setting
 GLboolean use_extra_mem = GL_TRUE;
 
+// Streaming rings for per-scene GPU data
+#define STREAM_RING_DEF_SIZE (4 * 1024 * 1024) // Default size in bytes for a streaming ring
+static stream_pool gpu_stream;
+static volatile uint32_t *gpu_stream_completed_seq = NULL; // Sequence number of the last scene completed by the GPU
+
 // Taken from here: https://graphics.stanford.edu/~seander/bithacks.html#RoundUpPowerOf2
 uint32_t nearest_po2(uint32_t val) {
 	val--;
@@ -65,31 +67,6 @@ void d2xy_morton(uint64_t d, uint64_t *x, uint64_t *y) {
 	*y = morton_1(d >> 1);
 }
 
-void extract_block(const uint8_t *src, int width, uint8_t *block) {
-	int j;
-	for (j = 0; j < 4; j++) {
-		vgl_fast_memcpy(&block[j * 4 * 4], src, 16);
-		src += width * 4;
-	}
-}
-
-void dxt_compress(uint8_t *dst, uint8_t *src, int w, int h, int isdxt5) {
-	uint8_t block[64];
-	int s = MAX(w, h);
-	uint32_t num_blocks = (s * s) / 16;
-	uint64_t d, offs_x, offs_y;
-	for (d = 0; d < num_blocks; d++) {
-		d2xy_morton(d, &offs_x, &offs_y);
-		if (offs_x * 4 >= h)
-			continue;
-		if (offs_y * 4 >= w)
-			continue;
-		extract_block(src + offs_y * 16 + offs_x * w * 16, w, block);
-		stb_compress_dxt_block(dst, block, isdxt5, fast_texture_compression ? STB_DXT_NORMAL : STB_DXT_HIGHQUAL);
-		dst += isdxt5 ? 16 : 8;
-	}
-}
-
 enum {
 	SWIZZLER_DEFAULT = 0x00,
 	SWIZZLER_LARGE_BLOCK = 0x01,
@@ -179,7 +156,7 @@ void *gpu_alloc_mapped_aligned_unsafe(size_t alignment, size_t size, vglMemType
 		res = vgl_memalign(alignment, size, VGL_MEM_EXTERNAL);
 
 	// Iterating for as many as possible max pending garbage collector cycles
-	if (!res && unsafe_allocator_counter < FRAME_PURGE_FREQ)
+	if (!res && unsafe_allocator_counter < GC_MAX_PENDING_REQUESTS)
 		res = gpu_alloc_mapped_aligned_unsafe(alignment, size, type);
 	
 	return res;
@@ -288,6 +265,64 @@ void *gpu_alloc_mapped_temp(size_t size) {
 #endif
 }
 
+void gpu_stream_init(volatile uint32_t *completed_seq) {
+	stream_pool_init(&gpu_stream);
+	gpu_stream_completed_seq = completed_seq;
+
+	// The overflow ring is allocated only once the primary one happens to be too small
+	stream_ring_init(&gpu_stream.rings[0], gpu_alloc_mapped(STREAM_RING_DEF_SIZE, use_vram ? VGL_MEM_VRAM : VGL_MEM_RAM), STREAM_RING_DEF_SIZE);
+}
+
+void gpu_stream_term(void) {
+	for (int i = 0; i < STREAM_RINGS_NUM; i++) {
+		if (gpu_stream.rings[i].base)
+			vgl_free(gpu_stream.rings[i].base);
+	}
+	stream_pool_init(&gpu_stream);
+	gpu_stream_completed_seq = NULL;
+}
+
+void gpu_stream_fence(uint32_t seq) {
+	stream_pool_fence(&gpu_stream, seq);
+	stream_pool_retire(&gpu_stream, *gpu_stream_completed_seq);
+}
+
+void *gpu_alloc_stream(size_t size) {
+	if (!gpu_stream_completed_seq)
+		return gpu_alloc_mapped_temp(size);
+	void *res = stream_pool_alloc(&gpu_stream, size);
+	if (!res) {
+		// Reclaiming the space of the scenes completed in the meantime
+		stream_pool_retire(&gpu_stream, *gpu_stream_completed_seq);
+		res = stream_pool_alloc(&gpu_stream, size);
+		if (!res && !gpu_stream.rings[STREAM_RINGS_NUM - 1].base) {
+			uint32_t ring_size = MAX(STREAM_RING_DEF_SIZE, ALIGN(size, STREAM_ALIGNMENT));
+			void *base = gpu_alloc_mapped(ring_size, use_vram ? VGL_MEM_VRAM : VGL_MEM_RAM);
+			if (base) {
+				stream_ring_init(&gpu_stream.rings[STREAM_RINGS_NUM - 1], base, ring_size);
+				res = stream_pool_alloc(&gpu_stream, size);
+			}
+		}
+
+		// Falling back to garbage collected memory if every ring is still in use by the GPU
+		if (!res)
+			res = gpu_alloc_mapped_temp(size);
+	}
+	return res;
+}
+
+void *gpu_stream_client_array(const void *src, uint32_t stride, uint32_t count) {
+	stream_cache_entry *slot;
+	void *res = stream_pool_lookup(&gpu_stream, src, stride, count, &slot);
+	if (res)
+		return res;
+	uint32_t size = stride * count;
+	res = gpu_alloc_stream(size);
+	vgl_fast_memcpy(res, src, size);
+	stream_pool_store(&gpu_stream, slot, src, stride, count, res);
+	return res;
+}
+
 int tex_format_to_bytespp(SceGxmTextureFormat format) {
 	// Calculating bpp for the requested texture format
 	switch (format & 0x9F000000) {
@@ -379,6 +414,7 @@ void gpu_free_texture(texture *tex) {
 }
 
 void gpu_alloc_cube_texture(uint32_t w, uint32_t h, SceGxmTextureFormat format, SceGxmTransferFormat src_format, const void *data, texture *tex, uint8_t src_bpp, int index) {
+	PROFILE_ZONE(ALLOC_CUBE_TEXTURE);
 	// If there's already a texture in passed texture object we first dealloc it
 	if (tex->status == TEX_VALID && tex->faces_counter >= 6) {
 		gpu_free_texture_data(tex);
@@ -422,6 +458,7 @@ void gpu_alloc_cube_texture(uint32_t w, uint32_t h, SceGxmTextureFormat format,
 }
 
 void gpu_alloc_texture(uint32_t w, uint32_t h, SceGxmTextureFormat format, const void *data, texture *tex, uint8_t src_bpp, uint32_t (*read_cb)(void *), void (*write_cb)(void *, uint32_t), GLboolean fast_store) {
+	PROFILE_ZONE(ALLOC_TEXTURE);
 	// If there's already a texture in passed texture object we first dealloc it
 	if (tex->status == TEX_VALID)
 		gpu_free_texture_data(tex);
@@ -452,13 +489,23 @@ void gpu_alloc_texture(uint32_t w, uint32_t h, SceGxmTextureFormat format, const
 					}
 				}
 			} else { // Different internal and data formats, we need to go with slower callbacks system
-				for (i = 0; i < h; i++) {
-					dst = ((uint8_t *)texture_data) + (ALIGN(w, 8) * bpp) * i;
-					for (j = 0; j < w; j++) {
-						uint32_t clr = read_cb(src);
-						write_cb(dst, clr);
-						src += src_bpp;
-						dst += bpp;
+				pixel_row_cb convert_row = getRowConverter(read_cb, write_cb);
+				if (convert_row) {
+					uint32_t line_size = w * src_bpp;
+					for (i = 0; i < h; i++) {
+						dst = ((uint8_t *)texture_data) + (ALIGN(w, 8) * bpp) * i;
+						convert_row(dst, src, w);
+						src += line_size;
+					}
+				} else {
+					for (i = 0; i < h; i++) {
+						dst = ((uint8_t *)texture_data) + (ALIGN(w, 8) * bpp) * i;
+						for (j = 0; j < w; j++) {
+							uint32_t clr = read_cb(src);
+							write_cb(dst, clr);
+							src += src_bpp;
+							dst += bpp;
+						}
 					}
 				}
 			}
@@ -478,6 +525,7 @@ void gpu_alloc_texture(uint32_t w, uint32_t h, SceGxmTextureFormat format, const
 }
 
 void gpu_alloc_paletted_texture(int32_t level, uint32_t w, uint32_t h, SceGxmTextureFormat format, const void *data, texture *tex, uint8_t src_bpp, uint32_t (*read_cb)(void *)) {
+	PROFILE_ZONE(ALLOC_PALETTED_TEXTURE);
 	// If there's already a texture in passed texture object we first dealloc it
 	if (tex->status == TEX_VALID)
 		gpu_free_texture_data(tex);
@@ -566,7 +614,8 @@ int gpu_get_compressed_mip_offset(int level, int width, int height, SceGxmTextur
 	return gpu_get_compressed_mipchain_size(level - 1, width, height, format);
 }
 
-void gpu_alloc_compressed_texture(int32_t mip_level, uint32_t w, uint32_t h, SceGxmTextureFormat format, uint32_t image_size, const void *data, texture *tex, uint8_t src_bpp, uint32_t (*read_cb)(void *)) {
+void gpu_alloc_compressed_texture(int32_t mip_level, uint32_t w, uint32_t h, SceGxmTextureFormat format, uint32_t image_size, const void *data, texture *tex, uint8_t src_bpp, uint32_t (*read_cb)(void *), transcode_fmt transcode) {
+	PROFILE_ZONE(ALLOC_COMPRESSED_TEXTURE);
 	// If there's already a texture in passed texture object we first dealloc it
 	if (tex->status == TEX_VALID && !mip_level)
 		gpu_free_texture_data(tex);
@@ -635,26 +684,34 @@ void gpu_alloc_compressed_texture(int32_t mip_level, uint32_t w, uint32_t h, Sce
 			if (read_cb != NULL) {
 				void *temp = (void *)data;
 
-				// stb_dxt expects input as RGBA8888, so we convert input texture if necessary
+				// DXT compressor expects input as RGBA8888, so we convert input texture if necessary
 				if (read_cb != readRGBA) {
 					temp = vgl_malloc(w * h * 4, VGL_MEM_EXTERNAL);
-					uint8_t *src = (uint8_t *)data;
-					uint32_t *dst = (uint32_t *)temp;
-					int i;
-					for (i = 0; i < w * h; i++) {
-						uint32_t clr = read_cb(src);
-						writeRGBA(dst++, clr);
-						src += src_bpp;
+					pixel_row_cb convert_row = getRowConverter(read_cb, writeRGBA);
+					if (convert_row)
+						convert_row(temp, data, w * h);
+					else {
+						uint8_t *src = (uint8_t *)data;
+						uint32_t *dst = (uint32_t *)temp;
+						int i;
+						for (i = 0; i < w * h; i++) {
+							uint32_t clr = read_cb(src);
+							writeRGBA(dst++, clr);
+							src += src_bpp;
+						}
 					}
 				}
 
 				// Performing swizzling and DXT compression
 				uint8_t alignment = tex_format_to_alignment(format);
-				dxt_compress(mip_data, temp, aligned_width, aligned_height, alignment == 16);
+				dxt_compress_swizzled(mip_data, temp, w, h, aligned_width, aligned_height, alignment == 16, texture_compression_quality);
 
 				// Freeing temporary data if necessary
 				if (read_cb != readRGBA)
 					vgl_free(temp);
+			} else if (transcode != TRANSCODE_NONE) {
+				// Transcoding block by block straight into the swizzled layout
+				transcode_swizzled(mip_data, data, w, h, aligned_width, aligned_height, transcode, texture_compression_quality);
 			} else {
 				// Perform swizzling if necessary.
 				switch (format) {
@@ -693,6 +750,7 @@ void gpu_alloc_compressed_texture(int32_t mip_level, uint32_t w, uint32_t h, Sce
 }
 
 void gpu_alloc_mipmaps(int level, texture *tex) {
+	PROFILE_ZONE(ALLOC_MIPMAPS);
 	// Getting current mipmap count in passed texture
 	uint32_t count = tex->mip_count - 1;
 
@@ -25,6 +25,8 @@
 #define _GPU_UTILS_H_
 
 #include "mem_utils.h"
+#include "stream_utils.h"
+#include "transcode_utils.h"
 
 // Align a value to the requested alignment
 #define ALIGN(x, a) (((x) + ((a)-1)) & ~((a)-1))
@@ -60,12 +62,30 @@ typedef struct {
 #endif
 } texture;
 
+// Rounds a value up to the nearest power of two
+uint32_t nearest_po2(uint32_t val);
+
 // Alloc a generic memblock into sceGxm mapped memory
 void *gpu_alloc_mapped(size_t size, vglMemType type);
 
 // Alloc a generic memblock into sceGxm mapped memory and marks it for garbage collection
 void *gpu_alloc_mapped_temp(size_t size);
 
+// Inits the streaming rings used for per-scene GPU data
+void gpu_stream_init(volatile uint32_t *completed_seq);
+
+// Releases the streaming rings memory
+void gpu_stream_term(void);
+
+// Closes the streamed data allocated for the scene with the given sequence number
+void gpu_stream_fence(uint32_t seq);
+
+// Alloc a generic memblock into sceGxm mapped memory valid until the current scene completes
+void *gpu_alloc_stream(size_t size);
+
+// Copy a client array into sceGxm mapped memory, reusing a copy done in the same scene if possible
+void *gpu_stream_client_array(const void *src, uint32_t stride, uint32_t count);
+
 // Alloc a generic memblock into sceGxm mapped memory with a given alignment
 void *gpu_alloc_mapped_aligned(size_t alignment, size_t size, vglMemType type);
 
@@ -91,7 +111,7 @@ void gpu_alloc_texture(uint32_t w, uint32_t h, SceGxmTextureFormat format, const
 void gpu_alloc_cube_texture(uint32_t w, uint32_t h, SceGxmTextureFormat format, SceGxmTransferFormat src_format, const void *data, texture *tex, uint8_t src_bpp, int index);
 
 // Alloc a compresseed texture
-void gpu_alloc_compressed_texture(int32_t level, uint32_t w, uint32_t h, SceGxmTextureFormat format, uint32_t image_size, const void *data, texture *tex, uint8_t src_bpp, uint32_t (*read_cb)(void *));
+void gpu_alloc_compressed_texture(int32_t level, uint32_t w, uint32_t h, SceGxmTextureFormat format, uint32_t image_size, const void *data, texture *tex, uint8_t src_bpp, uint32_t (*read_cb)(void *), transcode_fmt transcode);
 
 // Alloc a paletted texture
 void gpu_alloc_paletted_texture(int32_t level, uint32_t w, uint32_t h, SceGxmTextureFormat format, const void *data, texture *tex, uint8_t src_bpp, uint32_t (*read_cb)(void *));
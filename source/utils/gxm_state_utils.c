@@ -0,0 +1,260 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * gxm_state_utils.c:
+ * Shadowing of the sceGxm context state to coalesce state changes and skip redundant ones
+ */
+
+#include "../shared.h"
+
+#define GXM_STATE_MAX_WORDS 6 // Maximum number of words a state value is made of
+
+// Shadowed states, front/back ones use two consecutive dirty/valid bits
+typedef enum {
+	GXM_STATE_DEPTH_FUNC,
+	GXM_STATE_DEPTH_WRITE_ENABLE,
+	GXM_STATE_STENCIL_FUNC,
+	GXM_STATE_STENCIL_REF,
+	GXM_STATE_POLYGON_MODE,
+	GXM_STATE_DEPTH_BIAS,
+	GXM_STATE_FRAGMENT_PROGRAM_ENABLE,
+	GXM_STATE_POINT_LINE_WIDTH,
+	GXM_STATE_CULL_MODE,
+	GXM_STATE_TWO_SIDED_ENABLE,
+	GXM_STATE_REGION_CLIP,
+	GXM_STATE_VIEWPORT,
+	GXM_STATES_NUM
+} gxm_state;
+
+typedef union {
+	uint32_t u;
+	int32_t i;
+	float f;
+} gxm_state_word;
+
+static const uint8_t state_words[GXM_STATES_NUM] = {
+	1, // GXM_STATE_DEPTH_FUNC
+	1, // GXM_STATE_DEPTH_WRITE_ENABLE
+	6, // GXM_STATE_STENCIL_FUNC
+	1, // GXM_STATE_STENCIL_REF
+	1, // GXM_STATE_POLYGON_MODE
+	2, // GXM_STATE_DEPTH_BIAS
+	1, // GXM_STATE_FRAGMENT_PROGRAM_ENABLE
+	1, // GXM_STATE_POINT_LINE_WIDTH
+	1, // GXM_STATE_CULL_MODE
+	1, // GXM_STATE_TWO_SIDED_ENABLE
+	5, // GXM_STATE_REGION_CLIP
+	6 // GXM_STATE_VIEWPORT
+};
+
+// sceGxm resets viewport and region clip at every scene start
+#define GXM_SCENE_STATES_MASK ((1 << (GXM_STATE_REGION_CLIP * 2)) | (1 << (GXM_STATE_VIEWPORT * 2)))
+
+static gxm_state_word pending[GXM_STATES_NUM][2][GXM_STATE_MAX_WORDS]; // Last requested values
+static gxm_state_word submitted[GXM_STATES_NUM][2][GXM_STATE_MAX_WORDS]; // Values sceGxm currently has
+uint32_t gxm_state_dirty_mask = 0; // States whose requested value has not been flushed yet
+static uint32_t valid_mask = 0; // States whose value in sceGxm is known
+static vglStateStats state_stats;
+
+static void set_state(gxm_state id, int sides, const gxm_state_word *words) {
+	for (int side = 0; side < 2; side++) {
+		if (!(sides & (1 << side)))
+			continue;
+		uint32_t bit = 1 << (id * 2 + side);
+
+		// A value overwritten before reaching sceGxm is a skipped state change
+		if (gxm_state_dirty_mask & bit)
+			state_stats.skipped++;
+		for (int i = 0; i < state_words[id]; i++) {
+			pending[id][side][i] = words[i];
+		}
+		gxm_state_dirty_mask |= bit;
+	}
+}
+
+static void submit_state(gxm_state id, int side, const gxm_state_word *w) {
+	switch (id) {
+	case GXM_STATE_DEPTH_FUNC:
+		if (side)
+			sceGxmSetBackDepthFunc(gxm_context, w[0].u);
+		else
+			sceGxmSetFrontDepthFunc(gxm_context, w[0].u);
+		break;
+	case GXM_STATE_DEPTH_WRITE_ENABLE:
+		if (side)
+			sceGxmSetBackDepthWriteEnable(gxm_context, w[0].u);
+		else
+			sceGxmSetFrontDepthWriteEnable(gxm_context, w[0].u);
+		break;
+	case GXM_STATE_STENCIL_FUNC:
+		if (side)
+			sceGxmSetBackStencilFunc(gxm_context, w[0].u, w[1].u, w[2].u, w[3].u, w[4].u, w[5].u);
+		else
+			sceGxmSetFrontStencilFunc(gxm_context, w[0].u, w[1].u, w[2].u, w[3].u, w[4].u, w[5].u);
+		break;
+	case GXM_STATE_STENCIL_REF:
+		if (side)
+			sceGxmSetBackStencilRef(gxm_context, w[0].u);
+		else
+			sceGxmSetFrontStencilRef(gxm_context, w[0].u);
+		break;
+	case GXM_STATE_POLYGON_MODE:
+		if (side)
+			sceGxmSetBackPolygonMode(gxm_context, w[0].u);
+		else
+			sceGxmSetFrontPolygonMode(gxm_context, w[0].u);
+		break;
+	case GXM_STATE_DEPTH_BIAS:
+		if (side)
+			sceGxmSetBackDepthBias(gxm_context, w[0].i, w[1].i);
+		else
+			sceGxmSetFrontDepthBias(gxm_context, w[0].i, w[1].i);
+		break;
+	case GXM_STATE_FRAGMENT_PROGRAM_ENABLE:
+		if (side)
+			sceGxmSetBackFragmentProgramEnable(gxm_context, w[0].u);
+		else
+			sceGxmSetFrontFragmentProgramEnable(gxm_context, w[0].u);
+		break;
+	case GXM_STATE_POINT_LINE_WIDTH:
+		if (side)
+			sceGxmSetBackPointLineWidth(gxm_context, w[0].u);
+		else
+			sceGxmSetFrontPointLineWidth(gxm_context, w[0].u);
+		break;
+	case GXM_STATE_CULL_MODE:
+		sceGxmSetCullMode(gxm_context, w[0].u);
+		break;
+	case GXM_STATE_TWO_SIDED_ENABLE:
+		sceGxmSetTwoSidedEnable(gxm_context, w[0].u);
+		break;
+	case GXM_STATE_REGION_CLIP:
+		sceGxmSetRegionClip(gxm_context, w[0].u, w[1].u, w[2].u, w[3].u, w[4].u);
+		break;
+	case GXM_STATE_VIEWPORT:
+		setViewport(gxm_context, w[0].f, w[1].f, w[2].f, w[3].f, w[4].f, w[5].f);
+		break;
+	default:
+		break;
+	}
+}
+
+void set_gxm_depth_func(int sides, SceGxmDepthFunc func) {
+	gxm_state_word w[1] = {{.u = func}};
+	set_state(GXM_STATE_DEPTH_FUNC, sides, w);
+}
+
+void set_gxm_depth_write_enable(int sides, SceGxmDepthWriteMode mode) {
+	gxm_state_word w[1] = {{.u = mode}};
+	set_state(GXM_STATE_DEPTH_WRITE_ENABLE, sides, w);
+}
+
+void set_gxm_stencil_func(int sides, SceGxmStencilFunc func, SceGxmStencilOp stencil_fail, SceGxmStencilOp depth_fail, SceGxmStencilOp depth_pass, uint8_t compare_mask, uint8_t write_mask) {
+	gxm_state_word w[6] = {{.u = func}, {.u = stencil_fail}, {.u = depth_fail}, {.u = depth_pass}, {.u = compare_mask}, {.u = write_mask}};
+	set_state(GXM_STATE_STENCIL_FUNC, sides, w);
+}
+
+void set_gxm_stencil_ref(int sides, uint32_t ref) {
+	gxm_state_word w[1] = {{.u = ref}};
+	set_state(GXM_STATE_STENCIL_REF, sides, w);
+}
+
+void set_gxm_polygon_mode(int sides, SceGxmPolygonMode mode) {
+	gxm_state_word w[1] = {{.u = mode}};
+	set_state(GXM_STATE_POLYGON_MODE, sides, w);
+}
+
+void set_gxm_depth_bias(int sides, int factor, int units) {
+	gxm_state_word w[2] = {{.i = factor}, {.i = units}};
+	set_state(GXM_STATE_DEPTH_BIAS, sides, w);
+}
+
+void set_gxm_fragment_program_enable(int sides, SceGxmFragmentProgramMode mode) {
+	gxm_state_word w[1] = {{.u = mode}};
+	set_state(GXM_STATE_FRAGMENT_PROGRAM_ENABLE, sides, w);
+}
+
+void set_gxm_point_line_width(int sides, uint32_t width) {
+	gxm_state_word w[1] = {{.u = width}};
+	set_state(GXM_STATE_POINT_LINE_WIDTH, sides, w);
+}
+
+void set_gxm_cull_mode(SceGxmCullMode mode) {
+	gxm_state_word w[1] = {{.u = mode}};
+	set_state(GXM_STATE_CULL_MODE, GXM_SIDE_FRONT, w);
+}
+
+void set_gxm_two_sided_enable(SceGxmTwoSidedMode mode) {
+	gxm_state_word w[1] = {{.u = mode}};
+	set_state(GXM_STATE_TWO_SIDED_ENABLE, GXM_SIDE_FRONT, w);
+}
+
+void set_gxm_region_clip(SceGxmRegionClipMode mode, uint32_t x_min, uint32_t y_min, uint32_t x_max, uint32_t y_max) {
+	gxm_state_word w[5] = {{.u = mode}, {.u = x_min}, {.u = y_min}, {.u = x_max}, {.u = y_max}};
+	set_state(GXM_STATE_REGION_CLIP, GXM_SIDE_FRONT, w);
+}
+
+void set_gxm_viewport(float x_offset, float x_scale, float y_offset, float y_scale, float z_offset, float z_scale) {
+	gxm_state_word w[6] = {{.f = x_offset}, {.f = x_scale}, {.f = y_offset}, {.f = y_scale}, {.f = z_offset}, {.f = z_scale}};
+	set_state(GXM_STATE_VIEWPORT, GXM_SIDE_FRONT, w);
+}
+
+void submit_gxm_state(void) {
+	while (gxm_state_dirty_mask) {
+		int bit = __builtin_ctz(gxm_state_dirty_mask);
+		gxm_state_dirty_mask &= gxm_state_dirty_mask - 1;
+		gxm_state id = bit >> 1;
+		int side = bit & 1;
+		gxm_state_word *p = pending[id][side];
+		gxm_state_word *s = submitted[id][side];
+
+		// Values are compared bitwise so that viewport floats are sent only if actually changed
+		if (valid_mask & (1 << bit)) {
+			int i;
+			for (i = 0; i < state_words[id]; i++) {
+				if (p[i].u != s[i].u)
+					break;
+			}
+			if (i == state_words[id]) {
+				state_stats.skipped++;
+				continue;
+			}
+		}
+		sceClibMemcpy(s, p, state_words[id] * sizeof(gxm_state_word));
+		valid_mask |= 1 << bit;
+		submit_state(id, side, p);
+		state_stats.issued++;
+	}
+}
+
+void reset_gxm_state(void) {
+	gxm_state_dirty_mask = 0;
+	valid_mask = 0;
+}
+
+void reset_gxm_scene_state(void) {
+	// Changes requested for the previous scene are now meaningless since sceGxm discarded them
+	state_stats.skipped += __builtin_popcount(gxm_state_dirty_mask & GXM_SCENE_STATES_MASK);
+	gxm_state_dirty_mask &= ~GXM_SCENE_STATES_MASK;
+	valid_mask &= ~GXM_SCENE_STATES_MASK;
+}
+
+void vglGetStateStats(vglStateStats *stats) {
+	sceClibMemcpy(stats, &state_stats, sizeof(vglStateStats));
+}
@@ -0,0 +1,63 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * gxm_state_utils.h:
+ * Header file for the sceGxm context state shadowing exposed by gxm_state_utils.c
+ */
+
+#ifndef _GXM_STATE_UTILS_H_
+#define _GXM_STATE_UTILS_H_
+
+#include <stdint.h>
+
+// Sides a front/back state setter applies to
+#define GXM_SIDE_FRONT 1
+#define GXM_SIDE_BACK 2
+#define GXM_SIDES_BOTH (GXM_SIDE_FRONT | GXM_SIDE_BACK)
+
+/*
+ * Setters only record the requested value, values are sent to sceGxm by flush_gxm_state
+ * right before a draw and only if they differ from the ones sceGxm already has.
+ */
+void set_gxm_depth_func(int sides, SceGxmDepthFunc func);
+void set_gxm_depth_write_enable(int sides, SceGxmDepthWriteMode mode);
+void set_gxm_stencil_func(int sides, SceGxmStencilFunc func, SceGxmStencilOp stencil_fail, SceGxmStencilOp depth_fail, SceGxmStencilOp depth_pass, uint8_t compare_mask, uint8_t write_mask);
+void set_gxm_stencil_ref(int sides, uint32_t ref);
+void set_gxm_polygon_mode(int sides, SceGxmPolygonMode mode);
+void set_gxm_depth_bias(int sides, int factor, int units);
+void set_gxm_fragment_program_enable(int sides, SceGxmFragmentProgramMode mode);
+void set_gxm_point_line_width(int sides, uint32_t width);
+void set_gxm_cull_mode(SceGxmCullMode mode);
+void set_gxm_two_sided_enable(SceGxmTwoSidedMode mode);
+void set_gxm_region_clip(SceGxmRegionClipMode mode, uint32_t x_min, uint32_t y_min, uint32_t x_max, uint32_t y_max);
+void set_gxm_viewport(float x_offset, float x_scale, float y_offset, float y_scale, float z_offset, float z_scale);
+
+extern uint32_t gxm_state_dirty_mask;
+
+void submit_gxm_state(void); // Sends pending state changes to sceGxm
+void reset_gxm_state(void); // Forgets any state sceGxm has, to be called on context creation
+void reset_gxm_scene_state(void); // Forgets the state sceGxm resets on scene start, to be called after sceGxmBeginScene
+
+// Sends pending state changes to sceGxm, to be called right before a draw
+static inline void flush_gxm_state(void) {
+	if (gxm_state_dirty_mask)
+		submit_gxm_state();
+}
+
+#endif
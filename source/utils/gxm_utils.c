@@ -26,29 +26,29 @@
 
 static void *frag_buf = NULL;
 static void *vert_buf = NULL;
-static uint8_t *unif_pool = NULL;
-static uint32_t unif_idx = 0;
+static uniform_pool unif_pool;
+static uniform_stats unif_stats;
 
 void vglSetupUniformCircularPool() {
-	unif_pool = gpu_alloc_mapped(UNIFORM_CIRCULAR_POOL_SIZE, VGL_MEM_RAM);
+	uniform_pool_init(&unif_pool, gpu_alloc_mapped(UNIFORM_CIRCULAR_POOL_SIZE, VGL_MEM_RAM), UNIFORM_CIRCULAR_POOL_SIZE);
 }
 
-void *vglReserveUniformCircularPoolBuffer(uint32_t size) {
-	void *r;
-	if (unif_idx + size >= UNIFORM_CIRCULAR_POOL_SIZE) {
+static inline void check_uniform_pool_outage(uint32_t wraps) {
 #ifndef SKIP_ERROR_HANDLING
-		static uint32_t last_frame_swap = 0;
+	static uint32_t last_frame_swap = 0;
+	if (wraps != unif_pool.wraps) {
 		if (last_frame_swap == vgl_debugger_framecount) {
 			vgl_log("%s:%d Circular Uniform Pool outage detected! Considering increasing its size...\n", __FILE__, __LINE__);
 		}
 		last_frame_swap = vgl_debugger_framecount;
-#endif
-		r = unif_pool;
-		unif_idx = size;
-	} else {
-		r = (unif_pool + unif_idx);
-		unif_idx += size;
 	}
+#endif
+}
+
+void *vglReserveUniformCircularPoolBuffer(uint32_t size) {
+	uint32_t wraps = unif_pool.wraps;
+	void *r = uniform_pool_reserve(&unif_pool, size);
+	check_uniform_pool_outage(wraps);
 	return r;
 }
 
@@ -82,6 +82,30 @@ uint32_t vglReserveVertexUniformBuffer(const SceGxmProgram *p, void **uniformBuf
 	return size;
 }
 
+void vglUploadFragmentUniformBlock(uniform_block *b) {
+	if (b->size) {
+		uint32_t wraps = unif_pool.wraps;
+		frag_buf = uniform_block_upload(b, &unif_pool, &unif_stats);
+		check_uniform_pool_outage(wraps);
+		sceGxmSetFragmentDefaultUniformBuffer(gxm_context, frag_buf);
+	}
+}
+
+void vglUploadVertexUniformBlock(uniform_block *b) {
+	if (b->size) {
+		uint32_t wraps = unif_pool.wraps;
+		vert_buf = uniform_block_upload(b, &unif_pool, &unif_stats);
+		check_uniform_pool_outage(wraps);
+		sceGxmSetVertexDefaultUniformBuffer(gxm_context, vert_buf);
+	}
+}
+
+void vglGetUniformStats(vglUniformStats *stats) {
+	stats->uploads = unif_stats.uploads;
+	stats->reuses = unif_stats.reuses;
+	stats->bytes = unif_stats.bytes;
+}
+
 #ifndef PARANOID
 typedef struct {
 	uint32_t control_words[4];
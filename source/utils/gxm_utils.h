@@ -24,6 +24,8 @@
 #ifndef _GXM_UTILS_H_
 #define _GXM_UTILS_H_
 
+#include "uniform_utils.h"
+
 //#define PARANOID // Enable this flag to use original sceGxmTexture functions instead of faster re-implementations
 
 uint32_t vglReserveFragmentUniformBuffer(const SceGxmProgram *p, void **uniformBuffer);
@@ -31,6 +33,8 @@ uint32_t vglReserveVertexUniformBuffer(const SceGxmProgram *p, void **uniformBuf
 void vglRestoreFragmentUniformBuffer(void);
 void vglRestoreVertexUniformBuffer(void);
 void vglSetupUniformCircularPool(void);
+void vglUploadFragmentUniformBlock(uniform_block *b);
+void vglUploadVertexUniformBlock(uniform_block *b);
 
 #ifndef PARANOID
 // Faster variants with stripped error handling
@@ -0,0 +1,63 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * immediate_utils.c:
+ * Packing of immediate mode vertices with only the attributes in use
+ */
+
+#include <string.h>
+#include "immediate_utils.h"
+
+float *immediate_pack_vertex(float *dst, const float *pos, const float *uv0, const float *uv1, const float *color) {
+	// Vertices are laid out as position, texture coordinates and, optionally, color
+	dst[0] = pos[0];
+	dst[1] = pos[1];
+	dst[2] = pos[2];
+	dst += 3;
+	if (uv0) {
+		dst[0] = uv0[0];
+		dst[1] = uv0[1];
+		dst += IMMEDIATE_UV_SIZE;
+		if (uv1) {
+			dst[0] = uv1[0];
+			dst[1] = uv1[1];
+			dst += IMMEDIATE_UV_SIZE;
+		}
+	}
+	if (color) {
+		memcpy(dst, color, IMMEDIATE_COLOR_SIZE * sizeof(float));
+		dst += IMMEDIATE_COLOR_SIZE;
+	}
+	return dst;
+}
+
+float *immediate_add_colors(float *vertices, uint32_t count, uint32_t stride, const float *color) {
+	// Widening vertices in place starting from the last one so that no source gets overwritten before being moved
+	uint32_t new_stride = stride + IMMEDIATE_COLOR_SIZE;
+	for (int32_t i = (int32_t)count - 1; i >= 0; i--) {
+		float *src = vertices + i * stride;
+		float *dst = vertices + i * new_stride;
+		memcpy(dst + stride, color, IMMEDIATE_COLOR_SIZE * sizeof(float));
+		for (int32_t j = (int32_t)stride - 1; j >= 0; j--) {
+			dst[j] = src[j];
+		}
+	}
+	return vertices + count * new_stride;
+}
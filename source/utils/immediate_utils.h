@@ -0,0 +1,36 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * immediate_utils.h:
+ * Header file for the immediate mode vertices utilities exposed by immediate_utils.c
+ */
+
+#ifndef _IMMEDIATE_UTILS_H_
+#define _IMMEDIATE_UTILS_H_
+
+#include <stdint.h>
+
+#define IMMEDIATE_UV_SIZE 2 // Number of floats of a set of texture coordinates
+#define IMMEDIATE_COLOR_SIZE 4 // Number of floats of a per-vertex color
+
+float *immediate_pack_vertex(float *dst, const float *pos, const float *uv0, const float *uv1, const float *color);
+float *immediate_add_colors(float *vertices, uint32_t count, uint32_t stride, const float *color);
+
+#endif
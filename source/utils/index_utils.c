@@ -0,0 +1,454 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * index_utils.c:
+ * Index buffers expansion for primitives not natively supported by sceGxm and cache for their results
+ */
+
+#include <string.h>
+#include "index_utils.h"
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+uint32_t index_expanded_count(index_prim prim, uint32_t count) {
+	switch (prim) {
+	case INDEX_PRIM_QUADS:
+		return (count / 4) * 6;
+	case INDEX_PRIM_LINE_STRIP:
+		return count < 2 ? 0 : (count - 1) * 2;
+	case INDEX_PRIM_LINE_LOOP:
+		return count < 2 ? 0 : count * 2;
+	default:
+		return count;
+	}
+}
+
+void index_expand_u16(uint16_t *dst, const uint16_t *src, uint32_t count, int32_t base, index_prim prim) {
+	uint32_t i = 0;
+	uint16_t b = (uint16_t)base;
+#ifdef __ARM_NEON
+	uint16x8_t vb = vdupq_n_u16(b);
+#endif
+	switch (prim) {
+	case INDEX_PRIM_QUADS:
+		count /= 4;
+#ifdef __ARM_NEON
+		// 8 quads per iteration, triangles are built as (a, b, d) (b, c, d) by zipping the quads corners
+		for (; i + 8 <= count; i += 8) {
+			uint16x8x4_t q = vld4q_u16(&src[i * 4]);
+			uint16x8_t va = vaddq_u16(q.val[0], vb);
+			uint16x8_t vb1 = vaddq_u16(q.val[1], vb);
+			uint16x8_t vc = vaddq_u16(q.val[2], vb);
+			uint16x8_t vd = vaddq_u16(q.val[3], vb);
+			uint16x8x2_t ab = vzipq_u16(va, vb1);
+			uint16x8x2_t bc = vzipq_u16(vb1, vc);
+			uint16x8x2_t dd = vzipq_u16(vd, vd);
+			uint16x8x3_t lo = {{ab.val[0], bc.val[0], dd.val[0]}};
+			uint16x8x3_t hi = {{ab.val[1], bc.val[1], dd.val[1]}};
+			vst3q_u16(&dst[i * 6], lo);
+			vst3q_u16(&dst[i * 6 + 24], hi);
+		}
+#endif
+		for (; i < count; i++) {
+			dst[i * 6] = src[i * 4] + b;
+			dst[i * 6 + 1] = src[i * 4 + 1] + b;
+			dst[i * 6 + 2] = src[i * 4 + 3] + b;
+			dst[i * 6 + 3] = src[i * 4 + 1] + b;
+			dst[i * 6 + 4] = src[i * 4 + 2] + b;
+			dst[i * 6 + 5] = src[i * 4 + 3] + b;
+		}
+		break;
+	case INDEX_PRIM_LINE_STRIP:
+	case INDEX_PRIM_LINE_LOOP:
+		if (count < 2)
+			break;
+#ifdef __ARM_NEON
+		// 8 lines per iteration, built by interleaving the indices with themselves shifted by one
+		for (; i + 8 <= count - 1; i += 8) {
+			uint16x8x2_t l = {{vaddq_u16(vld1q_u16(&src[i]), vb), vaddq_u16(vld1q_u16(&src[i + 1]), vb)}};
+			vst2q_u16(&dst[i * 2], l);
+		}
+#endif
+		for (; i < count - 1; i++) {
+			dst[i * 2] = src[i] + b;
+			dst[i * 2 + 1] = src[i + 1] + b;
+		}
+		if (prim == INDEX_PRIM_LINE_LOOP) {
+			dst[i * 2] = src[count - 1] + b;
+			dst[i * 2 + 1] = src[0] + b;
+		}
+		break;
+	default:
+		if (!b) {
+			memcpy(dst, src, count * sizeof(uint16_t));
+			break;
+		}
+#ifdef __ARM_NEON
+		for (; i + 8 <= count; i += 8) {
+			vst1q_u16(&dst[i], vaddq_u16(vld1q_u16(&src[i]), vb));
+		}
+#endif
+		for (; i < count; i++) {
+			dst[i] = src[i] + b;
+		}
+		break;
+	}
+}
+
+void index_expand_u32(uint32_t *dst, const uint32_t *src, uint32_t count, int32_t base, index_prim prim) {
+	uint32_t i = 0;
+	uint32_t b = (uint32_t)base;
+#ifdef __ARM_NEON
+	uint32x4_t vb = vdupq_n_u32(b);
+#endif
+	switch (prim) {
+	case INDEX_PRIM_QUADS:
+		count /= 4;
+#ifdef __ARM_NEON
+		// 4 quads per iteration, same approach as the 16 bits variant
+		for (; i + 4 <= count; i += 4) {
+			uint32x4x4_t q = vld4q_u32(&src[i * 4]);
+			uint32x4_t va = vaddq_u32(q.val[0], vb);
+			uint32x4_t vb1 = vaddq_u32(q.val[1], vb);
+			uint32x4_t vc = vaddq_u32(q.val[2], vb);
+			uint32x4_t vd = vaddq_u32(q.val[3], vb);
+			uint32x4x2_t ab = vzipq_u32(va, vb1);
+			uint32x4x2_t bc = vzipq_u32(vb1, vc);
+			uint32x4x2_t dd = vzipq_u32(vd, vd);
+			uint32x4x3_t lo = {{ab.val[0], bc.val[0], dd.val[0]}};
+			uint32x4x3_t hi = {{ab.val[1], bc.val[1], dd.val[1]}};
+			vst3q_u32(&dst[i * 6], lo);
+			vst3q_u32(&dst[i * 6 + 12], hi);
+		}
+#endif
+		for (; i < count; i++) {
+			dst[i * 6] = src[i * 4] + b;
+			dst[i * 6 + 1] = src[i * 4 + 1] + b;
+			dst[i * 6 + 2] = src[i * 4 + 3] + b;
+			dst[i * 6 + 3] = src[i * 4 + 1] + b;
+			dst[i * 6 + 4] = src[i * 4 + 2] + b;
+			dst[i * 6 + 5] = src[i * 4 + 3] + b;
+		}
+		break;
+	case INDEX_PRIM_LINE_STRIP:
+	case INDEX_PRIM_LINE_LOOP:
+		if (count < 2)
+			break;
+#ifdef __ARM_NEON
+		for (; i + 4 <= count - 1; i += 4) {
+			uint32x4x2_t l = {{vaddq_u32(vld1q_u32(&src[i]), vb), vaddq_u32(vld1q_u32(&src[i + 1]), vb)}};
+			vst2q_u32(&dst[i * 2], l);
+		}
+#endif
+		for (; i < count - 1; i++) {
+			dst[i * 2] = src[i] + b;
+			dst[i * 2 + 1] = src[i + 1] + b;
+		}
+		if (prim == INDEX_PRIM_LINE_LOOP) {
+			dst[i * 2] = src[count - 1] + b;
+			dst[i * 2 + 1] = src[0] + b;
+		}
+		break;
+	default:
+		if (!b) {
+			memcpy(dst, src, count * sizeof(uint32_t));
+			break;
+		}
+#ifdef __ARM_NEON
+		for (; i + 4 <= count; i += 4) {
+			vst1q_u32(&dst[i], vaddq_u32(vld1q_u32(&src[i]), vb));
+		}
+#endif
+		for (; i < count; i++) {
+			dst[i] = src[i] + b;
+		}
+		break;
+	}
+}
+
+#ifdef __ARM_NEON
+static const uint16_t ramp_u16[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+#endif
+
+void index_fill_linear_u16(uint16_t *dst, uint32_t first, uint32_t count) {
+	uint32_t i = 0;
+#ifdef __ARM_NEON
+	uint16x8_t v = vaddq_u16(vld1q_u16(ramp_u16), vdupq_n_u16((uint16_t)first));
+	uint16x8_t step = vdupq_n_u16(8);
+	for (; i + 8 <= count; i += 8) {
+		vst1q_u16(&dst[i], v);
+		v = vaddq_u16(v, step);
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] = first + i;
+	}
+}
+
+void index_fill_quads_u16(uint16_t *dst, uint32_t first, uint32_t quads) {
+	uint32_t i = 0;
+#ifdef __ARM_NEON
+	// First corner of 8 consecutive quads, the other ones are derived from it
+	uint16x8_t va = vaddq_u16(vshlq_n_u16(vld1q_u16(ramp_u16), 2), vdupq_n_u16((uint16_t)first));
+	uint16x8_t one = vdupq_n_u16(1);
+	uint16x8_t step = vdupq_n_u16(32);
+	for (; i + 8 <= quads; i += 8) {
+		uint16x8_t vb = vaddq_u16(va, one);
+		uint16x8_t vc = vaddq_u16(vb, one);
+		uint16x8_t vd = vaddq_u16(vc, one);
+		uint16x8x2_t ab = vzipq_u16(va, vb);
+		uint16x8x2_t bc = vzipq_u16(vb, vc);
+		uint16x8x2_t dd = vzipq_u16(vd, vd);
+		uint16x8x3_t lo = {{ab.val[0], bc.val[0], dd.val[0]}};
+		uint16x8x3_t hi = {{ab.val[1], bc.val[1], dd.val[1]}};
+		vst3q_u16(&dst[i * 6], lo);
+		vst3q_u16(&dst[i * 6 + 24], hi);
+		va = vaddq_u16(va, step);
+	}
+#endif
+	for (; i < quads; i++) {
+		uint16_t a = first + i * 4;
+		dst[i * 6] = a;
+		dst[i * 6 + 1] = a + 1;
+		dst[i * 6 + 2] = a + 3;
+		dst[i * 6 + 3] = a + 1;
+		dst[i * 6 + 4] = a + 2;
+		dst[i * 6 + 5] = a + 3;
+	}
+}
+
+void index_fill_line_strip_u16(uint16_t *dst, uint32_t first, uint32_t lines) {
+	uint32_t i = 0;
+#ifdef __ARM_NEON
+	uint16x8_t v = vaddq_u16(vld1q_u16(ramp_u16), vdupq_n_u16((uint16_t)first));
+	uint16x8_t one = vdupq_n_u16(1);
+	uint16x8_t step = vdupq_n_u16(8);
+	for (; i + 8 <= lines; i += 8) {
+		uint16x8x2_t l = {{v, vaddq_u16(v, one)}};
+		vst2q_u16(&dst[i * 2], l);
+		v = vaddq_u16(v, step);
+	}
+#endif
+	for (; i < lines; i++) {
+		dst[i * 2] = first + i;
+		dst[i * 2 + 1] = first + i + 1;
+	}
+}
+
+void index_range_u16(const uint16_t *src, uint32_t count, uint32_t *min, uint32_t *max) {
+	uint32_t i = 0;
+	uint16_t lo = 0xFFFF, hi = 0;
+#ifdef __ARM_NEON
+	if (count >= 16) {
+		// Two accumulators per side to hide the latency of the compare instructions
+		uint16x8_t vlo0 = vdupq_n_u16(0xFFFF), vlo1 = vlo0;
+		uint16x8_t vhi0 = vdupq_n_u16(0), vhi1 = vhi0;
+		for (; i + 16 <= count; i += 16) {
+			uint16x8_t a = vld1q_u16(&src[i]);
+			uint16x8_t b = vld1q_u16(&src[i + 8]);
+			vlo0 = vminq_u16(vlo0, a);
+			vhi0 = vmaxq_u16(vhi0, a);
+			vlo1 = vminq_u16(vlo1, b);
+			vhi1 = vmaxq_u16(vhi1, b);
+		}
+		vlo0 = vminq_u16(vlo0, vlo1);
+		vhi0 = vmaxq_u16(vhi0, vhi1);
+		uint16x4_t l = vmin_u16(vget_low_u16(vlo0), vget_high_u16(vlo0));
+		uint16x4_t h = vmax_u16(vget_low_u16(vhi0), vget_high_u16(vhi0));
+		l = vpmin_u16(l, l);
+		h = vpmax_u16(h, h);
+		l = vpmin_u16(l, l);
+		h = vpmax_u16(h, h);
+		lo = vget_lane_u16(l, 0);
+		hi = vget_lane_u16(h, 0);
+	}
+#endif
+	for (; i < count; i++) {
+		lo = src[i] < lo ? src[i] : lo;
+		hi = src[i] > hi ? src[i] : hi;
+	}
+	*min = count ? lo : 0;
+	*max = hi;
+}
+
+void index_range_u32(const uint32_t *src, uint32_t count, uint32_t *min, uint32_t *max) {
+	uint32_t i = 0;
+	uint32_t lo = 0xFFFFFFFF, hi = 0;
+#ifdef __ARM_NEON
+	if (count >= 8) {
+		uint32x4_t vlo0 = vdupq_n_u32(0xFFFFFFFF), vlo1 = vlo0;
+		uint32x4_t vhi0 = vdupq_n_u32(0), vhi1 = vhi0;
+		for (; i + 8 <= count; i += 8) {
+			uint32x4_t a = vld1q_u32(&src[i]);
+			uint32x4_t b = vld1q_u32(&src[i + 4]);
+			vlo0 = vminq_u32(vlo0, a);
+			vhi0 = vmaxq_u32(vhi0, a);
+			vlo1 = vminq_u32(vlo1, b);
+			vhi1 = vmaxq_u32(vhi1, b);
+		}
+		vlo0 = vminq_u32(vlo0, vlo1);
+		vhi0 = vmaxq_u32(vhi0, vhi1);
+		uint32x2_t l = vmin_u32(vget_low_u32(vlo0), vget_high_u32(vlo0));
+		uint32x2_t h = vmax_u32(vget_low_u32(vhi0), vget_high_u32(vhi0));
+		l = vpmin_u32(l, l);
+		h = vpmax_u32(h, h);
+		lo = vget_lane_u32(l, 0);
+		hi = vget_lane_u32(h, 0);
+	}
+#endif
+	for (; i < count; i++) {
+		lo = src[i] < lo ? src[i] : lo;
+		hi = src[i] > hi ? src[i] : hi;
+	}
+	*min = count ? lo : 0;
+	*max = hi;
+}
+
+void index_range_cached(index_range_cache *c, uint32_t buf_id, uint32_t offset, const void *src, uint32_t count, uint8_t is_short, uint32_t *min, uint32_t *max) {
+	uint32_t h = buf_id * 0x9E3779B1;
+	h ^= offset * 0x85EBCA6B;
+	h ^= count * 0xC2B2AE35;
+	h ^= h >> 16;
+	index_range_entry *e = &c->entries[h & (INDEX_RANGE_CACHE_SIZE - 1)];
+	if (buf_id && e->buf_id == buf_id && e->offset == offset && e->count == count && e->is_short == is_short) {
+		c->hits++;
+		*min = e->min;
+		*max = e->max;
+		return;
+	}
+
+	c->misses++;
+	if (is_short)
+		index_range_u16((const uint16_t *)src, count, min, max);
+	else
+		index_range_u32((const uint32_t *)src, count, min, max);
+
+	// Buffers with no content identifier can't be told apart, so their ranges are never stored
+	if (buf_id) {
+		e->buf_id = buf_id;
+		e->offset = offset;
+		e->count = count;
+		e->is_short = is_short;
+		e->min = *min;
+		e->max = *max;
+	}
+}
+
+// Returns non zero if the indices of a buffer region overlap the given bytes range
+static inline int region_overlaps(uint32_t offset, uint32_t count, uint8_t is_short, uint32_t start, uint32_t end) {
+	return offset < end && offset + count * (is_short ? 2 : 4) > start;
+}
+
+void index_range_invalidate(index_range_cache *c, uint32_t buf_id, uint32_t offset, uint32_t size) {
+	for (int i = 0; i < INDEX_RANGE_CACHE_SIZE; i++) {
+		index_range_entry *e = &c->entries[i];
+		if (e->buf_id == buf_id && region_overlaps(e->offset, e->count, e->is_short, offset, offset + size))
+			e->buf_id = 0;
+	}
+}
+
+void index_cache_init(index_cache *c, index_free_cb free_cb) {
+	memset(c, 0, sizeof(index_cache));
+	c->free_cb = free_cb;
+}
+
+static void evict_entry(index_cache *c, index_cache_entry *e) {
+	c->free_cb(e->dst);
+	c->bytes -= e->dst_size;
+	e->buf_id = 0;
+}
+
+void index_cache_clear(index_cache *c) {
+	for (int i = 0; i < INDEX_CACHE_SETS * INDEX_CACHE_WAYS; i++) {
+		if (c->entries[i].buf_id)
+			evict_entry(c, &c->entries[i]);
+	}
+}
+
+void index_cache_invalidate(index_cache *c, uint32_t buf_id, uint32_t offset, uint32_t size) {
+	for (int i = 0; i < INDEX_CACHE_SETS * INDEX_CACHE_WAYS; i++) {
+		index_cache_entry *e = &c->entries[i];
+		if (buf_id && e->buf_id == buf_id && region_overlaps(e->offset, e->count, e->is_short, offset, offset + size))
+			evict_entry(c, e);
+	}
+}
+
+static index_cache_entry *get_set(index_cache *c, uint32_t buf_id, uint32_t offset, uint32_t count, int32_t base, index_prim prim) {
+	uint32_t h = buf_id * 0x9E3779B1;
+	h ^= offset * 0x85EBCA6B;
+	h ^= count * 0xC2B2AE35;
+	h ^= (uint32_t)base * 0x27D4EB2F;
+	h ^= prim;
+	h ^= h >> 16;
+	return &c->entries[(h % INDEX_CACHE_SETS) * INDEX_CACHE_WAYS];
+}
+
+index_cache_entry *index_cache_lookup(index_cache *c, uint32_t buf_id, uint32_t offset, uint32_t count, int32_t base, index_prim prim, uint8_t is_short) {
+	// Empty entries have a zero content identifier
+	if (!buf_id)
+		return NULL;
+	index_cache_entry *set = get_set(c, buf_id, offset, count, base, prim);
+	for (int i = 0; i < INDEX_CACHE_WAYS; i++) {
+		index_cache_entry *e = &set[i];
+		if (e->buf_id == buf_id && e->offset == offset && e->count == count && e->base == base && e->prim == prim && e->is_short == is_short) {
+			e->last_use = ++c->clock;
+			return e;
+		}
+	}
+	return NULL;
+}
+
+void index_cache_insert(index_cache *c, uint32_t buf_id, uint32_t offset, uint32_t count, int32_t base, index_prim prim, uint8_t is_short, void *dst, uint32_t dst_count, uint32_t dst_size) {
+	// Picking an empty way or the least recently used one
+	index_cache_entry *set = get_set(c, buf_id, offset, count, base, prim);
+	index_cache_entry *e = &set[0];
+	for (int i = 0; i < INDEX_CACHE_WAYS && e->buf_id; i++) {
+		if (!set[i].buf_id || (int32_t)(set[i].last_use - e->last_use) < 0)
+			e = &set[i];
+	}
+	if (e->buf_id)
+		evict_entry(c, e);
+
+	// Evicting least recently used entries until the new one fits in the cache budget
+	while (c->bytes + dst_size > INDEX_CACHE_MAX_BYTES) {
+		index_cache_entry *victim = NULL;
+		for (int i = 0; i < INDEX_CACHE_SETS * INDEX_CACHE_WAYS; i++) {
+			index_cache_entry *cand = &c->entries[i];
+			if (cand->buf_id && (!victim || (int32_t)(cand->last_use - victim->last_use) < 0))
+				victim = cand;
+		}
+		if (!victim)
+			break;
+		evict_entry(c, victim);
+	}
+
+	e->buf_id = buf_id;
+	e->offset = offset;
+	e->count = count;
+	e->base = base;
+	e->prim = prim;
+	e->is_short = is_short;
+	e->last_use = ++c->clock;
+	e->dst = dst;
+	e->dst_count = dst_count;
+	e->dst_size = dst_size;
+	c->bytes += dst_size;
+}
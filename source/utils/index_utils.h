@@ -0,0 +1,102 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * index_utils.h:
+ * Header file for the index buffers utilities exposed by index_utils.c
+ */
+
+#ifndef _INDEX_UTILS_H_
+#define _INDEX_UTILS_H_
+
+#include <stdint.h>
+
+#define INDEX_CACHE_SETS 64 // Number of sets of the converted index buffers cache
+#define INDEX_CACHE_WAYS 4 // Number of entries per set of the converted index buffers cache
+#define INDEX_CACHE_MAX_BYTES (4 * 1024 * 1024) // Maximum size in bytes of the converted index buffers held by the cache
+#define INDEX_RANGE_CACHE_SIZE 256 // Number of entries of the index ranges cache (must be a power of two)
+
+// Primitive layouts index buffers can be expanded from
+typedef enum {
+	INDEX_PRIM_LIST, // Indices are used as they are
+	INDEX_PRIM_QUADS, // Every 4 indices are expanded to 2 triangles
+	INDEX_PRIM_LINE_STRIP, // Every index but the last starts a line
+	INDEX_PRIM_LINE_LOOP // As INDEX_PRIM_LINE_STRIP plus a line closing the loop
+} index_prim;
+
+// Converted index buffer
+typedef struct {
+	uint32_t buf_id; // Content identifier of the source index buffer, zero for empty entries
+	uint32_t offset;
+	uint32_t count;
+	int32_t base;
+	uint8_t prim;
+	uint8_t is_short;
+	uint32_t last_use;
+	void *dst;
+	uint32_t dst_count;
+	uint32_t dst_size;
+} index_cache_entry;
+
+// Release callback for converted index buffers evicted from the cache
+typedef void (*index_free_cb)(void *ptr);
+
+// Set associative cache of converted index buffers
+typedef struct {
+	index_cache_entry entries[INDEX_CACHE_SETS * INDEX_CACHE_WAYS];
+	uint32_t bytes;
+	uint32_t clock;
+	index_free_cb free_cb;
+} index_cache;
+
+uint32_t index_expanded_count(index_prim prim, uint32_t count);
+void index_expand_u16(uint16_t *dst, const uint16_t *src, uint32_t count, int32_t base, index_prim prim);
+void index_expand_u32(uint32_t *dst, const uint32_t *src, uint32_t count, int32_t base, index_prim prim);
+void index_fill_linear_u16(uint16_t *dst, uint32_t first, uint32_t count);
+void index_fill_quads_u16(uint16_t *dst, uint32_t first, uint32_t quads);
+void index_fill_line_strip_u16(uint16_t *dst, uint32_t first, uint32_t lines);
+
+// Range of the indices of an index buffer region
+typedef struct {
+	uint32_t buf_id; // Content identifier of the source index buffer, zero for empty entries
+	uint32_t offset;
+	uint32_t count;
+	uint8_t is_short;
+	uint32_t min;
+	uint32_t max;
+} index_range_entry;
+
+// Direct mapped cache of index buffers regions ranges
+typedef struct {
+	index_range_entry entries[INDEX_RANGE_CACHE_SIZE];
+	uint32_t hits;
+	uint32_t misses;
+} index_range_cache;
+
+void index_range_u16(const uint16_t *src, uint32_t count, uint32_t *min, uint32_t *max);
+void index_range_u32(const uint32_t *src, uint32_t count, uint32_t *min, uint32_t *max);
+void index_range_cached(index_range_cache *c, uint32_t buf_id, uint32_t offset, const void *src, uint32_t count, uint8_t is_short, uint32_t *min, uint32_t *max);
+void index_range_invalidate(index_range_cache *c, uint32_t buf_id, uint32_t offset, uint32_t size);
+
+void index_cache_init(index_cache *c, index_free_cb free_cb);
+void index_cache_clear(index_cache *c);
+void index_cache_invalidate(index_cache *c, uint32_t buf_id, uint32_t offset, uint32_t size);
+index_cache_entry *index_cache_lookup(index_cache *c, uint32_t buf_id, uint32_t offset, uint32_t count, int32_t base, index_prim prim, uint8_t is_short);
+void index_cache_insert(index_cache *c, uint32_t buf_id, uint32_t offset, uint32_t count, int32_t base, index_prim prim, uint8_t is_short, void *dst, uint32_t dst_count, uint32_t dst_size);
+
+#endif
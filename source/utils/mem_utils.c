@@ -35,6 +35,64 @@ static size_t mempool_size[VGL_MEM_ALL] = {0, 0, 0, 0, 0}; // sizes of heap meml
 static int mempool_initialized = GL_FALSE;
 
 #ifdef HAVE_CUSTOM_HEAP
+#ifdef HAVE_TLSF_HEAP
+static tlsf_pool tm_pools[VGL_MEM_EXTERNAL]; // TLSF allocators (VRAM, RAM, PHYCONT RAM, CDLG)
+
+#define heap_free_space(type) tm_pools[type].free_size
+
+// initializes heap allocators
+static void heap_init(void) {
+	for (int i = 0; i < VGL_MEM_EXTERNAL; i++)
+		tlsf_init(&tm_pools[i]);
+}
+
+// resets heap state and frees block descriptors
+static void heap_destroy(void) {
+	for (int i = 0; i < VGL_MEM_EXTERNAL; i++)
+		tlsf_destroy(&tm_pools[i]);
+}
+
+// adds a memblock to the heap
+static void heap_extend(int32_t type, void *base, uint32_t size) {
+	tlsf_add_region(&tm_pools[type], base, size);
+}
+
+// allocates memory from the heap (basically malloc())
+static void *heap_alloc(int32_t type, uint32_t size, uint32_t alignment) {
+	return tlsf_alloc(&tm_pools[type], size, alignment);
+}
+
+// gets the allocator owning a given address
+static tlsf_pool *heap_get_pool(uintptr_t base) {
+	for (int i = 0; i < VGL_MEM_EXTERNAL; i++) {
+		if (base >= (uintptr_t)mempool_addr[i] && base < (uintptr_t)mempool_addr[i] + mempool_size[i])
+			return &tm_pools[i];
+	}
+	return NULL;
+}
+
+// reallocates memory from the heap (basically realloc())
+static void *heap_realloc(void *ptr, uint32_t size) {
+	tlsf_pool *pool = heap_get_pool((uintptr_t)ptr);
+	return pool ? tlsf_realloc(pool, ptr, size) : NULL;
+}
+
+// returns usable size of a heap block
+static size_t heap_usable_size(void *ptr) {
+	tlsf_pool *pool = heap_get_pool((uintptr_t)ptr);
+	return pool ? tlsf_usable_size(pool, ptr) : 0;
+}
+
+// frees a previously allocated heap block
+static void heap_blk_free(uintptr_t base) {
+	tlsf_pool *pool = heap_get_pool(base);
+	if (!pool || !tlsf_free(pool, (void *)base)) {
+#ifndef SKIP_ERROR_HANDLING
+		vgl_log("%s:%d An internal free failed (possible double free call) on pointer: 0x%08X!\n", __FILE__, __LINE__, base);
+#endif
+	}
+}
+#else
 typedef struct tm_block_s {
 	struct tm_block_s *next; // next block in list (either free or allocated)
 	int32_t type; // one of vglMemType
@@ -48,6 +106,8 @@ static tm_block_t *tm_freelist; // list of free blocks
 
 static uint32_t tm_free[VGL_MEM_ALL]; // see enum vglMemType
 
+#define heap_free_space(type) tm_free[type]
+
 // get new block header
 static inline tm_block_t *heap_blk_new(void) {
 	return calloc(1, sizeof(tm_block_t));
@@ -251,6 +311,7 @@ static void *heap_alloc(int32_t type, uint32_t size, uint32_t alignment) {
 	return (void *)block->base;
 }
 #endif
+#endif
 
 #ifdef PHYCONT_ON_DEMAND
 void *vgl_alloc_phycont_block(uint32_t size) {
@@ -375,7 +436,7 @@ void vgl_mem_init(size_t size_ram, size_t size_cdram, size_t size_phycont, size_
 }
 
 vglMemType vgl_mem_get_type_by_addr(void *addr) {
-#ifdef HAVE_CUSTOM_HEAP
+#if defined(HAVE_CUSTOM_HEAP) && !defined(HAVE_TLSF_HEAP)
 	if (addr >= mempool_addr[VGL_MEM_EXTERNAL] && (addr < mempool_addr[VGL_MEM_EXTERNAL] + mempool_size[VGL_MEM_EXTERNAL]))
 		return VGL_MEM_EXTERNAL;
 	return -1;
@@ -425,7 +486,7 @@ size_t vgl_mem_get_free_space(vglMemType type) {
 		return size;
 #ifdef HAVE_CUSTOM_HEAP
 	} else {
-		return tm_free[type];
+		return heap_free_space(type);
 	}
 #else
 	} else if (mempool_size[type]) {
@@ -461,8 +522,13 @@ size_t vgl_malloc_usable_size(void *ptr) {
 		return info.mappedSize;
 	}
 #endif
+#ifdef HAVE_TLSF_HEAP
+	else
+		return heap_usable_size(ptr);
+#else
 	else
 		return sceClibMspaceMallocUsableSize(ptr);
+#endif
 }
 
 void vgl_free(void *ptr) {
@@ -471,7 +537,7 @@ void vgl_free(void *ptr) {
 		free(ptr);
 #ifdef HAVE_CUSTOM_HEAP
 	else
-		heap_blk_free(ptr);
+		heap_blk_free((uintptr_t)ptr);
 #else
 #ifdef PHYCONT_ON_DEMAND
 	else if (type == VGL_MEM_SLOW) {
@@ -485,10 +551,11 @@ void vgl_free(void *ptr) {
 }
 
 void *vgl_malloc(size_t size, vglMemType type) {
+	PROFILE_ZONE(MALLOC);
 	if (type == VGL_MEM_EXTERNAL)
 		return malloc(size);
 #ifdef HAVE_CUSTOM_HEAP
-	else if (size <= tm_free[type])
+	else if (size <= heap_free_space(type))
 		return heap_alloc(type, size, MEM_ALIGNMENT);
 #else
 #ifdef PHYCONT_ON_DEMAND
@@ -505,8 +572,12 @@ void *vgl_calloc(size_t num, size_t size, vglMemType type) {
 	if (type == VGL_MEM_EXTERNAL)
 		return calloc(num, size);
 #ifdef HAVE_CUSTOM_HEAP
-	else if (num * size <= tm_free[type])
-		return heap_alloc(type, num * size, MEM_ALIGNMENT);
+	else if (num * size <= heap_free_space(type)) {
+		void *res = heap_alloc(type, num * size, MEM_ALIGNMENT);
+		if (res)
+			sceClibMemset(res, 0, num * size);
+		return res;
+	}
 #else
 #ifdef PHYCONT_ON_DEMAND
 	else if (type == VGL_MEM_SLOW)
@@ -519,10 +590,11 @@ void *vgl_calloc(size_t num, size_t size, vglMemType type) {
 }
 
 void *vgl_memalign(size_t alignment, size_t size, vglMemType type) {
+	PROFILE_ZONE(MEMALIGN);
 	if (type == VGL_MEM_EXTERNAL)
 		return memalign(alignment, size);
 #ifdef HAVE_CUSTOM_HEAP
-	else if (size <= tm_free[type])
+	else if (size <= heap_free_space(type))
 		return heap_alloc(type, size, alignment);
 #else
 #ifdef PHYCONT_ON_DEMAND
@@ -554,6 +626,9 @@ void *vgl_realloc(void *ptr, size_t size) {
 #endif
 	else if (mempool_mspace[type])
 		return sceClibMspaceRealloc(mempool_mspace[type], ptr, size);
+#elif defined(HAVE_TLSF_HEAP)
+	else
+		return heap_realloc(ptr, size);
 #endif
 	return NULL;
 }
@@ -0,0 +1,111 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * patch_cache_utils.c:
+ * Cache for patched programs keyed by the state they have been patched for
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "patch_cache_utils.h"
+
+uint32_t patch_cache_hash(uintptr_t tag, const uint32_t *key, uint32_t key_size) {
+	// 32 bit FNV-1a on words
+	uint32_t h = 0x811C9DC5 ^ (uint32_t)tag;
+	for (uint32_t i = 0; i < key_size; i++) {
+		h = (h ^ key[i]) * 0x01000193;
+	}
+	return h ^ (h >> 16);
+}
+
+static inline int entry_match(patch_cache_entry *e, uintptr_t tag, const uint32_t *key, uint32_t key_size, uint32_t hash) {
+	return e->hash == hash && e->tag == tag && e->key_size == key_size && !memcmp(e->key, key, key_size * sizeof(uint32_t));
+}
+
+void *patch_cache_find(patch_cache *c, uintptr_t tag, const uint32_t *key, uint32_t key_size, uint32_t hash) {
+	// Consecutive draws usually share the same state, so checking last hit entry first
+	if (c->last && entry_match(c->last, tag, key, key_size, hash))
+		return c->last->prog;
+
+	patch_cache_entry *e = c->buckets[hash & (PATCH_CACHE_BUCKETS - 1)];
+	while (e) {
+		if (entry_match(e, tag, key, key_size, hash)) {
+			c->last = e;
+			return e->prog;
+		}
+		e = e->next;
+	}
+	return NULL;
+}
+
+int patch_cache_insert(patch_cache *c, uintptr_t tag, const uint32_t *key, uint32_t key_size, uint32_t hash, void *prog) {
+	patch_cache_entry *e = (patch_cache_entry *)malloc(sizeof(patch_cache_entry) + key_size * sizeof(uint32_t));
+	if (!e)
+		return 0;
+	e->prog = prog;
+	e->tag = tag;
+	e->hash = hash;
+	e->key_size = key_size;
+	memcpy(e->key, key, key_size * sizeof(uint32_t));
+	e->next = c->buckets[hash & (PATCH_CACHE_BUCKETS - 1)];
+	c->buckets[hash & (PATCH_CACHE_BUCKETS - 1)] = e;
+	c->last = e;
+	return 1;
+}
+
+static void drop_entries(patch_cache *c, uintptr_t tag, uint32_t word, uint32_t value, int by_tag, patch_release_cb release) {
+	for (int i = 0; i < PATCH_CACHE_BUCKETS; i++) {
+		patch_cache_entry **link = &c->buckets[i];
+		while (*link) {
+			patch_cache_entry *e = *link;
+			if (by_tag ? e->tag == tag : (word < e->key_size && e->key[word] == value)) {
+				*link = e->next;
+				if (release)
+					release(e->prog);
+				if (c->last == e)
+					c->last = NULL;
+				free(e);
+			} else
+				link = &e->next;
+		}
+	}
+}
+
+void patch_cache_drop_tag(patch_cache *c, uintptr_t tag, patch_release_cb release) {
+	drop_entries(c, tag, 0, 0, 1, release);
+}
+
+void patch_cache_drop_key(patch_cache *c, uint32_t word, uint32_t value, patch_release_cb release) {
+	drop_entries(c, 0, word, value, 0, release);
+}
+
+void patch_cache_clear(patch_cache *c, patch_release_cb release) {
+	for (int i = 0; i < PATCH_CACHE_BUCKETS; i++) {
+		patch_cache_entry *e = c->buckets[i];
+		while (e) {
+			patch_cache_entry *next = e->next;
+			if (release)
+				release(e->prog);
+			free(e);
+			e = next;
+		}
+		c->buckets[i] = NULL;
+	}
+	c->last = NULL;
+}
@@ -0,0 +1,57 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * patch_cache_utils.h:
+ * Header file for the patched programs cache utilities exposed by patch_cache_utils.c
+ */
+
+#ifndef _PATCH_CACHE_UTILS_H_
+#define _PATCH_CACHE_UTILS_H_
+
+#include <stdint.h>
+
+#define PATCH_CACHE_BUCKETS 16 // Number of buckets for every patched programs cache (must be a power of two)
+
+// Patched programs cache entry
+typedef struct patch_cache_entry {
+	struct patch_cache_entry *next; // Next entry in the same bucket
+	void *prog; // Patched program
+	uintptr_t tag; // Caller defined tag (usually the registered program the patched one derives from)
+	uint32_t hash; // Hash of key
+	uint32_t key_size; // Key length in words
+	uint32_t key[]; // Key data
+} patch_cache_entry;
+
+// Patched programs cache
+typedef struct {
+	patch_cache_entry *buckets[PATCH_CACHE_BUCKETS];
+	patch_cache_entry *last; // Last hit entry, checked first on lookups
+} patch_cache;
+
+// Release callback for patched programs
+typedef void (*patch_release_cb)(void *prog);
+
+uint32_t patch_cache_hash(uintptr_t tag, const uint32_t *key, uint32_t key_size);
+void *patch_cache_find(patch_cache *c, uintptr_t tag, const uint32_t *key, uint32_t key_size, uint32_t hash);
+int patch_cache_insert(patch_cache *c, uintptr_t tag, const uint32_t *key, uint32_t key_size, uint32_t hash, void *prog);
+void patch_cache_drop_tag(patch_cache *c, uintptr_t tag, patch_release_cb release);
+void patch_cache_drop_key(patch_cache *c, uint32_t word, uint32_t value, patch_release_cb release);
+void patch_cache_clear(patch_cache *c, patch_release_cb release);
+
+#endif
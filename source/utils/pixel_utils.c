@@ -0,0 +1,454 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * pixel_utils.c:
+ * Row based pixel converters used in place of per pixel texture callbacks
+ */
+
+#include <stddef.h>
+#include "pixel_utils.h"
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+// Bytes per pixel for every format
+#define RGBA8_BPP 4
+#define BGRA8_BPP 4
+#define ABGR8_BPP 4
+#define RGB8_BPP 3
+#define BGR8_BPP 3
+#define RG8_BPP 2
+#define R8_BPP 1
+#define L8_BPP 1
+#define LA8_BPP 2
+#define RGB565_BPP 2
+#define RGBA5551_BPP 2
+#define RGBA4444_BPP 2
+
+// Expansion of packed channels to 8 bits, must match convert_u16_to_u32_cspace in texture_callbacks.c
+#define expand_channel(v, mask) ((((v) & (mask)) * 0xFF) / (mask))
+
+#define pack_color(r, g, b, a) (((uint32_t)(a) << 24) | ((uint32_t)(b) << 16) | ((uint32_t)(g) << 8) | (uint32_t)(r))
+
+/*
+ * Scalar decoders, they produce the same RGBA sample the read callbacks return
+ */
+static inline uint32_t decode_RGBA8(const uint8_t *s) {
+	return pack_color(s[0], s[1], s[2], s[3]);
+}
+
+static inline uint32_t decode_BGRA8(const uint8_t *s) {
+	return pack_color(s[2], s[1], s[0], s[3]);
+}
+
+static inline uint32_t decode_ABGR8(const uint8_t *s) {
+	return pack_color(s[3], s[2], s[1], s[0]);
+}
+
+static inline uint32_t decode_RGB8(const uint8_t *s) {
+	return pack_color(s[0], s[1], s[2], 0xFF);
+}
+
+static inline uint32_t decode_BGR8(const uint8_t *s) {
+	return pack_color(s[2], s[1], s[0], 0xFF);
+}
+
+static inline uint32_t decode_RG8(const uint8_t *s) {
+	return pack_color(s[0], s[1], 0xFF, 0xFF);
+}
+
+static inline uint32_t decode_R8(const uint8_t *s) {
+	return pack_color(s[0], 0xFF, 0xFF, 0xFF);
+}
+
+static inline uint32_t decode_L8(const uint8_t *s) {
+	return pack_color(s[0], s[0], s[0], 0xFF);
+}
+
+static inline uint32_t decode_LA8(const uint8_t *s) {
+	return pack_color(s[0], s[0], s[0], s[1]);
+}
+
+static inline uint32_t decode_RGB565(const uint8_t *s) {
+	uint32_t clr = s[0] | (s[1] << 8);
+	return pack_color(expand_channel(clr >> 11, 0x1F), expand_channel(clr >> 5, 0x3F), expand_channel(clr, 0x1F), 0xFF);
+}
+
+static inline uint32_t decode_RGBA5551(const uint8_t *s) {
+	uint32_t clr = s[0] | (s[1] << 8);
+	return pack_color(expand_channel(clr >> 11, 0x1F), expand_channel(clr >> 6, 0x1F), expand_channel(clr >> 1, 0x1F), expand_channel(clr, 0x01));
+}
+
+static inline uint32_t decode_RGBA4444(const uint8_t *s) {
+	uint32_t clr = s[0] | (s[1] << 8);
+	return pack_color(expand_channel(clr >> 12, 0x0F), expand_channel(clr >> 8, 0x0F), expand_channel(clr >> 4, 0x0F), expand_channel(clr, 0x0F));
+}
+
+/*
+ * Scalar encoders, they store a RGBA sample the same way the write callbacks do
+ */
+static inline void encode_RGBA8(uint8_t *d, uint32_t c) {
+	d[0] = c;
+	d[1] = c >> 8;
+	d[2] = c >> 16;
+	d[3] = c >> 24;
+}
+
+static inline void encode_BGRA8(uint8_t *d, uint32_t c) {
+	d[0] = c >> 16;
+	d[1] = c >> 8;
+	d[2] = c;
+	d[3] = c >> 24;
+}
+
+static inline void encode_ABGR8(uint8_t *d, uint32_t c) {
+	d[0] = c >> 24;
+	d[1] = c >> 16;
+	d[2] = c >> 8;
+	d[3] = c;
+}
+
+static inline void encode_RGB8(uint8_t *d, uint32_t c) {
+	d[0] = c;
+	d[1] = c >> 8;
+	d[2] = c >> 16;
+}
+
+static inline void encode_BGR8(uint8_t *d, uint32_t c) {
+	d[0] = c >> 16;
+	d[1] = c >> 8;
+	d[2] = c;
+}
+
+static inline void encode_RG8(uint8_t *d, uint32_t c) {
+	d[0] = c;
+	d[1] = c >> 8;
+}
+
+static inline void encode_R8(uint8_t *d, uint32_t c) {
+	d[0] = c;
+}
+
+static inline void encode_L8(uint8_t *d, uint32_t c) {
+	d[0] = c;
+}
+
+static inline void encode_LA8(uint8_t *d, uint32_t c) {
+	d[0] = c;
+	d[1] = c >> 24;
+}
+
+// Scalar row converter, also used to process the pixels left out by vectorized ones
+#define DEFINE_SCALAR_ROW(src, dst) \
+	static void convert_##src##_to_##dst(void *dst_ptr, const void *src_ptr, uint32_t num) { \
+		const uint8_t *s = (const uint8_t *)src_ptr; \
+		uint8_t *d = (uint8_t *)dst_ptr; \
+		while (num--) { \
+			encode_##dst(d, decode_##src(s)); \
+			s += src##_BPP; \
+			d += dst##_BPP; \
+		} \
+	}
+
+#ifdef __ARM_NEON
+/*
+ * NEON decoders, they load 16 pixels split in R, G, B and A channels
+ */
+#define neon_channels(r, g, b, a) \
+	res.val[0] = r; \
+	res.val[1] = g; \
+	res.val[2] = b; \
+	res.val[3] = a;
+
+static inline uint8x16x4_t neon_decode_RGBA8(const uint8_t *s) {
+	return vld4q_u8(s);
+}
+
+static inline uint8x16x4_t neon_decode_BGRA8(const uint8_t *s) {
+	uint8x16x4_t res, in = vld4q_u8(s);
+	neon_channels(in.val[2], in.val[1], in.val[0], in.val[3]);
+	return res;
+}
+
+static inline uint8x16x4_t neon_decode_ABGR8(const uint8_t *s) {
+	uint8x16x4_t res, in = vld4q_u8(s);
+	neon_channels(in.val[3], in.val[2], in.val[1], in.val[0]);
+	return res;
+}
+
+static inline uint8x16x4_t neon_decode_RGB8(const uint8_t *s) {
+	uint8x16x4_t res;
+	uint8x16x3_t in = vld3q_u8(s);
+	neon_channels(in.val[0], in.val[1], in.val[2], vdupq_n_u8(0xFF));
+	return res;
+}
+
+static inline uint8x16x4_t neon_decode_BGR8(const uint8_t *s) {
+	uint8x16x4_t res;
+	uint8x16x3_t in = vld3q_u8(s);
+	neon_channels(in.val[2], in.val[1], in.val[0], vdupq_n_u8(0xFF));
+	return res;
+}
+
+static inline uint8x16x4_t neon_decode_RG8(const uint8_t *s) {
+	uint8x16x4_t res;
+	uint8x16x2_t in = vld2q_u8(s);
+	neon_channels(in.val[0], in.val[1], vdupq_n_u8(0xFF), vdupq_n_u8(0xFF));
+	return res;
+}
+
+static inline uint8x16x4_t neon_decode_R8(const uint8_t *s) {
+	uint8x16x4_t res;
+	neon_channels(vld1q_u8(s), vdupq_n_u8(0xFF), vdupq_n_u8(0xFF), vdupq_n_u8(0xFF));
+	return res;
+}
+
+static inline uint8x16x4_t neon_decode_L8(const uint8_t *s) {
+	uint8x16x4_t res;
+	uint8x16_t l = vld1q_u8(s);
+	neon_channels(l, l, l, vdupq_n_u8(0xFF));
+	return res;
+}
+
+static inline uint8x16x4_t neon_decode_LA8(const uint8_t *s) {
+	uint8x16x4_t res;
+	uint8x16x2_t in = vld2q_u8(s);
+	neon_channels(in.val[0], in.val[0], in.val[0], in.val[1]);
+	return res;
+}
+
+// Packed channels expansion to 8 bits, (v * 0xFF) / mask computed without divisions
+static inline uint16x8_t neon_expand5(uint16x8_t v) {
+	return vshrq_n_u16(vmulq_n_u16(v, 1053), 7);
+}
+
+static inline uint16x8_t neon_expand6(uint16x8_t v) {
+	uint16x8_t v255 = vmulq_n_u16(v, 0xFF);
+	uint16x4_t lo = vmovn_u32(vshrq_n_u32(vmull_n_u16(vget_low_u16(v255), 8323), 19));
+	uint16x4_t hi = vmovn_u32(vshrq_n_u32(vmull_n_u16(vget_high_u16(v255), 8323), 19));
+	return vcombine_u16(lo, hi);
+}
+
+static inline uint16x8_t neon_expand4(uint16x8_t v) {
+	return vmulq_n_u16(v, 0x11);
+}
+
+static inline uint16x8_t neon_expand1(uint16x8_t v) {
+	return vmulq_n_u16(v, 0xFF);
+}
+
+#define neon_field(p, shift, mask) vandq_u16(vshrq_n_u16(p, shift), vdupq_n_u16(mask))
+#define neon_narrow(lo, hi) vcombine_u8(vmovn_u16(lo), vmovn_u16(hi))
+
+static inline uint8x16x4_t neon_decode_RGB565(const uint8_t *s) {
+	uint8x16x4_t res;
+	uint16x8_t p0 = vld1q_u16((const uint16_t *)s);
+	uint16x8_t p1 = vld1q_u16((const uint16_t *)(s + 16));
+	neon_channels(
+		neon_narrow(neon_expand5(vshrq_n_u16(p0, 11)), neon_expand5(vshrq_n_u16(p1, 11))),
+		neon_narrow(neon_expand6(neon_field(p0, 5, 0x3F)), neon_expand6(neon_field(p1, 5, 0x3F))),
+		neon_narrow(neon_expand5(neon_field(p0, 0, 0x1F)), neon_expand5(neon_field(p1, 0, 0x1F))),
+		vdupq_n_u8(0xFF));
+	return res;
+}
+
+static inline uint8x16x4_t neon_decode_RGBA5551(const uint8_t *s) {
+	uint8x16x4_t res;
+	uint16x8_t p0 = vld1q_u16((const uint16_t *)s);
+	uint16x8_t p1 = vld1q_u16((const uint16_t *)(s + 16));
+	neon_channels(
+		neon_narrow(neon_expand5(vshrq_n_u16(p0, 11)), neon_expand5(vshrq_n_u16(p1, 11))),
+		neon_narrow(neon_expand5(neon_field(p0, 6, 0x1F)), neon_expand5(neon_field(p1, 6, 0x1F))),
+		neon_narrow(neon_expand5(neon_field(p0, 1, 0x1F)), neon_expand5(neon_field(p1, 1, 0x1F))),
+		neon_narrow(neon_expand1(neon_field(p0, 0, 0x01)), neon_expand1(neon_field(p1, 0, 0x01))));
+	return res;
+}
+
+static inline uint8x16x4_t neon_decode_RGBA4444(const uint8_t *s) {
+	uint8x16x4_t res;
+	uint16x8_t p0 = vld1q_u16((const uint16_t *)s);
+	uint16x8_t p1 = vld1q_u16((const uint16_t *)(s + 16));
+	neon_channels(
+		neon_narrow(neon_expand4(vshrq_n_u16(p0, 12)), neon_expand4(vshrq_n_u16(p1, 12))),
+		neon_narrow(neon_expand4(neon_field(p0, 8, 0x0F)), neon_expand4(neon_field(p1, 8, 0x0F))),
+		neon_narrow(neon_expand4(neon_field(p0, 4, 0x0F)), neon_expand4(neon_field(p1, 4, 0x0F))),
+		neon_narrow(neon_expand4(neon_field(p0, 0, 0x0F)), neon_expand4(neon_field(p1, 0, 0x0F))));
+	return res;
+}
+
+/*
+ * NEON encoders, they store 16 pixels from R, G, B and A channels
+ */
+static inline void neon_encode_RGBA8(uint8_t *d, uint8x16x4_t c) {
+	vst4q_u8(d, c);
+}
+
+static inline void neon_encode_BGRA8(uint8_t *d, uint8x16x4_t c) {
+	uint8x16x4_t out;
+	out.val[0] = c.val[2];
+	out.val[1] = c.val[1];
+	out.val[2] = c.val[0];
+	out.val[3] = c.val[3];
+	vst4q_u8(d, out);
+}
+
+static inline void neon_encode_ABGR8(uint8_t *d, uint8x16x4_t c) {
+	uint8x16x4_t out;
+	out.val[0] = c.val[3];
+	out.val[1] = c.val[2];
+	out.val[2] = c.val[1];
+	out.val[3] = c.val[0];
+	vst4q_u8(d, out);
+}
+
+static inline void neon_encode_RGB8(uint8_t *d, uint8x16x4_t c) {
+	uint8x16x3_t out;
+	out.val[0] = c.val[0];
+	out.val[1] = c.val[1];
+	out.val[2] = c.val[2];
+	vst3q_u8(d, out);
+}
+
+static inline void neon_encode_BGR8(uint8_t *d, uint8x16x4_t c) {
+	uint8x16x3_t out;
+	out.val[0] = c.val[2];
+	out.val[1] = c.val[1];
+	out.val[2] = c.val[0];
+	vst3q_u8(d, out);
+}
+
+static inline void neon_encode_RG8(uint8_t *d, uint8x16x4_t c) {
+	uint8x16x2_t out;
+	out.val[0] = c.val[0];
+	out.val[1] = c.val[1];
+	vst2q_u8(d, out);
+}
+
+static inline void neon_encode_R8(uint8_t *d, uint8x16x4_t c) {
+	vst1q_u8(d, c.val[0]);
+}
+
+static inline void neon_encode_L8(uint8_t *d, uint8x16x4_t c) {
+	vst1q_u8(d, c.val[0]);
+}
+
+static inline void neon_encode_LA8(uint8_t *d, uint8x16x4_t c) {
+	uint8x16x2_t out;
+	out.val[0] = c.val[0];
+	out.val[1] = c.val[3];
+	vst2q_u8(d, out);
+}
+
+// NEON row converter, processes 16 pixels per iteration and leaves the remaining ones to the scalar one
+#define DEFINE_ROW(src, dst) \
+	DEFINE_SCALAR_ROW(src, dst) \
+	static void neon_convert_##src##_to_##dst(void *dst_ptr, const void *src_ptr, uint32_t num) { \
+		const uint8_t *s = (const uint8_t *)src_ptr; \
+		uint8_t *d = (uint8_t *)dst_ptr; \
+		while (num >= 16) { \
+			neon_encode_##dst(d, neon_decode_##src(s)); \
+			s += src##_BPP * 16; \
+			d += dst##_BPP * 16; \
+			num -= 16; \
+		} \
+		convert_##src##_to_##dst(d, s, num); \
+	}
+#define ROW(src, dst) neon_convert_##src##_to_##dst
+#else
+#define DEFINE_ROW(src, dst) DEFINE_SCALAR_ROW(src, dst)
+#define ROW(src, dst) convert_##src##_to_##dst
+#endif
+
+#define DEFINE_ROWS(src) \
+	DEFINE_ROW(src, RGBA8) \
+	DEFINE_ROW(src, BGRA8) \
+	DEFINE_ROW(src, ABGR8) \
+	DEFINE_ROW(src, RGB8) \
+	DEFINE_ROW(src, BGR8) \
+	DEFINE_ROW(src, RG8) \
+	DEFINE_ROW(src, R8) \
+	DEFINE_ROW(src, L8) \
+	DEFINE_ROW(src, LA8)
+
+DEFINE_ROWS(RGBA8)
+DEFINE_ROWS(BGRA8)
+DEFINE_ROWS(ABGR8)
+DEFINE_ROWS(RGB8)
+DEFINE_ROWS(BGR8)
+DEFINE_ROWS(RG8)
+DEFINE_ROWS(R8)
+DEFINE_ROWS(L8)
+DEFINE_ROWS(LA8)
+DEFINE_ROWS(RGB565)
+DEFINE_ROWS(RGBA5551)
+DEFINE_ROWS(RGBA4444)
+
+#define ROWS_ENTRY(src) \
+	[PIXEL_FMT_##src] = { \
+		[PIXEL_FMT_RGBA8] = ROW(src, RGBA8), \
+		[PIXEL_FMT_BGRA8] = ROW(src, BGRA8), \
+		[PIXEL_FMT_ABGR8] = ROW(src, ABGR8), \
+		[PIXEL_FMT_RGB8] = ROW(src, RGB8), \
+		[PIXEL_FMT_BGR8] = ROW(src, BGR8), \
+		[PIXEL_FMT_RG8] = ROW(src, RG8), \
+		[PIXEL_FMT_R8] = ROW(src, R8), \
+		[PIXEL_FMT_L8] = ROW(src, L8), \
+		[PIXEL_FMT_LA8] = ROW(src, LA8), \
+	},
+
+// Row converters table, indexed by source and destination formats
+static const pixel_row_cb row_converters[PIXEL_FMT_NUM][PIXEL_FMT_NUM] = {
+	ROWS_ENTRY(RGBA8)
+	ROWS_ENTRY(BGRA8)
+	ROWS_ENTRY(ABGR8)
+	ROWS_ENTRY(RGB8)
+	ROWS_ENTRY(BGR8)
+	ROWS_ENTRY(RG8)
+	ROWS_ENTRY(R8)
+	ROWS_ENTRY(L8)
+	ROWS_ENTRY(LA8)
+	ROWS_ENTRY(RGB565)
+	ROWS_ENTRY(RGBA5551)
+	ROWS_ENTRY(RGBA4444)
+};
+
+static const uint8_t pixel_fmt_bpps[PIXEL_FMT_NUM] = {
+	RGBA8_BPP,
+	BGRA8_BPP,
+	ABGR8_BPP,
+	RGB8_BPP,
+	BGR8_BPP,
+	RG8_BPP,
+	R8_BPP,
+	L8_BPP,
+	LA8_BPP,
+	RGB565_BPP,
+	RGBA5551_BPP,
+	RGBA4444_BPP
+};
+
+uint8_t pixel_fmt_bpp(pixel_fmt fmt) {
+	return fmt < PIXEL_FMT_NUM ? pixel_fmt_bpps[fmt] : 0;
+}
+
+pixel_row_cb get_pixel_row_converter(pixel_fmt src, pixel_fmt dst) {
+	if (src >= PIXEL_FMT_NUM || dst >= PIXEL_FMT_NUM)
+		return NULL;
+	return row_converters[src][dst];
+}
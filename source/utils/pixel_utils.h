@@ -0,0 +1,53 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * pixel_utils.h:
+ * Header file for the row based pixel converters exposed by pixel_utils.c
+ */
+
+#ifndef _PIXEL_UTILS_H_
+#define _PIXEL_UTILS_H_
+
+#include <stdint.h>
+
+// Pixel formats handled by row converters (channels are the ones produced and consumed by texture_callbacks.c)
+typedef enum {
+	PIXEL_FMT_RGBA8, // readRGBA / writeRGBA
+	PIXEL_FMT_BGRA8, // readBGRA / writeBGRA
+	PIXEL_FMT_ABGR8, // readABGR / writeABGR
+	PIXEL_FMT_RGB8, // readRGB / writeRGB
+	PIXEL_FMT_BGR8, // readBGR / writeBGR
+	PIXEL_FMT_RG8, // readRG / writeRG
+	PIXEL_FMT_R8, // readR / writeR
+	PIXEL_FMT_L8, // readL / writeR
+	PIXEL_FMT_LA8, // readLA / writeRA
+	PIXEL_FMT_RGB565, // readRGB565 (source only)
+	PIXEL_FMT_RGBA5551, // readRGBA5551 (source only)
+	PIXEL_FMT_RGBA4444, // readRGBA4444 (source only)
+	PIXEL_FMT_NUM,
+	PIXEL_FMT_INVALID = PIXEL_FMT_NUM
+} pixel_fmt;
+
+// Converts num pixels from src to dst
+typedef void (*pixel_row_cb)(void *dst, const void *src, uint32_t num);
+
+uint8_t pixel_fmt_bpp(pixel_fmt fmt);
+pixel_row_cb get_pixel_row_converter(pixel_fmt src, pixel_fmt dst);
+
+#endif
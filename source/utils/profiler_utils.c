@@ -0,0 +1,237 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * profiler_utils.c:
+ * CPU profiling zones recording, aggregation and Chrome Trace Event export
+ */
+
+#include "../shared.h"
+#include <psp2/kernel/threadmgr.h>
+
+#ifdef HAVE_PROFILER
+#define PROFILER_EVENTS_MASK (PROFILER_EVENTS_NUM - 1)
+#define PROFILER_FRAMES_MASK (PROFILER_FRAMES_NUM - 1)
+
+// Completed zone
+typedef struct {
+	uint64_t start;
+	uint32_t duration;
+	uint32_t zone;
+} profiler_event;
+
+// Aggregated timings of a zone
+typedef struct {
+	uint32_t calls;
+	uint32_t min;
+	uint32_t max;
+	uint64_t total;
+} profiler_aggregate;
+
+// Per-thread recording state, only written by the owning thread
+typedef struct {
+	volatile SceUID thid; // 0 for unclaimed slots
+	volatile uint32_t head; // Number of events ever written in the ring
+	volatile uint32_t generation; // Reset generation aggregates refer to
+	profiler_event events[PROFILER_EVENTS_NUM];
+	profiler_aggregate zones[PROFILER_ZONES_NUM];
+} profiler_thread;
+
+static const char *zone_names[] = {
+#define PROFILER_ZONE(id, name) name,
+	PROFILER_ZONES
+#undef PROFILER_ZONE
+};
+
+static profiler_thread threads[PROFILER_MAX_THREADS];
+static uint64_t frames[PROFILER_FRAMES_NUM]; // End time of the last frames (only written by the rendering thread)
+static volatile uint32_t frames_head = 0; // Number of frames ended since last reset
+static volatile uint32_t generation = 0; // Bumped on every reset
+static volatile uint64_t reset_time = 0; // Time of last reset, older events are ignored
+static SceUID render_thid = 0;
+
+static profiler_thread *get_thread(void) {
+	SceUID thid = sceKernelGetThreadId();
+	for (int i = 0; i < PROFILER_MAX_THREADS; i++) {
+		SceUID cur = threads[i].thid;
+		if (cur == thid)
+			return &threads[i];
+		if (!cur && __sync_bool_compare_and_swap(&threads[i].thid, 0, thid))
+			return &threads[i];
+	}
+	// All slots are in use, the zone is not recorded
+	return NULL;
+}
+
+profiler_scope profiler_zone_begin(uint32_t zone) {
+	profiler_scope s = {sceKernelGetProcessTimeWide(), zone};
+	return s;
+}
+
+void profiler_zone_end(profiler_scope *scope) {
+	uint64_t end = sceKernelGetProcessTimeWide();
+	profiler_thread *t = get_thread();
+	if (!t)
+		return;
+	uint32_t duration = end - scope->start;
+
+	// Publishing the event only once fully written so that dumps never read a partial one
+	profiler_event *e = &t->events[t->head & PROFILER_EVENTS_MASK];
+	e->start = scope->start;
+	e->duration = duration;
+	e->zone = scope->zone;
+	__atomic_store_n(&t->head, t->head + 1, __ATOMIC_RELEASE);
+
+	// Aggregates are cleared lazily by their owner after a reset
+	uint32_t gen = generation;
+	if (t->generation != gen) {
+		sceClibMemset(t->zones, 0, sizeof(t->zones));
+		t->generation = gen;
+	}
+	profiler_aggregate *a = &t->zones[scope->zone];
+	if (!a->calls || duration < a->min)
+		a->min = duration;
+	if (duration > a->max)
+		a->max = duration;
+	a->total += duration;
+	a->calls++;
+}
+
+void profiler_frame(void) {
+	render_thid = sceKernelGetThreadId();
+	frames[frames_head & PROFILER_FRAMES_MASK] = sceKernelGetProcessTimeWide();
+	__sync_synchronize();
+	frames_head++;
+}
+
+static void dump_event(FILE *f, int *first, const char *name, SceUID tid, uint64_t start, uint32_t duration) {
+	fprintf(f, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%llu,\"dur\":%u}", *first ? "" : ",", name, tid, (unsigned long long)start, duration);
+	*first = 0;
+}
+
+static void dump_thread_name(FILE *f, int *first, SceUID tid, const char *name) {
+	fprintf(f, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", *first ? "" : ",", tid, name);
+	*first = 0;
+}
+#endif
+
+GLboolean vglDumpProfilerTrace(const char *path, uint32_t num_frames) {
+#ifdef HAVE_PROFILER
+	// Picking the time range covered by the requested frames
+	uint32_t head = frames_head;
+	if (!head || !num_frames)
+		return GL_FALSE;
+	if (num_frames > PROFILER_FRAMES_NUM - 1)
+		num_frames = PROFILER_FRAMES_NUM - 1;
+	if (num_frames > head)
+		num_frames = head;
+	uint64_t bounds[PROFILER_FRAMES_NUM];
+	bounds[0] = num_frames == head ? reset_time : frames[(head - num_frames - 1) & PROFILER_FRAMES_MASK];
+	for (uint32_t i = 1; i <= num_frames; i++) {
+		bounds[i] = frames[(head - num_frames - 1 + i) & PROFILER_FRAMES_MASK];
+	}
+	uint64_t from = bounds[0];
+	uint64_t to = bounds[num_frames];
+
+	FILE *f = fopen(path, "w");
+	if (!f)
+		return GL_FALSE;
+	int first = 1;
+	fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+	// Frames are shown on a dedicated track
+	dump_thread_name(f, &first, 0, "Frames");
+	for (uint32_t i = 0; i < num_frames; i++) {
+		char name[32];
+		sprintf(name, "Frame %u", head - num_frames + i);
+		dump_event(f, &first, name, 0, bounds[i], bounds[i + 1] - bounds[i]);
+	}
+
+	for (int i = 0; i < PROFILER_MAX_THREADS; i++) {
+		profiler_thread *t = &threads[i];
+		SceUID thid = t->thid;
+		if (!thid)
+			continue;
+		char name[32];
+		if (thid == render_thid)
+			strcpy(name, "Rendering thread");
+		else
+			sprintf(name, "Thread 0x%08X", thid);
+		dump_thread_name(f, &first, thid, name);
+
+		// The owner keeps writing while we read, events it may have overwritten meanwhile are skipped
+		uint32_t end = t->head;
+		__sync_synchronize();
+		uint32_t begin = end > PROFILER_EVENTS_NUM ? end - PROFILER_EVENTS_NUM : 0;
+		for (uint32_t j = begin; j < end; j++) {
+			profiler_event e = t->events[j & PROFILER_EVENTS_MASK];
+			__sync_synchronize();
+			if (t->head - j > PROFILER_EVENTS_NUM)
+				continue;
+			if (e.start < from || e.start >= to)
+				continue;
+			dump_event(f, &first, zone_names[e.zone], thid, e.start, e.duration);
+		}
+	}
+
+	fprintf(f, "\n]}\n");
+	fclose(f);
+	return GL_TRUE;
+#else
+	return GL_FALSE;
+#endif
+}
+
+int vglGetProfilerZoneStats(vglProfilerZoneStats *stats, int max_zones) {
+#ifdef HAVE_PROFILER
+	int num = max_zones < PROFILER_ZONES_NUM ? max_zones : PROFILER_ZONES_NUM;
+	sceClibMemset(stats, 0, num * sizeof(vglProfilerZoneStats));
+	for (int i = 0; i < num; i++) {
+		stats[i].name = zone_names[i];
+	}
+	uint32_t gen = generation;
+	for (int i = 0; i < PROFILER_MAX_THREADS; i++) {
+		profiler_thread *t = &threads[i];
+		if (!t->thid || t->generation != gen)
+			continue;
+		for (int j = 0; j < num; j++) {
+			profiler_aggregate *a = &t->zones[j];
+			if (!a->calls)
+				continue;
+			if (!stats[j].calls || a->min < stats[j].min_time)
+				stats[j].min_time = a->min;
+			if (a->max > stats[j].max_time)
+				stats[j].max_time = a->max;
+			stats[j].total_time += a->total;
+			stats[j].calls += a->calls;
+		}
+	}
+	return num;
+#else
+	return 0;
+#endif
+}
+
+void vglResetProfiler(void) {
+#ifdef HAVE_PROFILER
+	reset_time = sceKernelGetProcessTimeWide();
+	frames_head = 0;
+	__sync_synchronize();
+	__sync_fetch_and_add(&generation, 1);
+#endif
+}
@@ -0,0 +1,83 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * profiler_utils.h:
+ * Header file for the CPU profiling zones exposed by profiler_utils.c
+ */
+
+#ifndef _PROFILER_UTILS_H_
+#define _PROFILER_UTILS_H_
+
+#include <stdint.h>
+
+#define PROFILER_MAX_THREADS 8 // Maximum number of threads whose zones get recorded
+#define PROFILER_EVENTS_NUM 8192 // Number of zone events kept per thread (must be a power of two)
+#define PROFILER_FRAMES_NUM 128 // Number of frame boundaries kept (must be a power of two)
+
+// Profiled zones, the name is the one shown in traces
+#define PROFILER_ZONES \
+	PROFILER_ZONE(SWAP_BUFFERS, "vglSwapBuffers") \
+	PROFILER_ZONE(SCENE_RESET, "sceneReset") \
+	PROFILER_ZONE(GARBAGE_COLLECTOR, "garbage_collector") \
+	PROFILER_ZONE(FFP_DRAW_ARRAYS, "_glDrawArrays_FixedFunctionIMPL") \
+	PROFILER_ZONE(FFP_DRAW_ELEMENTS, "_glDrawElements_FixedFunctionIMPL") \
+	PROFILER_ZONE(SHADERS_DRAW_ARRAYS, "_glDrawArrays_CustomShadersIMPL") \
+	PROFILER_ZONE(SHADERS_DRAW_ELEMENTS, "_glDrawElements_CustomShadersIMPL") \
+	PROFILER_ZONE(SHADERS_DRAW_OBJECTS, "_vglDrawObjects_CustomShadersIMPL") \
+	PROFILER_ZONE(RELOAD_FFP_SHADERS, "reload_ffp_shaders") \
+	PROFILER_ZONE(PATCH_VERTEX_PROGRAM, "patch_vertex_program_cached") \
+	PROFILER_ZONE(CALL_LIST, "glCallList") \
+	PROFILER_ZONE(ALLOC_TEXTURE, "gpu_alloc_texture") \
+	PROFILER_ZONE(ALLOC_CUBE_TEXTURE, "gpu_alloc_cube_texture") \
+	PROFILER_ZONE(ALLOC_PALETTED_TEXTURE, "gpu_alloc_paletted_texture") \
+	PROFILER_ZONE(ALLOC_COMPRESSED_TEXTURE, "gpu_alloc_compressed_texture") \
+	PROFILER_ZONE(ALLOC_MIPMAPS, "gpu_alloc_mipmaps") \
+	PROFILER_ZONE(MALLOC, "vgl_malloc") \
+	PROFILER_ZONE(MEMALIGN, "vgl_memalign")
+
+typedef enum {
+#define PROFILER_ZONE(id, name) PROFILER_ZONE_##id,
+	PROFILER_ZONES
+#undef PROFILER_ZONE
+	PROFILER_ZONES_NUM
+} profiler_zone;
+
+#ifdef HAVE_PROFILER
+// Running zone, closed when going out of scope
+typedef struct {
+	uint64_t start;
+	uint32_t zone;
+} profiler_scope;
+
+profiler_scope profiler_zone_begin(uint32_t zone);
+void profiler_zone_end(profiler_scope *scope);
+void profiler_frame(void);
+
+/*
+ * Opens a zone lasting until the end of the enclosing block.
+ * Events are written by the thread running the zone in its own ring, so no lock is ever taken.
+ */
+#define PROFILE_ZONE(id) profiler_scope _profiler_scope __attribute__((cleanup(profiler_zone_end))) = profiler_zone_begin(PROFILER_ZONE_##id)
+#define PROFILE_FRAME() profiler_frame()
+#else
+#define PROFILE_ZONE(id)
+#define PROFILE_FRAME()
+#endif
+
+#endif
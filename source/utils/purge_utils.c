@@ -0,0 +1,194 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * purge_utils.c:
+ * Deferred destruction of resources still in use by the GPU
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "purge_utils.h"
+
+#ifdef __vita__
+#include <psp2/kernel/threadmgr.h>
+typedef SceUID purge_mutex;
+#define mutex_create(m) m = sceKernelCreateMutex("Purge Queue Mutex", 0, 0, NULL)
+#define mutex_destroy(m) sceKernelDeleteMutex(m)
+#define mutex_lock(m) sceKernelLockMutex(m, 1, NULL)
+#define mutex_unlock(m) sceKernelUnlockMutex(m, 1)
+#else
+#include <pthread.h>
+typedef pthread_mutex_t purge_mutex;
+#define mutex_create(m) pthread_mutex_init(&m, NULL)
+#define mutex_destroy(m) pthread_mutex_destroy(&m)
+#define mutex_lock(m) pthread_mutex_lock(&m)
+#define mutex_unlock(m) pthread_mutex_unlock(&m)
+#endif
+
+static purge_cb purge_cbs[PURGE_MAX_KINDS];
+static purge_mutex queue_mutex;
+static purge_batch *cur_batch = NULL; // Batch being populated (only accessed by the rendering thread)
+static purge_batch *pending_head = NULL; // Oldest submitted batch
+static purge_batch *pending_tail = NULL; // Newest submitted batch
+static purge_batch *spare_batches = NULL; // Released batches ready to be reused
+static int queue_initialized = 0;
+
+static purge_batch *batch_new(void) {
+	purge_batch *b;
+	mutex_lock(queue_mutex);
+	b = spare_batches;
+	if (b)
+		spare_batches = b->next;
+	mutex_unlock(queue_mutex);
+	if (!b) {
+		b = (purge_batch *)calloc(1, sizeof(purge_batch));
+		if (!b)
+			return NULL;
+	}
+	b->num = 0;
+	b->next = NULL;
+	return b;
+}
+
+static void batch_release(purge_batch *b) {
+	for (uint32_t i = 0; i < b->num; i++) {
+		purge_cbs[b->elems[i].kind](b->elems[i].ptr);
+	}
+	b->num = 0;
+}
+
+void purge_queue_init(const purge_cb *cbs, int cbs_num) {
+	if (queue_initialized)
+		purge_queue_term();
+	if (cbs_num > PURGE_MAX_KINDS)
+		cbs_num = PURGE_MAX_KINDS;
+	memcpy(purge_cbs, cbs, cbs_num * sizeof(purge_cb));
+	mutex_create(queue_mutex);
+	queue_initialized = 1;
+	cur_batch = batch_new();
+}
+
+void purge_queue_term(void) {
+	if (!queue_initialized)
+		return;
+	purge_queue_flush();
+	purge_batch *b = spare_batches;
+	while (b) {
+		purge_batch *next = b->next;
+		free(b->elems);
+		free(b);
+		b = next;
+	}
+	spare_batches = NULL;
+	if (cur_batch) {
+		free(cur_batch->elems);
+		free(cur_batch);
+		cur_batch = NULL;
+	}
+	mutex_destroy(queue_mutex);
+	queue_initialized = 0;
+}
+
+void purge_queue_mark(uint32_t kind, void *ptr) {
+	purge_batch *b = cur_batch;
+	if (!ptr || !b)
+		return;
+	if (b->num == b->size) {
+		uint32_t new_size = b->size ? b->size * 2 : PURGE_BATCH_DEF_SIZE;
+		purge_elem *new_elems = (purge_elem *)realloc(b->elems, new_size * sizeof(purge_elem));
+		if (!new_elems) {
+			// Leaking is safer than releasing something the GPU may still be using
+			return;
+		}
+		b->elems = new_elems;
+		b->size = new_size;
+	}
+	b->elems[b->num].ptr = ptr;
+	b->elems[b->num].kind = kind;
+	b->num++;
+}
+
+void purge_queue_submit(uint32_t seq) {
+	purge_batch *b = cur_batch;
+	if (!b || !b->num)
+		return;
+
+	// Starting a new batch before handing the current one over to the collector
+	purge_batch *new_batch = batch_new();
+	if (!new_batch)
+		return;
+	cur_batch = new_batch;
+
+	b->seq = seq;
+	mutex_lock(queue_mutex);
+	if (pending_tail)
+		pending_tail->next = b;
+	else
+		pending_head = b;
+	pending_tail = b;
+	mutex_unlock(queue_mutex);
+}
+
+int purge_queue_ready(uint32_t completed_seq) {
+	mutex_lock(queue_mutex);
+	int res = pending_head && purge_seq_reached(pending_head->seq, completed_seq);
+	mutex_unlock(queue_mutex);
+	return res;
+}
+
+void purge_queue_collect(uint32_t completed_seq) {
+	for (;;) {
+		// Batches are submitted in sequence order, so we can stop at the first one not completed yet
+		mutex_lock(queue_mutex);
+		purge_batch *b = pending_head;
+		if (!b || !purge_seq_reached(b->seq, completed_seq)) {
+			mutex_unlock(queue_mutex);
+			return;
+		}
+		pending_head = b->next;
+		if (!pending_head)
+			pending_tail = NULL;
+		mutex_unlock(queue_mutex);
+
+		batch_release(b);
+
+		mutex_lock(queue_mutex);
+		b->next = spare_batches;
+		spare_batches = b;
+		mutex_unlock(queue_mutex);
+	}
+}
+
+void purge_queue_flush(void) {
+	mutex_lock(queue_mutex);
+	purge_batch *b = pending_head;
+	pending_head = pending_tail = NULL;
+	mutex_unlock(queue_mutex);
+	while (b) {
+		purge_batch *next = b->next;
+		batch_release(b);
+		mutex_lock(queue_mutex);
+		b->next = spare_batches;
+		spare_batches = b;
+		mutex_unlock(queue_mutex);
+		b = next;
+	}
+	if (cur_batch)
+		batch_release(cur_batch);
+}
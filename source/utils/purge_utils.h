@@ -0,0 +1,61 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * purge_utils.h:
+ * Header file for the deferred destruction utilities exposed by purge_utils.c
+ */
+
+#ifndef _PURGE_UTILS_H_
+#define _PURGE_UTILS_H_
+
+#include <stdint.h>
+
+#define PURGE_BATCH_DEF_SIZE 256 // Initial number of elements a purge batch can hold
+#define PURGE_MAX_KINDS 4 // Maximum number of element kinds
+
+// Purge callback, releases a single element
+typedef void (*purge_cb)(void *ptr);
+
+// Element marked for deletion
+typedef struct {
+	void *ptr;
+	uint32_t kind;
+} purge_elem;
+
+// Batch of elements released together once the GPU completes the sequence they got submitted with
+typedef struct purge_batch {
+	purge_elem *elems;
+	uint32_t num;
+	uint32_t size;
+	uint32_t seq; // Last sequence number that may reference the elements
+	struct purge_batch *next;
+} purge_batch;
+
+// Returns non zero if sequence a has been reached by sequence b (wrap-around safe)
+#define purge_seq_reached(a, b) ((int32_t)((b) - (a)) >= 0)
+
+void purge_queue_init(const purge_cb *cbs, int cbs_num);
+void purge_queue_term(void);
+void purge_queue_mark(uint32_t kind, void *ptr);
+void purge_queue_submit(uint32_t seq);
+int purge_queue_ready(uint32_t completed_seq);
+void purge_queue_collect(uint32_t completed_seq);
+void purge_queue_flush(void);
+
+#endif
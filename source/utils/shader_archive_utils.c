@@ -0,0 +1,373 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * shader_archive_utils.c:
+ * Single file archive for compiled shader binaries with crash safe appends
+ */
+
+#include <dirent.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "shader_archive_utils.h"
+#include "shader_cache_utils.h"
+
+// Archive layout: header, sorted index, blobs written by the last compaction, journal records
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entries_num;
+	uint32_t index_checksum;
+	uint32_t data_end; // Offset where the journal starts
+	uint32_t reserved[3];
+} archive_header;
+
+// Header of a journal record, followed by the blob payload
+typedef struct {
+	uint32_t magic;
+	uint32_t size;
+	uint64_t key;
+	uint32_t checksum; // Payload checksum
+	uint32_t header_checksum; // Checksum of the previous fields
+} record_header;
+
+uint64_t shader_archive_key(const char *name) {
+	return shader_cache_hash_finalize(shader_cache_hash(name, strlen(name), SHADER_HASH_SEED));
+}
+
+static int lower_bound(shader_archive *a, uint64_t key) {
+	int lo = 0, hi = a->num;
+	while (lo < hi) {
+		int mid = (lo + hi) >> 1;
+		if (a->entries[mid].key < key)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+static shader_archive_entry *find_entry(shader_archive *a, uint64_t key) {
+	int i = lower_bound(a, key);
+	return (uint32_t)i < a->num && a->entries[i].key == key ? &a->entries[i] : NULL;
+}
+
+static int insert_entry(shader_archive *a, uint64_t key, uint32_t offset, uint32_t size, uint32_t checksum) {
+	int i = lower_bound(a, key);
+	if ((uint32_t)i == a->num || a->entries[i].key != key) {
+		if (a->num == a->capacity) {
+			uint32_t new_capacity = a->capacity ? a->capacity * 2 : 64;
+			shader_archive_entry *new_entries = (shader_archive_entry *)realloc(a->entries, new_capacity * sizeof(shader_archive_entry));
+			if (!new_entries)
+				return 0;
+			a->entries = new_entries;
+			a->capacity = new_capacity;
+		}
+		memmove(&a->entries[i + 1], &a->entries[i], (a->num - i) * sizeof(shader_archive_entry));
+		a->num++;
+	} else
+		a->dead += a->entries[i].size;
+	shader_archive_entry *e = &a->entries[i];
+	e->key = key;
+	e->offset = offset;
+	e->size = size;
+	e->checksum = checksum;
+	e->reserved = 0;
+	return 1;
+}
+
+static void remove_entry(shader_archive *a, shader_archive_entry *e) {
+	a->dead += e->size;
+	a->num--;
+	memmove(e, e + 1, (uint8_t *)&a->entries[a->num] - (uint8_t *)e);
+}
+
+static int load_archive(shader_archive *a) {
+	archive_header h;
+	if (fseek(a->f, 0, SEEK_END))
+		return 0;
+	long file_size = ftell(a->f);
+	if (file_size < (long)sizeof(archive_header) || fseek(a->f, 0, SEEK_SET) || fread(&h, sizeof(h), 1, a->f) != 1)
+		return 0;
+
+	// Archives written by a different version are dropped as a whole
+	uint32_t index_end = sizeof(archive_header) + h.entries_num * sizeof(shader_archive_entry);
+	if (h.magic != SHADER_ARCHIVE_MAGIC || h.version != a->version || h.entries_num > (uint32_t)file_size / sizeof(shader_archive_entry) || h.data_end < index_end || h.data_end > (uint32_t)file_size)
+		return 0;
+
+	// Loading index
+	a->capacity = h.entries_num > 64 ? h.entries_num : 64;
+	a->entries = (shader_archive_entry *)malloc(a->capacity * sizeof(shader_archive_entry));
+	if (!a->entries || fread(a->entries, sizeof(shader_archive_entry), h.entries_num, a->f) != h.entries_num)
+		return 0;
+	if (shader_cache_checksum(a->entries, h.entries_num * sizeof(shader_archive_entry)) != h.index_checksum)
+		return 0;
+	for (uint32_t i = 0; i < h.entries_num; i++) {
+		shader_archive_entry *e = &a->entries[i];
+		if (e->offset < index_end || e->offset > h.data_end || e->size > h.data_end - e->offset || (i && e->key <= a->entries[i - 1].key))
+			return 0;
+	}
+	a->num = h.entries_num;
+
+	// Replaying journal, the first torn record marks its end
+	uint32_t pos = h.data_end;
+	record_header r;
+	while (pos + sizeof(record_header) <= (uint32_t)file_size) {
+		if (fseek(a->f, pos, SEEK_SET) || fread(&r, sizeof(r), 1, a->f) != 1)
+			break;
+		if (r.magic != SHADER_RECORD_MAGIC || r.header_checksum != shader_cache_checksum(&r, offsetof(record_header, header_checksum)) || r.size > (uint32_t)file_size - pos - sizeof(record_header))
+			break;
+		if (!insert_entry(a, r.key, pos + sizeof(record_header), r.size, r.checksum))
+			break;
+		pos += sizeof(record_header) + r.size;
+		a->records++;
+	}
+	a->end = pos;
+	a->stats.recovered = file_size - pos;
+	return 1;
+}
+
+static int create_archive(shader_archive *a) {
+	archive_header h;
+	memset(&h, 0, sizeof(h));
+	h.magic = SHADER_ARCHIVE_MAGIC;
+	h.version = a->version;
+	h.index_checksum = shader_cache_checksum(NULL, 0);
+	h.data_end = sizeof(archive_header);
+	a->f = fopen(a->path, "w+b");
+	if (!a->f)
+		return 0;
+	if (fwrite(&h, sizeof(h), 1, a->f) != 1 || fflush(a->f)) {
+		fclose(a->f);
+		a->f = NULL;
+		return 0;
+	}
+	a->end = sizeof(archive_header);
+	return 1;
+}
+
+int shader_archive_open(shader_archive *a, const char *path, uint32_t version) {
+	memset(a, 0, sizeof(shader_archive));
+	strncpy(a->path, path, sizeof(a->path) - 1);
+	a->version = version;
+
+	char tmp_path[264];
+	sprintf(tmp_path, "%s.tmp", a->path);
+	a->f = fopen(a->path, "r+b");
+	if (a->f) {
+		// Leftover of an interrupted compaction, the archive itself is still intact
+		remove(tmp_path);
+	} else if (!rename(tmp_path, a->path)) {
+		// Compaction got interrupted after the old archive removal, the new one is complete
+		a->f = fopen(a->path, "r+b");
+	}
+	if (a->f && load_archive(a))
+		return 1;
+
+	// Starting over with an empty archive
+	if (a->f)
+		fclose(a->f);
+	free(a->entries);
+	a->entries = NULL;
+	a->num = 0;
+	a->capacity = 0;
+	a->records = 0;
+	a->dead = 0;
+	a->stats.recovered = 0;
+	return create_archive(a);
+}
+
+void shader_archive_close(shader_archive *a) {
+	if (a->f)
+		fclose(a->f);
+	free(a->entries);
+	a->f = NULL;
+	a->entries = NULL;
+	a->num = 0;
+	a->capacity = 0;
+}
+
+const shader_archive_entry *shader_archive_find(shader_archive *a, uint64_t key) {
+	shader_archive_entry *e = find_entry(a, key);
+	if (!e)
+		a->stats.misses++;
+	return e;
+}
+
+int shader_archive_read(shader_archive *a, const shader_archive_entry *e, void *dst) {
+	if (fseek(a->f, e->offset, SEEK_SET) || (e->size && fread(dst, e->size, 1, a->f) != 1) || shader_cache_checksum(dst, e->size) != e->checksum) {
+		// Dropping the blob so that the caller rebuilds and appends it again
+		remove_entry(a, (shader_archive_entry *)e);
+		a->stats.corrupted++;
+		return 0;
+	}
+	a->stats.hits++;
+	return 1;
+}
+
+int shader_archive_append(shader_archive *a, uint64_t key, const void *data, uint32_t size) {
+	if (!a->f)
+		return 0;
+
+	record_header r;
+	r.magic = SHADER_RECORD_MAGIC;
+	r.size = size;
+	r.key = key;
+	r.checksum = shader_cache_checksum(data, size);
+	r.header_checksum = shader_cache_checksum(&r, offsetof(record_header, header_checksum));
+
+	// A torn write leaves end untouched so that the next append overwrites it, opening the archive discards it otherwise
+	if (fseek(a->f, a->end, SEEK_SET) || fwrite(&r, sizeof(r), 1, a->f) != 1 || (size && fwrite(data, size, 1, a->f) != 1) || fflush(a->f))
+		return 0;
+	if (!insert_entry(a, key, a->end + sizeof(record_header), size, r.checksum))
+		return 0;
+	a->end += sizeof(record_header) + size;
+	a->records++;
+	a->stats.appends++;
+	return 1;
+}
+
+int shader_archive_compact(shader_archive *a) {
+	if (!a->f)
+		return 0;
+
+	char tmp_path[264];
+	sprintf(tmp_path, "%s.tmp", a->path);
+	FILE *f = fopen(tmp_path, "wb");
+	if (!f)
+		return 0;
+
+	// Blobs are laid out in key order right after the index
+	uint32_t max_size = 0;
+	for (uint32_t i = 0; i < a->num; i++) {
+		if (a->entries[i].size > max_size)
+			max_size = a->entries[i].size;
+	}
+	shader_archive_entry *entries = (shader_archive_entry *)malloc(a->num * sizeof(shader_archive_entry) + 1);
+	uint8_t *buf = (uint8_t *)malloc(max_size + 1);
+	archive_header h;
+	memset(&h, 0, sizeof(h));
+	int res = entries && buf && fwrite(&h, sizeof(h), 1, f) == 1;
+	uint32_t pos = sizeof(archive_header) + a->num * sizeof(shader_archive_entry);
+	uint32_t num = 0;
+	if (res && fseek(f, pos, SEEK_SET))
+		res = 0;
+	for (uint32_t i = 0; res && i < a->num; i++) {
+		shader_archive_entry *e = &a->entries[i];
+		if (fseek(a->f, e->offset, SEEK_SET) || (e->size && fread(buf, e->size, 1, a->f) != 1) || shader_cache_checksum(buf, e->size) != e->checksum) {
+			// Corrupted blobs are left behind
+			a->stats.corrupted++;
+			continue;
+		}
+		if (e->size && fwrite(buf, e->size, 1, f) != 1) {
+			res = 0;
+			break;
+		}
+		entries[num] = *e;
+		entries[num].offset = pos;
+		pos += e->size;
+		num++;
+	}
+
+	// Header and index are written last so that only fully written archives are valid
+	if (res) {
+		h.magic = SHADER_ARCHIVE_MAGIC;
+		h.version = a->version;
+		h.entries_num = num;
+		h.index_checksum = shader_cache_checksum(entries, num * sizeof(shader_archive_entry));
+		h.data_end = pos;
+		res = !fseek(f, 0, SEEK_SET) && fwrite(&h, sizeof(h), 1, f) == 1 && (!num || fwrite(entries, sizeof(shader_archive_entry), num, f) == num);
+	}
+	free(entries);
+	free(buf);
+	if (fclose(f) || !res) {
+		remove(tmp_path);
+		return 0;
+	}
+
+	// Swapping archives, an interruption past this point gets recovered when opening
+	shader_archive_stats stats = a->stats;
+	uint32_t version = a->version;
+	char path[256];
+	strcpy(path, a->path);
+	shader_archive_close(a);
+	remove(path);
+	rename(tmp_path, path);
+	res = shader_archive_open(a, path, version);
+	stats.recovered = a->stats.recovered;
+	a->stats = stats;
+	return res;
+}
+
+uint32_t shader_archive_import_dir(shader_archive *a, const char *dir, const char *prefix, const char *suffix, int remove_files) {
+	DIR *d = opendir(dir);
+	if (!d)
+		return 0;
+
+	// Collecting names first so that removals don't interfere with the directory listing
+	char **names = NULL;
+	uint32_t names_num = 0, names_size = 0;
+	uint32_t prefix_len = strlen(prefix), suffix_len = strlen(suffix);
+	struct dirent *entry;
+	while ((entry = readdir(d))) {
+		uint32_t len = strlen(entry->d_name);
+		if (len < prefix_len + suffix_len || strncmp(entry->d_name, prefix, prefix_len) || strcmp(&entry->d_name[len - suffix_len], suffix))
+			continue;
+		if (names_num == names_size) {
+			uint32_t new_size = names_size ? names_size * 2 : 64;
+			char **new_names = (char **)realloc(names, new_size * sizeof(char *));
+			if (!new_names)
+				break;
+			names = new_names;
+			names_size = new_size;
+		}
+		names[names_num] = strdup(entry->d_name);
+		if (names[names_num])
+			names_num++;
+	}
+	closedir(d);
+
+	uint32_t imported = 0;
+	for (uint32_t i = 0; i < names_num; i++) {
+		char fname[512];
+		sprintf(fname, "%s/%s", dir, names[i]);
+		free(names[i]);
+		uint64_t key = shader_archive_key(fname);
+		int stored = find_entry(a, key) != NULL;
+		if (!stored) {
+			FILE *f = fopen(fname, "rb");
+			if (!f)
+				continue;
+			fseek(f, 0, SEEK_END);
+			long size = ftell(f);
+			fseek(f, 0, SEEK_SET);
+			void *buf = size > 0 ? malloc(size) : NULL;
+			if (buf && fread(buf, size, 1, f) == 1 && shader_archive_append(a, key, buf, size)) {
+				stored = 1;
+				imported++;
+			}
+			free(buf);
+			fclose(f);
+		}
+		if (stored && remove_files)
+			remove(fname);
+	}
+	free(names);
+	return imported;
+}
@@ -0,0 +1,75 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * shader_archive_utils.h:
+ * Header file for the packed shader binaries archive utilities exposed by shader_archive_utils.c
+ */
+
+#ifndef _SHADER_ARCHIVE_UTILS_H_
+#define _SHADER_ARCHIVE_UTILS_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define SHADER_ARCHIVE_MAGIC 0x41534756 // 'VGSA', magic for shader archives
+#define SHADER_RECORD_MAGIC 0x4A534756 // 'VGSJ', magic for shader archives journal records
+#define SHADER_ARCHIVE_COMPACT_RECORDS 64 // Number of journal records after which an archive is worth compacting
+
+// Blob stored in a shader archive
+typedef struct {
+	uint64_t key;
+	uint32_t offset; // Offset of the payload in the archive file
+	uint32_t size; // Payload size in bytes
+	uint32_t checksum; // Payload checksum
+	uint32_t reserved;
+} shader_archive_entry;
+
+// Statistics for a shader archive
+typedef struct {
+	uint32_t hits;
+	uint32_t misses;
+	uint32_t corrupted; // Blobs dropped because their payload didn't match the checksum
+	uint32_t appends;
+	uint32_t recovered; // Bytes of torn journal records discarded when opening the archive
+} shader_archive_stats;
+
+// Single file archive of shader binaries: a sorted index of the blobs written by the last compaction followed by a journal of appended blobs
+typedef struct {
+	FILE *f;
+	char path[256];
+	uint32_t version;
+	shader_archive_entry *entries; // Sorted by key
+	uint32_t num;
+	uint32_t capacity;
+	uint32_t records; // Number of journal records
+	uint32_t end; // Offset past the last valid journal record
+	uint32_t dead; // Bytes of blobs superseded by later records
+	shader_archive_stats stats;
+} shader_archive;
+
+uint64_t shader_archive_key(const char *name);
+int shader_archive_open(shader_archive *a, const char *path, uint32_t version);
+void shader_archive_close(shader_archive *a);
+const shader_archive_entry *shader_archive_find(shader_archive *a, uint64_t key);
+int shader_archive_read(shader_archive *a, const shader_archive_entry *e, void *dst);
+int shader_archive_append(shader_archive *a, uint64_t key, const void *data, uint32_t size);
+int shader_archive_compact(shader_archive *a);
+uint32_t shader_archive_import_dir(shader_archive *a, const char *dir, const char *prefix, const char *suffix, int remove_files);
+
+#endif
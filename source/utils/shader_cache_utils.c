@@ -0,0 +1,368 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * shader_cache_utils.c:
+ * Content addressed cache for compiled shader binaries
+ * NOTE: Every blob carries the full identity (source and settings) it was produced from, keys are only used to locate it
+ */
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "shader_cache_utils.h"
+
+// Header prepended to every stored blob
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t key;
+	uint32_t ident_size; // Identity size in bytes, the identity is stored right after the header
+	uint32_t size; // Payload size in bytes, the payload is stored right after the identity
+	uint32_t checksum; // Identity and payload checksum
+} shader_blob_header;
+
+// In-memory index entry
+typedef struct {
+	uint64_t key;
+	uint32_t size;
+	uint32_t stamp;
+} shader_cache_entry;
+
+static shader_cache_backend *cache_backend = NULL;
+static shader_cache_entry *cache_entries = NULL;
+static uint32_t cache_entries_num = 0;
+static uint32_t cache_entries_size = 0;
+static uint32_t cache_max_size = 0;
+static uint32_t cache_cur_size = 0;
+static uint32_t cache_stamp = 0;
+static uint32_t cache_version = 0; // Build dependent version, blobs produced by other builds are discarded
+static shader_cache_stats cache_stats;
+
+uint64_t shader_cache_hash(const void *data, uint32_t size, uint64_t seed) {
+	const uint8_t *p = (const uint8_t *)data;
+	uint64_t h = seed;
+	for (uint32_t i = 0; i < size; i++) {
+		h ^= p[i];
+		h *= 0x100000001B3ULL;
+	}
+	return h;
+}
+
+uint64_t shader_cache_hash_finalize(uint64_t h) {
+	h ^= h >> 33;
+	h *= 0xFF51AFD7ED558CCDULL;
+	h ^= h >> 33;
+	h *= 0xC4CEB9FE1A85EC53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+uint32_t shader_cache_checksum(const void *data, uint32_t size) {
+	// Adler-32
+	const uint8_t *p = (const uint8_t *)data;
+	uint32_t a = 1, b = 0;
+	while (size) {
+		uint32_t chunk = size > 5552 ? 5552 : size;
+		size -= chunk;
+		while (chunk--) {
+			a += *p++;
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+	}
+	return (b << 16) | a;
+}
+
+static void blob_name(char *dst, uint64_t key) {
+	sprintf(dst, "%016llX.bin", (unsigned long long)key);
+}
+
+/*
+ * Default stdio backend
+ */
+static char stdio_root[256];
+
+static void stdio_path(char *dst, void *user, const char *name) {
+	sprintf(dst, "%s/%s", (const char *)user, name);
+}
+
+static int stdio_read(void *user, const char *name, void **buf, uint32_t *size) {
+	char fname[512];
+	stdio_path(fname, user, name);
+	FILE *f = fopen(fname, "rb");
+	if (!f)
+		return -1;
+	fseek(f, 0, SEEK_END);
+	long len = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	if (len <= 0) {
+		fclose(f);
+		return -1;
+	}
+	*buf = malloc(len);
+	if (!*buf || fread(*buf, 1, len, f) != (size_t)len) {
+		free(*buf);
+		*buf = NULL;
+		fclose(f);
+		return -1;
+	}
+	fclose(f);
+	*size = len;
+	return 0;
+}
+
+static int stdio_write(void *user, const char *name, const void *buf, uint32_t size) {
+	char fname[512], tmp_fname[516];
+	stdio_path(fname, user, name);
+
+	// Writing to a temporary file first so that an interrupted write never leaves a truncated blob around
+	sprintf(tmp_fname, "%s.tmp", fname);
+	FILE *f = fopen(tmp_fname, "wb");
+	if (!f)
+		return -1;
+	size_t written = fwrite(buf, 1, size, f);
+	fclose(f);
+	if (written != size) {
+		remove(tmp_fname);
+		return -1;
+	}
+	remove(fname);
+	return rename(tmp_fname, fname);
+}
+
+static int stdio_remove(void *user, const char *name) {
+	char fname[512];
+	stdio_path(fname, user, name);
+	return remove(fname);
+}
+
+static int stdio_enumerate(void *user, void (*cb)(void *arg, const char *name, uint32_t size, uint32_t stamp), void *arg) {
+	DIR *d = opendir((const char *)user);
+	if (!d)
+		return -1;
+	struct dirent *entry;
+	while ((entry = readdir(d))) {
+		if (entry->d_name[0] == '.')
+			continue;
+		char fname[512];
+		struct stat st;
+		stdio_path(fname, user, entry->d_name);
+		if (!stat(fname, &st) && S_ISREG(st.st_mode))
+			cb(arg, entry->d_name, st.st_size, st.st_mtime);
+	}
+	closedir(d);
+	return 0;
+}
+
+static shader_cache_backend stdio_backend = {
+	stdio_root,
+	stdio_read,
+	stdio_write,
+	stdio_remove,
+	stdio_enumerate
+};
+
+shader_cache_backend *shader_cache_stdio_backend(const char *root) {
+	strncpy(stdio_root, root, sizeof(stdio_root) - 1);
+	mkdir(stdio_root, 0777);
+	return &stdio_backend;
+}
+
+/*
+ * In-memory index
+ */
+static void index_add(uint64_t key, uint32_t size, uint32_t stamp) {
+	if (cache_entries_num == cache_entries_size) {
+		uint32_t new_size = cache_entries_size ? cache_entries_size * 2 : 64;
+		shader_cache_entry *new_entries = (shader_cache_entry *)realloc(cache_entries, new_size * sizeof(shader_cache_entry));
+		if (!new_entries)
+			return;
+		cache_entries = new_entries;
+		cache_entries_size = new_size;
+	}
+	cache_entries[cache_entries_num].key = key;
+	cache_entries[cache_entries_num].size = size;
+	cache_entries[cache_entries_num].stamp = stamp;
+	cache_entries_num++;
+	cache_cur_size += size;
+	if (stamp >= cache_stamp)
+		cache_stamp = stamp + 1;
+}
+
+static int index_find(uint64_t key) {
+	for (uint32_t i = 0; i < cache_entries_num; i++) {
+		if (cache_entries[i].key == key)
+			return i;
+	}
+	return -1;
+}
+
+static void index_remove(uint32_t idx) {
+	cache_cur_size -= cache_entries[idx].size;
+	cache_entries[idx] = cache_entries[--cache_entries_num];
+}
+
+static void index_enumerate_cb(void *arg, const char *name, uint32_t size, uint32_t stamp) {
+	// Only blobs named after their key are part of the cache
+	if (strlen(name) != 20 || strcmp(&name[16], ".bin"))
+		return;
+	char *end;
+	uint64_t key = strtoull(name, &end, 16);
+	if (end != &name[16])
+		return;
+	index_add(key, size, stamp);
+}
+
+static void evict_entry(uint32_t idx) {
+	char name[32];
+	blob_name(name, cache_entries[idx].key);
+	cache_backend->remove(cache_backend->user, name);
+	index_remove(idx);
+}
+
+static void evict_until(uint32_t size) {
+	// Evicting least recently used blobs until the requested size fits into the cache
+	while (cache_entries_num && cache_cur_size + size > cache_max_size) {
+		uint32_t oldest = 0;
+		for (uint32_t i = 1; i < cache_entries_num; i++) {
+			if (cache_entries[i].stamp < cache_entries[oldest].stamp)
+				oldest = i;
+		}
+		evict_entry(oldest);
+		cache_stats.evictions++;
+	}
+}
+
+void shader_cache_init(shader_cache_backend *backend, uint32_t max_size, uint32_t version) {
+	shader_cache_term();
+	cache_backend = backend;
+	cache_max_size = max_size;
+	cache_version = version;
+	if (cache_backend && cache_backend->enumerate)
+		cache_backend->enumerate(cache_backend->user, index_enumerate_cb, NULL);
+	evict_until(0);
+}
+
+void shader_cache_term(void) {
+	free(cache_entries);
+	cache_entries = NULL;
+	cache_entries_num = 0;
+	cache_entries_size = 0;
+	cache_cur_size = 0;
+	cache_stamp = 0;
+	cache_backend = NULL;
+	memset(&cache_stats, 0, sizeof(shader_cache_stats));
+}
+
+void shader_cache_set_max_size(uint32_t max_size) {
+	cache_max_size = max_size;
+	if (cache_backend)
+		evict_until(0);
+}
+
+void *shader_cache_load(uint64_t key, const void *ident, uint32_t ident_size, uint32_t *size) {
+	if (!cache_backend || !cache_max_size)
+		return NULL;
+
+	int idx = index_find(key);
+	if (idx < 0) {
+		cache_stats.misses++;
+		return NULL;
+	}
+
+	char name[32];
+	void *blob;
+	uint32_t blob_size;
+	blob_name(name, key);
+	if (cache_backend->read(cache_backend->user, name, &blob, &blob_size)) {
+		// Blob disappeared from the storage behind our back
+		index_remove(idx);
+		cache_stats.misses++;
+		return NULL;
+	}
+
+	// Validating blob integrity
+	shader_blob_header *hdr = (shader_blob_header *)blob;
+	if (blob_size < sizeof(shader_blob_header) || hdr->magic != SHADER_BLOB_MAGIC || hdr->version != cache_version || hdr->key != key || hdr->ident_size > blob_size - sizeof(shader_blob_header) || hdr->size != blob_size - sizeof(shader_blob_header) - hdr->ident_size || hdr->checksum != shader_cache_checksum(&hdr[1], hdr->ident_size + hdr->size)) {
+		free(blob);
+		evict_entry(idx);
+		cache_stats.corrupted++;
+		cache_stats.misses++;
+		return NULL;
+	}
+
+	// Keys can collide, the blob is only valid if it was produced from the very same identity
+	uint8_t *data = (uint8_t *)&hdr[1];
+	if (hdr->ident_size != ident_size || memcmp(data, ident, ident_size)) {
+		free(blob);
+		cache_stats.collisions++;
+		cache_stats.misses++;
+		return NULL;
+	}
+
+	// Moving payload at the start of the buffer so that it can be released with a plain free
+	*size = hdr->size;
+	memmove(blob, &data[ident_size], hdr->size);
+	cache_entries[idx].stamp = cache_stamp++;
+	cache_stats.hits++;
+	return blob;
+}
+
+void shader_cache_store(uint64_t key, const void *ident, uint32_t ident_size, const void *bin, uint32_t size) {
+	if (!cache_backend || !cache_max_size)
+		return;
+
+	uint32_t blob_size = size + ident_size + sizeof(shader_blob_header);
+	if (blob_size > cache_max_size)
+		return;
+
+	// Replacing any stale or colliding blob with the same key
+	int idx = index_find(key);
+	if (idx >= 0)
+		evict_entry(idx);
+	evict_until(blob_size);
+
+	shader_blob_header *hdr = (shader_blob_header *)malloc(blob_size);
+	if (!hdr)
+		return;
+	uint8_t *data = (uint8_t *)&hdr[1];
+	memcpy(data, ident, ident_size);
+	memcpy(&data[ident_size], bin, size);
+	hdr->magic = SHADER_BLOB_MAGIC;
+	hdr->version = cache_version;
+	hdr->key = key;
+	hdr->ident_size = ident_size;
+	hdr->size = size;
+	hdr->checksum = shader_cache_checksum(data, ident_size + size);
+
+	char name[32];
+	blob_name(name, key);
+	if (!cache_backend->write(cache_backend->user, name, hdr, blob_size))
+		index_add(key, blob_size, cache_stamp);
+	free(hdr);
+}
+
+void shader_cache_get_stats(shader_cache_stats *stats) {
+	memcpy(stats, &cache_stats, sizeof(shader_cache_stats));
+	stats->entries = cache_entries_num;
+	stats->size = cache_cur_size;
+}
@@ -0,0 +1,69 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * shader_cache_utils.h:
+ * Header file for the shader binaries cache utilities exposed by shader_cache_utils.c
+ */
+
+#ifndef _SHADER_CACHE_UTILS_H_
+#define _SHADER_CACHE_UTILS_H_
+
+#include <stdint.h>
+
+#define SHADER_BLOB_MAGIC 0x42534756 // 'VGSB', magic for shader cache blobs
+#define CUSTOM_SHADER_CACHE_PATH "ux0:data/shader_cache/custom" // Default location for custom shaders cache
+#define CUSTOM_SHADER_CACHE_DEF_SIZE (8 * 1024 * 1024) // Default maximum size in bytes for custom shaders cache
+
+// Storage backend for the shader cache (all callbacks return 0 on success)
+typedef struct {
+	void *user; // Backend specific data passed to every callback
+	int (*read)(void *user, const char *name, void **buf, uint32_t *size); // Returned buffer is allocated with malloc
+	int (*write)(void *user, const char *name, const void *buf, uint32_t size);
+	int (*remove)(void *user, const char *name);
+	int (*enumerate)(void *user, void (*cb)(void *arg, const char *name, uint32_t size, uint32_t stamp), void *arg);
+} shader_cache_backend;
+
+// Statistics for the shader cache
+typedef struct {
+	uint32_t hits;
+	uint32_t misses;
+	uint32_t corrupted;
+	uint32_t collisions; // Blobs found for a key but with a different identity
+	uint32_t evictions;
+	uint32_t entries;
+	uint32_t size;
+} shader_cache_stats;
+
+// Hashing helpers (64 bit FNV-1a with avalanche finalizer)
+#define SHADER_HASH_SEED 0xCBF29CE484222325ULL
+uint64_t shader_cache_hash(const void *data, uint32_t size, uint64_t seed);
+uint64_t shader_cache_hash_finalize(uint64_t h);
+uint32_t shader_cache_checksum(const void *data, uint32_t size);
+
+// Default stdio based backend rooted at the given directory
+shader_cache_backend *shader_cache_stdio_backend(const char *root);
+
+void shader_cache_init(shader_cache_backend *backend, uint32_t max_size, uint32_t version);
+void shader_cache_term(void);
+void shader_cache_set_max_size(uint32_t max_size);
+void *shader_cache_load(uint64_t key, const void *ident, uint32_t ident_size, uint32_t *size);
+void shader_cache_store(uint64_t key, const void *ident, uint32_t ident_size, const void *bin, uint32_t size);
+void shader_cache_get_stats(shader_cache_stats *stats);
+
+#endif
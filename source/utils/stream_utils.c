@@ -0,0 +1,225 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * stream_utils.c:
+ * Streaming ring allocator for per-scene GPU data with copies de-duplication
+ */
+
+#include <string.h>
+#include "stream_utils.h"
+
+#define STREAM_ALIGN(x) (((x) + STREAM_ALIGNMENT - 1) & ~(STREAM_ALIGNMENT - 1))
+
+void stream_ring_init(stream_ring *r, void *base, uint32_t size) {
+	r->base = (uint8_t *)base;
+	r->size = size & ~(STREAM_ALIGNMENT - 1);
+	r->head = 0;
+	r->tail = 0;
+	r->consumed = 0;
+	r->released = 0;
+	r->fences_first = 0;
+	r->fences_num = 0;
+}
+
+void *stream_ring_alloc(stream_ring *r, uint32_t size) {
+	if (!r->base)
+		return NULL;
+	size = STREAM_ALIGN(size);
+	uint32_t used = r->consumed - r->released;
+
+	// Rewinding an empty ring so that the whole of it is contiguous again
+	if (!used)
+		r->head = r->tail = 0;
+
+	uint32_t off;
+	if (r->head >= r->tail && used < r->size) {
+		// Free space is split between the ring end and the ring start
+		if (size <= r->size - r->head) {
+			off = r->head;
+			r->consumed += size;
+		} else if (size <= r->tail) {
+			// Wrapping around, the skipped bytes at the ring end are consumed as well
+			off = 0;
+			r->consumed += r->size - r->head + size;
+		} else
+			return NULL;
+	} else if (r->head < r->tail && size <= r->tail - r->head) {
+		off = r->head;
+		r->consumed += size;
+	} else
+		return NULL;
+
+	r->head = off + size;
+	if (r->head == r->size)
+		r->head = 0;
+	return r->base + off;
+}
+
+void stream_ring_fence(stream_ring *r, uint32_t seq) {
+	// Nothing got allocated since last fence
+	if (r->fences_num) {
+		stream_fence *last = &r->fences[(r->fences_first + r->fences_num - 1) % STREAM_MAX_FENCES];
+		if (last->consumed == r->consumed) {
+			last->seq = seq;
+			return;
+		}
+	} else if (r->consumed == r->released)
+		return;
+
+	// Merging with the newest fence if we run out of them, space gets reclaimed a bit later
+	stream_fence *f;
+	if (r->fences_num == STREAM_MAX_FENCES)
+		f = &r->fences[(r->fences_first + r->fences_num - 1) % STREAM_MAX_FENCES];
+	else
+		f = &r->fences[(r->fences_first + r->fences_num++) % STREAM_MAX_FENCES];
+	f->seq = seq;
+	f->head = r->head;
+	f->consumed = r->consumed;
+}
+
+void stream_ring_retire(stream_ring *r, uint32_t completed_seq) {
+	while (r->fences_num) {
+		stream_fence *f = &r->fences[r->fences_first];
+		if (!stream_seq_reached(f->seq, completed_seq))
+			break;
+		r->tail = f->head;
+		r->released = f->consumed;
+		r->fences_first = (r->fences_first + 1) % STREAM_MAX_FENCES;
+		r->fences_num--;
+	}
+}
+
+void stream_pool_init(stream_pool *p) {
+	memset(p, 0, sizeof(stream_pool));
+	p->gen = 1;
+}
+
+void *stream_pool_alloc(stream_pool *p, uint32_t size) {
+	for (int i = 0; i < STREAM_RINGS_NUM; i++) {
+		void *res = stream_ring_alloc(&p->rings[i], size);
+		if (res) {
+			p->stats.allocs++;
+			return res;
+		}
+	}
+	p->stats.overflows++;
+	return NULL;
+}
+
+void stream_pool_fence(stream_pool *p, uint32_t seq) {
+	for (int i = 0; i < STREAM_RINGS_NUM; i++) {
+		stream_ring_fence(&p->rings[i], seq);
+	}
+
+	// Copies made so far can't be referenced by the next scene since they'll be reclaimed once this one completes
+	p->gen++;
+	if (!p->gen)
+		p->gen++;
+}
+
+void stream_pool_retire(stream_pool *p, uint32_t completed_seq) {
+	for (int i = 0; i < STREAM_RINGS_NUM; i++) {
+		stream_ring_retire(&p->rings[i], completed_seq);
+	}
+}
+
+static uint32_t hash_key(const void *src, uint32_t stride, uint32_t count) {
+	uint32_t h = (uint32_t)(uintptr_t)src;
+	h ^= stride * 0x85EBCA6B;
+	h ^= count * 0xC2B2AE35;
+	h ^= h >> 15;
+	h *= 0x2C1B3C6D;
+	h ^= h >> 13;
+	return h;
+}
+
+static uint64_t hash_data(const void *src, uint32_t size) {
+	// 64 bit multiply-xorshift on double words with a murmur finalizer, strong enough to be the only reuse criterion
+	const uint8_t *p = (const uint8_t *)src;
+	uint64_t h = 0xCBF29CE484222325ULL ^ size;
+	uint32_t i;
+	for (i = 0; i + 8 <= size; i += 8) {
+		uint64_t w;
+		memcpy(&w, &p[i], 8);
+		h = (h ^ w) * 0x9E3779B97F4A7C15ULL;
+		h ^= h >> 29;
+	}
+	for (; i < size; i++) {
+		h = (h ^ p[i]) * 0x100000001B3ULL;
+	}
+	h ^= h >> 33;
+	h *= 0xFF51AFD7ED558CCDULL;
+	h ^= h >> 33;
+	h *= 0xC4CEB9FE1A85EC53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+void *stream_pool_lookup(stream_pool *p, const void *src, uint32_t stride, uint32_t count, stream_cache_entry **slot) {
+	uint32_t idx = hash_key(src, stride, count);
+	stream_cache_entry *e = NULL;
+	*slot = &p->cache[idx & (STREAM_CACHE_SIZE - 1)];
+	for (int i = 0; i < STREAM_CACHE_PROBES; i++) {
+		stream_cache_entry *cand = &p->cache[(idx + i) & (STREAM_CACHE_SIZE - 1)];
+		if (cand->gen != p->gen) {
+			// Entries are never removed within a scene, so the chain ends here
+			*slot = cand;
+			return NULL;
+		}
+		if (cand->src == (uintptr_t)src && cand->stride == stride && cand->count == count) {
+			e = cand;
+			break;
+		}
+	}
+	if (!e)
+		return NULL;
+	*slot = e;
+
+	// Client array got rewritten earlier in this scene, hashing it again is likely to be wasted
+	if (e->flags & STREAM_CACHE_VOLATILE)
+		return NULL;
+
+	// Content is hashed only once the same array is drawn twice, so arrays drawn once cost nothing more than the copy
+	uint32_t size = stride * count;
+	uint64_t h = hash_data(src, size);
+	p->stats.bytes_hashed += size;
+	if (e->flags & STREAM_CACHE_HASHED) {
+		// The copy lives in GPU mapped memory, possibly uncached, so it is never read back
+		if (e->hash == h) {
+			p->stats.bytes_reused += size;
+			return e->dst;
+		}
+		e->flags |= STREAM_CACHE_VOLATILE;
+	}
+	e->hash = h;
+	e->flags |= STREAM_CACHE_HASHED;
+	return NULL;
+}
+
+void stream_pool_store(stream_pool *p, stream_cache_entry *slot, const void *src, uint32_t stride, uint32_t count, void *dst) {
+	if (slot->gen != p->gen || slot->src != (uintptr_t)src || slot->stride != stride || slot->count != count) {
+		slot->src = (uintptr_t)src;
+		slot->stride = stride;
+		slot->count = count;
+		slot->gen = p->gen;
+		slot->flags = 0;
+	}
+	slot->dst = dst;
+	p->stats.bytes_copied += stride * count;
+}
@@ -0,0 +1,102 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * stream_utils.h:
+ * Header file for the streaming ring allocator utilities exposed by stream_utils.c
+ */
+
+#ifndef _STREAM_UTILS_H_
+#define _STREAM_UTILS_H_
+
+#include <stdint.h>
+
+#define STREAM_ALIGNMENT 16 // Alignment in bytes of every streamed allocation
+#define STREAM_MAX_FENCES 64 // Maximum number of in flight fences per ring
+#define STREAM_RINGS_NUM 2 // Number of rings of a stream pool (primary + overflow)
+#define STREAM_CACHE_SIZE 64 // Number of entries of the copies de-duplication cache (must be a power of two)
+#define STREAM_CACHE_PROBES 8 // Maximum number of probed slots per cache lookup
+
+// Returns non zero if sequence a has been reached by sequence b (wrap-around safe)
+#define stream_seq_reached(a, b) ((int32_t)((b) - (a)) >= 0)
+
+// Ring state when a scene got closed
+typedef struct {
+	uint32_t seq; // Sequence number of the scene
+	uint32_t head; // Ring offset following the last allocation of the scene
+	uint32_t consumed; // Ring bytes consumed up to the last allocation of the scene
+} stream_fence;
+
+// Ring of GPU readable memory whose space is reclaimed once the scenes using it get completed
+typedef struct {
+	uint8_t *base;
+	uint32_t size;
+	uint32_t head; // Offset for the next allocation
+	uint32_t tail; // Offset of the oldest allocation the GPU may still read
+	uint32_t consumed; // Total bytes consumed, padding at wrap-around included
+	uint32_t released; // Total bytes given back by completed scenes
+	stream_fence fences[STREAM_MAX_FENCES];
+	uint32_t fences_first;
+	uint32_t fences_num;
+} stream_ring;
+
+// Copy of a client array performed in the current scene
+typedef struct {
+	uintptr_t src;
+	uint32_t stride;
+	uint32_t count;
+	uint32_t gen; // Scene the copy belongs to, the entry is empty if it differs from the pool one
+	uint32_t flags;
+	uint64_t hash; // Content hash of the copied data, valid only if HASHED flag is set
+	void *dst;
+} stream_cache_entry;
+
+// Copies de-duplication cache entries flags
+#define STREAM_CACHE_HASHED 0x01 // Entry content hash has been computed
+#define STREAM_CACHE_VOLATILE 0x02 // Client array got rewritten in the same scene, never reused
+
+// Stream pool counters
+typedef struct {
+	uint32_t allocs; // Number of allocations served by the rings
+	uint32_t overflows; // Number of allocations no ring could serve
+	uint32_t bytes_copied; // Bytes of client arrays copied into the rings
+	uint32_t bytes_hashed; // Bytes of client arrays hashed to validate a copy reuse
+	uint32_t bytes_reused; // Bytes of client arrays served from a previous copy
+} stream_stats;
+
+// Set of rings sharing a copies de-duplication cache
+typedef struct {
+	stream_ring rings[STREAM_RINGS_NUM];
+	stream_cache_entry cache[STREAM_CACHE_SIZE];
+	uint32_t gen;
+	stream_stats stats;
+} stream_pool;
+
+void stream_ring_init(stream_ring *r, void *base, uint32_t size);
+void *stream_ring_alloc(stream_ring *r, uint32_t size);
+void stream_ring_fence(stream_ring *r, uint32_t seq);
+void stream_ring_retire(stream_ring *r, uint32_t completed_seq);
+
+void stream_pool_init(stream_pool *p);
+void *stream_pool_alloc(stream_pool *p, uint32_t size);
+void stream_pool_fence(stream_pool *p, uint32_t seq);
+void stream_pool_retire(stream_pool *p, uint32_t completed_seq);
+void *stream_pool_lookup(stream_pool *p, const void *src, uint32_t stride, uint32_t count, stream_cache_entry **slot);
+void stream_pool_store(stream_pool *p, stream_cache_entry *slot, const void *src, uint32_t stride, uint32_t count, void *dst);
+
+#endif
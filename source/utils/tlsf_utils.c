@@ -0,0 +1,366 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * tlsf_utils.c:
+ * Two-Level Segregated Fit allocator with out of band block descriptors
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "tlsf_utils.h"
+
+#define TLSF_DESC_CHUNK 256 // Number of block descriptors allocated at once
+#define TLSF_HASH_DEF_SIZE 256 // Initial number of buckets for the used blocks hash table
+
+#define tlsf_align_up(x, a) (((x) + ((a)-1)) & ~((a)-1))
+#define tlsf_hash_idx(p, addr) (((addr) >> 4) * 0x9E3779B1 >> 8 & (p)->hash_mask)
+
+static inline int tlsf_msb(uint32_t x) {
+	return 31 - __builtin_clz(x);
+}
+
+// Maps a size to its first and second level indices
+static inline void mapping_insert(uint32_t size, int *fl, int *sl) {
+	uint32_t units = size / TLSF_GRANULARITY;
+	if (units < TLSF_SL_COUNT) {
+		*fl = 0;
+		*sl = units;
+	} else {
+		int msb = tlsf_msb(units);
+		*fl = msb - TLSF_SL_LOG2 + 1;
+		*sl = (units >> (msb - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+	}
+}
+
+// Maps a size to the first list whose blocks are all big enough to hold it
+static inline void mapping_search(uint32_t size, int *fl, int *sl) {
+	uint32_t units = size / TLSF_GRANULARITY;
+	if (units >= TLSF_SL_COUNT)
+		size += ((1 << (tlsf_msb(units) - TLSF_SL_LOG2)) - 1) * TLSF_GRANULARITY;
+	mapping_insert(size, fl, sl);
+}
+
+static tlsf_block *desc_new(tlsf_pool *p) {
+	if (!p->spare) {
+		// Descriptors chunks are chained through their first slot
+		tlsf_block *chunk = (tlsf_block *)malloc(TLSF_DESC_CHUNK * sizeof(tlsf_block));
+		if (!chunk)
+			return NULL;
+		chunk[0].next_free = (tlsf_block *)p->chunks;
+		p->chunks = chunk;
+		for (int i = 1; i < TLSF_DESC_CHUNK; i++) {
+			chunk[i].next_free = p->spare;
+			p->spare = &chunk[i];
+		}
+	}
+	tlsf_block *b = p->spare;
+	p->spare = b->next_free;
+	return b;
+}
+
+static inline void desc_release(tlsf_pool *p, tlsf_block *b) {
+	b->next_free = p->spare;
+	p->spare = b;
+}
+
+static void free_list_insert(tlsf_pool *p, tlsf_block *b) {
+	int fl, sl;
+	mapping_insert(b->size, &fl, &sl);
+	b->is_free = 1;
+	b->prev_free = NULL;
+	b->next_free = p->free_lists[fl][sl];
+	if (b->next_free)
+		b->next_free->prev_free = b;
+	p->free_lists[fl][sl] = b;
+	p->fl_bitmap |= 1 << fl;
+	p->sl_bitmap[fl] |= 1 << sl;
+}
+
+static void free_list_remove(tlsf_pool *p, tlsf_block *b) {
+	int fl, sl;
+	mapping_insert(b->size, &fl, &sl);
+	if (b->prev_free)
+		b->prev_free->next_free = b->next_free;
+	else {
+		p->free_lists[fl][sl] = b->next_free;
+		if (!b->next_free) {
+			p->sl_bitmap[fl] &= ~(1 << sl);
+			if (!p->sl_bitmap[fl])
+				p->fl_bitmap &= ~(1 << fl);
+		}
+	}
+	if (b->next_free)
+		b->next_free->prev_free = b->prev_free;
+	b->is_free = 0;
+}
+
+static tlsf_block *find_suitable(tlsf_pool *p, uint32_t size) {
+	int fl, sl;
+	mapping_search(size, &fl, &sl);
+	if (fl >= TLSF_FL_COUNT)
+		return NULL;
+	uint32_t sl_map = p->sl_bitmap[fl] & (~0U << sl);
+	if (!sl_map) {
+		uint32_t fl_map = fl + 1 < 32 ? p->fl_bitmap & (~0U << (fl + 1)) : 0;
+		if (!fl_map)
+			return NULL;
+		fl = __builtin_ctz(fl_map);
+		sl_map = p->sl_bitmap[fl];
+	}
+	return p->free_lists[fl][__builtin_ctz(sl_map)];
+}
+
+static void hash_grow(tlsf_pool *p) {
+	uint32_t new_size = p->hash ? (p->hash_mask + 1) * 2 : TLSF_HASH_DEF_SIZE;
+	tlsf_block **new_hash = (tlsf_block **)calloc(new_size, sizeof(tlsf_block *));
+	if (!new_hash)
+		return;
+	tlsf_block **old_hash = p->hash;
+	uint32_t old_size = old_hash ? p->hash_mask + 1 : 0;
+	p->hash = new_hash;
+	p->hash_mask = new_size - 1;
+	for (uint32_t i = 0; i < old_size; i++) {
+		tlsf_block *b = old_hash[i];
+		while (b) {
+			tlsf_block *next = b->next_hash;
+			uint32_t idx = tlsf_hash_idx(p, b->base);
+			b->next_hash = p->hash[idx];
+			p->hash[idx] = b;
+			b = next;
+		}
+	}
+	free(old_hash);
+}
+
+static void hash_insert(tlsf_pool *p, tlsf_block *b) {
+	if (p->used_num > p->hash_mask)
+		hash_grow(p);
+	uint32_t idx = tlsf_hash_idx(p, b->base);
+	b->next_hash = p->hash[idx];
+	p->hash[idx] = b;
+	p->used_num++;
+}
+
+static tlsf_block *hash_find(tlsf_pool *p, uintptr_t base, int remove) {
+	tlsf_block **link = &p->hash[tlsf_hash_idx(p, base)];
+	while (*link) {
+		tlsf_block *b = *link;
+		if (b->base == base) {
+			if (remove) {
+				*link = b->next_hash;
+				p->used_num--;
+			}
+			return b;
+		}
+		link = &b->next_hash;
+	}
+	return NULL;
+}
+
+// Splits the tail of a block exceeding size into a new free block
+static void split_tail(tlsf_pool *p, tlsf_block *b, uint32_t size) {
+	if (b->size - size < TLSF_GRANULARITY)
+		return;
+	tlsf_block *rem = desc_new(p);
+	if (!rem)
+		return;
+	rem->base = b->base + size;
+	rem->size = b->size - size;
+	rem->prev_phys = b;
+	rem->next_phys = b->next_phys;
+	if (rem->next_phys)
+		rem->next_phys->prev_phys = rem;
+	b->next_phys = rem;
+	b->size = size;
+
+	// Merging with the following block if it's free
+	tlsf_block *next = rem->next_phys;
+	if (next && next->is_free) {
+		free_list_remove(p, next);
+		rem->size += next->size;
+		rem->next_phys = next->next_phys;
+		if (rem->next_phys)
+			rem->next_phys->prev_phys = rem;
+		desc_release(p, next);
+	}
+	free_list_insert(p, rem);
+}
+
+void tlsf_init(tlsf_pool *p) {
+	memset(p, 0, sizeof(tlsf_pool));
+	hash_grow(p);
+}
+
+void tlsf_destroy(tlsf_pool *p) {
+	tlsf_block *chunk = (tlsf_block *)p->chunks;
+	while (chunk) {
+		tlsf_block *next = chunk[0].next_free;
+		free(chunk);
+		chunk = next;
+	}
+	free(p->hash);
+	memset(p, 0, sizeof(tlsf_pool));
+}
+
+int tlsf_add_region(tlsf_pool *p, void *base, size_t size) {
+	uintptr_t start = tlsf_align_up((uintptr_t)base, TLSF_GRANULARITY);
+	size = (size - (start - (uintptr_t)base)) & ~(TLSF_GRANULARITY - 1);
+	if (!size || size > UINT32_MAX)
+		return 0;
+	tlsf_block *b = desc_new(p);
+	if (!b)
+		return 0;
+	b->base = start;
+	b->size = size;
+	b->prev_phys = NULL;
+	b->next_phys = NULL;
+	free_list_insert(p, b);
+	p->free_size += size;
+	p->total_size += size;
+	return 1;
+}
+
+void *tlsf_alloc(tlsf_pool *p, size_t size, size_t alignment) {
+	if (size > UINT32_MAX / 2)
+		return NULL;
+	size = tlsf_align_up(size ? size : 1, TLSF_GRANULARITY);
+	if (alignment < TLSF_GRANULARITY)
+		alignment = TLSF_GRANULARITY;
+
+	// Looking for a block big enough to hold the requested size once aligned
+	uint32_t search_size = size + (alignment > TLSF_GRANULARITY ? alignment - TLSF_GRANULARITY : 0);
+	tlsf_block *b = find_suitable(p, search_size);
+	if (!b)
+		return NULL;
+	free_list_remove(p, b);
+
+	// Splitting the leading part of the block if misaligned
+	uint32_t skip = tlsf_align_up(b->base, alignment) - b->base;
+	if (skip) {
+		tlsf_block *lead = desc_new(p);
+		if (!lead) {
+			free_list_insert(p, b);
+			return NULL;
+		}
+		lead->base = b->base;
+		lead->size = skip;
+		lead->prev_phys = b->prev_phys;
+		lead->next_phys = b;
+		if (lead->prev_phys)
+			lead->prev_phys->next_phys = lead;
+		b->prev_phys = lead;
+		b->base += skip;
+		b->size -= skip;
+		free_list_insert(p, lead);
+	}
+
+	split_tail(p, b, size);
+	hash_insert(p, b);
+	p->free_size -= b->size;
+	return (void *)b->base;
+}
+
+int tlsf_free(tlsf_pool *p, void *ptr) {
+	tlsf_block *b = hash_find(p, (uintptr_t)ptr, 1);
+	if (!b)
+		return 0;
+	p->free_size += b->size;
+
+	// Merging with free neighbours
+	tlsf_block *prev = b->prev_phys;
+	if (prev && prev->is_free) {
+		free_list_remove(p, prev);
+		prev->size += b->size;
+		prev->next_phys = b->next_phys;
+		if (prev->next_phys)
+			prev->next_phys->prev_phys = prev;
+		desc_release(p, b);
+		b = prev;
+	}
+	tlsf_block *next = b->next_phys;
+	if (next && next->is_free) {
+		free_list_remove(p, next);
+		b->size += next->size;
+		b->next_phys = next->next_phys;
+		if (b->next_phys)
+			b->next_phys->prev_phys = b;
+		desc_release(p, next);
+	}
+	free_list_insert(p, b);
+	return 1;
+}
+
+void *tlsf_realloc(tlsf_pool *p, void *ptr, size_t size) {
+	tlsf_block *b = hash_find(p, (uintptr_t)ptr, 0);
+	if (!b || size > UINT32_MAX / 2)
+		return NULL;
+	size = tlsf_align_up(size ? size : 1, TLSF_GRANULARITY);
+
+	// Shrinking in place
+	if (size <= b->size) {
+		uint32_t old_size = b->size;
+		split_tail(p, b, size);
+		p->free_size += old_size - b->size;
+		return ptr;
+	}
+
+	// Growing in place if the following block is free and big enough
+	tlsf_block *next = b->next_phys;
+	if (next && next->is_free && b->size + next->size >= size) {
+		free_list_remove(p, next);
+		p->free_size -= next->size;
+		b->size += next->size;
+		b->next_phys = next->next_phys;
+		if (b->next_phys)
+			b->next_phys->prev_phys = b;
+		desc_release(p, next);
+		uint32_t old_size = b->size;
+		split_tail(p, b, size);
+		p->free_size += old_size - b->size;
+		return ptr;
+	}
+
+	// Moving to a new block
+	void *res = tlsf_alloc(p, size, TLSF_GRANULARITY);
+	if (res) {
+		memcpy(res, ptr, b->size);
+		tlsf_free(p, ptr);
+	}
+	return res;
+}
+
+size_t tlsf_usable_size(tlsf_pool *p, void *ptr) {
+	tlsf_block *b = hash_find(p, (uintptr_t)ptr, 0);
+	return b ? b->size : 0;
+}
+
+size_t tlsf_largest_free(tlsf_pool *p) {
+	if (!p->fl_bitmap)
+		return 0;
+	int fl = tlsf_msb(p->fl_bitmap);
+	int sl = tlsf_msb(p->sl_bitmap[fl]);
+	size_t res = 0;
+	tlsf_block *b = p->free_lists[fl][sl];
+	while (b) {
+		if (b->size > res)
+			res = b->size;
+		b = b->next_free;
+	}
+	return res;
+}
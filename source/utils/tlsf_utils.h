@@ -0,0 +1,70 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * tlsf_utils.h:
+ * Header file for the Two-Level Segregated Fit allocator exposed by tlsf_utils.c
+ */
+
+#ifndef _TLSF_UTILS_H_
+#define _TLSF_UTILS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TLSF_GRANULARITY 16 // Minimum alignment and size granularity for allocations
+#define TLSF_SL_LOG2 5 // Log2 of the number of second level lists
+#define TLSF_SL_COUNT (1 << TLSF_SL_LOG2) // Number of second level lists for every first level class
+#define TLSF_FL_COUNT 24 // Number of first level classes (up to 4 GBs pools)
+
+// Block descriptor (kept outside of the managed memory since it may be uncached or GPU memory)
+typedef struct tlsf_block {
+	uintptr_t base; // Block start address
+	uint32_t size; // Block size in bytes
+	uint32_t is_free; // Whether the block is free
+	struct tlsf_block *prev_phys; // Previous block in memory
+	struct tlsf_block *next_phys; // Next block in memory
+	struct tlsf_block *prev_free; // Previous block in the same free list
+	struct tlsf_block *next_free; // Next block in the same free list (or next spare descriptor)
+	struct tlsf_block *next_hash; // Next used block in the same hash bucket
+} tlsf_block;
+
+// Allocator instance
+typedef struct {
+	uint32_t fl_bitmap; // First level classes with at least a free block
+	uint32_t sl_bitmap[TLSF_FL_COUNT]; // Second level lists with at least a free block
+	tlsf_block *free_lists[TLSF_FL_COUNT][TLSF_SL_COUNT];
+	tlsf_block **hash; // Used blocks indexed by address
+	uint32_t hash_mask;
+	uint32_t used_num; // Number of used blocks
+	tlsf_block *spare; // Unused block descriptors
+	void *chunks; // Allocated block descriptors chunks
+	size_t free_size; // Free memory in bytes
+	size_t total_size; // Managed memory in bytes
+} tlsf_pool;
+
+void tlsf_init(tlsf_pool *p);
+void tlsf_destroy(tlsf_pool *p);
+int tlsf_add_region(tlsf_pool *p, void *base, size_t size);
+void *tlsf_alloc(tlsf_pool *p, size_t size, size_t alignment);
+void *tlsf_realloc(tlsf_pool *p, void *ptr, size_t size);
+int tlsf_free(tlsf_pool *p, void *ptr);
+size_t tlsf_usable_size(tlsf_pool *p, void *ptr);
+size_t tlsf_largest_free(tlsf_pool *p);
+
+#endif
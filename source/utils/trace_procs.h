@@ -0,0 +1,317 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * trace_procs.h:
+ * GL entrypoints recorded in traces with the signature of their arguments (see trace_utils.h)
+ * NOTE: Users define TRACE_PROC(name, sig, types...) and TRACE_FUNC(name, ret, sig, types...) before expanding TRACE_PROCS
+ */
+
+#ifndef _TRACE_PROCS_H_
+#define _TRACE_PROCS_H_
+
+// Helpers turning a list of argument types into parameters, arguments and trace slots reads
+#define TRACE_NARGS(...) TRACE_NARGS_(0, ##__VA_ARGS__, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define TRACE_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, _9, n, ...) n
+#define TRACE_CAT(a, b) TRACE_CAT_(a, b)
+#define TRACE_CAT_(a, b) a##b
+
+#define TRACE_PARAMS(...) TRACE_CAT(TRACE_PARAMS_, TRACE_NARGS(__VA_ARGS__))(__VA_ARGS__)
+#define TRACE_PARAMS_0() void
+#define TRACE_PARAMS_1(t0) t0 a0
+#define TRACE_PARAMS_2(t0, t1) TRACE_PARAMS_1(t0), t1 a1
+#define TRACE_PARAMS_3(t0, t1, t2) TRACE_PARAMS_2(t0, t1), t2 a2
+#define TRACE_PARAMS_4(t0, t1, t2, t3) TRACE_PARAMS_3(t0, t1, t2), t3 a3
+#define TRACE_PARAMS_5(t0, t1, t2, t3, t4) TRACE_PARAMS_4(t0, t1, t2, t3), t4 a4
+#define TRACE_PARAMS_6(t0, t1, t2, t3, t4, t5) TRACE_PARAMS_5(t0, t1, t2, t3, t4), t5 a5
+#define TRACE_PARAMS_7(t0, t1, t2, t3, t4, t5, t6) TRACE_PARAMS_6(t0, t1, t2, t3, t4, t5), t6 a6
+#define TRACE_PARAMS_8(t0, t1, t2, t3, t4, t5, t6, t7) TRACE_PARAMS_7(t0, t1, t2, t3, t4, t5, t6), t7 a7
+#define TRACE_PARAMS_9(t0, t1, t2, t3, t4, t5, t6, t7, t8) TRACE_PARAMS_8(t0, t1, t2, t3, t4, t5, t6, t7), t8 a8
+
+// Arguments list, TRACE_VARGS also prepends a comma when not empty
+#define TRACE_ARGS(...) TRACE_CAT(TRACE_ARGS_, TRACE_NARGS(__VA_ARGS__))
+#define TRACE_VARGS(...) TRACE_CAT(TRACE_VARGS_, TRACE_NARGS(__VA_ARGS__))
+#define TRACE_ARGS_0
+#define TRACE_ARGS_1 a0
+#define TRACE_ARGS_2 TRACE_ARGS_1, a1
+#define TRACE_ARGS_3 TRACE_ARGS_2, a2
+#define TRACE_ARGS_4 TRACE_ARGS_3, a3
+#define TRACE_ARGS_5 TRACE_ARGS_4, a4
+#define TRACE_ARGS_6 TRACE_ARGS_5, a5
+#define TRACE_ARGS_7 TRACE_ARGS_6, a6
+#define TRACE_ARGS_8 TRACE_ARGS_7, a7
+#define TRACE_ARGS_9 TRACE_ARGS_8, a8
+#define TRACE_VARGS_0
+#define TRACE_VARGS_1 , TRACE_ARGS_1
+#define TRACE_VARGS_2 , TRACE_ARGS_2
+#define TRACE_VARGS_3 , TRACE_ARGS_3
+#define TRACE_VARGS_4 , TRACE_ARGS_4
+#define TRACE_VARGS_5 , TRACE_ARGS_5
+#define TRACE_VARGS_6 , TRACE_ARGS_6
+#define TRACE_VARGS_7 , TRACE_ARGS_7
+#define TRACE_VARGS_8 , TRACE_ARGS_8
+#define TRACE_VARGS_9 , TRACE_ARGS_9
+
+// Reads of the arguments from an array of trace_slot named slots (values are stored in their own type at the slot start)
+#define TRACE_SLOT(i, t) (*(t *)&slots[i])
+#define TRACE_SLOTS(...) TRACE_CAT(TRACE_SLOTS_, TRACE_NARGS(__VA_ARGS__))(__VA_ARGS__)
+#define TRACE_SLOTS_0()
+#define TRACE_SLOTS_1(t0) TRACE_SLOT(0, t0)
+#define TRACE_SLOTS_2(t0, t1) TRACE_SLOTS_1(t0), TRACE_SLOT(1, t1)
+#define TRACE_SLOTS_3(t0, t1, t2) TRACE_SLOTS_2(t0, t1), TRACE_SLOT(2, t2)
+#define TRACE_SLOTS_4(t0, t1, t2, t3) TRACE_SLOTS_3(t0, t1, t2), TRACE_SLOT(3, t3)
+#define TRACE_SLOTS_5(t0, t1, t2, t3, t4) TRACE_SLOTS_4(t0, t1, t2, t3), TRACE_SLOT(4, t4)
+#define TRACE_SLOTS_6(t0, t1, t2, t3, t4, t5) TRACE_SLOTS_5(t0, t1, t2, t3, t4), TRACE_SLOT(5, t5)
+#define TRACE_SLOTS_7(t0, t1, t2, t3, t4, t5, t6) TRACE_SLOTS_6(t0, t1, t2, t3, t4, t5), TRACE_SLOT(6, t6)
+#define TRACE_SLOTS_8(t0, t1, t2, t3, t4, t5, t6, t7) TRACE_SLOTS_7(t0, t1, t2, t3, t4, t5, t6), TRACE_SLOT(7, t7)
+#define TRACE_SLOTS_9(t0, t1, t2, t3, t4, t5, t6, t7, t8) TRACE_SLOTS_8(t0, t1, t2, t3, t4, t5, t6, t7), TRACE_SLOT(8, t8)
+
+// clang-format off
+#define TRACE_PROCS \
+	TRACE_PROC(glActiveTexture, "i", GLenum) \
+	TRACE_PROC(glAlphaFunc, "if", GLenum, GLfloat) \
+	TRACE_PROC(glAlphaFuncx, "ii", GLenum, GLfixed) \
+	TRACE_PROC(glAttachShader, "PS", GLuint, GLuint) \
+	TRACE_PROC(glBegin, "i", GLenum) \
+	TRACE_PROC(glBindAttribLocation, "Pis", GLuint, GLuint, const GLchar *) \
+	TRACE_PROC(glBindBuffer, "iB", GLenum, GLuint) \
+	TRACE_PROC(glBindFramebuffer, "iF", GLenum, GLuint) \
+	TRACE_PROC(glBindRenderbuffer, "iR", GLenum, GLuint) \
+	TRACE_PROC(glBindTexture, "iT", GLenum, GLuint) \
+	TRACE_PROC(glBlendEquation, "i", GLenum) \
+	TRACE_PROC(glBlendEquationSeparate, "ii", GLenum, GLenum) \
+	TRACE_PROC(glBlendFunc, "ii", GLenum, GLenum) \
+	TRACE_PROC(glBlendFuncSeparate, "iiii", GLenum, GLenum, GLenum, GLenum) \
+	TRACE_PROC(glBufferData, "iib[a1]i", GLenum, GLsizei, const GLvoid *, GLenum) \
+	TRACE_PROC(glBufferSubData, "iiib[a2]", GLenum, GLintptr, GLsizeiptr, const void *) \
+	TRACE_PROC(glCallList, "L", GLuint) \
+	TRACE_FUNC(glCheckFramebufferStatus, GLenum, "i", GLenum) \
+	TRACE_PROC(glClear, "i", GLbitfield) \
+	TRACE_PROC(glClearColor, "ffff", GLfloat, GLfloat, GLfloat, GLfloat) \
+	TRACE_PROC(glClearColorx, "iiii", GLclampx, GLclampx, GLclampx, GLclampx) \
+	TRACE_PROC(glClearDepth, "d", GLdouble) \
+	TRACE_PROC(glClearDepthf, "f", GLclampf) \
+	TRACE_PROC(glClearDepthx, "i", GLclampx) \
+	TRACE_PROC(glClearStencil, "i", GLint) \
+	TRACE_PROC(glClientActiveTexture, "i", GLenum) \
+	TRACE_PROC(glClipPlane, "ib[32]", GLenum, const GLdouble *) \
+	TRACE_PROC(glColor3f, "fff", GLfloat, GLfloat, GLfloat) \
+	TRACE_PROC(glColor3fv, "b[12]", const GLfloat *) \
+	TRACE_PROC(glColor3ub, "iii", GLubyte, GLubyte, GLubyte) \
+	TRACE_PROC(glColor3ubv, "b[3]", const GLubyte *) \
+	TRACE_PROC(glColor4f, "ffff", GLfloat, GLfloat, GLfloat, GLfloat) \
+	TRACE_PROC(glColor4fv, "b[16]", const GLfloat *) \
+	TRACE_PROC(glColor4ub, "iiii", GLubyte, GLubyte, GLubyte, GLubyte) \
+	TRACE_PROC(glColor4ubv, "b[4]", const GLubyte *) \
+	TRACE_PROC(glColor4x, "iiii", GLfixed, GLfixed, GLfixed, GLfixed) \
+	TRACE_PROC(glColorMask, "iiii", GLboolean, GLboolean, GLboolean, GLboolean) \
+	TRACE_PROC(glColorMaterial, "ii", GLenum, GLenum) \
+	TRACE_PROC(glColorPointer, "iiip", GLint, GLenum, GLsizei, const GLvoid *) \
+	TRACE_PROC(glColorTable, "iiiiib[t2,-,3,4]", GLenum, GLenum, GLsizei, GLenum, GLenum, const GLvoid *) \
+	TRACE_PROC(glCompileShader, "S", GLuint) \
+	TRACE_PROC(glCompressedTexImage2D, "iiiiiiib[a6]", GLenum, GLint, GLenum, GLsizei, GLsizei, GLint, GLsizei, const void *) \
+	TRACE_FUNC(glCreateProgram, GLuint, ":P") \
+	TRACE_FUNC(glCreateShader, GLuint, "i:S", GLenum) \
+	TRACE_PROC(glCullFace, "i", GLenum) \
+	TRACE_PROC(glDeleteBuffers, "iNB[a0]", GLsizei, const GLuint *) \
+	TRACE_PROC(glDeleteFramebuffers, "iNF[a0]", GLsizei, const GLuint *) \
+	TRACE_PROC(glDeleteLists, "Li", GLuint, GLsizei) \
+	TRACE_PROC(glDeleteProgram, "P", GLuint) \
+	TRACE_PROC(glDeleteRenderbuffers, "iNR[a0]", GLsizei, const GLuint *) \
+	TRACE_PROC(glDeleteShader, "S", GLuint) \
+	TRACE_PROC(glDeleteTextures, "iNT[a0]", GLsizei, const GLuint *) \
+	TRACE_PROC(glDepthFunc, "i", GLenum) \
+	TRACE_PROC(glDepthMask, "i", GLboolean) \
+	TRACE_PROC(glDepthRange, "dd", GLdouble, GLdouble) \
+	TRACE_PROC(glDepthRangef, "ff", GLfloat, GLfloat) \
+	TRACE_PROC(glDisable, "i", GLenum) \
+	TRACE_PROC(glDisableClientState, "i", GLenum) \
+	TRACE_PROC(glDisableVertexAttribArray, "i", GLuint) \
+	TRACE_PROC(glDrawArrays, "iii", GLenum, GLint, GLsizei) \
+	TRACE_PROC(glDrawElements, "iiie", GLenum, GLsizei, GLenum, const GLvoid *) \
+	TRACE_PROC(glDrawElementsBaseVertex, "iiiei", GLenum, GLsizei, GLenum, const GLvoid *, GLint) \
+	TRACE_PROC(glEnable, "i", GLenum) \
+	TRACE_PROC(glEnableClientState, "i", GLenum) \
+	TRACE_PROC(glEnableVertexAttribArray, "i", GLuint) \
+	TRACE_PROC(glEnd, "") \
+	TRACE_PROC(glEndList, "") \
+	TRACE_PROC(glFinish, "") \
+	TRACE_PROC(glFlush, "") \
+	TRACE_PROC(glFlushMappedBufferRange, "iii", GLenum, GLintptr, GLsizeiptr) \
+	TRACE_PROC(glFogf, "if", GLenum, GLfloat) \
+	TRACE_PROC(glFogfv, "ib[p0*4]", GLenum, const GLfloat *) \
+	TRACE_PROC(glFogi, "ii", GLenum, const GLint) \
+	TRACE_PROC(glFramebufferRenderbuffer, "iiiR", GLenum, GLenum, GLenum, GLuint) \
+	TRACE_PROC(glFramebufferTexture, "iiTi", GLenum, GLenum, GLuint, GLint) \
+	TRACE_PROC(glFramebufferTexture2D, "iiiTi", GLenum, GLenum, GLenum, GLuint, GLint) \
+	TRACE_PROC(glFrontFace, "i", GLenum) \
+	TRACE_PROC(glFrustum, "dddddd", GLdouble, GLdouble, GLdouble, GLdouble, GLdouble, GLdouble) \
+	TRACE_PROC(glFrustumf, "ffffff", GLfloat, GLfloat, GLfloat, GLfloat, GLfloat, GLfloat) \
+	TRACE_PROC(glFrustumx, "iiiiii", GLfixed, GLfixed, GLfixed, GLfixed, GLfixed, GLfixed) \
+	TRACE_PROC(glGenBuffers, "iGB[a0]", GLsizei, GLuint *) \
+	TRACE_PROC(glGenerateMipmap, "i", GLenum) \
+	TRACE_PROC(glGenFramebuffers, "iGF[a0]", GLsizei, GLuint *) \
+	TRACE_FUNC(glGenLists, GLuint, "i:L", GLsizei) \
+	TRACE_PROC(glGenRenderbuffers, "iGR[a0]", GLsizei, GLuint *) \
+	TRACE_PROC(glGenTextures, "iGT[a0]", GLsizei, GLuint *) \
+	TRACE_PROC(glGetActiveAttrib, "Piio[4]o[4]o[4]o[a2]", GLuint, GLuint, GLsizei, GLsizei *, GLint *, GLenum *, GLchar *) \
+	TRACE_PROC(glGetActiveUniform, "Piio[4]o[4]o[4]o[a2]", GLuint, GLuint, GLsizei, GLsizei *, GLint *, GLenum *, GLchar *) \
+	TRACE_PROC(glGetAttachedShaders, "Pio[4]o[a1*4]", GLuint, GLsizei, GLsizei *, GLuint *) \
+	TRACE_FUNC(glGetAttribLocation, GLint, "Ps", GLuint, const GLchar *) \
+	TRACE_PROC(glGetBooleanv, "io[64]", GLenum, GLboolean *) \
+	TRACE_PROC(glGetBufferParameteriv, "iio[64]", GLenum, GLenum, GLint *) \
+	TRACE_FUNC(glGetError, GLenum, "") \
+	TRACE_PROC(glGetFloatv, "io[64]", GLenum, GLfloat *) \
+	TRACE_PROC(glGetFramebufferAttachmentParameteriv, "iiio[64]", GLenum, GLenum, GLenum, GLint *) \
+	TRACE_PROC(glGetIntegerv, "io[64]", GLenum, GLint *) \
+	TRACE_PROC(glGetProgramBinary, "Pio[4]o[4]o[a1]", GLuint, GLsizei, GLsizei *, GLenum *, void *) \
+	TRACE_PROC(glGetProgramInfoLog, "Pio[4]o[a1]", GLuint, GLsizei, GLsizei *, GLchar *) \
+	TRACE_PROC(glGetProgramiv, "Pio[64]", GLuint, GLenum, GLint *) \
+	TRACE_PROC(glGetShaderInfoLog, "Sio[4]o[a1]", GLuint, GLsizei, GLsizei *, GLchar *) \
+	TRACE_PROC(glGetShaderiv, "Sio[64]", GLuint, GLenum, GLint *) \
+	TRACE_PROC(glGetShaderSource, "Sio[4]o[a1]", GLuint, GLsizei, GLsizei *, GLchar *) \
+	TRACE_FUNC(glGetString, const GLubyte *, "i", GLenum) \
+	TRACE_FUNC(glGetStringi, const GLubyte *, "ii", GLenum, GLuint) \
+	TRACE_FUNC(glGetUniformLocation, GLint, "Ps:U", GLuint, const GLchar *) \
+	TRACE_PROC(glGetVertexAttribfv, "iio[64]", GLuint, GLenum, GLfloat *) \
+	TRACE_PROC(glGetVertexAttribiv, "iio[64]", GLuint, GLenum, GLint *) \
+	TRACE_PROC(glGetVertexAttribPointerv, "iio[8]", GLuint, GLenum, void **) \
+	TRACE_PROC(glHint, "ii", GLenum, GLenum) \
+	TRACE_PROC(glInterleavedArrays, "iip", GLenum, GLsizei, const void *) \
+	TRACE_FUNC(glIsEnabled, GLboolean, "i", GLenum) \
+	TRACE_FUNC(glIsFramebuffer, GLboolean, "F", GLuint) \
+	TRACE_FUNC(glIsTexture, GLboolean, "T", GLuint) \
+	TRACE_PROC(glLightfv, "iib[p1*4]", GLenum, GLenum, const GLfloat *) \
+	TRACE_PROC(glLightModelfv, "ib[p0*4]", GLenum, const GLfloat *) \
+	TRACE_PROC(glLightModelxv, "ib[p0*4]", GLenum, const GLfixed *) \
+	TRACE_PROC(glLightxv, "iib[p1*4]", GLenum, GLenum, const GLfixed *) \
+	TRACE_PROC(glLineWidth, "f", GLfloat) \
+	TRACE_PROC(glLinkProgram, "P", GLuint) \
+	TRACE_PROC(glLoadIdentity, "") \
+	TRACE_PROC(glLoadMatrixf, "b[64]", const GLfloat *) \
+	TRACE_PROC(glLoadMatrixx, "b[64]", const GLfixed *) \
+	TRACE_FUNC(glMapBuffer, void *, "ii:p", GLenum, GLbitfield) \
+	TRACE_FUNC(glMapBufferRange, void *, "iiii:p", GLenum, GLintptr, GLsizeiptr, GLbitfield) \
+	TRACE_PROC(glMaterialfv, "iib[p1*4]", GLenum, GLenum, const GLfloat *) \
+	TRACE_PROC(glMaterialxv, "iib[p1*4]", GLenum, GLenum, const GLfixed *) \
+	TRACE_PROC(glMatrixMode, "i", GLenum) \
+	TRACE_PROC(glMultiTexCoord2f, "iff", GLenum, GLfloat, GLfloat) \
+	TRACE_PROC(glMultiTexCoord2fv, "ib[8]", GLenum, GLfloat *) \
+	TRACE_PROC(glMultiTexCoord2i, "iii", GLenum, GLint, GLint) \
+	TRACE_PROC(glMultMatrixf, "b[64]", const GLfloat *) \
+	TRACE_PROC(glMultMatrixx, "b[64]", const GLfixed *) \
+	TRACE_PROC(glNewList, "Li", GLuint, GLenum) \
+	TRACE_PROC(glNormal3f, "fff", GLfloat, GLfloat, GLfloat) \
+	TRACE_PROC(glNormal3fv, "b[12]", const GLfloat *) \
+	TRACE_PROC(glNormal3s, "iii", GLshort, GLshort, GLshort) \
+	TRACE_PROC(glOrtho, "dddddd", GLdouble, GLdouble, GLdouble, GLdouble, GLdouble, GLdouble) \
+	TRACE_PROC(glOrthof, "ffffff", GLfloat, GLfloat, GLfloat, GLfloat, GLfloat, GLfloat) \
+	TRACE_PROC(glPointSize, "f", GLfloat) \
+	TRACE_PROC(glPolygonMode, "ii", GLenum, GLenum) \
+	TRACE_PROC(glPolygonOffset, "ff", GLfloat, GLfloat) \
+	TRACE_PROC(glPopAttrib, "") \
+	TRACE_PROC(glPopMatrix, "") \
+	TRACE_PROC(glProgramBinary, "Pib[a3]i", GLuint, GLenum, const void *, GLsizei) \
+	TRACE_PROC(glPushAttrib, "i", GLbitfield) \
+	TRACE_PROC(glPushMatrix, "") \
+	TRACE_PROC(glReadPixels, "iiiiiio[t2,3,4,5]", GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, GLvoid *) \
+	TRACE_PROC(glReleaseShaderCompiler, "") \
+	TRACE_PROC(glRenderbufferStorage, "iiii", GLenum, GLenum, GLsizei, GLsizei) \
+	TRACE_PROC(glRotatef, "ffff", GLfloat, GLfloat, GLfloat, GLfloat) \
+	TRACE_PROC(glRotatex, "iiii", GLfixed, GLfixed, GLfixed, GLfixed) \
+	TRACE_PROC(glScalef, "fff", GLfloat, GLfloat, GLfloat) \
+	TRACE_PROC(glScalex, "iii", GLfixed, GLfixed, GLfixed) \
+	TRACE_PROC(glScissor, "iiii", GLint, GLint, GLsizei, GLsizei) \
+	TRACE_PROC(glShadeModel, "i", GLenum) \
+	TRACE_PROC(glShaderBinary, "iNS[a0]ib[a4]i", GLsizei, const GLuint *, GLenum, const void *, GLsizei) \
+	TRACE_PROC(glShaderSource, "Siqx", GLuint, GLsizei, const GLchar *const *, const GLint *) \
+	TRACE_PROC(glStencilFunc, "iii", GLenum, GLint, GLuint) \
+	TRACE_PROC(glStencilFuncSeparate, "iiii", GLenum, GLenum, GLint, GLuint) \
+	TRACE_PROC(glStencilMask, "i", GLuint) \
+	TRACE_PROC(glStencilMaskSeparate, "ii", GLenum, GLuint) \
+	TRACE_PROC(glStencilOp, "iii", GLenum, GLenum, GLenum) \
+	TRACE_PROC(glStencilOpSeparate, "iiii", GLenum, GLenum, GLenum, GLenum) \
+	TRACE_PROC(glTexCoord2f, "ff", GLfloat, GLfloat) \
+	TRACE_PROC(glTexCoord2fv, "b[8]", GLfloat *) \
+	TRACE_PROC(glTexCoord2i, "ii", GLint, GLint) \
+	TRACE_PROC(glTexCoord2s, "ii", GLshort, GLshort) \
+	TRACE_PROC(glTexCoordPointer, "iiip", GLint, GLenum, GLsizei, const GLvoid *) \
+	TRACE_PROC(glTexEnvf, "iif", GLenum, GLenum, GLfloat) \
+	TRACE_PROC(glTexEnvfv, "iib[p1*4]", GLenum, GLenum, GLfloat *) \
+	TRACE_PROC(glTexEnvi, "iii", GLenum, GLenum, GLint) \
+	TRACE_PROC(glTexEnvx, "iii", GLenum, GLenum, GLfixed) \
+	TRACE_PROC(glTexEnvxv, "iib[p1*4]", GLenum, GLenum, GLfixed *) \
+	TRACE_PROC(glTexImage2D, "iiiiiiiib[t3,4,6,7]", GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const GLvoid *) \
+	TRACE_PROC(glTexParameterf, "iif", GLenum, GLenum, GLfloat) \
+	TRACE_PROC(glTexParameteri, "iii", GLenum, GLenum, GLint) \
+	TRACE_PROC(glTexSubImage2D, "iiiiiiiib[t4,5,6,7]", GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, const GLvoid *) \
+	TRACE_PROC(glTranslatef, "fff", GLfloat, GLfloat, GLfloat) \
+	TRACE_PROC(glTranslatex, "iii", GLfixed, GLfixed, GLfixed) \
+	TRACE_PROC(glUniform1f, "Uf", GLint, GLfloat) \
+	TRACE_PROC(glUniform1fv, "Uib[a1*4]", GLint, GLsizei, const GLfloat *) \
+	TRACE_PROC(glUniform1i, "Ui", GLint, GLint) \
+	TRACE_PROC(glUniform1iv, "Uib[a1*4]", GLint, GLsizei, const GLint *) \
+	TRACE_PROC(glUniform2f, "Uff", GLint, GLfloat, GLfloat) \
+	TRACE_PROC(glUniform2fv, "Uib[a1*8]", GLint, GLsizei, const GLfloat *) \
+	TRACE_PROC(glUniform2i, "Uii", GLint, GLint, GLint) \
+	TRACE_PROC(glUniform2iv, "Uib[a1*8]", GLint, GLsizei, const GLint *) \
+	TRACE_PROC(glUniform3f, "Ufff", GLint, GLfloat, GLfloat, GLfloat) \
+	TRACE_PROC(glUniform3fv, "Uib[a1*12]", GLint, GLsizei, const GLfloat *) \
+	TRACE_PROC(glUniform3i, "Uiii", GLint, GLint, GLint, GLint) \
+	TRACE_PROC(glUniform3iv, "Uib[a1*12]", GLint, GLsizei, const GLint *) \
+	TRACE_PROC(glUniform4f, "Uffff", GLint, GLfloat, GLfloat, GLfloat, GLfloat) \
+	TRACE_PROC(glUniform4fv, "Uib[a1*16]", GLint, GLsizei, const GLfloat *) \
+	TRACE_PROC(glUniform4i, "Uiiii", GLint, GLint, GLint, GLint, GLint) \
+	TRACE_PROC(glUniform4iv, "Uib[a1*16]", GLint, GLsizei, const GLint *) \
+	TRACE_PROC(glUniformMatrix2fv, "Uiib[a1*16]", GLint, GLsizei, GLboolean, const GLfloat *) \
+	TRACE_PROC(glUniformMatrix3fv, "Uiib[a1*36]", GLint, GLsizei, GLboolean, const GLfloat *) \
+	TRACE_PROC(glUniformMatrix4fv, "Uiib[a1*64]", GLint, GLsizei, GLboolean, const GLfloat *) \
+	TRACE_FUNC(glUnmapBuffer, GLboolean, "i", GLenum) \
+	TRACE_PROC(glUseProgram, "P", GLuint) \
+	TRACE_PROC(glVertex2f, "ff", GLfloat, GLfloat) \
+	TRACE_PROC(glVertex2i, "ii", GLint, GLint) \
+	TRACE_PROC(glVertex3f, "fff", GLfloat, GLfloat, GLfloat) \
+	TRACE_PROC(glVertex3fv, "b[12]", const GLfloat *) \
+	TRACE_PROC(glVertex3i, "iii", GLint, GLint, GLint) \
+	TRACE_PROC(glVertexAttrib1f, "if", GLuint, GLfloat) \
+	TRACE_PROC(glVertexAttrib1fv, "ib[4]", GLuint, const GLfloat *) \
+	TRACE_PROC(glVertexAttrib2f, "iff", GLuint, GLfloat, GLfloat) \
+	TRACE_PROC(glVertexAttrib2fv, "ib[8]", GLuint, const GLfloat *) \
+	TRACE_PROC(glVertexAttrib3f, "ifff", GLuint, GLfloat, GLfloat, GLfloat) \
+	TRACE_PROC(glVertexAttrib3fv, "ib[12]", GLuint, const GLfloat *) \
+	TRACE_PROC(glVertexAttrib4f, "iffff", GLuint, GLfloat, GLfloat, GLfloat, GLfloat) \
+	TRACE_PROC(glVertexAttrib4fv, "ib[16]", GLuint, const GLfloat *) \
+	TRACE_PROC(glVertexAttribPointer, "iiiiip", GLuint, GLint, GLenum, GLboolean, GLsizei, const void *) \
+	TRACE_PROC(glVertexPointer, "iiip", GLint, GLenum, GLsizei, const GLvoid *) \
+	TRACE_PROC(glViewport, "iiii", GLint, GLint, GLsizei, GLsizei) \
+	TRACE_PROC(gluBuild2DMipmaps, "iiiiiib[t2,3,4,5]", GLenum, GLint, GLsizei, GLsizei, GLenum, GLenum, const void *) \
+	TRACE_PROC(gluLookAt, "ddddddddd", GLdouble, GLdouble, GLdouble, GLdouble, GLdouble, GLdouble, GLdouble, GLdouble, GLdouble) \
+	TRACE_PROC(gluPerspective, "dddd", GLdouble, GLdouble, GLdouble, GLdouble)
+// clang-format on
+
+// Ids of the recorded procs
+#define TRACE_PROC(name, sig, ...) TRACE_ID_##name,
+#define TRACE_FUNC(name, ret, sig, ...) TRACE_ID_##name,
+typedef enum {
+	TRACE_PROCS
+	TRACE_PROCS_NUM
+} trace_proc_id;
+#undef TRACE_PROC
+#undef TRACE_FUNC
+
+#endif
@@ -0,0 +1,363 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * trace_utils.c:
+ * Signatures parsing, sizes evaluation and buffered writing of GL calls traces
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "../vitaGL.h"
+#include "trace_utils.h"
+
+static int parse_name_kind(char c) {
+	switch (c) {
+	case 'T':
+		return TRACE_NAME_TEXTURE;
+	case 'B':
+		return TRACE_NAME_BUFFER;
+	case 'F':
+		return TRACE_NAME_FRAMEBUFFER;
+	case 'R':
+		return TRACE_NAME_RENDERBUFFER;
+	case 'P':
+		return TRACE_NAME_PROGRAM;
+	case 'S':
+		return TRACE_NAME_SHADER;
+	case 'L':
+		return TRACE_NAME_LIST;
+	case 'U':
+		return TRACE_NAME_UNIFORM;
+	default:
+		return -1;
+	}
+}
+
+static const char *parse_size(const char *s, trace_size *size) {
+	if (*s++ != '[')
+		return NULL;
+	memset(size->args, 0xFF, sizeof(size->args));
+	size->mul = 1;
+	switch (*s) {
+	case 'a':
+	case 'p':
+		size->type = *s == 'a' ? TRACE_SIZE_ARG : TRACE_SIZE_PNAME;
+		size->args[0] = strtoul(s + 1, (char **)&s, 10);
+		if (*s == '*')
+			size->mul = strtoul(s + 1, (char **)&s, 10);
+		break;
+	case 't':
+		size->type = TRACE_SIZE_IMAGE;
+		s++;
+		for (int i = 0; i < 4; i++) {
+			if (*s == '-')
+				s++;
+			else
+				size->args[i] = strtoul(s, (char **)&s, 10);
+			if (i < 3 && *s++ != ',')
+				return NULL;
+		}
+		break;
+	default:
+		size->type = TRACE_SIZE_CONST;
+		size->mul = strtoul(s, (char **)&s, 10);
+		break;
+	}
+	return *s == ']' ? s + 1 : NULL;
+}
+
+static const char *parse_arg(const char *s, trace_arg *arg) {
+	memset(arg, 0, sizeof(trace_arg));
+	int kind = parse_name_kind(*s);
+	if (kind >= 0) {
+		arg->type = TRACE_ARG_NAME;
+		arg->kind = kind;
+		return s + 1;
+	}
+	switch (*s) {
+	case 'i':
+		arg->type = TRACE_ARG_INT;
+		return s + 1;
+	case 'f':
+		arg->type = TRACE_ARG_FLOAT;
+		return s + 1;
+	case 'd':
+		arg->type = TRACE_ARG_DOUBLE;
+		return s + 1;
+	case 'p':
+		arg->type = TRACE_ARG_PTR;
+		return s + 1;
+	case 's':
+		arg->type = TRACE_ARG_STRING;
+		return s + 1;
+	case 'e':
+		arg->type = TRACE_ARG_INDICES;
+		return s + 1;
+	case 'q':
+		arg->type = TRACE_ARG_SOURCES;
+		return s + 1;
+	case 'x':
+		arg->type = TRACE_ARG_IGNORED;
+		return s + 1;
+	case 'b':
+	case 'o':
+		arg->type = *s == 'b' ? TRACE_ARG_BLOB : TRACE_ARG_OUT;
+		return parse_size(s + 1, &arg->size);
+	case 'N':
+	case 'G':
+		arg->type = *s == 'N' ? TRACE_ARG_NAMES : TRACE_ARG_GEN_NAMES;
+		kind = parse_name_kind(s[1]);
+		if (kind < 0)
+			return NULL;
+		arg->kind = kind;
+		return parse_size(s + 2, &arg->size);
+	default:
+		return NULL;
+	}
+}
+
+int trace_parse_sig(const char *str, trace_sig *sig) {
+	memset(sig, 0, sizeof(trace_sig));
+	const char *s = str;
+	while (*s && *s != ':') {
+		if (sig->args_num == TRACE_MAX_ARGS)
+			return 0;
+		trace_arg *arg = &sig->args[sig->args_num++];
+		s = parse_arg(s, arg);
+		if (!s)
+			return 0;
+		if (arg->type == TRACE_ARG_GEN_NAMES)
+			sig->after = 1;
+	}
+	if (*s == ':') {
+		s = parse_arg(s + 1, &sig->ret);
+		if (!s || *s || (sig->ret.type != TRACE_ARG_NAME && sig->ret.type != TRACE_ARG_PTR))
+			return 0;
+		sig->has_ret = 1;
+		sig->after = 1;
+	}
+	return 1;
+}
+
+uint32_t trace_pname_count(uint32_t pname) {
+	switch (pname) {
+	case GL_AMBIENT:
+	case GL_DIFFUSE:
+	case GL_SPECULAR:
+	case GL_POSITION:
+	case GL_EMISSION:
+	case GL_AMBIENT_AND_DIFFUSE:
+	case GL_FOG_COLOR:
+	case GL_LIGHT_MODEL_AMBIENT:
+	case GL_TEXTURE_ENV_COLOR:
+		return 4;
+	default:
+		return 1;
+	}
+}
+
+uint32_t trace_type_size(uint32_t type) {
+	switch (type) {
+	case GL_BYTE:
+	case GL_UNSIGNED_BYTE:
+		return 1;
+	case GL_SHORT:
+	case GL_UNSIGNED_SHORT:
+	case GL_HALF_FLOAT:
+		return 2;
+	default:
+		return 4;
+	}
+}
+
+uint32_t trace_pixels_size(uint32_t width, uint32_t height, uint32_t format, uint32_t type) {
+	uint32_t bpp;
+	switch (type) {
+	case GL_UNSIGNED_SHORT_5_6_5:
+	case GL_UNSIGNED_SHORT_4_4_4_4:
+	case GL_UNSIGNED_SHORT_5_5_5_1:
+		bpp = 2;
+		break;
+	default:
+		switch (format) {
+		case GL_RED:
+		case GL_ALPHA:
+		case GL_LUMINANCE:
+		case GL_INTENSITY:
+		case GL_COLOR_INDEX:
+		case GL_COLOR_INDEX8_EXT:
+		case GL_DEPTH_COMPONENT:
+			bpp = 1;
+			break;
+		case GL_LUMINANCE_ALPHA:
+		case GL_RG:
+			bpp = 2;
+			break;
+		case GL_RGB:
+		case GL_BGR:
+			bpp = 3;
+			break;
+		default:
+			bpp = 4;
+			break;
+		}
+		bpp *= trace_type_size(type);
+		break;
+	}
+	// Pixel rows are always tightly packed (GL_UNPACK_ALIGNMENT is 1)
+	return width * height * bpp;
+}
+
+uint32_t trace_eval_size(const trace_size *size, const trace_slot *slots) {
+	switch (size->type) {
+	case TRACE_SIZE_CONST:
+		return size->mul;
+	case TRACE_SIZE_ARG:
+		return slots[size->args[0]].i > 0 ? slots[size->args[0]].u * size->mul : 0;
+	case TRACE_SIZE_PNAME:
+		return trace_pname_count(slots[size->args[0]].u) * size->mul;
+	case TRACE_SIZE_IMAGE:
+		return trace_pixels_size(slots[size->args[0]].u, size->args[1] == 0xFF ? 1 : slots[size->args[1]].u, slots[size->args[2]].u, slots[size->args[3]].u);
+	default:
+		return 0;
+	}
+}
+
+uint64_t trace_hash(const void *data, uint32_t size) {
+	const uint8_t *p = (const uint8_t *)data;
+	uint64_t h = 0xCBF29CE484222325ULL ^ size;
+	while (size >= 8) {
+		uint64_t w;
+		memcpy(&w, p, 8);
+		h = (h ^ w) * 0x9E3779B97F4A7C15ULL;
+		h ^= h >> 29;
+		p += 8;
+		size -= 8;
+	}
+	while (size--) {
+		h = (h ^ *p++) * 0x100000001B3ULL;
+	}
+	h ^= h >> 33;
+	h *= 0xFF51AFD7ED558CCDULL;
+	h ^= h >> 33;
+	h *= 0xC4CEB9FE1A85EC53ULL;
+	h ^= h >> 33;
+	// Zero marks empty slots of the deduplication table
+	return h ? h : 1;
+}
+
+int trace_writer_open(trace_writer *w, const char *path) {
+	memset(w, 0, sizeof(trace_writer));
+	w->f = fopen(path, "wb");
+	if (!w->f)
+		return 0;
+	w->buf = (uint8_t *)malloc(TRACE_BUFFER_SIZE);
+	w->blobs_size = TRACE_BLOBS_DEF_SIZE;
+	w->blob_keys = (uint64_t *)calloc(w->blobs_size, sizeof(uint64_t));
+	w->blob_ids = (uint32_t *)malloc(w->blobs_size * sizeof(uint32_t));
+	trace_header hdr = {TRACE_MAGIC, TRACE_VERSION, sizeof(void *), {0, 0}};
+	trace_write(w, &hdr, sizeof(trace_header));
+	return 1;
+}
+
+void trace_writer_flush(trace_writer *w) {
+	if (w->used) {
+		fwrite(w->buf, 1, w->used, w->f);
+		w->used = 0;
+	}
+	fflush(w->f);
+}
+
+void trace_writer_close(trace_writer *w) {
+	if (!w->f)
+		return;
+	trace_writer_flush(w);
+	fclose(w->f);
+	free(w->buf);
+	free(w->blob_keys);
+	free(w->blob_ids);
+	w->f = NULL;
+}
+
+void trace_write(trace_writer *w, const void *data, uint32_t size) {
+	w->stats.bytes += size;
+	const uint8_t *src = (const uint8_t *)data;
+	while (size) {
+		if (w->used == TRACE_BUFFER_SIZE) {
+			fwrite(w->buf, 1, w->used, w->f);
+			w->used = 0;
+		}
+		uint32_t chunk = TRACE_BUFFER_SIZE - w->used;
+		if (chunk > size)
+			chunk = size;
+		memcpy(w->buf + w->used, src, chunk);
+		w->used += chunk;
+		src += chunk;
+		size -= chunk;
+	}
+}
+
+static void grow_blobs_table(trace_writer *w) {
+	uint32_t old_size = w->blobs_size;
+	uint64_t *old_keys = w->blob_keys;
+	uint32_t *old_ids = w->blob_ids;
+	w->blobs_size *= 2;
+	w->blob_keys = (uint64_t *)calloc(w->blobs_size, sizeof(uint64_t));
+	w->blob_ids = (uint32_t *)malloc(w->blobs_size * sizeof(uint32_t));
+	for (uint32_t i = 0; i < old_size; i++) {
+		if (old_keys[i]) {
+			uint32_t j = old_keys[i] & (w->blobs_size - 1);
+			while (w->blob_keys[j])
+				j = (j + 1) & (w->blobs_size - 1);
+			w->blob_keys[j] = old_keys[i];
+			w->blob_ids[j] = old_ids[i];
+		}
+	}
+	free(old_keys);
+	free(old_ids);
+}
+
+uint32_t trace_write_blob(trace_writer *w, const void *data, uint32_t size) {
+	if (!data)
+		return TRACE_NULL_BLOB;
+
+	// Looking for an already written blob with the same content
+	uint64_t key = trace_hash(data, size);
+	uint32_t i = key & (w->blobs_size - 1);
+	while (w->blob_keys[i]) {
+		if (w->blob_keys[i] == key) {
+			w->stats.blobs_reused++;
+			return w->blob_ids[i];
+		}
+		i = (i + 1) & (w->blobs_size - 1);
+	}
+
+	uint32_t id = w->stats.blobs++;
+	w->blob_keys[i] = key;
+	w->blob_ids[i] = id;
+	if (w->stats.blobs * 2 > w->blobs_size)
+		grow_blobs_table(w);
+
+	trace_write_u8(w, TRACE_TAG_BLOB);
+	trace_write_u32(w, id);
+	trace_write_u32(w, size);
+	trace_write(w, data, size);
+	w->stats.blob_bytes += size;
+	return id;
+}
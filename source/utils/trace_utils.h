@@ -0,0 +1,220 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * trace_utils.h:
+ * Header file for the GL calls trace format utilities exposed by trace_utils.c
+ */
+
+#ifndef _TRACE_UTILS_H_
+#define _TRACE_UTILS_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define TRACE_MAGIC 0x544C4756 // 'VGLT', magic for GL calls traces
+#define TRACE_VERSION 1 // Current version of the trace format
+#define TRACE_MAX_ARGS 9 // Maximum number of arguments of a recorded call
+#define TRACE_NULL_BLOB 0xFFFFFFFF // Blob id used for NULL pointers
+#define TRACE_BUFFER_SIZE (256 * 1024) // Size in bytes of the trace writer buffer
+#define TRACE_BLOBS_DEF_SIZE 1024 // Initial number of slots of the blobs deduplication table
+
+/*
+ * Trace layout: a trace_header followed by records, each one starting with a trace_tag byte.
+ * All values are little endian and stored unaligned.
+ *
+ * TRACE_TAG_PROC         u16 id, u8 length, name       Binds a proc id to an entrypoint name, emitted before its first call
+ * TRACE_TAG_CALL         u16 id, arguments             A call, arguments are encoded as described by the proc signature
+ * TRACE_TAG_BLOB         u32 id, u32 size, data        Client memory, ids are sequential and identical content is stored once
+ * TRACE_TAG_CLIENT_ARRAY u16 id, u32 index, u32 blob  Content of a client array read by the next draw, from its start to its highest
+ *                                                      read vertex, id is the proc that set the array up and index its client texture
+ *                                                      unit or attribute index
+ * TRACE_TAG_MAP_WRITE    u32 target, u32 offset, u32 blob
+ *                                                      Data written by the application into a mapped buffer range
+ * TRACE_TAG_FRAME        u8 has_commondialog           vglSwapBuffers call
+ * TRACE_TAG_INIT         8 x u32                       vglInitWithCustomSizes arguments
+ *
+ * Signatures describe the arguments of a proc, one token per argument:
+ * i          32 bit integer, enum, boolean or fixed point value
+ * f, d       Float and double values
+ * T B F R    Texture, buffer, framebuffer and renderbuffer name (u32)
+ * P S L      Program, shader and display list name (u32)
+ * U          Uniform location (u32)
+ * p          Pointer stored as a raw value (u64), either a buffer offset or a client array address
+ * s          NUL terminated string (u32 blob id)
+ * b[size]    Client memory read by the call (u32 blob id)
+ * o[size]    Memory written by the call (u32 size), replays pass a scratch buffer
+ * N?[count]  Array of names of the given kind read by the call (u32 blob id)
+ * G?[count]  Array of names of the given kind generated by the call (u32 count, count x u32 names)
+ * e          Indices of a draw, u8 0 followed by the buffer offset (u64) or u8 1 followed by a blob id
+ * q          Shader sources, count is the previous argument and lengths the next one (u32 blob id of NUL separated strings)
+ * x          Ignored argument, replays pass NULL
+ * An optional :? suffix records the returned name of the given kind (u32) or pointer (p, u64).
+ * Calls recording returned or generated values are captured after being executed, every other one before.
+ *
+ * Sizes are expressed as:
+ * [n]        Constant number of bytes
+ * [aK]       Value of argument K
+ * [aK*n]     Value of argument K multiplied by n
+ * [pK*n]     Number of values of the parameter named by argument K multiplied by n
+ * [tW,H,F,Y] Pixel data of the image with width W, height H (- for 1), format F and type Y arguments
+ */
+
+// Records tags
+typedef enum {
+	TRACE_TAG_PROC = 1,
+	TRACE_TAG_CALL,
+	TRACE_TAG_BLOB,
+	TRACE_TAG_CLIENT_ARRAY,
+	TRACE_TAG_MAP_WRITE,
+	TRACE_TAG_FRAME,
+	TRACE_TAG_INIT
+} trace_tag;
+
+// Arguments types
+typedef enum {
+	TRACE_ARG_INT,
+	TRACE_ARG_FLOAT,
+	TRACE_ARG_DOUBLE,
+	TRACE_ARG_NAME,
+	TRACE_ARG_PTR,
+	TRACE_ARG_STRING,
+	TRACE_ARG_BLOB,
+	TRACE_ARG_OUT,
+	TRACE_ARG_NAMES,
+	TRACE_ARG_GEN_NAMES,
+	TRACE_ARG_INDICES,
+	TRACE_ARG_SOURCES,
+	TRACE_ARG_IGNORED
+} trace_arg_type;
+
+// Size expressions types
+typedef enum {
+	TRACE_SIZE_CONST,
+	TRACE_SIZE_ARG,
+	TRACE_SIZE_PNAME,
+	TRACE_SIZE_IMAGE
+} trace_size_type;
+
+// Names kinds, each one has its own namespace
+typedef enum {
+	TRACE_NAME_TEXTURE,
+	TRACE_NAME_BUFFER,
+	TRACE_NAME_FRAMEBUFFER,
+	TRACE_NAME_RENDERBUFFER,
+	TRACE_NAME_PROGRAM,
+	TRACE_NAME_SHADER,
+	TRACE_NAME_LIST,
+	TRACE_NAME_UNIFORM,
+	TRACE_NAMES_NUM
+} trace_name_kind;
+
+// Size of the memory referenced by an argument
+typedef struct {
+	uint8_t type;
+	uint8_t args[4]; // Arguments the size depends on, 0xFF for unused ones
+	uint32_t mul;
+} trace_size;
+
+// Argument of a proc
+typedef struct {
+	uint8_t type;
+	uint8_t kind; // Name kind for names arguments
+	trace_size size;
+} trace_arg;
+
+// Parsed signature of a proc
+typedef struct {
+	trace_arg args[TRACE_MAX_ARGS];
+	uint8_t args_num;
+	uint8_t has_ret;
+	trace_arg ret;
+	uint8_t after; // Set if the call must be captured after being executed
+} trace_sig;
+
+// Value of an argument
+typedef union {
+	uint32_t u;
+	int32_t i;
+	float f;
+	double d;
+	const void *p;
+	uint64_t v;
+} trace_slot;
+
+// Trace file header
+typedef struct {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t ptr_size; // Size in bytes of pointers on the capturing platform
+	uint32_t reserved[2];
+} trace_header;
+
+// Trace writing counters
+typedef struct {
+	uint32_t calls;
+	uint32_t frames;
+	uint32_t blobs; // Number of unique blobs written
+	uint32_t blobs_reused; // Number of blobs references served by an already written blob
+	uint64_t bytes; // Bytes written to the trace
+	uint64_t blob_bytes; // Bytes of unique blobs written
+} trace_stats;
+
+// Buffered trace writer with blobs deduplication
+typedef struct {
+	FILE *f;
+	uint8_t *buf;
+	uint32_t used;
+	uint64_t *blob_keys; // Content hash of written blobs, 0 for empty slots
+	uint32_t *blob_ids;
+	uint32_t blobs_size; // Number of slots of the deduplication table
+	trace_stats stats;
+} trace_writer;
+
+int trace_parse_sig(const char *str, trace_sig *sig);
+uint32_t trace_eval_size(const trace_size *size, const trace_slot *slots);
+uint32_t trace_pname_count(uint32_t pname);
+uint32_t trace_pixels_size(uint32_t width, uint32_t height, uint32_t format, uint32_t type);
+uint32_t trace_type_size(uint32_t type);
+uint64_t trace_hash(const void *data, uint32_t size);
+
+int trace_writer_open(trace_writer *w, const char *path);
+void trace_writer_close(trace_writer *w);
+void trace_writer_flush(trace_writer *w);
+void trace_write(trace_writer *w, const void *data, uint32_t size);
+uint32_t trace_write_blob(trace_writer *w, const void *data, uint32_t size);
+
+static inline void trace_write_u8(trace_writer *w, uint8_t v) {
+	if (w->used == TRACE_BUFFER_SIZE)
+		trace_writer_flush(w);
+	w->buf[w->used++] = v;
+}
+
+static inline void trace_write_u16(trace_writer *w, uint16_t v) {
+	trace_write(w, &v, 2);
+}
+
+static inline void trace_write_u32(trace_writer *w, uint32_t v) {
+	trace_write(w, &v, 4);
+}
+
+static inline void trace_write_u64(trace_writer *w, uint64_t v) {
+	trace_write(w, &v, 8);
+}
+
+#endif
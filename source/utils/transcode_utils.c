@@ -0,0 +1,456 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * transcode_utils.c:
+ * Block transcoders from ETC2/EAC and ATITC to DXT writing directly in swizzled layout
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "eac_utils.h"
+#include "atitc_utils.h"
+#include "transcode_utils.h"
+
+#define clamp_u8(x) ((x) < 0 ? 0 : ((x) > 255 ? 255 : (x)))
+
+static const int etc_modifier_table[8][4] = {
+	{2, 8, -2, -8},
+	{5, 17, -5, -17},
+	{9, 29, -9, -29},
+	{13, 42, -13, -42},
+	{18, 60, -18, -60},
+	{24, 80, -24, -80},
+	{33, 106, -33, -106},
+	{47, 183, -47, -183}
+};
+
+static const int eac_modifier_table[16][8] = {
+	{-3, -6, -9, -15, 2, 5, 8, 14},
+	{-3, -7, -10, -13, 2, 6, 9, 12},
+	{-2, -5, -8, -13, 1, 4, 7, 12},
+	{-2, -4, -6, -13, 1, 3, 5, 12},
+	{-3, -6, -8, -12, 2, 5, 7, 11},
+	{-3, -7, -9, -11, 2, 6, 8, 10},
+	{-4, -7, -8, -11, 3, 6, 7, 10},
+	{-3, -5, -8, -11, 2, 4, 7, 10},
+	{-2, -6, -8, -10, 1, 5, 7, 9},
+	{-2, -5, -8, -10, 1, 4, 7, 9},
+	{-2, -4, -8, -10, 1, 3, 7, 9},
+	{-2, -5, -7, -10, 1, 4, 6, 9},
+	{-3, -4, -7, -10, 2, 3, 6, 9},
+	{-1, -2, -3, -10, 0, 1, 2, 9},
+	{-4, -6, -8, -9, 3, 5, 7, 8},
+	{-3, -5, -7, -9, 2, 4, 6, 8}
+};
+
+// Weight of the first endpoint in thirds for every DXT color index
+static const int dxt_weight[4] = {3, 0, 2, 1};
+
+static inline int expand4(int v) {
+	return (v << 4) | v;
+}
+
+static inline int expand5(int v) {
+	return (v << 3) | (v >> 2);
+}
+
+static inline int expand6(int v) {
+	return (v << 2) | (v >> 4);
+}
+
+static inline uint16_t pack565(int r, int g, int b) {
+	r = clamp_u8(r);
+	g = clamp_u8(g);
+	b = clamp_u8(b);
+	return (((r * 31 + 127) / 255) << 11) | (((g * 63 + 127) / 255) << 5) | ((b * 31 + 127) / 255);
+}
+
+static inline void write_color(uint8_t *dst, uint16_t c0, uint16_t c1, uint32_t mask) {
+	dst[0] = c0 & 0xFF;
+	dst[1] = c0 >> 8;
+	dst[2] = c1 & 0xFF;
+	dst[3] = c1 >> 8;
+	dst[4] = mask & 0xFF;
+	dst[5] = (mask >> 8) & 0xFF;
+	dst[6] = (mask >> 16) & 0xFF;
+	dst[7] = mask >> 24;
+}
+
+/*
+ * Palette based blocks (ETC1 subblocks and EAC alpha) address up to 8 colors, so
+ * endpoints are fitted over the palette and each entry is mapped to a DXT index
+ * once instead of matching all the 16 texels
+ */
+typedef struct {
+	int color[8][3];
+	int count[8];
+	uint8_t entry[16]; // Palette entry of every texel in row major order
+} palette_block;
+
+static void palette_to_rgba(const palette_block *pb, uint8_t *block) {
+	for (int i = 0; i < 16; i++) {
+		const int *c = pb->color[pb->entry[i]];
+		block[i * 4] = c[0];
+		block[i * 4 + 1] = c[1];
+		block[i * 4 + 2] = c[2];
+		block[i * 4 + 3] = 0xFF;
+	}
+}
+
+// Maps every used palette entry to its closest DXT color, returns the total squared error
+static uint32_t map_palette(const palette_block *pb, uint16_t c0, uint16_t c1, uint8_t *lut) {
+	int dxt[4][3] = {
+		{expand5(c0 >> 11), expand6((c0 >> 5) & 0x3F), expand5(c0 & 0x1F)},
+		{expand5(c1 >> 11), expand6((c1 >> 5) & 0x3F), expand5(c1 & 0x1F)},
+	};
+	for (int c = 0; c < 3; c++) {
+		dxt[2][c] = (2 * dxt[0][c] + dxt[1][c]) / 3;
+		dxt[3][c] = (dxt[0][c] + 2 * dxt[1][c]) / 3;
+	}
+	uint32_t err = 0;
+	for (int k = 0; k < 8; k++) {
+		if (!pb->count[k])
+			continue;
+		uint32_t best = 0xFFFFFFFF;
+		for (int j = 0; j < 4; j++) {
+			int dr = pb->color[k][0] - dxt[j][0];
+			int dg = pb->color[k][1] - dxt[j][1];
+			int db = pb->color[k][2] - dxt[j][2];
+			uint32_t d = dr * dr + dg * dg + db * db;
+			if (d < best) {
+				best = d;
+				lut[k] = j;
+			}
+		}
+		err += best * pb->count[k];
+	}
+	return err;
+}
+
+// Least squares endpoints for the current indices, weighted by palette usage
+static int refine_palette(const palette_block *pb, const uint8_t *lut, uint16_t *c0, uint16_t *c1) {
+	int a = 0, b = 0, c = 0;
+	int x0[3] = {0, 0, 0}, x1[3] = {0, 0, 0};
+	for (int k = 0; k < 8; k++) {
+		if (!pb->count[k])
+			continue;
+		int w0 = dxt_weight[lut[k]];
+		int w1 = 3 - w0;
+		int n = pb->count[k];
+		a += n * w0 * w0;
+		b += n * w0 * w1;
+		c += n * w1 * w1;
+		for (int ch = 0; ch < 3; ch++) {
+			x0[ch] += n * w0 * pb->color[k][ch];
+			x1[ch] += n * w1 * pb->color[k][ch];
+		}
+	}
+	int det = a * c - b * b;
+	if (!det)
+		return 0;
+	int e0[3], e1[3];
+	for (int ch = 0; ch < 3; ch++) {
+		e0[ch] = 3 * (c * x0[ch] - b * x1[ch]) / det;
+		e1[ch] = 3 * (a * x1[ch] - b * x0[ch]) / det;
+	}
+	*c0 = pack565(e0[0], e0[1], e0[2]);
+	*c1 = pack565(e1[0], e1[1], e1[2]);
+	return 1;
+}
+
+static void transcode_palette_color(uint8_t *dst, const palette_block *pb, dxt_quality quality) {
+	uint8_t block[64];
+	if (quality == DXT_QUALITY_HIGH) {
+		palette_to_rgba(pb, block);
+		dxt_compress_block(dst, block, 0, quality);
+		return;
+	}
+
+	// Entries of a subblock lie on a line along the gray axis so only its darkest and brightest used entries are endpoint candidates
+	int cand[4], num = 0;
+	for (int s = 0; s < 8; s += 4) {
+		int mn = -1, mx = -1, mn_l = 766, mx_l = -1;
+		for (int k = s; k < s + 4; k++) {
+			if (!pb->count[k])
+				continue;
+			int l = pb->color[k][0] + pb->color[k][1] + pb->color[k][2];
+			if (l < mn_l) {
+				mn_l = l;
+				mn = k;
+			}
+			if (l > mx_l) {
+				mx_l = l;
+				mx = k;
+			}
+		}
+		if (mn >= 0) {
+			cand[num++] = mn;
+			cand[num++] = mx;
+		}
+	}
+	int e0 = cand[0], e1 = cand[1];
+	int best = -1;
+	for (int i = 0; i < num; i++) {
+		for (int j = i + 1; j < num; j++) {
+			const int *a = pb->color[cand[i]];
+			const int *b = pb->color[cand[j]];
+			int d = (a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) + (a[2] - b[2]) * (a[2] - b[2]);
+			if (d > best) {
+				best = d;
+				e0 = cand[i];
+				e1 = cand[j];
+			}
+		}
+	}
+	uint16_t c0 = pack565(pb->color[e0][0], pb->color[e0][1], pb->color[e0][2]);
+	uint16_t c1 = pack565(pb->color[e1][0], pb->color[e1][1], pb->color[e1][2]);
+
+	// Blocks collapsing to a single endpoint go through the regular encoder
+	if (c0 == c1) {
+		palette_to_rgba(pb, block);
+		dxt_compress_block(dst, block, 0, quality);
+		return;
+	}
+
+	uint8_t lut[8];
+	uint32_t err = map_palette(pb, c0, c1, lut);
+	if (quality == DXT_QUALITY_NORMAL && err) {
+		uint16_t r0, r1;
+		uint8_t rlut[8];
+		if (refine_palette(pb, lut, &r0, &r1) && r0 != r1) {
+			uint32_t rerr = map_palette(pb, r0, r1, rlut);
+			if (rerr < err) {
+				c0 = r0;
+				c1 = r1;
+				memcpy(lut, rlut, 8);
+			}
+		}
+	}
+
+	// 4 colors mode requires the first endpoint to be the greater one
+	if (c0 < c1) {
+		uint16_t t = c0;
+		c0 = c1;
+		c1 = t;
+		for (int k = 0; k < 8; k++)
+			lut[k] ^= 1;
+	}
+	uint32_t mask = 0;
+	for (int i = 15; i >= 0; i--)
+		mask = (mask << 2) | lut[pb->entry[i]];
+	write_color(dst, c0, c1, mask);
+}
+
+// Decodes an ETC1 individual/differential block in palette form, returns 0 for ETC2 T, H and planar modes
+static int etc_to_palette(const uint8_t *src, palette_block *pb) {
+	int base[2][3];
+	if (src[3] & 0x02) {
+		for (int c = 0; c < 3; c++) {
+			int v = src[c] >> 3;
+			int d = src[c] & 0x07;
+			int v2 = v + (d & 0x04 ? d - 8 : d);
+			if (v2 < 0 || v2 > 31)
+				return 0;
+			base[0][c] = expand5(v);
+			base[1][c] = expand5(v2);
+		}
+	} else {
+		for (int c = 0; c < 3; c++) {
+			base[0][c] = expand4(src[c] >> 4);
+			base[1][c] = expand4(src[c] & 0x0F);
+		}
+	}
+	const int *mods[2] = {etc_modifier_table[src[3] >> 5], etc_modifier_table[(src[3] >> 2) & 0x07]};
+	for (int s = 0; s < 2; s++) {
+		for (int k = 0; k < 4; k++) {
+			int *c = pb->color[s * 4 + k];
+			c[0] = clamp_u8(base[s][0] + mods[s][k]);
+			c[1] = clamp_u8(base[s][1] + mods[s][k]);
+			c[2] = clamp_u8(base[s][2] + mods[s][k]);
+		}
+	}
+
+	// Texel indices are stored column major with most significant bits on the upper half
+	uint32_t bits = ((uint32_t)src[4] << 24) | (src[5] << 16) | (src[6] << 8) | src[7];
+	int flip = src[3] & 0x01;
+	memset(pb->count, 0, sizeof(pb->count));
+	for (int x = 0; x < 4; x++) {
+		for (int y = 0; y < 4; y++) {
+			int i = x * 4 + y;
+			int sel = ((bits >> (15 + i)) & 0x02) | ((bits >> i) & 0x01);
+			int sub = flip ? (y >> 1) : (x >> 1);
+			int k = sub * 4 + sel;
+			pb->entry[y * 4 + x] = k;
+			pb->count[k]++;
+		}
+	}
+	return 1;
+}
+
+static void transcode_etc_color(uint8_t *dst, const uint8_t *src, dxt_quality quality) {
+	palette_block pb;
+	if (etc_to_palette(src, &pb)) {
+		transcode_palette_color(dst, &pb, quality);
+	} else {
+		uint8_t block[64];
+		detexDecompressBlockETC2(src, DETEX_MODE_MASK_ALL_MODES_ETC2, 0, block);
+		dxt_compress_block(dst, block, 0, quality);
+	}
+}
+
+static void transcode_eac_alpha(uint8_t *dst, const uint8_t *src) {
+	const int *mods = eac_modifier_table[src[1] & 0x0F];
+	int mult = src[1] >> 4;
+	uint64_t bits = ((uint64_t)src[2] << 40) | ((uint64_t)src[3] << 32) | ((uint64_t)src[4] << 24) | ((uint64_t)src[5] << 16) | ((uint64_t)src[6] << 8) | src[7];
+
+	// Texel indices are stored column major, most significant first
+	uint8_t sel[16];
+	int values[8];
+	int used = 0;
+	for (int i = 0; i < 16; i++) {
+		int k = (bits >> (45 - i * 3)) & 0x07;
+		sel[(i & 3) * 4 + (i >> 2)] = k;
+		used |= 1 << k;
+	}
+	int mn = 255, mx = 0;
+	for (int k = 0; k < 8; k++) {
+		values[k] = clamp_u8(src[0] + mods[k] * mult);
+		if (used & (1 << k)) {
+			mn = values[k] < mn ? values[k] : mn;
+			mx = values[k] > mx ? values[k] : mx;
+		}
+	}
+	dst[0] = mx;
+	dst[1] = mn;
+
+	// 8 alpha values mode over the used range, each EAC entry goes to its closest ramp step
+	uint8_t lut[8] = {0};
+	int range = mx - mn;
+	if (range) {
+		for (int k = 0; k < 8; k++) {
+			if (!(used & (1 << k)))
+				continue;
+			int step = ((values[k] - mn) * 14 + range) / (2 * range);
+			lut[k] = step == 7 ? 0 : (step == 0 ? 1 : 8 - step);
+		}
+	}
+	uint64_t out = 0;
+	for (int i = 15; i >= 0; i--)
+		out = (out << 3) | lut[sel[i]];
+	for (int i = 0; i < 6; i++)
+		dst[2 + i] = (out >> (8 * i)) & 0xFF;
+}
+
+/*
+ * ATITC color blocks share DXT1 layout, in the 4 colors mode the first endpoint is RGB555
+ * and indices 1 and 2 are swapped with respect to DXT, so both are remapped bitwise
+ */
+static void transcode_atc_color(uint8_t *dst, const uint8_t *src, dxt_quality quality) {
+	uint16_t a0 = src[0] | (src[1] << 8);
+	uint16_t c1 = src[2] | (src[3] << 8);
+	uint32_t bits = src[4] | (src[5] << 8) | (src[6] << 16) | ((uint32_t)src[7] << 24);
+
+	// Alternate mode has black as an implicit color which DXT can't express, so the block gets reencoded
+	if (a0 & 0x8000) {
+		uint8_t tmp[8];
+		uint32_t block[16];
+		memcpy(tmp, src, 8);
+		atitc_decode(tmp, (uint8_t *)block, 4, 4, ATC_RGB);
+		for (int i = 0; i < 16; i++) {
+			uint32_t c = block[i];
+			block[i] = ((c >> 16) & 0xFF) | (c & 0xFF00) | ((c & 0xFF) << 16) | 0xFF000000;
+		}
+		dxt_compress_block(dst, (uint8_t *)block, 0, quality);
+		return;
+	}
+
+	// Green gets the same 6 bits the ATITC decoder expands
+	uint16_t c0 = ((a0 & 0x7C00) << 1) | (((a0 >> 4) & 0x3F) << 5) | (a0 & 0x1F);
+	uint32_t hi = (bits >> 1) & 0x55555555;
+	uint32_t lo = bits & 0x55555555;
+	if (c0 > c1)
+		bits = ((hi ^ lo) << 1) | hi;
+	else if (c0 < c1) {
+		uint16_t t = c0;
+		c0 = c1;
+		c1 = t;
+		bits = ((hi ^ lo) << 1) | (hi ^ 0x55555555);
+	} else
+		bits = 0;
+	write_color(dst, c0, c1, bits);
+}
+
+uint32_t transcode_src_block_size(transcode_fmt fmt) {
+	switch (fmt) {
+	case TRANSCODE_ETC2_EAC:
+	case TRANSCODE_ATC_EXPLICIT_ALPHA:
+	case TRANSCODE_ATC_INTERPOLATED_ALPHA:
+		return 16;
+	default:
+		return 8;
+	}
+}
+
+uint32_t transcode_dst_block_size(transcode_fmt fmt) {
+	return transcode_src_block_size(fmt);
+}
+
+void transcode_block(uint8_t *dst, const uint8_t *src, transcode_fmt fmt, dxt_quality quality) {
+	switch (fmt) {
+	case TRANSCODE_ETC2_EAC:
+		transcode_eac_alpha(dst, src);
+		transcode_etc_color(dst + 8, src + 8, quality);
+		break;
+	case TRANSCODE_ATC_RGB:
+		transcode_atc_color(dst, src, quality);
+		break;
+	case TRANSCODE_ATC_EXPLICIT_ALPHA:
+		// Explicit alpha is bit exact with DXT3 alpha
+		memcpy(dst, src, 8);
+		transcode_atc_color(dst + 8, src + 8, quality);
+		break;
+	case TRANSCODE_ATC_INTERPOLATED_ALPHA:
+		// Interpolated alpha is bit exact with DXT5 alpha except for equal endpoints where ATITC stays in 8 values mode
+		memcpy(dst, src, 8);
+		if (src[0] == src[1])
+			memset(dst + 2, 0, 6);
+		transcode_atc_color(dst + 8, src + 8, quality);
+		break;
+	default:
+		break;
+	}
+}
+
+void transcode_swizzled(uint8_t *dst, const uint8_t *src, int src_w, int src_h, int w, int h, transcode_fmt fmt, dxt_quality quality) {
+	const uint32_t src_block_size = transcode_src_block_size(fmt);
+	const uint32_t dst_block_size = transcode_dst_block_size(fmt);
+	const uint32_t src_blocks_w = (src_w + 3) / 4;
+	const uint32_t src_blocks_h = (src_h + 3) / 4;
+	const uint32_t blocks_w = (w + 3) / 4;
+	const uint32_t blocks_h = (h + 3) / 4;
+
+	// Blocks past source size replicate its edges
+	for (uint32_t by = 0; by < blocks_h; by++) {
+		const uint8_t *row = src + (by < src_blocks_h ? by : src_blocks_h - 1) * src_blocks_w * src_block_size;
+		for (uint32_t bx = 0; bx < blocks_w; bx++) {
+			const uint8_t *block = row + (bx < src_blocks_w ? bx : src_blocks_w - 1) * src_block_size;
+			transcode_block(dst + dxt_swizzled_block_index(bx, by, blocks_w, blocks_h) * dst_block_size, block, fmt, quality);
+		}
+	}
+}
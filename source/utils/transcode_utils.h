@@ -0,0 +1,44 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * transcode_utils.h:
+ * Header file for the block transcoders exposed by transcode_utils.c
+ */
+
+#ifndef _TRANSCODE_UTILS_H_
+#define _TRANSCODE_UTILS_H_
+
+#include <stdint.h>
+#include "dxt_utils.h"
+
+// Supported source formats, each one is transcoded to the DXT format with the closest layout
+typedef enum {
+	TRANSCODE_NONE, // No transcoding, data is already in the destination format
+	TRANSCODE_ETC2_EAC, // ETC2 RGB with EAC alpha to DXT5
+	TRANSCODE_ATC_RGB, // ATITC RGB to DXT1
+	TRANSCODE_ATC_EXPLICIT_ALPHA, // ATITC with explicit alpha to DXT3
+	TRANSCODE_ATC_INTERPOLATED_ALPHA // ATITC with interpolated alpha to DXT5
+} transcode_fmt;
+
+uint32_t transcode_src_block_size(transcode_fmt fmt);
+uint32_t transcode_dst_block_size(transcode_fmt fmt);
+void transcode_block(uint8_t *dst, const uint8_t *src, transcode_fmt fmt, dxt_quality quality);
+void transcode_swizzled(uint8_t *dst, const uint8_t *src, int src_w, int src_h, int w, int h, transcode_fmt fmt, dxt_quality quality);
+
+#endif
@@ -0,0 +1,192 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * uniform_utils.c:
+ * Flattened uniform blocks uploaded into a circular pool with a single copy
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "uniform_utils.h"
+
+void uniform_pool_init(uniform_pool *p, void *base, uint32_t size) {
+	p->base = (uint8_t *)base;
+	p->size = size;
+	p->idx = 0;
+	p->pos = 0;
+	p->wraps = 0;
+}
+
+void *uniform_pool_reserve(uniform_pool *p, uint32_t size) {
+	void *r;
+	if (p->idx + size >= p->size) {
+		// Restarting from the beginning, the skipped tail counts as consumed
+		p->pos += p->size - p->idx + size;
+		p->wraps++;
+		r = p->base;
+		p->idx = size;
+	} else {
+		p->pos += size;
+		r = p->base + p->idx;
+		p->idx += size;
+	}
+	return r;
+}
+
+int uniform_block_init(uniform_block *b, uint32_t size) {
+	b->data = size ? (uint8_t *)calloc(1, size) : NULL;
+	b->size = size;
+	b->capacity = size;
+	b->dirty = 1;
+	b->last = NULL;
+	b->last_pos = 0;
+	return !size || b->data;
+}
+
+int uniform_block_resize(uniform_block *b, uint32_t size) {
+	// Content is kept only up to the new size, callers are expected to rewrite it
+	if (size > b->capacity) {
+		uint8_t *data = (uint8_t *)realloc(b->data, size);
+		if (!data) {
+			b->size = 0;
+			b->last = NULL;
+			return 0;
+		}
+		b->data = data;
+		b->capacity = size;
+	}
+	b->size = size;
+	b->dirty = 1;
+	b->last = NULL;
+	return 1;
+}
+
+void uniform_block_term(uniform_block *b) {
+	free(b->data);
+	b->data = NULL;
+	b->size = 0;
+	b->capacity = 0;
+	b->last = NULL;
+}
+
+void *uniform_block_upload(uniform_block *b, uniform_pool *p, uniform_stats *stats) {
+	// Last copy can be bound again as long as the pool didn't overwrite it
+	if (!b->dirty && b->last && p->pos - b->last_pos <= p->size - b->size) {
+		stats->reuses++;
+		return b->last;
+	}
+
+	void *dst = uniform_pool_reserve(p, b->size);
+	memcpy(dst, b->data, b->size);
+	b->last = dst;
+	b->last_pos = p->pos;
+	b->dirty = 0;
+	stats->uploads++;
+	stats->bytes += b->size;
+	return dst;
+}
+
+void gxp_table_build(gxp_param *table, const char *const *names, uint32_t num, const void *prog, gxp_param_finder find) {
+	for (uint32_t i = 0; i < num; i++) {
+		if (!names[i] || !find(prog, names[i], &table[i])) {
+			table[i].ptr = NULL;
+			table[i].res_index = 0;
+			table[i].size = 0;
+		}
+	}
+}
+
+void uniform_plan_begin(uniform_plan *p, uniform_block *b, uniform_setter set) {
+	p->num = 0;
+	p->direct = 0;
+	p->direct_writes = 0;
+	p->block = b;
+	p->set = set;
+}
+
+static void execute_step(uniform_plan *p, const uniform_plan_step *s) {
+	p->set(p->block->data, s->param, s->offset, s->count, s->src);
+	p->block->dirty = 1;
+	p->direct_writes++;
+}
+
+void uniform_plan_add(uniform_plan *p, const void *param, uint32_t offset, uint32_t count, const float *src) {
+	// Uniforms the program lacks are skipped
+	if (!param || !count)
+		return;
+
+	// Running out of steps, the ones added so far get executed in order and the following ones as they come
+	if (p->num == UNIFORM_PLAN_MAX_STEPS && !p->direct) {
+		for (uint32_t i = 0; i < p->num; i++) {
+			execute_step(p, &p->steps[i]);
+		}
+		p->direct = 1;
+	}
+	uniform_plan_step step = {param, offset, count, src};
+	if (p->direct) {
+		execute_step(p, &step);
+		return;
+	}
+	p->steps[p->num++] = step;
+}
+
+void uniform_plan_invalidate(uniform_plan *p) {
+	p->valid = 0;
+}
+
+uint32_t uniform_plan_run(uniform_plan *p) {
+	// Steps got executed while being added, so there's nothing to compare the next run with
+	if (p->direct) {
+		p->valid = 0;
+		p->last_num = 0;
+		return p->direct_writes;
+	}
+
+	uniform_block *b = p->block;
+	uint32_t writes = 0;
+	uint32_t cursor = 0;
+	uint8_t same = p->valid;
+	for (uint32_t i = 0; i < p->num; i++) {
+		uniform_plan_step *s = &p->steps[i];
+		uniform_plan_step *l = &p->last[i];
+
+		// Values of a step can be compared only if every previous step matched the last run ones
+		if (same && (i >= p->last_num || l->param != s->param || l->offset != s->offset || l->count != s->count))
+			same = 0;
+		int fits = cursor + s->count <= UNIFORM_PLAN_MAX_VALUES;
+		if (!same || !fits || memcmp(&p->values[cursor], s->src, s->count * sizeof(float))) {
+			p->set(b->data, s->param, s->offset, s->count, s->src);
+			if (fits)
+				memcpy(&p->values[cursor], s->src, s->count * sizeof(float));
+			writes++;
+		}
+		if (fits)
+			cursor += s->count;
+		else
+			same = 0;
+		*l = *s;
+	}
+	p->last_num = p->num;
+
+	// Steps past the values storage are written at every run, every other step has its values recorded
+	p->valid = 1;
+	if (writes)
+		b->dirty = 1;
+	return writes;
+}
@@ -0,0 +1,105 @@
+/*
+ * This file is part of vitaGL
+ * Copyright 2017, 2018, 2019, 2020 Rinnegatamante
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * uniform_utils.h:
+ * Header file for the uniform blocks utilities exposed by uniform_utils.c
+ */
+
+#ifndef _UNIFORM_UTILS_H_
+#define _UNIFORM_UTILS_H_
+
+#include <stdint.h>
+
+#define UNIFORM_PLAN_MAX_STEPS 64 // Maximum number of steps of an upload plan
+#define UNIFORM_PLAN_MAX_VALUES 512 // Maximum number of components an upload plan can track
+
+// Circular pool uniform buffers get reserved from
+typedef struct {
+	uint8_t *base;
+	uint32_t size;
+	uint32_t idx; // Offset of the first free byte
+	uint32_t pos; // Total number of bytes consumed, wasted tails at wrap included
+	uint32_t wraps; // Number of times the pool restarted from its beginning
+} uniform_pool;
+
+// Uniforms of a program stage laid out as its default uniform buffer
+typedef struct {
+	uint8_t *data;
+	uint32_t size;
+	uint32_t capacity; // Allocated size of data
+	uint8_t dirty; // Set when data changed since the last upload
+	void *last; // Last uploaded copy
+	uint32_t last_pos; // Pool position right after the last uploaded copy
+} uniform_block;
+
+// Uniform blocks counters
+typedef struct {
+	uint32_t uploads; // Number of blocks copied into the pool
+	uint32_t reuses; // Number of blocks whose last uploaded copy got bound again
+	uint32_t bytes; // Bytes copied into the pool
+} uniform_stats;
+
+// Parameter of a shader program located through its name
+typedef struct {
+	const void *ptr; // NULL if the program lacks the parameter
+	uint16_t res_index; // Resource index of the parameter (register for attributes, offset in the default uniform buffer for uniforms)
+	uint16_t size; // Number of components
+} gxp_param;
+
+// Locates a parameter of a program, returns zero if the program lacks it
+typedef int (*gxp_param_finder)(const void *prog, const char *name, gxp_param *out);
+
+// Writes components of a uniform into a default uniform buffer
+typedef int (*uniform_setter)(void *buf, const void *param, uint32_t offset, uint32_t count, const float *src);
+
+// Copy of some state into a uniform
+typedef struct {
+	const void *param;
+	uint32_t offset; // First component of the uniform to write
+	uint32_t count; // Number of components to write
+	const float *src;
+} uniform_plan_step;
+
+// Ordered list of state copies into a uniform block, only steps whose source changed since the last run get executed
+typedef struct {
+	uniform_plan_step steps[UNIFORM_PLAN_MAX_STEPS];
+	uint32_t num;
+	uniform_plan_step last[UNIFORM_PLAN_MAX_STEPS]; // Steps executed by the last run
+	uint32_t last_num;
+	float values[UNIFORM_PLAN_MAX_VALUES]; // Components written by the last run, step after step
+	uint8_t valid; // Whether last run results are still in the uniform block
+	uint8_t direct; // Set when the steps didn't fit, every step is then executed as soon as it's added
+	uint32_t direct_writes; // Number of steps executed since the plan went direct
+	uniform_block *block; // Block the plan being built writes into
+	uniform_setter set;
+} uniform_plan;
+
+void uniform_pool_init(uniform_pool *p, void *base, uint32_t size);
+void *uniform_pool_reserve(uniform_pool *p, uint32_t size);
+int uniform_block_init(uniform_block *b, uint32_t size);
+int uniform_block_resize(uniform_block *b, uint32_t size);
+void uniform_block_term(uniform_block *b);
+void *uniform_block_upload(uniform_block *b, uniform_pool *p, uniform_stats *stats);
+void gxp_table_build(gxp_param *table, const char *const *names, uint32_t num, const void *prog, gxp_param_finder find);
+void uniform_plan_begin(uniform_plan *p, uniform_block *b, uniform_setter set);
+void uniform_plan_add(uniform_plan *p, const void *param, uint32_t offset, uint32_t count, const float *src);
+void uniform_plan_invalidate(uniform_plan *p);
+uint32_t uniform_plan_run(uniform_plan *p);
+
+#endif
@@ -31,6 +31,90 @@ void *color_object; // Color object address for vgl* draw pipeline
 void *texture_object; // Texture object address for vgl* draw pipeline
 void *index_object; // Index object address for vgl* draw pipeline
 
+static uint32_t data_id_counter = 0; // Last content identifier given to a buffer
+static index_range_cache index_ranges; // Ranges of the indices drawn from index buffers
+static buffer_stats buffers_stats; // Counters of the buffers storages updates
+
+static void *alloc_buffer_storage(uint32_t size, uint32_t type) {
+	return gpu_alloc_mapped(size, (vglMemType)type);
+}
+
+static void release_buffer_storage(void *ptr, int busy) {
+	// Storages still read by the GPU are released by the garbage collector
+	if (busy)
+		markAsDirty(ptr);
+	else
+		vglFree(ptr);
+}
+
+static const buffer_allocator buffers_allocator = {
+	alloc_buffer_storage,
+	release_buffer_storage
+};
+
+static inline void invalidate_buffer_content(gpubuffer *gpu_buf) {
+	// Zero is reserved for buffers with no content
+	if (!++data_id_counter)
+		data_id_counter++;
+	gpu_buf->data_id = data_id_counter;
+}
+
+static inline void invalidate_buffer_range(gpubuffer *gpu_buf, uint32_t offset, uint32_t size) {
+	// Only cached data sourced from the changed bytes gets dropped, so content identifier is kept
+	index_range_invalidate(&index_ranges, gpu_buf->data_id, offset, size);
+	invalidate_converted_indices(gpu_buf->data_id, offset, size);
+}
+
+static void *map_buffer(gpubuffer *gpu_buf, uint32_t offset, uint32_t length, GLbitfield access) {
+	// Read only mappings can access current storage straight
+	if (!(access & GL_MAP_WRITE_BIT)) {
+		gpu_buf->mapped = GL_TRUE;
+		gpu_buf->map_offset = offset;
+		gpu_buf->map_length = length;
+		gpu_buf->map_access = access;
+		return (uint8_t *)gpu_buf->ptr + offset;
+	}
+
+	uint32_t flags = 0;
+	if (access & GL_MAP_INVALIDATE_BUFFER_BIT)
+		flags |= BUFFER_MAP_INVALIDATE_BUFFER;
+	if (access & GL_MAP_INVALIDATE_RANGE_BIT)
+		flags |= BUFFER_MAP_INVALIDATE_RANGE;
+
+	// Unsynchronized mappings write in place, so usage tracking is skipped as well
+	if (access & GL_MAP_UNSYNCHRONIZED_BIT)
+		flags |= BUFFER_MAP_UNSYNCHRONIZED;
+
+	// Writing in place if the GPU is done with current storage, otherwise switching to another one
+	void *ptr = buffer_store_map(&gpu_buf->store, &buffers_allocator, offset, length, flags, get_completed_scene_seq(), &buffers_stats);
+	if (!ptr && gpu_buf->size) {
+#ifdef LOG_ERRORS
+		vgl_log("%s:%d %s: Failed to alloc a buffer of %ld bytes.\n", __FILE__, __LINE__, __func__, gpu_buf->size);
+#endif
+		SET_GL_ERROR_WITH_RET(GL_OUT_OF_MEMORY, NULL)
+	}
+	gpu_buf->ptr = ptr;
+	gpu_buf->mapped = GL_TRUE;
+	gpu_buf->map_offset = offset;
+	gpu_buf->map_length = length;
+	gpu_buf->map_access = access;
+	if (access & GL_MAP_INVALIDATE_BUFFER_BIT)
+		invalidate_buffer_content(gpu_buf);
+	buffers_stats.bytes_written += length;
+	return (uint8_t *)ptr + offset;
+}
+
+void get_index_range(const void *idx_buf, GLsizei count, GLboolean is_short, uint32_t *min, uint32_t *max) {
+	// Ranges of indices sourced from the bound index buffer are computed once per buffer content
+	gpubuffer *gpu_buf = (gpubuffer *)(uintptr_t)index_array_unit;
+	if (gpu_buf && gpu_buf->ptr && (uint8_t *)idx_buf >= (uint8_t *)gpu_buf->ptr && (uint8_t *)idx_buf < (uint8_t *)gpu_buf->ptr + gpu_buf->size)
+		index_range_cached(&index_ranges, gpu_buf->data_id, (uint8_t *)idx_buf - (uint8_t *)gpu_buf->ptr, idx_buf, count, is_short, min, max);
+	else if (is_short)
+		index_range_u16((const uint16_t *)idx_buf, count, min, max);
+	else
+		index_range_u32((const uint32_t *)idx_buf, count, min, max);
+}
+
 /*
  * ------------------------------
  * - IMPLEMENTATION STARTS HERE -
@@ -45,12 +129,12 @@ void glGenBuffers(GLsizei n, GLuint *res) {
 	}
 #endif
 	for (i = 0; i < n; i++) {
-		res[i] = (GLuint)(vglMalloc(sizeof(gpubuffer)));
+		res[i] = (GLuint)(uintptr_t)vglMalloc(sizeof(gpubuffer));
 #ifdef LOG_ERRORS
 		if (!res[i])
 			vgl_log("%s:%d glGenBuffers failed to alloc a buffer (%d/%lu).\n", __FILE__, __LINE__, i, n);
 #endif
-		sceClibMemset((void *)res[i], 0, sizeof(gpubuffer));
+		sceClibMemset((void *)(uintptr_t)res[i], 0, sizeof(gpubuffer));
 	}
 }
 
@@ -82,13 +166,8 @@ void glDeleteBuffers(GLsizei n, const GLuint *gl_buffers) {
 	int i, j;
 	for (j = 0; j < n; j++) {
 		if (gl_buffers[j]) {
-			gpubuffer *gpu_buf = (gpubuffer *)gl_buffers[j];
-			if (gpu_buf->ptr) {
-				if (gpu_buf->used)
-					markAsDirty(gpu_buf->ptr);
-				else
-					vglFree(gpu_buf->ptr);
-			}
+			gpubuffer *gpu_buf = (gpubuffer *)(uintptr_t)gl_buffers[j];
+			buffer_store_release(&gpu_buf->store, &buffers_allocator, get_completed_scene_seq());
 			vglFree(gpu_buf);
 		}
 	}
@@ -98,10 +177,10 @@ void glBufferData(GLenum target, GLsizei size, const GLvoid *data, GLenum usage)
 	gpubuffer *gpu_buf;
 	switch (target) {
 	case GL_ARRAY_BUFFER:
-		gpu_buf = (gpubuffer *)vertex_array_unit;
+		gpu_buf = (gpubuffer *)(uintptr_t)vertex_array_unit;
 		break;
 	case GL_ELEMENT_ARRAY_BUFFER:
-		gpu_buf = (gpubuffer *)index_array_unit;
+		gpu_buf = (gpubuffer *)(uintptr_t)index_array_unit;
 		break;
 	default:
 		SET_GL_ERROR_WITH_VALUE(GL_INVALID_ENUM, target)
@@ -127,16 +206,8 @@ void glBufferData(GLenum target, GLsizei size, const GLvoid *data, GLenum usage)
 		break;
 	}
 
-	// Marking previous content for deletion or deleting it straight if unused
-	if (gpu_buf->ptr) {
-		if (gpu_buf->used)
-			markAsDirty(gpu_buf->ptr);
-		else
-			vglFree(gpu_buf->ptr);
-	}
-
-	// Allocating a new buffer
-	gpu_buf->ptr = gpu_alloc_mapped(size, gpu_buf->type);
+	// Orphaning previous content, its storage gets recycled once the GPU is done with it
+	gpu_buf->ptr = buffer_store_orphan(&gpu_buf->store, &buffers_allocator, size, gpu_buf->type, get_completed_scene_seq(), &buffers_stats);
 
 #ifndef SKIP_ERROR_HANDLING
 	if (!gpu_buf->ptr) {
@@ -145,20 +216,22 @@ void glBufferData(GLenum target, GLsizei size, const GLvoid *data, GLenum usage)
 #endif
 
 	gpu_buf->size = size;
-	gpu_buf->used = GL_FALSE;
+	invalidate_buffer_content(gpu_buf);
 
-	if (data)
+	if (data) {
 		vgl_fast_memcpy(gpu_buf->ptr, data, size);
+		buffers_stats.bytes_written += size;
+	}
 }
 
 void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data) {
 	gpubuffer *gpu_buf;
 	switch (target) {
 	case GL_ARRAY_BUFFER:
-		gpu_buf = (gpubuffer *)vertex_array_unit;
+		gpu_buf = (gpubuffer *)(uintptr_t)vertex_array_unit;
 		break;
 	case GL_ELEMENT_ARRAY_BUFFER:
-		gpu_buf = (gpubuffer *)index_array_unit;
+		gpu_buf = (gpubuffer *)(uintptr_t)index_array_unit;
 		break;
 	default:
 		SET_GL_ERROR_WITH_VALUE(GL_INVALID_ENUM, target)
@@ -171,42 +244,26 @@ void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void
 	}
 #endif
 
-	// Allocating a new buffer
-	if (gpu_buf->used) {
-		uint8_t *ptr = gpu_alloc_mapped(gpu_buf->size, gpu_buf->type);
-
+	// Writing in place if the GPU is done with current storage, otherwise switching to another one
+	void *ptr = buffer_store_write(&gpu_buf->store, &buffers_allocator, offset, data, size, get_completed_scene_seq(), &buffers_stats);
+	if (!ptr) {
 #ifdef LOG_ERRORS
-		if (!ptr) {
-			vgl_log("%s:%d glBufferSubData failed to alloc a buffer of %ld bytes. Buffer content won't be updated.\n", __FILE__, __LINE__, gpu_buf->size);
-			return;
-		}
+		vgl_log("%s:%d glBufferSubData failed to alloc a buffer of %ld bytes. Buffer content won't be updated.\n", __FILE__, __LINE__, gpu_buf->size);
 #endif
-		
-		// Copying up previous data combined to modified data
-		if (offset > 0)
-			vgl_memcpy(ptr, gpu_buf->ptr, offset);
-		vgl_memcpy(ptr + offset, data, size);
-		if (gpu_buf->size - size - offset > 0)
-			vgl_memcpy(ptr + offset + size, (uint8_t *)gpu_buf->ptr + offset + size, gpu_buf->size - size - offset);
-
-		// Marking previous content for deletion
-		markAsDirty(gpu_buf->ptr);
-		
-		gpu_buf->ptr = ptr;
-		gpu_buf->used = GL_FALSE;
-	} else {
-		vgl_memcpy((uint8_t *)gpu_buf->ptr + offset, data, size);
-	}	
+		return;
+	}
+	gpu_buf->ptr = ptr;
+	invalidate_buffer_content(gpu_buf);
 }
 
 void *glMapBuffer(GLenum target, GLenum access) {
 	gpubuffer *gpu_buf;
 	switch (target) {
 	case GL_ARRAY_BUFFER:
-		gpu_buf = (gpubuffer *)vertex_array_unit;
+		gpu_buf = (gpubuffer *)(uintptr_t)vertex_array_unit;
 		break;
 	case GL_ELEMENT_ARRAY_BUFFER:
-		gpu_buf = (gpubuffer *)index_array_unit;
+		gpu_buf = (gpubuffer *)(uintptr_t)index_array_unit;
 		break;
 	default:
 		SET_GL_ERROR_WITH_RET(GL_INVALID_ENUM, NULL)
@@ -227,19 +284,24 @@ void *glMapBuffer(GLenum target, GLenum access) {
 	}
 #endif
 
-	// TODO: Current implementation doesn't take into account 'used' state
-	gpu_buf->mapped = GL_TRUE;
-	return gpu_buf->ptr;
+	switch (access) {
+	case GL_READ_ONLY:
+		return map_buffer(gpu_buf, 0, gpu_buf->size, GL_MAP_READ_BIT);
+	case GL_WRITE_ONLY:
+		return map_buffer(gpu_buf, 0, gpu_buf->size, GL_MAP_WRITE_BIT);
+	default:
+		return map_buffer(gpu_buf, 0, gpu_buf->size, GL_MAP_READ_BIT | GL_MAP_WRITE_BIT);
+	}
 }
 
 void *glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
 	gpubuffer *gpu_buf;
 	switch (target) {
 	case GL_ARRAY_BUFFER:
-		gpu_buf = (gpubuffer *)vertex_array_unit;
+		gpu_buf = (gpubuffer *)(uintptr_t)vertex_array_unit;
 		break;
 	case GL_ELEMENT_ARRAY_BUFFER:
-		gpu_buf = (gpubuffer *)index_array_unit;
+		gpu_buf = (gpubuffer *)(uintptr_t)index_array_unit;
 		break;
 	default:
 		SET_GL_ERROR_WITH_RET(GL_INVALID_ENUM, NULL)
@@ -248,24 +310,30 @@ void *glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitf
 #ifndef SKIP_ERROR_HANDLING
 	if (!gpu_buf || gpu_buf->mapped) {
 		SET_GL_ERROR_WITH_RET(GL_INVALID_OPERATION, NULL)
-	} else if (offset < 0 || length < 0 || offset + length > gpu_buf->size) {
+	} else if (offset < 0 || offset > gpu_buf->size || length > gpu_buf->size - offset) {
+		SET_GL_ERROR_WITH_RET(GL_INVALID_VALUE, NULL)
+	} else if (access & ~(GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_UNSYNCHRONIZED_BIT)) {
 		SET_GL_ERROR_WITH_RET(GL_INVALID_VALUE, NULL)
+	} else if (!(access & (GL_MAP_READ_BIT | GL_MAP_WRITE_BIT))) {
+		SET_GL_ERROR_WITH_RET(GL_INVALID_OPERATION, NULL)
+	} else if ((access & GL_MAP_READ_BIT) && (access & (GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT))) {
+		SET_GL_ERROR_WITH_RET(GL_INVALID_OPERATION, NULL)
+	} else if ((access & GL_MAP_FLUSH_EXPLICIT_BIT) && !(access & GL_MAP_WRITE_BIT)) {
+		SET_GL_ERROR_WITH_RET(GL_INVALID_OPERATION, NULL)
 	}
 #endif
-	
-	// TODO: Current implementation doesn't take into account 'used' state
-	gpu_buf->mapped = GL_TRUE;
-	return (void *)((uint8_t *)gpu_buf->ptr + offset);
+
+	return map_buffer(gpu_buf, offset, length, access);
 }
 
 GLboolean glUnmapBuffer(GLenum target) {
 	gpubuffer *gpu_buf;
 	switch (target) {
 	case GL_ARRAY_BUFFER:
-		gpu_buf = (gpubuffer *)vertex_array_unit;
+		gpu_buf = (gpubuffer *)(uintptr_t)vertex_array_unit;
 		break;
 	case GL_ELEMENT_ARRAY_BUFFER:
-		gpu_buf = (gpubuffer *)index_array_unit;
+		gpu_buf = (gpubuffer *)(uintptr_t)index_array_unit;
 		break;
 	default:
 		SET_GL_ERROR_WITH_RET(GL_INVALID_ENUM, GL_TRUE)
@@ -277,7 +345,9 @@ GLboolean glUnmapBuffer(GLenum target) {
 	}
 #endif
 	
-	gpu_buf->used = GL_FALSE;
+	// Explicitly flushed mappings already invalidated the bytes they changed
+	if ((gpu_buf->map_access & (GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT)) == GL_MAP_WRITE_BIT)
+		invalidate_buffer_range(gpu_buf, gpu_buf->map_offset, gpu_buf->map_length);
 	gpu_buf->mapped = GL_FALSE;
 	return GL_TRUE;
 }
@@ -286,32 +356,35 @@ void glFlushMappedBufferRange(GLenum target, GLintptr offset, GLsizeiptr length)
 	gpubuffer *gpu_buf;
 	switch (target) {
 	case GL_ARRAY_BUFFER:
-		gpu_buf = (gpubuffer *)vertex_array_unit;
+		gpu_buf = (gpubuffer *)(uintptr_t)vertex_array_unit;
 		break;
 	case GL_ELEMENT_ARRAY_BUFFER:
-		gpu_buf = (gpubuffer *)index_array_unit;
+		gpu_buf = (gpubuffer *)(uintptr_t)index_array_unit;
 		break;
 	default:
 		SET_GL_ERROR_WITH_VALUE(GL_INVALID_ENUM, target)
 	}
 
 #ifndef SKIP_ERROR_HANDLING
-	if (!gpu_buf || !gpu_buf->mapped) {
+	if (!gpu_buf || !gpu_buf->mapped || !(gpu_buf->map_access & GL_MAP_FLUSH_EXPLICIT_BIT)) {
 		SET_GL_ERROR(GL_INVALID_OPERATION)
-	} else if (offset < 0 || length < 0 || offset + length > gpu_buf->size) {
+	} else if (offset < 0 || offset > gpu_buf->map_length || length > gpu_buf->map_length - offset) {
 		SET_GL_ERROR(GL_INVALID_VALUE)
 	}
 #endif
+
+	// Offset is relative to the mapped range
+	invalidate_buffer_range(gpu_buf, gpu_buf->map_offset + offset, length);
 }
 
 void glGetBufferParameteriv(GLenum target, GLenum pname, GLint *params) {
 	gpubuffer *gpu_buf;
 	switch (target) {
 	case GL_ARRAY_BUFFER:
-		gpu_buf = (gpubuffer *)vertex_array_unit;
+		gpu_buf = (gpubuffer *)(uintptr_t)vertex_array_unit;
 		break;
 	case GL_ELEMENT_ARRAY_BUFFER:
-		gpu_buf = (gpubuffer *)index_array_unit;
+		gpu_buf = (gpubuffer *)(uintptr_t)index_array_unit;
 		break;
 	default:
 		SET_GL_ERROR_WITH_VALUE(GL_INVALID_ENUM, target)
@@ -331,6 +404,13 @@ void glGetBufferParameteriv(GLenum target, GLenum pname, GLint *params) {
 	}
 }
 
+void vglGetBufferStats(vglBufferStats *stats) {
+	stats->bytes_written = buffers_stats.bytes_written;
+	stats->bytes_copied = buffers_stats.bytes_copied;
+	stats->renames = buffers_stats.renames;
+	stats->allocs = buffers_stats.allocs;
+}
+
 // VGL_EXT_gpu_objects_array extension implementation
 
 void vglVertexPointer(GLint size, GLenum type, GLsizei stride, GLuint count, const GLvoid *pointer) {
@@ -94,6 +94,7 @@ extern GLboolean use_vram_for_usse;
 uint16_t *default_idx_ptr; // sceGxm mapped progressive indices buffer
 uint16_t *default_quads_idx_ptr; // sceGxm mapped progressive indices buffer for quads
 uint16_t *default_line_strips_idx_ptr; // sceGxm mapped progressive indices buffer for line strips
+static uint32_t default_idx_vertices = 0; // Number of vertices covered by the progressive indices buffers
 
 // Internal functions
 #ifdef HAVE_CIRCULAR_VERTEX_POOL
@@ -116,6 +117,40 @@ void reset_vertex_data_pool(){
 }
 #endif
 
+void reserve_default_indices(uint32_t count) {
+	if (count <= default_idx_vertices || default_idx_vertices == MAX_IDX_NUMBER)
+		return;
+
+	// Growing to the next power of two so that the buffers get rebuilt only a handful of times
+	uint32_t vertices = nearest_po2(count);
+	if (vertices > MAX_IDX_NUMBER)
+		vertices = MAX_IDX_NUMBER;
+	uint16_t *idx = (uint16_t *)gpu_alloc_mapped(vertices * sizeof(uint16_t), VGL_MEM_VRAM);
+	uint16_t *quads_idx = (uint16_t *)gpu_alloc_mapped((vertices / 4) * 6 * sizeof(uint16_t), VGL_MEM_VRAM);
+	uint16_t *line_strips_idx = (uint16_t *)gpu_alloc_mapped(vertices * 2 * sizeof(uint16_t), VGL_MEM_VRAM);
+	if (!idx || !quads_idx || !line_strips_idx) {
+		vgl_log("%s:%d reserve_default_indices: Failed to grow progressive indices buffers to %u vertices.\n", __FILE__, __LINE__, vertices);
+		vglFree(idx);
+		vglFree(quads_idx);
+		vglFree(line_strips_idx);
+		return;
+	}
+	index_fill_linear_u16(idx, 0, vertices);
+	index_fill_quads_u16(quads_idx, 0, vertices / 4);
+	index_fill_line_strip_u16(line_strips_idx, 0, vertices);
+
+	// Previous buffers may still be in use by the GPU
+	if (default_idx_vertices) {
+		markAsDirty(default_idx_ptr);
+		markAsDirty(default_quads_idx_ptr);
+		markAsDirty(default_line_strips_idx_ptr);
+	}
+	default_idx_ptr = idx;
+	default_quads_idx_ptr = quads_idx;
+	default_line_strips_idx_ptr = line_strips_idx;
+	default_idx_vertices = vertices;
+}
+
 void vector4f_convert_to_local_space(vector4f *out, int x, int y, int width, int height) {
 	out->x = (float)(2 * x) / DISPLAY_WIDTH_FLOAT - 1.0f;
 	out->y = (float)(2 * (x + width)) / DISPLAY_WIDTH_FLOAT - 1.0f;
@@ -144,6 +179,10 @@ GLboolean vglInitWithCustomSizes(int pool_size, int width, int height, int ram_p
 		return GL_FALSE;
 	}
 
+#ifdef HAVE_GL_CAPTURE
+	capture_init(pool_size, width, height, ram_pool_size, cdram_pool_size, phycont_pool_size, cdlg_pool_size, msaa);
+#endif
+
 #ifndef DISABLE_ADVANCED_SHADER_CACHE
 	sceIoMkdir("ux0:data/shader_cache", 0777);
 #endif
@@ -256,7 +295,7 @@ GLboolean vglInitWithCustomSizes(int pool_size, int width, int height, int ram_p
 			msaa_mode, NULL, NULL,
 			&clear_fragment_program_float_patched);
 	}
-	sceGxmSetTwoSidedEnable(gxm_context, SCE_GXM_TWO_SIDED_ENABLED);
+	set_gxm_two_sided_enable(SCE_GXM_TWO_SIDED_ENABLED);
 
 	// Scissor Test shader register
 	sceGxmShaderPatcherCreateMaskUpdateFragmentProgram(gxm_shader_patcher, &scissor_test_fragment_program);
@@ -294,6 +333,10 @@ GLboolean vglInitWithCustomSizes(int pool_size, int width, int height, int ram_p
 	// Init custom shaders
 	resetCustomShaders();
 
+	// Init ffp shaders cache
+	init_ffp_shader_cache();
+	init_ffp_shader_archive();
+
 #ifdef HAVE_CIRCULAR_VERTEX_POOL
 	vertex_data_pool = gpu_alloc_mapped(vertex_data_pool_size, VGL_MEM_RAM);
 	vertex_data_pool_ptr = vertex_data_pool;
@@ -301,29 +344,7 @@ GLboolean vglInitWithCustomSizes(int pool_size, int width, int height, int ram_p
 #endif
 
 	// Init constant index buffers
-	default_idx_ptr = (uint16_t *)vglMalloc(MAX_IDX_NUMBER * sizeof(uint16_t));
-	default_quads_idx_ptr = (uint16_t *)vglMalloc(MAX_IDX_NUMBER * sizeof(uint16_t));
-	default_line_strips_idx_ptr = (uint16_t *)vglMalloc(MAX_IDX_NUMBER * sizeof(uint16_t));
-	for (i = 0; i < MAX_IDX_NUMBER / 6; i++) {
-		default_idx_ptr[i * 6] = i * 6;
-		default_idx_ptr[i * 6 + 1] = i * 6 + 1;
-		default_idx_ptr[i * 6 + 2] = i * 6 + 2;
-		default_idx_ptr[i * 6 + 3] = i * 6 + 3;
-		default_idx_ptr[i * 6 + 4] = i * 6 + 4;
-		default_idx_ptr[i * 6 + 5] = i * 6 + 5;
-		default_line_strips_idx_ptr[i * 6] = i * 3;
-		default_line_strips_idx_ptr[i * 6 + 1] = i * 3 + 1;
-		default_line_strips_idx_ptr[i * 6 + 2] = i * 3 + 1;
-		default_line_strips_idx_ptr[i * 6 + 3] = i * 3 + 2;
-		default_line_strips_idx_ptr[i * 6 + 4] = i * 3 + 2;
-		default_line_strips_idx_ptr[i * 6 + 5] = i * 3 + 3;
-		default_quads_idx_ptr[i * 6] = i * 4;
-		default_quads_idx_ptr[i * 6 + 1] = i * 4 + 1;
-		default_quads_idx_ptr[i * 6 + 2] = i * 4 + 3;
-		default_quads_idx_ptr[i * 6 + 3] = i * 4 + 1;
-		default_quads_idx_ptr[i * 6 + 4] = i * 4 + 2;
-		default_quads_idx_ptr[i * 6 + 5] = i * 4 + 3;
-	}
+	reserve_default_indices(DEFAULT_IDX_NUMBER);
 
 	// Init buffers
 	for (i = 0; i < VERTEX_ATTRIBS_NUM; i++) {
@@ -431,12 +452,6 @@ GLboolean vglInitWithCustomSizes(int pool_size, int width, int height, int ram_p
 		}
 	}
 
-	// Init purge lists
-	for (i = 0; i < FRAME_PURGE_FREQ; i++) {
-		frame_purge_list[i][0] = NULL;
-		frame_rt_purge_list[i][0] = NULL;
-	}
-
 	// Init scissor test state
 	resetScissorTestRegion();
 
@@ -509,14 +524,31 @@ void vglEnd(void) {
 	vglFree(depth_clear_indices);
 	vglFree(scissor_test_vertices);
 
+	// Deallocating progressive indices buffers, so that the next vitaGL instance reserves them again
+	vglFree(default_idx_ptr);
+	vglFree(default_quads_idx_ptr);
+	vglFree(default_line_strips_idx_ptr);
+	default_idx_vertices = 0;
+
+	// Deallocating default texture object, it's reallocated by the next vitaGL instance
+	gpu_free_texture(&texture_slots[0]);
+
 	// Releasing shader programs from sceGxmShaderPatcher
 	sceGxmShaderPatcherReleaseFragmentProgram(gxm_shader_patcher, scissor_test_fragment_program);
 	sceGxmShaderPatcherReleaseVertexProgram(gxm_shader_patcher, clear_vertex_program_patched);
 	sceGxmShaderPatcherReleaseFragmentProgram(gxm_shader_patcher, clear_fragment_program_patched);
+	sceGxmShaderPatcherReleaseFragmentProgram(gxm_shader_patcher, clear_fragment_program_float_patched);
 
 	// Unregistering shader programs from sceGxmShaderPatcher
+	SceGxmProgram *clear_vertex_program = (SceGxmProgram *)sceGxmShaderPatcherGetProgramFromId(clear_vertex_id);
+	SceGxmProgram *clear_fragment_program = (SceGxmProgram *)sceGxmShaderPatcherGetProgramFromId(clear_fragment_id);
 	sceGxmShaderPatcherUnregisterProgram(gxm_shader_patcher, clear_vertex_id);
 	sceGxmShaderPatcherUnregisterProgram(gxm_shader_patcher, clear_fragment_id);
+	vglFree(clear_vertex_program);
+	vglFree(clear_fragment_program);
+
+	// Releasing ffp shaders cache and every program patched for the fixed function pipeline
+	term_ffp_shader_cache();
 
 	// Terminating shader patcher
 	stopShaderPatcher();
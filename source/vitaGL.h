@@ -465,6 +465,7 @@ extern "C" {
 #define GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX 0x9049
 #define GL_COMPRESSED_RGBA_PVRTC_2BPPV2_IMG             0x9137
 #define GL_COMPRESSED_RGBA_PVRTC_4BPPV2_IMG             0x9138
+#define GL_COMPLETION_STATUS_KHR                        0x91B1
 #define GL_COMPRESSED_RGBA8_ETC2_EAC                    0x9278
 
 #define EGL_SUCCESS                                  0x3000
@@ -768,15 +769,90 @@ typedef enum {
 	VGL_MEM_ALL
 } vglMemType;
 
+typedef enum {
+	VGL_ASYNC_FALLBACK_SKIP, // Skip ffp draws until the required shaders are compiled
+	VGL_ASYNC_FALLBACK_NEAREST // Draw with the nearest compatible cached ffp shader while the required one is compiled
+} vglAsyncFallback;
+
+typedef struct {
+	uint32_t hits; // Number of shaders loaded from cache
+	uint32_t misses; // Number of shaders not found in cache
+	uint32_t corrupted; // Number of cached shaders discarded due to corruption or being produced by another build
+	uint32_t collisions; // Number of cached shaders rejected due to being compiled from a different source
+	uint32_t evictions; // Number of cached shaders evicted due to size limits
+	uint32_t entries; // Number of shaders currently in cache
+	uint32_t size; // Current cache size in bytes
+} vglShaderCacheStats;
+
+typedef struct {
+	uint32_t hits; // Number of ffp shaders lookups served by the cache
+	uint32_t misses; // Number of ffp shaders lookups not found in cache
+	uint32_t evictions; // Number of ffp shaders evicted due to capacity limits
+	uint32_t entries; // Number of ffp shaders currently in cache
+	uint32_t capacity; // Maximum number of ffp shaders in cache
+	uint32_t max_entry_hits; // Number of hits of the most used cached ffp shader
+} vglFFPCacheStats;
+
+typedef struct {
+	uint32_t draws_in; // Number of ffp draws submitted for batching
+	uint32_t draws_out; // Number of draws issued for batched ffp draws
+	uint32_t vertices; // Number of vertices merged into batches
+	uint32_t vertices_transformed; // Number of vertices moved on the CPU to be merged into a batch
+} vglFFPBatchingStats;
+
+typedef struct {
+	uint32_t bytes_written; // Bytes of new content written into buffers
+	uint32_t bytes_copied; // Bytes of previous content copied when a buffer switched storage
+	uint32_t renames; // Number of times a buffer switched storage to not overwrite data read by the GPU
+	uint32_t allocs; // Number of buffers storages allocated
+} vglBufferStats;
+
+typedef struct {
+	uint32_t uploads; // Number of uniform blocks copied into the uniform buffers pool
+	uint32_t reuses; // Number of uniform blocks whose last uploaded copy got bound again
+	uint32_t bytes; // Bytes of uniform blocks copied into the uniform buffers pool
+} vglUniformStats;
+
+typedef struct {
+	uint32_t calls; // Number of GL calls recorded
+	uint32_t frames; // Number of frames recorded
+	uint32_t blobs; // Number of unique client memory blocks stored
+	uint32_t blobs_reused; // Number of client memory blocks served by an already stored identical one
+	uint64_t bytes; // Size in bytes of the trace
+	uint64_t blob_bytes; // Size in bytes of the unique client memory blocks stored
+} vglCaptureStats;
+
+typedef struct {
+	const char *name; // Name of the profiled zone
+	uint32_t calls; // Number of times the zone got executed
+	uint32_t min_time; // Shortest execution of the zone in microseconds
+	uint32_t max_time; // Longest execution of the zone in microseconds
+	uint64_t total_time; // Time spent in the zone in microseconds
+} vglProfilerZoneStats;
+
+typedef struct {
+	uint32_t issued; // Number of fixed function state changes sent to sceGxm
+	uint32_t skipped; // Number of fixed function state changes skipped as redundant or overwritten before a draw
+} vglStateStats;
+
 // vgl*
 void *vglAlloc(uint32_t size, vglMemType type);
 void *vglCalloc(uint32_t nmember, uint32_t size);
+GLboolean vglDumpProfilerTrace(const char *path, uint32_t num_frames);
 void vglEnd(void);
 void *vglForceAlloc(uint32_t size);
 void vglFree(void *addr);
+void vglGetBufferStats(vglBufferStats *stats);
+void vglGetCaptureStats(vglCaptureStats *stats);
+void vglGetFFPCacheStats(vglFFPCacheStats *stats);
+void vglGetFFPBatchingStats(vglFFPBatchingStats *stats);
 SceGxmTexture *vglGetGxmTexture(GLenum target);
+void vglGetShaderCacheStats(vglShaderCacheStats *stats);
+void vglGetStateStats(vglStateStats *stats);
 void *vglGetProcAddress(const char *name);
+int vglGetProfilerZoneStats(vglProfilerZoneStats *stats, int max_zones);
 void *vglGetTexDataPointer(GLenum target);
+void vglGetUniformStats(vglUniformStats *stats);
 GLboolean vglInit(int legacy_pool_size);
 GLboolean vglInitExtended(int legacy_pool_size, int width, int height, int ram_threshold, SceGxmMultisampleMode msaa);
 GLboolean vglInitWithCustomSizes(int legacy_pool_size, int width, int height, int ram_pool_size, int cdram_pool_size, int phycont_pool_size, int cdlg_pool_size, SceGxmMultisampleMode msaa);
@@ -788,15 +864,22 @@ size_t vglMemFree(vglMemType type);
 size_t vglMemTotal(vglMemType type);
 void vglOverloadTexDataPointer(GLenum target, void *data);
 void *vglRealloc(void *ptr, uint32_t size);
+void vglResetProfiler(void);
 void vglSetDisplayCallback(void (*cb)(void *framebuf));
+void vglSetFFPCacheSize(uint32_t size);
 void vglSetFragmentBufferSize(uint32_t size);
 void vglSetParamBufferSize(uint32_t size);
+void vglSetShaderCacheSize(uint32_t size);
 void vglSetUSSEBufferSize(uint32_t size);
 void vglSetVDMBufferSize(uint32_t size);
 void vglSetVertexBufferSize(uint32_t size);
 void vglSetVertexPoolSize(uint32_t size);
+void vglSetupAsyncShaderCompiler(GLboolean enable, vglAsyncFallback fallback, int priority, int affinity);
 void vglSetupGarbageCollector(int priority, int affinity);
 void vglSetupRuntimeShaderCompiler(shark_opt opt_level, int32_t use_fastmath, int32_t use_fastprecision, int32_t use_fastint);
+void vglSetupTextureCompressor(int num_threads, int priority, int affinity);
+GLboolean vglStartCapture(const char *path);
+void vglStopCapture(void);
 void vglSwapBuffers(GLboolean has_commondialog);
 void vglTexImageDepthBuffer(GLenum target);
 void vglUseCachedMem(GLboolean use);